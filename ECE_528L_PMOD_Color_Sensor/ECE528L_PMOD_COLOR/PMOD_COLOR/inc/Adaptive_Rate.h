@@ -0,0 +1,181 @@
+/**
+ * @file Adaptive_Rate.h
+ * @brief Header file for the Adaptive_Rate controller.
+ *
+ * This file contains the function definitions for the adaptive sampling rate controller.
+ * While the scene in front of the sensor does not change, the controller selects an idle
+ * mode with a long wait time (WTIME), in which the sensor spends most of its time in the
+ * low-power wait state. As soon as the clear channel or the chromaticity
+ * changes by more than a threshold between two samples, it switches to a burst mode with the
+ * shortest integration time and no wait time. After a quiet period without changes, it decays
+ * back to the idle mode.
+ *
+ * The controller keeps its own time base by adding up the conversion periods of the samples,
+ * and records the number of samples, the time and the estimated sensor energy spent in each mode.
+ *
+ */
+
+#ifndef INC_ADAPTIVE_RATE_H_
+#define INC_ADAPTIVE_RATE_H_
+
+#include <stdint.h>
+#include "PMOD_Color.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// TCS34725 supply currents used for the energy estimate (typical values from the datasheet)
+#define ADAPTIVE_RATE_ACTIVE_CURRENT_UA         235
+#define ADAPTIVE_RATE_WAIT_CURRENT_UA           65
+#define ADAPTIVE_RATE_SUPPLY_MV                 3300
+
+// Clear channel values below this level are treated as this level when computing relative changes
+#define ADAPTIVE_RATE_MIN_CLEAR                 16
+
+// Chromaticity changes are ignored when R + G + B is below this level (after normalization),
+// since the chromaticity of a dark sample is dominated by noise
+#define ADAPTIVE_RATE_MIN_CHROMA_SUM            256
+
+// Default idle mode: 2.4 ms integration and 48 ms wait time (about 20 samples per second).
+// The period matches the original 50 ms sampling loop, so the latency of the first
+// detection is unchanged while the sensor spends 95% of the time in the wait state
+#define ADAPTIVE_RATE_IDLE_INTEGRATION_US       2400
+#define ADAPTIVE_RATE_IDLE_WAIT_US              48000
+
+// Default burst mode: 2.4 ms integration and no wait time (about 416 samples per second)
+#define ADAPTIVE_RATE_BURST_INTEGRATION_US      2400
+#define ADAPTIVE_RATE_BURST_WAIT_US             0
+
+// Default thresholds: 12.5% relative change of the clear channel (Q8),
+// or a change of 0.08 in r + g chromaticity (Q10)
+#define ADAPTIVE_RATE_CLEAR_THRESHOLD_Q8        32
+#define ADAPTIVE_RATE_CHROMA_THRESHOLD_Q10      82
+
+// Default quiet period before decaying back to the idle mode
+#define ADAPTIVE_RATE_QUIET_TIME_US             1500000
+
+typedef enum
+{
+    ADAPTIVE_RATE_IDLE = 0,
+    ADAPTIVE_RATE_BURST = 1,
+    ADAPTIVE_RATE_NUM_MODES = 2
+} Adaptive_Rate_Mode;
+
+typedef struct
+{
+    uint32_t integration_us[ADAPTIVE_RATE_NUM_MODES];
+    uint32_t wait_us[ADAPTIVE_RATE_NUM_MODES];
+
+    // Relative change of the clear channel (Q8, 256 = 100%) and change of the
+    // r + g chromaticity (Q10, 1024 = 1.0) between two samples that count as a change
+    uint16_t clear_threshold_q8;
+    uint16_t chroma_threshold_q10;
+
+    // Time without changes after which the burst mode decays to the idle mode
+    uint32_t quiet_time_us;
+} Adaptive_Rate_Config;
+
+typedef struct
+{
+    uint32_t samples[ADAPTIVE_RATE_NUM_MODES];
+    uint64_t time_us[ADAPTIVE_RATE_NUM_MODES];
+    uint64_t active_us[ADAPTIVE_RATE_NUM_MODES];
+    uint64_t wait_us[ADAPTIVE_RATE_NUM_MODES];
+    uint32_t bursts;
+} Adaptive_Rate_Stats;
+
+typedef struct
+{
+    Adaptive_Rate_Config config;
+    Adaptive_Rate_Mode mode;
+    uint64_t time_us;
+    uint64_t last_change_us;
+    PMOD_Color_Data previous;
+    uint8_t has_previous;
+    Adaptive_Rate_Stats stats;
+} Adaptive_Rate_Controller;
+
+// Default configuration built from the ADAPTIVE_RATE_* constants above
+extern const Adaptive_Rate_Config Adaptive_Rate_Default_Config;
+
+/**
+ * @brief Initializes the controller in the idle mode.
+ *
+ * @param controller Pointer to the controller.
+ * @param config     Pointer to the configuration, which is copied.
+ *
+ * @return None
+ */
+void Adaptive_Rate_Init(Adaptive_Rate_Controller *controller, const Adaptive_Rate_Config *config);
+
+/**
+ * @brief Processes one raw sample taken with the timing of the current mode.
+ *
+ * @param controller Pointer to the controller.
+ * @param sample     The raw RGBC sample.
+ *
+ * @return 1 if the mode changed and the sensor timing must be reprogrammed, 0 otherwise.
+ */
+uint8_t Adaptive_Rate_Update(Adaptive_Rate_Controller *controller, PMOD_Color_Data sample);
+
+/**
+ * @brief Scales a raw sample taken in the current mode to the integration time of the burst mode.
+ *
+ * This keeps the counts comparable across modes, so that calibration and classification
+ * do not depend on the current integration time.
+ *
+ * @param controller Pointer to the controller.
+ * @param sample     The raw RGBC sample.
+ *
+ * @return The scaled sample.
+ */
+PMOD_Color_Data Adaptive_Rate_Normalize(const Adaptive_Rate_Controller *controller, PMOD_Color_Data sample);
+
+/**
+ * @brief Returns the current mode.
+ */
+Adaptive_Rate_Mode Adaptive_Rate_Get_Mode(const Adaptive_Rate_Controller *controller);
+
+/**
+ * @brief Returns the integration time of the current mode in microseconds.
+ */
+uint32_t Adaptive_Rate_Get_Integration_us(const Adaptive_Rate_Controller *controller);
+
+/**
+ * @brief Returns the wait time of the current mode in microseconds.
+ */
+uint32_t Adaptive_Rate_Get_Wait_us(const Adaptive_Rate_Controller *controller);
+
+/**
+ * @brief Returns the conversion period (integration time plus wait time) of the current mode in microseconds.
+ */
+uint32_t Adaptive_Rate_Get_Period_us(const Adaptive_Rate_Controller *controller);
+
+/**
+ * @brief Estimates the sensor energy used so far and the energy a fixed-rate loop would have used.
+ *
+ * The fixed-rate reference keeps the sensor integrating continuously, as the original 50 ms loop does.
+ *
+ * @param controller  Pointer to the controller.
+ * @param adaptive_uJ Pointer that receives the energy used with adaptive sampling in microjoules.
+ * @param fixed_uJ    Pointer that receives the energy of the fixed-rate reference in microjoules.
+ *
+ * @return None
+ */
+void Adaptive_Rate_Get_Energy(const Adaptive_Rate_Controller *controller, uint32_t *adaptive_uJ, uint32_t *fixed_uJ);
+
+/**
+ * @brief Prints the rate distribution and the energy estimate with printf.
+ *
+ * @param controller Pointer to the controller.
+ *
+ * @return None
+ */
+void Adaptive_Rate_Print_Stats(const Adaptive_Rate_Controller *controller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ADAPTIVE_RATE_H_ */
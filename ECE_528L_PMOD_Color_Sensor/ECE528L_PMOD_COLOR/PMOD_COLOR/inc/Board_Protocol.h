@@ -0,0 +1,255 @@
+/**
+ * @file Board_Protocol.h
+ * @brief Header file for the Board_Protocol module.
+ *
+ * This file contains the definitions of the binary frames that a board can send to the host next to
+ * the text output of printf, and the functions that encode them. The host SDK (host_tools/Board_Decoder.h)
+ * decodes both the frames and the legacy text lines, so a board may mix the two on the same UART.
+ *
+ * A frame is delimited by a 0x00 byte on each side, and its content is COBS encoded so that it never
+ * contains 0x00. Text lines never contain 0x00 either, so the host can tell frames and text apart.
+ * Before COBS encoding, a frame is:
+ *
+ *   type (1 byte) | sequence (1 byte) | body (0 to BOARD_PROTOCOL_MAX_BODY bytes) | CRC-16 (2 bytes)
+ *
+ * The sequence number is incremented by the sender for every frame, so that the host can count lost
+ * frames. The modules of a board that send frames take their numbers from Board_Protocol_Next_Sequence,
+ * so that their frames form one sequence. The CRC is CRC-16/CCITT-FALSE over the type, sequence and body. Multi-byte fields are
+ * little-endian.
+ *
+ * The module has no dependency on the hardware, so the host tools use the same encoder.
+ *
+ */
+
+#ifndef INC_BOARD_PROTOCOL_H_
+#define INC_BOARD_PROTOCOL_H_
+
+#include <stdint.h>
+#include "PMOD_Color.h"
+#include "Reaction_Stats.h"
+#include "Color_Classifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frame delimiter
+#define BOARD_PROTOCOL_DELIMITER                0x00
+
+// Largest body, and largest encoded frame including both delimiters
+#define BOARD_PROTOCOL_MAX_BODY                 64
+#define BOARD_PROTOCOL_MAX_FRAME                (BOARD_PROTOCOL_MAX_BODY + 8)
+
+// Frame types
+#define BOARD_PROTOCOL_SAMPLE                   0x01    // time_ms (u32), red, green, blue, clear (u16)
+#define BOARD_PROTOCOL_DETECTION                0x02    // color (u8, Color_t)
+#define BOARD_PROTOCOL_GAME                     0x03    // result (u8, SIMON_GAME_WRONG, _STEP, _COMPLETE or _MISS)
+#define BOARD_PROTOCOL_RATE_STATS               0x04    // idle_samples, idle_ms, burst_samples, burst_ms, bursts,
+                                                        // adaptive_uJ, fixed_uJ, total_ms (u32)
+#define BOARD_PROTOCOL_REACTION                 0x05    // step (u8), since_start_ms, reaction_ms, pipeline_ms (u32)
+#define BOARD_PROTOCOL_REACTION_STATS           0x06    // steps (u32), reaction_mean_ms, reaction_p50_ms, reaction_p90_ms,
+                                                        // pipeline_mean_ms, pipeline_p90_ms, rounds, fails, misses (u16),
+                                                        // round_mean_ms, best_round_ms (u32)
+#define BOARD_PROTOCOL_PC_SAMPLES               0x07    // flags (u8, BOARD_PROTOCOL_PC_SAMPLES_LR), dropped (u16),
+                                                        // then count PCs, or count PC and LR pairs (u32)
+#define BOARD_PROTOCOL_I2C_TRACE                0x08    // dropped (u16), then count transfers of start_us (u32),
+                                                        // duration_us (u16), address, write_length, read_length (u8),
+                                                        // status (i8, I2C_BUS_OK or an I2C_BUS_ERROR code)
+#define BOARD_PROTOCOL_SUMMARY                  0x09    // start_ms (u32), window_ms, samples, raw_samples (u16),
+                                                        // then min, max, mean (u16) and variance (u32) of red,
+                                                        // green, blue and clear, then count of each Color_t (u16)
+
+// Body sizes of the frame types
+#define BOARD_PROTOCOL_SAMPLE_SIZE              12
+#define BOARD_PROTOCOL_DETECTION_SIZE           1
+#define BOARD_PROTOCOL_GAME_SIZE                1
+#define BOARD_PROTOCOL_RATE_STATS_SIZE          32
+#define BOARD_PROTOCOL_REACTION_SIZE            13
+#define BOARD_PROTOCOL_REACTION_STATS_SIZE      28
+#define BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE   3
+#define BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE    2
+#define BOARD_PROTOCOL_I2C_TRANSFER_SIZE        10
+#define BOARD_PROTOCOL_SUMMARY_SIZE             58
+
+// Channels of a SUMMARY frame, in this order: red, green, blue and clear; and the colors it counts
+#define BOARD_PROTOCOL_SUMMARY_CHANNELS         4
+#define BOARD_PROTOCOL_SUMMARY_CLASSES          COLOR_CLASSIFIER_NUM_COLORS
+
+// Flag of a PC_SAMPLES frame whose samples carry the LR, and the most samples in a frame without and with it
+#define BOARD_PROTOCOL_PC_SAMPLES_LR            0x01
+#define BOARD_PROTOCOL_PC_SAMPLES_MAX           7
+#define BOARD_PROTOCOL_PC_SAMPLES_MAX_LR        3
+
+// Most transfers in an I2C_TRACE frame
+#define BOARD_PROTOCOL_I2C_TRACE_MAX            3
+
+typedef struct
+{
+    uint32_t idle_samples;
+    uint32_t idle_ms;
+    uint32_t burst_samples;
+    uint32_t burst_ms;
+    uint32_t bursts;
+    uint32_t adaptive_uJ;
+    uint32_t fixed_uJ;
+    uint32_t total_ms;
+} Board_Protocol_Rate_Stats;
+
+typedef struct
+{
+    uint8_t count;
+    uint8_t has_lr;
+
+    // Samples that the board dropped before the first one of the frame, because its buffer was full
+    uint16_t dropped;
+
+    // Stacked PC of each sample, and its stacked LR when has_lr is set
+    uint32_t pc[BOARD_PROTOCOL_PC_SAMPLES_MAX];
+    uint32_t lr[BOARD_PROTOCOL_PC_SAMPLES_MAX];
+} Board_Protocol_PC_Samples;
+
+typedef struct
+{
+    // Start in microseconds since the trace started (wraps after 71 minutes) and duration, saturated
+    uint32_t start_us;
+    uint16_t duration_us;
+    uint8_t address;
+
+    // Bytes written and read by the messages of the transfer, saturated at 255
+    uint8_t write_length;
+    uint8_t read_length;
+    int8_t status;
+} Board_Protocol_I2C_Transfer;
+
+typedef struct
+{
+    uint8_t count;
+
+    // Transfers that the board dropped before the first one of the frame, because its buffer was full
+    uint16_t dropped;
+
+    Board_Protocol_I2C_Transfer transfers[BOARD_PROTOCOL_I2C_TRACE_MAX];
+} Board_Protocol_I2C_Trace;
+
+typedef struct
+{
+    // Start of the window in board time, its length, the samples in it, and those also sent as SAMPLE frames
+    uint32_t start_ms;
+    uint16_t window_ms;
+    uint16_t samples;
+    uint16_t raw_samples;
+
+    // Statistics of each channel over the samples of the window: the mean is rounded, and the variance
+    // is the population variance, rounded down
+    uint16_t min[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint16_t max[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint16_t mean[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint32_t variance[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+
+    // Samples classified as each color, indexed by Color_t
+    uint16_t classes[BOARD_PROTOCOL_SUMMARY_CLASSES];
+} Board_Protocol_Summary;
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of a buffer.
+ *
+ * @param data   Pointer to the data.
+ * @param length Number of bytes.
+ *
+ * @return The CRC.
+ */
+uint16_t Board_Protocol_CRC16(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Returns the sequence number of the next frame of the board, and increments it.
+ *
+ * The main program only: the frames of the board are all sent from it.
+ *
+ * @return The sequence number.
+ */
+uint8_t Board_Protocol_Next_Sequence(void);
+
+/**
+ * @brief Encodes a frame, including both delimiters.
+ *
+ * @param type     The frame type.
+ * @param sequence The sequence number of the frame.
+ * @param body     Pointer to the body.
+ * @param length   Length of the body (at most BOARD_PROTOCOL_MAX_BODY).
+ * @param frame    Output buffer.
+ * @param capacity Size of the output buffer (BOARD_PROTOCOL_MAX_FRAME is always enough).
+ *
+ * @return The length of the encoded frame, or -1 if the body or the output buffer is too large or too small.
+ */
+int Board_Protocol_Encode(uint8_t type, uint8_t sequence, const uint8_t *body, uint8_t length, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_SAMPLE frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Sample(uint8_t sequence, uint32_t time_ms, const PMOD_Color_Data *data, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_DETECTION frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Detection(uint8_t sequence, uint8_t color, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_GAME frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Game(uint8_t sequence, uint8_t result, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_RATE_STATS frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Rate_Stats(uint8_t sequence, const Board_Protocol_Rate_Stats *stats, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_REACTION frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Reaction(uint8_t sequence, const Reaction_Step *step, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_REACTION_STATS frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Reaction_Stats(uint8_t sequence, const Reaction_Summary *summary, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_PC_SAMPLES frame.
+ *
+ * @return The length of the encoded frame, or -1 on error, including more than BOARD_PROTOCOL_PC_SAMPLES_MAX
+ *         samples, or BOARD_PROTOCOL_PC_SAMPLES_MAX_LR with the LR.
+ */
+int Board_Protocol_Encode_PC_Samples(uint8_t sequence, const Board_Protocol_PC_Samples *samples, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_I2C_TRACE frame.
+ *
+ * @return The length of the encoded frame, or -1 on error, including more than BOARD_PROTOCOL_I2C_TRACE_MAX
+ *         transfers.
+ */
+int Board_Protocol_Encode_I2C_Trace(uint8_t sequence, const Board_Protocol_I2C_Trace *trace, uint8_t *frame, uint16_t capacity);
+
+/**
+ * @brief Encodes a BOARD_PROTOCOL_SUMMARY frame.
+ *
+ * @return The length of the encoded frame, or -1 on error.
+ */
+int Board_Protocol_Encode_Summary(uint8_t sequence, const Board_Protocol_Summary *summary, uint8_t *frame, uint16_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BOARD_PROTOCOL_H_ */
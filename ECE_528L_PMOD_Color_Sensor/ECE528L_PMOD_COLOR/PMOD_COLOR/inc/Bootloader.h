@@ -0,0 +1,235 @@
+/**
+ * @file Bootloader.h
+ * @brief Header file for the Bootloader module.
+ *
+ * This file contains the definitions for the protocol core of the UART bootloader. The core receives
+ * packets one byte at a time, executes their commands on the main flash and sends the responses
+ * through a backend, so that the same code runs on the MSP432 (Bootloader_MSP432) and against an
+ * emulated flash on a host computer (Bootloader_Sim).
+ *
+ * The main flash is split in three parts:
+ *
+ *   0x00000 - 0x01FFF   the resident bootloader, with its own vector table and reset entry
+ *   0x02000 - 0x02FFF   the application header, in the first flash word of the sector
+ *   0x03000 - ...       the application, which starts with its vector table
+ *
+ * The header holds a magic number, the length of the application and its CRC-32 (u32 each). After
+ * every reset, the bootloader checks the application against the header (Bootloader_Application_Valid)
+ * and only starts a valid one. ERASE and PROGRAM refuse the sectors of the bootloader.
+ *
+ * A packet, in both directions, is framed like the packets of the TI MSP432 BSL:
+ *
+ *   0x80 | length (u16) | payload (length bytes) | CRC-16 of the payload (u16)
+ *
+ * The CRC is CRC-16/CCITT-FALSE and multi-byte fields are little-endian. The first byte of a request
+ * payload is the command. The response payload is the command, a status (int8, BOOTLOADER_OK or a
+ * negative BOOTLOADER_ERROR code) and the data of the command:
+ *
+ *   INFO          -                                 version, flash size, sector size, max data,
+ *                                                   application address (u32)
+ *   SECTOR_CRCS   first sector, count (u16)         count (u16), CRC-32 of each sector (u32)
+ *   ERASE         address (u32)                     -
+ *   PROGRAM       address (u32), data               -
+ *   VERIFY        length (u32), CRC-32 (u32)        CRC-32 of the application (u32)
+ *   RUN           -                                 -
+ *   SET_BAUD      baud rate (u32)                   -
+ *
+ * Commands are idempotent, so the host simply repeats a request whose response was lost. Flash is
+ * written in sectors: the host compares the CRC-32 of each sector with its new image and only erases
+ * and programs the sectors that differ. The host erases the header sector before anything else and
+ * programs the header last, once VERIFY has succeeded, so an interrupted update leaves no valid
+ * header. RUN resets the board only when the application is valid, like the check at reset.
+ *
+ * A SET_BAUD is acknowledged at the current baud rate. If no valid packet arrives at the new rate
+ * within BOOTLOADER_BAUD_PROBATION_IDLES idle periods, the previous rate is restored.
+ *
+ * On the MSP432, the core and the backend are linked into the resident bootloader image, and they run
+ * from SRAM (.TI.ramfunc) so that nothing executes from flash bank 0 while it is erased or programmed
+ * (see Bootloader_MSP432.h).
+ *
+ */
+
+#ifndef INC_BOOTLOADER_H_
+#define INC_BOOTLOADER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Places a function in SRAM on the MSP432; the host build ignores it
+#if defined(__TI_COMPILER_VERSION__)
+#define BOOTLOADER_RAMFUNC                      __attribute__((ramfunc))
+#else
+#define BOOTLOADER_RAMFUNC
+#endif
+
+// Protocol version reported by INFO
+#define BOOTLOADER_VERSION                      2
+
+// Flash layout: the resident bootloader sectors, the application header sector and the application
+#define BOOTLOADER_RESIDENT_SIZE                0x00002000
+#define BOOTLOADER_APP_HEADER_ADDRESS           0x00002000
+#define BOOTLOADER_APP_ADDRESS                  0x00003000
+
+// Application header: magic ("APPL"), length and CRC-32 of the application, in one flash word
+#define BOOTLOADER_APP_MAGIC                    0x4C505041
+#define BOOTLOADER_APP_HEADER_SIZE              16
+
+// Packet header byte
+#define BOOTLOADER_HEADER                       0x80
+
+// Byte sent continuously by the host to request the bootloader from a running application
+#define BOOTLOADER_ENTER_BYTE                   0xB0
+
+// Largest PROGRAM data, and its alignment (one 128-bit flash word)
+#define BOOTLOADER_MAX_DATA                     1024
+#define BOOTLOADER_PROGRAM_ALIGN                16
+
+// Largest request and response payloads
+#define BOOTLOADER_MAX_PAYLOAD                  (BOOTLOADER_MAX_DATA + 5)
+#define BOOTLOADER_MAX_SECTOR_CRCS              64
+#define BOOTLOADER_MAX_RESPONSE                 (4 + 4 * BOOTLOADER_MAX_SECTOR_CRCS)
+#define BOOTLOADER_INFO_LENGTH                  20
+
+// Bytes added to a payload by the framing: header, length and CRC
+#define BOOTLOADER_FRAMING                      5
+
+// Range of SET_BAUD, and the idle periods allowed at a new rate before it is abandoned
+#define BOOTLOADER_MIN_BAUD                     9600
+#define BOOTLOADER_MAX_BAUD                     1500000
+#define BOOTLOADER_BAUD_PROBATION_IDLES         20
+
+// Commands
+#define BOOTLOADER_CMD_INFO                     0x01
+#define BOOTLOADER_CMD_SECTOR_CRCS              0x02
+#define BOOTLOADER_CMD_ERASE                    0x03
+#define BOOTLOADER_CMD_PROGRAM                  0x04
+#define BOOTLOADER_CMD_VERIFY                   0x05
+#define BOOTLOADER_CMD_RUN                      0x06
+#define BOOTLOADER_CMD_SET_BAUD                 0x07
+
+// Status codes
+#define BOOTLOADER_OK                           0
+#define BOOTLOADER_ERROR_CRC                    -1
+#define BOOTLOADER_ERROR_INVALID                -2
+#define BOOTLOADER_ERROR_ADDRESS                -3
+#define BOOTLOADER_ERROR_FLASH                  -4
+#define BOOTLOADER_ERROR_VERIFY                 -5
+#define BOOTLOADER_ERROR_NOT_VERIFIED           -6
+
+typedef struct
+{
+    // Erases the sector that starts at address, so that it reads 0xFF
+    int (*erase_sector)(void *context, uint32_t address);
+
+    // Programs length bytes (a multiple of BOOTLOADER_PROGRAM_ALIGN) at an aligned address
+    int (*program)(void *context, uint32_t address, const uint8_t *data, uint32_t length);
+
+    // Sends bytes to the host and returns when they have been transmitted
+    void (*send)(void *context, const uint8_t *data, uint32_t length);
+
+    // Changes the baud rate of the link
+    void (*set_baud)(void *context, uint32_t baud);
+
+    // Resets the board, which starts the application if it is valid; does not return on the MSP432
+    void (*reset)(void *context);
+} Bootloader_Ops;
+
+typedef struct
+{
+    // Backend operations and backend-specific state
+    const Bootloader_Ops *ops;
+    void *context;
+
+    // Main flash, read directly for the CRCs
+    const uint8_t *flash;
+    uint32_t flash_size;
+    uint32_t sector_size;
+
+    // Packet receiver
+    uint8_t state;
+    uint16_t length;
+    uint16_t index;
+    uint16_t crc;
+    uint8_t packet[BOOTLOADER_MAX_PAYLOAD];
+    uint8_t response[BOOTLOADER_MAX_RESPONSE + BOOTLOADER_FRAMING];
+
+    // Baud rate change that has not been confirmed by a valid packet yet
+    uint32_t baud;
+    uint32_t previous_baud;
+    uint8_t probation_idles;
+
+    // Activity counters
+    uint32_t packet_count;
+    uint32_t crc_error_count;
+    uint32_t erase_count;
+    uint32_t program_count;
+    uint32_t checked_byte_count;        // Flash bytes read for SECTOR_CRCS, VERIFY and RUN
+} Bootloader;
+
+/**
+ * @brief Initializes the protocol core.
+ *
+ * @param bootloader  Pointer to the bootloader state.
+ * @param ops         Backend operations.
+ * @param context     Backend-specific state passed to the operations.
+ * @param flash       Pointer to the first byte of the main flash.
+ * @param flash_size  Size of the main flash in bytes.
+ * @param sector_size Size of an erase sector in bytes.
+ * @param baud        Current baud rate of the link.
+ *
+ * @return None
+ */
+void Bootloader_Init(Bootloader *bootloader, const Bootloader_Ops *ops, void *context,
+                     const uint8_t *flash, uint32_t flash_size, uint32_t sector_size, uint32_t baud);
+
+/**
+ * @brief Processes one received byte. A complete packet is executed and answered before returning.
+ *
+ * @param bootloader Pointer to the bootloader state.
+ * @param byte       The received byte.
+ *
+ * @return None
+ */
+void Bootloader_Receive_Byte(Bootloader *bootloader, uint8_t byte);
+
+/**
+ * @brief Reports that the link has been idle for one idle period (100 ms on the MSP432).
+ *
+ * A partial packet is abandoned, so that the receiver resynchronizes on the next header, and a
+ * baud rate change that is not confirmed in time is reverted.
+ *
+ * @param bootloader Pointer to the bootloader state.
+ *
+ * @return None
+ */
+void Bootloader_Idle(Bootloader *bootloader);
+
+/**
+ * @brief Checks the application against its header: the magic number, a length that fits in the flash
+ *        and the CRC-32 of the application.
+ *
+ * @param flash      Pointer to the first byte of the main flash.
+ * @param flash_size Size of the main flash in bytes.
+ *
+ * @return 1 if the application may be started, otherwise 0.
+ */
+uint8_t Bootloader_Application_Valid(const uint8_t *flash, uint32_t flash_size);
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE of a buffer (packet CRC).
+ */
+uint16_t Bootloader_CRC16(const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Updates a CRC-32 (IEEE 802.3) with a buffer. Start with crc = 0.
+ */
+uint32_t Bootloader_CRC32(uint32_t crc, const uint8_t *data, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BOOTLOADER_H_ */
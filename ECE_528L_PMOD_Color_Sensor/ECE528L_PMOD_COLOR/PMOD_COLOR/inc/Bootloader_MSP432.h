@@ -0,0 +1,83 @@
+/**
+ * @file Bootloader_MSP432.h
+ * @brief Header file for the Bootloader_MSP432 backend.
+ *
+ * This file contains the function definitions for running the UART bootloader (see Bootloader.h)
+ * on the MSP432P401R, with the flash controller (FLCTL) and EUSCI_A0 on pins P1.2 and P1.3.
+ *
+ * The bootloader is a resident image in sectors 0 and 1 of the main flash, built by the
+ * PMOD_COLOR_BOOT project with its own linker command file (msp432p401r_boot.cmd) and its own vector
+ * table, so it owns the reset vector. The application is linked by msp432p401r.cmd to start at
+ * BOOTLOADER_APP_ADDRESS. After every reset, Bootloader_MSP432_Start listens on EUSCI_A0 for
+ * BOOTLOADER_MSP432_WINDOW_MS. If the host updater has not requested the bootloader by then and the
+ * application passes Bootloader_Application_Valid, it jumps to the application. Otherwise the LED
+ * turns blue and the board serves the bootloader protocol until RUN resets it.
+ *
+ * The host updater (host_tools/boot_update.cpp) requests the bootloader by sending
+ * BOOTLOADER_ENTER_BYTE continuously. A running application passes each byte it receives from the
+ * host to Bootloader_MSP432_Enter_Byte (main.c does it in Check_Host_Input). Once
+ * BOOTLOADER_MSP432_ENTER_COUNT of them have been received in a row, it calls Bootloader_MSP432_Restart,
+ * and the bootloader sees the requests that follow the reset. A board whose update was interrupted
+ * stays in the bootloader, and one whose application never calls Check_Host_Input enters it when it
+ * is reset while the updater runs.
+ *
+ * The protocol loop, the flash and UART functions and the protocol core execute from SRAM, so that
+ * nothing is read from flash bank 0 while one of its sectors is erased or programmed. No interrupt is
+ * enabled, and the SysTick counter is polled to detect idle periods. Sectors 0 and 1 keep the
+ * write/erase protection they have after a reset, and the protocol core refuses to erase or program
+ * them.
+ *
+ */
+
+#ifndef INC_BOOTLOADER_MSP432_H_
+#define INC_BOOTLOADER_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "Bootloader.h"
+
+// Main flash of the MSP432P401R
+#define BOOTLOADER_MSP432_FLASH_SIZE            0x00040000
+#define BOOTLOADER_MSP432_BANK_SIZE             0x00020000
+#define BOOTLOADER_MSP432_SECTOR_SIZE           0x00001000
+
+// Number of consecutive received bytes that must be BOOTLOADER_ENTER_BYTE
+#define BOOTLOADER_MSP432_ENTER_COUNT           3
+
+// Baud rate after a reset, and the DCO frequency of MCLK and SMCLK, which drives EUSCI_A0, in the bootloader
+#define BOOTLOADER_MSP432_DEFAULT_BAUD          115200
+#define BOOTLOADER_MSP432_SMCLK_HZ              12000000
+
+// Milliseconds without a received byte that make one idle period (see Bootloader_Idle)
+#define BOOTLOADER_MSP432_IDLE_MS               100
+
+// Milliseconds after a reset in which a request of the host updater keeps the board in the bootloader.
+// The updater waits up to 100 ms for a response between two bursts of requests.
+#define BOOTLOADER_MSP432_WINDOW_MS             250
+
+/**
+ * @brief Counts one byte received from the host towards the request of the host updater.
+ *
+ * @param byte The received byte.
+ *
+ * @return 1 when the bootloader has been requested, otherwise 0.
+ */
+uint8_t Bootloader_MSP432_Enter_Byte(uint8_t byte);
+
+/**
+ * @brief Resets the board for a request of the host updater, so that the resident bootloader stays
+ *        in the protocol. Called by the application; does not return.
+ *
+ * @return None
+ */
+void Bootloader_MSP432_Restart(void);
+
+/**
+ * @brief Entry of the resident bootloader, called by main() of PMOD_COLOR_BOOT after each reset.
+ *        Jumps to the application when it is valid and not requested otherwise; does not return.
+ *
+ * @return None
+ */
+void Bootloader_MSP432_Start(void);
+
+#endif /* INC_BOOTLOADER_MSP432_H_ */
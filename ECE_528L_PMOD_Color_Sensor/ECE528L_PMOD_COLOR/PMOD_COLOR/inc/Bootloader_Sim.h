@@ -0,0 +1,154 @@
+/**
+ * @file Bootloader_Sim.h
+ * @brief Header file for the Bootloader_Sim backend.
+ *
+ * This file contains the function definitions for running the UART bootloader (see Bootloader.h)
+ * against an emulated flash on a host computer, so that the host updater can be tested without a board.
+ *
+ * The emulated flash has the geometry of the MSP432P401R main flash and behaves like NOR flash:
+ * an erase sets a whole sector to 0xFF, and programming can only clear bits, so programming a
+ * location twice without an erase leaves the AND of both values. The bytes sent by the bootloader
+ * are queued until the host reads them, and the erases and programmed flash words are counted for
+ * timing models.
+ *
+ * The emulated board follows the reset path of Bootloader_MSP432_Start: after a reset, it runs the
+ * application if the application is valid and the host did not request the bootloader, and stays in
+ * the bootloader otherwise. The running application only watches for the request of the host
+ * updater, like Check_Host_Input in main.c, and resets into the bootloader when it sees it. The
+ * sectors of the resident bootloader hold a stand-in pattern and refuse erases and programs, like
+ * the write/erase protection of the MSP432.
+ *
+ * A power failure can be scheduled at any erase or programmed flash word of an update: that
+ * operation is torn (half of the sector is erased, or half of the flash word is programmed), and the
+ * board is off until the next reset.
+ *
+ */
+
+#ifndef INC_BOOTLOADER_SIM_H_
+#define INC_BOOTLOADER_SIM_H_
+
+#include <stdint.h>
+#include "Bootloader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Geometry of the emulated flash (the MSP432P401R main flash)
+#define BOOTLOADER_SIM_FLASH_SIZE               0x00040000
+#define BOOTLOADER_SIM_SECTOR_SIZE              0x00001000
+#define BOOTLOADER_SIM_SECTORS                  (BOOTLOADER_SIM_FLASH_SIZE / BOOTLOADER_SIM_SECTOR_SIZE)
+
+// Bytes sent by the bootloader that can wait for the host
+#define BOOTLOADER_SIM_OUTPUT_CAPACITY          4096
+
+// Consecutive BOOTLOADER_ENTER_BYTE that the application needs, as on the MSP432
+#define BOOTLOADER_SIM_ENTER_COUNT              3
+
+// What the emulated board runs
+#define BOOTLOADER_SIM_STATE_BOOTLOADER         0
+#define BOOTLOADER_SIM_STATE_APPLICATION        1
+#define BOOTLOADER_SIM_STATE_OFF                2
+
+typedef struct
+{
+    uint8_t flash[BOOTLOADER_SIM_FLASH_SIZE];
+
+    // Bytes sent by the bootloader and not read yet
+    uint8_t output[BOOTLOADER_SIM_OUTPUT_CAPACITY];
+    uint32_t output_length;
+    uint32_t output_overflow_count;
+
+    // Board state, and the baud rate of the link after a reset
+    uint8_t state;
+    uint8_t reset_requested;
+    uint8_t enter_count;
+    uint32_t baud;
+    uint32_t reset_baud;
+    uint32_t reset_count;
+
+    // Flash operations left before the scheduled power failure, or 0 for none
+    uint32_t power_fail_countdown;
+
+    // Flash activity: erases per sector, programmed 128-bit flash words, and refused operations on the
+    // sectors of the bootloader
+    uint32_t sector_erase_count[BOOTLOADER_SIM_SECTORS];
+    uint32_t erase_count;
+    uint32_t program_word_count;
+    uint32_t protected_write_count;
+} Bootloader_Sim_Context;
+
+/**
+ * @brief Initializes a board whose application sectors are erased. The board is in the bootloader.
+ *
+ * @param bootloader Pointer to the bootloader state.
+ * @param context    Pointer to the emulated board, which must stay valid while the bootloader is in use.
+ * @param baud       Baud rate of the link after a reset.
+ *
+ * @return None
+ */
+void Bootloader_Sim_Init(Bootloader *bootloader, Bootloader_Sim_Context *context, uint32_t baud);
+
+/**
+ * @brief Installs an application as a completed update does, without counting erases or programs:
+ *        the image at BOOTLOADER_APP_ADDRESS and a valid header. The rest of the flash after the
+ *        bootloader is erased. Call Bootloader_Sim_Reset to start it.
+ *
+ * @param context Pointer to the emulated board.
+ * @param image   The application image.
+ * @param length  Length of the image (at most BOOTLOADER_SIM_FLASH_SIZE - BOOTLOADER_APP_ADDRESS).
+ *
+ * @return None
+ */
+void Bootloader_Sim_Load(Bootloader_Sim_Context *context, const uint8_t *image, uint32_t length);
+
+/**
+ * @brief Resets the board, which also restores the power after a power failure. The application is
+ *        started if it is valid and not requested is 0; otherwise the bootloader is initialized.
+ *
+ * @param bootloader Pointer to the bootloader state.
+ * @param context    Pointer to the emulated board.
+ * @param requested  1 if the host updater requests the bootloader during the reset.
+ *
+ * @return None
+ */
+void Bootloader_Sim_Reset(Bootloader *bootloader, Bootloader_Sim_Context *context, uint8_t requested);
+
+/**
+ * @brief Delivers a byte received from the host to what the board runs. A board that is off loses it.
+ *        A reset requested by RUN or by the application happens before returning.
+ *
+ * @param bootloader Pointer to the bootloader state.
+ * @param context    Pointer to the emulated board.
+ * @param byte       The received byte.
+ *
+ * @return None
+ */
+void Bootloader_Sim_Receive_Byte(Bootloader *bootloader, Bootloader_Sim_Context *context, uint8_t byte);
+
+/**
+ * @brief Schedules a power failure during a later flash operation.
+ *
+ * @param context    Pointer to the emulated board.
+ * @param operations Erases and programmed flash words until the failure: 1 tears the next one.
+ *
+ * @return None
+ */
+void Bootloader_Sim_Power_Fail(Bootloader_Sim_Context *context, uint32_t operations);
+
+/**
+ * @brief Removes and returns the bytes sent by the bootloader.
+ *
+ * @param context  Pointer to the emulated board.
+ * @param data     Buffer that receives the bytes.
+ * @param capacity Size of the buffer.
+ *
+ * @return The number of bytes copied.
+ */
+uint32_t Bootloader_Sim_Read_Output(Bootloader_Sim_Context *context, uint8_t *data, uint32_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BOOTLOADER_SIM_H_ */
@@ -0,0 +1,169 @@
+/**
+ * @file Bumper_Switches.h
+ * @brief Header file for the Bumper_Switches module.
+ *
+ * This file contains the function definitions for the interrupt-driven bumper switches of the
+ * TI-RSLK chassis. The six switches raise an edge interrupt, so a collision is handled as soon as
+ * it happens instead of at the next poll of the main loop, which can be seconds away during the
+ * motor animations of the game.
+ *
+ * Edges: each switch interrupts on its next change only. A closed switch waits for the opening edge,
+ * and an open switch for the closing edge. After reselecting the edges, the interrupt handler reads
+ * the switches again, so a change during the reconfiguration is not lost.
+ *
+ * Collisions: the interrupt handler of the backend disables the motors before it calls
+ * Bumper_Switches_Handle_Interrupt. A collision is posted when a switch closes after all of them were
+ * open for at least the debounce time. A closing within the debounce time is a bounce, which is
+ * counted but not posted again. The collision stays set until the program acknowledges it after all
+ * switches are open, and Bumper_Switches_Drive does not start the motors while it is set.
+ *
+ * The backend provides the switches, the edge selection, the time and a lock against the interrupt,
+ * so that the same code runs on the MSP432 (Bumper_Switches_MSP432, Port 4) and on a host computer
+ * with simulated pin edges (Bumper_Switches_Sim).
+ *
+ */
+
+#ifndef INC_BUMPER_SWITCHES_H_
+#define INC_BUMPER_SWITCHES_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of switches, and the mask of their bits (bit 0 = BUMP0, the rightmost switch)
+#define BUMPER_SWITCHES_COUNT                   6
+#define BUMPER_SWITCHES_ALL                     0x3F
+
+// Time all switches must stay open before a new closing counts as a new collision
+#define BUMPER_SWITCHES_DEBOUNCE_MS             20
+
+// Called from the interrupt when a collision is posted, with the closed switches
+typedef void (*Bumper_Switches_Callback)(uint8_t switches, void *context);
+
+typedef struct
+{
+    // Returns the closed switches, one bit per switch
+    uint8_t (*read)(void *context);
+
+    // Selects the interrupt edge of each switch (opening for the closed switches, closing for the
+    // others) and clears the edge flags, including the ones raised by the new selection
+    void (*watch)(void *context, uint8_t closed);
+
+    // Free-running time in milliseconds
+    uint32_t (*now_ms)(void *context);
+
+    // Masks the switch interrupt and returns the previous state, which unlock restores
+    uint32_t (*lock)(void *context);
+    void (*unlock)(void *context, uint32_t state);
+} Bumper_Switches_Ops;
+
+typedef struct
+{
+    // Closed switches of the collision, and the time it was posted
+    uint8_t switches;
+    uint32_t time_ms;
+} Bumper_Switches_Event;
+
+typedef struct
+{
+    // Backend operations and backend-specific state
+    const Bumper_Switches_Ops *ops;
+    void *context;
+    uint32_t debounce_ms;
+
+    // Called from the interrupt for each posted collision (may be NULL)
+    Bumper_Switches_Callback callback;
+    void *callback_context;
+
+    // Switches closed at the last interrupt, and the time they were last all opened
+    volatile uint8_t closed;
+    uint8_t opened_valid;
+    uint32_t opened_ms;
+
+    // Set with a collision until Bumper_Switches_Acknowledge, and the event not taken yet
+    volatile uint8_t collision;
+    volatile uint8_t event_pending;
+    Bumper_Switches_Event event;
+
+    // Statistics: interrupts, posted collisions and bounces
+    uint32_t interrupts;
+    uint32_t collisions;
+    uint32_t bounces;
+} Bumper_Switches;
+
+/**
+ * @brief Initializes the module on a backend and selects the edges. Called by the Init function of
+ *        the backend. A switch already closed is posted as a collision.
+ *
+ * @param bumpers          Pointer to the module.
+ * @param ops              Backend operations.
+ * @param context          Backend-specific state passed to the operations.
+ * @param debounce_ms      Time all switches must stay open before a new collision.
+ * @param callback         Called from the interrupt for each collision (may be NULL).
+ * @param callback_context Passed to the callback.
+ *
+ * @return None
+ */
+void Bumper_Switches_Init(Bumper_Switches *bumpers, const Bumper_Switches_Ops *ops, void *context, uint32_t debounce_ms,
+                          Bumper_Switches_Callback callback, void *callback_context);
+
+/**
+ * @brief Reads the switches and reselects their edges. Called by the interrupt handler of the
+ *        backend after it has disabled the motors.
+ *
+ * @param bumpers Pointer to the module.
+ *
+ * @return None
+ */
+void Bumper_Switches_Handle_Interrupt(Bumper_Switches *bumpers);
+
+/**
+ * @brief Takes the collision posted since the last call, if any.
+ *
+ * @param bumpers Pointer to the module.
+ * @param event   Receives the collision. Switches that closed after it was posted and before it was
+ *                taken are added to it.
+ *
+ * @return 1 if a collision was taken, 0 otherwise.
+ */
+uint8_t Bumper_Switches_Take_Event(Bumper_Switches *bumpers, Bumper_Switches_Event *event);
+
+/**
+ * @brief Clears the collision once all switches are open, so that the motors can be started again.
+ *
+ * @param bumpers Pointer to the module.
+ *
+ * @return 1 if no collision is set anymore, 0 while a switch is still closed.
+ */
+uint8_t Bumper_Switches_Acknowledge(Bumper_Switches *bumpers);
+
+/**
+ * @brief Starts the motors with one of the Motor functions, unless a collision is set or a switch is
+ *        closed. The check and the start are done with the interrupt masked, so a collision cannot
+ *        be missed between them.
+ *
+ * @param bumpers          Pointer to the module.
+ * @param move             Motor function, such as Motor_Forward.
+ * @param left_duty_cycle  The duty cycle for the left motor.
+ * @param right_duty_cycle The duty cycle for the right motor.
+ *
+ * @return 1 if the motors were started, 0 otherwise.
+ */
+uint8_t Bumper_Switches_Drive(Bumper_Switches *bumpers, void (*move)(uint16_t, uint16_t), uint16_t left_duty_cycle, uint16_t right_duty_cycle);
+
+/**
+ * @brief Prints the interrupt, collision and bounce counts with printf, on a line starting with "bumper:".
+ *
+ * @param bumpers Pointer to the module.
+ *
+ * @return None
+ */
+void Bumper_Switches_Print_Stats(const Bumper_Switches *bumpers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUMPER_SWITCHES_H_ */
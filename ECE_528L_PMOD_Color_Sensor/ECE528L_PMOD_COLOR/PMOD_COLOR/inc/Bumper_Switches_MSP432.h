@@ -0,0 +1,91 @@
+/**
+ * @file Bumper_Switches_MSP432.h
+ * @brief Header file for the Bumper_Switches_MSP432 backend.
+ *
+ * This file contains the function definitions for running the bumper switches (see Bumper_Switches.h)
+ * on Port 4 of the MSP432P401R. The switches of the TI-RSLK chassis are active low and use the
+ * internal pull-up resistors:
+ *  - BUMP0 <-->  MSP432 LaunchPad Pin P4.0
+ *  - BUMP1 <-->  MSP432 LaunchPad Pin P4.2
+ *  - BUMP2 <-->  MSP432 LaunchPad Pin P4.3
+ *  - BUMP3 <-->  MSP432 LaunchPad Pin P4.5
+ *  - BUMP4 <-->  MSP432 LaunchPad Pin P4.6
+ *  - BUMP5 <-->  MSP432 LaunchPad Pin P4.7
+ *
+ * The first statement of PORT4_IRQHandler clears the motor enable pins (P3.6 and P3.7), on every edge
+ * of every switch, before the DWT cycle counter is read and the module handles the switches. Its
+ * priority is 1, the highest that a critical section can mask (see Critical_Section.h), so only the
+ * lock of the module and the sections that mask all interrupts with PRIMASK can delay it. The lock of
+ * the tickless timer, at priority 2, does not.
+ *
+ * The time of the module is the millisecond time of the tickless timer, which the handler reads
+ * without the lock of the timer.
+ *
+ */
+
+#ifndef INC_BUMPER_SWITCHES_MSP432_H_
+#define INC_BUMPER_SWITCHES_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "Bumper_Switches.h"
+#include "Tickless_Timer.h"
+
+// Port 4 pins of the six switches
+#define BUMPER_SWITCHES_MSP432_PINS             0xED
+
+// Priority of the PORT4 interrupt, from 1 (highest that the lock can mask) to 7
+#define BUMPER_SWITCHES_MSP432_PRIORITY         1
+
+typedef struct
+{
+    // Cycles from the software edge to the motor cutoff in PORT4_IRQHandler
+    uint32_t trials;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+} Bumper_Switches_MSP432_Latency;
+
+/**
+ * @brief Configures the switch pins, starts the DWT cycle counter, enables the PORT4 interrupt and
+ *        initializes the module.
+ *
+ * Interrupts must be enabled afterwards (EnableInterrupts) for the collisions to be handled.
+ *
+ * @param bumpers          Pointer to the module. It must stay valid, since the interrupt handler uses it.
+ * @param timer            Tickless timer that provides the time of the module.
+ * @param priority         Priority of the PORT4 interrupt, from 1 to 7, higher than the tickless timer.
+ * @param callback         Called from the interrupt for each collision (may be NULL).
+ * @param callback_context Passed to the callback.
+ *
+ * @return None
+ */
+void Bumper_Switches_MSP432_Init(Bumper_Switches *bumpers, Tickless_Timer *timer, uint32_t priority,
+                                 Bumper_Switches_Callback callback, void *callback_context);
+
+/**
+ * @brief Measures the reaction latency of PORT4_IRQHandler with the DWT cycle counter.
+ *
+ * Each trial sets the interrupt flag of BUMP0 in software and counts the cycles until the handler has
+ * cleared the motor enable pins. This includes the interrupt entry and the flash wait states, but not
+ * the input synchronizer of the pin (two clock cycles of the port). Interrupts must be enabled, and
+ * the motors are stopped.
+ *
+ * @param latency Receives the minimum, maximum and total cycles.
+ * @param trials  Number of trials.
+ *
+ * @return None
+ */
+void Bumper_Switches_MSP432_Measure_Latency(Bumper_Switches_MSP432_Latency *latency, uint32_t trials);
+
+/**
+ * @brief Prints a latency measurement with printf, in cycles and nanoseconds at 48 MHz, on a line
+ *        starting with "bumper cutoff:".
+ *
+ * @param latency The measurement.
+ *
+ * @return None
+ */
+void Bumper_Switches_MSP432_Print_Latency(const Bumper_Switches_MSP432_Latency *latency);
+
+#endif /* INC_BUMPER_SWITCHES_MSP432_H_ */
@@ -0,0 +1,108 @@
+/**
+ * @file Bumper_Switches_Sim.h
+ * @brief Header file for the Bumper_Switches_Sim backend.
+ *
+ * This file contains the function definitions for running the bumper switches (see Bumper_Switches.h)
+ * on simulated pin edges on a host computer, so that the edge handling can be checked without a board.
+ *
+ * The simulated port behaves like Port 4 of the MSP432: a change of a switch sets its flag when it
+ * matches the selected edge, selecting the edge that has already happened also sets the flag, and
+ * the interrupt is taken while a flag is set, the lock is released and the handler is not running.
+ * Like PORT4_IRQHandler, the simulated handler disables the motors before it calls the module. A hook
+ * can change the switches in the middle of the handler, to reach the races of the edge selection.
+ *
+ */
+
+#ifndef INC_BUMPER_SWITCHES_SIM_H_
+#define INC_BUMPER_SWITCHES_SIM_H_
+
+#include <stdint.h>
+#include "Bumper_Switches.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Bumper_Switches_Sim_Context Bumper_Switches_Sim_Context;
+
+// Called at each read and edge selection of the interrupt handler; may call Bumper_Switches_Sim_Set
+typedef void (*Bumper_Switches_Sim_Hook)(Bumper_Switches_Sim_Context *context);
+
+struct Bumper_Switches_Sim_Context
+{
+    // Simulated time in microseconds
+    uint64_t time_us;
+
+    // Closed switches, switches that wait for their closing edge, and edge flags
+    uint8_t closed;
+    uint8_t watch_closing;
+    uint8_t flags;
+
+    // Lock state, and whether the interrupt handler is running
+    uint8_t locked;
+    uint8_t in_interrupt;
+
+    // Motor enable, cleared by the handler
+    uint8_t motors_enabled;
+
+    Bumper_Switches *bumpers;
+
+    Bumper_Switches_Sim_Hook hook;
+    void *hook_context;
+
+    // Activity: interrupts taken, and the ones that stopped running motors
+    uint64_t interrupts;
+    uint64_t cutoffs;
+};
+
+/**
+ * @brief Initializes the module on a simulated port with all switches open.
+ *
+ * @param bumpers          Pointer to the module.
+ * @param context          Pointer to the simulated port, which must stay valid while the module is in use.
+ * @param debounce_ms      Time all switches must stay open before a new collision.
+ * @param callback         Called from the interrupt for each collision (may be NULL).
+ * @param callback_context Passed to the callback.
+ *
+ * @return None
+ */
+void Bumper_Switches_Sim_Init(Bumper_Switches *bumpers, Bumper_Switches_Sim_Context *context, uint32_t debounce_ms,
+                              Bumper_Switches_Callback callback, void *callback_context);
+
+/**
+ * @brief Changes the switches, raising the flags of the selected edges, and takes the interrupt if it
+ *        is not masked.
+ *
+ * @param context Pointer to the simulated port.
+ * @param closed  The switches that are closed from now on.
+ *
+ * @return None
+ */
+void Bumper_Switches_Sim_Set(Bumper_Switches_Sim_Context *context, uint8_t closed);
+
+/**
+ * @brief Advances the simulated time.
+ *
+ * @param context Pointer to the simulated port.
+ * @param us      Time in microseconds.
+ *
+ * @return None
+ */
+void Bumper_Switches_Sim_Advance(Bumper_Switches_Sim_Context *context, uint64_t us);
+
+/**
+ * @brief Masks or unmasks the interrupt from the simulated program, as the lock of the module does.
+ *        A pending interrupt is taken when unmasked.
+ *
+ * @param context Pointer to the simulated port.
+ * @param locked  1 to mask, 0 to unmask.
+ *
+ * @return None
+ */
+void Bumper_Switches_Sim_Mask(Bumper_Switches_Sim_Context *context, uint8_t locked);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BUMPER_SWITCHES_SIM_H_ */
@@ -0,0 +1,67 @@
+/**
+ * @file Color_Classifier.h
+ * @brief Header file for the Color_Classifier module.
+ *
+ * This file contains the function definitions for the threshold classifier used by the Simon game.
+ * It maps a calibrated RGB sample (see PMOD_Color_Normalize_Calibration) to green, red, yellow or unknown.
+ * The rules are checked in order, and the first one that matches decides the color:
+ *  - Green:  G exceeds both R and B by more than green_margin
+ *  - Yellow: R and G are above yellow_min_rg and B is below yellow_max_blue
+ *  - Red:    R exceeds both G and B by more than red_margin
+ *
+ * The classifier has no dependency on the hardware, so the host tools evaluate exactly the same code.
+ *
+ */
+
+#ifndef INC_COLOR_CLASSIFIER_H_
+#define INC_COLOR_CLASSIFIER_H_
+
+#include <stdint.h>
+#include "Color_Classifier_Config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    COLOR_GREEN = 0,
+    COLOR_RED   = 1,
+    COLOR_YELLOW = 2,
+    COLOR_UNKNOWN = 3
+} Color_t;
+
+#define COLOR_CLASSIFIER_NUM_COLORS             4
+
+typedef struct
+{
+    uint16_t green_margin;
+    uint16_t yellow_min_rg;
+    uint16_t yellow_max_blue;
+    uint16_t red_margin;
+} Color_Classifier_Params;
+
+// Parameters built from Color_Classifier_Config.h
+extern const Color_Classifier_Params Color_Classifier_Default_Params;
+
+/**
+ * @brief Classifies a calibrated RGB sample.
+ *
+ * @param params Pointer to the classifier thresholds.
+ * @param R      The calibrated red channel.
+ * @param G      The calibrated green channel.
+ * @param B      The calibrated blue channel.
+ *
+ * @return COLOR_GREEN, COLOR_RED, COLOR_YELLOW or COLOR_UNKNOWN.
+ */
+Color_t Color_Classifier_Classify(const Color_Classifier_Params *params, uint16_t R, uint16_t G, uint16_t B);
+
+/**
+ * @brief Returns the name of a color ("GREEN", "RED", "YELLOW" or "UNKNOWN").
+ */
+const char *Color_Classifier_Name(Color_t color);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_COLOR_CLASSIFIER_H_ */
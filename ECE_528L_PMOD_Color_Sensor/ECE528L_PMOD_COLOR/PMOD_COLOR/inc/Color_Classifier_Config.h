@@ -0,0 +1,18 @@
+/**
+ * @file Color_Classifier_Config.h
+ * @brief Threshold configuration for the Color_Classifier.
+ *
+ * This file can be regenerated by host_tools/classifier_optimizer from labeled captures.
+ * The values below are the original hand-picked thresholds of Detect_Color.
+ *
+ */
+
+#ifndef INC_COLOR_CLASSIFIER_CONFIG_H_
+#define INC_COLOR_CLASSIFIER_CONFIG_H_
+
+#define COLOR_CLASSIFIER_GREEN_MARGIN           3000
+#define COLOR_CLASSIFIER_YELLOW_MIN_RG          0x2000
+#define COLOR_CLASSIFIER_YELLOW_MAX_BLUE        0x3000
+#define COLOR_CLASSIFIER_RED_MARGIN             6000
+
+#endif /* INC_COLOR_CLASSIFIER_CONFIG_H_ */
@@ -0,0 +1,131 @@
+/**
+ * @file Color_Names.h
+ * @brief Header file for the Color_Names module.
+ *
+ * This file contains the function definitions for finding the nearest named color of a calibrated RGB
+ * sample in a database of a few hundred colors, for example a paint chip catalog. The database is a
+ * constant table in flash, generated by host_tools/color_names from a CSV file (see Color_Names_Table.c).
+ *
+ * Each color is compared by a key of three fixed-point values:
+ *  - x and y: the chromaticity R / (R + G + B) and G / (R + G + B) in Q15 (COLOR_NAMES_ONE is 1.0),
+ *    which does not change with the distance of the object or the brightness of the light
+ *  - lightness: (R + G + B) / 6, from 0 to 32767, so that black, gray and white stay apart
+ * The distance is dx^2 + dy^2 + (dl^2 >> COLOR_NAMES_LIGHTNESS_SHIFT), which fits in 32 bits.
+ *
+ * The entries are sorted by the cell of a uniform grid of 2^grid_bits x 2^grid_bits cells over (x, y),
+ * and cells[c] is the index of the first entry of cell c. A query scans the cell of the sample, then the
+ * rings of cells around it, and stops when the chromaticity distance to the cells left is larger than
+ * the best distance found: the result is exactly the nearest entry, as with a linear scan. With a few
+ * entries per cell, a query compares a small fraction of the database.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same search.
+ *
+ */
+
+#ifndef INC_COLOR_NAMES_H_
+#define INC_COLOR_NAMES_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 1.0 in the Q15 chromaticity of the keys
+#define COLOR_NAMES_ONE                         32768
+
+// The squared lightness difference counts for a quarter of a squared chromaticity difference
+#define COLOR_NAMES_LIGHTNESS_SHIFT             2
+
+// Largest grid: 64 x 64 cells
+#define COLOR_NAMES_MAX_GRID_BITS               6
+
+// Index returned when the database is empty
+#define COLOR_NAMES_NONE                        0xFFFF
+
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t lightness;
+} Color_Names_Key;
+
+typedef struct
+{
+    Color_Names_Key key;
+    const char *name;
+} Color_Names_Entry;
+
+typedef struct
+{
+    // Entries sorted by grid cell, and the (1 << (2 * grid_bits)) + 1 offsets of the cells: the entries
+    // of cell (cx, cy) are cells[c] to cells[c + 1] - 1, with c = (cy << grid_bits) + cx
+    const Color_Names_Entry *entries;
+    const uint16_t *cells;
+    uint16_t count;
+    uint8_t grid_bits;
+} Color_Names_Database;
+
+typedef struct
+{
+    // Index of the nearest entry, or COLOR_NAMES_NONE, and its distance
+    uint16_t index;
+    uint32_t distance;
+
+    // Entries compared by the query
+    uint16_t compared;
+} Color_Names_Match;
+
+// Database generated by host_tools/color_names (see Color_Names_Table.c)
+extern const Color_Names_Database Color_Names_Default_Database;
+
+/**
+ * @brief Computes the key of a calibrated RGB sample.
+ *
+ * @param R The calibrated red channel.
+ * @param G The calibrated green channel.
+ * @param B The calibrated blue channel.
+ *
+ * @return The key. A black sample (R + G + B = 0) has the chromaticity of gray.
+ */
+Color_Names_Key Color_Names_Key_From_RGB(uint16_t R, uint16_t G, uint16_t B);
+
+/**
+ * @brief Computes the distance between two keys.
+ */
+uint32_t Color_Names_Distance(const Color_Names_Key *a, const Color_Names_Key *b);
+
+/**
+ * @brief Finds the nearest entry of a key with the grid. Of entries at the same distance, the one with
+ *        the lowest index is found.
+ *
+ * @param database Pointer to the database.
+ * @param key      Pointer to the key.
+ * @param match    Pointer to the result.
+ *
+ * @return None
+ */
+void Color_Names_Find(const Color_Names_Database *database, const Color_Names_Key *key, Color_Names_Match *match);
+
+/**
+ * @brief Finds the nearest entry of a key by comparing all the entries. The result is the same as
+ *        Color_Names_Find; the host tools use it as a reference and a baseline.
+ *
+ * @param database Pointer to the database.
+ * @param key      Pointer to the key.
+ * @param match    Pointer to the result.
+ *
+ * @return None
+ */
+void Color_Names_Find_Linear(const Color_Names_Database *database, const Color_Names_Key *key, Color_Names_Match *match);
+
+/**
+ * @brief Returns the name of an entry, or "none" for COLOR_NAMES_NONE.
+ */
+const char *Color_Names_Name(const Color_Names_Database *database, uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_COLOR_NAMES_H_ */
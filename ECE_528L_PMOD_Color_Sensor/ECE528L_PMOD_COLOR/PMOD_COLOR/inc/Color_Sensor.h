@@ -0,0 +1,145 @@
+/**
+ * @file Color_Sensor.h
+ * @brief Header file for the Color_Sensor interface.
+ *
+ * This file contains a backend-independent interface to the RGB color sensor used by the
+ * sensing pipeline. The backend is selected at compile time and every function is a
+ * static inline wrapper around the backend driver, so the pipeline code does not pay
+ * for any runtime indirection.
+ *
+ * The following backends are available:
+ *  - COLOR_SENSOR_BACKEND_TCS34725: PMOD COLOR module (AMS TCS34725) through the PMOD_Color driver
+ *  - COLOR_SENSOR_BACKEND_MOCK:     Synthetic sensor from Color_Sensor_Mock, for host builds and benchmarks
+ *
+ * If no backend is defined (for example with -DCOLOR_SENSOR_BACKEND_MOCK), the TCS34725 backend
+ * is used for MSP432 builds and the mock backend for all other builds.
+ *
+ * Each backend also provides a capabilities descriptor, Color_Sensor_Capabilities, which
+ * describes its channels, conversion rate and integration settings.
+ *
+ */
+
+#ifndef INC_COLOR_SENSOR_H_
+#define INC_COLOR_SENSOR_H_
+
+#include <stdint.h>
+
+#if !defined(COLOR_SENSOR_BACKEND_TCS34725) && !defined(COLOR_SENSOR_BACKEND_MOCK)
+#if defined(__MSP432P401R__)
+#define COLOR_SENSOR_BACKEND_TCS34725
+#else
+#define COLOR_SENSOR_BACKEND_MOCK
+#endif
+#endif
+
+typedef struct
+{
+    const char *name;
+
+    // Number of channels and whether one of them is an unfiltered (clear) channel
+    uint8_t channel_count;
+    uint8_t has_clear_channel;
+
+    // Highest count that a channel can report
+    uint16_t max_count;
+
+    // Integration time range and step in microseconds
+    uint32_t min_integration_us;
+    uint32_t max_integration_us;
+    uint32_t integration_step_us;
+
+    // Highest conversion rate, reached with the minimum integration time and no wait time
+    uint16_t max_rate_hz;
+
+    // Available analog gain settings
+    uint8_t gain_count;
+    uint8_t gains[4];
+} Color_Sensor_Capabilities;
+
+#if defined(COLOR_SENSOR_BACKEND_TCS34725)
+
+#include "PMOD_Color.h"
+
+typedef PMOD_Color_Data Color_Sensor_Data;
+
+static const Color_Sensor_Capabilities Color_Sensor_Caps =
+{
+    "TCS34725",
+    4, 1,
+    0xFFFF,
+    PMOD_COLOR_CYCLE_US, PMOD_COLOR_CYCLE_US * PMOD_COLOR_MAX_CYCLES, PMOD_COLOR_CYCLE_US,
+    1000000 / PMOD_COLOR_CYCLE_US,
+    4, { 1, 4, 16, 60 }
+};
+
+static inline void Color_Sensor_Init(void)
+{
+    PMOD_Color_Init();
+}
+
+static inline uint8_t Color_Sensor_Get_ID(void)
+{
+    return PMOD_Color_Get_Device_ID();
+}
+
+static inline Color_Sensor_Data Color_Sensor_Read(void)
+{
+    return PMOD_Color_Get_RGBC();
+}
+
+static inline void Color_Sensor_Set_Timing(uint32_t integration_us, uint32_t wait_us)
+{
+    PMOD_Color_Set_Timing(integration_us, wait_us);
+}
+
+static inline void Color_Sensor_Set_Gain(uint8_t gain_index)
+{
+    PMOD_Color_Set_Gain(gain_index);
+}
+
+#elif defined(COLOR_SENSOR_BACKEND_MOCK)
+
+#include "Color_Sensor_Mock.h"
+
+typedef PMOD_Color_Data Color_Sensor_Data;
+
+static const Color_Sensor_Capabilities Color_Sensor_Caps =
+{
+    "Mock",
+    4, 1,
+    0xFFFF,
+    COLOR_SENSOR_MOCK_CYCLE_US, COLOR_SENSOR_MOCK_CYCLE_US * 256, COLOR_SENSOR_MOCK_CYCLE_US,
+    1000000 / COLOR_SENSOR_MOCK_CYCLE_US,
+    4, { 1, 4, 16, 60 }
+};
+
+static inline void Color_Sensor_Init(void)
+{
+    Color_Sensor_Mock_Init();
+}
+
+static inline uint8_t Color_Sensor_Get_ID(void)
+{
+    return COLOR_SENSOR_MOCK_ID;
+}
+
+static inline Color_Sensor_Data Color_Sensor_Read(void)
+{
+    return Color_Sensor_Mock_Read();
+}
+
+static inline void Color_Sensor_Set_Timing(uint32_t integration_us, uint32_t wait_us)
+{
+    Color_Sensor_Mock_Set_Timing(integration_us, wait_us);
+}
+
+static inline void Color_Sensor_Set_Gain(uint8_t gain_index)
+{
+    Color_Sensor_Mock_Set_Gain(gain_index);
+}
+
+#else
+#error "No color sensor backend selected"
+#endif
+
+#endif /* INC_COLOR_SENSOR_H_ */
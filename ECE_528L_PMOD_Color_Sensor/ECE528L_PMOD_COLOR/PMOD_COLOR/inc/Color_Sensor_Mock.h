@@ -0,0 +1,104 @@
+/**
+ * @file Color_Sensor_Mock.h
+ * @brief Header file for the Color_Sensor_Mock driver.
+ *
+ * This file contains the function definitions for a synthetic color sensor that behaves like a
+ * TCS34725: the counts grow with the integration time and gain and saturate at the same limits,
+ * and every read advances a simulated clock by one conversion period. It is used as the
+ * Color_Sensor backend for host builds and benchmarks, where no hardware is available.
+ *
+ * The scene is set with Color_Sensor_Mock_Set_Color as counts per 2.4 ms integration cycle
+ * at 1x gain, and uniform noise can be added with Color_Sensor_Mock_Set_Noise.
+ *
+ */
+
+#ifndef INC_COLOR_SENSOR_MOCK_H_
+#define INC_COLOR_SENSOR_MOCK_H_
+
+#include <stdint.h>
+#include "PMOD_Color.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Value returned as the device ID of the mock sensor
+#define COLOR_SENSOR_MOCK_ID                    0x00
+
+// Duration of one integration or wait cycle in microseconds, as for the TCS34725
+#define COLOR_SENSOR_MOCK_CYCLE_US              2400
+
+/**
+ * @brief Resets the mock sensor: black scene, no noise, 2.4 ms integration, no wait, 1x gain.
+ *
+ * @return None
+ */
+void Color_Sensor_Mock_Init(void);
+
+/**
+ * @brief Sets the scene seen by the mock sensor.
+ *
+ * @param red   Red counts per 2.4 ms integration cycle at 1x gain.
+ * @param green Green counts per 2.4 ms integration cycle at 1x gain.
+ * @param blue  Blue counts per 2.4 ms integration cycle at 1x gain.
+ * @param clear Clear counts per 2.4 ms integration cycle at 1x gain.
+ *
+ * @return None
+ */
+void Color_Sensor_Mock_Set_Color(uint16_t red, uint16_t green, uint16_t blue, uint16_t clear);
+
+/**
+ * @brief Sets the amplitude of the uniform noise added to every channel, and its seed.
+ *
+ * @param amplitude The noise is uniformly distributed in [-amplitude, +amplitude] counts.
+ * @param seed      Seed of the noise generator (0 is replaced by a fixed non-zero seed).
+ *
+ * @return None
+ */
+void Color_Sensor_Mock_Set_Noise(uint16_t amplitude, uint32_t seed);
+
+/**
+ * @brief Sets the integration time and wait time, with the same rounding as the TCS34725.
+ *
+ * @param integration_us The integration time in microseconds.
+ * @param wait_us        The wait time in microseconds (0 disables the wait state).
+ *
+ * @return None
+ */
+void Color_Sensor_Mock_Set_Timing(uint32_t integration_us, uint32_t wait_us);
+
+/**
+ * @brief Sets the analog gain index (0 = 1x, 1 = 4x, 2 = 16x, 3 = 60x).
+ *
+ * @param gain_index The gain index.
+ *
+ * @return None
+ */
+void Color_Sensor_Mock_Set_Gain(uint8_t gain_index);
+
+/**
+ * @brief Performs one conversion and advances the simulated clock by one conversion period.
+ *
+ * @return The simulated RGBC data.
+ */
+PMOD_Color_Data Color_Sensor_Mock_Read(void);
+
+/**
+ * @brief Returns the simulated time in microseconds since Color_Sensor_Mock_Init.
+ *
+ * @return The simulated time.
+ */
+uint64_t Color_Sensor_Mock_Get_Time_us(void);
+
+/**
+ * @brief Returns the number of conversions performed since Color_Sensor_Mock_Init.
+ *
+ * @return The number of conversions.
+ */
+uint32_t Color_Sensor_Mock_Get_Read_Count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_COLOR_SENSOR_MOCK_H_ */
@@ -0,0 +1,145 @@
+/**
+ * @file Critical_Section.h
+ * @brief Header file for the Critical_Section module.
+ *
+ * This file contains the inline functions for critical sections that mask interrupts by priority with
+ * the BASEPRI register of the Cortex-M4, instead of masking all of them with PRIMASK.
+ *
+ * A section entered at a priority masks the interrupts of that priority and of every lower priority
+ * (numerically greater or equal). The interrupts of higher priority still preempt it, so a section
+ * that only shares data with the tickless timer does not delay the bumper switches. The MSP432
+ * implements 3 priority bits: priority p is the BASEPRI value p << 5. A priority of 0 cannot be masked
+ * with BASEPRI, so the interrupts that share data with a section have priorities from 1 to 7.
+ *
+ * The sections nest: Critical_Section_Enter only raises the mask, and Critical_Section_Exit restores
+ * the value that the matching Critical_Section_Enter returned. An interrupt handler may enter a
+ * section of its own priority or of a higher one.
+ *
+ * With CRITICAL_SECTION_PROFILE set to 1, each section that raises the mask is timed with the DWT
+ * cycle counter, and the longest one is kept for each priority. An interrupt of priority p waits at
+ * most for the longest section at priority p or higher, while with PRIMASK it waited for the longest
+ * section of all.
+ *
+ */
+
+#ifndef INC_CRITICAL_SECTION_H_
+#define INC_CRITICAL_SECTION_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Set to 0 to remove the timing of the sections
+#ifndef CRITICAL_SECTION_PROFILE
+#define CRITICAL_SECTION_PROFILE                1
+#endif
+
+// Number of priorities, and the shift from a priority to its BASEPRI value
+#define CRITICAL_SECTION_PRIORITIES             (1 << __NVIC_PRIO_BITS)
+#define CRITICAL_SECTION_SHIFT                  (8 - __NVIC_PRIO_BITS)
+
+#if CRITICAL_SECTION_PROFILE
+// Cycle count when the mask was raised to each priority, and the sections timed at each priority
+extern uint32_t Critical_Section_Start_Cycles[CRITICAL_SECTION_PRIORITIES];
+extern uint32_t Critical_Section_Count[CRITICAL_SECTION_PRIORITIES];
+extern uint32_t Critical_Section_Max_Cycles[CRITICAL_SECTION_PRIORITIES];
+#endif
+
+/**
+ * @brief Starts the DWT cycle counter used by the profile.
+ *
+ * @return None
+ */
+void Critical_Section_Init(void);
+
+/**
+ * @brief Enters a critical section that masks the interrupts of a priority and of the lower ones.
+ *
+ * @param priority The highest priority to mask, from 1 to 7.
+ *
+ * @return The previous mask, for Critical_Section_Exit.
+ */
+static inline uint32_t Critical_Section_Enter(uint32_t priority)
+{
+    uint32_t state = __get_BASEPRI();
+    uint32_t level = priority << CRITICAL_SECTION_SHIFT;
+
+    // A mask of 0 masks nothing; otherwise a smaller value masks more priorities
+    if ((state == 0) || (level < state))
+    {
+        __set_BASEPRI(level);
+        __ISB();
+
+#if CRITICAL_SECTION_PROFILE
+        Critical_Section_Start_Cycles[priority] = DWT->CYCCNT;
+#endif
+    }
+
+    return state;
+}
+
+/**
+ * @brief Leaves a critical section, restoring the mask from before the matching Critical_Section_Enter.
+ *
+ * @param state The value returned by Critical_Section_Enter.
+ *
+ * @return None
+ */
+static inline void Critical_Section_Exit(uint32_t state)
+{
+#if CRITICAL_SECTION_PROFILE
+    uint32_t level = __get_BASEPRI();
+
+    // Only the section that raised the mask is timed, while it is still masked
+    if (level != state)
+    {
+        uint32_t priority = level >> CRITICAL_SECTION_SHIFT;
+        uint32_t cycles = DWT->CYCCNT - Critical_Section_Start_Cycles[priority];
+
+        Critical_Section_Count[priority]++;
+
+        if (cycles > Critical_Section_Max_Cycles[priority])
+        {
+            Critical_Section_Max_Cycles[priority] = cycles;
+        }
+    }
+#endif
+
+    __set_BASEPRI(state);
+}
+
+/**
+ * @brief Sleeps with WFI inside a critical section until an interrupt of any priority is pending.
+ *
+ * WFI does not wake for the interrupts that BASEPRI masks, so the mask is moved to PRIMASK for the
+ * wait: the pending interrupt wakes the processor, and it is taken when the section ends. The section
+ * must be the outermost one, entered with nothing masked. The profile does not count the wait.
+ *
+ * @return None
+ */
+static inline void Critical_Section_Wait_For_Interrupt(void)
+{
+    uint32_t level = __get_BASEPRI();
+
+    __disable_irq();
+    __set_BASEPRI(0);
+    __DSB();
+    __WFI();
+    __set_BASEPRI(level);
+    __enable_irq();
+
+#if CRITICAL_SECTION_PROFILE
+    Critical_Section_Start_Cycles[level >> CRITICAL_SECTION_SHIFT] = DWT->CYCCNT;
+#endif
+}
+
+/**
+ * @brief Prints the profile of the sections with printf, on lines starting with "critical:", and the
+ *        longest wait of an interrupt at a priority with BASEPRI and with PRIMASK sections.
+ *
+ * @param priority The priority of the interrupt whose wait is printed.
+ *
+ * @return None
+ */
+void Critical_Section_Print_Stats(uint32_t priority);
+
+#endif /* INC_CRITICAL_SECTION_H_ */
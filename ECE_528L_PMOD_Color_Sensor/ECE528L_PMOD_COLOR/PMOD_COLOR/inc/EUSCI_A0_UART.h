@@ -298,4 +298,20 @@ int EUSCI_A0_UART_Rename(const char *old_name, const char *new_name);
  */
 void EUSCI_A0_UART_Init_Printf();
 
+/**
+ * @brief The EUSCI_A0_UART_Write_Frame function transmits a binary frame via UART between the text lines of printf.
+ *
+ * This function flushes stdout before it transmits the frame, so that the frame does not split a text line
+ * that printf has buffered. It has the signature of the frame writers of PC_Sampler, I2C_Trace and
+ * Sample_Summary, which are passed this function. It waits for each character to be transmitted, so it must
+ * be called from the main program, never from an interrupt handler.
+ *
+ * @param context Unused.
+ * @param frame   Pointer to the frame to be transmitted.
+ * @param length  Length of the frame in bytes.
+ *
+ * @return None
+ */
+void EUSCI_A0_UART_Write_Frame(void *context, const uint8_t *frame, uint16_t length);
+
 #endif /* EUSCI_A0_UART_H_ */
@@ -0,0 +1,146 @@
+/**
+ * @file EUSCI_B_I2C.h
+ * @brief Header file for the EUSCI_B_I2C driver.
+ *
+ * This file contains the function definitions for the EUSCI_B_I2C driver.
+ * It is the multi-instance counterpart of the EUSCI_B1_I2C driver: every function takes
+ * the EUSCI_B module (EUSCI_B0 to EUSCI_B3) to operate on, so several I2C buses can be
+ * used at the same time. The EUSCI_B_I2C driver uses busy-wait implementation.
+ *
+ * The following pins are used by each module:
+ *  - EUSCI_B0: P1.6 (SDA), P1.7 (SCL)  (Primary module function)
+ *  - EUSCI_B1: P6.4 (SDA), P6.5 (SCL)  (Primary module function)
+ *  - EUSCI_B2: P3.6 (SDA), P3.7 (SCL)  (Primary module function)
+ *  - EUSCI_B3: P6.6 (SDA), P6.7 (SCL)  (Secondary module function)
+ *
+ * @note On the TI-RSLK MAX chassis, P3.6 and P3.7 are used as the motor sleep pins,
+ *       so EUSCI_B2 cannot be used together with the Motor driver.
+ *
+ * For more information regarding the Enhanced Universal Serial Communication Interface (eUSCI),
+ * refer to the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#ifndef INC_EUSCI_B_I2C_H_
+#define INC_EUSCI_B_I2C_H_
+
+#include <stdint.h>
+#include "msp.h"
+
+// Number of EUSCI_B modules available on the MSP432P401R
+#define EUSCI_B_I2C_NUM_MODULES                 4
+
+// Status codes returned by EUSCI_B_I2C_Write and EUSCI_B_I2C_Read
+#define EUSCI_B_I2C_OK                          0
+#define EUSCI_B_I2C_ERROR_NACK                  -1
+#define EUSCI_B_I2C_ERROR_TIMEOUT               -2
+
+// Approximate number of flag polling iterations per microsecond at 48 MHz,
+// used to convert a timeout in microseconds to a polling budget
+#define EUSCI_B_I2C_POLLS_PER_US                4
+
+/**
+ * @brief Returns the index (0 to 3) of the given EUSCI_B module.
+ *
+ * @param eusci_b Pointer to the EUSCI_B module (EUSCI_B0, EUSCI_B1, EUSCI_B2 or EUSCI_B3).
+ *
+ * @return The module index, or EUSCI_B_I2C_NUM_MODULES if the pointer does not refer to a EUSCI_B module.
+ */
+uint8_t EUSCI_B_I2C_Get_Index(EUSCI_B_Type *eusci_b);
+
+/**
+ * @brief Initializes the given EUSCI_B module for I2C communication.
+ *
+ * The module is configured in the same way as in EUSCI_B1_I2C_Init: 7-bit addressing,
+ * single master, SMCLK (12 MHz) as the clock source and a 400 kHz SCL frequency.
+ * The SDA and SCL pins of the selected module are also configured.
+ *
+ * @param eusci_b Pointer to the EUSCI_B module to initialize.
+ *
+ * @return None
+ */
+void EUSCI_B_I2C_Init(EUSCI_B_Type *eusci_b);
+
+/**
+ * @brief Sends a byte of data to a specified I2C slave device.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ * @param data          The data byte to be sent to the slave device.
+ *
+ * @return None
+ */
+void EUSCI_B_I2C_Send_A_Byte(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t data);
+
+/**
+ * @brief Sends multiple bytes of data to a specified I2C slave device.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ * @param data_buffer   A pointer to an array of data bytes to be sent to the slave device.
+ * @param packet_length The number of data bytes to send in the data_buffer.
+ *
+ * @return None
+ */
+void EUSCI_B_I2C_Send_Multiple_Bytes(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer, uint32_t packet_length);
+
+/**
+ * @brief Receives a single byte of data from a specified I2C slave device.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ *
+ * @return The received data byte from the slave device.
+ */
+uint8_t EUSCI_B_I2C_Receive_A_Byte(EUSCI_B_Type *eusci_b, uint8_t slave_address);
+
+/**
+ * @brief Receives multiple bytes of data from a specified I2C slave device.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ * @param data_buffer   A pointer to an array where received data bytes will be stored.
+ * @param packet_length The number of data bytes to receive and store in data_buffer.
+ *
+ * @return None
+ */
+void EUSCI_B_I2C_Receive_Multiple_Bytes(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer, uint16_t packet_length);
+
+/**
+ * @brief Writes bytes to a slave device with NACK detection and a timeout.
+ *
+ * Unlike EUSCI_B_I2C_Send_Multiple_Bytes, this function can leave the bus held after the
+ * last byte (generate_stop = 0), so that a following EUSCI_B_I2C_Read is issued with a
+ * repeated START condition. If the slave does not acknowledge or a flag is not set within
+ * the timeout, a STOP condition is generated and an error code is returned.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ * @param data_buffer   A pointer to an array of data bytes to be sent to the slave device.
+ * @param packet_length The number of data bytes to send (0 sends only the address).
+ * @param generate_stop 1 to generate the STOP condition after the last byte, 0 to keep the bus.
+ * @param timeout_us    The maximum time in microseconds to wait for each byte.
+ *
+ * @return EUSCI_B_I2C_OK, EUSCI_B_I2C_ERROR_NACK or EUSCI_B_I2C_ERROR_TIMEOUT.
+ */
+int EUSCI_B_I2C_Write(EUSCI_B_Type *eusci_b, uint8_t slave_address, const uint8_t *data_buffer,
+                      uint32_t packet_length, uint8_t generate_stop, uint32_t timeout_us);
+
+/**
+ * @brief Reads bytes from a slave device with NACK detection and a timeout.
+ *
+ * If the bus is still held by a previous EUSCI_B_I2C_Write, the START condition generated
+ * by this function is a repeated START. A STOP condition is always generated after the last byte.
+ *
+ * @param eusci_b       Pointer to the EUSCI_B module to use.
+ * @param slave_address The 7-bit address of the I2C slave device.
+ * @param data_buffer   A pointer to an array where received data bytes will be stored.
+ * @param packet_length The number of data bytes to receive (at least 1).
+ * @param timeout_us    The maximum time in microseconds to wait for each byte.
+ *
+ * @return EUSCI_B_I2C_OK, EUSCI_B_I2C_ERROR_NACK or EUSCI_B_I2C_ERROR_TIMEOUT.
+ */
+int EUSCI_B_I2C_Read(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer,
+                     uint32_t packet_length, uint32_t timeout_us);
+
+#endif /* INC_EUSCI_B_I2C_H_ */
@@ -0,0 +1,252 @@
+/**
+ * @file Fixed_Point.h
+ * @brief Header file for the Fixed_Point module.
+ *
+ * This file contains the inline functions for the saturating fixed-point arithmetic of the sensor
+ * pipeline. A result that does not fit its type is clamped to the nearest value that does, instead of
+ * wrapping around: a calibrated channel above the white reference is full scale, not a dark value.
+ *
+ * Q formats:
+ *  - Fixed_Point_UQ16:   unsigned, 16 fractional bits. A calibrated channel, where 0xFFFF is full scale
+ *  - Fixed_Point_Q15:    signed, 15 fractional bits, from -1.0 to 1.0 - 2^-15
+ *  - Fixed_Point_Q16_16: signed, 16 integer and 16 fractional bits, for gains and ratios
+ *  - Fixed_Point_UQ32:   unsigned, 32 fractional bits, for the reciprocals of Fixed_Point_Reciprocal
+ * The products are rounded to the nearest value, ties away from zero.
+ *
+ * Divisions: Fixed_Point_Reciprocal computes 2^32 / d once with the divider, and Fixed_Point_Divide
+ * then divides by d with a multiply and a correction. The quotient is exact, so a stage that divides
+ * several values by the same number takes one division instead of one per value.
+ *
+ * On the Cortex-M4, the saturations are single SSAT and USAT instructions, and the 32-bit saturating
+ * additions are QADD and QSUB: through the intrinsics of the TI compiler, or of the ARM C Language
+ * Extensions for GCC and Clang. Elsewhere, as in the host tools, the same results are computed in C.
+ *
+ */
+
+#ifndef INC_FIXED_POINT_H_
+#define INC_FIXED_POINT_H_
+
+#include <stdint.h>
+
+#if defined(__TI_ARM_V7M4__)
+#define FIXED_POINT_INTRINSICS                  1
+#elif defined(__ARM_FEATURE_SAT) && defined(__ARM_FEATURE_QBIT)
+#include <arm_acle.h>
+#define FIXED_POINT_INTRINSICS                  1
+#else
+#define FIXED_POINT_INTRINSICS                  0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint16_t Fixed_Point_UQ16;
+typedef int16_t Fixed_Point_Q15;
+typedef int32_t Fixed_Point_Q16_16;
+typedef uint32_t Fixed_Point_UQ32;
+
+// 1.0 in each format; UQ16 and Q15 cannot hold it, and saturate to the largest value instead
+#define FIXED_POINT_UQ16_MAX                    0xFFFF
+#define FIXED_POINT_Q15_MAX                     0x7FFF
+#define FIXED_POINT_Q15_MIN                     (-0x8000)
+#define FIXED_POINT_Q16_16_ONE                  0x10000
+
+/**
+ * @brief Clamps a signed value to 0 to 65535 (USAT #16).
+ */
+static inline uint16_t Fixed_Point_Sat_U16(int32_t value)
+{
+#if defined(__TI_ARM_V7M4__)
+    return (uint16_t)_usata(value, 0, 16);
+#elif FIXED_POINT_INTRINSICS
+    return (uint16_t)__usat(value, 16);
+#else
+    return (value < 0) ? 0 : ((value > 0xFFFF) ? 0xFFFF : (uint16_t)value);
+#endif
+}
+
+/**
+ * @brief Clamps a signed value to -32768 to 32767 (SSAT #16).
+ */
+static inline int16_t Fixed_Point_Sat_S16(int32_t value)
+{
+#if defined(__TI_ARM_V7M4__)
+    return (int16_t)_ssata(value, 0, 16);
+#elif FIXED_POINT_INTRINSICS
+    return (int16_t)__ssat(value, 16);
+#else
+    return (value < -0x8000) ? -0x8000 : ((value > 0x7FFF) ? 0x7FFF : (int16_t)value);
+#endif
+}
+
+/**
+ * @brief Clamps an unsigned value to 0 to 65535.
+ */
+static inline uint16_t Fixed_Point_Sat_U16_From_U32(uint32_t value)
+{
+    return (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+}
+
+/**
+ * @brief Saturating additions and subtractions of unsigned 16-bit values: a + b stops at 65535, and
+ *        a - b at 0.
+ */
+static inline uint16_t Fixed_Point_Add_U16(uint16_t a, uint16_t b)
+{
+    return Fixed_Point_Sat_U16((int32_t)a + b);
+}
+
+static inline uint16_t Fixed_Point_Sub_U16(uint16_t a, uint16_t b)
+{
+    return Fixed_Point_Sat_U16((int32_t)a - b);
+}
+
+/**
+ * @brief Returns |a - b| of unsigned 16-bit values.
+ */
+static inline uint16_t Fixed_Point_Abs_Diff_U16(uint16_t a, uint16_t b)
+{
+    return (a > b) ? (uint16_t)(a - b) : (uint16_t)(b - a);
+}
+
+/**
+ * @brief Saturating additions and subtractions of signed 32-bit values (QADD and QSUB).
+ */
+static inline int32_t Fixed_Point_Add_S32(int32_t a, int32_t b)
+{
+#if defined(__TI_ARM_V7M4__)
+    return _sadd(a, b);
+#elif FIXED_POINT_INTRINSICS
+    return __qadd(a, b);
+#else
+    int64_t sum = (int64_t)a + b;
+    return (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : (int32_t)sum);
+#endif
+}
+
+static inline int32_t Fixed_Point_Sub_S32(int32_t a, int32_t b)
+{
+#if defined(__TI_ARM_V7M4__)
+    return _ssub(a, b);
+#elif FIXED_POINT_INTRINSICS
+    return __qsub(a, b);
+#else
+    int64_t difference = (int64_t)a - b;
+    return (difference > INT32_MAX) ? INT32_MAX : ((difference < INT32_MIN) ? INT32_MIN : (int32_t)difference);
+#endif
+}
+
+/**
+ * @brief Saturating Q15 arithmetic. The product of -1.0 by -1.0 saturates to the largest value.
+ */
+static inline Fixed_Point_Q15 Fixed_Point_Add_Q15(Fixed_Point_Q15 a, Fixed_Point_Q15 b)
+{
+    return Fixed_Point_Sat_S16((int32_t)a + b);
+}
+
+static inline Fixed_Point_Q15 Fixed_Point_Sub_Q15(Fixed_Point_Q15 a, Fixed_Point_Q15 b)
+{
+    return Fixed_Point_Sat_S16((int32_t)a - b);
+}
+
+static inline Fixed_Point_Q15 Fixed_Point_Mul_Q15(Fixed_Point_Q15 a, Fixed_Point_Q15 b)
+{
+    int32_t product = (int32_t)a * b;
+
+    // Rounded to the nearest, ties away from zero
+    product += (product >= 0) ? 0x4000 : 0x3FFF;
+
+    return Fixed_Point_Sat_S16(product >> 15);
+}
+
+/**
+ * @brief Rounded product of two UQ16 values. It never exceeds either of them.
+ */
+static inline Fixed_Point_UQ16 Fixed_Point_Mul_UQ16(Fixed_Point_UQ16 a, Fixed_Point_UQ16 b)
+{
+    return (Fixed_Point_UQ16)(((uint32_t)a * b + 0x8000) >> 16);
+}
+
+/**
+ * @brief Saturating and rounded product of two Q16.16 values.
+ */
+static inline Fixed_Point_Q16_16 Fixed_Point_Mul_Q16_16(Fixed_Point_Q16_16 a, Fixed_Point_Q16_16 b)
+{
+    int64_t product = (int64_t)a * b;
+
+    product += (product >= 0) ? 0x8000 : 0x7FFF;
+    product >>= 16;
+
+    return (product > INT32_MAX) ? INT32_MAX : ((product < INT32_MIN) ? INT32_MIN : (int32_t)product);
+}
+
+/**
+ * @brief Computes the reciprocal of a divisor for Fixed_Point_Divide.
+ *
+ * @param divisor The divisor, from 1.
+ *
+ * @return (2^32 - 1) / divisor, which is at most 1 below 2^32 / divisor.
+ */
+static inline Fixed_Point_UQ32 Fixed_Point_Reciprocal(uint32_t divisor)
+{
+    return 0xFFFFFFFFu / divisor;
+}
+
+/**
+ * @brief Divides by a divisor with its reciprocal.
+ *
+ * The product of the dividend by the reciprocal is at most 1 below the quotient, and the correction
+ * adds it, so the result is exactly dividend / divisor.
+ *
+ * @param dividend   The dividend.
+ * @param divisor    The divisor, from 1.
+ * @param reciprocal Fixed_Point_Reciprocal(divisor).
+ *
+ * @return dividend / divisor, rounded down.
+ */
+static inline uint32_t Fixed_Point_Divide(uint32_t dividend, uint32_t divisor, Fixed_Point_UQ32 reciprocal)
+{
+    uint32_t quotient = (uint32_t)(((uint64_t)dividend * reciprocal) >> 32);
+    uint32_t remainder = dividend - quotient * divisor;
+
+    if (remainder >= divisor)
+    {
+        quotient++;
+    }
+
+    return quotient;
+}
+
+/**
+ * @brief Scales a value to full scale: value * 65535 / range, rounded down and saturated.
+ *
+ * @param value The value, from 0.
+ * @param range The value of full scale. A range of 0 gives 0.
+ *
+ * @return The UQ16 value.
+ */
+static inline Fixed_Point_UQ16 Fixed_Point_Scale_UQ16(uint16_t value, uint16_t range)
+{
+    if (range == 0)
+    {
+        return 0;
+    }
+
+    return Fixed_Point_Sat_U16_From_U32(((uint32_t)value * 0xFFFF) / range);
+}
+
+/**
+ * @brief Computes the square root of an unsigned 32-bit value, digit by digit without a division.
+ *
+ * @param value The value.
+ *
+ * @return The square root, rounded down.
+ */
+uint16_t Fixed_Point_Sqrt(uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FIXED_POINT_H_ */
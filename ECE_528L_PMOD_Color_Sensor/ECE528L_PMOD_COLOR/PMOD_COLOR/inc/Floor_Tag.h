@@ -0,0 +1,156 @@
+/**
+ * @file Floor_Tag.h
+ * @brief Header file for the Floor_Tag module.
+ *
+ * This file contains the function definitions for decoding color tags on the floor while the robot
+ * drives over them. A tag is a row of green, red and yellow patches across the path of the robot,
+ * read in the order the robot reaches them:
+ *
+ *   background | patch | gap | patch | patch | ... | patch | background of at least end_gap
+ *
+ * Each patch is one symbol. Two patches of the same color must be separated by a gap of background;
+ * patches of different colors may touch. The nominal patch length is 30 mm, and the tag ends when the
+ * background after its last patch is longer than end_gap.
+ *
+ * Every classified sample is passed with the distance driven when it was taken, so that the lengths
+ * do not depend on the speed or the sampling rate. The stream is segmented into runs of one color in
+ * constant memory:
+ *  - Glitches: a change between the background and a color must last for confirm_um and
+ *    confirm_samples before it ends the current run, and a change from one color to another must last
+ *    for color_confirm_um. Shorter changes, such as a misread inside a patch or the mixed colors at the
+ *    edge between two touching patches, are part of the current run.
+ *  - Colors: each colored run counts the colors of its samples, and its color is the majority. The
+ *    samples should be classified with Floor_Tag_Classifier_Params, which keep red and yellow apart.
+ *  - Patches: a colored run between min_patch_um and max_patch_um is a symbol. A colored run of another
+ *    length makes the tag invalid, and it is reported as an error when it ends.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_FLOOR_TAG_H_
+#define INC_FLOOR_TAG_H_
+
+#include <stdint.h>
+#include "Color_Classifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest tag in symbols
+#define FLOOR_TAG_MAX_SYMBOLS                   8
+
+// Lowest R and G of a yellow patch: halfway between the G of the red and yellow calibration colors,
+// where the Simon thresholds (COLOR_CLASSIFIER_YELLOW_MIN_RG) read many samples of a bright red as yellow
+#define FLOOR_TAG_YELLOW_MIN_RG                 0x3800
+
+// Results returned by Floor_Tag_Push
+#define FLOOR_TAG_NONE                          0
+#define FLOOR_TAG_SYMBOL                        1
+#define FLOOR_TAG_COMPLETE                      2
+#define FLOOR_TAG_ERROR                         3
+
+typedef struct
+{
+    // Glitch filter: distance and samples a change must last for, and distance for a change between colors
+    uint32_t confirm_um;
+    uint8_t confirm_samples;
+    uint32_t color_confirm_um;
+
+    // Accepted patch lengths, and the background that ends a tag
+    uint32_t min_patch_um;
+    uint32_t max_patch_um;
+    uint32_t end_gap_um;
+} Floor_Tag_Params;
+
+// Parameters for 30 mm patches: 3 mm glitches (12 mm between colors), patches from 15 mm to 60 mm, 45 mm end gap
+extern const Floor_Tag_Params Floor_Tag_Default_Params;
+
+// Classifier thresholds for the patches: the Simon thresholds with FLOOR_TAG_YELLOW_MIN_RG
+extern const Color_Classifier_Params Floor_Tag_Classifier_Params;
+
+typedef struct
+{
+    const Floor_Tag_Params *params;
+
+    // Current run: its color (the majority of its votes), the position of its first sample and the
+    // samples of each color
+    Color_t run_color;
+    uint32_t run_start_um;
+    uint32_t run_votes[3];
+
+    // Change that has not lasted long enough to end the current run: its first color (COLOR_UNKNOWN for
+    // the background), its position, its samples and the samples of each color
+    Color_t candidate_color;
+    uint32_t candidate_start_um;
+    uint32_t candidate_samples;
+    uint32_t candidate_votes[3];
+
+    // Symbols of the tag being read, whether one of its patches had a wrong length, and whether the
+    // tag was reported and is cleared by the next sample
+    Color_t tag[FLOOR_TAG_MAX_SYMBOLS];
+    uint8_t tag_length;
+    uint8_t tag_invalid;
+    uint8_t tag_done;
+
+    // Length of the last run that ended, for diagnostics
+    uint32_t last_run_um;
+
+    // Statistics: samples, runs, glitches, symbols, tags and invalid tags
+    uint32_t samples;
+    uint32_t runs;
+    uint32_t glitches;
+    uint32_t symbols;
+    uint32_t tags;
+    uint32_t errors;
+} Floor_Tag_Decoder;
+
+/**
+ * @brief Initializes a decoder on background.
+ *
+ * @param decoder Pointer to the decoder.
+ * @param params  Pointer to the parameters, which must stay valid while the decoder is in use.
+ *
+ * @return None
+ */
+void Floor_Tag_Init(Floor_Tag_Decoder *decoder, const Floor_Tag_Params *params);
+
+/**
+ * @brief Starts over on background at a position, keeping the statistics.
+ *
+ * @param decoder     Pointer to the decoder.
+ * @param position_um The distance driven.
+ *
+ * @return None
+ */
+void Floor_Tag_Reset(Floor_Tag_Decoder *decoder, uint32_t position_um);
+
+/**
+ * @brief Adds a classified sample.
+ *
+ * @param decoder     Pointer to the decoder.
+ * @param color       The color of the sample (COLOR_UNKNOWN for the background).
+ * @param position_um The distance driven when the sample was taken, in micrometers. It must not
+ *                    decrease; it wraps after 4.29 km.
+ *
+ * @return FLOOR_TAG_SYMBOL when a patch was accepted (the last symbol of tag), FLOOR_TAG_COMPLETE when
+ *         a tag was read (tag and tag_length stay valid until the next sample), FLOOR_TAG_ERROR when
+ *         an invalid tag ended, or FLOOR_TAG_NONE.
+ */
+int Floor_Tag_Push(Floor_Tag_Decoder *decoder, Color_t color, uint32_t position_um);
+
+/**
+ * @brief Prints the statistics of a decoder with printf, on a line starting with "floor tags:".
+ *
+ * @param decoder Pointer to the decoder.
+ *
+ * @return None
+ */
+void Floor_Tag_Print_Stats(const Floor_Tag_Decoder *decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FLOOR_TAG_H_ */
@@ -0,0 +1,143 @@
+/**
+ * @file I2C_Bus.h
+ * @brief Header file for the I2C_Bus interface.
+ *
+ * This file contains the definitions for a platform-independent I2C bus interface.
+ * Device drivers such as PMOD_Color talk to an I2C_Bus instead of a specific I2C peripheral,
+ * so the same driver code can run on the MSP432 (I2C_Bus_EUSCI_B), on a Linux single-board
+ * computer through /dev/i2c-N (I2C_Bus_Linux) or against simulated devices (I2C_Bus_Sim).
+ *
+ * A transfer is a list of messages that are executed as one combined transaction:
+ * consecutive messages are separated by repeated START conditions, and a single STOP
+ * condition is generated after the last message. This matches the semantics of the
+ * Linux I2C_RDWR ioctl.
+ *
+ */
+
+#ifndef INC_I2C_BUS_H_
+#define INC_I2C_BUS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Status codes returned by the I2C_Bus functions
+#define I2C_BUS_OK                              0
+#define I2C_BUS_ERROR_NACK                      -1
+#define I2C_BUS_ERROR_TIMEOUT                   -2
+#define I2C_BUS_ERROR_IO                        -3
+#define I2C_BUS_ERROR_INVALID                   -4
+
+// Message flags
+#define I2C_BUS_MSG_WRITE                       0x00
+#define I2C_BUS_MSG_READ                        0x01
+
+// Default transfer timeout in microseconds
+#define I2C_BUS_DEFAULT_TIMEOUT_US              10000
+
+// Used as mux_channel when no TCA9548A channel is selected on the bus
+#define I2C_BUS_NO_MUX_CHANNEL                  0xFF
+
+// Set to 1 to let an I2C_Trace record the transfers of a bus (see I2C_Trace.h). It changes the I2C_Bus
+// structure, so every file of the program must see the same value
+#ifndef I2C_BUS_TRACE
+#define I2C_BUS_TRACE                           0
+#endif
+
+typedef struct
+{
+    uint8_t address;
+    uint8_t flags;
+    uint16_t length;
+    uint8_t *buffer;
+} I2C_Bus_Message;
+
+typedef struct I2C_Bus I2C_Bus;
+
+struct I2C_Trace;
+
+typedef struct
+{
+    int (*transfer)(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count);
+} I2C_Bus_Ops;
+
+struct I2C_Bus
+{
+    // Backend operations and backend-specific state
+    const I2C_Bus_Ops *ops;
+    void *context;
+
+    // Maximum time allowed for one message before I2C_BUS_ERROR_TIMEOUT is returned
+    uint32_t timeout_us;
+
+    // State of the TCA9548A switch on this bus, cached to avoid redundant channel selects
+    uint8_t mux_address;
+    uint8_t mux_channel;
+
+#if I2C_BUS_TRACE
+    // Trace that records the transfers, or 0
+    struct I2C_Trace *trace;
+#endif
+};
+
+/**
+ * @brief Executes a list of messages as one combined transaction.
+ *
+ * @param bus           Pointer to the bus.
+ * @param messages      Array of messages. Read messages are filled in place.
+ * @param message_count The number of messages in the array.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int I2C_Bus_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count);
+
+/**
+ * @brief Writes bytes to a slave device, followed by a STOP condition.
+ *
+ * @param bus           Pointer to the bus.
+ * @param address       The 7-bit address of the slave device.
+ * @param data_buffer   The bytes to write.
+ * @param packet_length The number of bytes to write.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int I2C_Bus_Write(I2C_Bus *bus, uint8_t address, const uint8_t *data_buffer, uint16_t packet_length);
+
+/**
+ * @brief Reads bytes from a slave device, followed by a STOP condition.
+ *
+ * @param bus           Pointer to the bus.
+ * @param address       The 7-bit address of the slave device.
+ * @param data_buffer   The buffer that receives the bytes.
+ * @param packet_length The number of bytes to read.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int I2C_Bus_Read(I2C_Bus *bus, uint8_t address, uint8_t *data_buffer, uint16_t packet_length);
+
+/**
+ * @brief Writes bytes to a slave device and reads its response after a repeated START.
+ *
+ * This is the usual way of reading a register: the register address is written,
+ * then the register contents are read without releasing the bus in between.
+ *
+ * @param bus          Pointer to the bus.
+ * @param address      The 7-bit address of the slave device.
+ * @param write_buffer The bytes to write.
+ * @param write_length The number of bytes to write.
+ * @param read_buffer  The buffer that receives the bytes.
+ * @param read_length  The number of bytes to read.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int I2C_Bus_Write_Read(I2C_Bus *bus, uint8_t address,
+                       const uint8_t *write_buffer, uint16_t write_length,
+                       uint8_t *read_buffer, uint16_t read_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_I2C_BUS_H_ */
@@ -0,0 +1,35 @@
+/**
+ * @file I2C_Bus_EUSCI_B.h
+ * @brief Header file for the I2C_Bus_EUSCI_B backend.
+ *
+ * This file contains the function definitions for the EUSCI_B backend of the I2C_Bus interface.
+ * It runs the messages of a transfer on one of the EUSCI_B modules using the EUSCI_B_I2C driver.
+ *
+ * @note The EUSCI_B module always generates a STOP condition after a read, so a read message
+ *       that is followed by further messages ends with a STOP instead of a repeated START.
+ *       Write messages are always joined to the next message with a repeated START.
+ *
+ */
+
+#ifndef INC_I2C_BUS_EUSCI_B_H_
+#define INC_I2C_BUS_EUSCI_B_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "I2C_Bus.h"
+#include "EUSCI_B_I2C.h"
+
+/**
+ * @brief Initializes an I2C_Bus that uses the given EUSCI_B module.
+ *
+ * The EUSCI_B module and its pins are initialized with EUSCI_B_I2C_Init.
+ *
+ * @param bus        Pointer to the bus to initialize.
+ * @param eusci_b    Pointer to the EUSCI_B module (EUSCI_B0 to EUSCI_B3).
+ * @param timeout_us The maximum time in microseconds to wait for each byte.
+ *
+ * @return None
+ */
+void I2C_Bus_EUSCI_B_Init(I2C_Bus *bus, EUSCI_B_Type *eusci_b, uint32_t timeout_us);
+
+#endif /* INC_I2C_BUS_EUSCI_B_H_ */
@@ -0,0 +1,85 @@
+/**
+ * @file I2C_Bus_Linux.h
+ * @brief Header file for the I2C_Bus_Linux backend.
+ *
+ * This file contains the function definitions for the Linux i2c-dev backend of the I2C_Bus interface.
+ * It allows the PMOD_Color driver to run on a Linux single-board computer, where the
+ * sensor is connected to one of the /dev/i2c-N adapters.
+ *
+ * Transfers are passed to the kernel with the I2C_RDWR ioctl, so the write and read of a register
+ * access are executed as one combined transaction with a repeated START. A transfer with more
+ * messages than the kernel accepts in one ioctl (I2C_RDRW_IOCTL_MAX_MSGS, 42) is rejected with
+ * I2C_BUS_ERROR_INVALID, since splitting it would end the transaction in the middle.
+ *
+ * Without hardware, the backend can be exercised with the kernel's i2c-stub module:
+ *  - sudo modprobe i2c-stub chip_addr=0x29
+ *  - i2cdetect -l (to find the adapter number N of the "SMBus stub driver")
+ *
+ * Without a kernel module, I2C_Bus_Linux_Attach takes the ioctl function to use, so that a host check
+ * can answer the ioctls itself (see host_tools/i2c_bus_linux_check.cpp).
+ *
+ * @note This file is only compiled on Linux.
+ *
+ */
+
+#ifndef INC_I2C_BUS_LINUX_H_
+#define INC_I2C_BUS_LINUX_H_
+
+#include <stdint.h>
+#include "I2C_Bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Function that executes the ioctls of the backend, with the signature of ioctl(2)
+typedef int (*I2C_Bus_Linux_Ioctl)(int fd, unsigned long request, void *argument);
+
+typedef struct
+{
+    int fd;
+    I2C_Bus_Linux_Ioctl ioctl;
+} I2C_Bus_Linux_Context;
+
+/**
+ * @brief Opens a Linux I2C adapter and initializes an I2C_Bus that uses it.
+ *
+ * @param bus        Pointer to the bus to initialize.
+ * @param context    Pointer to the backend state, which must stay valid while the bus is in use.
+ * @param device     The path of the adapter, for example "/dev/i2c-1".
+ * @param timeout_us The transfer timeout in microseconds. The kernel uses a 10 ms resolution.
+ *
+ * @return I2C_BUS_OK on success, or I2C_BUS_ERROR_IO if the adapter could not be opened or did not
+ *         accept the timeout and retry settings. The adapter is closed on failure.
+ */
+int I2C_Bus_Linux_Open(I2C_Bus *bus, I2C_Bus_Linux_Context *context, const char *device, uint32_t timeout_us);
+
+/**
+ * @brief Initializes an I2C_Bus on an adapter that is already open.
+ *
+ * @param bus            Pointer to the bus to initialize.
+ * @param context        Pointer to the backend state, which must stay valid while the bus is in use.
+ * @param fd             The file descriptor of the adapter.
+ * @param timeout_us     The transfer timeout in microseconds. The kernel uses a 10 ms resolution.
+ * @param ioctl_function The function that executes the ioctls, or 0 for ioctl(2).
+ *
+ * @return I2C_BUS_OK on success, or I2C_BUS_ERROR_IO if the I2C_TIMEOUT or I2C_RETRIES ioctl failed.
+ *         The file descriptor is not closed on failure.
+ */
+int I2C_Bus_Linux_Attach(I2C_Bus *bus, I2C_Bus_Linux_Context *context, int fd, uint32_t timeout_us,
+                         I2C_Bus_Linux_Ioctl ioctl_function);
+
+/**
+ * @brief Closes the adapter used by the bus.
+ *
+ * @param bus Pointer to the bus.
+ *
+ * @return None
+ */
+void I2C_Bus_Linux_Close(I2C_Bus *bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_I2C_BUS_LINUX_H_ */
@@ -0,0 +1,115 @@
+/**
+ * @file I2C_Bus_Sim.h
+ * @brief Header file for the I2C_Bus_Sim backend.
+ *
+ * This file contains the function definitions for an in-process simulated I2C bus.
+ * The simulated bus holds TCS34725 color sensors and an optional TCA9548A multiplexer, so that
+ * the PMOD_Color driver and the code built on it can be exercised on a host computer without hardware.
+ *
+ * The simulated TCS34725 implements the command register (repeated byte, auto-increment and the
+ * RGBC interrupt clear special function), the ENABLE, STATUS and data registers, and completes a
+ * new RGBC conversion after a configurable number of bus transfers while RGBC is enabled.
+ *
+ */
+
+#ifndef INC_I2C_BUS_SIM_H_
+#define INC_I2C_BUS_SIM_H_
+
+#include <stdint.h>
+#include "I2C_Bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of simulated TCS34725 devices on one bus
+#define I2C_BUS_SIM_MAX_DEVICES                 8
+
+// Value of the TCS34725 ID register
+#define I2C_BUS_SIM_TCS34725_ID                 0x44
+
+typedef struct
+{
+    uint8_t address;
+    uint8_t mux_channel;
+    uint8_t registers[32];
+    uint8_t register_pointer;
+    uint8_t auto_increment;
+
+    // A conversion completes every transfers_per_conversion transfers on the bus
+    uint32_t transfers_per_conversion;
+    uint32_t transfers_until_conversion;
+    uint32_t conversion_count;
+
+    // Values latched into the data registers by the next conversion
+    uint16_t clear, red, green, blue;
+} I2C_Bus_Sim_Device;
+
+typedef struct
+{
+    I2C_Bus_Sim_Device devices[I2C_BUS_SIM_MAX_DEVICES];
+    uint8_t device_count;
+
+    uint8_t mux_present;
+    uint8_t mux_address;
+    uint8_t mux_control;
+
+    // Bus activity counters
+    uint32_t transfer_count;
+    uint32_t message_count;
+    uint32_t byte_count;
+    uint32_t nack_count;
+    uint32_t collision_count;
+} I2C_Bus_Sim_Context;
+
+/**
+ * @brief Initializes an I2C_Bus that uses a simulated bus with no devices.
+ *
+ * @param bus     Pointer to the bus to initialize.
+ * @param context Pointer to the simulated bus state, which must stay valid while the bus is in use.
+ *
+ * @return None
+ */
+void I2C_Bus_Sim_Init(I2C_Bus *bus, I2C_Bus_Sim_Context *context);
+
+/**
+ * @brief Adds a TCA9548A multiplexer to the simulated bus.
+ *
+ * @param context Pointer to the simulated bus state.
+ * @param address The 7-bit address of the multiplexer.
+ *
+ * @return None
+ */
+void I2C_Bus_Sim_Add_TCA9548A(I2C_Bus_Sim_Context *context, uint8_t address);
+
+/**
+ * @brief Adds a TCS34725 color sensor to the simulated bus.
+ *
+ * @param context                  Pointer to the simulated bus state.
+ * @param address                  The 7-bit address of the sensor.
+ * @param mux_channel              The multiplexer channel of the sensor, or I2C_BUS_NO_MUX_CHANNEL.
+ * @param transfers_per_conversion The number of bus transfers per RGBC conversion (at least 1).
+ *
+ * @return Pointer to the simulated device, or 0 if the bus is full.
+ */
+I2C_Bus_Sim_Device *I2C_Bus_Sim_Add_TCS34725(I2C_Bus_Sim_Context *context, uint8_t address,
+                                             uint8_t mux_channel, uint32_t transfers_per_conversion);
+
+/**
+ * @brief Sets the RGBC values that the simulated sensor reports from its next conversion.
+ *
+ * @param device Pointer to the simulated device.
+ * @param clear  The clear channel value.
+ * @param red    The red channel value.
+ * @param green  The green channel value.
+ * @param blue   The blue channel value.
+ *
+ * @return None
+ */
+void I2C_Bus_Sim_Set_RGBC(I2C_Bus_Sim_Device *device, uint16_t clear, uint16_t red, uint16_t green, uint16_t blue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_I2C_BUS_SIM_H_ */
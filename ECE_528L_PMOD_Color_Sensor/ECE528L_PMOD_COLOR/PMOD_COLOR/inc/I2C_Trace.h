@@ -0,0 +1,212 @@
+/**
+ * @file I2C_Trace.h
+ * @brief Header file for the I2C_Trace module.
+ *
+ * This file contains the function definitions for tracing the transfers of an I2C_Bus. With
+ * I2C_BUS_TRACE set to 1 (see I2C_Bus.h), I2C_Bus_Transfer passes the transfers of a bus that has a
+ * trace attached to I2C_Trace_Transfer, which reads a clock before and after the transfer and records
+ * the address, the bytes written and read, the start, the duration and the status. With I2C_BUS_TRACE
+ * set to 0, the default, the bus has no trace and I2C_Bus_Transfer has no tracing code at all.
+ *
+ * Records: each transfer is added to a ring buffer, which the main program sends to the host as
+ * BOARD_PROTOCOL_I2C_TRACE frames (see Board_Protocol.h) with I2C_Trace_Flush, for the timelines of
+ * host_tools/i2c_trace. When the buffer is full, the record is counted as dropped, and the next frame
+ * carries the count. The transfers and the flush must both run in the main program.
+ *
+ * Statistics: the trace also keeps, on the board, the transfers, bytes and errors by status, the bus
+ * utilization (the time in transfers over the time since I2C_Trace_Init), a histogram of the transfer
+ * durations, and the count, time, bytes and errors of each operation, where an operation is a
+ * device address with a kind of transfer (write, read, or write then read).
+ *
+ * The clock is read through a function, the DWT cycle counter on the MSP432. The statistics take a
+ * division and a few short loops per transfer, about a hundred cycles; a transfer of the PMOD COLOR
+ * at 400 kHz takes about 12000.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_I2C_TRACE_H_
+#define INC_I2C_TRACE_H_
+
+#include <stdint.h>
+#include "I2C_Bus.h"
+#include "Board_Protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Records in the ring buffer (a power of two)
+#ifndef I2C_TRACE_BUFFER_SIZE
+#define I2C_TRACE_BUFFER_SIZE                   64
+#endif
+
+// Duration histogram: bucket 0 counts the transfers under I2C_TRACE_BUCKET_MIN_US, each next bucket
+// doubles the limit, and the last one counts all the longer transfers
+#define I2C_TRACE_BUCKETS                       10
+#define I2C_TRACE_BUCKET_MIN_US                 32
+
+// Operations with their own statistics; the transfers of other operations are only in the totals
+#define I2C_TRACE_MAX_OPERATIONS                8
+
+// Kinds of transfer of an operation
+#define I2C_TRACE_KIND_WRITE                    0x01
+#define I2C_TRACE_KIND_READ                     0x02
+#define I2C_TRACE_KIND_WRITE_READ               0x03
+
+// Error statuses counted apart, from I2C_BUS_ERROR_NACK (-1) to I2C_BUS_ERROR_INVALID (-4)
+#define I2C_TRACE_ERROR_KINDS                   4
+
+/**
+ * @brief Reads a free-running clock that wraps at 2^32.
+ *
+ * @param context Context passed to I2C_Trace_Init.
+ *
+ * @return The clock in ticks.
+ */
+typedef uint32_t (*I2C_Trace_Clock)(void *context);
+
+/**
+ * @brief Writes an encoded frame to the link of the host.
+ *
+ * @param context Context passed to I2C_Trace_Init.
+ * @param frame   Pointer to the frame.
+ * @param length  Length of the frame.
+ *
+ * @return None
+ */
+typedef void (*I2C_Trace_Write)(void *context, const uint8_t *frame, uint16_t length);
+
+typedef struct
+{
+    // Start in ticks since I2C_Trace_Init, and duration in ticks
+    uint64_t start;
+    uint32_t ticks;
+
+    uint8_t address;
+    int8_t status;
+
+    // Bytes written and read by the messages of the transfer
+    uint16_t write_length;
+    uint16_t read_length;
+} I2C_Trace_Record;
+
+typedef struct
+{
+    uint8_t address;
+    uint8_t kind;
+    uint32_t count;
+    uint32_t errors;
+    uint32_t bytes;
+    uint64_t ticks;
+    uint32_t max_ticks;
+} I2C_Trace_Operation;
+
+typedef struct I2C_Trace
+{
+    I2C_Trace_Clock clock;
+    void *clock_context;
+    uint32_t ticks_per_us;
+
+    // Ticks since I2C_Trace_Init, extended from the clock at each transfer, and the last clock value
+    uint64_t now;
+    uint32_t last_clock;
+
+    // Ring buffer: transfers are added at head, I2C_Trace_Flush sends from tail. Both only increase
+    I2C_Trace_Record records[I2C_TRACE_BUFFER_SIZE];
+    uint32_t head;
+    uint32_t tail;
+
+    // Records dropped because the buffer was full, and the part of them reported in the frames
+    uint32_t dropped;
+    uint32_t reported;
+
+    I2C_Trace_Write write;
+    void *write_context;
+
+    // Frames and records sent
+    uint32_t frames;
+    uint32_t sent;
+
+    // Statistics: transfers, bytes, errors by status, time in transfers, durations and operations
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t errors[I2C_TRACE_ERROR_KINDS];
+    uint64_t busy_ticks;
+    uint32_t max_ticks;
+    uint32_t bucket_ticks[I2C_TRACE_BUCKETS - 1];
+    uint32_t buckets[I2C_TRACE_BUCKETS];
+    I2C_Trace_Operation operations[I2C_TRACE_MAX_OPERATIONS];
+    uint8_t operation_count;
+} I2C_Trace;
+
+/**
+ * @brief Initializes a trace with an empty buffer and empty statistics.
+ *
+ * @param trace         Pointer to the trace.
+ * @param clock         Clock of the timestamps.
+ * @param clock_context Context passed to the clock.
+ * @param ticks_per_us  Clock frequency in ticks per microsecond.
+ * @param write         Function that writes the frames.
+ * @param write_context Context passed to the write function.
+ *
+ * @return None
+ */
+void I2C_Trace_Init(I2C_Trace *trace, I2C_Trace_Clock clock, void *clock_context, uint32_t ticks_per_us,
+                    I2C_Trace_Write write, void *write_context);
+
+#if I2C_BUS_TRACE
+/**
+ * @brief Traces the transfers of a bus from now on. Only available with I2C_BUS_TRACE.
+ *
+ * @param trace Pointer to the trace, or 0 to stop tracing the bus.
+ * @param bus   Pointer to the bus, after the Init function of its backend.
+ *
+ * @return None
+ */
+void I2C_Trace_Attach(I2C_Trace *trace, I2C_Bus *bus);
+#endif
+
+/**
+ * @brief Runs a transfer on the bus and records it. Called by I2C_Bus_Transfer.
+ *
+ * @return The status of the transfer.
+ */
+int I2C_Trace_Transfer(I2C_Trace *trace, I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count);
+
+/**
+ * @brief Sends the records in the buffer, 3 per frame, and a last frame with fewer records when
+ *        the buffer holds less. Called from the main program only.
+ *
+ * @param trace      Pointer to the trace.
+ * @param max_frames Most frames to send in this call.
+ *
+ * @return The number of frames sent.
+ */
+uint32_t I2C_Trace_Flush(I2C_Trace *trace, uint32_t max_frames);
+
+/**
+ * @brief Returns the number of records waiting in the buffer.
+ */
+uint32_t I2C_Trace_Pending(const I2C_Trace *trace);
+
+/**
+ * @brief Returns the bus utilization since I2C_Trace_Init in hundredths of a percent.
+ */
+uint32_t I2C_Trace_Utilization(const I2C_Trace *trace);
+
+/**
+ * @brief Prints the statistics with printf, on lines starting with "i2c trace:".
+ *
+ * @param trace Pointer to the trace.
+ *
+ * @return None
+ */
+void I2C_Trace_Print_Stats(const I2C_Trace *trace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_I2C_TRACE_H_ */
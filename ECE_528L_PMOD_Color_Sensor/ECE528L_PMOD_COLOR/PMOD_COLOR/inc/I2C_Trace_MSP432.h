@@ -0,0 +1,42 @@
+/**
+ * @file I2C_Trace_MSP432.h
+ * @brief Header file for the I2C_Trace_MSP432 backend.
+ *
+ * This file contains the function definitions for tracing an I2C_Bus (see I2C_Trace.h) on the
+ * MSP432P401R. The timestamps are read from the DWT cycle counter at 48 MHz, and the frames are written
+ * to EUSCI_A0 with EUSCI_A0_UART_Write_Frame, so they fall between the text lines of printf.
+ * I2C_Trace_Flush must therefore be called from the main program, never from an interrupt handler.
+ *
+ * The firmware must be built with I2C_BUS_TRACE set to 1 (see I2C_Bus.h). Each frame of 3 transfers
+ * takes about 40 bytes. The main loop makes one transfer per sample, so the trace adds about 13 bytes
+ * per sample to the 22 bytes of its text line.
+ *
+ */
+
+#ifndef INC_I2C_TRACE_MSP432_H_
+#define INC_I2C_TRACE_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "I2C_Trace.h"
+
+// DWT cycle counter frequency
+#define I2C_TRACE_MSP432_TICKS_PER_US           48
+
+// Most frames sent by one flush of the main loop
+#define I2C_TRACE_MSP432_FLUSH_FRAMES           4
+
+#if I2C_BUS_TRACE
+/**
+ * @brief Initializes the trace, starts the DWT cycle counter, and traces the transfers of the bus from
+ *        now on.
+ *
+ * @param trace Pointer to the trace. It must stay valid while the bus is in use.
+ * @param bus   Pointer to the bus, after the Init function of its backend (PMOD_Color_Get_Bus).
+ *
+ * @return None
+ */
+void I2C_Trace_MSP432_Init(I2C_Trace *trace, I2C_Bus *bus);
+#endif
+
+#endif /* INC_I2C_TRACE_MSP432_H_ */
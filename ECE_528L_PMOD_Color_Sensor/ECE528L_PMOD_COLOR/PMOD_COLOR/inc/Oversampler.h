@@ -0,0 +1,129 @@
+/**
+ * @file Oversampler.h
+ * @brief Header file for the Oversampler module.
+ *
+ * This file contains the function definitions for an oversampling and decimation filter for RGBC samples.
+ * The filter is a first-order CIC (boxcar) filter in accumulate-and-dump form: the channels of K consecutive
+ * input samples are added up, and every K-th input sample produces one output sample. Each input sample costs
+ * four additions, and the scaling to the output resolution is done once per output sample.
+ *
+ * Averaging K samples with uncorrelated noise reduces the noise by a factor of sqrt(K), which gives
+ * about 0.5 * log2(K) extra effective bits. The output keeps extra_bits fractional bits, so an output
+ * channel has 16 + extra_bits bits and the value is the channel average multiplied by 2^extra_bits.
+ *
+ * When the input samples are taken back to back (no wait time), the filter integrates the light over
+ * K sample periods. A window that spans a whole number of flicker periods rejects the flicker of lights
+ * powered from the mains (100 Hz or 120 Hz), and Oversampler_Flicker_Decimation picks such a K.
+ *
+ */
+
+#ifndef INC_OVERSAMPLER_H_
+#define INC_OVERSAMPLER_H_
+
+#include <stdint.h>
+#include "PMOD_Color.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Limits of the configuration
+#define OVERSAMPLER_MAX_DECIMATION              65535
+#define OVERSAMPLER_MAX_EXTRA_BITS              8
+
+// Flicker frequency that rejects both 100 Hz and 120 Hz: any multiple of its 50 ms period
+// is a whole number of periods of both
+#define OVERSAMPLER_FLICKER_100_120_HZ          20
+
+typedef struct
+{
+    uint32_t red;
+    uint32_t green;
+    uint32_t blue;
+    uint32_t clear;
+} Oversampler_Data;
+
+typedef struct
+{
+    // Configuration
+    uint16_t decimation;
+    uint8_t extra_bits;
+
+    // Shift used instead of a division when the decimation is a power of two, or -1
+    int8_t shift;
+
+    // Accumulators and number of input samples in the current window
+    uint32_t sum[4];
+    uint16_t count;
+
+    // Totals since the last call to Oversampler_Init
+    uint32_t input_count;
+    uint32_t output_count;
+} Oversampler;
+
+/**
+ * @brief Initializes the filter and empties the accumulators.
+ *
+ * @param oversampler Pointer to the filter.
+ * @param decimation  The number of input samples per output sample (K), from 1 to OVERSAMPLER_MAX_DECIMATION.
+ * @param extra_bits  The number of fractional bits kept in the output, from 0 to OVERSAMPLER_MAX_EXTRA_BITS.
+ *
+ * @return 0 on success, or -1 if a parameter is out of range.
+ */
+int Oversampler_Init(Oversampler *oversampler, uint16_t decimation, uint8_t extra_bits);
+
+/**
+ * @brief Discards the samples accumulated in the current window.
+ *
+ * Call this after changing the sensor integration time or gain, so that one output
+ * sample does not mix samples taken with different settings.
+ *
+ * @param oversampler Pointer to the filter.
+ *
+ * @return None
+ */
+void Oversampler_Reset(Oversampler *oversampler);
+
+/**
+ * @brief Adds one input sample to the filter.
+ *
+ * @param oversampler Pointer to the filter.
+ * @param sample      The input sample.
+ * @param output      Pointer that receives the output sample when one is produced.
+ *
+ * @return 1 if the window is complete and an output sample was written, 0 otherwise.
+ */
+uint8_t Oversampler_Add(Oversampler *oversampler, PMOD_Color_Data sample, Oversampler_Data *output);
+
+/**
+ * @brief Returns the number of bits of an output channel (16 + extra_bits).
+ */
+uint8_t Oversampler_Get_Output_Bits(const Oversampler *oversampler);
+
+/**
+ * @brief Returns the output sample period in microseconds for a given input sample period.
+ */
+uint32_t Oversampler_Get_Output_Period_us(const Oversampler *oversampler, uint32_t sample_period_us);
+
+/**
+ * @brief Finds the smallest decimation whose window spans a whole number of flicker periods.
+ *
+ * The window of K samples lasts K * sample_period_us. It is accepted if it differs from a multiple
+ * of the flicker period 1 / flicker_hz by at most tolerance_us.
+ *
+ * @param sample_period_us The input sample period in microseconds (integration time plus wait time).
+ * @param flicker_hz       The flicker frequency to reject, e.g. 100, 120 or OVERSAMPLER_FLICKER_100_120_HZ.
+ * @param min_decimation   The smallest decimation to consider (at least 1).
+ * @param max_decimation   The largest decimation to consider.
+ * @param tolerance_us     The accepted window error in microseconds.
+ *
+ * @return The decimation, or 0 if no decimation in the range is accepted.
+ */
+uint16_t Oversampler_Flicker_Decimation(uint32_t sample_period_us, uint16_t flicker_hz,
+                                        uint16_t min_decimation, uint16_t max_decimation, uint32_t tolerance_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_OVERSAMPLER_H_ */
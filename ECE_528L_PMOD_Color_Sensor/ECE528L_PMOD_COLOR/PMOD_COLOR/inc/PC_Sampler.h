@@ -0,0 +1,143 @@
+/**
+ * @file PC_Sampler.h
+ * @brief Header file for the PC_Sampler module.
+ *
+ * This file contains the function definitions for a statistical profiler. A timer interrupt of the
+ * highest priority (see PC_Sampler_MSP432.h) adds the program counter that the processor stacked on
+ * entry, and optionally the link register, to a ring buffer at a fixed rate. The main program sends
+ * the buffer as BOARD_PROTOCOL_PC_SAMPLES frames (see Board_Protocol.h) between its text lines, and
+ * host_tools/pc_profile symbolizes the addresses with the ELF file of the firmware into a flat profile
+ * and a flame graph. No code has to be marked: the samples land wherever the processor spends its
+ * time, including the printf internals, the busy-wait loops and the interrupt handlers.
+ *
+ * The buffer has a single producer, the interrupt, and a single consumer, PC_Sampler_Flush, so it
+ * needs no lock. When the buffer is full, the interrupt counts the sample as dropped, and the next
+ * frame carries the count so that the host can report the part of the time it did not see.
+ *
+ * The stacked LR is the return address of the interrupted function only while it has not called
+ * another one, as in a leaf function or a loop around a leaf function; otherwise it is an address in
+ * the function itself. The host uses it as the caller when it is in another function.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_PC_SAMPLER_H_
+#define INC_PC_SAMPLER_H_
+
+#include <stdint.h>
+#include "Board_Protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set to 1 to record the stacked LR with each PC, which doubles the memory and the UART bandwidth per sample
+#ifndef PC_SAMPLER_LR
+#define PC_SAMPLER_LR                           0
+#endif
+
+// Samples in the ring buffer (a power of two)
+#ifndef PC_SAMPLER_BUFFER_SIZE
+#define PC_SAMPLER_BUFFER_SIZE                  1024
+#endif
+
+/**
+ * @brief Writes an encoded frame to the link of the host.
+ *
+ * @param context Context passed to PC_Sampler_Init.
+ * @param frame   Pointer to the frame.
+ * @param length  Length of the frame.
+ *
+ * @return None
+ */
+typedef void (*PC_Sampler_Write)(void *context, const uint8_t *frame, uint16_t length);
+
+typedef struct
+{
+    // Ring buffer: the interrupt writes at head, PC_Sampler_Flush reads at tail. Both only increase
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t pc[PC_SAMPLER_BUFFER_SIZE];
+#if PC_SAMPLER_LR
+    uint32_t lr[PC_SAMPLER_BUFFER_SIZE];
+#endif
+
+    // Samples dropped by the interrupt, and the part of them reported in the frames
+    volatile uint32_t dropped;
+    uint32_t reported;
+
+    PC_Sampler_Write write;
+    void *write_context;
+
+    // Frames and samples sent
+    uint32_t frames;
+    uint32_t sent;
+} PC_Sampler;
+
+/**
+ * @brief Initializes a sampler with an empty buffer.
+ *
+ * @param sampler Pointer to the sampler.
+ * @param write   Writes the frames of PC_Sampler_Flush.
+ * @param context Passed to write.
+ *
+ * @return None
+ */
+void PC_Sampler_Init(PC_Sampler *sampler, PC_Sampler_Write write, void *context);
+
+/**
+ * @brief Adds a sample, or counts it as dropped when the buffer is full. Called from the sampling interrupt.
+ *
+ * @param sampler Pointer to the sampler.
+ * @param pc      The stacked PC.
+ * @param lr      The stacked LR (ignored unless PC_SAMPLER_LR is 1).
+ *
+ * @return None
+ */
+static inline void PC_Sampler_Push(PC_Sampler *sampler, uint32_t pc, uint32_t lr)
+{
+    uint32_t head = sampler->head;
+
+    if ((head - sampler->tail) >= PC_SAMPLER_BUFFER_SIZE)
+    {
+        sampler->dropped++;
+        return;
+    }
+
+    sampler->pc[head & (PC_SAMPLER_BUFFER_SIZE - 1)] = pc;
+#if PC_SAMPLER_LR
+    sampler->lr[head & (PC_SAMPLER_BUFFER_SIZE - 1)] = lr;
+#else
+    (void)lr;
+#endif
+
+    // The sample is stored before the consumer can see the new head
+    sampler->head = head + 1;
+}
+
+/**
+ * @brief Sends the buffered samples as BOARD_PROTOCOL_PC_SAMPLES frames, and the samples dropped since
+ *        the last frame. Must not be called from an interrupt that can preempt another call.
+ *
+ * @param sampler    Pointer to the sampler.
+ * @param max_frames Most frames to send, so that a call does not block the program for too long.
+ *
+ * @return The number of frames sent.
+ */
+uint32_t PC_Sampler_Flush(PC_Sampler *sampler, uint32_t max_frames);
+
+/**
+ * @brief Returns the number of samples in the buffer.
+ *
+ * @param sampler Pointer to the sampler.
+ *
+ * @return The number of samples.
+ */
+uint32_t PC_Sampler_Pending(const PC_Sampler *sampler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PC_SAMPLER_H_ */
@@ -0,0 +1,72 @@
+/**
+ * @file PC_Sampler_MSP432.h
+ * @brief Header file for the PC_Sampler_MSP432 backend.
+ *
+ * This file contains the function definitions for sampling the program counter (see PC_Sampler.h) with
+ * Timer_A2 of the MSP432P401R. Timer_A2 counts SMCLK (12 MHz) in up mode and raises TA2_0 once per
+ * sampling period. TA2_0_IRQHandler (src/PC_Sampler_MSP432_IRQ.asm) passes the exception frame that the
+ * processor stacked, from the MSP or the PSP according to EXC_RETURN, to the handler, which adds the
+ * stacked PC and LR to the buffer.
+ * Each period is varied at random by up to 1/16 of the nominal one either way, so that the samples do
+ * not lock onto a periodic task of the program.
+ *
+ * The priority of TA2_0 is 0 by default: the critical sections of Critical_Section.h do not mask it,
+ * so the samples also land inside them and inside the other interrupt handlers, and the bumper switches
+ * are delayed by the short handler only. The sections that mask all interrupts with PRIMASK delay the
+ * sample to their end.
+ *
+ * The frames are written to EUSCI_A0 with EUSCI_A0_UART_Write_Frame, so they fall between the text
+ * lines of printf. PC_Sampler_Flush must therefore be called from the main program, never from an
+ * interrupt handler. Each frame of 7 samples takes about 40 bytes, so the samples use about half of the
+ * 115200 baud at 1 kHz, and twice as much with PC_SAMPLER_LR. The handler takes about 60 cycles with the
+ * exception entry and return, 0.06% of the processor at 500 Hz.
+ *
+ */
+
+#ifndef INC_PC_SAMPLER_MSP432_H_
+#define INC_PC_SAMPLER_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "PC_Sampler.h"
+
+// Default sampling rate; from 200 Hz to 20 kHz
+#define PC_SAMPLER_MSP432_RATE_HZ               500
+
+// Priority of the TA2_0 interrupt
+#define PC_SAMPLER_MSP432_PRIORITY              0
+
+// Most frames sent by one flush of the main loop (4 frames take 14 ms at 115200 baud)
+#define PC_SAMPLER_MSP432_FLUSH_FRAMES          4
+
+/**
+ * @brief Initializes the sampler, starts the DWT cycle counter, and starts Timer_A2 and the TA2_0 interrupt.
+ *
+ * Interrupts must be enabled afterwards (EnableInterrupts) for the samples to be taken.
+ *
+ * @param sampler  Pointer to the sampler. It must stay valid, since the interrupt handler uses it.
+ * @param rate_hz  Samples per second, from 200 to 20000.
+ * @param priority Priority of the TA2_0 interrupt.
+ *
+ * @return None
+ */
+void PC_Sampler_MSP432_Init(PC_Sampler *sampler, uint32_t rate_hz, uint32_t priority);
+
+/**
+ * @brief Stops Timer_A2. The samples in the buffer can still be flushed.
+ *
+ * @return None
+ */
+void PC_Sampler_MSP432_Stop(void);
+
+/**
+ * @brief Prints the samples taken, sent and dropped, and the cycles of the handler with printf, on
+ *        lines starting with "pc sampler:".
+ *
+ * @param sampler Pointer to the sampler.
+ *
+ * @return None
+ */
+void PC_Sampler_MSP432_Print_Stats(const PC_Sampler *sampler);
+
+#endif /* INC_PC_SAMPLER_MSP432_H_ */
@@ -31,9 +31,20 @@
 #define INC_PMOD_COLOR_H_
 
 #include <stdint.h>
+#include "I2C_Bus.h"
+
+// The LED control and the single-sensor functions below use the MSP432 peripherals directly,
+// while the PMOD_Color_Sensor functions only depend on the I2C_Bus interface and can also be
+// compiled on a host computer
+#if defined(__MSP432P401R__)
 #include "msp.h"
-#include "EUSCI_B1_I2C.h"
+#include "I2C_Bus_EUSCI_B.h"
 #include "Clock.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 typedef struct
 {
@@ -48,9 +59,32 @@ typedef struct
     PMOD_Color_Data min, max;
 } PMOD_Calibration_Data;
 
+// Describes one PMOD COLOR module. Each sensor is attached to an I2C bus and,
+// optionally, to one channel of a TCA9548A I2C multiplexer on that bus
+// (mux_channel = PMOD_COLOR_NO_MUX otherwise)
+typedef struct
+{
+    I2C_Bus *bus;
+    uint8_t address;
+    uint8_t mux_address;
+    uint8_t mux_channel;
+} PMOD_Color_Sensor;
+
 // Default I2C address for the PMOD COLOR
 #define PMOD_COLOR_ADDRESS                      0x29
 
+// Default I2C address for the TCA9548A I2C multiplexer (A2 = A1 = A0 = 0)
+#define TCA9548A_ADDRESS                        0x70
+
+// Number of downstream channels of the TCA9548A
+#define TCA9548A_NUM_CHANNELS                   8
+
+// Used as mux_channel when a sensor is connected directly to its bus
+#define PMOD_COLOR_NO_MUX                       I2C_BUS_NO_MUX_CHANNEL
+
+// Maximum number of sensors handled by PMOD_Color_Sample_Sensors
+#define PMOD_COLOR_MAX_SENSORS                  16
+
 // Register Bit Position Values
 #define SET_BIT_0                               0x01
 #define SET_BIT_1                               0x02
@@ -83,15 +117,40 @@ typedef struct
 #define PMOD_COLOR_BDATA_L_REG                  0x1A
 #define PMOD_COLOR_BDATA_H_REG                  0x1B
 
-#define PMOD_COLOR_CMD_REPEAT                   0x08
+#define PMOD_COLOR_CMD_REPEAT                   0x80
 #define PMOD_COLOR_AUTO_INC                     0xA0
+#define PMOD_COLOR_CMD_CLEAR_INT                0xE6
 
 #define PMOD_COLOR_ENABLE_POWER_ON              0x01
 #define PMOD_COLOR_ENABLE_RGBC                  0x02
+#define PMOD_COLOR_ENABLE_WAIT                  0x08
+#define PMOD_COLOR_ENABLE_RGBC_INT              0x10
+
+#define PMOD_COLOR_STATUS_AVALID                0x01
+#define PMOD_COLOR_STATUS_AINT                  0x10
+
+#define PMOD_COLOR_CONFIG_WLONG                 0x02
+
+#define PMOD_COLOR_GAIN_1X                      0x00
+#define PMOD_COLOR_GAIN_4X                      0x01
+#define PMOD_COLOR_GAIN_16X                     0x02
+#define PMOD_COLOR_GAIN_60X                     0x03
+
+// Duration of one integration or wait cycle (ATIME and WTIME step) in microseconds.
+// WTIME cycles last 12 times longer when the WLONG bit is set in the CONFIG register
+#define PMOD_COLOR_CYCLE_US                     2400
+#define PMOD_COLOR_MAX_CYCLES                   256
+#define PMOD_COLOR_WLONG_FACTOR                 12
+
+// Full-scale count of one integration cycle, the RGBC channels saturate
+// at min(1024 * integration cycles, 65535) counts
+#define PMOD_COLOR_COUNTS_PER_CYCLE             1024
 
 #define PMOD_COLOR_ENABLE_LED                   0x01
 #define PMOD_COLOR_DISABLE_LED                  0x00
 
+#if defined(__MSP432P401R__)
+
 void PMOD_Color_Write_Register(uint8_t register_address, uint8_t register_data);
 
 uint8_t PMOD_Color_Read_Register(uint8_t register_address);
@@ -110,10 +169,125 @@ uint8_t PMOD_Color_Read_Raw_Color_Data(uint8_t register_address);
 
 PMOD_Color_Data PMOD_Color_Get_RGBC();
 
+void PMOD_Color_Set_Timing(uint32_t integration_us, uint32_t wait_us);
+
+void PMOD_Color_Set_Gain(uint8_t gain);
+
+// Bus of the default sensor on EUSCI_B1, set up by PMOD_Color_Init
+I2C_Bus *PMOD_Color_Get_Bus();
+
+#endif /* __MSP432P401R__ */
+
 PMOD_Calibration_Data PMOD_Color_Init_Calibration_Data(PMOD_Color_Data first_sample);
 
 void PMOD_Color_Calibrate(PMOD_Color_Data new_sample, PMOD_Calibration_Data *calibration_data);
 
+// Scales each channel from the min of the calibration by the integer factor 0xFFFF / (max - min). A value
+// below the min gives 0, a scaled value above 0xFFFF gives 0xFFFF (see Fixed_Point.h), and a channel
+// without a range gives 0
 PMOD_Color_Data PMOD_Color_Normalize_Calibration(PMOD_Color_Data sample, PMOD_Calibration_Data calibration_data);
 
+/**
+ * @brief Initializes a PMOD COLOR module described by a PMOD_Color_Sensor handle.
+ *
+ * The I2C bus of the sensor must already be initialized by its backend (for example
+ * I2C_Bus_EUSCI_B_Init). The sensor is powered on with the RGBC interrupt enabled on every
+ * integration cycle, so the AINT status bit can be used to detect a completed conversion
+ * without blocking on it.
+ *
+ * @param sensor Pointer to the sensor handle.
+ *
+ * @return I2C_BUS_OK on success, or the negative I2C_BUS_ERROR code of the first register write that
+ *         failed.
+ */
+int PMOD_Color_Sensor_Init(PMOD_Color_Sensor *sensor);
+
+/**
+ * @brief Writes a register of the sensor, selecting its multiplexer channel first if needed.
+ *
+ * @param sensor           Pointer to the sensor handle.
+ * @param register_address The command byte, including the command bit and transaction type.
+ * @param register_data    The data byte to write.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int PMOD_Color_Sensor_Write_Register(PMOD_Color_Sensor *sensor, uint8_t register_address, uint8_t register_data);
+
+/**
+ * @brief Reads a register of the sensor, selecting its multiplexer channel first if needed.
+ *
+ * @param sensor           Pointer to the sensor handle.
+ * @param register_address The command byte, including the command bit and transaction type.
+ * @param register_data    Pointer that receives the register value.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int PMOD_Color_Sensor_Read_Register(PMOD_Color_Sensor *sensor, uint8_t register_address, uint8_t *register_data);
+
+/**
+ * @brief Sets the integration time (ATIME) and the wait time between conversions (WTIME).
+ *
+ * The times are rounded to whole 2.4 ms cycles. A wait time of 0 disables the wait state,
+ * and wait times longer than 256 cycles use the WLONG setting (28.8 ms cycles).
+ *
+ * @param sensor         Pointer to the sensor handle.
+ * @param integration_us The integration time in microseconds (2400 to 614400).
+ * @param wait_us        The wait time in microseconds (0 to 7372800).
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int PMOD_Color_Sensor_Set_Timing(PMOD_Color_Sensor *sensor, uint32_t integration_us, uint32_t wait_us);
+
+/**
+ * @brief Sets the analog gain of the RGBC channels.
+ *
+ * @param sensor Pointer to the sensor handle.
+ * @param gain   One of PMOD_COLOR_GAIN_1X, PMOD_COLOR_GAIN_4X, PMOD_COLOR_GAIN_16X or PMOD_COLOR_GAIN_60X.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int PMOD_Color_Sensor_Set_Gain(PMOD_Color_Sensor *sensor, uint8_t gain);
+
+/**
+ * @brief Checks whether the sensor has completed a new RGBC integration cycle.
+ *
+ * @param sensor Pointer to the sensor handle.
+ *
+ * @return 1 if a new sample is available, 0 otherwise (including on bus errors).
+ */
+uint8_t PMOD_Color_Sensor_Data_Ready(PMOD_Color_Sensor *sensor);
+
+/**
+ * @brief Reads the RGBC data of the sensor and acknowledges the RGBC interrupt.
+ *
+ * The command byte and the eight data bytes are exchanged in one combined transaction.
+ *
+ * @param sensor Pointer to the sensor handle.
+ * @param data   Pointer that receives the raw RGBC data.
+ *
+ * @return I2C_BUS_OK on success, or a negative I2C_BUS_ERROR code.
+ */
+int PMOD_Color_Sensor_Get_RGBC(PMOD_Color_Sensor *sensor, PMOD_Color_Data *data);
+
+/**
+ * @brief Samples a group of sensors, interleaving the reads across buses.
+ *
+ * All sensors convert concurrently since each TCS34725 integrates on its own. In each polling
+ * round the sensors are visited alternating between buses, and only the sensors whose conversion
+ * has completed are read, so a slow sensor never blocks the others. The selected multiplexer
+ * channel is cached per bus to avoid redundant channel switches.
+ *
+ * @param sensors      Array of sensor handles (up to PMOD_COLOR_MAX_SENSORS).
+ * @param data         Array that receives one sample per sensor.
+ * @param sensor_count The number of sensors in the array.
+ * @param max_rounds   The maximum number of polling rounds before giving up.
+ *
+ * @return A bit mask with bit i set if data[i] holds a new sample.
+ */
+uint32_t PMOD_Color_Sample_Sensors(PMOD_Color_Sensor *sensors, PMOD_Color_Data *data, uint8_t sensor_count, uint32_t max_rounds);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* INC_PMOD_COLOR_H_ */
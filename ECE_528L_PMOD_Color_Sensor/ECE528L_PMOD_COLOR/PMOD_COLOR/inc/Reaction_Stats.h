@@ -0,0 +1,177 @@
+/**
+ * @file Reaction_Stats.h
+ * @brief Header file for the Reaction_Stats module.
+ *
+ * This file contains the function definitions for the reaction time statistics of the Simon game.
+ * A round starts when the pattern has been shown. Each accepted color is split into two times:
+ *   - reaction: from the end of the pattern display, or the previous accepted color, to the first
+ *     detection of the color (the player),
+ *   - pipeline: from the first detection to the acceptance (hold and debounce times of the firmware).
+ * The times are added to small histograms with fixed bins, which give the mean, the percentiles and the
+ * extremes without storing the samples. Completed rounds are timed from the end of the pattern display
+ * to the last color, and the best round is kept.
+ *
+ * The times are passed in milliseconds of a monotonic counter (Tickless_Timer_Now_ms in main.c), so the
+ * module has no dependency on the hardware and the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_REACTION_STATS_H_
+#define INC_REACTION_STATS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of bins of a histogram; the last bin also collects the longer times
+#define REACTION_STATS_BINS                     32
+
+// Bin widths: reaction times up to 3.2 s, pipeline times up to 1.28 s (the 1 s hold of Hold_Color
+// fits), round times up to 16 s
+#define REACTION_STATS_REACTION_BIN_MS          100
+#define REACTION_STATS_PIPELINE_BIN_MS          40
+#define REACTION_STATS_ROUND_BIN_MS             500
+
+typedef struct
+{
+    uint16_t bin_ms;
+    uint32_t count;
+    uint64_t sum_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    uint32_t bins[REACTION_STATS_BINS];
+} Reaction_Histogram;
+
+// Times of one accepted color
+typedef struct
+{
+    uint8_t step;                   // Position of the color in the round, from 1
+    uint32_t since_start_ms;        // From the end of the pattern display to the acceptance
+    uint32_t reaction_ms;
+    uint32_t pipeline_ms;
+} Reaction_Step;
+
+// Summary of the statistics, as printed by Reaction_Stats_Print and sent in telemetry. The 16-bit
+// fields saturate; Reaction_Stats_Print prints the counts in full
+typedef struct
+{
+    uint32_t steps;
+    uint16_t reaction_mean_ms;
+    uint16_t reaction_p50_ms;
+    uint16_t reaction_p90_ms;
+    uint16_t pipeline_mean_ms;
+    uint16_t pipeline_p90_ms;
+    uint16_t rounds;
+    uint16_t fails;
+    uint16_t misses;
+    uint32_t round_mean_ms;
+    uint32_t best_round_ms;         // 0 before the first completed round
+} Reaction_Summary;
+
+typedef struct
+{
+    Reaction_Histogram reaction;
+    Reaction_Histogram pipeline;
+    Reaction_Histogram round;
+    uint32_t best_round_ms;
+    uint32_t fails;
+    uint32_t misses;
+
+    // Current round: whether one is running, its number of accepted colors, its start and the last acceptance
+    uint8_t in_round;
+    uint8_t step;
+    uint32_t start_ms;
+    uint32_t last_ms;
+} Reaction_Stats;
+
+/**
+ * @brief Initializes the statistics with empty histograms and no round running.
+ *
+ * @param stats Pointer to the statistics.
+ *
+ * @return None
+ */
+void Reaction_Stats_Init(Reaction_Stats *stats);
+
+/**
+ * @brief Starts a round when the pattern has been shown. A round that was running is abandoned.
+ *
+ * @param stats  Pointer to the statistics.
+ * @param now_ms The current time.
+ *
+ * @return None
+ */
+void Reaction_Stats_Start_Round(Reaction_Stats *stats, uint32_t now_ms);
+
+/**
+ * @brief Records an accepted color of the current round.
+ *
+ * @param stats       Pointer to the statistics.
+ * @param detected_ms Time of the first detection of the color.
+ * @param accepted_ms Time the game accepted it.
+ *
+ * @return The times of the color. The step is 0 when no round is running, and nothing is recorded.
+ */
+Reaction_Step Reaction_Stats_Accept(Reaction_Stats *stats, uint32_t detected_ms, uint32_t accepted_ms);
+
+/**
+ * @brief Ends the current round when the pattern has been completed (after its last color was accepted).
+ *
+ * @param stats  Pointer to the statistics.
+ * @param now_ms Time of the last accepted color.
+ *
+ * @return The time of the round, or 0 when no round is running.
+ */
+uint32_t Reaction_Stats_Complete(Reaction_Stats *stats, uint32_t now_ms);
+
+/**
+ * @brief Ends the current round when the game restarts the pattern.
+ */
+void Reaction_Stats_Fail(Reaction_Stats *stats);
+
+/**
+ * @brief Counts a miss of the continuous mode. The round goes on.
+ */
+void Reaction_Stats_Miss(Reaction_Stats *stats);
+
+/**
+ * @brief Returns an upper bound of a percentile of a histogram.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param percent   The percentile, from 1 to 100.
+ *
+ * @return The upper edge of the bin that holds the percentile, limited to the longest time, or 0 if the histogram is empty.
+ */
+uint32_t Reaction_Histogram_Percentile_ms(const Reaction_Histogram *histogram, uint8_t percent);
+
+/**
+ * @brief Returns the mean of a histogram in milliseconds, or 0 if it is empty.
+ */
+uint32_t Reaction_Histogram_Mean_ms(const Reaction_Histogram *histogram);
+
+/**
+ * @brief Computes the summary of the statistics.
+ *
+ * @param stats   Pointer to the statistics.
+ * @param summary Pointer that receives the summary. Times that do not fit are saturated.
+ *
+ * @return None
+ */
+void Reaction_Stats_Summarize(const Reaction_Stats *stats, Reaction_Summary *summary);
+
+/**
+ * @brief Prints the summary with printf, on three lines that start with "reaction ".
+ *
+ * @param stats Pointer to the statistics.
+ *
+ * @return None
+ */
+void Reaction_Stats_Print(const Reaction_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_REACTION_STATS_H_ */
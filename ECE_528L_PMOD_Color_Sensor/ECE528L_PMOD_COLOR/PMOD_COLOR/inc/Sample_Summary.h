@@ -0,0 +1,186 @@
+/**
+ * @file Sample_Summary.h
+ * @brief Header file for the Sample_Summary module.
+ *
+ * This file contains the function definitions for summarizing the color samples over time windows
+ * instead of sending each one. The samples are added one by one with their time and color class. For
+ * each window of window_ms, aligned on the first sample, the module sends one BOARD_PROTOCOL_SUMMARY
+ * frame (see Board_Protocol.h) with the min, max, mean and variance of the red, green, blue and clear
+ * channels, and the number of samples classified as each color. A window is sent when the first sample
+ * after its end arrives, and windows without samples are not sent.
+ *
+ * Raw bursts: the next burst_samples samples are also sent as BOARD_PROTOCOL_SAMPLE frames
+ *   - on demand, after Sample_Summary_Request_Burst (the main program calls it when the host sends
+ *     SAMPLE_SUMMARY_BURST_REQUEST), or
+ *   - when a sample is an anomaly: a channel is at least anomaly_min_delta away from the mean of the
+ *     last window, and more than anomaly_sigmas of its standard deviations. An anomaly burst rearms at
+ *     the next window, so that a lasting change starts one burst and not one after the other.
+ *
+ * The sums are kept in integers: a sample takes a few additions, compares and multiply-accumulates, and
+ * the divisions of the mean and variance are done once per window. The anomaly threshold of each
+ * channel is also computed once per window, with the square root of Fixed_Point.h, so that a sample is
+ * only compared with it.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_SAMPLE_SUMMARY_H_
+#define INC_SAMPLE_SUMMARY_H_
+
+#include <stdint.h>
+#include "PMOD_Color.h"
+#include "Color_Classifier.h"
+#include "Board_Protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Default window: one summary per second
+#ifndef SAMPLE_SUMMARY_WINDOW_MS
+#define SAMPLE_SUMMARY_WINDOW_MS                1000
+#endif
+
+// Longest window, so that the samples of a window fit in 16 bits at the burst rate of Adaptive_Rate
+#define SAMPLE_SUMMARY_MAX_WINDOW_MS            60000
+
+// Default raw burst: 64 samples, 150 ms at the burst rate of Adaptive_Rate
+#define SAMPLE_SUMMARY_BURST_SAMPLES            64
+
+// Default anomaly: more than 4 standard deviations and at least 4096 counts (1/16 of the calibrated range)
+#define SAMPLE_SUMMARY_ANOMALY_SIGMAS           4
+#define SAMPLE_SUMMARY_ANOMALY_MIN_DELTA        4096
+
+// Byte that the host sends to request a raw burst ('B')
+#define SAMPLE_SUMMARY_BURST_REQUEST            0x42
+
+// Flags returned by Sample_Summary_Add
+#define SAMPLE_SUMMARY_WINDOW_SENT              0x01
+#define SAMPLE_SUMMARY_RAW_SENT                 0x02
+#define SAMPLE_SUMMARY_ANOMALY                  0x04
+
+/**
+ * @brief Writes an encoded frame to the link of the host.
+ *
+ * @param context Context passed to Sample_Summary_Init.
+ * @param frame   Pointer to the frame.
+ * @param length  Length of the frame.
+ *
+ * @return None
+ */
+typedef void (*Sample_Summary_Write)(void *context, const uint8_t *frame, uint16_t length);
+
+typedef struct
+{
+    // Length of the windows (at most SAMPLE_SUMMARY_MAX_WINDOW_MS)
+    uint32_t window_ms;
+
+    // Samples sent raw by a burst
+    uint16_t burst_samples;
+
+    // Distance from the mean of the last window, in standard deviations and in counts, that makes a
+    // sample an anomaly. anomaly_sigmas = 0 disables the anomaly bursts
+    uint8_t anomaly_sigmas;
+    uint16_t anomaly_min_delta;
+} Sample_Summary_Config;
+
+typedef struct
+{
+    Sample_Summary_Config config;
+    Sample_Summary_Write write;
+    void *write_context;
+
+    // Current window: its start, its samples, and the sums of the values and of their squares of each
+    // channel (red, green, blue, clear)
+    uint8_t has_window;
+    uint32_t start_ms;
+    uint16_t samples;
+    uint16_t raw_samples;
+    uint16_t min[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint16_t max[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint32_t sum[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint64_t sum_squares[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint16_t classes[BOARD_PROTOCOL_SUMMARY_CLASSES];
+
+    // Reference of the anomalies: mean of the last window, and the distance from it that makes a sample
+    // an anomaly. It is cleared by an anomaly burst and set again by the next window
+    uint8_t has_reference;
+    uint16_t reference_mean[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint32_t reference_threshold[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+
+    // Samples left to send raw in the current burst
+    uint16_t burst_left;
+
+    // Statistics: windows and samples, raw samples and bursts by cause, and bytes sent
+    uint32_t windows;
+    uint32_t total_samples;
+    uint32_t raw_sent;
+    uint32_t anomalies;
+    uint32_t requests;
+    uint32_t bytes;
+} Sample_Summary;
+
+// Default configuration built from the SAMPLE_SUMMARY_* constants above
+extern const Sample_Summary_Config Sample_Summary_Default_Config;
+
+/**
+ * @brief Initializes the summary without a window.
+ *
+ * @param summary       Pointer to the summary.
+ * @param config        Pointer to the configuration, which is copied.
+ * @param write         Function that writes the frames.
+ * @param write_context Context passed to the write function.
+ *
+ * @return None
+ */
+void Sample_Summary_Init(Sample_Summary *summary, const Sample_Summary_Config *config, Sample_Summary_Write write,
+                         void *write_context);
+
+/**
+ * @brief Adds a sample to its window. Sends the previous window when the sample is past its end, and
+ *        the sample itself when it is part of a raw burst.
+ *
+ * @param summary Pointer to the summary.
+ * @param time_ms Board time of the sample, which wraps at 2^32.
+ * @param data    The calibrated sample.
+ * @param color   The color class of the sample.
+ *
+ * @return SAMPLE_SUMMARY_WINDOW_SENT, SAMPLE_SUMMARY_RAW_SENT and SAMPLE_SUMMARY_ANOMALY flags.
+ */
+uint8_t Sample_Summary_Add(Sample_Summary *summary, uint32_t time_ms, const PMOD_Color_Data *data, Color_t color);
+
+/**
+ * @brief Sends the next burst_samples samples raw, from the next sample on. A burst in progress is
+ *        extended to burst_samples from now.
+ *
+ * @param summary Pointer to the summary.
+ *
+ * @return None
+ */
+void Sample_Summary_Request_Burst(Sample_Summary *summary);
+
+/**
+ * @brief Sends the current window now if it has samples, for example before the board stops sampling.
+ *        The next sample starts a new window.
+ *
+ * @param summary Pointer to the summary.
+ *
+ * @return None
+ */
+void Sample_Summary_Flush(Sample_Summary *summary);
+
+/**
+ * @brief Prints the statistics with printf, on lines starting with "summary:".
+ *
+ * @param summary Pointer to the summary.
+ *
+ * @return None
+ */
+void Sample_Summary_Print_Stats(const Sample_Summary *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SAMPLE_SUMMARY_H_ */
@@ -0,0 +1,175 @@
+/**
+ * @file Simon_Game.h
+ * @brief Header file for the Simon_Game module.
+ *
+ * This file contains the function definitions for the game logic of the Simon Says color game:
+ * generating a random pattern of colors and checking the colors presented by the player.
+ * The state of a game, including its random number generator, is kept in a Simon_Game struct,
+ * so several games can run independently and a game is reproducible from its seed.
+ *
+ * Two modes check the detected colors:
+ *   - SIMON_GAME_MODE_RESTART: the colors must follow the pattern from its first color, and the
+ *     pattern restarts after SIMON_GAME_MAX_FAILS consecutive wrong colors.
+ *   - SIMON_GAME_MODE_CONTINUOUS: the pattern is accepted anywhere in the stream of color events.
+ *     A KMP automaton keeps the longest end of the stream that is a start of the pattern, so a wrong
+ *     color only falls back to the partial match it still leaves, and the game never restarts.
+ *
+ * In the continuous mode, Simon_Game_Debounce turns every classified sample into color events: a
+ * color becomes an event once it has been stable for SIMON_GAME_STABLE_US, and the same object is
+ * not counted twice until the background has been seen for SIMON_GAME_RELEASE_US.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_SIMON_GAME_H_
+#define INC_SIMON_GAME_H_
+
+#include <stdint.h>
+#include "Color_Classifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIMON_GAME_PATTERN_LENGTH               4
+
+// Number of consecutive wrong colors that restart the pattern
+#define SIMON_GAME_MAX_FAILS                    2
+
+// Time a color must be stable to become an event, and time without a color that ends the
+// presentation of an object (continuous mode)
+#define SIMON_GAME_STABLE_US                    150000
+#define SIMON_GAME_RELEASE_US                   100000
+
+// Results returned by Simon_Game_Check
+#define SIMON_GAME_IGNORED                      -1
+#define SIMON_GAME_WRONG                        0
+#define SIMON_GAME_STEP                         1
+#define SIMON_GAME_COMPLETE                     2
+#define SIMON_GAME_MISS                         3
+
+// Modes selected with Simon_Game_Set_Mode
+#define SIMON_GAME_MODE_RESTART                 0
+#define SIMON_GAME_MODE_CONTINUOUS              1
+
+// Debouncer of color events: the color being sampled and for how long, the color of the last event
+// (COLOR_UNKNOWN once the object has been removed) and the time without a color
+typedef struct
+{
+    uint32_t stable_time_us;
+    uint32_t release_time_us;
+    Color_t candidate;
+    uint32_t stable_us;
+    Color_t last_event;
+    uint32_t release_us;
+} Simon_Debouncer;
+
+typedef struct
+{
+    Color_t pattern[SIMON_GAME_PATTERN_LENGTH];
+    uint8_t index;
+    uint8_t fail_count;
+    uint8_t mode;
+    uint32_t random_state;
+
+    // Debouncer of the continuous mode, with SIMON_GAME_STABLE_US and SIMON_GAME_RELEASE_US
+    Simon_Debouncer debouncer;
+
+    // KMP failure function of the pattern: fallback[i] is the length of the longest proper prefix
+    // of pattern[0..i] that is also a suffix of it
+    uint8_t fallback[SIMON_GAME_PATTERN_LENGTH];
+} Simon_Game;
+
+/**
+ * @brief Initializes a game in SIMON_GAME_MODE_RESTART and seeds its random number generator.
+ *
+ * @param game Pointer to the game.
+ * @param seed The seed of the random number generator. A seed of 0 is replaced by a fixed nonzero value.
+ *
+ * @return None
+ */
+void Simon_Game_Init(Simon_Game *game, uint32_t seed);
+
+/**
+ * @brief Selects how the detected colors are checked, and restarts the pattern.
+ *
+ * @param game Pointer to the game.
+ * @param mode SIMON_GAME_MODE_RESTART or SIMON_GAME_MODE_CONTINUOUS.
+ *
+ * @return None
+ */
+void Simon_Game_Set_Mode(Simon_Game *game, uint8_t mode);
+
+/**
+ * @brief Generates a new random pattern of green, red and yellow and restarts the game.
+ *
+ * @param game Pointer to the game.
+ *
+ * @return None
+ */
+void Simon_Game_Generate_Pattern(Simon_Game *game);
+
+/**
+ * @brief Checks a detected color against the next color of the pattern.
+ *
+ * Unknown colors are ignored. In SIMON_GAME_MODE_RESTART, a wrong color is ignored once, and the
+ * pattern restarts from the beginning after SIMON_GAME_MAX_FAILS consecutive wrong colors.
+ *
+ * In SIMON_GAME_MODE_CONTINUOUS, the colors are the events of Simon_Game_Debounce. Each color event
+ * moves index to the longest partial match that ends with it: SIMON_GAME_STEP when there is one, even if a wrong color made it shorter,
+ * and SIMON_GAME_MISS when there is none (index 0). SIMON_GAME_COMPLETE is returned whenever the last
+ * SIMON_GAME_PATTERN_LENGTH events are the pattern, and the match continues from its overlap with
+ * the next occurrence. Presenting the whole pattern without a misread always completes it.
+ *
+ * @param game     Pointer to the game.
+ * @param detected The detected color.
+ *
+ * @return SIMON_GAME_IGNORED, SIMON_GAME_WRONG (restart needed), SIMON_GAME_STEP (correct so far),
+ *         SIMON_GAME_COMPLETE (full pattern matched) or SIMON_GAME_MISS (continuous mode only).
+ */
+int Simon_Game_Check(Simon_Game *game, Color_t detected);
+
+/**
+ * @brief Debounces the classified samples of the continuous mode into color events.
+ *
+ * @param game       Pointer to the game.
+ * @param detected   The color of the sample.
+ * @param elapsed_us Time covered by the sample (the sampling period).
+ *
+ * @return The color of a new event, to pass to Simon_Game_Check, or COLOR_UNKNOWN.
+ */
+Color_t Simon_Game_Debounce(Simon_Game *game, Color_t detected, uint32_t elapsed_us);
+
+/**
+ * @brief Initializes a debouncer with no color being sampled and no previous event.
+ *
+ * @param debouncer       Pointer to the debouncer.
+ * @param stable_time_us  Time a color must be stable to become an event.
+ * @param release_time_us Time without a color after which the same color is a new event.
+ *
+ * @return None
+ */
+void Simon_Debouncer_Init(Simon_Debouncer *debouncer, uint32_t stable_time_us, uint32_t release_time_us);
+
+/**
+ * @brief Passes one classified sample to a debouncer.
+ *
+ * @param debouncer  Pointer to the debouncer.
+ * @param detected   The color of the sample.
+ * @param elapsed_us Time covered by the sample (the sampling period).
+ *
+ * @return The color of a new event, or COLOR_UNKNOWN.
+ */
+Color_t Simon_Debouncer_Update(Simon_Debouncer *debouncer, Color_t detected, uint32_t elapsed_us);
+
+/**
+ * @brief Returns the next value of the random number generator of the game.
+ */
+uint32_t Simon_Game_Random(Simon_Game *game);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SIMON_GAME_H_ */
@@ -0,0 +1,162 @@
+/**
+ * @file Simon_Levels.h
+ * @brief Header file for the Simon_Levels module.
+ *
+ * This file contains the function definitions for the progressive version of the Simon Says color
+ * game. Each completed level adds one random color to the pattern, up to SIMON_LEVELS_MAX_LENGTH
+ * colors, and a wrong color or a color that comes too late starts a new game at the first level.
+ *
+ * The pattern is stored with 2 bits per color (green, red or yellow) in a packed array, so a
+ * pattern of 256 colors takes 64 bytes. The colors are read back with Simon_Levels_Get_Color.
+ *
+ * The timing of a level depends on its length: the display time of each color, the gap between two
+ * colors, the debounce times of the input and the time allowed for each color all shrink as the
+ * pattern grows. They are interpolated between the breakpoints of Simon_Levels_Timing_Table.
+ * The input is checked in strict order, one sample at a time with Simon_Levels_Update, which
+ * debounces the samples with the times of the level and enforces the input window.
+ *
+ * The module has no dependency on the hardware, so the host tools run exactly the same logic.
+ *
+ */
+
+#ifndef INC_SIMON_LEVELS_H_
+#define INC_SIMON_LEVELS_H_
+
+#include <stdint.h>
+#include "Color_Classifier.h"
+#include "Simon_Game.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Length of the pattern at the first level and longest pattern
+#define SIMON_LEVELS_FIRST_LENGTH               SIMON_GAME_PATTERN_LENGTH
+#define SIMON_LEVELS_MAX_LENGTH                 256
+
+// Bytes of the packed pattern (4 colors per byte)
+#define SIMON_LEVELS_PACKED_BYTES               (SIMON_LEVELS_MAX_LENGTH / 4)
+
+// Samples of the burst mode averaged by an Oversampler before each classification. At 2.4 ms per
+// sample, single samples are too noisy to stay stable for the debounce time of the first levels
+#define SIMON_LEVELS_OVERSAMPLING               4
+
+// Number of breakpoints in Simon_Levels_Timing_Table
+#define SIMON_LEVELS_TIMING_POINTS              4
+
+typedef struct
+{
+    // Pattern length at which these values apply
+    uint16_t length;
+
+    // Display time of each color and gap between two colors
+    uint16_t show_on_ms;
+    uint16_t show_off_ms;
+
+    // Debounce times of the input (see Simon_Debouncer_Init)
+    uint32_t stable_us;
+    uint32_t release_us;
+
+    // Longest time from the start of the input or the last correct color to the next color
+    uint32_t window_us;
+} Simon_Level_Timing;
+
+typedef struct
+{
+    // Pattern, 2 bits per color: color i is in bits 2 * (i % 4) of byte i / 4
+    uint8_t packed[SIMON_LEVELS_PACKED_BYTES];
+    uint16_t length;
+    uint16_t index;
+    uint32_t random_state;
+
+    Simon_Level_Timing timing;
+    Simon_Debouncer debouncer;
+
+    // Time since the start of the input or the last correct color, and whether the last game
+    // ended because a color came too late
+    uint32_t waiting_us;
+    uint8_t timed_out;
+} Simon_Levels;
+
+// Timing of the levels at SIMON_LEVELS_TIMING_POINTS pattern lengths, in increasing length order
+extern const Simon_Level_Timing Simon_Levels_Timing_Table[SIMON_LEVELS_TIMING_POINTS];
+
+/**
+ * @brief Initializes a game at the first level with a random pattern.
+ *
+ * @param levels Pointer to the game.
+ * @param seed   The seed of the random number generator. A seed of 0 is replaced by a fixed nonzero value.
+ *
+ * @return None
+ */
+void Simon_Levels_Init(Simon_Levels *levels, uint32_t seed);
+
+/**
+ * @brief Starts a new game at the first level with a new random pattern.
+ *
+ * @param levels Pointer to the game.
+ *
+ * @return None
+ */
+void Simon_Levels_Restart(Simon_Levels *levels);
+
+/**
+ * @brief Adds one random color to the pattern and selects the timing of the new length.
+ *
+ * At SIMON_LEVELS_MAX_LENGTH, the pattern is not extended and the last level is played again.
+ *
+ * @param levels Pointer to the game.
+ *
+ * @return None
+ */
+void Simon_Levels_Next_Level(Simon_Levels *levels);
+
+/**
+ * @brief Returns a color of the pattern.
+ *
+ * @param levels   Pointer to the game.
+ * @param position Position of the color, below levels->length.
+ *
+ * @return COLOR_GREEN, COLOR_RED or COLOR_YELLOW.
+ */
+Color_t Simon_Levels_Get_Color(const Simon_Levels *levels, uint16_t position);
+
+/**
+ * @brief Computes the timing of a level by linear interpolation in Simon_Levels_Timing_Table.
+ *
+ * @param length Length of the pattern of the level.
+ * @param timing Pointer that receives the timing.
+ *
+ * @return None
+ */
+void Simon_Levels_Get_Timing(uint16_t length, Simon_Level_Timing *timing);
+
+/**
+ * @brief Starts the input of the current level, after the pattern has been shown.
+ *
+ * @param levels Pointer to the game.
+ *
+ * @return None
+ */
+void Simon_Levels_Start_Input(Simon_Levels *levels);
+
+/**
+ * @brief Passes one classified sample of the input to the game.
+ *
+ * The samples are debounced into color events with the times of the level. Each event must be the
+ * next color of the pattern, and must come within the window of the level.
+ *
+ * @param levels     Pointer to the game.
+ * @param detected   The color of the sample.
+ * @param elapsed_us Time covered by the sample (the sampling period).
+ *
+ * @return SIMON_GAME_IGNORED (no event), SIMON_GAME_STEP (correct so far), SIMON_GAME_COMPLETE
+ *         (level completed) or SIMON_GAME_WRONG (wrong color, or timed_out is set when too late).
+ */
+int Simon_Levels_Update(Simon_Levels *levels, Color_t detected, uint32_t elapsed_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SIMON_LEVELS_H_ */
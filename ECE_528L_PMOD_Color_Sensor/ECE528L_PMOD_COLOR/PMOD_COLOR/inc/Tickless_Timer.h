@@ -0,0 +1,212 @@
+/**
+ * @file Tickless_Timer.h
+ * @brief Header file for the Tickless_Timer module.
+ *
+ * This file contains the function definitions for a tickless timer service. Instead of a periodic
+ * interrupt that counts milliseconds, the service reads a free-running hardware counter for the time,
+ * and programs a one-shot alarm for the earliest pending event only. The processor is therefore
+ * interrupted when something is due (an LED toggle, a scheduled task or a timeout), and can sleep
+ * between these deadlines with Tickless_Timer_Sleep_ms.
+ *
+ * Time base: the 32-bit counter of the backend wraps around. It is extended in software into a 64-bit
+ * count of ticks since Tickless_Timer_Init, which never wraps. The service keeps an internal
+ * event every TICKLESS_TIMER_GUARD_TICKS so that the counter is read at least twice per wrap, even
+ * when nothing else is scheduled.
+ *
+ * Events: an event is a deadline in 64-bit ticks, an optional period and an optional callback. Pending
+ * events are kept in a list sorted by deadline, and events with the same deadline run in the order they
+ * were started. Callbacks run in the context of the alarm interrupt, outside of the lock, and may start
+ * or stop events, including their own. A periodic event keeps its phase: its next deadline is the
+ * previous one plus the period, and the periods missed by a late callback are skipped and counted.
+ *
+ * The backend provides the counter, the one-shot alarm, a lock against the alarm interrupt and the
+ * sleep instruction, so that the same code runs on the MSP432 (Tickless_Timer_MSP432, Timer32) and
+ * on a host computer in simulated time (Tickless_Timer_Sim).
+ *
+ */
+
+#ifndef INC_TICKLESS_TIMER_H_
+#define INC_TICKLESS_TIMER_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Longest time between two reads of the counter, half of its wrap period
+#define TICKLESS_TIMER_GUARD_TICKS              0x80000000UL
+
+// Longest alarm delay that a backend must support
+#define TICKLESS_TIMER_MAX_ALARM_TICKS          0xFFFFFFFFUL
+
+typedef struct Tickless_Timer_Event Tickless_Timer_Event;
+
+typedef void (*Tickless_Timer_Callback)(Tickless_Timer_Event *event);
+
+struct Tickless_Timer_Event
+{
+    // Deadline in ticks since Tickless_Timer_Init, and period (0 for a one-shot event)
+    uint64_t deadline;
+    uint32_t period_ticks;
+
+    // Called when the deadline is reached (may be NULL), with the event and its context
+    Tickless_Timer_Callback callback;
+    void *context;
+
+    // Next pending event, and whether the event is in the list
+    Tickless_Timer_Event *next;
+    volatile uint8_t pending;
+};
+
+typedef struct
+{
+    // Free-running counter that counts up and wraps at 2^32
+    uint32_t (*now)(void *context);
+
+    // Programs the one-shot alarm to interrupt after delay_ticks (0 means as soon as possible).
+    // The interrupt handler of the backend calls Tickless_Timer_Handle_Alarm
+    void (*set_alarm)(void *context, uint32_t delay_ticks);
+
+    // Disarms the alarm
+    void (*cancel_alarm)(void *context);
+
+    // Masks the alarm interrupt and returns the previous state, which unlock restores
+    uint32_t (*lock)(void *context);
+    void (*unlock)(void *context, uint32_t state);
+
+    // Called with the lock held: waits until an interrupt is pending. The interrupt is taken when
+    // the lock is released, so one that arrives before the wait is not lost
+    void (*idle)(void *context);
+} Tickless_Timer_Ops;
+
+typedef struct
+{
+    uint64_t ticks;
+    uint32_t counter;
+} Tickless_Timer_Base;
+
+typedef struct
+{
+    // Backend operations and backend-specific state
+    const Tickless_Timer_Ops *ops;
+    void *context;
+    uint32_t ticks_per_ms;
+
+    // 64-bit time base: ticks since Tickless_Timer_Init, and the counter value they were extended
+    // from. The locked sections publish each new base in the other copy and then advance the
+    // sequence, so that Tickless_Timer_Now reads a consistent copy without the lock, also from the
+    // interrupts that the lock does not mask
+    volatile Tickless_Timer_Base base[2];
+    volatile uint32_t base_sequence;
+
+    // Pending events sorted by deadline, and the internal event that keeps the time base extended
+    Tickless_Timer_Event *head;
+    Tickless_Timer_Event guard;
+
+    // Statistics: alarm interrupts, callbacks run, periods skipped by late periodic events, and the
+    // time spent in Tickless_Timer_Sleep_ms
+    uint32_t alarms;
+    uint32_t callbacks;
+    uint32_t overruns;
+    uint64_t idle_ticks;
+} Tickless_Timer;
+
+/**
+ * @brief Initializes the service on a backend. Called by the Init function of the backend.
+ *
+ * @param timer        Pointer to the service.
+ * @param ops          Backend operations.
+ * @param context      Backend-specific state passed to the operations.
+ * @param ticks_per_ms Counter frequency in ticks per millisecond.
+ *
+ * @return None
+ */
+void Tickless_Timer_Init(Tickless_Timer *timer, const Tickless_Timer_Ops *ops, void *context, uint32_t ticks_per_ms);
+
+/**
+ * @brief Returns the time in ticks since Tickless_Timer_Init. It does not take the lock, so it may be
+ *        called from interrupts of a higher priority than the alarm.
+ */
+uint64_t Tickless_Timer_Now(Tickless_Timer *timer);
+
+/**
+ * @brief Returns the time in milliseconds since Tickless_Timer_Init, modulo 2^32 (about 49.7 days).
+ */
+uint32_t Tickless_Timer_Now_ms(Tickless_Timer *timer);
+
+/**
+ * @brief Converts milliseconds to ticks.
+ */
+uint32_t Tickless_Timer_Ticks_From_ms(const Tickless_Timer *timer, uint32_t ms);
+
+/**
+ * @brief Starts an event, or restarts it if it is pending.
+ *
+ * @param timer        Pointer to the service.
+ * @param event        Pointer to the event, which must stay valid while it is pending.
+ * @param delay_ticks  Time from now to the first deadline.
+ * @param period_ticks Time between the following deadlines, or 0 for a one-shot event.
+ * @param callback     Function called at each deadline, or NULL.
+ * @param context      Passed to the callback in event->context.
+ *
+ * @return None
+ */
+void Tickless_Timer_Start(Tickless_Timer *timer, Tickless_Timer_Event *event, uint32_t delay_ticks, uint32_t period_ticks,
+                          Tickless_Timer_Callback callback, void *context);
+
+/**
+ * @brief Stops an event. Nothing happens if it is not pending.
+ */
+void Tickless_Timer_Stop(Tickless_Timer *timer, Tickless_Timer_Event *event);
+
+/**
+ * @brief Runs the callbacks of the events that are due and programs the alarm for the next deadline.
+ *
+ * Called by the alarm interrupt handler of the backend. An early or spurious alarm only reprograms it.
+ *
+ * @param timer Pointer to the service.
+ *
+ * @return None
+ */
+void Tickless_Timer_Handle_Alarm(Tickless_Timer *timer);
+
+/**
+ * @brief Sleeps with the idle operation of the backend until a delay has passed.
+ *
+ * Other interrupts wake the processor and are served, and the sleep goes on until the deadline.
+ * It must be called with interrupts enabled and not from a callback, since the alarm interrupt
+ * ends the sleep.
+ *
+ * @param timer       Pointer to the service.
+ * @param delay_ticks The delay in ticks.
+ *
+ * @return None
+ */
+void Tickless_Timer_Sleep(Tickless_Timer *timer, uint32_t delay_ticks);
+
+/**
+ * @brief Sleeps for a number of milliseconds (see Tickless_Timer_Sleep).
+ */
+void Tickless_Timer_Sleep_ms(Tickless_Timer *timer, uint32_t ms);
+
+/**
+ * @brief Sleeps for a number of microseconds (see Tickless_Timer_Sleep).
+ */
+void Tickless_Timer_Sleep_us(Tickless_Timer *timer, uint32_t us);
+
+/**
+ * @brief Prints the alarm rate and the idle time since Tickless_Timer_Init with printf, on a line
+ *        that starts with "timer: ".
+ *
+ * @param timer Pointer to the service.
+ *
+ * @return None
+ */
+void Tickless_Timer_Print_Stats(Tickless_Timer *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TICKLESS_TIMER_H_ */
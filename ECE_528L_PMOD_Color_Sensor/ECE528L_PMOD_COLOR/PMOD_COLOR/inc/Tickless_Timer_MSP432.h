@@ -0,0 +1,44 @@
+/**
+ * @file Tickless_Timer_MSP432.h
+ * @brief Header file for the Tickless_Timer_MSP432 backend.
+ *
+ * This file contains the function definitions for running the tickless timer service (see
+ * Tickless_Timer.h) on the two Timer32 counters of the MSP432P401R:
+ *   - Timer32_1 runs free in 32-bit mode without interrupts and provides the counter,
+ *   - Timer32_2 runs in one-shot mode and raises T32_INT2 when the alarm is due.
+ * Both count MCLK / 16, so at 48 MHz a tick lasts 333 ns and the counter wraps every 23.9 minutes.
+ *
+ * The lock is a critical section at the priority of T32_INT2 (see Critical_Section.h), so the
+ * interrupts of higher priority, such as the bumper switches, are not delayed by the service. The
+ * idle operation executes WFI with the mask moved to PRIMASK, since WFI does not wake for an interrupt
+ * that BASEPRI masks. Timer32 runs from MCLK, so the processor sleeps in LPM0 between deadlines; the
+ * deeper modes would stop the counter.
+ *
+ */
+
+#ifndef INC_TICKLESS_TIMER_MSP432_H_
+#define INC_TICKLESS_TIMER_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "Tickless_Timer.h"
+
+// Counter frequency with the 48 MHz MCLK of Clock_Init48MHz and the prescaler of 16
+#define TICKLESS_TIMER_MSP432_TICKS_PER_MS      3000
+
+// Priority of the T32_INT2 interrupt, from 1 (highest that the lock can mask) to 7
+#define TICKLESS_TIMER_MSP432_PRIORITY          2
+
+/**
+ * @brief Starts Timer32_1 and Timer32_2, enables the T32_INT2 interrupt and initializes the service.
+ *
+ * Interrupts must be enabled afterwards (EnableInterrupts) for the events to run.
+ *
+ * @param timer    Pointer to the service. It must stay valid, since the interrupt handler uses it.
+ * @param priority Priority of the T32_INT2 interrupt, from 1 to 7.
+ *
+ * @return None
+ */
+void Tickless_Timer_MSP432_Init(Tickless_Timer *timer, uint32_t priority);
+
+#endif /* INC_TICKLESS_TIMER_MSP432_H_ */
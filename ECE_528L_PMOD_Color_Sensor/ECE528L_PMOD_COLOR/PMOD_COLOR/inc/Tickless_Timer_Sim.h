@@ -0,0 +1,89 @@
+/**
+ * @file Tickless_Timer_Sim.h
+ * @brief Header file for the Tickless_Timer_Sim backend.
+ *
+ * This file contains the function definitions for running the tickless timer service (see
+ * Tickless_Timer.h) in simulated time on a host computer, so that its scheduling can be checked
+ * without a board.
+ *
+ * The simulated counter starts at a chosen value, so that its wraparound can be reached quickly.
+ * Time only moves forward in Tickless_Timer_Sim_Advance (busy time of the simulated program) and in
+ * the idle operation, which jumps to the alarm. The alarm interrupt is raised exactly at its deadline
+ * and taken as soon as the lock is released, like on the MSP432. It does not preempt itself, so the
+ * callbacks may advance the time to simulate their own duration. A hook can run after any read of the
+ * counter, to reach the reads of the time from interrupts that the lock does not mask.
+ *
+ */
+
+#ifndef INC_TICKLESS_TIMER_SIM_H_
+#define INC_TICKLESS_TIMER_SIM_H_
+
+#include <stdint.h>
+#include "Tickless_Timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Tickless_Timer_Sim_Context Tickless_Timer_Sim_Context;
+
+// Called after a read of the counter; may call Tickless_Timer_Now and advance the time
+typedef void (*Tickless_Timer_Sim_Hook)(Tickless_Timer_Sim_Context *context);
+
+struct Tickless_Timer_Sim_Context
+{
+    // Simulated time in ticks, and the counter value at time 0
+    uint64_t time;
+    uint32_t counter_start;
+
+    // One-shot alarm, and an alarm interrupt raised but not taken yet
+    uint8_t alarm_armed;
+    uint64_t alarm_time;
+    uint8_t interrupt_pending;
+
+    // Lock state, and whether the alarm interrupt handler is running
+    uint8_t locked;
+    uint8_t in_interrupt;
+
+    Tickless_Timer *timer;
+
+    // Runs after each read of the counter, as an interrupt of a higher priority than the alarm could,
+    // including in the locked sections (may be NULL). It is not called again while it runs
+    Tickless_Timer_Sim_Hook hook;
+    void *hook_context;
+    uint8_t in_hook;
+
+    // Activity: alarm interrupts taken, calls of the idle operation and the time they skipped
+    uint64_t interrupts;
+    uint64_t idle_calls;
+    uint64_t idle_ticks;
+};
+
+/**
+ * @brief Initializes the service on a simulated counter.
+ *
+ * @param timer         Pointer to the service.
+ * @param context       Pointer to the simulated timer, which must stay valid while the service is in use.
+ * @param counter_start Value of the counter at time 0.
+ * @param ticks_per_ms  Counter frequency in ticks per millisecond.
+ *
+ * @return None
+ */
+void Tickless_Timer_Sim_Init(Tickless_Timer *timer, Tickless_Timer_Sim_Context *context, uint32_t counter_start, uint32_t ticks_per_ms);
+
+/**
+ * @brief Advances the simulated time by some busy time, and takes the alarm interrupts that fall in it
+ *        at their exact times.
+ *
+ * @param context Pointer to the simulated timer.
+ * @param ticks   The busy time.
+ *
+ * @return None
+ */
+void Tickless_Timer_Sim_Advance(Tickless_Timer_Sim_Context *context, uint64_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TICKLESS_TIMER_SIM_H_ */
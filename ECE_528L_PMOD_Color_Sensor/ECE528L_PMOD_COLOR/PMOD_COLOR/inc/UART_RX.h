@@ -0,0 +1,166 @@
+/**
+ * @file UART_RX.h
+ * @brief Header file for the UART_RX module.
+ *
+ * This file contains the function definitions for receiving a UART with DMA into a circular buffer,
+ * with the frames of the input delimited by idle time on the line. EUSCI_A0_UART_InChar waits for
+ * each byte; here the DMA stores the bytes without the processor, which only takes one interrupt per
+ * half of the buffer and a periodic idle check, and reads whole blocks when it has time.
+ *
+ * Buffer: the DMA fills the two halves of the buffer in turn (ping-pong). When it completes a half, it
+ * continues with the other one, and its interrupt calls UART_RX_Handle_DMA, which arms the completed
+ * half again for the next lap. The position of the DMA is the number of completed halves and the
+ * transfers left in the active half, so the bytes received are counted exactly without a lock. The
+ * interrupt must run within the time of half a buffer.
+ *
+ * Reader: UART_RX_Read copies the received bytes in order. If the reader falls more than a whole
+ * buffer behind, the DMA has overwritten the oldest bytes: they are counted as overruns and the
+ * reader continues with the oldest byte still in the buffer.
+ *
+ * Idle line: a periodic timer interrupt calls UART_RX_Check_Idle. When the position did not change
+ * during idle_checks check periods in a row, the bytes since the last boundary are a frame, and its
+ * end is queued. A gap shorter than idle_checks periods never ends a frame, and a gap of one more
+ * period always does. UART_RX_Frame_Length takes the end of each frame in turn.
+ *
+ * The backend provides the state of the DMA and arms its halves, so that the same code runs on the
+ * MSP432 (UART_RX_MSP432, the µDMA and Timer_A1) and on a host computer against a simulated DMA
+ * (UART_RX_Sim).
+ *
+ */
+
+#ifndef INC_UART_RX_H_
+#define INC_UART_RX_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Size of the buffer (a power of two), and of each half, which the µDMA transfers in one cycle of at most 1024
+#define UART_RX_BUFFER_SIZE                     2048
+#define UART_RX_HALF_SIZE                       (UART_RX_BUFFER_SIZE / 2)
+
+// Ends of frames queued for the reader
+#define UART_RX_MAX_FRAMES                      16
+
+typedef struct
+{
+    // Half of the buffer that the DMA is writing (0 or 1)
+    uint8_t (*active_half)(void *context);
+
+    // Transfers left in a half: its length right after it is armed, and 0 once it is complete
+    uint32_t (*remaining)(void *context, uint8_t half);
+
+    // Arms a completed half for its next cycle
+    void (*arm)(void *context, uint8_t half, uint8_t *destination, uint32_t length);
+} UART_RX_Ops;
+
+typedef struct
+{
+    // Backend operations and backend-specific state
+    const UART_RX_Ops *ops;
+    void *context;
+
+    uint8_t buffer[UART_RX_BUFFER_SIZE];
+
+    // Halves completed by the DMA, counted by the DMA interrupt, and bytes consumed by the reader
+    volatile uint32_t completed;
+    volatile uint32_t tail;
+
+    // Idle checks: position at the last check, checks without a new byte, checks that end a frame, and
+    // the position of the last frame end
+    uint32_t last_head;
+    uint32_t quiet_checks;
+    uint32_t idle_checks;
+    uint32_t frame_end;
+
+    // Frame ends queued by UART_RX_Check_Idle for the reader
+    volatile uint32_t frame_ends[UART_RX_MAX_FRAMES];
+    volatile uint32_t frames_head;
+    volatile uint32_t frames_tail;
+
+    // Statistics: frames, frame ends dropped because the queue was full, bytes lost to overruns,
+    // the most bytes waiting for the reader, DMA interrupts and idle checks
+    uint32_t frames;
+    uint32_t dropped_frames;
+    uint32_t overruns;
+    uint32_t max_pending;
+    uint32_t dma_interrupts;
+    uint32_t checks;
+} UART_RX;
+
+/**
+ * @brief Initializes the receiver and arms both halves of the buffer. Called by the Init function of
+ *        the backend, before the DMA is started.
+ *
+ * @param rx          Pointer to the receiver.
+ * @param ops         Backend operations.
+ * @param context     Backend-specific state passed to the operations.
+ * @param idle_checks Check periods without a byte that end a frame (at least 1).
+ *
+ * @return None
+ */
+void UART_RX_Init(UART_RX *rx, const UART_RX_Ops *ops, void *context, uint32_t idle_checks);
+
+/**
+ * @brief Returns the number of bytes received since UART_RX_Init, modulo 2^32.
+ */
+uint32_t UART_RX_Head(UART_RX *rx);
+
+/**
+ * @brief Counts the completed half and arms it again. Called by the DMA interrupt handler of the backend.
+ */
+void UART_RX_Handle_DMA(UART_RX *rx);
+
+/**
+ * @brief Ends the current frame when the line has been idle for idle_checks calls. Called by the
+ *        periodic timer interrupt of the backend, at the priority of the DMA interrupt.
+ */
+void UART_RX_Check_Idle(UART_RX *rx);
+
+/**
+ * @brief Returns the number of received bytes that have not been read, up to UART_RX_BUFFER_SIZE.
+ */
+uint32_t UART_RX_Available(UART_RX *rx);
+
+/**
+ * @brief Copies received bytes in order. Called from the main program only.
+ *
+ * @param rx   Pointer to the receiver.
+ * @param data Output buffer.
+ * @param max  Size of the output buffer.
+ *
+ * @return The number of bytes copied (0 when none was received).
+ */
+uint32_t UART_RX_Read(UART_RX *rx, uint8_t *data, uint32_t max);
+
+/**
+ * @brief Takes the end of the next complete frame. Called from the main program only.
+ *
+ * The length counts the bytes of the frame from the next byte that UART_RX_Read returns, which the
+ * caller reads next. It is shorter than the frame, down to 0, when the caller has read the start of
+ * the frame already (a frame longer than the buffer has to be read before it ends) or lost it to an
+ * overrun.
+ *
+ * @param rx     Pointer to the receiver.
+ * @param length Set to the bytes of the frame left to read.
+ *
+ * @return 1 when a frame has ended, or 0.
+ */
+uint8_t UART_RX_Frame_Length(UART_RX *rx, uint32_t *length);
+
+/**
+ * @brief Prints the statistics of the receiver with printf, on a line starting with "uart rx:".
+ *
+ * @param rx Pointer to the receiver.
+ *
+ * @return None
+ */
+void UART_RX_Print_Stats(UART_RX *rx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_RX_H_ */
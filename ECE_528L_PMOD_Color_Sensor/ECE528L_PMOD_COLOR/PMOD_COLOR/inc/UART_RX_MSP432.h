@@ -0,0 +1,63 @@
+/**
+ * @file UART_RX_MSP432.h
+ * @brief Header file for the UART_RX_MSP432 backend.
+ *
+ * This file contains the function definitions for receiving EUSCI_A0 (see UART_RX.h) with the µDMA of
+ * the MSP432P401R. Channel 1 is triggered by the receive flag of EUSCI_A0 and runs in ping-pong mode:
+ * its primary structure fills the first half of the buffer and its alternate structure the second. The
+ * completion of each half raises DMA_INT1, whose handler arms the half again. Timer_A1 counts SMCLK
+ * (12 MHz) in up mode and raises TA1_0 every UART_RX_MSP432_CHECK_US for the idle checks.
+ *
+ * At 115200 baud, a half of 1024 bytes takes 89 ms, so the DMA interrupt comes about 11 times per
+ * second instead of 11520 times for an interrupt per byte, and the DMA interrupt may be delayed by up
+ * to a half of the buffer without losing a byte. With the default check period and
+ * UART_RX_MSP432_IDLE_CHECKS, a gap of less than 2 ms never ends a frame and a gap of 3 ms always does.
+ *
+ * Both interrupts have the same priority, so they never preempt each other. While the receiver runs,
+ * the DMA takes every received byte: EUSCI_A0_UART_InChar must not be used, and the bytes read are passed
+ * to Bootloader_MSP432_Enter_Byte.
+ *
+ */
+
+#ifndef INC_UART_RX_MSP432_H_
+#define INC_UART_RX_MSP432_H_
+
+#include <stdint.h>
+#include "msp.h"
+#include "UART_RX.h"
+
+// µDMA channel triggered by the EUSCI_A0 receive flag (source 1 of channel 1)
+#define UART_RX_MSP432_CHANNEL                  1
+#define UART_RX_MSP432_SOURCE                   1
+
+// Period of the idle checks, and the checks without a byte that end a frame
+#define UART_RX_MSP432_CHECK_US                 1000
+#define UART_RX_MSP432_IDLE_CHECKS              2
+
+// Priority of the DMA_INT1 and TA1_0 interrupts
+#define UART_RX_MSP432_PRIORITY                 3
+
+/**
+ * @brief Initializes the receiver, starts the µDMA on EUSCI_A0 and starts Timer_A1 for the idle checks.
+ *
+ * EUSCI_A0 must have been initialized (EUSCI_A0_UART_Init_Printf). Interrupts must be enabled
+ * afterwards (EnableInterrupts) for the halves to be armed again.
+ *
+ * @param rx          Pointer to the receiver. It must stay valid, since the interrupt handlers use it.
+ * @param check_us    Period of the idle checks in microseconds, from 100 to 5000.
+ * @param idle_checks Check periods without a byte that end a frame.
+ * @param priority    Priority of the DMA_INT1 and TA1_0 interrupts.
+ *
+ * @return None
+ */
+void UART_RX_MSP432_Init(UART_RX *rx, uint32_t check_us, uint32_t idle_checks, uint32_t priority);
+
+/**
+ * @brief Stops the µDMA channel and Timer_A1, and gives the receive flag of EUSCI_A0 back to polling.
+ *        The bytes in the buffer can still be read.
+ *
+ * @return None
+ */
+void UART_RX_MSP432_Stop(void);
+
+#endif /* INC_UART_RX_MSP432_H_ */
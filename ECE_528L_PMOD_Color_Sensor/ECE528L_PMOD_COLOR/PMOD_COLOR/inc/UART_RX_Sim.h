@@ -0,0 +1,80 @@
+/**
+ * @file UART_RX_Sim.h
+ * @brief Header file for the UART_RX_Sim backend.
+ *
+ * This file contains the function definitions for running the UART receiver (see UART_RX.h) on a host
+ * computer against a simulated ping-pong DMA, so that bursts of input can be checked without a board.
+ *
+ * Like the µDMA, the simulated DMA writes each received byte to the active half and, after the last
+ * byte of a half, continues with the other one and raises its interrupt. The interrupt is only taken
+ * when the caller decides, so that any interrupt latency can be simulated. A byte that arrives while
+ * the active half has not been armed again is lost, as the stopped µDMA channel would leave it in
+ * RXBUF to be overwritten.
+ *
+ */
+
+#ifndef INC_UART_RX_SIM_H_
+#define INC_UART_RX_SIM_H_
+
+#include <stdint.h>
+#include "UART_RX.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    UART_RX *rx;
+
+    // Structures of the two halves: destination, length, transfers left and whether they are armed
+    uint8_t *destination[2];
+    uint32_t length[2];
+    uint32_t remaining[2];
+    uint8_t armed[2];
+
+    // Half that receives the next byte, and the completions whose interrupt was not taken yet
+    uint8_t active;
+    uint32_t interrupt_pending;
+
+    // Bytes written by the DMA, and bytes lost because the active half was not armed
+    uint64_t received;
+    uint64_t lost;
+} UART_RX_Sim_Context;
+
+/**
+ * @brief Initializes the receiver on a simulated DMA.
+ *
+ * @param rx          Pointer to the receiver.
+ * @param context     Pointer to the simulated DMA, which must stay valid while the receiver is in use.
+ * @param idle_checks Check periods without a byte that end a frame.
+ *
+ * @return None
+ */
+void UART_RX_Sim_Init(UART_RX *rx, UART_RX_Sim_Context *context, uint32_t idle_checks);
+
+/**
+ * @brief Receives one byte: the DMA writes it to the active half, and raises the interrupt when the
+ *        half is complete.
+ *
+ * @param context Pointer to the simulated DMA.
+ * @param byte    The received byte.
+ *
+ * @return None
+ */
+void UART_RX_Sim_Receive(UART_RX_Sim_Context *context, uint8_t byte);
+
+/**
+ * @brief Takes the pending DMA interrupts, calling UART_RX_Handle_DMA once for each completed half.
+ *
+ * @param context Pointer to the simulated DMA.
+ *
+ * @return None
+ */
+void UART_RX_Sim_Take_Interrupt(UART_RX_Sim_Context *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_RX_SIM_H_ */
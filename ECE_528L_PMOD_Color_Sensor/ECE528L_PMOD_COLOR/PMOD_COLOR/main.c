@@ -26,65 +26,158 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
 #include "msp.h"
 #include "inc/Clock.h"
 #include "inc/CortexM.h"
+#include "inc/Critical_Section.h"
 #include "inc/EUSCI_A0_UART.h"
 #include "inc/PMOD_Color.h"
+#include "inc/Color_Sensor.h"
+#include "inc/Adaptive_Rate.h"
+#include "inc/Oversampler.h"
+#include "inc/Color_Classifier.h"
+#include "inc/Simon_Game.h"
+#include "inc/Simon_Levels.h"
+#include "inc/Reaction_Stats.h"
+#include "inc/Bootloader_MSP432.h"
 #include "inc/GPIO.h"
 #include "inc/Motor.h"
-#include "inc/SysTick_Interrupt.h"
+#include "inc/Tickless_Timer.h"
+#include "inc/Tickless_Timer_MSP432.h"
+#include "inc/Bumper_Switches.h"
+#include "inc/Bumper_Switches_MSP432.h"
+#include "inc/Floor_Tag.h"
+#include "inc/PC_Sampler.h"
+#include "inc/PC_Sampler_MSP432.h"
+#include "inc/UART_RX.h"
+#include "inc/UART_RX_MSP432.h"
+#include "inc/I2C_Trace.h"
+#include "inc/I2C_Trace_MSP432.h"
+#include "inc/Sample_Summary.h"
+#include "inc/Color_Names.h"
+
+// Set to 1 to play the progressive game of Simon_Levels instead of the 4-color pattern
+#define PLAY_LEVELS                             0
+
+// Set to 1 to enter the pattern as a tag of floor color patches (see Floor_Tag.h) that the robot
+// reads while it drives forward
+#define DRIVE_AND_SCAN                          0
+
+// Drive-and-scan: duty cycle of both motors and the speed it gives on the floor, which has to be
+// measured on the robot (there are no wheel encoders), the time to reach that speed, and the
+// longest drive before the tag is given up
+#define DRIVE_SCAN_DUTY_CYCLE                   2000
+#define DRIVE_SCAN_SPEED_MM_S                   150
+#define DRIVE_SCAN_SETTLE_MS                    200
+#define DRIVE_SCAN_MAX_MM                       1000
+
+// Set to 1 to profile the firmware: the PC is sampled in a Timer_A2 interrupt (see PC_Sampler_MSP432.h)
+// and the samples are sent as frames between the text lines, for host_tools/pc_profile
+#define PC_SAMPLING                             0
+
+// Set to 1 to receive EUSCI_A0 with the µDMA into a circular buffer (see UART_RX_MSP432.h) instead of
+// polling its receive flag for the bootloader request
+#define UART_RX_DMA                             0
+
+// Set to 1 to send one summary frame per window of samples instead of a text line per sample, with raw
+// bursts of SAMPLE frames on anomalies and on request of the host (see Sample_Summary.h)
+#define TELEMETRY_SUMMARY                       0
+
+// Set to 1 to print the nearest named color of the database in Color_Names_Table.c (see Color_Names.h)
+// instead of playing the game. A name is printed when it has been found for NAME_COLORS_STABLE_SAMPLES
+// samples in a row
+#define NAME_COLORS                             0
+#define NAME_COLORS_STABLE_SAMPLES              8
+
+// Period of the r=/g=/b= line in the burst mode of the adaptive rate controller. A line takes about
+// 1.9 ms at 115200 baud, which would nearly double the 2.4 ms sampling period if it were printed
+// for every sample
+#define BURST_PRINT_MS                          100
+
+// State of the Simon game, including the pattern and its random number generator
+Simon_Game game;
+
+// Reaction times of the player, measured from the end of each pattern display
+Reaction_Stats reaction_stats;
+
+// Set while the adaptive rate controller is in ADAPTIVE_RATE_BURST: the main loop prints the samples
+// once per BURST_PRINT_MS, and Detect_Color only prints the color when it changes
+uint8_t burst_sampling = 0;
+
+void Show_Color(Color_t color, uint16_t on_ms, uint16_t off_ms);
+void Show_Pattern(void);
+void Play_Levels(PMOD_Calibration_Data calibration_data);
+void Drive_And_Scan(PMOD_Calibration_Data calibration_data);
+void Name_Colors(PMOD_Calibration_Data calibration_data);
 
-typedef enum {
-    COLOR_GREEN = 0,
-    COLOR_RED   = 1,
-    COLOR_YELLOW = 2,
-    COLOR_UNKNOWN = 3
-} Color_t;
+Color_t Detect_Color(uint16_t R, uint16_t G, uint16_t B);
+Color_t Hold_Color(uint16_t R, uint16_t G, uint16_t B);
+void Watch_Delay_ms(Adaptive_Rate_Controller *rate_controller, PMOD_Calibration_Data calibration_data, uint32_t ms);
+void Drive(void (*move)(uint16_t, uint16_t), uint16_t left_duty_cycle, uint16_t right_duty_cycle, uint32_t ms);
+uint8_t Clear_Collision(void);
+void Host_Input_Byte(uint8_t byte);
+void Check_Host_Input(void);
 
-#define PATTERN_LENGTH 4
-Color_t pattern[PATTERN_LENGTH];
 
-void Generate_Random_Pattern(void);
-void Show_Pattern(void);
+// Toggle period of the chassis LEDs in milliseconds
+#define CHASSIS_LED_TOGGLE_MS                   500
 
-int CheckPattern(Color_t detected);
+// Tickless timer service: time base, timed events and sleeps between samples
+Tickless_Timer timer;
 
-Color_t Detect_Color(uint16_t R, uint16_t G, uint16_t B);
+// Periodic event that updates the chassis LEDs
+Tickless_Timer_Event chassis_led_event;
+
+// Bumper switches of the chassis, which stop the motors in PORT4_IRQHandler
+Bumper_Switches bumpers;
+
+#if PC_SAMPLING
+// Samples of the statistical profiler, taken in TA2_0_IRQHandler and sent by the main loop
+PC_Sampler pc_sampler;
+#endif
+
+#if UART_RX_DMA
+// Bytes received from the host by the µDMA, with the frames delimited by idle time in TA1_0_IRQHandler
+UART_RX uart_rx;
+#endif
 
+#if I2C_BUS_TRACE
+// Transfers of the color sensor bus, recorded by I2C_Bus_Transfer and sent by the main loop
+I2C_Trace i2c_trace;
+#endif
 
-// Initialize a global variable for SysTick to keep track of elapsed time in milliseconds
-uint32_t SysTick_ms_elapsed = 0;
+#if TELEMETRY_SUMMARY
+// Windowed statistics of the samples, sent instead of the text line of each sample
+Sample_Summary sample_summary;
+#endif
 
 // Global flag that gets set in Bumper_Switches_Handler.
 // This is used to detect if any collisions occurred when any one of the bumper switches are pressed.
-uint8_t collision_detected = 0;
+volatile uint8_t collision_detected = 0;
 
 /**
- * @brief Interrupt service routine for the SysTick timer.
+ * @brief Callback of the chassis LED event, run from the tickless timer interrupt every 500 ms.
  *
- * The interrupt service routine for the SysTick timer increments the SysTick_ms_elapsed
- * global variable to keep track of the elapsed milliseconds. If collision_detected is 0, then
- * it checks if 500 milliseconds passed. It toggles the front yellow LEDs and turns off the back red LEDs
+ * If collision_detected is 0, it toggles the front yellow LEDs and turns off the back red LEDs
  * on the chassis board. Otherwise, if collision_detected is set, it turns off the front yellow LEDs
  * and turns on the back red LEDs on the chassis board.
  *
- * @param None
+ * @param event The chassis LED event.
  *
  * @return None
  */
-void SysTick_Handler(void)
+void Chassis_LED_Handler(Tickless_Timer_Event *event)
 {
-    SysTick_ms_elapsed++;
+    (void)event;
+
+    // Bumper_Switches_Handler also writes P8 and has a higher priority: mask it during the update
+    uint32_t state = Critical_Section_Enter(BUMPER_SWITCHES_MSP432_PRIORITY);
 
     if (collision_detected == 0)
     {
-        if (SysTick_ms_elapsed >= 500)
-        {
-            P8->OUT &= ~0xC0;
-            P8->OUT ^= 0x21;
-            SysTick_ms_elapsed = 0;
-        }
+        P8->OUT &= ~0xC0;
+        P8->OUT ^= 0x21;
     }
 
     else
@@ -92,6 +185,53 @@ void SysTick_Handler(void)
         P8->OUT |= 0xC0;
         P8->OUT &= ~0x21;
     }
+
+    Critical_Section_Exit(state);
+}
+
+/**
+ * @brief Collision callback of the bumper switches, run from PORT4_IRQHandler after the motors are stopped.
+ *
+ * Sets collision_detected, and turns on the back red LEDs and turns off the front yellow LEDs right away
+ * instead of at the next toggle of Chassis_LED_Handler. The main loop clears collision_detected once
+ * all bumper switches are released.
+ *
+ * @param switches The closed switches (bit 0 = BUMP0).
+ * @param context  Unused.
+ *
+ * @return None
+ */
+void Bumper_Switches_Handler(uint8_t switches, void *context)
+{
+    (void)switches;
+    (void)context;
+
+    collision_detected = 1;
+    P8->OUT |= 0xC0;
+    P8->OUT &= ~0x21;
+}
+
+/**
+ * @brief Clears collision_detected once all bumper switches are released and the collision is acknowledged.
+ *
+ * The acknowledge and the clear run in one critical section at the priority of PORT4_IRQHandler, so a
+ * collision that Bumper_Switches_Handler posts between them is not lost. The tickless timer and the
+ * other interrupts of lower priority are not masked.
+ *
+ * @return 1 if collision_detected was cleared, or 0 if a bumper switch is still closed.
+ */
+uint8_t Clear_Collision(void)
+{
+    uint32_t state = Critical_Section_Enter(BUMPER_SWITCHES_MSP432_PRIORITY);
+    uint8_t clear = Bumper_Switches_Acknowledge(&bumpers);
+
+    if (clear)
+    {
+        collision_detected = 0;
+    }
+
+    Critical_Section_Exit(state);
+    return clear;
 }
 
 
@@ -104,6 +244,9 @@ int main(void)
     // Initialize the 48 MHz Clock
     Clock_Init48MHz();
 
+    // Start the cycle counter that times the critical sections
+    Critical_Section_Init();
+
     //Initialize GPIO
     LED2_Init();
     Buttons_Init();
@@ -112,14 +255,42 @@ int main(void)
     Timer_A0_PWM_Init(TIMER_A0_PERIOD_CONSTANT, 0, 0);
     Motor_Init();
 
-    // Initialize the SysTick timer to generate periodic interrupts every 1 ms
-    SysTick_Interrupt_Init(SYSTICK_INT_NUM_CLK_CYCLES, SYSTICK_INT_PRIORITY);
+    // Initialize the chassis LEDs driven by Chassis_LED_Handler and Bumper_Switches_Handler
+    Chassis_Board_LEDs_Init();
+
+    // Initialize the tickless timer on Timer32 and toggle the chassis LEDs every 500 ms. There is no
+    // periodic tick: the timer interrupts only at the next deadline, and the delays below sleep
+    Tickless_Timer_MSP432_Init(&timer, TICKLESS_TIMER_MSP432_PRIORITY);
+    Tickless_Timer_Start(&timer, &chassis_led_event, Tickless_Timer_Ticks_From_ms(&timer, CHASSIS_LED_TOGGLE_MS),
+                         Tickless_Timer_Ticks_From_ms(&timer, CHASSIS_LED_TOGGLE_MS), Chassis_LED_Handler, 0);
+
+    // Stop the motors on any edge of the bumper switches, in an interrupt of higher priority than the timer
+    Bumper_Switches_MSP432_Init(&bumpers, &timer, BUMPER_SWITCHES_MSP432_PRIORITY, Bumper_Switches_Handler, 0);
 
     // Initialize EUSCI_A0_UART
     EUSCI_A0_UART_Init_Printf();
 
-    // Initialize the PMOD Color module
-    PMOD_Color_Init();
+#if PC_SAMPLING
+    // Sample the PC from the first enabled interrupt on
+    PC_Sampler_MSP432_Init(&pc_sampler, PC_SAMPLER_MSP432_RATE_HZ, PC_SAMPLER_MSP432_PRIORITY);
+#endif
+
+#if UART_RX_DMA
+    // Receive the host input with the µDMA; the interrupts start with the first enabled one
+    UART_RX_MSP432_Init(&uart_rx, UART_RX_MSP432_CHECK_US, UART_RX_MSP432_IDLE_CHECKS, UART_RX_MSP432_PRIORITY);
+#endif
+
+    // Initialize the color sensor selected by Color_Sensor.h (the PMOD Color module on the MSP432)
+    Color_Sensor_Init();
+
+#if I2C_BUS_TRACE
+    // Trace the transfers of the sensor from its first sample on (see I2C_Trace.h)
+    I2C_Trace_MSP432_Init(&i2c_trace, PMOD_Color_Get_Bus());
+#endif
+
+#if TELEMETRY_SUMMARY
+    Sample_Summary_Init(&sample_summary, &Sample_Summary_Default_Config, EUSCI_A0_UART_Write_Frame, 0);
+#endif
 
     // Indicate that the PMDO Color module has been initialized and powered on
     printf("PMOD COLOR has been initialized and powered on.\n");
@@ -127,22 +298,55 @@ int main(void)
     // Enable the interrupts used by the modules
     EnableInterrupts();
 
+    // Measure the time from a bumper edge to the motor cutoff with the cycle counter
+    Bumper_Switches_MSP432_Latency bumper_latency;
+    Bumper_Switches_MSP432_Measure_Latency(&bumper_latency, 100);
+    Bumper_Switches_MSP432_Print_Latency(&bumper_latency);
+
     // Display the PMOD Color Device ID
-    printf("PMOD Color Device ID: 0x%02X\n", PMOD_Color_Get_Device_ID());
+    printf("%s Device ID: 0x%02X\n", Color_Sensor_Caps.name, Color_Sensor_Get_ID());
 
     // Declare structs for both raw and normalized PMOD Color data
     PMOD_Color_Data pmod_color_data;
     PMOD_Calibration_Data calibration_data;
 
-    pmod_color_data = PMOD_Color_Get_RGBC();
+    // Start sampling in the low-power idle mode of the adaptive rate controller
+    Adaptive_Rate_Controller rate_controller;
+    Adaptive_Rate_Init(&rate_controller, &Adaptive_Rate_Default_Config);
+    Color_Sensor_Set_Timing(Adaptive_Rate_Get_Integration_us(&rate_controller), Adaptive_Rate_Get_Wait_us(&rate_controller));
+    Tickless_Timer_Sleep_us(&timer, Adaptive_Rate_Get_Period_us(&rate_controller));
+
+    pmod_color_data = Adaptive_Rate_Normalize(&rate_controller, Color_Sensor_Read());
     calibration_data = PMOD_Color_Init_Calibration_Data(pmod_color_data);
-    Clock_Delay1us(2400);
+    Tickless_Timer_Sleep_us(&timer, 2400);
+
+#if PLAY_LEVELS
+    Play_Levels(calibration_data);
+#endif
+
+#if DRIVE_AND_SCAN
+    Drive_And_Scan(calibration_data);
+#endif
+
+#if NAME_COLORS
+    Name_Colors(calibration_data);
+#endif
 
-    srand(time(NULL)); // reset the rand()
+    Simon_Game_Init(&game, (uint32_t)time(NULL)); // seed the pattern generator
 
-    Generate_Random_Pattern();
+    // Accept the pattern anywhere in the stream of detected colors, so a misread does not restart
+    // the round. Select SIMON_GAME_MODE_RESTART for the original game
+    Simon_Game_Set_Mode(&game, SIMON_GAME_MODE_CONTINUOUS);
+
+    Reaction_Stats_Init(&reaction_stats);
+
+    Simon_Game_Generate_Pattern(&game);
     Show_Pattern();
 
+#if !TELEMETRY_SUMMARY
+    // Time of the last r=/g=/b= line
+    uint32_t print_ms = 0;
+#endif
 
     while(1)
     {
@@ -150,62 +354,159 @@ int main(void)
         // Uncomment the line below if you'd like to see the on-board LED
         PMOD_Color_LED_Control(PMOD_COLOR_ENABLE_LED);
 
-        // Sample the PMOD COLOR sensor every 50 ms
-        pmod_color_data = PMOD_Color_Get_RGBC();
+        // Sample the PMOD COLOR sensor once per conversion period of the current rate mode.
+        // The counts are scaled to the burst integration time before calibration so that
+        // the calibration range does not depend on the mode
+        PMOD_Color_Data raw_color_data = Color_Sensor_Read();
+        uint32_t sample_ms = Tickless_Timer_Now_ms(&timer);
+        pmod_color_data = Adaptive_Rate_Normalize(&rate_controller, raw_color_data);
+
+        // Switch between idle scanning and burst sampling when the scene changes or settles
+        if (Adaptive_Rate_Update(&rate_controller, raw_color_data))
+        {
+            Color_Sensor_Set_Timing(Adaptive_Rate_Get_Integration_us(&rate_controller), Adaptive_Rate_Get_Wait_us(&rate_controller));
+        }
+
+        burst_sampling = (Adaptive_Rate_Get_Mode(&rate_controller) == ADAPTIVE_RATE_BURST);
+
         PMOD_Color_Calibrate(pmod_color_data, &calibration_data);
         pmod_color_data = PMOD_Color_Normalize_Calibration(pmod_color_data, calibration_data);
-        printf("r=%04x g=%04x b=%04x\r\n", pmod_color_data.red, pmod_color_data.green, pmod_color_data.blue);
-        Clock_Delay1ms(50);
+#if TELEMETRY_SUMMARY
+        Sample_Summary_Add(&sample_summary, sample_ms, &pmod_color_data,
+                           Color_Classifier_Classify(&Color_Classifier_Default_Params, pmod_color_data.red, pmod_color_data.green, pmod_color_data.blue));
+#else
+        // In the burst mode, the line is printed without stretching the sampling period
+        if (!burst_sampling || ((sample_ms - print_ms) >= BURST_PRINT_MS))
+        {
+            printf("r=%04x g=%04x b=%04x\r\n", pmod_color_data.red, pmod_color_data.green, pmod_color_data.blue);
+            print_ms = sample_ms;
+        }
+#endif
+
+#if PC_SAMPLING
+        PC_Sampler_Flush(&pc_sampler, PC_SAMPLER_MSP432_FLUSH_FRAMES);
+#endif
+
+#if I2C_BUS_TRACE
+        I2C_Trace_Flush(&i2c_trace, I2C_TRACE_MSP432_FLUSH_FRAMES);
+#endif
+
+        Tickless_Timer_Sleep_us(&timer, Adaptive_Rate_Get_Period_us(&rate_controller));
+
+        // Reset into the UART bootloader when host_tools/boot_update requests it (see Bootloader_MSP432.h)
+        Check_Host_Input();
 
+        // Report the collision posted by PORT4_IRQHandler, and clear it once the bumpers are released
+        Bumper_Switches_Event collision;
+
+        if (Bumper_Switches_Take_Event(&bumpers, &collision))
+        {
+            printf("collision: switches 0x%02X at %lu ms\n", collision.switches, (unsigned long)collision.time_ms);
+        }
+
+        if (collision_detected)
+        {
+            Clear_Collision();
+        }
 
         uint16_t R = pmod_color_data.red;
         uint16_t G = pmod_color_data.green;
         uint16_t B = pmod_color_data.blue;
 
-        Color_t detect = Hold_Color(R, G, B);
+        Color_t detect;
 
-        int result = CheckPattern(detect);
+        // Time the color of the event was first seen: the sample itself when it is held, or the
+        // start of the stable run that the debouncer accepted
+        uint32_t detected_ms = sample_ms;
 
-        if (result == 1)
+        if (game.mode == SIMON_GAME_MODE_CONTINUOUS)
+        {
+            // Every sample is classified, and a color becomes an event once it has been stable
+            detect = Simon_Game_Debounce(&game, Detect_Color(R, G, B), Adaptive_Rate_Get_Period_us(&rate_controller));
+            detected_ms = sample_ms - (game.debouncer.stable_us / 1000);
+        }
+        else
+        {
+            detect = Hold_Color(R, G, B);
+        }
+
+        int result = Simon_Game_Check(&game, detect);
+
+        if ((result == SIMON_GAME_STEP) || (result == SIMON_GAME_COMPLETE))
+        {
+            Reaction_Step step = Reaction_Stats_Accept(&reaction_stats, detected_ms, Tickless_Timer_Now_ms(&timer));
+
+            if (step.step > 0)
+            {
+                printf("step %u: %lu ms after the pattern, %lu ms reaction, %lu ms pipeline\n", step.step,
+                       (unsigned long)step.since_start_ms, (unsigned long)step.reaction_ms, (unsigned long)step.pipeline_ms);
+            }
+        }
+
+        if (result == SIMON_GAME_STEP)
         {
             printf("Correct step!\n");
             LED2_Output(RGB_LED_WHITE);
-            Clock_Delay1ms(500);
+            Watch_Delay_ms(&rate_controller, calibration_data, 500);
             LED2_Output(RGB_LED_OFF);
 
         }
-        else if (result == 2)
+        else if (result == SIMON_GAME_COMPLETE)
         {
             printf("ACCESS GRANTED!\n");
+            Reaction_Stats_Complete(&reaction_stats, Tickless_Timer_Now_ms(&timer));
+            Adaptive_Rate_Print_Stats(&rate_controller);
+            Tickless_Timer_Print_Stats(&timer);
+            Bumper_Switches_Print_Stats(&bumpers);
+            Critical_Section_Print_Stats(BUMPER_SWITCHES_MSP432_PRIORITY);
+            Reaction_Stats_Print(&reaction_stats);
+#if PC_SAMPLING
+            PC_Sampler_MSP432_Print_Stats(&pc_sampler);
+#endif
+#if UART_RX_DMA
+            UART_RX_Print_Stats(&uart_rx);
+#endif
+#if I2C_BUS_TRACE
+            I2C_Trace_Print_Stats(&i2c_trace);
+#endif
+#if TELEMETRY_SUMMARY
+            Sample_Summary_Print_Stats(&sample_summary);
+#endif
             LED2_Output(RGB_LED_SKY_BLUE);
-            Clock_Delay1ms(3000);
+            Tickless_Timer_Sleep_ms(&timer, 3000);
             LED2_Output(RGB_LED_OFF);
 
-            Motor_Forward(3000, 3000);
-            Clock_Delay1ms(2000);
-            Motor_Backward(3000, 3000);
-            Clock_Delay1ms(2000);
+            Drive(Motor_Forward, 3000, 3000, 2000);
+            Drive(Motor_Backward, 3000, 3000, 2000);
             Motor_Stop();
 
-            Generate_Random_Pattern();
+            Simon_Game_Generate_Pattern(&game);
             Show_Pattern();
         }
-        else if (result == 0)
+        else if (result == SIMON_GAME_WRONG)
         {
             printf("Wrong! Restarting...\n");
+            Reaction_Stats_Fail(&reaction_stats);
             LED2_Output(RGB_LED_PINK);
-            Clock_Delay1ms(2500);
+            Tickless_Timer_Sleep_ms(&timer, 2500);
             LED2_Output(RGB_LED_OFF);
 
-            Clock_Delay1ms(500);
-            Motor_Left(4500, 4500);
-            Clock_Delay1ms(2000);
-            Motor_Right(4500, 4500);
-            Clock_Delay1ms(2000);
+            Tickless_Timer_Sleep_ms(&timer, 500);
+            Drive(Motor_Left, 4500, 4500, 2000);
+            Drive(Motor_Right, 4500, 4500, 2000);
             Motor_Stop();
 
             Show_Pattern();
         }
+        else if (result == SIMON_GAME_MISS)
+        {
+            // Continuous mode: the colors that still match are kept, so the pattern is not shown again
+            printf("Miss! Keep going...\n");
+            Reaction_Stats_Miss(&reaction_stats);
+            LED2_Output(RGB_LED_PINK);
+            Watch_Delay_ms(&rate_controller, calibration_data, 300);
+            LED2_Output(RGB_LED_OFF);
+        }
 
 
     }
@@ -213,34 +514,39 @@ int main(void)
 
 Color_t Detect_Color(uint16_t R, uint16_t G, uint16_t B)
 {
-    // ---- GREEN ----
-    if (G > R + 3000 && G > B + 3000)
-    {
-        printf("GREEN\n");
-        LED2_Output(RGB_LED_GREEN);
-        return COLOR_GREEN;
-    }
+    static Color_t previous_color = COLOR_UNKNOWN;
 
-    // ---- YELLOW ----
-    else if (R > 0x2000 && G > 0x2000 && B < 0x3000)
-    {
-        printf("YELLOW\n");
-        LED2_Output(RGB_LED_YELLOW);
-        return COLOR_YELLOW;
-    }
+    // The thresholds are defined in Color_Classifier_Config.h
+    Color_t color = Color_Classifier_Classify(&Color_Classifier_Default_Params, R, G, B);
 
-    // ---- RED  ----
-    else if (R > G + 6000 && R > B + 6000)
-    {
-        printf("RED\n");
-        LED2_Output(RGB_LED_RED);
-        return COLOR_RED;
-    }
-    else
+    // In the burst mode, the name is only printed when the color changes, so that the samples of a
+    // color shown to the sensor are not stretched by printf
+    uint8_t print = !burst_sampling || (color != previous_color);
+    previous_color = color;
+
+    switch (color)
     {
-        LED2_Output(RGB_LED_OFF);
-        return COLOR_UNKNOWN;
+        case COLOR_GREEN:
+            if (print) printf("GREEN\n");
+            LED2_Output(RGB_LED_GREEN);
+            break;
+
+        case COLOR_YELLOW:
+            if (print) printf("YELLOW\n");
+            LED2_Output(RGB_LED_YELLOW);
+            break;
+
+        case COLOR_RED:
+            if (print) printf("RED\n");
+            LED2_Output(RGB_LED_RED);
+            break;
+
+        default:
+            LED2_Output(RGB_LED_OFF);
+            break;
     }
+
+    return color;
 }
 
 Color_t Hold_Color(uint16_t R, uint16_t G, uint16_t B)
@@ -250,7 +556,7 @@ Color_t Hold_Color(uint16_t R, uint16_t G, uint16_t B)
     if (color != COLOR_UNKNOWN)
     {
         // Hold the detected color for 1 second
-        Clock_Delay1ms(1000);
+        Tickless_Timer_Sleep_ms(&timer, 1000);
 
         return color;  // return the locked-in color
     }
@@ -258,79 +564,406 @@ Color_t Hold_Color(uint16_t R, uint16_t G, uint16_t B)
     return COLOR_UNKNOWN;
 }
 
+void Watch_Delay_ms(Adaptive_Rate_Controller *rate_controller, PMOD_Calibration_Data calibration_data, uint32_t ms)
+{
+    if (game.mode != SIMON_GAME_MODE_CONTINUOUS)
+    {
+        Tickless_Timer_Sleep_ms(&timer, ms);
+        return;
+    }
+
+    // Keep sampling during the feedback so that an object removed meanwhile is released by the
+    // debouncer. The period stands for the time of each sample; the actual time is a little longer,
+    // which only makes the release later
+    uint32_t elapsed_us = 0;
+
+    while (elapsed_us < (ms * 1000))
+    {
+        uint32_t period_us = Adaptive_Rate_Get_Period_us(rate_controller);
+        PMOD_Color_Data color_data = Adaptive_Rate_Normalize(rate_controller, Color_Sensor_Read());
+
+        color_data = PMOD_Color_Normalize_Calibration(color_data, calibration_data);
+        Color_t color = Color_Classifier_Classify(&Color_Classifier_Default_Params, color_data.red, color_data.green, color_data.blue);
+
+#if TELEMETRY_SUMMARY
+        Sample_Summary_Add(&sample_summary, Tickless_Timer_Now_ms(&timer), &color_data, color);
+#endif
+
+#if PC_SAMPLING
+        PC_Sampler_Flush(&pc_sampler, PC_SAMPLER_MSP432_FLUSH_FRAMES);
+#endif
+
+#if I2C_BUS_TRACE
+        I2C_Trace_Flush(&i2c_trace, I2C_TRACE_MSP432_FLUSH_FRAMES);
+#endif
+
+        Tickless_Timer_Sleep_us(&timer, period_us);
+        elapsed_us += period_us;
+
+        // Only the background is passed: a color shown during the feedback is not an event
+        if (color == COLOR_UNKNOWN)
+        {
+            Simon_Game_Debounce(&game, COLOR_UNKNOWN, period_us);
+        }
+    }
+}
+
 
 
-void Generate_Random_Pattern(void)
+void Drive(void (*move)(uint16_t, uint16_t), uint16_t left_duty_cycle, uint16_t right_duty_cycle, uint32_t ms)
 {
-    for (int i = 0; i < PATTERN_LENGTH; i++)
+    // After a collision, the motors stay off and the step is skipped until the collision is acknowledged
+    if (Bumper_Switches_Drive(&bumpers, move, left_duty_cycle, right_duty_cycle))
     {
-        pattern[i] = rand() % 3;   // 0 = green, 1 = red, 2 = yellow
+        Tickless_Timer_Sleep_ms(&timer, ms);
     }
 }
 
+void Show_Color(Color_t color, uint16_t on_ms, uint16_t off_ms)
+{
+    switch(color)
+    {
+        case COLOR_GREEN:
+            LED2_Output(RGB_LED_GREEN);
+            break;
+
+        case COLOR_RED:
+            LED2_Output(RGB_LED_RED);
+            break;
+
+        case COLOR_YELLOW:
+            LED2_Output(RGB_LED_YELLOW);
+            break;
+
+        default:
+            break;
+    }
+
+    Tickless_Timer_Sleep_ms(&timer, on_ms);  // hold the color
+    LED2_Output(RGB_LED_OFF);
+    Tickless_Timer_Sleep_ms(&timer, off_ms);  // gap between colors
+}
 
 void Show_Pattern(void)
 {
-    for (int i = 0; i < PATTERN_LENGTH; i++)
+    for (int i = 0; i < SIMON_GAME_PATTERN_LENGTH; i++)
+    {
+        Show_Color(game.pattern[i], 700, 300);
+    }
+
+    // The reaction times of the round are measured from the end of the display
+    Reaction_Stats_Start_Round(&reaction_stats, Tickless_Timer_Now_ms(&timer));
+}
+
+void Play_Levels(PMOD_Calibration_Data calibration_data)
+{
+    Simon_Levels levels;
+    Oversampler oversampler;
+    Oversampler_Data averaged;
+
+    Simon_Levels_Init(&levels, (uint32_t)time(NULL));
+    Reaction_Stats_Init(&reaction_stats);
+
+    // Low-latency detection path: the sensor converts continuously with the burst timing of
+    // Adaptive_Rate, which is also the integration time the calibration refers to. Every
+    // SIMON_LEVELS_OVERSAMPLING samples are averaged and classified without printf or LED output,
+    // so the shortest debounce times of the last levels still span several classifications
+    uint32_t period_us = ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US;
+    Color_Sensor_Set_Timing(ADAPTIVE_RATE_BURST_INTEGRATION_US, ADAPTIVE_RATE_BURST_WAIT_US);
+    Oversampler_Init(&oversampler, SIMON_LEVELS_OVERSAMPLING, 0);
+
+    while (1)
     {
-        switch(pattern[i])
+        printf("Level %u: %u colors\n", levels.length - SIMON_LEVELS_FIRST_LENGTH + 1, levels.length);
+
+        for (uint16_t i = 0; i < levels.length; i++)
         {
-            case COLOR_GREEN:
-                LED2_Output(RGB_LED_GREEN);
-                break;
+            Show_Color(Simon_Levels_Get_Color(&levels, i), levels.timing.show_on_ms, levels.timing.show_off_ms);
+        }
 
-            case COLOR_RED:
-                LED2_Output(RGB_LED_RED);
-                break;
+        Simon_Levels_Start_Input(&levels);
+        Oversampler_Reset(&oversampler);
+        Reaction_Stats_Start_Round(&reaction_stats, Tickless_Timer_Now_ms(&timer));
 
-            case COLOR_YELLOW:
-                LED2_Output(RGB_LED_YELLOW);
-                break;
+        int result = SIMON_GAME_IGNORED;
+
+        while ((result != SIMON_GAME_COMPLETE) && (result != SIMON_GAME_WRONG))
+        {
+            PMOD_Color_Data color_data = PMOD_Color_Normalize_Calibration(Color_Sensor_Read(), calibration_data);
+            Tickless_Timer_Sleep_us(&timer, period_us);
+
+            if (!Oversampler_Add(&oversampler, color_data, &averaged))
+            {
+                continue;
+            }
+
+            Color_t color = Color_Classifier_Classify(&Color_Classifier_Default_Params, (uint16_t)averaged.red, (uint16_t)averaged.green, (uint16_t)averaged.blue);
+            result = Simon_Levels_Update(&levels, color, period_us * SIMON_LEVELS_OVERSAMPLING);
+
+            // The steps are recorded without printf, which would stretch the sampling period
+            if ((result == SIMON_GAME_STEP) || (result == SIMON_GAME_COMPLETE))
+            {
+                uint32_t now_ms = Tickless_Timer_Now_ms(&timer);
+                Reaction_Stats_Accept(&reaction_stats, now_ms - (levels.debouncer.stable_us / 1000), now_ms);
+            }
+
+            // The white LED acknowledges each correct color until the object is removed
+            if (result == SIMON_GAME_STEP)
+            {
+                LED2_Output(RGB_LED_WHITE);
+            }
+            else if (color == COLOR_UNKNOWN)
+            {
+                LED2_Output(RGB_LED_OFF);
+            }
+
+            Check_Host_Input();
         }
 
-        Clock_Delay1ms(700);  // hold the color
-        LED2_Output(RGB_LED_OFF);
-        Clock_Delay1ms(300);  // gap between colors
+        if (result == SIMON_GAME_COMPLETE)
+        {
+            printf("Level complete!\n");
+            Reaction_Stats_Complete(&reaction_stats, Tickless_Timer_Now_ms(&timer));
+            Reaction_Stats_Print(&reaction_stats);
+            LED2_Output(RGB_LED_SKY_BLUE);
+            Tickless_Timer_Sleep_ms(&timer, 1000);
+            LED2_Output(RGB_LED_OFF);
+
+            Simon_Levels_Next_Level(&levels);
+        }
+        else
+        {
+            printf(levels.timed_out ? "Too slow! Restarting...\n" : "Wrong! Restarting...\n");
+            Reaction_Stats_Fail(&reaction_stats);
+            LED2_Output(RGB_LED_PINK);
+            Tickless_Timer_Sleep_ms(&timer, 2500);
+            LED2_Output(RGB_LED_OFF);
+
+            Simon_Levels_Restart(&levels);
+        }
+
+        Tickless_Timer_Sleep_ms(&timer, 500);
     }
 }
 
-int CheckPattern(Color_t detected)
+void Drive_And_Scan(PMOD_Calibration_Data calibration_data)
 {
-    static int index = 0;
-    static int failCount = 0; // counts consecutive failures
+    Floor_Tag_Decoder decoder;
+
+    Simon_Game_Init(&game, (uint32_t)time(NULL));
+    Floor_Tag_Init(&decoder, &Floor_Tag_Default_Params);
 
-    if (detected == COLOR_UNKNOWN)
-        return -1;  // ignore noise completely
+    // The sensor converts continuously with the burst timing of Adaptive_Rate, the fastest rate that
+    // the calibration refers to. Each sample is tagged with the distance driven at the middle of its
+    // integration, computed from the time and DRIVE_SCAN_SPEED_MM_S
+    uint32_t period_us = ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US;
+    uint32_t ticks_per_ms = Tickless_Timer_Ticks_From_ms(&timer, 1);
+    uint64_t half_integration_ticks = (uint64_t)ticks_per_ms * ADAPTIVE_RATE_BURST_INTEGRATION_US / 2000;
+    Color_Sensor_Set_Timing(ADAPTIVE_RATE_BURST_INTEGRATION_US, ADAPTIVE_RATE_BURST_WAIT_US);
 
-    // ---------- CORRECT COLOR ----------
-    if (detected == pattern[index])
+    while (1)
     {
-        failCount = 0;    // reset failure counter
-        index++;
+        Simon_Game_Generate_Pattern(&game);
+
+        for (int i = 0; i < SIMON_GAME_PATTERN_LENGTH; i++)
+        {
+            Show_Color(game.pattern[i], 700, 300);
+        }
+
+        printf("Driving over the tag...\n");
 
-        if (index == PATTERN_LENGTH)
+        int result = FLOOR_TAG_NONE;
+        uint32_t position_um = 0;
+        uint32_t drive_start_ms = Tickless_Timer_Now_ms(&timer);
+
+        if (Bumper_Switches_Drive(&bumpers, Motor_Forward, DRIVE_SCAN_DUTY_CYCLE, DRIVE_SCAN_DUTY_CYCLE))
+        {
+            Tickless_Timer_Sleep_ms(&timer, DRIVE_SCAN_SETTLE_MS);
+
+            uint64_t start_ticks = Tickless_Timer_Now(&timer);
+            Floor_Tag_Reset(&decoder, 0);
+
+            // The samples are decoded without printf, which would stretch the sampling period. A
+            // collision stops the motors in PORT4_IRQHandler and ends the scan
+            while ((result != FLOOR_TAG_COMPLETE) && (result != FLOOR_TAG_ERROR) && !collision_detected &&
+                   (position_um < (DRIVE_SCAN_MAX_MM * 1000)))
+            {
+                PMOD_Color_Data color_data = PMOD_Color_Normalize_Calibration(Color_Sensor_Read(), calibration_data);
+                uint64_t ticks = Tickless_Timer_Now(&timer) - start_ticks;
+                Tickless_Timer_Sleep_us(&timer, period_us);
+
+                ticks = (ticks > half_integration_ticks) ? (ticks - half_integration_ticks) : 0;
+                position_um = (uint32_t)(ticks * DRIVE_SCAN_SPEED_MM_S / ticks_per_ms);
+
+                Color_t color = Color_Classifier_Classify(&Floor_Tag_Classifier_Params, color_data.red, color_data.green, color_data.blue);
+                result = Floor_Tag_Push(&decoder, color, position_um);
+            }
+        }
+
+        Motor_Stop();
+        uint32_t drive_ms = Tickless_Timer_Now_ms(&timer) - drive_start_ms;
+
+        if (collision_detected)
+        {
+            Bumper_Switches_Event collision;
+
+            if (Bumper_Switches_Take_Event(&bumpers, &collision))
+            {
+                printf("collision: switches 0x%02X at %lu ms\n", collision.switches, (unsigned long)collision.time_ms);
+            }
+
+            // Wait for the bumpers to be released before driving back
+            while (!Clear_Collision())
+            {
+                Tickless_Timer_Sleep_ms(&timer, 100);
+            }
+
+            LED2_Output(RGB_LED_PINK);
+        }
+        else if (result == FLOOR_TAG_COMPLETE)
+        {
+            // The tag must be exactly the pattern: a wrong symbol is not forgiven as a misread
+            uint8_t granted = (decoder.tag_length == SIMON_GAME_PATTERN_LENGTH);
+
+            printf("Tag:");
+            for (uint8_t i = 0; i < decoder.tag_length; i++)
+            {
+                printf(" %s", Color_Classifier_Name(decoder.tag[i]));
+                granted = granted && (decoder.tag[i] == game.pattern[i]);
+            }
+            printf(" at %lu mm\n", (unsigned long)(position_um / 1000));
+
+            printf(granted ? "ACCESS GRANTED!\n" : "Wrong tag!\n");
+            LED2_Output(granted ? RGB_LED_SKY_BLUE : RGB_LED_PINK);
+        }
+        else
         {
-            index = 0;
-            return 2;     // full pattern matched
+            printf((result == FLOOR_TAG_ERROR) ? "Unreadable tag at %lu mm\n" : "No tag within %lu mm\n",
+                   (unsigned long)(position_um / 1000));
+            LED2_Output(RGB_LED_PINK);
         }
-        return 1; // correct so far
+
+        Floor_Tag_Print_Stats(&decoder);
+        Tickless_Timer_Sleep_ms(&timer, 2000);
+        LED2_Output(RGB_LED_OFF);
+
+        // Back to about where the drive started, for the next round
+        Drive(Motor_Backward, DRIVE_SCAN_DUTY_CYCLE, DRIVE_SCAN_DUTY_CYCLE, drive_ms);
+        Motor_Stop();
+
+        Check_Host_Input();
+
+        Tickless_Timer_Sleep_ms(&timer, 500);
     }
+}
 
-    // ---------- WRONG COLOR ----------
-    else
+void Name_Colors(PMOD_Calibration_Data calibration_data)
+{
+    Color_Names_Match match;
+    uint16_t shown = COLOR_NAMES_NONE;
+    uint16_t candidate = COLOR_NAMES_NONE;
+    uint16_t repeats = 0;
+    uint32_t max_cycles = 0;
+
+    // The lookups are timed with the DWT cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // The sensor converts continuously with the burst timing of Adaptive_Rate, which is also the
+    // integration time the calibration refers to
+    uint32_t period_us = ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US;
+    Color_Sensor_Set_Timing(ADAPTIVE_RATE_BURST_INTEGRATION_US, ADAPTIVE_RATE_BURST_WAIT_US);
+
+    printf("Naming colors: %u in the database\n", Color_Names_Default_Database.count);
+
+    while (1)
     {
-        failCount++;
+        PMOD_Color_Data color_data = PMOD_Color_Normalize_Calibration(Color_Sensor_Read(), calibration_data);
+        uint32_t start_cycles = DWT->CYCCNT;
+
+        Color_Names_Key key = Color_Names_Key_From_RGB(color_data.red, color_data.green, color_data.blue);
+        Color_Names_Find(&Color_Names_Default_Database, &key, &match);
 
-        if (failCount >= 2)   // only fail after 2 bad reads in a row
+        uint32_t cycles = DWT->CYCCNT - start_cycles;
+
+        if (cycles > max_cycles)
         {
-            index = 0;
-            failCount = 0;
-            return 0;   // full failure: restart needed
+            max_cycles = cycles;
         }
 
-        return -1;   // mild failure → IGNORE (do not restart)
+        if (match.index != candidate)
+        {
+            candidate = match.index;
+            repeats = 1;
+        }
+        else if (repeats < NAME_COLORS_STABLE_SAMPLES)
+        {
+            repeats++;
+        }
+
+        if ((repeats == NAME_COLORS_STABLE_SAMPLES) && (candidate != shown))
+        {
+            shown = candidate;
+            printf("Color: %s (%u compared in %lu cycles, %lu at most)\n", Color_Names_Name(&Color_Names_Default_Database, shown),
+                   match.compared, (unsigned long)cycles, (unsigned long)max_cycles);
+        }
+
+        Check_Host_Input();
+        Tickless_Timer_Sleep_us(&timer, period_us);
     }
 }
 
+/**
+ * @brief Handles a byte received from the host: a request of a raw burst of samples, or a byte of the
+ *        bootloader request of host_tools/boot_update (see Bootloader_MSP432.h).
+ *
+ * @param byte The received byte.
+ *
+ * @return None
+ */
+void Host_Input_Byte(uint8_t byte)
+{
+#if TELEMETRY_SUMMARY
+    if (byte == SAMPLE_SUMMARY_BURST_REQUEST)
+    {
+        Sample_Summary_Request_Burst(&sample_summary);
+    }
+#endif
 
+    if (Bootloader_MSP432_Enter_Byte(byte))
+    {
+        Bootloader_MSP432_Restart();
+    }
+}
 
+/**
+ * @brief Handles the bytes received from the host since the last call (see Host_Input_Byte).
+ *
+ * With UART_RX_DMA, the µDMA takes every received byte, so the bytes waiting in its buffer are read.
+ * Otherwise, only the last byte received is seen.
+ *
+ * @param None
+ *
+ * @return None
+ */
+void Check_Host_Input(void)
+{
+#if UART_RX_DMA
+    uint8_t data[64];
+    uint32_t count;
+
+    while ((count = UART_RX_Read(&uart_rx, data, sizeof(data))) > 0)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Host_Input_Byte(data[i]);
+        }
+    }
+#else
+    // Only a byte received since the last poll counts (UCRXIFG, Bit 0 in the IFG register)
+    if (EUSCI_A0->IFG & 0x01)
+    {
+        Host_Input_Byte((uint8_t)EUSCI_A0->RXBUF);
+    }
+#endif
+}
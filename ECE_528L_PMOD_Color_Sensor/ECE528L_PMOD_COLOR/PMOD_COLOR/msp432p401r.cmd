@@ -38,9 +38,17 @@
 
 --retain=flashMailbox
 
+/* The application is started by the resident bootloader (../PMOD_COLOR_BOOT), which is linked by    */
+/* msp432p401r_boot.cmd into sectors 0 and 1 of the main flash and owns the reset vector. Sector 2    */
+/* holds the application header, which host_tools/boot_update writes. The application starts with    */
+/* its vector table at 0x00003000 (BOOTLOADER_APP_ADDRESS in inc/Bootloader.h), and the bootloader    */
+/* points VTOR to it before jumping to its reset handler.                                            */
+
 MEMORY
 {
-    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
+    BOOT       (RX) : origin = 0x00000000, length = 0x00002000
+    APP_HEADER (RX) : origin = 0x00002000, length = 0x00001000
+    MAIN       (RX) : origin = 0x00003000, length = 0x0003D000
     INFO       (RX) : origin = 0x00200000, length = 0x00004000
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
@@ -76,7 +84,7 @@ MEMORY
 
 SECTIONS
 {
-    .intvecs:   > 0x00000000
+    .intvecs:   > 0x00003000
     .text   :   > MAIN
     .const  :   > MAIN
     .cinit  :   > MAIN
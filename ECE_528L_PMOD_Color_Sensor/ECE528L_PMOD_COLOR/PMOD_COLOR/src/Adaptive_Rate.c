@@ -0,0 +1,180 @@
+/**
+ * @file Adaptive_Rate.c
+ * @brief Source code for the Adaptive_Rate controller.
+ *
+ * This file contains the function definitions for the adaptive sampling rate controller,
+ * which switches the sensor between a low-power idle mode and a maximum-rate burst mode.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Adaptive_Rate.h"
+#include "../inc/Fixed_Point.h"
+
+const Adaptive_Rate_Config Adaptive_Rate_Default_Config =
+{
+    { ADAPTIVE_RATE_IDLE_INTEGRATION_US, ADAPTIVE_RATE_BURST_INTEGRATION_US },
+    { ADAPTIVE_RATE_IDLE_WAIT_US, ADAPTIVE_RATE_BURST_WAIT_US },
+    ADAPTIVE_RATE_CLEAR_THRESHOLD_Q8,
+    ADAPTIVE_RATE_CHROMA_THRESHOLD_Q10,
+    ADAPTIVE_RATE_QUIET_TIME_US
+};
+
+static uint32_t Adaptive_Rate_Abs_Diff(uint32_t a, uint32_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+// Scales a channel from the current integration time to the burst integration time, in units of 100 us
+// so that the product fits in 32 bits. The four channels share the reciprocal of from
+static uint16_t Adaptive_Rate_Scale(uint16_t value, uint32_t from, uint32_t to, Fixed_Point_UQ32 reciprocal)
+{
+    return Fixed_Point_Sat_U16_From_U32(Fixed_Point_Divide((uint32_t)value * to + (from / 2), from, reciprocal));
+}
+
+// Returns 1 if the scene changed between two samples that were scaled to the same integration time
+static uint8_t Adaptive_Rate_Changed(const Adaptive_Rate_Config *config, const PMOD_Color_Data *previous, const PMOD_Color_Data *current)
+{
+    uint32_t reference_clear = (previous->clear < ADAPTIVE_RATE_MIN_CLEAR) ? ADAPTIVE_RATE_MIN_CLEAR : previous->clear;
+    uint32_t clear_change_q8 = (Adaptive_Rate_Abs_Diff(current->clear, previous->clear) << 8) / reference_clear;
+    uint32_t previous_sum = (uint32_t)previous->red + previous->green + previous->blue;
+    uint32_t current_sum = (uint32_t)current->red + current->green + current->blue;
+    uint32_t chroma_change_q10;
+
+    if (clear_change_q8 >= config->clear_threshold_q8) return 1;
+
+    // Chromaticity is unreliable for a dark sample, which is covered by the clear channel check
+    if ((previous_sum < ADAPTIVE_RATE_MIN_CHROMA_SUM) || (current_sum < ADAPTIVE_RATE_MIN_CHROMA_SUM)) return 0;
+
+    // One division per sum; the red and green channels are divided with its reciprocal
+    Fixed_Point_UQ32 current_reciprocal = Fixed_Point_Reciprocal(current_sum);
+    Fixed_Point_UQ32 previous_reciprocal = Fixed_Point_Reciprocal(previous_sum);
+
+    chroma_change_q10 = Adaptive_Rate_Abs_Diff(Fixed_Point_Divide((uint32_t)current->red << 10, current_sum, current_reciprocal),
+                                               Fixed_Point_Divide((uint32_t)previous->red << 10, previous_sum, previous_reciprocal)) +
+                        Adaptive_Rate_Abs_Diff(Fixed_Point_Divide((uint32_t)current->green << 10, current_sum, current_reciprocal),
+                                               Fixed_Point_Divide((uint32_t)previous->green << 10, previous_sum, previous_reciprocal));
+
+    return (chroma_change_q10 >= config->chroma_threshold_q10);
+}
+
+void Adaptive_Rate_Init(Adaptive_Rate_Controller *controller, const Adaptive_Rate_Config *config)
+{
+    uint8_t *raw = (uint8_t *)controller;
+
+    for (uint32_t i = 0; i < sizeof(Adaptive_Rate_Controller); i++) raw[i] = 0;
+
+    controller->config = *config;
+    controller->mode = ADAPTIVE_RATE_IDLE;
+}
+
+uint8_t Adaptive_Rate_Update(Adaptive_Rate_Controller *controller, PMOD_Color_Data sample)
+{
+    Adaptive_Rate_Mode mode = controller->mode;
+    uint32_t integration_us = controller->config.integration_us[mode];
+    uint32_t wait_us = controller->config.wait_us[mode];
+    PMOD_Color_Data normalized = Adaptive_Rate_Normalize(controller, sample);
+    uint8_t changed = 0;
+
+    // The sample covers one conversion period of the current mode
+    controller->time_us += integration_us + wait_us;
+    controller->stats.samples[mode]++;
+    controller->stats.time_us[mode] += integration_us + wait_us;
+    controller->stats.active_us[mode] += integration_us;
+    controller->stats.wait_us[mode] += wait_us;
+
+    if (controller->has_previous)
+    {
+        changed = Adaptive_Rate_Changed(&controller->config, &controller->previous, &normalized);
+    }
+
+    controller->previous = normalized;
+    controller->has_previous = 1;
+
+    if (changed)
+    {
+        controller->last_change_us = controller->time_us;
+
+        if (mode == ADAPTIVE_RATE_IDLE)
+        {
+            controller->mode = ADAPTIVE_RATE_BURST;
+            controller->stats.bursts++;
+            return 1;
+        }
+    }
+    else if ((mode == ADAPTIVE_RATE_BURST) &&
+             ((controller->time_us - controller->last_change_us) >= controller->config.quiet_time_us))
+    {
+        controller->mode = ADAPTIVE_RATE_IDLE;
+        return 1;
+    }
+
+    return 0;
+}
+
+PMOD_Color_Data Adaptive_Rate_Normalize(const Adaptive_Rate_Controller *controller, PMOD_Color_Data sample)
+{
+    uint32_t from = controller->config.integration_us[controller->mode] / 100;
+    uint32_t to = controller->config.integration_us[ADAPTIVE_RATE_BURST] / 100;
+    PMOD_Color_Data scaled;
+
+    if ((from == 0) || (from == to)) return sample;
+
+    Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(from);
+
+    scaled.red = Adaptive_Rate_Scale(sample.red, from, to, reciprocal);
+    scaled.green = Adaptive_Rate_Scale(sample.green, from, to, reciprocal);
+    scaled.blue = Adaptive_Rate_Scale(sample.blue, from, to, reciprocal);
+    scaled.clear = Adaptive_Rate_Scale(sample.clear, from, to, reciprocal);
+
+    return scaled;
+}
+
+Adaptive_Rate_Mode Adaptive_Rate_Get_Mode(const Adaptive_Rate_Controller *controller)
+{
+    return controller->mode;
+}
+
+uint32_t Adaptive_Rate_Get_Integration_us(const Adaptive_Rate_Controller *controller)
+{
+    return controller->config.integration_us[controller->mode];
+}
+
+uint32_t Adaptive_Rate_Get_Wait_us(const Adaptive_Rate_Controller *controller)
+{
+    return controller->config.wait_us[controller->mode];
+}
+
+uint32_t Adaptive_Rate_Get_Period_us(const Adaptive_Rate_Controller *controller)
+{
+    return controller->config.integration_us[controller->mode] + controller->config.wait_us[controller->mode];
+}
+
+void Adaptive_Rate_Get_Energy(const Adaptive_Rate_Controller *controller, uint32_t *adaptive_uJ, uint32_t *fixed_uJ)
+{
+    uint64_t active_us = controller->stats.active_us[ADAPTIVE_RATE_IDLE] + controller->stats.active_us[ADAPTIVE_RATE_BURST];
+    uint64_t wait_us = controller->stats.wait_us[ADAPTIVE_RATE_IDLE] + controller->stats.wait_us[ADAPTIVE_RATE_BURST];
+
+    // uA * us = pC, and pC * mV = fJ = 1e-9 uJ
+    *adaptive_uJ = (uint32_t)(((active_us * ADAPTIVE_RATE_ACTIVE_CURRENT_UA + wait_us * ADAPTIVE_RATE_WAIT_CURRENT_UA)
+                              * ADAPTIVE_RATE_SUPPLY_MV) / 1000000000ULL);
+    *fixed_uJ = (uint32_t)(((active_us + wait_us) * ADAPTIVE_RATE_ACTIVE_CURRENT_UA * ADAPTIVE_RATE_SUPPLY_MV) / 1000000000ULL);
+}
+
+void Adaptive_Rate_Print_Stats(const Adaptive_Rate_Controller *controller)
+{
+    const Adaptive_Rate_Stats *stats = &controller->stats;
+    uint32_t total_ms = (uint32_t)((stats->time_us[ADAPTIVE_RATE_IDLE] + stats->time_us[ADAPTIVE_RATE_BURST]) / 1000);
+    uint32_t adaptive_uJ;
+    uint32_t fixed_uJ;
+
+    Adaptive_Rate_Get_Energy(controller, &adaptive_uJ, &fixed_uJ);
+
+    printf("rate idle: %lu samples, %lu ms\n", (unsigned long)stats->samples[ADAPTIVE_RATE_IDLE],
+           (unsigned long)(stats->time_us[ADAPTIVE_RATE_IDLE] / 1000));
+    printf("rate burst: %lu samples, %lu ms, %lu bursts\n", (unsigned long)stats->samples[ADAPTIVE_RATE_BURST],
+           (unsigned long)(stats->time_us[ADAPTIVE_RATE_BURST] / 1000), (unsigned long)stats->bursts);
+    printf("rate energy: %lu uJ adaptive, %lu uJ fixed over %lu ms (%lu%% saved)\n",
+           (unsigned long)adaptive_uJ, (unsigned long)fixed_uJ, (unsigned long)total_ms,
+           (unsigned long)((fixed_uJ > 0) ? (100 - (100ULL * adaptive_uJ) / fixed_uJ) : 0));
+}
@@ -0,0 +1,249 @@
+/**
+ * @file Board_Protocol.c
+ * @brief Source code for the Board_Protocol module.
+ *
+ * This file contains the function definitions for encoding the binary frames sent to the host.
+ *
+ */
+
+#include "../inc/Board_Protocol.h"
+
+static void Board_Protocol_Put_U16(uint8_t *out, uint16_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+static void Board_Protocol_Put_U32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+// Sequence number of the next frame of the board
+static uint8_t Board_Protocol_Sequence = 0;
+
+uint8_t Board_Protocol_Next_Sequence(void)
+{
+    return Board_Protocol_Sequence++;
+}
+
+uint16_t Board_Protocol_CRC16(const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+int Board_Protocol_Encode(uint8_t type, uint8_t sequence, const uint8_t *body, uint8_t length, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t payload[BOARD_PROTOCOL_MAX_BODY + 4];
+    uint16_t payload_length = length + 4;
+
+    if ((length > BOARD_PROTOCOL_MAX_BODY) || (capacity < payload_length + 3))
+    {
+        return -1;
+    }
+
+    payload[0] = type;
+    payload[1] = sequence;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        payload[2 + i] = body[i];
+    }
+    Board_Protocol_Put_U16(&payload[2 + length], Board_Protocol_CRC16(payload, length + 2));
+
+    // COBS: each 0x00 is replaced by the distance to the next 0x00 (or to the end of the payload).
+    // The payload is shorter than 254 bytes, so no extra code bytes are needed.
+    uint16_t out = 1;
+    uint16_t code_index = out++;
+    uint8_t code = 1;
+
+    frame[0] = BOARD_PROTOCOL_DELIMITER;
+
+    for (uint16_t i = 0; i < payload_length; i++)
+    {
+        if (payload[i] == 0)
+        {
+            frame[code_index] = code;
+            code_index = out++;
+            code = 1;
+        }
+        else
+        {
+            frame[out++] = payload[i];
+            code++;
+        }
+    }
+
+    frame[code_index] = code;
+    frame[out++] = BOARD_PROTOCOL_DELIMITER;
+
+    return out;
+}
+
+int Board_Protocol_Encode_Sample(uint8_t sequence, uint32_t time_ms, const PMOD_Color_Data *data, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_SAMPLE_SIZE];
+
+    Board_Protocol_Put_U32(&body[0], time_ms);
+    Board_Protocol_Put_U16(&body[4], data->red);
+    Board_Protocol_Put_U16(&body[6], data->green);
+    Board_Protocol_Put_U16(&body[8], data->blue);
+    Board_Protocol_Put_U16(&body[10], data->clear);
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_SAMPLE, sequence, body, BOARD_PROTOCOL_SAMPLE_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_Detection(uint8_t sequence, uint8_t color, uint8_t *frame, uint16_t capacity)
+{
+    return Board_Protocol_Encode(BOARD_PROTOCOL_DETECTION, sequence, &color, BOARD_PROTOCOL_DETECTION_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_Game(uint8_t sequence, uint8_t result, uint8_t *frame, uint16_t capacity)
+{
+    return Board_Protocol_Encode(BOARD_PROTOCOL_GAME, sequence, &result, BOARD_PROTOCOL_GAME_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_Rate_Stats(uint8_t sequence, const Board_Protocol_Rate_Stats *stats, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_RATE_STATS_SIZE];
+
+    Board_Protocol_Put_U32(&body[0], stats->idle_samples);
+    Board_Protocol_Put_U32(&body[4], stats->idle_ms);
+    Board_Protocol_Put_U32(&body[8], stats->burst_samples);
+    Board_Protocol_Put_U32(&body[12], stats->burst_ms);
+    Board_Protocol_Put_U32(&body[16], stats->bursts);
+    Board_Protocol_Put_U32(&body[20], stats->adaptive_uJ);
+    Board_Protocol_Put_U32(&body[24], stats->fixed_uJ);
+    Board_Protocol_Put_U32(&body[28], stats->total_ms);
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_RATE_STATS, sequence, body, BOARD_PROTOCOL_RATE_STATS_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_Reaction(uint8_t sequence, const Reaction_Step *step, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_REACTION_SIZE];
+
+    body[0] = step->step;
+    Board_Protocol_Put_U32(&body[1], step->since_start_ms);
+    Board_Protocol_Put_U32(&body[5], step->reaction_ms);
+    Board_Protocol_Put_U32(&body[9], step->pipeline_ms);
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_REACTION, sequence, body, BOARD_PROTOCOL_REACTION_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_Reaction_Stats(uint8_t sequence, const Reaction_Summary *summary, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_REACTION_STATS_SIZE];
+
+    Board_Protocol_Put_U32(&body[0], summary->steps);
+    Board_Protocol_Put_U16(&body[4], summary->reaction_mean_ms);
+    Board_Protocol_Put_U16(&body[6], summary->reaction_p50_ms);
+    Board_Protocol_Put_U16(&body[8], summary->reaction_p90_ms);
+    Board_Protocol_Put_U16(&body[10], summary->pipeline_mean_ms);
+    Board_Protocol_Put_U16(&body[12], summary->pipeline_p90_ms);
+    Board_Protocol_Put_U16(&body[14], summary->rounds);
+    Board_Protocol_Put_U16(&body[16], summary->fails);
+    Board_Protocol_Put_U16(&body[18], summary->misses);
+    Board_Protocol_Put_U32(&body[20], summary->round_mean_ms);
+    Board_Protocol_Put_U32(&body[24], summary->best_round_ms);
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_REACTION_STATS, sequence, body, BOARD_PROTOCOL_REACTION_STATS_SIZE, frame, capacity);
+}
+
+int Board_Protocol_Encode_PC_Samples(uint8_t sequence, const Board_Protocol_PC_Samples *samples, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_MAX_BODY];
+    uint8_t length = BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE;
+
+    if (samples->count > (samples->has_lr ? BOARD_PROTOCOL_PC_SAMPLES_MAX_LR : BOARD_PROTOCOL_PC_SAMPLES_MAX))
+    {
+        return -1;
+    }
+
+    body[0] = samples->has_lr ? BOARD_PROTOCOL_PC_SAMPLES_LR : 0;
+    Board_Protocol_Put_U16(&body[1], samples->dropped);
+
+    for (uint8_t i = 0; i < samples->count; i++)
+    {
+        Board_Protocol_Put_U32(&body[length], samples->pc[i]);
+        length += 4;
+
+        if (samples->has_lr)
+        {
+            Board_Protocol_Put_U32(&body[length], samples->lr[i]);
+            length += 4;
+        }
+    }
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_PC_SAMPLES, sequence, body, length, frame, capacity);
+}
+
+int Board_Protocol_Encode_I2C_Trace(uint8_t sequence, const Board_Protocol_I2C_Trace *trace, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_MAX_BODY];
+    uint8_t length = BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE;
+
+    if (trace->count > BOARD_PROTOCOL_I2C_TRACE_MAX)
+    {
+        return -1;
+    }
+
+    Board_Protocol_Put_U16(&body[0], trace->dropped);
+
+    for (uint8_t i = 0; i < trace->count; i++)
+    {
+        const Board_Protocol_I2C_Transfer *transfer = &trace->transfers[i];
+
+        Board_Protocol_Put_U32(&body[length], transfer->start_us);
+        Board_Protocol_Put_U16(&body[length + 4], transfer->duration_us);
+        body[length + 6] = transfer->address;
+        body[length + 7] = transfer->write_length;
+        body[length + 8] = transfer->read_length;
+        body[length + 9] = (uint8_t)transfer->status;
+        length += BOARD_PROTOCOL_I2C_TRANSFER_SIZE;
+    }
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_I2C_TRACE, sequence, body, length, frame, capacity);
+}
+
+int Board_Protocol_Encode_Summary(uint8_t sequence, const Board_Protocol_Summary *summary, uint8_t *frame, uint16_t capacity)
+{
+    uint8_t body[BOARD_PROTOCOL_SUMMARY_SIZE];
+    uint8_t length = 10;
+
+    Board_Protocol_Put_U32(&body[0], summary->start_ms);
+    Board_Protocol_Put_U16(&body[4], summary->window_ms);
+    Board_Protocol_Put_U16(&body[6], summary->samples);
+    Board_Protocol_Put_U16(&body[8], summary->raw_samples);
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+    {
+        Board_Protocol_Put_U16(&body[length], summary->min[i]);
+        Board_Protocol_Put_U16(&body[length + 2], summary->max[i]);
+        Board_Protocol_Put_U16(&body[length + 4], summary->mean[i]);
+        Board_Protocol_Put_U32(&body[length + 6], summary->variance[i]);
+        length += 10;
+    }
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+    {
+        Board_Protocol_Put_U16(&body[length], summary->classes[i]);
+        length += 2;
+    }
+
+    return Board_Protocol_Encode(BOARD_PROTOCOL_SUMMARY, sequence, body, length, frame, capacity);
+}
@@ -0,0 +1,356 @@
+/**
+ * @file Bootloader.c
+ * @brief Source code for the Bootloader module.
+ *
+ * This file contains the function definitions for the protocol core of the UART bootloader.
+ *
+ * Every function is placed in SRAM with BOOTLOADER_RAMFUNC, and none of them uses constant tables,
+ * string literals or library calls, because .const and .text are in flash bank 0, which the
+ * bootloader erases and programs. The CRCs are therefore computed bit by bit.
+ *
+ */
+
+#include "../inc/Bootloader.h"
+
+// States of the packet receiver
+#define BOOTLOADER_STATE_HEADER                 0
+#define BOOTLOADER_STATE_LENGTH_LOW             1
+#define BOOTLOADER_STATE_LENGTH_HIGH            2
+#define BOOTLOADER_STATE_PAYLOAD                3
+#define BOOTLOADER_STATE_CRC_LOW                4
+#define BOOTLOADER_STATE_CRC_HIGH               5
+
+BOOTLOADER_RAMFUNC static uint32_t Bootloader_Get_U32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+BOOTLOADER_RAMFUNC static void Bootloader_Put_U32(uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+BOOTLOADER_RAMFUNC uint16_t Bootloader_CRC16(const uint8_t *data, uint32_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+BOOTLOADER_RAMFUNC uint32_t Bootloader_CRC32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    crc = ~crc;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+// Returns the length of the application given by its header, or 0 if the header is not valid
+BOOTLOADER_RAMFUNC static uint32_t Bootloader_Application_Length(const uint8_t *flash, uint32_t flash_size)
+{
+    const uint8_t *header = flash + BOOTLOADER_APP_HEADER_ADDRESS;
+    uint32_t length = Bootloader_Get_U32(&header[4]);
+
+    if ((Bootloader_Get_U32(&header[0]) != BOOTLOADER_APP_MAGIC) || (length == 0) ||
+        (length > flash_size - BOOTLOADER_APP_ADDRESS))
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+BOOTLOADER_RAMFUNC uint8_t Bootloader_Application_Valid(const uint8_t *flash, uint32_t flash_size)
+{
+    uint32_t length = Bootloader_Application_Length(flash, flash_size);
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    uint32_t crc = Bootloader_Get_U32(&flash[BOOTLOADER_APP_HEADER_ADDRESS + 8]);
+
+    return Bootloader_CRC32(0, flash + BOOTLOADER_APP_ADDRESS, length) == crc;
+}
+
+// Frames and sends the response whose payload (command, status, data) is in bootloader->response
+BOOTLOADER_RAMFUNC static void Bootloader_Respond(Bootloader *bootloader, uint8_t command, int8_t status, uint16_t data_length)
+{
+    uint8_t *payload = &bootloader->response[3];
+    uint16_t length = data_length + 2;
+
+    bootloader->response[0] = BOOTLOADER_HEADER;
+    bootloader->response[1] = (uint8_t)length;
+    bootloader->response[2] = (uint8_t)(length >> 8);
+    payload[0] = command;
+    payload[1] = (uint8_t)status;
+
+    uint16_t crc = Bootloader_CRC16(payload, length);
+    payload[length] = (uint8_t)crc;
+    payload[length + 1] = (uint8_t)(crc >> 8);
+
+    bootloader->ops->send(bootloader->context, bootloader->response, length + BOOTLOADER_FRAMING);
+}
+
+BOOTLOADER_RAMFUNC static void Bootloader_Execute(Bootloader *bootloader)
+{
+    const uint8_t *packet = bootloader->packet;
+    uint16_t length = bootloader->length;
+    uint8_t *data = &bootloader->response[5];
+    uint8_t command = packet[0];
+
+    if (command == BOOTLOADER_CMD_INFO)
+    {
+        Bootloader_Put_U32(&data[0], BOOTLOADER_VERSION);
+        Bootloader_Put_U32(&data[4], bootloader->flash_size);
+        Bootloader_Put_U32(&data[8], bootloader->sector_size);
+        Bootloader_Put_U32(&data[12], BOOTLOADER_MAX_DATA);
+        Bootloader_Put_U32(&data[16], BOOTLOADER_APP_ADDRESS);
+        Bootloader_Respond(bootloader, command, BOOTLOADER_OK, BOOTLOADER_INFO_LENGTH);
+    }
+    else if ((command == BOOTLOADER_CMD_SECTOR_CRCS) && (length == 5))
+    {
+        uint32_t first = packet[1] | ((uint32_t)packet[2] << 8);
+        uint32_t count = packet[3] | ((uint32_t)packet[4] << 8);
+        uint32_t sectors = bootloader->flash_size / bootloader->sector_size;
+
+        if ((count > BOOTLOADER_MAX_SECTOR_CRCS) || (first > sectors) || (count > sectors - first))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_ADDRESS, 0);
+            return;
+        }
+
+        bootloader->checked_byte_count += count * bootloader->sector_size;
+        data[0] = (uint8_t)count;
+        data[1] = (uint8_t)(count >> 8);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint8_t *sector = bootloader->flash + (first + i) * bootloader->sector_size;
+            Bootloader_Put_U32(&data[2 + 4 * i], Bootloader_CRC32(0, sector, bootloader->sector_size));
+        }
+        Bootloader_Respond(bootloader, command, BOOTLOADER_OK, (uint16_t)(2 + 4 * count));
+    }
+    else if ((command == BOOTLOADER_CMD_ERASE) && (length == 5))
+    {
+        uint32_t address = Bootloader_Get_U32(&packet[1]);
+
+        // The sectors of the bootloader are never erased
+        if ((address < BOOTLOADER_RESIDENT_SIZE) || (address >= bootloader->flash_size) ||
+            (address % bootloader->sector_size != 0))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_ADDRESS, 0);
+            return;
+        }
+
+        bootloader->erase_count++;
+
+        int status = bootloader->ops->erase_sector(bootloader->context, address);
+
+        // An erased sector reads 0xFF everywhere
+        for (uint32_t i = 0; (status == BOOTLOADER_OK) && (i < bootloader->sector_size); i++)
+        {
+            if (bootloader->flash[address + i] != 0xFF) status = BOOTLOADER_ERROR_FLASH;
+        }
+
+        Bootloader_Respond(bootloader, command, (int8_t)status, 0);
+    }
+    else if ((command == BOOTLOADER_CMD_PROGRAM) && (length > 5))
+    {
+        uint32_t address = Bootloader_Get_U32(&packet[1]);
+        uint32_t size = length - 5u;
+        const uint8_t *bytes = &packet[5];
+
+        if ((size % BOOTLOADER_PROGRAM_ALIGN != 0) || (address % BOOTLOADER_PROGRAM_ALIGN != 0) ||
+            (address < BOOTLOADER_RESIDENT_SIZE) || (address >= bootloader->flash_size) ||
+            (size > bootloader->flash_size - address))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_ADDRESS, 0);
+            return;
+        }
+
+        bootloader->program_count++;
+
+        int status = bootloader->ops->program(bootloader->context, address, bytes, size);
+
+        // Read back what was programmed
+        for (uint32_t i = 0; (status == BOOTLOADER_OK) && (i < size); i++)
+        {
+            if (bootloader->flash[address + i] != bytes[i]) status = BOOTLOADER_ERROR_FLASH;
+        }
+
+        Bootloader_Respond(bootloader, command, (int8_t)status, 0);
+    }
+    else if ((command == BOOTLOADER_CMD_VERIFY) && (length == 9))
+    {
+        uint32_t size = Bootloader_Get_U32(&packet[1]);
+        uint32_t expected = Bootloader_Get_U32(&packet[5]);
+
+        if ((size == 0) || (size > bootloader->flash_size - BOOTLOADER_APP_ADDRESS))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_ADDRESS, 0);
+            return;
+        }
+
+        uint32_t crc = Bootloader_CRC32(0, bootloader->flash + BOOTLOADER_APP_ADDRESS, size);
+        bootloader->checked_byte_count += size;
+
+        Bootloader_Put_U32(&data[0], crc);
+        Bootloader_Respond(bootloader, command, (crc == expected) ? BOOTLOADER_OK : BOOTLOADER_ERROR_VERIFY, 4);
+    }
+    else if ((command == BOOTLOADER_CMD_RUN) && (length == 1))
+    {
+        // The same check as at reset, so that RUN never leaves the board in the bootloader
+        bootloader->checked_byte_count += Bootloader_Application_Length(bootloader->flash, bootloader->flash_size);
+
+        if (!Bootloader_Application_Valid(bootloader->flash, bootloader->flash_size))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_NOT_VERIFIED, 0);
+            return;
+        }
+
+        Bootloader_Respond(bootloader, command, BOOTLOADER_OK, 0);
+        bootloader->ops->reset(bootloader->context);
+    }
+    else if ((command == BOOTLOADER_CMD_SET_BAUD) && (length == 5))
+    {
+        uint32_t baud = Bootloader_Get_U32(&packet[1]);
+
+        if ((baud < BOOTLOADER_MIN_BAUD) || (baud > BOOTLOADER_MAX_BAUD))
+        {
+            Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_INVALID, 0);
+            return;
+        }
+
+        // The acknowledgment is sent at the old rate
+        Bootloader_Respond(bootloader, command, BOOTLOADER_OK, 0);
+
+        if (baud != bootloader->baud)
+        {
+            bootloader->previous_baud = bootloader->baud;
+            bootloader->baud = baud;
+            bootloader->probation_idles = 0;
+            bootloader->ops->set_baud(bootloader->context, baud);
+        }
+    }
+    else
+    {
+        Bootloader_Respond(bootloader, command, BOOTLOADER_ERROR_INVALID, 0);
+    }
+}
+
+BOOTLOADER_RAMFUNC void Bootloader_Init(Bootloader *bootloader, const Bootloader_Ops *ops, void *context,
+                                        const uint8_t *flash, uint32_t flash_size, uint32_t sector_size, uint32_t baud)
+{
+    bootloader->ops = ops;
+    bootloader->context = context;
+    bootloader->flash = flash;
+    bootloader->flash_size = flash_size;
+    bootloader->sector_size = sector_size;
+    bootloader->state = BOOTLOADER_STATE_HEADER;
+    bootloader->length = 0;
+    bootloader->index = 0;
+    bootloader->crc = 0;
+
+    bootloader->baud = baud;
+    bootloader->previous_baud = 0;
+    bootloader->probation_idles = 0;
+
+    bootloader->packet_count = 0;
+    bootloader->crc_error_count = 0;
+    bootloader->erase_count = 0;
+    bootloader->program_count = 0;
+    bootloader->checked_byte_count = 0;
+}
+
+// The states are tested with if statements rather than a switch, which may be compiled to a table
+BOOTLOADER_RAMFUNC void Bootloader_Receive_Byte(Bootloader *bootloader, uint8_t byte)
+{
+    uint8_t state = bootloader->state;
+
+    if (state == BOOTLOADER_STATE_HEADER)
+    {
+        // Bytes between packets, such as the entry request, are ignored
+        if (byte == BOOTLOADER_HEADER) bootloader->state = BOOTLOADER_STATE_LENGTH_LOW;
+    }
+    else if (state == BOOTLOADER_STATE_LENGTH_LOW)
+    {
+        bootloader->length = byte;
+        bootloader->state = BOOTLOADER_STATE_LENGTH_HIGH;
+    }
+    else if (state == BOOTLOADER_STATE_LENGTH_HIGH)
+    {
+        bootloader->length |= (uint16_t)byte << 8;
+        bootloader->index = 0;
+
+        if ((bootloader->length == 0) || (bootloader->length > BOOTLOADER_MAX_PAYLOAD))
+        {
+            bootloader->state = BOOTLOADER_STATE_HEADER;
+        }
+        else
+        {
+            bootloader->state = BOOTLOADER_STATE_PAYLOAD;
+        }
+    }
+    else if (state == BOOTLOADER_STATE_PAYLOAD)
+    {
+        bootloader->packet[bootloader->index++] = byte;
+        if (bootloader->index == bootloader->length) bootloader->state = BOOTLOADER_STATE_CRC_LOW;
+    }
+    else if (state == BOOTLOADER_STATE_CRC_LOW)
+    {
+        bootloader->crc = byte;
+        bootloader->state = BOOTLOADER_STATE_CRC_HIGH;
+    }
+    else
+    {
+        bootloader->crc |= (uint16_t)byte << 8;
+        bootloader->state = BOOTLOADER_STATE_HEADER;
+
+        if (bootloader->crc != Bootloader_CRC16(bootloader->packet, bootloader->length))
+        {
+            bootloader->crc_error_count++;
+            Bootloader_Respond(bootloader, 0, BOOTLOADER_ERROR_CRC, 0);
+            return;
+        }
+
+        // A valid packet confirms a new baud rate
+        bootloader->previous_baud = 0;
+        bootloader->packet_count++;
+        Bootloader_Execute(bootloader);
+    }
+}
+
+BOOTLOADER_RAMFUNC void Bootloader_Idle(Bootloader *bootloader)
+{
+    bootloader->state = BOOTLOADER_STATE_HEADER;
+
+    if ((bootloader->previous_baud != 0) && (++bootloader->probation_idles >= BOOTLOADER_BAUD_PROBATION_IDLES))
+    {
+        bootloader->baud = bootloader->previous_baud;
+        bootloader->previous_baud = 0;
+        bootloader->ops->set_baud(bootloader->context, bootloader->baud);
+    }
+}
@@ -0,0 +1,274 @@
+/**
+ * @file Bootloader_MSP432.c
+ * @brief Source code for the Bootloader_MSP432 backend.
+ *
+ * This file contains the function definitions for running the UART bootloader on the MSP432P401R.
+ *
+ * For more information regarding the flash controller (FLCTL), refer to the Flash Controller
+ * section (9) of the MSP432Pxx Microcontrollers Technical Reference Manual.
+ *
+ */
+
+#include "../inc/Bootloader_MSP432.h"
+#include "../inc/GPIO.h"
+
+// The state of the bootloader is in .bss, which is in SRAM
+static Bootloader Bootloader_MSP432_State;
+
+// Waits until EUSCI_A0 has finished sending, so that the baud rate can be changed or the board reset
+BOOTLOADER_RAMFUNC static void Bootloader_MSP432_Wait_Transmitted(void)
+{
+    // Wait while the UCBUSY bit (Bit 0) in the STATW register is set
+    while (EUSCI_A0->STATW & 0x01);
+}
+
+BOOTLOADER_RAMFUNC static void Bootloader_MSP432_Send(void *context, const uint8_t *data, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++)
+    {
+        // Wait for the Transmit Interrupt flag (UCTXIFG, Bit 1) in the IFG register
+        while ((EUSCI_A0->IFG & 0x02) == 0);
+        EUSCI_A0->TXBUF = data[i];
+    }
+
+    Bootloader_MSP432_Wait_Transmitted();
+}
+
+BOOTLOADER_RAMFUNC static void Bootloader_MSP432_Set_Baud(void *context, uint32_t baud)
+{
+    Bootloader_MSP432_Wait_Transmitted();
+
+    // Hold EUSCI_A0 in reset (UCSWRST, Bit 0 of CTLW0) while the rate changes.
+    // As in EUSCI_A0_UART_Init, N = SMCLK / baud without oversampling; the error is below 0.2%
+    // for 115200, 460800 and 921600 baud, and 0 for 1500000 baud
+    EUSCI_A0->CTLW0 |= 0x01;
+    EUSCI_A0->MCTLW = 0;
+    EUSCI_A0->BRW = (uint16_t)(BOOTLOADER_MSP432_SMCLK_HZ / baud);
+    EUSCI_A0->CTLW0 &= ~0x01;
+}
+
+BOOTLOADER_RAMFUNC static void Bootloader_MSP432_Reset(void *context)
+{
+    Bootloader_MSP432_Wait_Transmitted();
+
+    // Request a system reset by writing the VECTKEY (0x05FA) and the SYSRESETREQ bit (Bit 2) to AIRCR
+    SCB->AIRCR = 0x05FA0004;
+    while (1);
+}
+
+// Returns the write/erase protection register of the bank that holds the address
+BOOTLOADER_RAMFUNC static volatile uint32_t *Bootloader_MSP432_Protection(uint32_t address)
+{
+    return (address < BOOTLOADER_MSP432_BANK_SIZE) ? &FLCTL->BANK0_MAIN_WEPROT : &FLCTL->BANK1_MAIN_WEPROT;
+}
+
+BOOTLOADER_RAMFUNC static uint32_t Bootloader_MSP432_Sector_Bit(uint32_t address)
+{
+    return 1u << ((address % BOOTLOADER_MSP432_BANK_SIZE) / BOOTLOADER_MSP432_SECTOR_SIZE);
+}
+
+BOOTLOADER_RAMFUNC static int Bootloader_MSP432_Erase_Sector(void *context, uint32_t address)
+{
+    volatile uint32_t *protection = Bootloader_MSP432_Protection(address);
+    uint32_t sector_bit = Bootloader_MSP432_Sector_Bit(address);
+    int status = BOOTLOADER_OK;
+
+    // Clear the protection bit of the sector
+    *protection &= ~sector_bit;
+
+    // Select a sector erase (MODE, Bit 1 = 0) of main memory (TYPE, Bits 3-2 = 00b),
+    // clear the previous status (CLR_STAT, Bit 19) and start the erase (START, Bit 0)
+    FLCTL->ERASE_CTLSTAT &= ~0x0E;
+    FLCTL->ERASE_SECTADDR = address;
+    FLCTL->ERASE_CTLSTAT |= 0x00080000;
+    FLCTL->ERASE_CTLSTAT |= 0x01;
+
+    // Wait until the STATUS field (Bits 17-16) reports completion (11b) or ADDR_ERR (Bit 18) is set
+    while (((FLCTL->ERASE_CTLSTAT & 0x00030000) != 0x00030000) && ((FLCTL->ERASE_CTLSTAT & 0x00040000) == 0));
+
+    if (FLCTL->ERASE_CTLSTAT & 0x00040000)
+    {
+        status = BOOTLOADER_ERROR_FLASH;
+    }
+
+    FLCTL->ERASE_CTLSTAT |= 0x00080000;
+    *protection |= sector_bit;
+
+    return status;
+}
+
+BOOTLOADER_RAMFUNC static int Bootloader_MSP432_Program(void *context, uint32_t address, const uint8_t *data, uint32_t length)
+{
+    // Enable word programming (ENABLE, Bit 0) in full word mode (MODE, Bit 1): the flash word of
+    // 128 bits is programmed once, when its fourth 32-bit word has been written
+    FLCTL->PRG_CTLSTAT = (FLCTL->PRG_CTLSTAT & ~0x0E) | 0x03;
+
+    for (uint32_t offset = 0; offset < length; offset += BOOTLOADER_PROGRAM_ALIGN)
+    {
+        uint32_t word_address = address + offset;
+        volatile uint32_t *protection = Bootloader_MSP432_Protection(word_address);
+        uint32_t sector_bit = Bootloader_MSP432_Sector_Bit(word_address);
+
+        *protection &= ~sector_bit;
+
+        for (uint32_t i = 0; i < BOOTLOADER_PROGRAM_ALIGN; i += 4)
+        {
+            const uint8_t *bytes = &data[offset + i];
+            *(volatile uint32_t *)(word_address + i) = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+                                                       ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        }
+
+        // Wait while the STATUS field (Bits 17-16) reports a program in progress
+        while (FLCTL->PRG_CTLSTAT & 0x00030000);
+
+        *protection |= sector_bit;
+    }
+
+    FLCTL->PRG_CTLSTAT &= ~0x01;
+
+    // The protocol core reads the data back
+    return BOOTLOADER_OK;
+}
+
+// Not const: .const is in flash bank 0, which the bootloader erases and programs, and .data is copied to SRAM at startup
+static Bootloader_Ops Bootloader_MSP432_Ops =
+{
+    Bootloader_MSP432_Erase_Sector,
+    Bootloader_MSP432_Program,
+    Bootloader_MSP432_Send,
+    Bootloader_MSP432_Set_Baud,
+    Bootloader_MSP432_Reset
+};
+
+BOOTLOADER_RAMFUNC static void Bootloader_MSP432_Loop(Bootloader *bootloader)
+{
+    uint32_t idle_ms = 0;
+
+    while (1)
+    {
+        // Receive Interrupt flag (UCRXIFG, Bit 0) in the IFG register
+        if (EUSCI_A0->IFG & 0x01)
+        {
+            idle_ms = 0;
+            Bootloader_Receive_Byte(bootloader, (uint8_t)EUSCI_A0->RXBUF);
+        }
+
+        // The COUNTFLAG bit (Bit 16) of the SysTick CTRL register is set once per millisecond
+        else if (SysTick->CTRL & 0x00010000)
+        {
+            if (++idle_ms >= BOOTLOADER_MSP432_IDLE_MS)
+            {
+                idle_ms = 0;
+                Bootloader_Idle(bootloader);
+            }
+        }
+    }
+}
+
+// Loads the stack pointer of the application and branches to its reset handler. As in CortexM.c, the
+// body relies on the arguments being in R0 and R1.
+static void Bootloader_MSP432_Jump(uint32_t stack_pointer, uint32_t reset_handler)
+{
+    __asm("    MSR     MSP, R0\n"
+          "    BX      R1\n");
+}
+
+// Returns 1 if the host updater requests the bootloader within window_ms
+static uint8_t Bootloader_MSP432_Requested(uint32_t window_ms)
+{
+    uint32_t elapsed_ms = 0;
+
+    while (elapsed_ms < window_ms)
+    {
+        // Receive Interrupt flag (UCRXIFG, Bit 0) in the IFG register
+        if (EUSCI_A0->IFG & 0x01)
+        {
+            if (Bootloader_MSP432_Enter_Byte((uint8_t)EUSCI_A0->RXBUF)) return 1;
+        }
+
+        // The COUNTFLAG bit (Bit 16) of the SysTick CTRL register is set once per millisecond
+        else if (SysTick->CTRL & 0x00010000)
+        {
+            elapsed_ms++;
+        }
+    }
+
+    return 0;
+}
+
+static void Bootloader_MSP432_Start_Application(void)
+{
+    const uint32_t *vectors = (const uint32_t *)BOOTLOADER_APP_ADDRESS;
+
+    // Leave SysTick, EUSCI_A0 and its pins as a reset does, since the application initializes them.
+    // Its SystemInit sets the clocks again.
+    SysTick->CTRL = 0;
+    EUSCI_A0->CTLW0 = 0x0001;
+    P1->SEL0 &= ~0x0C;
+
+    // The application takes its interrupts from its own vector table: stack pointer, then reset handler
+    SCB->VTOR = BOOTLOADER_APP_ADDRESS;
+    Bootloader_MSP432_Jump(vectors[0], vectors[1]);
+}
+
+uint8_t Bootloader_MSP432_Enter_Byte(uint8_t byte)
+{
+    static uint8_t enter_count = 0;
+
+    if (byte != BOOTLOADER_ENTER_BYTE)
+    {
+        enter_count = 0;
+        return 0;
+    }
+
+    if (++enter_count < BOOTLOADER_MSP432_ENTER_COUNT)
+    {
+        return 0;
+    }
+
+    enter_count = 0;
+    return 1;
+}
+
+void Bootloader_MSP432_Restart(void)
+{
+    // The host keeps sending requests, which the bootloader sees after the reset
+    Bootloader_MSP432_Reset(0);
+}
+
+void Bootloader_MSP432_Start(void)
+{
+    // MCLK and SMCLK come from the DCO after a reset. Unlock CS (KEY = 0x695A) and select the 12 MHz
+    // range (DCORSEL, Bits 18-16 of CTL0 = 011b), which needs neither VCORE1 nor flash wait states.
+    CS->KEY = 0x695A;
+    CS->CTL0 = 0x00030000;
+    CS->KEY = 0;
+
+    // Configure pins P1.2 and P1.3 for EUSCI_A0, and hold EUSCI_A0 in reset (UCSWRST, Bit 0 of CTLW0)
+    // in UART mode with 8 data bits, no parity, one stop bit and SMCLK (UCSSEL, Bits 7-6 = 11b)
+    P1->SEL0 |= 0x0C;
+    P1->SEL1 &= ~0x0C;
+    EUSCI_A0->CTLW0 = 0x00C1;
+    Bootloader_MSP432_Set_Baud(0, BOOTLOADER_MSP432_DEFAULT_BAUD);
+
+    // Run SysTick from the 12 MHz core clock with a 1 ms period and no interrupt, for the timeouts
+    SysTick->CTRL = 0;
+    SysTick->LOAD = BOOTLOADER_MSP432_SMCLK_HZ / 1000 - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL = 0x05;
+
+    // Stay in the bootloader when the host updater requests it or when the application is not valid
+    if (!Bootloader_MSP432_Requested(BOOTLOADER_MSP432_WINDOW_MS) &&
+        Bootloader_Application_Valid((const uint8_t *)0x00000000, BOOTLOADER_MSP432_FLASH_SIZE))
+    {
+        Bootloader_MSP432_Start_Application();
+    }
+
+    LED2_Init();
+    LED2_Output(RGB_LED_BLUE);
+
+    Bootloader_Init(&Bootloader_MSP432_State, &Bootloader_MSP432_Ops, 0, (const uint8_t *)0x00000000,
+                    BOOTLOADER_MSP432_FLASH_SIZE, BOOTLOADER_MSP432_SECTOR_SIZE, BOOTLOADER_MSP432_DEFAULT_BAUD);
+
+    Bootloader_MSP432_Loop(&Bootloader_MSP432_State);
+}
@@ -0,0 +1,227 @@
+/**
+ * @file Bootloader_Sim.c
+ * @brief Source code for the Bootloader_Sim backend.
+ *
+ * This file contains the function definitions for running the UART bootloader against an emulated flash.
+ *
+ */
+
+#include <string.h>
+#include "../inc/Bootloader_Sim.h"
+
+// Counts a flash operation towards the scheduled power failure. Returns 1 if the power fails during it.
+static uint8_t Bootloader_Sim_Power_Fails(Bootloader_Sim_Context *sim)
+{
+    if ((sim->power_fail_countdown == 0) || (--sim->power_fail_countdown > 0))
+    {
+        return 0;
+    }
+
+    sim->state = BOOTLOADER_SIM_STATE_OFF;
+    return 1;
+}
+
+static int Bootloader_Sim_Erase_Sector(void *context, uint32_t address)
+{
+    Bootloader_Sim_Context *sim = (Bootloader_Sim_Context *)context;
+
+    if (address < BOOTLOADER_RESIDENT_SIZE)
+    {
+        sim->protected_write_count++;
+        return BOOTLOADER_ERROR_FLASH;
+    }
+
+    if (sim->state == BOOTLOADER_SIM_STATE_OFF)
+    {
+        return BOOTLOADER_ERROR_FLASH;
+    }
+
+    sim->sector_erase_count[address / BOOTLOADER_SIM_SECTOR_SIZE]++;
+    sim->erase_count++;
+
+    // A torn erase leaves the second half of the sector as it was
+    if (Bootloader_Sim_Power_Fails(sim))
+    {
+        memset(&sim->flash[address], 0xFF, BOOTLOADER_SIM_SECTOR_SIZE / 2);
+        return BOOTLOADER_ERROR_FLASH;
+    }
+
+    memset(&sim->flash[address], 0xFF, BOOTLOADER_SIM_SECTOR_SIZE);
+
+    return BOOTLOADER_OK;
+}
+
+static int Bootloader_Sim_Program(void *context, uint32_t address, const uint8_t *data, uint32_t length)
+{
+    Bootloader_Sim_Context *sim = (Bootloader_Sim_Context *)context;
+
+    if (address < BOOTLOADER_RESIDENT_SIZE)
+    {
+        sim->protected_write_count++;
+        return BOOTLOADER_ERROR_FLASH;
+    }
+
+    for (uint32_t offset = 0; offset < length; offset += BOOTLOADER_PROGRAM_ALIGN)
+    {
+        uint32_t size = BOOTLOADER_PROGRAM_ALIGN;
+
+        if (sim->state == BOOTLOADER_SIM_STATE_OFF)
+        {
+            return BOOTLOADER_ERROR_FLASH;
+        }
+
+        sim->program_word_count++;
+
+        // A torn program only programs the first half of the flash word
+        if (Bootloader_Sim_Power_Fails(sim))
+        {
+            size /= 2;
+        }
+
+        // Programming can only clear bits
+        for (uint32_t i = 0; i < size; i++)
+        {
+            sim->flash[address + offset + i] &= data[offset + i];
+        }
+    }
+
+    return (sim->state == BOOTLOADER_SIM_STATE_OFF) ? BOOTLOADER_ERROR_FLASH : BOOTLOADER_OK;
+}
+
+static void Bootloader_Sim_Send(void *context, const uint8_t *data, uint32_t length)
+{
+    Bootloader_Sim_Context *sim = (Bootloader_Sim_Context *)context;
+
+    // A board that lost its power during the command sends nothing
+    if (sim->state == BOOTLOADER_SIM_STATE_OFF)
+    {
+        return;
+    }
+
+    if (sim->output_length + length > BOOTLOADER_SIM_OUTPUT_CAPACITY)
+    {
+        sim->output_overflow_count++;
+        return;
+    }
+
+    memcpy(&sim->output[sim->output_length], data, length);
+    sim->output_length += length;
+}
+
+static void Bootloader_Sim_Set_Baud(void *context, uint32_t baud)
+{
+    ((Bootloader_Sim_Context *)context)->baud = baud;
+}
+
+// The reset happens in Bootloader_Sim_Receive_Byte, once the core has returned
+static void Bootloader_Sim_Request_Reset(void *context)
+{
+    ((Bootloader_Sim_Context *)context)->reset_requested = 1;
+}
+
+static const Bootloader_Ops Bootloader_Sim_Ops =
+{
+    Bootloader_Sim_Erase_Sector,
+    Bootloader_Sim_Program,
+    Bootloader_Sim_Send,
+    Bootloader_Sim_Set_Baud,
+    Bootloader_Sim_Request_Reset
+};
+
+void Bootloader_Sim_Init(Bootloader *bootloader, Bootloader_Sim_Context *context, uint32_t baud)
+{
+    memset(context, 0, sizeof(*context));
+    memset(context->flash, 0xFF, sizeof(context->flash));
+
+    // Stand-in for the resident bootloader, which the updates must leave alone
+    for (uint32_t i = 0; i < BOOTLOADER_RESIDENT_SIZE; i++)
+    {
+        context->flash[i] = (uint8_t)(i * 7 + 0x5B);
+    }
+
+    context->reset_baud = baud;
+
+    Bootloader_Sim_Reset(bootloader, context, 0);
+}
+
+void Bootloader_Sim_Load(Bootloader_Sim_Context *context, const uint8_t *image, uint32_t length)
+{
+    uint8_t *header = &context->flash[BOOTLOADER_APP_HEADER_ADDRESS];
+    uint32_t fields[3];
+
+    if (length > BOOTLOADER_SIM_FLASH_SIZE - BOOTLOADER_APP_ADDRESS)
+    {
+        length = BOOTLOADER_SIM_FLASH_SIZE - BOOTLOADER_APP_ADDRESS;
+    }
+
+    memset(header, 0xFF, BOOTLOADER_SIM_FLASH_SIZE - BOOTLOADER_APP_HEADER_ADDRESS);
+    memcpy(&context->flash[BOOTLOADER_APP_ADDRESS], image, length);
+
+    fields[0] = BOOTLOADER_APP_MAGIC;
+    fields[1] = length;
+    fields[2] = Bootloader_CRC32(0, image, length);
+
+    for (int i = 0; i < 12; i++)
+    {
+        header[i] = (uint8_t)(fields[i / 4] >> (8 * (i % 4)));
+    }
+}
+
+void Bootloader_Sim_Reset(Bootloader *bootloader, Bootloader_Sim_Context *context, uint8_t requested)
+{
+    context->reset_requested = 0;
+    context->enter_count = 0;
+    context->power_fail_countdown = 0;
+    context->baud = context->reset_baud;
+    context->reset_count++;
+
+    // The decision of Bootloader_MSP432_Start
+    if (!requested && Bootloader_Application_Valid(context->flash, BOOTLOADER_SIM_FLASH_SIZE))
+    {
+        context->state = BOOTLOADER_SIM_STATE_APPLICATION;
+        return;
+    }
+
+    context->state = BOOTLOADER_SIM_STATE_BOOTLOADER;
+    Bootloader_Init(bootloader, &Bootloader_Sim_Ops, context, context->flash,
+                    BOOTLOADER_SIM_FLASH_SIZE, BOOTLOADER_SIM_SECTOR_SIZE, context->baud);
+}
+
+void Bootloader_Sim_Receive_Byte(Bootloader *bootloader, Bootloader_Sim_Context *context, uint8_t byte)
+{
+    if (context->state == BOOTLOADER_SIM_STATE_BOOTLOADER)
+    {
+        Bootloader_Receive_Byte(bootloader, byte);
+
+        if (context->reset_requested)
+        {
+            Bootloader_Sim_Reset(bootloader, context, 0);
+        }
+    }
+    else if (context->state == BOOTLOADER_SIM_STATE_APPLICATION)
+    {
+        // Like Bootloader_MSP432_Enter_Byte and Bootloader_MSP432_Restart
+        context->enter_count = (byte == BOOTLOADER_ENTER_BYTE) ? context->enter_count + 1 : 0;
+
+        if (context->enter_count >= BOOTLOADER_SIM_ENTER_COUNT)
+        {
+            Bootloader_Sim_Reset(bootloader, context, 1);
+        }
+    }
+}
+
+void Bootloader_Sim_Power_Fail(Bootloader_Sim_Context *context, uint32_t operations)
+{
+    context->power_fail_countdown = operations;
+}
+
+uint32_t Bootloader_Sim_Read_Output(Bootloader_Sim_Context *context, uint8_t *data, uint32_t capacity)
+{
+    uint32_t length = (context->output_length < capacity) ? context->output_length : capacity;
+
+    memcpy(data, context->output, length);
+    memmove(context->output, &context->output[length], context->output_length - length);
+    context->output_length -= length;
+
+    return length;
+}
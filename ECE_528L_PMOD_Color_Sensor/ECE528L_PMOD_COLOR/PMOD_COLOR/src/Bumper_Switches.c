@@ -0,0 +1,155 @@
+/**
+ * @file Bumper_Switches.c
+ * @brief Source code for the Bumper_Switches module.
+ *
+ * This file contains the function definitions for the interrupt-driven bumper switches.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Bumper_Switches.h"
+
+// Selects the edges for the switches, then reads them again until they did not change meanwhile.
+// A change after the last read raises the interrupt again, since its edge is then selected
+static uint8_t Bumper_Switches_Watch(Bumper_Switches *bumpers)
+{
+    uint8_t closed = bumpers->ops->read(bumpers->context);
+
+    while (1)
+    {
+        bumpers->ops->watch(bumpers->context, closed);
+
+        uint8_t again = bumpers->ops->read(bumpers->context);
+
+        if (again == closed)
+        {
+            return closed;
+        }
+
+        closed = again;
+    }
+}
+
+static void Bumper_Switches_Update(Bumper_Switches *bumpers, uint8_t closed, uint32_t now_ms)
+{
+    uint8_t previous = bumpers->closed;
+
+    if ((closed != 0) && (previous == 0))
+    {
+        if (bumpers->opened_valid && ((uint32_t)(now_ms - bumpers->opened_ms) < bumpers->debounce_ms))
+        {
+            bumpers->bounces++;
+        }
+        else
+        {
+            bumpers->collisions++;
+            bumpers->collision = 1;
+            bumpers->event.switches = closed;
+            bumpers->event.time_ms = now_ms;
+            bumpers->event_pending = 1;
+
+            if (bumpers->callback != 0)
+            {
+                bumpers->callback(closed, bumpers->callback_context);
+            }
+        }
+    }
+    else if (bumpers->event_pending)
+    {
+        // More switches of the same collision
+        bumpers->event.switches |= closed;
+    }
+
+    if ((closed == 0) && (previous != 0))
+    {
+        bumpers->opened_valid = 1;
+        bumpers->opened_ms = now_ms;
+    }
+
+    bumpers->closed = closed;
+}
+
+void Bumper_Switches_Init(Bumper_Switches *bumpers, const Bumper_Switches_Ops *ops, void *context, uint32_t debounce_ms,
+                          Bumper_Switches_Callback callback, void *callback_context)
+{
+    bumpers->ops = ops;
+    bumpers->context = context;
+    bumpers->debounce_ms = debounce_ms;
+    bumpers->callback = callback;
+    bumpers->callback_context = callback_context;
+    bumpers->closed = 0;
+    bumpers->opened_valid = 0;
+    bumpers->opened_ms = 0;
+    bumpers->collision = 0;
+    bumpers->event_pending = 0;
+    bumpers->event.switches = 0;
+    bumpers->event.time_ms = 0;
+    bumpers->interrupts = 0;
+    bumpers->collisions = 0;
+    bumpers->bounces = 0;
+
+    uint32_t state = ops->lock(context);
+    uint8_t closed = Bumper_Switches_Watch(bumpers);
+
+    Bumper_Switches_Update(bumpers, closed, ops->now_ms(context));
+    ops->unlock(context, state);
+}
+
+void Bumper_Switches_Handle_Interrupt(Bumper_Switches *bumpers)
+{
+    uint32_t now_ms = bumpers->ops->now_ms(bumpers->context);
+    uint8_t closed = Bumper_Switches_Watch(bumpers);
+
+    bumpers->interrupts++;
+    Bumper_Switches_Update(bumpers, closed, now_ms);
+}
+
+uint8_t Bumper_Switches_Take_Event(Bumper_Switches *bumpers, Bumper_Switches_Event *event)
+{
+    uint32_t state = bumpers->ops->lock(bumpers->context);
+    uint8_t taken = bumpers->event_pending;
+
+    if (taken)
+    {
+        *event = bumpers->event;
+        bumpers->event_pending = 0;
+    }
+
+    bumpers->ops->unlock(bumpers->context, state);
+    return taken;
+}
+
+uint8_t Bumper_Switches_Acknowledge(Bumper_Switches *bumpers)
+{
+    uint32_t state = bumpers->ops->lock(bumpers->context);
+
+    if (bumpers->closed == 0)
+    {
+        bumpers->collision = 0;
+    }
+
+    uint8_t clear = !bumpers->collision;
+
+    bumpers->ops->unlock(bumpers->context, state);
+    return clear;
+}
+
+uint8_t Bumper_Switches_Drive(Bumper_Switches *bumpers, void (*move)(uint16_t, uint16_t), uint16_t left_duty_cycle, uint16_t right_duty_cycle)
+{
+    uint32_t state = bumpers->ops->lock(bumpers->context);
+    uint8_t clear = (!bumpers->collision) && (bumpers->closed == 0);
+
+    if (clear)
+    {
+        move(left_duty_cycle, right_duty_cycle);
+    }
+
+    bumpers->ops->unlock(bumpers->context, state);
+    return clear;
+}
+
+void Bumper_Switches_Print_Stats(const Bumper_Switches *bumpers)
+{
+    printf("bumper: %lu interrupts, %lu collisions, %lu bounces\n", (unsigned long)bumpers->interrupts,
+           (unsigned long)bumpers->collisions, (unsigned long)bumpers->bounces);
+}
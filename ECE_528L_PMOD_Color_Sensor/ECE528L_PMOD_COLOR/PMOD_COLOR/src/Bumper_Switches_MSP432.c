@@ -0,0 +1,174 @@
+/**
+ * @file Bumper_Switches_MSP432.c
+ * @brief Source code for the Bumper_Switches_MSP432 backend.
+ *
+ * This file contains the function definitions for the Port 4 backend of the bumper switches.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Bumper_Switches_MSP432.h"
+#include "../inc/Critical_Section.h"
+
+// Module served by PORT4_IRQHandler, and the priority of the interrupt, which the lock masks
+static Bumper_Switches *Bumper_Switches_MSP432_Bumpers = 0;
+static uint32_t Bumper_Switches_MSP432_Priority = BUMPER_SWITCHES_MSP432_PRIORITY;
+
+// DWT cycle count right after the last motor cutoff
+static volatile uint32_t Bumper_Switches_MSP432_Cutoff_Cycles = 0;
+
+// Converts between the Port 4 pins and the switch bits (bit 0 = BUMP0)
+static uint8_t Bumper_Switches_MSP432_From_Pins(uint8_t pins)
+{
+    return (pins & 0x01) | ((pins >> 1) & 0x06) | ((pins >> 2) & 0x38);
+}
+
+static uint8_t Bumper_Switches_MSP432_To_Pins(uint8_t switches)
+{
+    return (switches & 0x01) | ((switches & 0x06) << 1) | ((switches & 0x38) << 2);
+}
+
+static uint8_t Bumper_Switches_MSP432_Read(void *context)
+{
+    (void)context;
+
+    // The switches are active low
+    return Bumper_Switches_MSP432_From_Pins(~P4->IN & BUMPER_SWITCHES_MSP432_PINS);
+}
+
+static void Bumper_Switches_MSP432_Watch(void *context, uint8_t closed)
+{
+    (void)context;
+
+    // IES = 1 selects the falling edge, which is the closing of an open switch. Writing IES can set
+    // the flag of the pin, so the flags are cleared afterwards
+    P4->IES = (P4->IES & ~BUMPER_SWITCHES_MSP432_PINS) | (~Bumper_Switches_MSP432_To_Pins(closed) & BUMPER_SWITCHES_MSP432_PINS);
+    P4->IFG &= ~BUMPER_SWITCHES_MSP432_PINS;
+}
+
+static uint32_t Bumper_Switches_MSP432_Now_ms(void *context)
+{
+    return Tickless_Timer_Now_ms((Tickless_Timer *)context);
+}
+
+static uint32_t Bumper_Switches_MSP432_Lock(void *context)
+{
+    (void)context;
+
+    return Critical_Section_Enter(Bumper_Switches_MSP432_Priority);
+}
+
+static void Bumper_Switches_MSP432_Unlock(void *context, uint32_t state)
+{
+    (void)context;
+
+    Critical_Section_Exit(state);
+}
+
+static const Bumper_Switches_Ops Bumper_Switches_MSP432_Ops =
+{
+    Bumper_Switches_MSP432_Read,
+    Bumper_Switches_MSP432_Watch,
+    Bumper_Switches_MSP432_Now_ms,
+    Bumper_Switches_MSP432_Lock,
+    Bumper_Switches_MSP432_Unlock,
+};
+
+void Bumper_Switches_MSP432_Init(Bumper_Switches *bumpers, Tickless_Timer *timer, uint32_t priority,
+                                 Bumper_Switches_Callback callback, void *callback_context)
+{
+    // Configure the switch pins as GPIO inputs with pull-up resistors
+    P4->SEL0 &= ~BUMPER_SWITCHES_MSP432_PINS;
+    P4->SEL1 &= ~BUMPER_SWITCHES_MSP432_PINS;
+    P4->DIR &= ~BUMPER_SWITCHES_MSP432_PINS;
+    P4->REN |= BUMPER_SWITCHES_MSP432_PINS;
+    P4->OUT |= BUMPER_SWITCHES_MSP432_PINS;
+
+    // Start the cycle counter for the latency measurements
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Bumper_Switches_MSP432_Bumpers = bumpers;
+    Bumper_Switches_MSP432_Priority = priority;
+    Bumper_Switches_Init(bumpers, &Bumper_Switches_MSP432_Ops, timer, BUMPER_SWITCHES_DEBOUNCE_MS, callback, callback_context);
+
+    P4->IE |= BUMPER_SWITCHES_MSP432_PINS;
+
+    NVIC_SetPriority(PORT4_IRQn, priority);
+    NVIC_EnableIRQ(PORT4_IRQn);
+}
+
+void Bumper_Switches_MSP432_Measure_Latency(Bumper_Switches_MSP432_Latency *latency, uint32_t trials)
+{
+    latency->trials = 0;
+    latency->min_cycles = UINT32_MAX;
+    latency->max_cycles = 0;
+    latency->sum_cycles = 0;
+
+    for (uint32_t i = 0; i < trials; i++)
+    {
+        uint32_t start = DWT->CYCCNT;
+
+        // The interrupt is taken once the write has completed
+        P4->IFG |= 0x01;
+        __DSB();
+        __ISB();
+
+        uint32_t cycles = Bumper_Switches_MSP432_Cutoff_Cycles - start;
+
+        latency->trials++;
+        latency->sum_cycles += cycles;
+
+        if (cycles < latency->min_cycles)
+        {
+            latency->min_cycles = cycles;
+        }
+
+        if (cycles > latency->max_cycles)
+        {
+            latency->max_cycles = cycles;
+        }
+    }
+}
+
+void Bumper_Switches_MSP432_Print_Latency(const Bumper_Switches_MSP432_Latency *latency)
+{
+    if (latency->trials == 0)
+    {
+        return;
+    }
+
+    uint32_t mean_cycles = (uint32_t)(latency->sum_cycles / latency->trials);
+
+    // 48 cycles per microsecond
+    printf("bumper cutoff: %lu trials, min %lu, mean %lu, max %lu cycles (max %lu ns)\n",
+           (unsigned long)latency->trials, (unsigned long)latency->min_cycles, (unsigned long)mean_cycles,
+           (unsigned long)latency->max_cycles, (unsigned long)((uint64_t)latency->max_cycles * 1000 / 48));
+}
+
+/**
+ * @brief Interrupt service routine for the bumper switches.
+ *
+ * Disables both motors first, by clearing their enable pins P3.6 and P3.7, then records the cycle
+ * count for Bumper_Switches_MSP432_Measure_Latency and lets the module read the switches, reselect
+ * their edges and post a collision.
+ *
+ * @param None
+ *
+ * @return None
+ */
+void PORT4_IRQHandler(void)
+{
+    P3->OUT &= ~0xC0;
+    Bumper_Switches_MSP432_Cutoff_Cycles = DWT->CYCCNT;
+
+    if (Bumper_Switches_MSP432_Bumpers != 0)
+    {
+        Bumper_Switches_Handle_Interrupt(Bumper_Switches_MSP432_Bumpers);
+    }
+    else
+    {
+        P4->IFG &= ~BUMPER_SWITCHES_MSP432_PINS;
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file Bumper_Switches_Sim.c
+ * @brief Source code for the Bumper_Switches_Sim backend.
+ *
+ * This file contains the function definitions for the simulated backend of the bumper switches.
+ *
+ */
+
+#include "../inc/Bumper_Switches_Sim.h"
+
+// Takes the interrupt while a flag is set and nothing masks it
+static void Bumper_Switches_Sim_Take_Interrupt(Bumper_Switches_Sim_Context *context)
+{
+    while ((context->flags != 0) && !context->locked && !context->in_interrupt && (context->bumpers != 0))
+    {
+        context->in_interrupt = 1;
+        context->interrupts++;
+
+        // As in PORT4_IRQHandler, the motors are disabled before anything else
+        if (context->motors_enabled)
+        {
+            context->motors_enabled = 0;
+            context->cutoffs++;
+        }
+
+        Bumper_Switches_Handle_Interrupt(context->bumpers);
+        context->in_interrupt = 0;
+    }
+}
+
+static void Bumper_Switches_Sim_Run_Hook(Bumper_Switches_Sim_Context *context)
+{
+    if (context->in_interrupt && (context->hook != 0))
+    {
+        context->hook(context);
+    }
+}
+
+static uint8_t Bumper_Switches_Sim_Read(void *context)
+{
+    Bumper_Switches_Sim_Context *sim = (Bumper_Switches_Sim_Context *)context;
+
+    Bumper_Switches_Sim_Run_Hook(sim);
+    return sim->closed;
+}
+
+static void Bumper_Switches_Sim_Watch(void *context, uint8_t closed)
+{
+    Bumper_Switches_Sim_Context *sim = (Bumper_Switches_Sim_Context *)context;
+    uint8_t watch_closing = ~closed & BUMPER_SWITCHES_ALL;
+
+    // Selecting an edge that matches the current level of a switch sets its flag, like writing PxIES
+    sim->flags |= (watch_closing ^ sim->watch_closing) & (sim->closed ^ ~watch_closing) & BUMPER_SWITCHES_ALL;
+    sim->watch_closing = watch_closing;
+
+    Bumper_Switches_Sim_Run_Hook(sim);
+    sim->flags = 0;
+    Bumper_Switches_Sim_Run_Hook(sim);
+}
+
+static uint32_t Bumper_Switches_Sim_Now_ms(void *context)
+{
+    Bumper_Switches_Sim_Context *sim = (Bumper_Switches_Sim_Context *)context;
+
+    return (uint32_t)(sim->time_us / 1000);
+}
+
+static uint32_t Bumper_Switches_Sim_Lock(void *context)
+{
+    Bumper_Switches_Sim_Context *sim = (Bumper_Switches_Sim_Context *)context;
+    uint32_t state = sim->locked;
+
+    sim->locked = 1;
+    return state;
+}
+
+static void Bumper_Switches_Sim_Unlock(void *context, uint32_t state)
+{
+    Bumper_Switches_Sim_Context *sim = (Bumper_Switches_Sim_Context *)context;
+
+    sim->locked = (uint8_t)state;
+    Bumper_Switches_Sim_Take_Interrupt(sim);
+}
+
+static const Bumper_Switches_Ops Bumper_Switches_Sim_Ops =
+{
+    Bumper_Switches_Sim_Read,
+    Bumper_Switches_Sim_Watch,
+    Bumper_Switches_Sim_Now_ms,
+    Bumper_Switches_Sim_Lock,
+    Bumper_Switches_Sim_Unlock,
+};
+
+void Bumper_Switches_Sim_Init(Bumper_Switches *bumpers, Bumper_Switches_Sim_Context *context, uint32_t debounce_ms,
+                              Bumper_Switches_Callback callback, void *callback_context)
+{
+    context->time_us = 0;
+    context->closed = 0;
+    context->watch_closing = 0;
+    context->flags = 0;
+    context->locked = 0;
+    context->in_interrupt = 0;
+    context->motors_enabled = 0;
+    context->bumpers = 0;
+    context->hook = 0;
+    context->hook_context = 0;
+    context->interrupts = 0;
+    context->cutoffs = 0;
+
+    Bumper_Switches_Init(bumpers, &Bumper_Switches_Sim_Ops, context, debounce_ms, callback, callback_context);
+    context->bumpers = bumpers;
+}
+
+void Bumper_Switches_Sim_Set(Bumper_Switches_Sim_Context *context, uint8_t closed)
+{
+    uint8_t changed = (closed ^ context->closed) & BUMPER_SWITCHES_ALL;
+
+    // A closing raises the flag of a switch waiting for it, and an opening the flag of the others
+    context->flags |= changed & ~(closed ^ context->watch_closing);
+    context->closed = closed & BUMPER_SWITCHES_ALL;
+
+    Bumper_Switches_Sim_Take_Interrupt(context);
+}
+
+void Bumper_Switches_Sim_Advance(Bumper_Switches_Sim_Context *context, uint64_t us)
+{
+    context->time_us += us;
+}
+
+void Bumper_Switches_Sim_Mask(Bumper_Switches_Sim_Context *context, uint8_t locked)
+{
+    context->locked = locked;
+    Bumper_Switches_Sim_Take_Interrupt(context);
+}
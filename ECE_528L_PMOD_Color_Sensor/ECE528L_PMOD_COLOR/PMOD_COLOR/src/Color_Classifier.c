@@ -0,0 +1,54 @@
+/**
+ * @file Color_Classifier.c
+ * @brief Source code for the Color_Classifier module.
+ *
+ * This file contains the function definitions for the threshold classifier used by the Simon game.
+ *
+ */
+
+#include "../inc/Color_Classifier.h"
+#include "../inc/Fixed_Point.h"
+
+const Color_Classifier_Params Color_Classifier_Default_Params =
+{
+    COLOR_CLASSIFIER_GREEN_MARGIN,
+    COLOR_CLASSIFIER_YELLOW_MIN_RG,
+    COLOR_CLASSIFIER_YELLOW_MAX_BLUE,
+    COLOR_CLASSIFIER_RED_MARGIN
+};
+
+static const char *const Color_Classifier_Names[COLOR_CLASSIFIER_NUM_COLORS] =
+{
+    "GREEN", "RED", "YELLOW", "UNKNOWN"
+};
+
+Color_t Color_Classifier_Classify(const Color_Classifier_Params *params, uint16_t R, uint16_t G, uint16_t B)
+{
+    // The margins are added with saturation: a sum that stops at 0xFFFF is still above every channel,
+    // so the rules give the same results as the int comparisons of the original Detect_Color
+
+    // ---- GREEN ----
+    if ((G > Fixed_Point_Add_U16(R, params->green_margin)) && (G > Fixed_Point_Add_U16(B, params->green_margin)))
+    {
+        return COLOR_GREEN;
+    }
+
+    // ---- YELLOW ----
+    if ((R > params->yellow_min_rg) && (G > params->yellow_min_rg) && (B < params->yellow_max_blue))
+    {
+        return COLOR_YELLOW;
+    }
+
+    // ---- RED ----
+    if ((R > Fixed_Point_Add_U16(G, params->red_margin)) && (R > Fixed_Point_Add_U16(B, params->red_margin)))
+    {
+        return COLOR_RED;
+    }
+
+    return COLOR_UNKNOWN;
+}
+
+const char *Color_Classifier_Name(Color_t color)
+{
+    return (color < COLOR_CLASSIFIER_NUM_COLORS) ? Color_Classifier_Names[color] : "UNKNOWN";
+}
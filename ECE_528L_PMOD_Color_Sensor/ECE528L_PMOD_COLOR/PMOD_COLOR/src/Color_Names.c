@@ -0,0 +1,154 @@
+/**
+ * @file Color_Names.c
+ * @brief Source code for the Color_Names module.
+ *
+ * This file contains the function definitions for the nearest named color search over the grid.
+ *
+ */
+
+#include "../inc/Color_Names.h"
+#include "../inc/Fixed_Point.h"
+
+Color_Names_Key Color_Names_Key_From_RGB(uint16_t R, uint16_t G, uint16_t B)
+{
+    Color_Names_Key key;
+    uint32_t sum = (uint32_t)R + G + B;
+
+    if (sum == 0)
+    {
+        key.x = COLOR_NAMES_ONE / 3;
+        key.y = COLOR_NAMES_ONE / 3;
+        key.lightness = 0;
+        return key;
+    }
+
+    // R * 32768 fits in 32 bits; R and G are divided with the reciprocal of the sum
+    Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(sum);
+
+    key.x = (uint16_t)Fixed_Point_Divide((uint32_t)R * COLOR_NAMES_ONE + sum / 2, sum, reciprocal);
+    key.y = (uint16_t)Fixed_Point_Divide((uint32_t)G * COLOR_NAMES_ONE + sum / 2, sum, reciprocal);
+    key.lightness = (uint16_t)(sum / 6);
+
+    return key;
+}
+
+uint32_t Color_Names_Distance(const Color_Names_Key *a, const Color_Names_Key *b)
+{
+    int32_t dx = (int32_t)a->x - b->x;
+    int32_t dy = (int32_t)a->y - b->y;
+    int32_t dl = (int32_t)a->lightness - b->lightness;
+
+    // Each term is below 2^30, so the sum fits in 32 bits
+    return (uint32_t)(dx * dx) + (uint32_t)(dy * dy) + ((uint32_t)(dl * dl) >> COLOR_NAMES_LIGHTNESS_SHIFT);
+}
+
+static void Color_Names_Scan(const Color_Names_Database *database, const Color_Names_Key *key, uint16_t first,
+                             uint16_t end, Color_Names_Match *match)
+{
+    for (uint16_t i = first; i < end; i++)
+    {
+        uint32_t distance = Color_Names_Distance(key, &database->entries[i].key);
+
+        if ((distance < match->distance) || ((distance == match->distance) && (i < match->index)))
+        {
+            match->index = i;
+            match->distance = distance;
+        }
+    }
+
+    match->compared += end - first;
+}
+
+static void Color_Names_Scan_Cell(const Color_Names_Database *database, const Color_Names_Key *key, int cx, int cy,
+                                  Color_Names_Match *match)
+{
+    uint32_t cell = ((uint32_t)cy << database->grid_bits) + (uint32_t)cx;
+
+    Color_Names_Scan(database, key, database->cells[cell], database->cells[cell + 1], match);
+}
+
+void Color_Names_Find(const Color_Names_Database *database, const Color_Names_Key *key, Color_Names_Match *match)
+{
+    int shift = 15 - database->grid_bits;
+    int size = 1 << database->grid_bits;
+    int cx = key->x >> shift;
+    int cy = key->y >> shift;
+
+    match->index = COLOR_NAMES_NONE;
+    match->distance = UINT32_MAX;
+    match->compared = 0;
+
+    // x or y is 1.0 only on the edge of the grid
+    if (cx >= size) cx = size - 1;
+    if (cy >= size) cy = size - 1;
+
+    for (int r = 0; ; r++)
+    {
+        // Cells at a distance of exactly r cells from the cell of the key: the rows above and below,
+        // then the columns on the left and right, within the grid
+        int left = cx - r;
+        int right = cx + r;
+        int bottom = cy - r;
+        int top = cy + r;
+
+        for (int x = (left < 0) ? 0 : left; x <= ((right < size) ? right : size - 1); x++)
+        {
+            if (bottom >= 0) Color_Names_Scan_Cell(database, key, x, bottom, match);
+            if ((top < size) && (r > 0)) Color_Names_Scan_Cell(database, key, x, top, match);
+        }
+
+        for (int y = (bottom + 1 < 0) ? 0 : bottom + 1; y <= ((top - 1 < size) ? top - 1 : size - 1); y++)
+        {
+            if (left >= 0) Color_Names_Scan_Cell(database, key, left, y, match);
+            if (right < size) Color_Names_Scan_Cell(database, key, right, y, match);
+        }
+
+        // Every cell left is beyond a side of the ring that is inside the grid, so its entries are at
+        // least as far as that side in chromaticity. The search stops when that bound exceeds the
+        // best distance; an entry at the same distance could still have a lower index
+        uint32_t bound = UINT32_MAX;
+
+        if (left > 0)
+        {
+            uint32_t d = key->x - ((uint32_t)left << shift);
+            if (d < bound) bound = d;
+        }
+
+        if (right + 1 < size)
+        {
+            uint32_t d = ((uint32_t)(right + 1) << shift) - key->x;
+            if (d < bound) bound = d;
+        }
+
+        if (bottom > 0)
+        {
+            uint32_t d = key->y - ((uint32_t)bottom << shift);
+            if (d < bound) bound = d;
+        }
+
+        if (top + 1 < size)
+        {
+            uint32_t d = ((uint32_t)(top + 1) << shift) - key->y;
+            if (d < bound) bound = d;
+        }
+
+        if ((bound == UINT32_MAX) || (bound * bound > match->distance))
+        {
+            return;
+        }
+    }
+}
+
+void Color_Names_Find_Linear(const Color_Names_Database *database, const Color_Names_Key *key, Color_Names_Match *match)
+{
+    match->index = COLOR_NAMES_NONE;
+    match->distance = UINT32_MAX;
+    match->compared = 0;
+
+    Color_Names_Scan(database, key, 0, database->count, match);
+}
+
+const char *Color_Names_Name(const Color_Names_Database *database, uint16_t index)
+{
+    return (index < database->count) ? database->entries[index].name : "none";
+}
@@ -0,0 +1,181 @@
+/**
+ * @file Color_Names_Table.c
+ * @brief Named color database of the Color_Names module.
+ *
+ * Generated by host_tools/color_names from named_colors.csv: 139 colors on a grid of 16 x 16 cells.
+ *
+ */
+
+#include "../inc/Color_Names.h"
+
+static const Color_Names_Entry Color_Names_Entries[139] =
+{
+    { {     0,     0, 10922 }, "blue" },
+    { {     0,     0,  2820 }, "darkblue" },
+    { {     0,     0,  6668 }, "mediumblue" },
+    { {  1755,  1755,  1982 }, "midnightblue" },
+    { {     0,     0,  2357 }, "navy" },
+    { {  8017,   762, 11346 }, "blueviolet" },
+    { {  7853,     0,  3206 }, "indigo" },
+    { { 10938,  1095, 10423 }, "darkorchid" },
+    { { 10241,     0, 10349 }, "darkviolet" },
+    { { 16384,     0,  5640 }, "darkmagenta" },
+    { { 16384,     0, 21845 }, "fuchsia" },
+    { { 16384,     0,  4715 }, "purple" },
+    { { 23015,   302,  8881 }, "mediumvioletred" },
+    { { 25230,   176, 14185 }, "deeppink" },
+    { { 29178,  1795,  4615 }, "brown" },
+    { { 30542,   298,  8387 }, "crimson" },
+    { { 30572,  1098,  5212 }, "firebrick" },
+    { { 32768,     0,  2820 }, "darkred" },
+    { { 32768,     0,  2357 }, "maroon" },
+    { { 30927,  1841, 11572 }, "orangered" },
+    { { 32768,     0, 10922 }, "red" },
+    { {  5447,  3807, 13014 }, "mediumslateblue" },
+    { {  5512,  3910,  9359 }, "slateblue" },
+    { {  8986,  2239,  5292 }, "rebeccapurple" },
+    { { 13046,  2414, 13470 }, "mediumorchid" },
+    { { 14961,  3458, 16772 }, "orchid" },
+    { { 14492,  3784, 21115 }, "violet" },
+    { { 20510,  2897, 17450 }, "hotpink" },
+    { { 27588,  3442, 12973 }, "tomato" },
+    { {  1829,  4888, 10344 }, "royalblue" },
+    { {  5745,  4136,  4037 }, "darkslateblue" },
+    { {  8227,  4569, 12693 }, "mediumpurple" },
+    { { 19973,  4569, 12693 }, "palevioletred" },
+    { { 21912,  5428, 14232 }, "lightcoral" },
+    { { 24261,  4253,  9006 }, "indianred" },
+    { { 23375,  5278, 14637 }, "salmon" },
+    { { 26440,  5796,  8724 }, "chocolate" },
+    { { 25353,  5381, 14116 }, "coral" },
+    { { 26095,  6015,  3541 }, "saddlebrown" },
+    { { 24924,  5983,  5048 }, "sienna" },
+    { {   329,  7074, 14110 }, "dodgerblue" },
+    { {  3276,  7725, 13924 }, "cornflowerblue" },
+    { { 13180,  6408, 19634 }, "plum" },
+    { { 16375,  7660, 21856 }, "lightpink" },
+    { { 15425,  8131, 23202 }, "pink" },
+    { { 20313,  7603, 14357 }, "darksalmon" },
+    { { 21193,  7450, 16887 }, "lightsalmon" },
+    { { 25960,  6808, 13787 }, "darkorange" },
+    { {  2709,  9873,  8092 }, "steelblue" },
+    { { 10214, 10214, 27727 }, "lavender" },
+    { { 11878,  9012, 20691 }, "thistle" },
+    { { 12958, 10053, 27620 }, "mistyrose" },
+    { { 15661,  8554, 11493 }, "rosybrown" },
+    { { 22358,  8590,  9773 }, "peru" },
+    { { 21283,  8734, 15213 }, "sandybrown" },
+    { { 23810,  8958, 15032 }, "orange" },
+    { {     0, 11224, 16613 }, "deepskyblue" },
+    { {  4373, 11140, 19829 }, "lightskyblue" },
+    { {  4697, 11965, 18462 }, "skyblue" },
+    { {  7223, 11869, 20707 }, "lightblue" },
+    { {  8068, 10768,  8183 }, "lightslategray" },
+    { {  8084, 10769,  7173 }, "slategray" },
+    { { 10161, 10946, 30692 }, "aliceblue" },
+    { {  9944, 11412, 31362 }, "azure" },
+    { {  8897, 11936, 29986 }, "lightcyan" },
+    { {  8287, 10537, 18749 }, "lightsteelblue" },
+    { { 11771, 11771, 27763 }, "beige" },
+    { { 10922, 10922,     0 }, "black" },
+    { { 10923, 10923, 13000 }, "darkgray" },
+    { { 10923, 10923,  4629 }, "dimgray" },
+    { { 11590, 11079, 30881 }, "floralwhite" },
+    { { 10923, 10923, 23451 }, "gainsboro" },
+    { { 10690, 10690, 31428 }, "ghostwhite" },
+    { { 10923, 10923,  7073 }, "gray" },
+    { { 10410, 11947, 29957 }, "honeydew" },
+    { { 11412, 11412, 31362 }, "ivory" },
+    { { 11768, 10254, 30413 }, "lavenderblush" },
+    { { 12254, 12254, 27922 }, "lightgoldenrodyellow" },
+    { { 10923, 10923, 21345 }, "lightgray" },
+    { { 11936, 11936, 29986 }, "lightyellow" },
+    { { 11962, 10904, 28602 }, "linen" },
+    { { 10429, 11421, 31337 }, "mintcream" },
+    { { 11980, 11137, 29345 }, "oldlace" },
+    { { 11838, 10809, 30234 }, "seashell" },
+    { { 10923, 10923, 17272 }, "silver" },
+    { { 11253, 10758, 31805 }, "snow" },
+    { { 10923, 10923, 32767 }, "white" },
+    { { 10923, 10923, 29920 }, "whitesmoke" },
+    { { 12701, 11038, 26938 }, "antiquewhite" },
+    { { 14077, 10921, 25425 }, "bisque" },
+    { { 13422, 11151, 26664 }, "blanchedalmond" },
+    { { 12345, 11588, 28992 }, "cornsilk" },
+    { { 12768, 12206, 28032 }, "lemonchiffon" },
+    { { 12959, 11186, 27618 }, "papayawhip" },
+    { { 14286, 11429, 22875 }, "wheat" },
+    { { 14642, 11360, 24443 }, "moccasin" },
+    { { 15253, 11142, 23465 }, "navajowhite" },
+    { { 14988, 10508, 23879 }, "peachpuff" },
+    { { 15492, 10971, 14889 }, "tan" },
+    { { 16484, 10816, 15860 }, "burlywood" },
+    { { 21782, 10834,  7875 }, "darkgoldenrod" },
+    { { 21042, 11292, 11925 }, "goldenrod" },
+    { {  4642, 13868,  8824 }, "cadetblue" },
+    { {  5041, 13864,  2018 }, "darkslategray" },
+    { {  6568, 13100, 23359 }, "paleturquoise" },
+    { {  7218, 12393, 21526 }, "powderblue" },
+    { { 13574, 12812, 22543 }, "palegoldenrod" },
+    { { 14764, 13738, 12336 }, "darkkhaki" },
+    { { 14833, 13470, 21025 }, "khaki" },
+    { { 19510, 13258, 18344 }, "gold" },
+    { {     0, 16118, 13705 }, "darkturquoise" },
+    { {  1626, 15995, 14267 }, "mediumturquoise" },
+    { {  8554, 15661, 11493 }, "darkseagreen" },
+    { {     0, 16384, 21845 }, "aqua" },
+    { {     0, 16384,  5640 }, "darkcyan" },
+    { {   550, 16931,  9411 }, "lightseagreen" },
+    { {     0, 16384,  4715 }, "teal" },
+    { {  1177, 17111, 15591 }, "turquoise" },
+    { {  3718, 17517, 20431 }, "aquamarine" },
+    { {  3801, 17466, 12510 }, "mediumaquamarine" },
+    { { 11178, 18092,  2908 }, "darkolivegreen" },
+    { { 16384, 16384,  4715 }, "olive" },
+    { { 16384, 16384, 21845 }, "yellow" },
+    { {  6469, 19831, 15431 }, "lightgreen" },
+    { {  6460, 19848, 17395 }, "palegreen" },
+    { { 11092, 20408,  4743 }, "olivedrab" },
+    { {  2239, 22344,  7220 }, "mediumseagreen" },
+    { {  2350, 22216,  4159 }, "seagreen" },
+    { { 10967, 20719, 10546 }, "yellowgreen" },
+    { {     0, 24490, 13971 }, "mediumspringgreen" },
+    { {  9468, 22656, 15797 }, "greenyellow" },
+    { {     0, 27031, 13240 }, "springgreen" },
+    { {  5737, 27031, 13240 }, "chartreuse" },
+    { {  5621, 27147, 12834 }, "lawngreen" },
+    { {  1806, 29156,  3169 }, "forestgreen" },
+    { {  1550, 29668,  7364 }, "limegreen" },
+    { {     0, 32768,  1392 }, "darkgreen" },
+    { {     0, 32768,  2357 }, "green" },
+    { {     0, 32768, 10922 }, "lime" }
+};
+
+static const uint16_t Color_Names_Cells[257] =
+{
+    0, 5, 5, 5, 7, 7, 9, 9, 9, 12, 12, 12, 13, 14, 14, 17,
+    21, 21, 21, 23, 23, 24, 24, 25, 27, 27, 27, 28, 28, 28, 29, 29,
+    29, 30, 30, 31, 31, 32, 32, 32, 32, 32, 33, 34, 36, 40, 40, 40,
+    40, 41, 42, 42, 42, 42, 42, 43, 45, 45, 46, 47, 47, 48, 48, 48,
+    48, 48, 49, 49, 49, 50, 51, 52, 53, 53, 53, 55, 56, 56, 56, 56,
+    56, 57, 57, 59, 62, 66, 88, 95, 99, 100, 100, 102, 102, 102, 102, 102,
+    102, 102, 102, 104, 106, 106, 106, 107, 109, 109, 110, 110, 110, 110, 110, 110,
+    110, 112, 112, 112, 112, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+    113, 118, 120, 120, 120, 120, 121, 121, 121, 123, 123, 123, 123, 123, 123, 123,
+    123, 123, 123, 123, 125, 125, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126,
+    126, 126, 128, 128, 128, 128, 129, 129, 129, 129, 129, 129, 129, 129, 129, 129,
+    129, 130, 130, 130, 130, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131,
+    131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 131,
+    131, 132, 132, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134, 134,
+    134, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136, 136,
+    136, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 139,
+    139
+};
+
+const Color_Names_Database Color_Names_Default_Database =
+{
+    Color_Names_Entries,
+    Color_Names_Cells,
+    139,
+    4
+};
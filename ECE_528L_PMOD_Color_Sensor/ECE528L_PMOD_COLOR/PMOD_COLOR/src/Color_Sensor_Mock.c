@@ -0,0 +1,116 @@
+/**
+ * @file Color_Sensor_Mock.c
+ * @brief Source code for the Color_Sensor_Mock driver.
+ *
+ * This file contains the function definitions for a synthetic color sensor that behaves like a
+ * TCS34725. It is used as the Color_Sensor backend for host builds and benchmarks.
+ *
+ */
+
+#include "../inc/Color_Sensor_Mock.h"
+
+static const uint8_t Color_Sensor_Mock_Gains[4] = { 1, 4, 16, 60 };
+
+static uint16_t Mock_Scene[4];
+static uint16_t Mock_Noise_Amplitude;
+static uint32_t Mock_Noise_State;
+static uint32_t Mock_Integration_Cycles;
+static uint32_t Mock_Wait_us;
+static uint8_t Mock_Gain_Index;
+static uint64_t Mock_Time_us;
+static uint32_t Mock_Read_Count;
+
+// xorshift32 pseudo-random number generator
+static uint32_t Color_Sensor_Mock_Random(void)
+{
+    Mock_Noise_State ^= Mock_Noise_State << 13;
+    Mock_Noise_State ^= Mock_Noise_State >> 17;
+    Mock_Noise_State ^= Mock_Noise_State << 5;
+    return Mock_Noise_State;
+}
+
+static uint16_t Color_Sensor_Mock_Channel(uint16_t counts_per_cycle)
+{
+    uint32_t full_scale = 1024 * Mock_Integration_Cycles;
+    int32_t value = (int32_t)(counts_per_cycle * Mock_Integration_Cycles * Color_Sensor_Mock_Gains[Mock_Gain_Index]);
+
+    if (Mock_Noise_Amplitude > 0)
+    {
+        value += (int32_t)(Color_Sensor_Mock_Random() % (2 * Mock_Noise_Amplitude + 1)) - Mock_Noise_Amplitude;
+    }
+
+    // Saturate like the TCS34725
+    if (full_scale > 0xFFFF) full_scale = 0xFFFF;
+    if (value < 0) value = 0;
+    if ((uint32_t)value > full_scale) value = (int32_t)full_scale;
+
+    return (uint16_t)value;
+}
+
+void Color_Sensor_Mock_Init(void)
+{
+    for (int i = 0; i < 4; i++) Mock_Scene[i] = 0;
+
+    Mock_Noise_Amplitude = 0;
+    Mock_Noise_State = 0x12345678;
+    Mock_Integration_Cycles = 1;
+    Mock_Wait_us = 0;
+    Mock_Gain_Index = 0;
+    Mock_Time_us = 0;
+    Mock_Read_Count = 0;
+}
+
+void Color_Sensor_Mock_Set_Color(uint16_t red, uint16_t green, uint16_t blue, uint16_t clear)
+{
+    Mock_Scene[0] = red;
+    Mock_Scene[1] = green;
+    Mock_Scene[2] = blue;
+    Mock_Scene[3] = clear;
+}
+
+void Color_Sensor_Mock_Set_Noise(uint16_t amplitude, uint32_t seed)
+{
+    Mock_Noise_Amplitude = amplitude;
+    Mock_Noise_State = (seed == 0) ? 0x12345678 : seed;
+}
+
+void Color_Sensor_Mock_Set_Timing(uint32_t integration_us, uint32_t wait_us)
+{
+    uint32_t cycles = (integration_us + (COLOR_SENSOR_MOCK_CYCLE_US / 2)) / COLOR_SENSOR_MOCK_CYCLE_US;
+
+    if (cycles < 1) cycles = 1;
+    if (cycles > 256) cycles = 256;
+
+    Mock_Integration_Cycles = cycles;
+    Mock_Wait_us = wait_us;
+}
+
+void Color_Sensor_Mock_Set_Gain(uint8_t gain_index)
+{
+    Mock_Gain_Index = gain_index & 0x03;
+}
+
+PMOD_Color_Data Color_Sensor_Mock_Read(void)
+{
+    PMOD_Color_Data data;
+
+    data.red = Color_Sensor_Mock_Channel(Mock_Scene[0]);
+    data.green = Color_Sensor_Mock_Channel(Mock_Scene[1]);
+    data.blue = Color_Sensor_Mock_Channel(Mock_Scene[2]);
+    data.clear = Color_Sensor_Mock_Channel(Mock_Scene[3]);
+
+    Mock_Time_us += (uint64_t)Mock_Integration_Cycles * COLOR_SENSOR_MOCK_CYCLE_US + Mock_Wait_us;
+    Mock_Read_Count++;
+
+    return data;
+}
+
+uint64_t Color_Sensor_Mock_Get_Time_us(void)
+{
+    return Mock_Time_us;
+}
+
+uint32_t Color_Sensor_Mock_Get_Read_Count(void)
+{
+    return Mock_Read_Count;
+}
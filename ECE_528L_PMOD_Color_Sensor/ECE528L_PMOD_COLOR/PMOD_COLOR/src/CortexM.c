@@ -36,6 +36,7 @@ those of the authors and should not be interpreted as representing official
 policies, either expressed or implied, of the FreeBSD Project.
  */
 #include <stdint.h>
+#include "msp.h"
 #include "../inc/CortexM.h"
 
 
@@ -60,10 +61,12 @@ void EnableInterrupts(void){
 // make a copy of previous I bit, disable interrupts
 // inputs:  none
 // outputs: previous I bit
-void StartCritical(void){
-  __asm  ("    MRS    R0, PRIMASK   ; save old status \n"
-          "    CPSID  I             ; mask all (except faults)\n"
-          "    BX     LR\n");
+// The intrinsics do not depend on the argument and result registers of the calling convention.
+// To mask only the interrupts up to a priority, use Critical_Section.h
+long StartCritical(void){
+  long sr = (long)__get_PRIMASK();  // save old status
+  __disable_irq();                  // mask all (except faults)
+  return sr;
 }
 
 //*********** EndCritical ************************
@@ -71,8 +74,7 @@ void StartCritical(void){
 // inputs:  previous I bit
 // outputs: none
 void EndCritical(long sr){
-  __asm  ("    MSR    PRIMASK, R0\n"
-          "    BX     LR\n");
+  __set_PRIMASK((uint32_t)sr);
 }
 
 //*********** WaitForInterrupt ************************
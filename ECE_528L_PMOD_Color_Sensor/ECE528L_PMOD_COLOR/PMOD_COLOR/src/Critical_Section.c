@@ -0,0 +1,57 @@
+/**
+ * @file Critical_Section.c
+ * @brief Source code for the Critical_Section module.
+ *
+ * This file contains the profile of the BASEPRI critical sections.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Critical_Section.h"
+
+#if CRITICAL_SECTION_PROFILE
+uint32_t Critical_Section_Start_Cycles[CRITICAL_SECTION_PRIORITIES];
+uint32_t Critical_Section_Count[CRITICAL_SECTION_PRIORITIES];
+uint32_t Critical_Section_Max_Cycles[CRITICAL_SECTION_PRIORITIES];
+#endif
+
+void Critical_Section_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void Critical_Section_Print_Stats(uint32_t priority)
+{
+#if CRITICAL_SECTION_PROFILE
+    uint32_t masked_cycles = 0;
+    uint32_t all_cycles = 0;
+
+    for (uint32_t i = 1; i < CRITICAL_SECTION_PRIORITIES; i++)
+    {
+        if (Critical_Section_Count[i] == 0)
+        {
+            continue;
+        }
+
+        printf("critical: priority %lu: %lu sections, max %lu cycles\n", (unsigned long)i,
+               (unsigned long)Critical_Section_Count[i], (unsigned long)Critical_Section_Max_Cycles[i]);
+
+        // The sections at the priority and above mask the interrupt; with PRIMASK, all of them did
+        if ((i <= priority) && (Critical_Section_Max_Cycles[i] > masked_cycles))
+        {
+            masked_cycles = Critical_Section_Max_Cycles[i];
+        }
+
+        if (Critical_Section_Max_Cycles[i] > all_cycles)
+        {
+            all_cycles = Critical_Section_Max_Cycles[i];
+        }
+    }
+
+    printf("critical: priority %lu interrupts wait up to %lu cycles, %lu with PRIMASK sections\n",
+           (unsigned long)priority, (unsigned long)masked_cycles, (unsigned long)all_cycles);
+#else
+    (void)priority;
+#endif
+}
@@ -350,3 +350,16 @@ void EUSCI_A0_UART_Init_Printf()
     // Turn off buffering for stdout
     setvbuf(stdout, NULL, _IONBF, 0);
 }
+
+void EUSCI_A0_UART_Write_Frame(void *context, const uint8_t *frame, uint16_t length)
+{
+    (void)context;
+
+    // The frame must not split a text line that printf has buffered
+    fflush(stdout);
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        EUSCI_A0_UART_OutChar((char)frame[i]);
+    }
+}
@@ -0,0 +1,319 @@
+/**
+ * @file EUSCI_B_I2C.c
+ * @brief Source code for the EUSCI_B_I2C driver.
+ *
+ * This file contains the function definitions for the EUSCI_B_I2C driver.
+ * It is the multi-instance counterpart of the EUSCI_B1_I2C driver: every function takes
+ * the EUSCI_B module (EUSCI_B0 to EUSCI_B3) to operate on, so several I2C buses can be
+ * used at the same time. The EUSCI_B_I2C driver uses busy-wait implementation.
+ *
+ * For more information regarding the Enhanced Universal Serial Communication Interface (eUSCI),
+ * refer to the MSP432Pxx Microcontrollers Technical Reference Manual
+ *
+ */
+
+#include "../inc/EUSCI_B_I2C.h"
+
+uint8_t EUSCI_B_I2C_Get_Index(EUSCI_B_Type *eusci_b)
+{
+    if (eusci_b == EUSCI_B0) return 0;
+    if (eusci_b == EUSCI_B1) return 1;
+    if (eusci_b == EUSCI_B2) return 2;
+    if (eusci_b == EUSCI_B3) return 3;
+    return EUSCI_B_I2C_NUM_MODULES;
+}
+
+static void EUSCI_B_I2C_Pin_Init(EUSCI_B_Type *eusci_b)
+{
+    switch (EUSCI_B_I2C_Get_Index(eusci_b))
+    {
+        // Configure P1.6 (SDA) and P1.7 (SCL) to use the primary module function
+        case 0:
+            P1->SEL0 |= 0xC0;
+            P1->SEL1 &= ~0xC0;
+            break;
+
+        // Configure P6.4 (SDA) and P6.5 (SCL) to use the primary module function
+        case 1:
+            P6->SEL0 |= 0x30;
+            P6->SEL1 &= ~0x30;
+            break;
+
+        // Configure P3.6 (SDA) and P3.7 (SCL) to use the primary module function
+        case 2:
+            P3->SEL0 |= 0xC0;
+            P3->SEL1 &= ~0xC0;
+            break;
+
+        // Configure P6.6 (SDA) and P6.7 (SCL) to use the secondary module function
+        case 3:
+            P6->SEL0 &= ~0xC0;
+            P6->SEL1 |= 0xC0;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void EUSCI_B_I2C_Init(EUSCI_B_Type *eusci_b)
+{
+    // Hold the EUSCI_B module in reset mode by setting the
+    // UCSWRST bit (Bit 0) in the UCBxCTLW0 register
+    eusci_b->CTLW0 |= 0x0001;
+
+    // Configure 7-bit addressing (UCA10, UCSLA10 = 0), single master (UCMM = 0),
+    // master mode (UCMST = 1), I2C mode (UCMODEx = 11b), synchronous mode (UCSYNC = 1)
+    // and SMCLK as the clock source (UCSSELx = 11b). The remaining bits
+    // (UCTXACK, UCTR, UCTXNACK, UCTXSTP, UCTXSTT) are cleared
+    eusci_b->CTLW0 = 0x0001 | 0x0800 | 0x0600 | 0x0100 | 0x00C0;
+
+    // Clear all of the bits in the UCBxCTLW1 register (Bits 8 to 0) since the
+    // advanced I2C features will not be used
+    eusci_b->CTLW1 &= ~0x01FF;
+
+    // Set the I2C clock prescaler value to 30 to divide the SMCLK clock frequency
+    // from 12 MHz to 400 kHz
+    // N = (Clock Frequency) / (SCL Frequency) = (12,000,000 / 400,000) = 30
+    eusci_b->BRW = 30;
+
+    // Configure the SDA and SCL pins of the selected module
+    EUSCI_B_I2C_Pin_Init(eusci_b);
+
+    // Ensure that all of the I2C interrupts are disabled by clearing
+    // Bits 14 to 0 in the UCBxIE register
+    eusci_b->IE &= ~0x7FFF;
+
+    // Take the EUSCI_B module out of reset mode by clearing the
+    // UCSWRST bit (Bit 0) in the UCBxCTLW0 register
+    eusci_b->CTLW0 &= ~0x0001;
+}
+
+void EUSCI_B_I2C_Send_A_Byte(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t data)
+{
+    EUSCI_B_I2C_Send_Multiple_Bytes(eusci_b, slave_address, &data, 1);
+}
+
+void EUSCI_B_I2C_Send_Multiple_Bytes(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer, uint32_t packet_length)
+{
+    // Wait until the EUSCI_B module is not busy by checking the
+    // UCBBUSY bit (Bit 4) in the UCBxSTATW register
+    while((eusci_b->STATW & 0x0010) != 0);
+
+    // Assign the slave device's address to the UCBxI2CSA register
+    eusci_b->I2CSA = slave_address;
+
+    // Set the UCTR bit (Bit 4) to select master transmitter mode, clear the UCTXSTP bit (Bit 2)
+    // and set the UCTXSTT bit (Bit 1) to generate the START condition
+    eusci_b->CTLW0 = (eusci_b->CTLW0 & ~0x0004) | 0x0012;
+
+    // Use a loop to transfer the data individually from the array to the Transmit Buffer
+    for (uint32_t i = 0; i < packet_length; i++)
+    {
+        // Wait until the UCTXIFG0 bit (Bit 1) in the UCBxIFG register is set
+        while((eusci_b->IFG & 0x0002) == 0);
+
+        eusci_b->TXBUF = data_buffer[i];
+    }
+
+    // Wait until the last byte has been moved to the shift register
+    while((eusci_b->IFG & 0x0002) == 0);
+
+    // Generate the STOP condition by setting the
+    // UCTXSTP bit (Bit 2) in the UCBxCTLW0 register
+    eusci_b->CTLW0 |= 0x0004;
+
+    // Ensure that the transmit interrupt flag is not set by clearing the
+    // UCTXIFG0 bit (Bit 1) in the UCBxIFG register
+    eusci_b->IFG &= ~0x0002;
+}
+
+uint8_t EUSCI_B_I2C_Receive_A_Byte(EUSCI_B_Type *eusci_b, uint8_t slave_address)
+{
+    uint8_t received_data;
+
+    EUSCI_B_I2C_Receive_Multiple_Bytes(eusci_b, slave_address, &received_data, 1);
+
+    return received_data;
+}
+
+void EUSCI_B_I2C_Receive_Multiple_Bytes(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer, uint16_t packet_length)
+{
+    // Wait until the EUSCI_B module is not busy by checking the
+    // UCBBUSY bit (Bit 4) in the UCBxSTATW register
+    while((eusci_b->STATW & 0x0010) != 0);
+
+    // Assign the slave device's address to the UCBxI2CSA register
+    eusci_b->I2CSA = slave_address;
+
+    // Clear the UCTR bit (Bit 4) in the UCBxCTLW0 register to configure the EUSCI_B module
+    // in master receiver mode. Then, set the UCTXSTT bit (Bit 1) to generate the START condition
+    eusci_b->CTLW0 = (eusci_b->CTLW0 & ~0x0010) | 0x0002;
+
+    // For a single byte, the STOP condition must be requested as soon as the START condition
+    // has been sent, which is indicated when the UCTXSTT bit (Bit 1) is cleared
+    if (packet_length == 1)
+    {
+        while((eusci_b->CTLW0 & 0x0002) != 0);
+        eusci_b->CTLW0 |= 0x0004;
+    }
+
+    // Use a loop to transfer the data individually from the Receive Buffer to the array
+    for (uint16_t i = 0; i < packet_length; i++)
+    {
+        // Check if it is the last byte and then set the UCTXSTP bit (Bit 2) to generate the STOP condition
+        if ((packet_length > 1) && (i == (packet_length - 1)))
+        {
+            eusci_b->CTLW0 |= 0x0004;
+        }
+
+        // Wait until the UCRXIFG0 bit (Bit 0) in the UCBxIFG register is set
+        while((eusci_b->IFG & 0x0001) == 0);
+
+        data_buffer[i] = eusci_b->RXBUF;
+    }
+
+    // Wait until the STOP condition is transmitted by checking the status of the
+    // UCTXSTP bit (Bit 2) in the UCBxCTLW0 register
+    while((eusci_b->CTLW0 & 0x0004) != 0);
+}
+
+// Waits until a bit in the UCBxIFG register is set. Returns early if the slave
+// did not acknowledge, which is indicated by the UCNACKIFG bit (Bit 5)
+static int EUSCI_B_I2C_Wait_IFG(EUSCI_B_Type *eusci_b, uint16_t flag, uint32_t polls)
+{
+    while((eusci_b->IFG & flag) == 0)
+    {
+        if ((eusci_b->IFG & 0x0020) != 0) return EUSCI_B_I2C_ERROR_NACK;
+        if (polls == 0) return EUSCI_B_I2C_ERROR_TIMEOUT;
+        polls--;
+    }
+    return EUSCI_B_I2C_OK;
+}
+
+// Waits until a bit in the UCBxCTLW0 register is cleared by the hardware
+static int EUSCI_B_I2C_Wait_CTLW0_Clear(EUSCI_B_Type *eusci_b, uint16_t bit, uint32_t polls)
+{
+    while((eusci_b->CTLW0 & bit) != 0)
+    {
+        if ((eusci_b->IFG & 0x0020) != 0) return EUSCI_B_I2C_ERROR_NACK;
+        if (polls == 0) return EUSCI_B_I2C_ERROR_TIMEOUT;
+        polls--;
+    }
+    return EUSCI_B_I2C_OK;
+}
+
+// Releases the bus after an error. A timeout usually means that the bus is stuck,
+// so the module is also reset, which keeps its configuration but clears its state machine
+static int EUSCI_B_I2C_Abort(EUSCI_B_Type *eusci_b, int status, uint32_t polls)
+{
+    eusci_b->CTLW0 |= 0x0004;
+    EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0004, polls);
+
+    if (status == EUSCI_B_I2C_ERROR_TIMEOUT)
+    {
+        eusci_b->CTLW0 |= 0x0001;
+        eusci_b->CTLW0 &= ~0x0001;
+    }
+
+    eusci_b->IFG &= ~0x0023;
+    return status;
+}
+
+int EUSCI_B_I2C_Write(EUSCI_B_Type *eusci_b, uint8_t slave_address, const uint8_t *data_buffer,
+                      uint32_t packet_length, uint8_t generate_stop, uint32_t timeout_us)
+{
+    uint32_t polls = timeout_us * EUSCI_B_I2C_POLLS_PER_US;
+    int status;
+
+    // Wait until a pending STOP condition from the previous transfer has been sent
+    status = EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0004, polls);
+    if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+    // Clear the UCNACKIFG bit (Bit 5) left over from a previous transfer
+    eusci_b->IFG &= ~0x0020;
+
+    eusci_b->I2CSA = slave_address;
+
+    // Set the UCTR bit (Bit 4) to select master transmitter mode and the UCTXSTT bit (Bit 1)
+    // to generate a START condition, which is a repeated START if the bus is still held
+    eusci_b->CTLW0 |= 0x0012;
+
+    if (packet_length == 0)
+    {
+        // Only the address is sent, so wait until the START condition and address have been transmitted
+        status = EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0002, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+    }
+
+    for (uint32_t i = 0; i < packet_length; i++)
+    {
+        status = EUSCI_B_I2C_Wait_IFG(eusci_b, 0x0002, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+        eusci_b->TXBUF = data_buffer[i];
+    }
+
+    if (packet_length > 0)
+    {
+        // Wait until the last byte has been moved to the shift register
+        status = EUSCI_B_I2C_Wait_IFG(eusci_b, 0x0002, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+    }
+
+    if (generate_stop)
+    {
+        eusci_b->CTLW0 |= 0x0004;
+
+        status = EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0004, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+        eusci_b->IFG &= ~0x0002;
+    }
+
+    return EUSCI_B_I2C_OK;
+}
+
+int EUSCI_B_I2C_Read(EUSCI_B_Type *eusci_b, uint8_t slave_address, uint8_t *data_buffer,
+                     uint32_t packet_length, uint32_t timeout_us)
+{
+    uint32_t polls = timeout_us * EUSCI_B_I2C_POLLS_PER_US;
+    int status;
+
+    if (packet_length == 0) return EUSCI_B_I2C_OK;
+
+    eusci_b->IFG &= ~0x0020;
+
+    eusci_b->I2CSA = slave_address;
+
+    // Clear the UCTR bit (Bit 4) to select master receiver mode and set
+    // the UCTXSTT bit (Bit 1) to generate the (repeated) START condition
+    eusci_b->CTLW0 = (eusci_b->CTLW0 & ~0x0010) | 0x0002;
+
+    // For a single byte, the STOP condition must be requested as soon as the address has been sent
+    if (packet_length == 1)
+    {
+        status = EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0002, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+        eusci_b->CTLW0 |= 0x0004;
+    }
+
+    for (uint32_t i = 0; i < packet_length; i++)
+    {
+        if ((packet_length > 1) && (i == (packet_length - 1)))
+        {
+            eusci_b->CTLW0 |= 0x0004;
+        }
+
+        status = EUSCI_B_I2C_Wait_IFG(eusci_b, 0x0001, polls);
+        if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+        data_buffer[i] = eusci_b->RXBUF;
+    }
+
+    status = EUSCI_B_I2C_Wait_CTLW0_Clear(eusci_b, 0x0004, polls);
+    if (status != EUSCI_B_I2C_OK) return EUSCI_B_I2C_Abort(eusci_b, status, polls);
+
+    return EUSCI_B_I2C_OK;
+}
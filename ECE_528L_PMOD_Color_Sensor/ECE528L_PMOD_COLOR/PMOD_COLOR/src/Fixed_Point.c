@@ -0,0 +1,39 @@
+/**
+ * @file Fixed_Point.c
+ * @brief Source code for the Fixed_Point module.
+ *
+ * This file contains the function definitions for the fixed-point functions that are not inline.
+ *
+ */
+
+#include "../inc/Fixed_Point.h"
+
+uint16_t Fixed_Point_Sqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    // One bit of the root per iteration, from the highest: 16 iterations of a compare, a subtraction
+    // and shifts
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return (uint16_t)root;
+}
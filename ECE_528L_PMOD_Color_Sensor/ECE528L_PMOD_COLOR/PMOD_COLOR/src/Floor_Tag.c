@@ -0,0 +1,225 @@
+/**
+ * @file Floor_Tag.c
+ * @brief Source code for the Floor_Tag module.
+ *
+ * This file contains the function definitions for decoding color tags on the floor.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Floor_Tag.h"
+
+const Floor_Tag_Params Floor_Tag_Default_Params =
+{
+    3000,
+    2,
+    12000,
+    15000,
+    60000,
+    45000
+};
+
+const Color_Classifier_Params Floor_Tag_Classifier_Params =
+{
+    COLOR_CLASSIFIER_GREEN_MARGIN,
+    FLOOR_TAG_YELLOW_MIN_RG,
+    COLOR_CLASSIFIER_YELLOW_MAX_BLUE,
+    COLOR_CLASSIFIER_RED_MARGIN
+};
+
+static void Floor_Tag_Clear_Tag(Floor_Tag_Decoder *decoder)
+{
+    decoder->tag_length = 0;
+    decoder->tag_invalid = 0;
+    decoder->tag_done = 0;
+}
+
+static void Floor_Tag_Clear_Votes(uint32_t votes[3])
+{
+    votes[COLOR_GREEN] = 0;
+    votes[COLOR_RED] = 0;
+    votes[COLOR_YELLOW] = 0;
+}
+
+static Color_t Floor_Tag_Majority(const uint32_t votes[3])
+{
+    Color_t color = COLOR_GREEN;
+
+    if (votes[COLOR_RED] > votes[color]) color = COLOR_RED;
+    if (votes[COLOR_YELLOW] > votes[color]) color = COLOR_YELLOW;
+
+    return color;
+}
+
+// Drops the pending change; the samples of a colored change count for the current colored run
+static void Floor_Tag_Drop_Candidate(Floor_Tag_Decoder *decoder)
+{
+    if (decoder->candidate_samples == 0)
+    {
+        return;
+    }
+
+    if ((decoder->run_color != COLOR_UNKNOWN) && (decoder->candidate_color != COLOR_UNKNOWN))
+    {
+        decoder->run_votes[COLOR_GREEN] += decoder->candidate_votes[COLOR_GREEN];
+        decoder->run_votes[COLOR_RED] += decoder->candidate_votes[COLOR_RED];
+        decoder->run_votes[COLOR_YELLOW] += decoder->candidate_votes[COLOR_YELLOW];
+        decoder->run_color = Floor_Tag_Majority(decoder->run_votes);
+    }
+
+    decoder->glitches++;
+    decoder->candidate_samples = 0;
+}
+
+// Ends the current run and adds it to the tag when it is a patch
+static int Floor_Tag_End_Run(Floor_Tag_Decoder *decoder, uint32_t length_um)
+{
+    decoder->runs++;
+    decoder->last_run_um = length_um;
+
+    if (decoder->run_color == COLOR_UNKNOWN)
+    {
+        return FLOOR_TAG_NONE;
+    }
+
+    if ((length_um < decoder->params->min_patch_um) || (length_um > decoder->params->max_patch_um) ||
+        (decoder->tag_length >= FLOOR_TAG_MAX_SYMBOLS))
+    {
+        decoder->tag_invalid = 1;
+        return FLOOR_TAG_NONE;
+    }
+
+    decoder->tag[decoder->tag_length++] = decoder->run_color;
+    decoder->symbols++;
+    return FLOOR_TAG_SYMBOL;
+}
+
+void Floor_Tag_Init(Floor_Tag_Decoder *decoder, const Floor_Tag_Params *params)
+{
+    decoder->params = params;
+    decoder->samples = 0;
+    decoder->runs = 0;
+    decoder->glitches = 0;
+    decoder->symbols = 0;
+    decoder->tags = 0;
+    decoder->errors = 0;
+
+    Floor_Tag_Reset(decoder, 0);
+}
+
+void Floor_Tag_Reset(Floor_Tag_Decoder *decoder, uint32_t position_um)
+{
+    decoder->run_color = COLOR_UNKNOWN;
+    decoder->run_start_um = position_um;
+    decoder->candidate_color = COLOR_UNKNOWN;
+    decoder->candidate_start_um = position_um;
+    decoder->candidate_samples = 0;
+    decoder->last_run_um = 0;
+
+    Floor_Tag_Clear_Votes(decoder->run_votes);
+    Floor_Tag_Clear_Votes(decoder->candidate_votes);
+    Floor_Tag_Clear_Tag(decoder);
+}
+
+int Floor_Tag_Push(Floor_Tag_Decoder *decoder, Color_t color, uint32_t position_um)
+{
+    const Floor_Tag_Params *params = decoder->params;
+    int result = FLOOR_TAG_NONE;
+    uint32_t confirm_um;
+
+    if (decoder->tag_done)
+    {
+        Floor_Tag_Clear_Tag(decoder);
+    }
+
+    decoder->samples++;
+
+    if (color == decoder->run_color)
+    {
+        // The current color is back: a pending change was a glitch
+        Floor_Tag_Drop_Candidate(decoder);
+
+        if (color != COLOR_UNKNOWN)
+        {
+            decoder->run_votes[color]++;
+        }
+    }
+    else
+    {
+        // A change is either to the background or to a color; a sample of the other kind drops it
+        if ((decoder->candidate_samples > 0) &&
+            ((color == COLOR_UNKNOWN) != (decoder->candidate_color == COLOR_UNKNOWN)))
+        {
+            Floor_Tag_Drop_Candidate(decoder);
+        }
+
+        if (decoder->candidate_samples == 0)
+        {
+            decoder->candidate_color = color;
+            decoder->candidate_start_um = position_um;
+            Floor_Tag_Clear_Votes(decoder->candidate_votes);
+        }
+
+        decoder->candidate_samples++;
+
+        if (color != COLOR_UNKNOWN)
+        {
+            decoder->candidate_votes[color]++;
+        }
+
+        // A change from one color to another must last longer, so that the misreads inside a patch
+        // and the mixed colors between two touching patches do not split it
+        confirm_um = params->confirm_um;
+        if ((decoder->run_color != COLOR_UNKNOWN) && (color != COLOR_UNKNOWN))
+        {
+            confirm_um = params->color_confirm_um;
+        }
+
+        // The change has lasted long enough: the current run ended where it started
+        if ((decoder->candidate_samples >= params->confirm_samples) &&
+            ((uint32_t)(position_um - decoder->candidate_start_um) >= confirm_um))
+        {
+            result = Floor_Tag_End_Run(decoder, decoder->candidate_start_um - decoder->run_start_um);
+
+            decoder->run_color = COLOR_UNKNOWN;
+            decoder->run_start_um = decoder->candidate_start_um;
+            decoder->run_votes[COLOR_GREEN] = decoder->candidate_votes[COLOR_GREEN];
+            decoder->run_votes[COLOR_RED] = decoder->candidate_votes[COLOR_RED];
+            decoder->run_votes[COLOR_YELLOW] = decoder->candidate_votes[COLOR_YELLOW];
+            decoder->candidate_samples = 0;
+
+            if (color != COLOR_UNKNOWN)
+            {
+                decoder->run_color = Floor_Tag_Majority(decoder->run_votes);
+            }
+        }
+    }
+
+    // Enough background after the last patch ends the tag
+    if ((result == FLOOR_TAG_NONE) && (decoder->run_color == COLOR_UNKNOWN) && (decoder->candidate_samples == 0) &&
+        ((decoder->tag_length > 0) || decoder->tag_invalid) && !decoder->tag_done &&
+        ((uint32_t)(position_um - decoder->run_start_um) >= params->end_gap_um))
+    {
+        decoder->tag_done = 1;
+
+        if (decoder->tag_invalid || (decoder->tag_length == 0))
+        {
+            decoder->errors++;
+            result = FLOOR_TAG_ERROR;
+        }
+        else
+        {
+            decoder->tags++;
+            result = FLOOR_TAG_COMPLETE;
+        }
+    }
+
+    return result;
+}
+
+void Floor_Tag_Print_Stats(const Floor_Tag_Decoder *decoder)
+{
+    printf("floor tags: %lu samples, %lu runs, %lu glitches, %lu symbols, %lu tags, %lu errors\n",
+           (unsigned long)decoder->samples, (unsigned long)decoder->runs, (unsigned long)decoder->glitches,
+           (unsigned long)decoder->symbols, (unsigned long)decoder->tags, (unsigned long)decoder->errors);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file I2C_Bus.c
+ * @brief Source code for the I2C_Bus interface.
+ *
+ * This file contains the backend-independent helper functions of the I2C_Bus interface.
+ * Each helper builds a list of messages and passes it to the transfer operation of the backend.
+ *
+ */
+
+#include "../inc/I2C_Bus.h"
+
+#if I2C_BUS_TRACE
+#include "../inc/I2C_Trace.h"
+#endif
+
+int I2C_Bus_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    if ((bus == 0) || (bus->ops == 0) || (bus->ops->transfer == 0))
+    {
+        return I2C_BUS_ERROR_INVALID;
+    }
+
+    if (message_count == 0)
+    {
+        return I2C_BUS_OK;
+    }
+
+#if I2C_BUS_TRACE
+    if (bus->trace != 0)
+    {
+        return I2C_Trace_Transfer(bus->trace, bus, messages, message_count);
+    }
+#endif
+
+    return bus->ops->transfer(bus, messages, message_count);
+}
+
+int I2C_Bus_Write(I2C_Bus *bus, uint8_t address, const uint8_t *data_buffer, uint16_t packet_length)
+{
+    I2C_Bus_Message message;
+
+    message.address = address;
+    message.flags = I2C_BUS_MSG_WRITE;
+    message.length = packet_length;
+    message.buffer = (uint8_t *)data_buffer;
+
+    return I2C_Bus_Transfer(bus, &message, 1);
+}
+
+int I2C_Bus_Read(I2C_Bus *bus, uint8_t address, uint8_t *data_buffer, uint16_t packet_length)
+{
+    I2C_Bus_Message message;
+
+    message.address = address;
+    message.flags = I2C_BUS_MSG_READ;
+    message.length = packet_length;
+    message.buffer = data_buffer;
+
+    return I2C_Bus_Transfer(bus, &message, 1);
+}
+
+int I2C_Bus_Write_Read(I2C_Bus *bus, uint8_t address,
+                       const uint8_t *write_buffer, uint16_t write_length,
+                       uint8_t *read_buffer, uint16_t read_length)
+{
+    I2C_Bus_Message messages[2];
+
+    messages[0].address = address;
+    messages[0].flags = I2C_BUS_MSG_WRITE;
+    messages[0].length = write_length;
+    messages[0].buffer = (uint8_t *)write_buffer;
+
+    messages[1].address = address;
+    messages[1].flags = I2C_BUS_MSG_READ;
+    messages[1].length = read_length;
+    messages[1].buffer = read_buffer;
+
+    return I2C_Bus_Transfer(bus, messages, 2);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file I2C_Bus_EUSCI_B.c
+ * @brief Source code for the I2C_Bus_EUSCI_B backend.
+ *
+ * This file contains the function definitions for the EUSCI_B backend of the I2C_Bus interface.
+ * It runs the messages of a transfer on one of the EUSCI_B modules using the EUSCI_B_I2C driver.
+ *
+ */
+
+#include "../inc/I2C_Bus_EUSCI_B.h"
+
+static int I2C_Bus_EUSCI_B_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    EUSCI_B_Type *eusci_b = (EUSCI_B_Type *)bus->context;
+    int status = EUSCI_B_I2C_OK;
+
+    for (uint32_t i = 0; (i < message_count) && (status == EUSCI_B_I2C_OK); i++)
+    {
+        uint8_t last_message = (i == (message_count - 1));
+
+        if (messages[i].flags & I2C_BUS_MSG_READ)
+        {
+            status = EUSCI_B_I2C_Read(eusci_b, messages[i].address, messages[i].buffer,
+                                      messages[i].length, bus->timeout_us);
+        }
+        else
+        {
+            status = EUSCI_B_I2C_Write(eusci_b, messages[i].address, messages[i].buffer,
+                                       messages[i].length, last_message, bus->timeout_us);
+        }
+    }
+
+    // The EUSCI_B_I2C status codes use the same values as the I2C_Bus status codes
+    return status;
+}
+
+static const I2C_Bus_Ops I2C_Bus_EUSCI_B_Ops =
+{
+    I2C_Bus_EUSCI_B_Transfer
+};
+
+void I2C_Bus_EUSCI_B_Init(I2C_Bus *bus, EUSCI_B_Type *eusci_b, uint32_t timeout_us)
+{
+    EUSCI_B_I2C_Init(eusci_b);
+
+    bus->ops = &I2C_Bus_EUSCI_B_Ops;
+    bus->context = eusci_b;
+    bus->timeout_us = timeout_us;
+    bus->mux_address = 0;
+    bus->mux_channel = I2C_BUS_NO_MUX_CHANNEL;
+#if I2C_BUS_TRACE
+    bus->trace = 0;
+#endif
+}
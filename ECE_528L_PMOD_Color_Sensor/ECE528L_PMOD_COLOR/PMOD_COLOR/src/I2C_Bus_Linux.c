@@ -0,0 +1,151 @@
+/**
+ * @file I2C_Bus_Linux.c
+ * @brief Source code for the I2C_Bus_Linux backend.
+ *
+ * This file contains the function definitions for the Linux i2c-dev backend of the I2C_Bus interface.
+ * Transfers are passed to the kernel with the I2C_RDWR ioctl, through a function that a check can replace.
+ *
+ * @note This file is only compiled on Linux.
+ *
+ */
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "../inc/I2C_Bus_Linux.h"
+
+// Maximum number of messages accepted by one I2C_RDWR ioctl
+#ifndef I2C_RDRW_IOCTL_MAX_MSGS
+#define I2C_RDRW_IOCTL_MAX_MSGS                 42
+#endif
+
+static int I2C_Bus_Linux_Status(int error_number)
+{
+    switch (error_number)
+    {
+        // The i2c-dev adapters report a missing acknowledge with one of these codes
+        case ENXIO:
+        case EREMOTEIO:
+            return I2C_BUS_ERROR_NACK;
+
+        case ETIMEDOUT:
+            return I2C_BUS_ERROR_TIMEOUT;
+
+        default:
+            return I2C_BUS_ERROR_IO;
+    }
+}
+
+static int I2C_Bus_Linux_System_Ioctl(int fd, unsigned long request, void *argument)
+{
+    return ioctl(fd, request, argument);
+}
+
+static int I2C_Bus_Linux_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    I2C_Bus_Linux_Context *context = (I2C_Bus_Linux_Context *)bus->context;
+    struct i2c_msg linux_messages[I2C_RDRW_IOCTL_MAX_MSGS];
+    struct i2c_rdwr_ioctl_data transfer;
+
+    // A transfer is one combined transaction that ends with a single STOP condition. Splitting it
+    // into several ioctls would add STOP conditions between the messages, so it is rejected
+    if (message_count > I2C_RDRW_IOCTL_MAX_MSGS)
+    {
+        return I2C_BUS_ERROR_INVALID;
+    }
+
+    for (uint32_t i = 0; i < message_count; i++)
+    {
+        linux_messages[i].addr = messages[i].address;
+        linux_messages[i].flags = (messages[i].flags & I2C_BUS_MSG_READ) ? I2C_M_RD : 0;
+        linux_messages[i].len = messages[i].length;
+        linux_messages[i].buf = messages[i].buffer;
+    }
+
+    transfer.msgs = linux_messages;
+    transfer.nmsgs = message_count;
+
+    if (context->ioctl(context->fd, I2C_RDWR, &transfer) < 0)
+    {
+        return I2C_Bus_Linux_Status(errno);
+    }
+
+    return I2C_BUS_OK;
+}
+
+static const I2C_Bus_Ops I2C_Bus_Linux_Ops =
+{
+    I2C_Bus_Linux_Transfer
+};
+
+int I2C_Bus_Linux_Attach(I2C_Bus *bus, I2C_Bus_Linux_Context *context, int fd, uint32_t timeout_us,
+                         I2C_Bus_Linux_Ioctl ioctl_function)
+{
+    unsigned long timeout_10ms = (timeout_us + 9999) / 10000;
+
+    context->fd = fd;
+    context->ioctl = (ioctl_function != 0) ? ioctl_function : I2C_Bus_Linux_System_Ioctl;
+
+    // Let the kernel handle the timeout and do not retry on arbitration loss,
+    // so that errors are reported to the caller right away
+    if (context->ioctl(fd, I2C_TIMEOUT, (void *)timeout_10ms) < 0)
+    {
+        return I2C_BUS_ERROR_IO;
+    }
+
+    if (context->ioctl(fd, I2C_RETRIES, (void *)0UL) < 0)
+    {
+        return I2C_BUS_ERROR_IO;
+    }
+
+    bus->ops = &I2C_Bus_Linux_Ops;
+    bus->context = context;
+    bus->timeout_us = timeout_us;
+    bus->mux_address = 0;
+    bus->mux_channel = I2C_BUS_NO_MUX_CHANNEL;
+#if I2C_BUS_TRACE
+    bus->trace = 0;
+#endif
+
+    return I2C_BUS_OK;
+}
+
+int I2C_Bus_Linux_Open(I2C_Bus *bus, I2C_Bus_Linux_Context *context, const char *device, uint32_t timeout_us)
+{
+    int status;
+    int fd = open(device, O_RDWR);
+
+    if (fd < 0)
+    {
+        context->fd = -1;
+        return I2C_BUS_ERROR_IO;
+    }
+
+    status = I2C_Bus_Linux_Attach(bus, context, fd, timeout_us, 0);
+    if (status != I2C_BUS_OK)
+    {
+        close(fd);
+        context->fd = -1;
+        return status;
+    }
+
+    return I2C_BUS_OK;
+}
+
+void I2C_Bus_Linux_Close(I2C_Bus *bus)
+{
+    I2C_Bus_Linux_Context *context = (I2C_Bus_Linux_Context *)bus->context;
+
+    if (context->fd >= 0)
+    {
+        close(context->fd);
+        context->fd = -1;
+    }
+}
+
+#endif /* __linux__ */
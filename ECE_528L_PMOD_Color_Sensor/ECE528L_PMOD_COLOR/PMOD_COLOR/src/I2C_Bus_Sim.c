@@ -0,0 +1,244 @@
+/**
+ * @file I2C_Bus_Sim.c
+ * @brief Source code for the I2C_Bus_Sim backend.
+ *
+ * This file contains the function definitions for an in-process simulated I2C bus
+ * with TCS34725 color sensors and an optional TCA9548A multiplexer.
+ *
+ */
+
+#include "../inc/I2C_Bus_Sim.h"
+
+// TCS34725 register and bit definitions used by the simulation
+#define SIM_ENABLE_REG                          0x00
+#define SIM_ID_REG                              0x12
+#define SIM_STATUS_REG                          0x13
+#define SIM_CDATA_L_REG                         0x14
+#define SIM_ENABLE_PON_AEN                      0x03
+#define SIM_STATUS_AVALID                       0x01
+#define SIM_STATUS_AINT                         0x10
+#define SIM_CMD_BIT                             0x80
+#define SIM_CMD_TYPE_AUTO_INC                   0x01
+#define SIM_CMD_TYPE_SPECIAL                    0x03
+#define SIM_SPECIAL_CLEAR_INT                   0x06
+
+static void I2C_Bus_Sim_Store_Word(uint8_t *registers, uint8_t register_address, uint16_t value)
+{
+    registers[register_address] = (uint8_t)(value & 0xFF);
+    registers[register_address + 1] = (uint8_t)(value >> 8);
+}
+
+// Advances the conversion counters of all powered-on sensors by one bus transfer
+static void I2C_Bus_Sim_Tick(I2C_Bus_Sim_Context *context)
+{
+    for (uint8_t i = 0; i < context->device_count; i++)
+    {
+        I2C_Bus_Sim_Device *device = &context->devices[i];
+
+        if ((device->registers[SIM_ENABLE_REG] & SIM_ENABLE_PON_AEN) != SIM_ENABLE_PON_AEN) continue;
+
+        if (--device->transfers_until_conversion == 0)
+        {
+            device->transfers_until_conversion = device->transfers_per_conversion;
+            device->conversion_count++;
+
+            I2C_Bus_Sim_Store_Word(device->registers, SIM_CDATA_L_REG, device->clear);
+            I2C_Bus_Sim_Store_Word(device->registers, SIM_CDATA_L_REG + 2, device->red);
+            I2C_Bus_Sim_Store_Word(device->registers, SIM_CDATA_L_REG + 4, device->green);
+            I2C_Bus_Sim_Store_Word(device->registers, SIM_CDATA_L_REG + 6, device->blue);
+
+            device->registers[SIM_STATUS_REG] |= SIM_STATUS_AVALID | SIM_STATUS_AINT;
+        }
+    }
+}
+
+// Returns the sensor that answers to the address with the current multiplexer setting.
+// More than one answering sensor is a bus collision, which is reported with collision = 1
+static I2C_Bus_Sim_Device *I2C_Bus_Sim_Find(I2C_Bus_Sim_Context *context, uint8_t address, uint8_t *collision)
+{
+    I2C_Bus_Sim_Device *found = 0;
+
+    *collision = 0;
+
+    for (uint8_t i = 0; i < context->device_count; i++)
+    {
+        I2C_Bus_Sim_Device *device = &context->devices[i];
+        uint8_t connected = (device->mux_channel == I2C_BUS_NO_MUX_CHANNEL) ||
+                            (context->mux_present && (context->mux_control & (1 << device->mux_channel)));
+
+        if ((device->address != address) || !connected) continue;
+
+        if (found != 0)
+        {
+            *collision = 1;
+        }
+        found = device;
+    }
+
+    return found;
+}
+
+static void I2C_Bus_Sim_Device_Write(I2C_Bus_Sim_Device *device, const uint8_t *data, uint16_t length)
+{
+    if (length == 0) return;
+
+    // The first byte of a write is the command byte
+    if (data[0] & SIM_CMD_BIT)
+    {
+        uint8_t type = (data[0] >> 5) & 0x03;
+
+        if (type == SIM_CMD_TYPE_SPECIAL)
+        {
+            if ((data[0] & 0x1F) == SIM_SPECIAL_CLEAR_INT)
+            {
+                device->registers[SIM_STATUS_REG] &= ~SIM_STATUS_AINT;
+            }
+            return;
+        }
+
+        device->register_pointer = data[0] & 0x1F;
+        device->auto_increment = (type == SIM_CMD_TYPE_AUTO_INC);
+    }
+
+    for (uint16_t i = 1; i < length; i++)
+    {
+        uint8_t register_address = device->register_pointer;
+
+        // The ID, STATUS and data registers are read-only
+        if (register_address < SIM_ID_REG)
+        {
+            device->registers[register_address] = data[i];
+        }
+
+        if (device->auto_increment)
+        {
+            device->register_pointer = (device->register_pointer + 1) & 0x1F;
+        }
+    }
+}
+
+static void I2C_Bus_Sim_Device_Read(I2C_Bus_Sim_Device *device, uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        data[i] = device->registers[device->register_pointer];
+
+        if (device->auto_increment)
+        {
+            device->register_pointer = (device->register_pointer + 1) & 0x1F;
+        }
+    }
+}
+
+static int I2C_Bus_Sim_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    I2C_Bus_Sim_Context *context = (I2C_Bus_Sim_Context *)bus->context;
+
+    context->transfer_count++;
+    I2C_Bus_Sim_Tick(context);
+
+    for (uint32_t i = 0; i < message_count; i++)
+    {
+        I2C_Bus_Message *message = &messages[i];
+        uint8_t is_read = (message->flags & I2C_BUS_MSG_READ) != 0;
+        I2C_Bus_Sim_Device *device;
+        uint8_t collision;
+
+        context->message_count++;
+
+        if (context->mux_present && (message->address == context->mux_address))
+        {
+            if (is_read)
+            {
+                for (uint16_t j = 0; j < message->length; j++) message->buffer[j] = context->mux_control;
+            }
+            else if (message->length > 0)
+            {
+                context->mux_control = message->buffer[message->length - 1];
+            }
+
+            context->byte_count += message->length;
+            continue;
+        }
+
+        device = I2C_Bus_Sim_Find(context, message->address, &collision);
+
+        if (device == 0)
+        {
+            context->nack_count++;
+            return I2C_BUS_ERROR_NACK;
+        }
+
+        if (collision)
+        {
+            context->collision_count++;
+            return I2C_BUS_ERROR_IO;
+        }
+
+        if (is_read)
+        {
+            I2C_Bus_Sim_Device_Read(device, message->buffer, message->length);
+        }
+        else
+        {
+            I2C_Bus_Sim_Device_Write(device, message->buffer, message->length);
+        }
+
+        context->byte_count += message->length;
+    }
+
+    return I2C_BUS_OK;
+}
+
+static const I2C_Bus_Ops I2C_Bus_Sim_Ops =
+{
+    I2C_Bus_Sim_Transfer
+};
+
+void I2C_Bus_Sim_Init(I2C_Bus *bus, I2C_Bus_Sim_Context *context)
+{
+    uint8_t *raw = (uint8_t *)context;
+
+    for (uint32_t i = 0; i < sizeof(I2C_Bus_Sim_Context); i++) raw[i] = 0;
+
+    bus->ops = &I2C_Bus_Sim_Ops;
+    bus->context = context;
+    bus->timeout_us = I2C_BUS_DEFAULT_TIMEOUT_US;
+    bus->mux_address = 0;
+    bus->mux_channel = I2C_BUS_NO_MUX_CHANNEL;
+#if I2C_BUS_TRACE
+    bus->trace = 0;
+#endif
+}
+
+void I2C_Bus_Sim_Add_TCA9548A(I2C_Bus_Sim_Context *context, uint8_t address)
+{
+    context->mux_present = 1;
+    context->mux_address = address;
+    context->mux_control = 0;
+}
+
+I2C_Bus_Sim_Device *I2C_Bus_Sim_Add_TCS34725(I2C_Bus_Sim_Context *context, uint8_t address,
+                                             uint8_t mux_channel, uint32_t transfers_per_conversion)
+{
+    I2C_Bus_Sim_Device *device;
+
+    if (context->device_count >= I2C_BUS_SIM_MAX_DEVICES) return 0;
+
+    device = &context->devices[context->device_count++];
+    device->address = address;
+    device->mux_channel = mux_channel;
+    device->registers[SIM_ID_REG] = I2C_BUS_SIM_TCS34725_ID;
+    device->transfers_per_conversion = (transfers_per_conversion == 0) ? 1 : transfers_per_conversion;
+    device->transfers_until_conversion = device->transfers_per_conversion;
+
+    return device;
+}
+
+void I2C_Bus_Sim_Set_RGBC(I2C_Bus_Sim_Device *device, uint16_t clear, uint16_t red, uint16_t green, uint16_t blue)
+{
+    device->clear = clear;
+    device->red = red;
+    device->green = green;
+    device->blue = blue;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file I2C_Trace.c
+ * @brief Source code for the I2C_Trace module.
+ *
+ * This file contains the function definitions for the I2C transfer records and statistics.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/I2C_Trace.h"
+
+void I2C_Trace_Init(I2C_Trace *trace, I2C_Trace_Clock clock, void *clock_context, uint32_t ticks_per_us,
+                    I2C_Trace_Write write, void *write_context)
+{
+    trace->clock = clock;
+    trace->clock_context = clock_context;
+    trace->ticks_per_us = (ticks_per_us > 0) ? ticks_per_us : 1;
+    trace->now = 0;
+    trace->last_clock = clock(clock_context);
+    trace->head = 0;
+    trace->tail = 0;
+    trace->dropped = 0;
+    trace->reported = 0;
+    trace->write = write;
+    trace->write_context = write_context;
+    trace->frames = 0;
+    trace->sent = 0;
+    trace->transfers = 0;
+    trace->bytes = 0;
+    trace->busy_ticks = 0;
+    trace->max_ticks = 0;
+    trace->operation_count = 0;
+
+    for (int i = 0; i < I2C_TRACE_ERROR_KINDS; i++)
+    {
+        trace->errors[i] = 0;
+    }
+
+    // The limits of the buckets in ticks, so that a transfer is classified without a division
+    for (int i = 0; i < I2C_TRACE_BUCKETS; i++)
+    {
+        trace->buckets[i] = 0;
+
+        if (i < (I2C_TRACE_BUCKETS - 1))
+        {
+            trace->bucket_ticks[i] = trace->ticks_per_us * ((uint32_t)I2C_TRACE_BUCKET_MIN_US << i);
+        }
+    }
+}
+
+#if I2C_BUS_TRACE
+void I2C_Trace_Attach(I2C_Trace *trace, I2C_Bus *bus)
+{
+    bus->trace = trace;
+}
+#endif
+
+static void I2C_Trace_Count(I2C_Trace *trace, const I2C_Trace_Record *record, uint8_t kind)
+{
+    uint32_t bytes = (uint32_t)record->write_length + record->read_length;
+    int bucket = 0;
+
+    trace->transfers++;
+    trace->bytes += bytes;
+    trace->busy_ticks += record->ticks;
+
+    if (record->ticks > trace->max_ticks)
+    {
+        trace->max_ticks = record->ticks;
+    }
+
+    if ((record->status < 0) && (record->status >= -I2C_TRACE_ERROR_KINDS))
+    {
+        trace->errors[-record->status - 1]++;
+    }
+
+    while ((bucket < (I2C_TRACE_BUCKETS - 1)) && (record->ticks >= trace->bucket_ticks[bucket]))
+    {
+        bucket++;
+    }
+
+    trace->buckets[bucket]++;
+
+    // Find the operation, or add it while there is room
+    int i = 0;
+
+    while ((i < trace->operation_count) &&
+           ((trace->operations[i].address != record->address) || (trace->operations[i].kind != kind)))
+    {
+        i++;
+    }
+
+    if (i == trace->operation_count)
+    {
+        if (i == I2C_TRACE_MAX_OPERATIONS)
+        {
+            return;
+        }
+
+        trace->operations[i].address = record->address;
+        trace->operations[i].kind = kind;
+        trace->operations[i].count = 0;
+        trace->operations[i].errors = 0;
+        trace->operations[i].bytes = 0;
+        trace->operations[i].ticks = 0;
+        trace->operations[i].max_ticks = 0;
+        trace->operation_count++;
+    }
+
+    I2C_Trace_Operation *operation = &trace->operations[i];
+
+    operation->count++;
+    operation->bytes += bytes;
+    operation->ticks += record->ticks;
+
+    if (record->status != I2C_BUS_OK)
+    {
+        operation->errors++;
+    }
+
+    if (record->ticks > operation->max_ticks)
+    {
+        operation->max_ticks = record->ticks;
+    }
+}
+
+int I2C_Trace_Transfer(I2C_Trace *trace, I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    uint32_t start = trace->clock(trace->clock_context);
+    int status = bus->ops->transfer(bus, messages, message_count);
+    uint32_t end = trace->clock(trace->clock_context);
+
+    I2C_Trace_Record record;
+    uint8_t kind = 0;
+
+    // Extend the clock to 64 bits; it must be read at least once per wrap, which a transfer every
+    // 89 s does at 48 MHz
+    trace->now += start - trace->last_clock;
+    record.start = trace->now;
+    record.ticks = end - start;
+    trace->now += record.ticks;
+    trace->last_clock = end;
+
+    record.address = messages[0].address;
+    record.status = (int8_t)status;
+    record.write_length = 0;
+    record.read_length = 0;
+
+    for (uint32_t i = 0; i < message_count; i++)
+    {
+        if (messages[i].flags & I2C_BUS_MSG_READ)
+        {
+            record.read_length += messages[i].length;
+            kind |= I2C_TRACE_KIND_READ;
+        }
+        else
+        {
+            record.write_length += messages[i].length;
+            kind |= I2C_TRACE_KIND_WRITE;
+        }
+    }
+
+    I2C_Trace_Count(trace, &record, kind);
+
+    if ((trace->head - trace->tail) >= I2C_TRACE_BUFFER_SIZE)
+    {
+        trace->dropped++;
+    }
+    else
+    {
+        trace->records[trace->head & (I2C_TRACE_BUFFER_SIZE - 1)] = record;
+        trace->head++;
+    }
+
+    return status;
+}
+
+uint32_t I2C_Trace_Flush(I2C_Trace *trace, uint32_t max_frames)
+{
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+    uint32_t frames = 0;
+
+    while ((frames < max_frames) && ((trace->head != trace->tail) || (trace->dropped != trace->reported)))
+    {
+        Board_Protocol_I2C_Trace body;
+        uint32_t dropped = trace->dropped - trace->reported;
+
+        body.dropped = (dropped > 0xFFFF) ? 0xFFFF : (uint16_t)dropped;
+        body.count = 0;
+
+        while ((body.count < BOARD_PROTOCOL_I2C_TRACE_MAX) && (trace->tail != trace->head))
+        {
+            const I2C_Trace_Record *record = &trace->records[trace->tail & (I2C_TRACE_BUFFER_SIZE - 1)];
+            uint32_t duration_us = record->ticks / trace->ticks_per_us;
+            Board_Protocol_I2C_Transfer *transfer = &body.transfers[body.count];
+
+            transfer->start_us = (uint32_t)(record->start / trace->ticks_per_us);
+            transfer->duration_us = (duration_us > 0xFFFF) ? 0xFFFF : (uint16_t)duration_us;
+            transfer->address = record->address;
+            transfer->status = record->status;
+            transfer->write_length = (record->write_length > 0xFF) ? 0xFF : (uint8_t)record->write_length;
+            transfer->read_length = (record->read_length > 0xFF) ? 0xFF : (uint8_t)record->read_length;
+
+            body.count++;
+            trace->tail++;
+        }
+
+        int length = Board_Protocol_Encode_I2C_Trace(Board_Protocol_Next_Sequence(), &body, frame, sizeof(frame));
+
+        if (length <= 0)
+        {
+            break;
+        }
+
+        trace->write(trace->write_context, frame, (uint16_t)length);
+        trace->reported += body.dropped;
+        trace->frames++;
+        trace->sent += body.count;
+        frames++;
+    }
+
+    return frames;
+}
+
+uint32_t I2C_Trace_Pending(const I2C_Trace *trace)
+{
+    return trace->head - trace->tail;
+}
+
+uint32_t I2C_Trace_Utilization(const I2C_Trace *trace)
+{
+    uint64_t elapsed = trace->now + (uint32_t)(trace->clock(trace->clock_context) - trace->last_clock);
+
+    if (elapsed == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(trace->busy_ticks * 10000 / elapsed);
+}
+
+void I2C_Trace_Print_Stats(const I2C_Trace *trace)
+{
+    uint32_t utilization = I2C_Trace_Utilization(trace);
+    uint32_t mean_us = 0;
+
+    if (trace->transfers > 0)
+    {
+        mean_us = (uint32_t)(trace->busy_ticks / trace->transfers / trace->ticks_per_us);
+    }
+
+    printf("i2c trace: %lu transfers, %lu bytes, %lu.%02lu%% bus utilization, mean %lu us, max %lu us\n",
+           (unsigned long)trace->transfers, (unsigned long)trace->bytes,
+           (unsigned long)(utilization / 100), (unsigned long)(utilization % 100),
+           (unsigned long)mean_us, (unsigned long)(trace->max_ticks / trace->ticks_per_us));
+    printf("i2c trace: errors %lu nack, %lu timeout, %lu io, %lu invalid; %lu records sent in %lu frames, %lu dropped\n",
+           (unsigned long)trace->errors[0], (unsigned long)trace->errors[1], (unsigned long)trace->errors[2],
+           (unsigned long)trace->errors[3], (unsigned long)trace->sent, (unsigned long)trace->frames,
+           (unsigned long)trace->dropped);
+
+    printf("i2c trace: durations");
+
+    for (int i = 0; i < I2C_TRACE_BUCKETS; i++)
+    {
+        if (i < (I2C_TRACE_BUCKETS - 1))
+        {
+            printf(" <%lu us %lu", (unsigned long)((uint32_t)I2C_TRACE_BUCKET_MIN_US << i), (unsigned long)trace->buckets[i]);
+        }
+        else
+        {
+            printf(", longer %lu\n", (unsigned long)trace->buckets[i]);
+        }
+
+        if (i < (I2C_TRACE_BUCKETS - 2))
+        {
+            printf(",");
+        }
+    }
+
+    for (int i = 0; i < trace->operation_count; i++)
+    {
+        const I2C_Trace_Operation *operation = &trace->operations[i];
+        static const char *const kinds[] = { "", "write", "read", "write-read" };
+
+        printf("i2c trace: 0x%02X %s: %lu transfers, %lu bytes, %lu us, max %lu us, %lu errors\n",
+               operation->address, kinds[operation->kind], (unsigned long)operation->count, (unsigned long)operation->bytes,
+               (unsigned long)(operation->ticks / trace->ticks_per_us),
+               (unsigned long)(operation->max_ticks / trace->ticks_per_us), (unsigned long)operation->errors);
+    }
+}
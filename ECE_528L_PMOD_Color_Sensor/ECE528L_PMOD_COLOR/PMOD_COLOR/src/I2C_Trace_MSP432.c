@@ -0,0 +1,31 @@
+/**
+ * @file I2C_Trace_MSP432.c
+ * @brief Source code for the I2C_Trace_MSP432 backend.
+ *
+ * This file contains the function definitions for the DWT and EUSCI_A0 backend of the I2C trace.
+ *
+ */
+
+#include "../inc/I2C_Trace_MSP432.h"
+#include "../inc/EUSCI_A0_UART.h"
+
+#if I2C_BUS_TRACE
+
+static uint32_t I2C_Trace_MSP432_Clock(void *context)
+{
+    (void)context;
+
+    return DWT->CYCCNT;
+}
+
+void I2C_Trace_MSP432_Init(I2C_Trace *trace, I2C_Bus *bus)
+{
+    // Start the cycle counter of the timestamps
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    I2C_Trace_Init(trace, I2C_Trace_MSP432_Clock, 0, I2C_TRACE_MSP432_TICKS_PER_US, EUSCI_A0_UART_Write_Frame, 0);
+    I2C_Trace_Attach(trace, bus);
+}
+
+#endif
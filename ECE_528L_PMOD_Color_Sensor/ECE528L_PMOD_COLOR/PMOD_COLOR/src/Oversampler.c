@@ -0,0 +1,130 @@
+/**
+ * @file Oversampler.c
+ * @brief Source code for the Oversampler module.
+ *
+ * This file contains the function definitions for the accumulate-and-dump oversampling filter.
+ *
+ */
+
+#include "../inc/Oversampler.h"
+
+// Scales a window sum to the output resolution: (sum << extra_bits) / decimation, rounded to nearest
+// with both the shift and the division. The sum of at most 65535 samples of 16 bits fits in 32 bits,
+// but the shifted or rounded sum may not
+static uint32_t Oversampler_Scale(const Oversampler *oversampler, uint32_t sum)
+{
+    int32_t shift = oversampler->shift;
+
+    if (shift >= 0)
+    {
+        shift -= oversampler->extra_bits;
+
+        if (shift > 0)
+        {
+            return (uint32_t)(((uint64_t)sum + (1u << (shift - 1))) >> shift);
+        }
+
+        return sum << -shift;
+    }
+
+    return (uint32_t)((((uint64_t)sum << oversampler->extra_bits) + (oversampler->decimation / 2)) / oversampler->decimation);
+}
+
+int Oversampler_Init(Oversampler *oversampler, uint16_t decimation, uint8_t extra_bits)
+{
+    if ((decimation == 0) || (extra_bits > OVERSAMPLER_MAX_EXTRA_BITS))
+    {
+        return -1;
+    }
+
+    oversampler->decimation = decimation;
+    oversampler->extra_bits = extra_bits;
+    oversampler->shift = -1;
+
+    // Powers of two are scaled with a shift
+    if ((decimation & (decimation - 1)) == 0)
+    {
+        int8_t shift = 0;
+        while ((1u << shift) < decimation) shift++;
+        oversampler->shift = shift;
+    }
+
+    oversampler->input_count = 0;
+    oversampler->output_count = 0;
+    Oversampler_Reset(oversampler);
+
+    return 0;
+}
+
+void Oversampler_Reset(Oversampler *oversampler)
+{
+    oversampler->sum[0] = 0;
+    oversampler->sum[1] = 0;
+    oversampler->sum[2] = 0;
+    oversampler->sum[3] = 0;
+    oversampler->count = 0;
+}
+
+uint8_t Oversampler_Add(Oversampler *oversampler, PMOD_Color_Data sample, Oversampler_Data *output)
+{
+    oversampler->sum[0] += sample.red;
+    oversampler->sum[1] += sample.green;
+    oversampler->sum[2] += sample.blue;
+    oversampler->sum[3] += sample.clear;
+    oversampler->input_count++;
+
+    if (++oversampler->count < oversampler->decimation)
+    {
+        return 0;
+    }
+
+    // Dump the window
+    output->red = Oversampler_Scale(oversampler, oversampler->sum[0]);
+    output->green = Oversampler_Scale(oversampler, oversampler->sum[1]);
+    output->blue = Oversampler_Scale(oversampler, oversampler->sum[2]);
+    output->clear = Oversampler_Scale(oversampler, oversampler->sum[3]);
+    oversampler->output_count++;
+
+    Oversampler_Reset(oversampler);
+
+    return 1;
+}
+
+uint8_t Oversampler_Get_Output_Bits(const Oversampler *oversampler)
+{
+    return 16 + oversampler->extra_bits;
+}
+
+uint32_t Oversampler_Get_Output_Period_us(const Oversampler *oversampler, uint32_t sample_period_us)
+{
+    return sample_period_us * oversampler->decimation;
+}
+
+uint16_t Oversampler_Flicker_Decimation(uint32_t sample_period_us, uint16_t flicker_hz,
+                                        uint16_t min_decimation, uint16_t max_decimation, uint32_t tolerance_us)
+{
+    if ((sample_period_us == 0) || (flicker_hz == 0))
+    {
+        return 0;
+    }
+
+    if (min_decimation == 0)
+    {
+        min_decimation = 1;
+    }
+
+    for (uint32_t k = min_decimation; k <= max_decimation; k++)
+    {
+        // The window measured in flicker periods is k * sample_period_us * flicker_hz / 1000000,
+        // so the remainder below is the window error in units of 1 / (1000000 * flicker_hz) s
+        uint64_t remainder = ((uint64_t)k * sample_period_us * flicker_hz) % 1000000;
+        uint64_t error = (remainder < 500000) ? remainder : (1000000 - remainder);
+
+        if (error <= (uint64_t)tolerance_us * flicker_hz)
+        {
+            return (uint16_t)k;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file PC_Sampler.c
+ * @brief Source code for the PC_Sampler module.
+ *
+ * This file contains the function definitions for the ring buffer of the statistical profiler.
+ *
+ */
+
+#include "../inc/PC_Sampler.h"
+
+#if PC_SAMPLER_LR
+#define PC_SAMPLER_FRAME_SAMPLES                BOARD_PROTOCOL_PC_SAMPLES_MAX_LR
+#else
+#define PC_SAMPLER_FRAME_SAMPLES                BOARD_PROTOCOL_PC_SAMPLES_MAX
+#endif
+
+void PC_Sampler_Init(PC_Sampler *sampler, PC_Sampler_Write write, void *context)
+{
+    sampler->head = 0;
+    sampler->tail = 0;
+    sampler->dropped = 0;
+    sampler->reported = 0;
+    sampler->write = write;
+    sampler->write_context = context;
+    sampler->frames = 0;
+    sampler->sent = 0;
+}
+
+uint32_t PC_Sampler_Flush(PC_Sampler *sampler, uint32_t max_frames)
+{
+    Board_Protocol_PC_Samples samples;
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+    uint32_t frames = 0;
+
+    samples.has_lr = PC_SAMPLER_LR;
+
+    while (frames < max_frames)
+    {
+        uint32_t tail = sampler->tail;
+        uint32_t available = sampler->head - tail;
+
+        // Samples dropped since the last frame; the frame reports them before its own samples
+        uint32_t dropped = sampler->dropped - sampler->reported;
+
+        if ((available == 0) && (dropped == 0))
+        {
+            break;
+        }
+
+        if (dropped > UINT16_MAX)
+        {
+            dropped = UINT16_MAX;
+        }
+
+        samples.count = (available < PC_SAMPLER_FRAME_SAMPLES) ? (uint8_t)available : PC_SAMPLER_FRAME_SAMPLES;
+        samples.dropped = (uint16_t)dropped;
+
+        for (uint8_t i = 0; i < samples.count; i++)
+        {
+            samples.pc[i] = sampler->pc[(tail + i) & (PC_SAMPLER_BUFFER_SIZE - 1)];
+#if PC_SAMPLER_LR
+            samples.lr[i] = sampler->lr[(tail + i) & (PC_SAMPLER_BUFFER_SIZE - 1)];
+#endif
+        }
+
+        int length = Board_Protocol_Encode_PC_Samples(Board_Protocol_Next_Sequence(), &samples, frame, sizeof(frame));
+
+        if (length > 0)
+        {
+            sampler->write(sampler->write_context, frame, (uint16_t)length);
+        }
+
+        // The slots are released once they have been copied
+        sampler->tail = tail + samples.count;
+        sampler->reported += dropped;
+        sampler->sent += samples.count;
+        sampler->frames++;
+        frames++;
+    }
+
+    return frames;
+}
+
+uint32_t PC_Sampler_Pending(const PC_Sampler *sampler)
+{
+    return sampler->head - sampler->tail;
+}
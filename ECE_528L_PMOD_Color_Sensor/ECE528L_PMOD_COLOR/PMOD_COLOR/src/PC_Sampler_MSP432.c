@@ -0,0 +1,150 @@
+/**
+ * @file PC_Sampler_MSP432.c
+ * @brief Source code for the PC_Sampler_MSP432 backend.
+ *
+ * This file contains the function definitions for the Timer_A2 backend of the statistical profiler.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/PC_Sampler_MSP432.h"
+#include "../inc/EUSCI_A0_UART.h"
+
+// Timer_A CTL and CCTL register bits
+#define TIMER_A_SSEL_SMCLK                      0x0200
+#define TIMER_A_MC_UP                           0x0010
+#define TIMER_A_CLR                             0x0004
+#define TIMER_A_CCIE                            0x0010
+#define TIMER_A_CCIFG                           0x0001
+
+// Timer_A2 clock
+#define PC_SAMPLER_MSP432_CLOCK_HZ              12000000
+
+// Cycles of the exception entry and return, which the handler cannot time itself
+#define PC_SAMPLER_MSP432_EXCEPTION_CYCLES      24
+
+// Sampler served by TA2_0_IRQHandler, and the nominal sampling period in timer counts
+static PC_Sampler *PC_Sampler_MSP432_Sampler = 0;
+static uint32_t PC_Sampler_MSP432_Period = 0;
+static uint32_t PC_Sampler_MSP432_Rate_Hz = 0;
+
+// State of the xorshift generator that varies the periods
+static uint32_t PC_Sampler_MSP432_Random = 0x2545F491;
+
+// Samples taken, and the cycles of the handler
+static volatile uint32_t PC_Sampler_MSP432_Samples = 0;
+static volatile uint32_t PC_Sampler_MSP432_Max_Cycles = 0;
+static volatile uint64_t PC_Sampler_MSP432_Sum_Cycles = 0;
+
+// Called by TA2_0_IRQHandler (see PC_Sampler_MSP432_IRQ.asm) with the exception frame
+void PC_Sampler_MSP432_Handler(uint32_t *frame);
+
+void PC_Sampler_MSP432_Init(PC_Sampler *sampler, uint32_t rate_hz, uint32_t priority)
+{
+    if (rate_hz < 200) rate_hz = 200;
+    if (rate_hz > 20000) rate_hz = 20000;
+
+    PC_Sampler_Init(sampler, EUSCI_A0_UART_Write_Frame, 0);
+
+    // Start the cycle counter that times the handler
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    PC_Sampler_MSP432_Sampler = sampler;
+    PC_Sampler_MSP432_Rate_Hz = rate_hz;
+    PC_Sampler_MSP432_Period = PC_SAMPLER_MSP432_CLOCK_HZ / rate_hz;
+    PC_Sampler_MSP432_Samples = 0;
+    PC_Sampler_MSP432_Max_Cycles = 0;
+    PC_Sampler_MSP432_Sum_Cycles = 0;
+
+    // Count SMCLK in up mode to CCR[0], which ends each period with the TA2_0 interrupt
+    TIMER_A2->CTL = TIMER_A_CLR;
+    TIMER_A2->EX0 = 0;
+    TIMER_A2->CCR[0] = (uint16_t)(PC_Sampler_MSP432_Period - 1);
+    TIMER_A2->CCTL[0] = TIMER_A_CCIE;
+    TIMER_A2->CTL = TIMER_A_SSEL_SMCLK | TIMER_A_MC_UP | TIMER_A_CLR;
+
+    NVIC_SetPriority(TA2_0_IRQn, priority);
+    NVIC_EnableIRQ(TA2_0_IRQn);
+}
+
+void PC_Sampler_MSP432_Stop(void)
+{
+    TIMER_A2->CTL = 0;
+    TIMER_A2->CCTL[0] = 0;
+    NVIC_DisableIRQ(TA2_0_IRQn);
+}
+
+void PC_Sampler_MSP432_Print_Stats(const PC_Sampler *sampler)
+{
+    uint32_t samples;
+    uint32_t max_cycles;
+    uint64_t sum_cycles;
+    uint32_t mean_cycles = 0;
+
+    // The handler has priority 0 by default, which no critical section masks, and it may update the
+    // statistics between the reads (the 64-bit sum in two halves); read again until no sample came in
+    do
+    {
+        samples = PC_Sampler_MSP432_Samples;
+        max_cycles = PC_Sampler_MSP432_Max_Cycles;
+        sum_cycles = PC_Sampler_MSP432_Sum_Cycles;
+    } while (samples != PC_Sampler_MSP432_Samples);
+
+    if (samples > 0)
+    {
+        mean_cycles = (uint32_t)(sum_cycles / samples);
+    }
+
+    // Share of the processor in hundredths of a percent, with the exception entry and return, at 48 MHz
+    uint32_t overhead = (uint32_t)((uint64_t)(mean_cycles + PC_SAMPLER_MSP432_EXCEPTION_CYCLES) * PC_Sampler_MSP432_Rate_Hz / 4800);
+
+    printf("pc sampler: %lu Hz, %lu samples, %lu sent in %lu frames, %lu dropped\n",
+           (unsigned long)PC_Sampler_MSP432_Rate_Hz, (unsigned long)samples,
+           (unsigned long)sampler->sent, (unsigned long)sampler->frames, (unsigned long)sampler->dropped);
+    printf("pc sampler: handler mean %lu, max %lu cycles, overhead %lu.%02lu%%\n",
+           (unsigned long)mean_cycles, (unsigned long)max_cycles,
+           (unsigned long)(overhead / 100), (unsigned long)(overhead % 100));
+}
+
+/**
+ * @brief Adds the stacked PC and LR of the interrupted code to the buffer.
+ *
+ * The basic exception frame is R0, R1, R2, R3, R12, LR, PC and xPSR, so the stacked LR and PC are its
+ * words 5 and 6. The next period is varied by up to 1/16 either way: in up mode, the new
+ * CCR[0] applies to the period that has just started.
+ *
+ * @param frame The exception frame.
+ *
+ * @return None
+ */
+void PC_Sampler_MSP432_Handler(uint32_t *frame)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t random = PC_Sampler_MSP432_Random;
+
+    TIMER_A2->CCTL[0] &= ~TIMER_A_CCIFG;
+
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    PC_Sampler_MSP432_Random = random;
+
+    TIMER_A2->CCR[0] = (uint16_t)(PC_Sampler_MSP432_Period - (PC_Sampler_MSP432_Period >> 4) - 1 +
+                                  (random % ((PC_Sampler_MSP432_Period >> 3) + 1)));
+
+    if (PC_Sampler_MSP432_Sampler != 0)
+    {
+        PC_Sampler_Push(PC_Sampler_MSP432_Sampler, frame[6], frame[5]);
+    }
+
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    PC_Sampler_MSP432_Samples++;
+    PC_Sampler_MSP432_Sum_Cycles += cycles;
+
+    if (cycles > PC_Sampler_MSP432_Max_Cycles)
+    {
+        PC_Sampler_MSP432_Max_Cycles = cycles;
+    }
+}
@@ -0,0 +1,28 @@
+;
+; @file PC_Sampler_MSP432_IRQ.asm
+; @brief Interrupt service routine of the PC_Sampler_MSP432 backend.
+;
+; TA2_0_IRQHandler passes the exception frame of the interrupted code to PC_Sampler_MSP432_Handler in
+; R0. It is written in assembly so that nothing runs before it reads LR and the stack pointer: in C, the
+; prologue that the compiler adds at some optimization levels would push registers first and move the
+; stack away from the frame. Bit 2 of EXC_RETURN, in LR on entry, tells whether the interrupted code
+; used the MSP or the PSP. The branch keeps EXC_RETURN in LR, so the handler returns from the exception
+; directly.
+;
+
+        .thumb
+        .text
+
+        .global TA2_0_IRQHandler
+        .global PC_Sampler_MSP432_Handler
+
+        .thumbfunc TA2_0_IRQHandler
+TA2_0_IRQHandler:   .asmfunc
+        TST     LR, #4
+        ITE     EQ
+        MRSEQ   R0, MSP
+        MRSNE   R0, PSP
+        B       PC_Sampler_MSP432_Handler
+        .endasmfunc
+
+        .end
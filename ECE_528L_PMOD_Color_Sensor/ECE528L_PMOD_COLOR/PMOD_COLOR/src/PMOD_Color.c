@@ -28,28 +28,45 @@
  */
 
 #include "../inc/PMOD_Color.h"
+#include "../inc/Fixed_Point.h"
 
-void PMOD_Color_Write_Register(uint8_t register_address, uint8_t register_data)
+#if defined(__MSP432P401R__)
+#define PMOD_Color_Delay_us(n)                  Clock_Delay1us(n)
+#else
+#include <unistd.h>
+#define PMOD_Color_Delay_us(n)                  usleep(n)
+#endif
+
+#if defined(__MSP432P401R__)
+
+// The single-sensor functions use a PMOD COLOR module connected directly to EUSCI_B1
+static I2C_Bus PMOD_Color_Default_Bus;
+
+static PMOD_Color_Sensor PMOD_Color_Default_Sensor =
 {
-    uint8_t buffer[] =
-    {
-         register_address,
-         register_data & 0xFF
-    };
+    &PMOD_Color_Default_Bus, PMOD_COLOR_ADDRESS, 0, PMOD_COLOR_NO_MUX
+};
 
-    EUSCI_B1_I2C_Send_Multiple_Bytes(PMOD_COLOR_ADDRESS, buffer, sizeof(buffer));
+void PMOD_Color_Write_Register(uint8_t register_address, uint8_t register_data)
+{
+    PMOD_Color_Sensor_Write_Register(&PMOD_Color_Default_Sensor, register_address, register_data);
 }
 
 uint8_t PMOD_Color_Read_Register(uint8_t register_address)
 {
-    EUSCI_B1_I2C_Send_A_Byte(PMOD_COLOR_ADDRESS, register_address);
-    uint8_t received_data = EUSCI_B1_I2C_Receive_A_Byte(PMOD_COLOR_ADDRESS);
+    uint8_t received_data = 0;
+    PMOD_Color_Sensor_Read_Register(&PMOD_Color_Default_Sensor, register_address, &received_data);
     return received_data;
 }
 
+I2C_Bus *PMOD_Color_Get_Bus()
+{
+    return &PMOD_Color_Default_Bus;
+}
+
 void PMOD_Color_Init()
 {
-    EUSCI_B1_I2C_Init();
+    I2C_Bus_EUSCI_B_Init(&PMOD_Color_Default_Bus, EUSCI_B1, I2C_BUS_DEFAULT_TIMEOUT_US);
 
     PMOD_Color_Enable(PMOD_COLOR_ENABLE_POWER_ON);
 
@@ -95,12 +112,14 @@ uint8_t PMOD_Color_Get_Device_ID()
 
 PMOD_Color_Data PMOD_Color_Get_RGBC()
 {
-    PMOD_Color_Data data;
+    PMOD_Color_Data data = {0, 0, 0, 0};
+    uint8_t command = PMOD_COLOR_AUTO_INC | PMOD_COLOR_CDATA_L_REG;
     uint8_t color_buffer[8];
 
-    EUSCI_B1_I2C_Send_A_Byte(PMOD_COLOR_ADDRESS, PMOD_COLOR_AUTO_INC | PMOD_COLOR_CDATA_L_REG);
-
-    EUSCI_B1_I2C_Receive_Multiple_Bytes(PMOD_COLOR_ADDRESS, color_buffer, 8);
+    if (I2C_Bus_Write_Read(&PMOD_Color_Default_Bus, PMOD_COLOR_ADDRESS, &command, 1, color_buffer, 8) != I2C_BUS_OK)
+    {
+        return data;
+    }
 
     data.clear = (color_buffer[1] << 8) | color_buffer[0];
     data.red = (color_buffer[3] << 8) | color_buffer[2];
@@ -116,6 +135,18 @@ uint8_t PMOD_Color_Read_Raw_Color_Data(uint8_t register_address)
     return PMOD_Color_Byte;
 }
 
+void PMOD_Color_Set_Timing(uint32_t integration_us, uint32_t wait_us)
+{
+    PMOD_Color_Sensor_Set_Timing(&PMOD_Color_Default_Sensor, integration_us, wait_us);
+}
+
+void PMOD_Color_Set_Gain(uint8_t gain)
+{
+    PMOD_Color_Sensor_Set_Gain(&PMOD_Color_Default_Sensor, gain);
+}
+
+#endif /* __MSP432P401R__ */
+
 PMOD_Calibration_Data PMOD_Color_Init_Calibration_Data(PMOD_Color_Data first_sample)
 {
     PMOD_Calibration_Data calibration_data;
@@ -139,14 +170,303 @@ void PMOD_Color_Calibrate(PMOD_Color_Data new_sample, PMOD_Calibration_Data *cal
     if (new_sample.blue > calibration_data->max.blue) calibration_data->max.blue = new_sample.blue;
 }
 
+// The difference and the range saturate at 0, and the scaled value at 0xFFFF, so that a sample outside
+// of the calibration does not wrap around. The integer factor 0xFFFF / range is kept, so that a sample
+// within the calibration gives the same value that the thresholds of Color_Classifier_Config.h were
+// tuned on
+static uint16_t PMOD_Color_Normalize_Channel(uint16_t value, uint16_t min, uint16_t max)
+{
+    uint16_t range = Fixed_Point_Sub_U16(max, min);
+
+    if (range == 0)
+    {
+        return 0;
+    }
+
+    return Fixed_Point_Sat_U16_From_U32((uint32_t)Fixed_Point_Sub_U16(value, min) * (0xFFFF / range));
+}
+
 PMOD_Color_Data PMOD_Color_Normalize_Calibration(PMOD_Color_Data sample, PMOD_Calibration_Data calibration_data)
 {
     PMOD_Color_Data normalized_data;
 
-    normalized_data.clear = (sample.clear - calibration_data.min.clear) * (0xFFFF / (calibration_data.max.clear - calibration_data.min.clear));
-    normalized_data.red = (sample.red - calibration_data.min.red) * (0xFFFF / (calibration_data.max.red - calibration_data.min.red));
-    normalized_data.green = (sample.green - calibration_data.min.green) * (0xFFFF / (calibration_data.max.green - calibration_data.min.green));
-    normalized_data.blue = (sample.blue - calibration_data.min.blue) * (0xFFFF / (calibration_data.max.blue - calibration_data.min.blue));
+    normalized_data.clear = PMOD_Color_Normalize_Channel(sample.clear, calibration_data.min.clear, calibration_data.max.clear);
+    normalized_data.red = PMOD_Color_Normalize_Channel(sample.red, calibration_data.min.red, calibration_data.max.red);
+    normalized_data.green = PMOD_Color_Normalize_Channel(sample.green, calibration_data.min.green, calibration_data.max.green);
+    normalized_data.blue = PMOD_Color_Normalize_Channel(sample.blue, calibration_data.min.blue, calibration_data.max.blue);
 
     return normalized_data;
 }
+
+static int PMOD_Color_Sensor_Select(PMOD_Color_Sensor *sensor)
+{
+    I2C_Bus *bus = sensor->bus;
+    uint8_t control;
+    int status;
+
+    if (sensor->mux_channel == PMOD_COLOR_NO_MUX)
+    {
+        return I2C_BUS_OK;
+    }
+
+    // Skip the channel switch if the channel is already selected
+    if ((bus->mux_address == sensor->mux_address) && (bus->mux_channel == sensor->mux_channel))
+    {
+        return I2C_BUS_OK;
+    }
+
+    // Disconnect the channel of a different multiplexer on the same bus so that
+    // sensors sharing the same I2C address do not respond at the same time
+    if ((bus->mux_channel != PMOD_COLOR_NO_MUX) && (bus->mux_address != sensor->mux_address))
+    {
+        control = 0x00;
+        status = I2C_Bus_Write(bus, bus->mux_address, &control, 1);
+        if (status != I2C_BUS_OK) return status;
+
+        bus->mux_channel = PMOD_COLOR_NO_MUX;
+    }
+
+    // The TCA9548A control register is a bit mask of the enabled channels
+    control = (uint8_t)(1 << sensor->mux_channel);
+    status = I2C_Bus_Write(bus, sensor->mux_address, &control, 1);
+
+    if (status != I2C_BUS_OK)
+    {
+        bus->mux_channel = PMOD_COLOR_NO_MUX;
+        return status;
+    }
+
+    bus->mux_address = sensor->mux_address;
+    bus->mux_channel = sensor->mux_channel;
+
+    return I2C_BUS_OK;
+}
+
+int PMOD_Color_Sensor_Init(PMOD_Color_Sensor *sensor)
+{
+    int status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_ENABLE_REG, PMOD_COLOR_ENABLE_POWER_ON);
+    if (status != I2C_BUS_OK) return status;
+
+    PMOD_Color_Delay_us(2400);
+
+    // Generate an RGBC interrupt at the end of every integration cycle by setting the
+    // persistence filter to 0 and using thresholds that every clear channel value falls outside of
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_PERS_REG, 0x00);
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_AILTL_REG, 0xFF);
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_AILTH_REG, 0xFF);
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_AIHTL_REG, 0x00);
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_AIHTH_REG, 0x00);
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_ENABLE_REG,
+                                              PMOD_COLOR_ENABLE_POWER_ON | PMOD_COLOR_ENABLE_RGBC | PMOD_COLOR_ENABLE_RGBC_INT);
+    if (status != I2C_BUS_OK) return status;
+
+    PMOD_Color_Delay_us(2400);
+
+    return I2C_BUS_OK;
+}
+
+int PMOD_Color_Sensor_Write_Register(PMOD_Color_Sensor *sensor, uint8_t register_address, uint8_t register_data)
+{
+    uint8_t buffer[] =
+    {
+         register_address,
+         register_data
+    };
+    int status = PMOD_Color_Sensor_Select(sensor);
+
+    if (status != I2C_BUS_OK) return status;
+
+    return I2C_Bus_Write(sensor->bus, sensor->address, buffer, sizeof(buffer));
+}
+
+int PMOD_Color_Sensor_Read_Register(PMOD_Color_Sensor *sensor, uint8_t register_address, uint8_t *register_data)
+{
+    int status = PMOD_Color_Sensor_Select(sensor);
+
+    if (status != I2C_BUS_OK) return status;
+
+    return I2C_Bus_Write_Read(sensor->bus, sensor->address, &register_address, 1, register_data, 1);
+}
+
+// Converts a time to a number of cycles, rounded to the nearest cycle and limited to 1 to 256
+static uint32_t PMOD_Color_Time_To_Cycles(uint32_t time_us, uint32_t cycle_us)
+{
+    uint32_t cycles = (time_us + (cycle_us / 2)) / cycle_us;
+
+    if (cycles < 1) cycles = 1;
+    if (cycles > PMOD_COLOR_MAX_CYCLES) cycles = PMOD_COLOR_MAX_CYCLES;
+
+    return cycles;
+}
+
+int PMOD_Color_Sensor_Set_Timing(PMOD_Color_Sensor *sensor, uint32_t integration_us, uint32_t wait_us)
+{
+    uint32_t integration_cycles = PMOD_Color_Time_To_Cycles(integration_us, PMOD_COLOR_CYCLE_US);
+    uint8_t long_wait = (wait_us > (PMOD_COLOR_MAX_CYCLES * PMOD_COLOR_CYCLE_US));
+    uint32_t wait_cycles;
+    uint8_t enable;
+    int status;
+
+    if (long_wait)
+    {
+        wait_cycles = PMOD_Color_Time_To_Cycles(wait_us, PMOD_COLOR_CYCLE_US * PMOD_COLOR_WLONG_FACTOR);
+    }
+    else
+    {
+        wait_cycles = PMOD_Color_Time_To_Cycles(wait_us, PMOD_COLOR_CYCLE_US);
+    }
+
+    // ATIME and WTIME hold 256 minus the number of cycles
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_ATIME_REG,
+                                              (uint8_t)(PMOD_COLOR_MAX_CYCLES - integration_cycles));
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_WTIME_REG,
+                                              (uint8_t)(PMOD_COLOR_MAX_CYCLES - wait_cycles));
+    if (status != I2C_BUS_OK) return status;
+
+    status = PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_CONFIG_REG,
+                                              long_wait ? PMOD_COLOR_CONFIG_WLONG : 0x00);
+    if (status != I2C_BUS_OK) return status;
+
+    // Enable the wait state only if a wait time was requested
+    status = PMOD_Color_Sensor_Read_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_ENABLE_REG, &enable);
+    if (status != I2C_BUS_OK) return status;
+
+    if (wait_us > 0)
+    {
+        enable |= PMOD_COLOR_ENABLE_WAIT;
+    }
+    else
+    {
+        enable &= ~PMOD_COLOR_ENABLE_WAIT;
+    }
+
+    return PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_ENABLE_REG, enable);
+}
+
+int PMOD_Color_Sensor_Set_Gain(PMOD_Color_Sensor *sensor, uint8_t gain)
+{
+    return PMOD_Color_Sensor_Write_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_CONTROL_REG, gain & 0x03);
+}
+
+uint8_t PMOD_Color_Sensor_Data_Ready(PMOD_Color_Sensor *sensor)
+{
+    uint8_t status_register = 0;
+
+    if (PMOD_Color_Sensor_Read_Register(sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_STATUS_REG, &status_register) != I2C_BUS_OK)
+    {
+        return 0;
+    }
+
+    return ((status_register & PMOD_COLOR_STATUS_AINT) != 0);
+}
+
+int PMOD_Color_Sensor_Get_RGBC(PMOD_Color_Sensor *sensor, PMOD_Color_Data *data)
+{
+    uint8_t command = PMOD_COLOR_AUTO_INC | PMOD_COLOR_CDATA_L_REG;
+    uint8_t clear_interrupt = PMOD_COLOR_CMD_CLEAR_INT;
+    uint8_t color_buffer[8];
+    int status = PMOD_Color_Sensor_Select(sensor);
+
+    if (status != I2C_BUS_OK) return status;
+
+    status = I2C_Bus_Write_Read(sensor->bus, sensor->address, &command, 1, color_buffer, 8);
+    if (status != I2C_BUS_OK) return status;
+
+    // Acknowledge the RGBC interrupt so that AINT signals the next completed conversion
+    status = I2C_Bus_Write(sensor->bus, sensor->address, &clear_interrupt, 1);
+
+    data->clear = (color_buffer[1] << 8) | color_buffer[0];
+    data->red = (color_buffer[3] << 8) | color_buffer[2];
+    data->green = (color_buffer[5] << 8) | color_buffer[4];
+    data->blue = (color_buffer[7] << 8) | color_buffer[6];
+
+    return status;
+}
+
+uint32_t PMOD_Color_Sample_Sensors(PMOD_Color_Sensor *sensors, PMOD_Color_Data *data, uint8_t sensor_count, uint32_t max_rounds)
+{
+    I2C_Bus *buses[PMOD_COLOR_MAX_SENSORS];
+    uint8_t visit_order[PMOD_COLOR_MAX_SENSORS];
+    uint8_t bus_count = 0;
+    uint8_t visit_count = 0;
+    uint32_t pending_mask;
+    uint32_t ready_mask = 0;
+
+    if (sensor_count > PMOD_COLOR_MAX_SENSORS)
+    {
+        sensor_count = PMOD_COLOR_MAX_SENSORS;
+    }
+
+    // Collect the distinct buses in order of first appearance
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+        uint8_t known = 0;
+
+        for (uint8_t b = 0; b < bus_count; b++)
+        {
+            if (buses[b] == sensors[i].bus) known = 1;
+        }
+
+        if (!known)
+        {
+            buses[bus_count++] = sensors[i].bus;
+        }
+    }
+
+    // Build the visiting order by taking the n-th sensor of each bus in turn, so that
+    // consecutive reads alternate between buses
+    for (uint8_t n = 0; visit_count < sensor_count; n++)
+    {
+        for (uint8_t b = 0; b < bus_count; b++)
+        {
+            uint8_t seen = 0;
+
+            for (uint8_t i = 0; i < sensor_count; i++)
+            {
+                if (sensors[i].bus != buses[b]) continue;
+
+                if (seen == n)
+                {
+                    visit_order[visit_count++] = i;
+                    break;
+                }
+                seen++;
+            }
+        }
+    }
+
+    pending_mask = (1UL << sensor_count) - 1;
+
+    for (uint32_t round = 0; (round < max_rounds) && (pending_mask != 0); round++)
+    {
+        for (uint8_t k = 0; k < visit_count; k++)
+        {
+            uint8_t i = visit_order[k];
+
+            if ((pending_mask & (1UL << i)) == 0) continue;
+
+            if (PMOD_Color_Sensor_Data_Ready(&sensors[i]) &&
+                (PMOD_Color_Sensor_Get_RGBC(&sensors[i], &data[i]) == I2C_BUS_OK))
+            {
+                ready_mask |= (1UL << i);
+                pending_mask &= ~(1UL << i);
+            }
+        }
+    }
+
+    return ready_mask;
+}
@@ -0,0 +1,215 @@
+/**
+ * @file Reaction_Stats.c
+ * @brief Source code for the Reaction_Stats module.
+ *
+ * This file contains the function definitions for the reaction time statistics of the Simon game.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Reaction_Stats.h"
+
+static void Reaction_Histogram_Init(Reaction_Histogram *histogram, uint16_t bin_ms)
+{
+    histogram->bin_ms = bin_ms;
+    histogram->count = 0;
+    histogram->sum_ms = 0;
+    histogram->min_ms = 0;
+    histogram->max_ms = 0;
+
+    for (int i = 0; i < REACTION_STATS_BINS; i++)
+    {
+        histogram->bins[i] = 0;
+    }
+}
+
+static void Reaction_Histogram_Add(Reaction_Histogram *histogram, uint32_t time_ms)
+{
+    uint32_t bin = time_ms / histogram->bin_ms;
+
+    if (bin >= REACTION_STATS_BINS)
+    {
+        bin = REACTION_STATS_BINS - 1;
+    }
+
+    // The bins saturate rather than wrap, so the percentiles stay usable after a very long session
+    if (histogram->bins[bin] < UINT32_MAX)
+    {
+        histogram->bins[bin]++;
+    }
+
+    if ((histogram->count == 0) || (time_ms < histogram->min_ms))
+    {
+        histogram->min_ms = time_ms;
+    }
+    if (time_ms > histogram->max_ms)
+    {
+        histogram->max_ms = time_ms;
+    }
+
+    histogram->count++;
+    histogram->sum_ms += time_ms;
+}
+
+// Saturates a time to the 16-bit fields of the summary
+static uint16_t Reaction_Stats_U16(uint32_t value)
+{
+    return (value > UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+}
+
+void Reaction_Stats_Init(Reaction_Stats *stats)
+{
+    Reaction_Histogram_Init(&stats->reaction, REACTION_STATS_REACTION_BIN_MS);
+    Reaction_Histogram_Init(&stats->pipeline, REACTION_STATS_PIPELINE_BIN_MS);
+    Reaction_Histogram_Init(&stats->round, REACTION_STATS_ROUND_BIN_MS);
+    stats->best_round_ms = 0;
+    stats->fails = 0;
+    stats->misses = 0;
+    stats->in_round = 0;
+    stats->step = 0;
+    stats->start_ms = 0;
+    stats->last_ms = 0;
+}
+
+void Reaction_Stats_Start_Round(Reaction_Stats *stats, uint32_t now_ms)
+{
+    stats->in_round = 1;
+    stats->step = 0;
+    stats->start_ms = now_ms;
+    stats->last_ms = now_ms;
+}
+
+Reaction_Step Reaction_Stats_Accept(Reaction_Stats *stats, uint32_t detected_ms, uint32_t accepted_ms)
+{
+    Reaction_Step step = { 0, 0, 0, 0 };
+
+    if (!stats->in_round)
+    {
+        return step;
+    }
+
+    // A color first seen before the previous acceptance (still being debounced) has no reaction time.
+    // The differences are computed modulo 2^32, so the counter may wrap during a round
+    if ((int32_t)(detected_ms - stats->last_ms) < 0)
+    {
+        detected_ms = stats->last_ms;
+    }
+    if ((int32_t)(accepted_ms - detected_ms) < 0)
+    {
+        accepted_ms = detected_ms;
+    }
+
+    if (stats->step < UINT8_MAX)
+    {
+        stats->step++;
+    }
+
+    step.step = stats->step;
+    step.since_start_ms = accepted_ms - stats->start_ms;
+    step.reaction_ms = detected_ms - stats->last_ms;
+    step.pipeline_ms = accepted_ms - detected_ms;
+
+    Reaction_Histogram_Add(&stats->reaction, step.reaction_ms);
+    Reaction_Histogram_Add(&stats->pipeline, step.pipeline_ms);
+    stats->last_ms = accepted_ms;
+
+    return step;
+}
+
+uint32_t Reaction_Stats_Complete(Reaction_Stats *stats, uint32_t now_ms)
+{
+    if (!stats->in_round)
+    {
+        return 0;
+    }
+
+    uint32_t round_ms = now_ms - stats->start_ms;
+
+    Reaction_Histogram_Add(&stats->round, round_ms);
+    if ((stats->best_round_ms == 0) || (round_ms < stats->best_round_ms))
+    {
+        stats->best_round_ms = round_ms;
+    }
+
+    stats->in_round = 0;
+    return round_ms;
+}
+
+void Reaction_Stats_Fail(Reaction_Stats *stats)
+{
+    stats->fails++;
+    stats->in_round = 0;
+}
+
+void Reaction_Stats_Miss(Reaction_Stats *stats)
+{
+    stats->misses++;
+}
+
+uint32_t Reaction_Histogram_Percentile_ms(const Reaction_Histogram *histogram, uint8_t percent)
+{
+    uint64_t total = 0;
+    uint64_t counted = 0;
+
+    for (int i = 0; i < REACTION_STATS_BINS; i++)
+    {
+        total += histogram->bins[i];
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    // Smallest number of samples that covers the percentile, rounded up
+    uint64_t target = (total * percent + 99) / 100;
+
+    for (int i = 0; i < REACTION_STATS_BINS; i++)
+    {
+        counted += histogram->bins[i];
+
+        if ((counted >= target) && (counted > 0))
+        {
+            uint32_t upper_ms = (uint32_t)(i + 1) * histogram->bin_ms;
+            return ((i == REACTION_STATS_BINS - 1) || (upper_ms > histogram->max_ms)) ? histogram->max_ms : upper_ms;
+        }
+    }
+
+    return histogram->max_ms;
+}
+
+uint32_t Reaction_Histogram_Mean_ms(const Reaction_Histogram *histogram)
+{
+    return (histogram->count > 0) ? (uint32_t)(histogram->sum_ms / histogram->count) : 0;
+}
+
+void Reaction_Stats_Summarize(const Reaction_Stats *stats, Reaction_Summary *summary)
+{
+    summary->steps = stats->reaction.count;
+    summary->reaction_mean_ms = Reaction_Stats_U16(Reaction_Histogram_Mean_ms(&stats->reaction));
+    summary->reaction_p50_ms = Reaction_Stats_U16(Reaction_Histogram_Percentile_ms(&stats->reaction, 50));
+    summary->reaction_p90_ms = Reaction_Stats_U16(Reaction_Histogram_Percentile_ms(&stats->reaction, 90));
+    summary->pipeline_mean_ms = Reaction_Stats_U16(Reaction_Histogram_Mean_ms(&stats->pipeline));
+    summary->pipeline_p90_ms = Reaction_Stats_U16(Reaction_Histogram_Percentile_ms(&stats->pipeline, 90));
+    summary->rounds = Reaction_Stats_U16(stats->round.count);
+    summary->fails = Reaction_Stats_U16(stats->fails);
+    summary->misses = Reaction_Stats_U16(stats->misses);
+    summary->round_mean_ms = Reaction_Histogram_Mean_ms(&stats->round);
+    summary->best_round_ms = stats->best_round_ms;
+}
+
+void Reaction_Stats_Print(const Reaction_Stats *stats)
+{
+    Reaction_Summary summary;
+
+    Reaction_Stats_Summarize(stats, &summary);
+
+    printf("reaction steps: %lu, mean %u ms, p50 %u ms, p90 %u ms\n", (unsigned long)summary.steps,
+           summary.reaction_mean_ms, summary.reaction_p50_ms, summary.reaction_p90_ms);
+    printf("reaction pipeline: mean %u ms, p90 %u ms\n", summary.pipeline_mean_ms, summary.pipeline_p90_ms);
+
+    // The counts are printed in full; only the telemetry frame saturates them
+    printf("reaction rounds: %lu complete, %lu failed, %lu misses, mean %lu ms, best %lu ms\n",
+           (unsigned long)stats->round.count, (unsigned long)stats->fails, (unsigned long)stats->misses,
+           (unsigned long)summary.round_mean_ms, (unsigned long)summary.best_round_ms);
+}
@@ -0,0 +1,249 @@
+/**
+ * @file Sample_Summary.c
+ * @brief Source code for the Sample_Summary module.
+ *
+ * This file contains the function definitions for the windowed summaries and raw bursts of the samples.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Sample_Summary.h"
+#include "../inc/Fixed_Point.h"
+
+// Length of the text line that main.c prints for each sample without the summary
+#define SAMPLE_SUMMARY_TEXT_LINE_SIZE           22
+
+const Sample_Summary_Config Sample_Summary_Default_Config =
+{
+    SAMPLE_SUMMARY_WINDOW_MS,
+    SAMPLE_SUMMARY_BURST_SAMPLES,
+    SAMPLE_SUMMARY_ANOMALY_SIGMAS,
+    SAMPLE_SUMMARY_ANOMALY_MIN_DELTA
+};
+
+static void Sample_Summary_Clear_Window(Sample_Summary *summary)
+{
+    summary->samples = 0;
+    summary->raw_samples = 0;
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+    {
+        summary->sum[i] = 0;
+        summary->sum_squares[i] = 0;
+    }
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+    {
+        summary->classes[i] = 0;
+    }
+}
+
+void Sample_Summary_Init(Sample_Summary *summary, const Sample_Summary_Config *config, Sample_Summary_Write write,
+                         void *write_context)
+{
+    summary->config = *config;
+
+    if (summary->config.window_ms == 0)
+    {
+        summary->config.window_ms = 1;
+    }
+    else if (summary->config.window_ms > SAMPLE_SUMMARY_MAX_WINDOW_MS)
+    {
+        summary->config.window_ms = SAMPLE_SUMMARY_MAX_WINDOW_MS;
+    }
+
+    summary->write = write;
+    summary->write_context = write_context;
+    summary->has_window = 0;
+    summary->start_ms = 0;
+    summary->has_reference = 0;
+    summary->burst_left = 0;
+    summary->windows = 0;
+    summary->total_samples = 0;
+    summary->raw_sent = 0;
+    summary->anomalies = 0;
+    summary->requests = 0;
+    summary->bytes = 0;
+
+    Sample_Summary_Clear_Window(summary);
+}
+
+static void Sample_Summary_Send_Window(Sample_Summary *summary)
+{
+    Board_Protocol_Summary body;
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+    uint32_t n = summary->samples;
+    Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(n);
+
+    body.start_ms = summary->start_ms;
+    body.window_ms = (uint16_t)summary->config.window_ms;
+    body.samples = summary->samples;
+    body.raw_samples = summary->raw_samples;
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+    {
+        uint64_t sum = summary->sum[i];
+
+        // n * variance = sum of squares - sum^2 / n; sum^2 fits in 64 bits for up to 65535 samples
+        body.min[i] = summary->min[i];
+        body.max[i] = summary->max[i];
+        body.mean[i] = (uint16_t)Fixed_Point_Divide((uint32_t)sum + n / 2, n, reciprocal);
+        body.variance[i] = (uint32_t)((summary->sum_squares[i] - (sum * sum) / n) / n);
+
+        // Smallest delta with delta^2 > sigmas^2 * variance, and at least the min delta. Above 32 bits,
+        // the threshold is beyond any 16-bit delta
+        uint64_t bound = (uint64_t)summary->config.anomaly_sigmas * summary->config.anomaly_sigmas * body.variance[i];
+        uint32_t threshold = (bound > 0xFFFFFFFFu) ? 0x10000 : (uint32_t)Fixed_Point_Sqrt((uint32_t)bound) + 1;
+
+        summary->reference_mean[i] = body.mean[i];
+        summary->reference_threshold[i] = (threshold > summary->config.anomaly_min_delta) ? threshold
+                                                                                           : summary->config.anomaly_min_delta;
+    }
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+    {
+        body.classes[i] = summary->classes[i];
+    }
+
+    int length = Board_Protocol_Encode_Summary(Board_Protocol_Next_Sequence(), &body, frame, sizeof(frame));
+
+    if (length > 0)
+    {
+        summary->write(summary->write_context, frame, (uint16_t)length);
+        summary->bytes += length;
+    }
+
+    summary->has_reference = 1;
+    summary->windows++;
+    Sample_Summary_Clear_Window(summary);
+}
+
+static uint8_t Sample_Summary_Is_Anomaly(const Sample_Summary *summary, const uint16_t *values)
+{
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+    {
+        if (Fixed_Point_Abs_Diff_U16(values[i], summary->reference_mean[i]) >= summary->reference_threshold[i])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+uint8_t Sample_Summary_Add(Sample_Summary *summary, uint32_t time_ms, const PMOD_Color_Data *data, Color_t color)
+{
+    uint16_t values[BOARD_PROTOCOL_SUMMARY_CHANNELS] = { data->red, data->green, data->blue, data->clear };
+    uint32_t window_ms = summary->config.window_ms;
+    uint8_t flags = 0;
+
+    if (!summary->has_window)
+    {
+        summary->has_window = 1;
+        summary->start_ms = time_ms;
+    }
+    else if ((time_ms - summary->start_ms) >= window_ms)
+    {
+        Sample_Summary_Send_Window(summary);
+        flags |= SAMPLE_SUMMARY_WINDOW_SENT;
+
+        // The windows stay aligned on the first one; the windows without samples are skipped
+        summary->start_ms += ((time_ms - summary->start_ms) / window_ms) * window_ms;
+    }
+    else if (summary->samples == 0xFFFF)
+    {
+        // Only with more than 65535 samples in a window: it is cut short, and the next starts here
+        Sample_Summary_Send_Window(summary);
+        flags |= SAMPLE_SUMMARY_WINDOW_SENT;
+        summary->start_ms = time_ms;
+    }
+
+    if ((summary->burst_left == 0) && summary->has_reference && (summary->config.anomaly_sigmas > 0) &&
+        Sample_Summary_Is_Anomaly(summary, values))
+    {
+        summary->burst_left = summary->config.burst_samples;
+        summary->has_reference = 0;
+        summary->anomalies++;
+        flags |= SAMPLE_SUMMARY_ANOMALY;
+    }
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+    {
+        uint32_t value = values[i];
+
+        if ((summary->samples == 0) || (value < summary->min[i]))
+        {
+            summary->min[i] = (uint16_t)value;
+        }
+
+        if ((summary->samples == 0) || (value > summary->max[i]))
+        {
+            summary->max[i] = (uint16_t)value;
+        }
+
+        summary->sum[i] += value;
+        summary->sum_squares[i] += value * value;
+    }
+
+    if ((uint32_t)color < BOARD_PROTOCOL_SUMMARY_CLASSES)
+    {
+        summary->classes[color]++;
+    }
+
+    summary->samples++;
+    summary->total_samples++;
+
+    if (summary->burst_left > 0)
+    {
+        uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+        int length = Board_Protocol_Encode_Sample(Board_Protocol_Next_Sequence(), time_ms, data, frame, sizeof(frame));
+
+        if (length > 0)
+        {
+            summary->write(summary->write_context, frame, (uint16_t)length);
+            summary->bytes += length;
+        }
+
+        summary->burst_left--;
+        summary->raw_samples++;
+        summary->raw_sent++;
+        flags |= SAMPLE_SUMMARY_RAW_SENT;
+    }
+
+    return flags;
+}
+
+void Sample_Summary_Request_Burst(Sample_Summary *summary)
+{
+    summary->burst_left = summary->config.burst_samples;
+    summary->requests++;
+}
+
+void Sample_Summary_Flush(Sample_Summary *summary)
+{
+    if (summary->has_window && (summary->samples > 0))
+    {
+        Sample_Summary_Send_Window(summary);
+    }
+
+    summary->has_window = 0;
+}
+
+void Sample_Summary_Print_Stats(const Sample_Summary *summary)
+{
+    uint64_t text_bytes = (uint64_t)summary->total_samples * SAMPLE_SUMMARY_TEXT_LINE_SIZE;
+    uint32_t share = 0;
+
+    // Share of the bytes that a text line per sample would take, in hundredths of a percent
+    if (text_bytes > 0)
+    {
+        share = (uint32_t)((uint64_t)summary->bytes * 10000 / text_bytes);
+    }
+
+    printf("summary: %lu windows of %lu ms, %lu samples, %lu sent raw (%lu anomalies, %lu requests)\n",
+           (unsigned long)summary->windows, (unsigned long)summary->config.window_ms,
+           (unsigned long)summary->total_samples, (unsigned long)summary->raw_sent,
+           (unsigned long)summary->anomalies, (unsigned long)summary->requests);
+    printf("summary: %lu bytes sent, %lu.%02lu%% of a text line per sample\n", (unsigned long)summary->bytes,
+           (unsigned long)(share / 100), (unsigned long)(share % 100));
+}
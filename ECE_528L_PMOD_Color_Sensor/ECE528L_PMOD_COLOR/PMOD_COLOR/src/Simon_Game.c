@@ -0,0 +1,205 @@
+/**
+ * @file Simon_Game.c
+ * @brief Source code for the Simon_Game module.
+ *
+ * This file contains the function definitions for the game logic of the Simon Says color game.
+ *
+ */
+
+#include "../inc/Simon_Game.h"
+
+// Builds the KMP failure function of the pattern
+static void Simon_Game_Build_Fallback(Simon_Game *game)
+{
+    uint8_t length = 0;
+
+    game->fallback[0] = 0;
+
+    for (int i = 1; i < SIMON_GAME_PATTERN_LENGTH; i++)
+    {
+        while ((length > 0) && (game->pattern[i] != game->pattern[length]))
+        {
+            length = game->fallback[length - 1];
+        }
+
+        if (game->pattern[i] == game->pattern[length])
+        {
+            length++;
+        }
+
+        game->fallback[i] = length;
+    }
+}
+
+void Simon_Game_Init(Simon_Game *game, uint32_t seed)
+{
+    game->random_state = (seed == 0) ? 0x12345678 : seed;
+    game->index = 0;
+    game->fail_count = 0;
+    game->mode = SIMON_GAME_MODE_RESTART;
+    Simon_Debouncer_Init(&game->debouncer, SIMON_GAME_STABLE_US, SIMON_GAME_RELEASE_US);
+
+    for (int i = 0; i < SIMON_GAME_PATTERN_LENGTH; i++)
+    {
+        game->pattern[i] = COLOR_GREEN;
+    }
+
+    Simon_Game_Build_Fallback(game);
+}
+
+void Simon_Game_Set_Mode(Simon_Game *game, uint8_t mode)
+{
+    game->mode = mode;
+    game->index = 0;
+    game->fail_count = 0;
+    Simon_Debouncer_Init(&game->debouncer, SIMON_GAME_STABLE_US, SIMON_GAME_RELEASE_US);
+}
+
+// xorshift32 pseudo-random number generator
+uint32_t Simon_Game_Random(Simon_Game *game)
+{
+    game->random_state ^= game->random_state << 13;
+    game->random_state ^= game->random_state >> 17;
+    game->random_state ^= game->random_state << 5;
+    return game->random_state;
+}
+
+void Simon_Game_Generate_Pattern(Simon_Game *game)
+{
+    for (int i = 0; i < SIMON_GAME_PATTERN_LENGTH; i++)
+    {
+        game->pattern[i] = (Color_t)(Simon_Game_Random(game) % 3);   // 0 = green, 1 = red, 2 = yellow
+    }
+
+    Simon_Game_Build_Fallback(game);
+
+    game->index = 0;
+    game->fail_count = 0;
+}
+
+// Advances the KMP automaton by one color event
+static int Simon_Game_Check_Continuous(Simon_Game *game, Color_t detected)
+{
+    if (detected == COLOR_UNKNOWN)
+    {
+        return SIMON_GAME_IGNORED;
+    }
+
+    // Fall back to shorter partial matches until the color extends one
+    while ((game->index > 0) && (detected != game->pattern[game->index]))
+    {
+        game->index = game->fallback[game->index - 1];
+    }
+
+    if (detected == game->pattern[game->index])
+    {
+        game->index++;
+    }
+
+    if (game->index == SIMON_GAME_PATTERN_LENGTH)
+    {
+        // Keep the overlap with a following occurrence of the pattern
+        game->index = game->fallback[SIMON_GAME_PATTERN_LENGTH - 1];
+        return SIMON_GAME_COMPLETE;
+    }
+
+    // A color that still ends a partial match is a step, even after a fall back: the player only has
+    // to continue the pattern from there. A miss leaves no partial match
+    return (game->index > 0) ? SIMON_GAME_STEP : SIMON_GAME_MISS;
+}
+
+int Simon_Game_Check(Simon_Game *game, Color_t detected)
+{
+    if (game->mode == SIMON_GAME_MODE_CONTINUOUS)
+    {
+        return Simon_Game_Check_Continuous(game, detected);
+    }
+
+    if (detected == COLOR_UNKNOWN)
+        return SIMON_GAME_IGNORED;  // ignore noise completely
+
+    // ---------- CORRECT COLOR ----------
+    if (detected == game->pattern[game->index])
+    {
+        game->fail_count = 0;    // reset failure counter
+        game->index++;
+
+        if (game->index == SIMON_GAME_PATTERN_LENGTH)
+        {
+            game->index = 0;
+            return SIMON_GAME_COMPLETE;     // full pattern matched
+        }
+        return SIMON_GAME_STEP; // correct so far
+    }
+
+    // ---------- WRONG COLOR ----------
+    else
+    {
+        game->fail_count++;
+
+        if (game->fail_count >= SIMON_GAME_MAX_FAILS)   // only fail after 2 bad reads in a row
+        {
+            game->index = 0;
+            game->fail_count = 0;
+            return SIMON_GAME_WRONG;   // full failure: restart needed
+        }
+
+        return SIMON_GAME_IGNORED;   // mild failure, do not restart
+    }
+}
+
+void Simon_Debouncer_Init(Simon_Debouncer *debouncer, uint32_t stable_time_us, uint32_t release_time_us)
+{
+    debouncer->stable_time_us = stable_time_us;
+    debouncer->release_time_us = release_time_us;
+    debouncer->candidate = COLOR_UNKNOWN;
+    debouncer->stable_us = 0;
+    debouncer->last_event = COLOR_UNKNOWN;
+    debouncer->release_us = 0;
+}
+
+Color_t Simon_Debouncer_Update(Simon_Debouncer *debouncer, Color_t detected, uint32_t elapsed_us)
+{
+    if (detected == COLOR_UNKNOWN)
+    {
+        debouncer->candidate = COLOR_UNKNOWN;
+        debouncer->stable_us = 0;
+
+        // The object has been removed once the background has been seen long enough
+        if (debouncer->release_us < debouncer->release_time_us)
+        {
+            debouncer->release_us += elapsed_us;
+        }
+        if (debouncer->release_us >= debouncer->release_time_us)
+        {
+            debouncer->last_event = COLOR_UNKNOWN;
+        }
+        return COLOR_UNKNOWN;
+    }
+
+    debouncer->release_us = 0;
+
+    if (detected != debouncer->candidate)
+    {
+        debouncer->candidate = detected;
+        debouncer->stable_us = elapsed_us;
+    }
+    else if (debouncer->stable_us < debouncer->stable_time_us)
+    {
+        debouncer->stable_us += elapsed_us;
+    }
+
+    // A stable color is an event, unless it is the object of the last event still being sampled
+    if ((debouncer->stable_us >= debouncer->stable_time_us) && (detected != debouncer->last_event))
+    {
+        debouncer->last_event = detected;
+        return detected;
+    }
+
+    return COLOR_UNKNOWN;
+}
+
+Color_t Simon_Game_Debounce(Simon_Game *game, Color_t detected, uint32_t elapsed_us)
+{
+    return Simon_Debouncer_Update(&game->debouncer, detected, elapsed_us);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file Simon_Levels.c
+ * @brief Source code for the Simon_Levels module.
+ *
+ * This file contains the function definitions for the progressive Simon Says color game.
+ *
+ */
+
+#include "../inc/Simon_Levels.h"
+
+// The first level keeps the timing of main.c (Show_Pattern and Simon_Game_Debounce). The shortest
+// debounce times still span several samples of the burst mode of Adaptive_Rate (2.4 ms)
+const Simon_Level_Timing Simon_Levels_Timing_Table[SIMON_LEVELS_TIMING_POINTS] =
+{
+    // Length   On ms   Off ms  Stable us   Release us  Window us
+    {  4,       700,    300,    150000,     100000,     4000000 },     // SIMON_LEVELS_FIRST_LENGTH
+    {  16,      450,    200,    100000,     60000,      2500000 },
+    {  64,      280,    120,    60000,      35000,      1400000 },
+    {  256,     180,    70,     30000,      20000,      800000 },      // SIMON_LEVELS_MAX_LENGTH
+};
+
+// xorshift32 pseudo-random number generator
+static uint32_t Simon_Levels_Random(Simon_Levels *levels)
+{
+    uint32_t x = levels->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    levels->random_state = x;
+    return x;
+}
+
+static void Simon_Levels_Set_Color(Simon_Levels *levels, uint16_t position, Color_t color)
+{
+    uint8_t shift = (uint8_t)((position & 3) * 2);
+    uint8_t *byte = &levels->packed[position >> 2];
+
+    *byte = (uint8_t)((*byte & ~(0x03 << shift)) | ((color & 0x03) << shift));
+}
+
+// Selects the timing of the current length and restarts the input
+static void Simon_Levels_Set_Length(Simon_Levels *levels, uint16_t length)
+{
+    levels->length = length;
+    Simon_Levels_Get_Timing(length, &levels->timing);
+    Simon_Levels_Start_Input(levels);
+}
+
+void Simon_Levels_Init(Simon_Levels *levels, uint32_t seed)
+{
+    levels->random_state = (seed == 0) ? 0x12345678 : seed;
+    Simon_Levels_Restart(levels);
+}
+
+void Simon_Levels_Restart(Simon_Levels *levels)
+{
+    for (int i = 0; i < SIMON_LEVELS_PACKED_BYTES; i++)
+    {
+        levels->packed[i] = 0;
+    }
+
+    for (uint16_t i = 0; i < SIMON_LEVELS_FIRST_LENGTH; i++)
+    {
+        Simon_Levels_Set_Color(levels, i, (Color_t)(Simon_Levels_Random(levels) % 3));
+    }
+
+    Simon_Levels_Set_Length(levels, SIMON_LEVELS_FIRST_LENGTH);
+}
+
+void Simon_Levels_Next_Level(Simon_Levels *levels)
+{
+    uint16_t length = levels->length;
+
+    if (length < SIMON_LEVELS_MAX_LENGTH)
+    {
+        Simon_Levels_Set_Color(levels, length, (Color_t)(Simon_Levels_Random(levels) % 3));
+        length++;
+    }
+
+    Simon_Levels_Set_Length(levels, length);
+}
+
+Color_t Simon_Levels_Get_Color(const Simon_Levels *levels, uint16_t position)
+{
+    return (Color_t)((levels->packed[position >> 2] >> ((position & 3) * 2)) & 0x03);
+}
+
+void Simon_Levels_Get_Timing(uint16_t length, Simon_Level_Timing *timing)
+{
+    const Simon_Level_Timing *low = &Simon_Levels_Timing_Table[0];
+    const Simon_Level_Timing *high = &Simon_Levels_Timing_Table[SIMON_LEVELS_TIMING_POINTS - 1];
+
+    if (length <= low->length)
+    {
+        *timing = *low;
+        return;
+    }
+    if (length >= high->length)
+    {
+        *timing = *high;
+        return;
+    }
+
+    // Find the breakpoints around the length
+    for (int i = 1; i < SIMON_LEVELS_TIMING_POINTS; i++)
+    {
+        if (length <= Simon_Levels_Timing_Table[i].length)
+        {
+            low = &Simon_Levels_Timing_Table[i - 1];
+            high = &Simon_Levels_Timing_Table[i];
+            break;
+        }
+    }
+
+    int32_t span = high->length - low->length;
+    int32_t offset = length - low->length;
+
+    timing->length = length;
+    timing->show_on_ms = (uint16_t)(low->show_on_ms + ((int32_t)high->show_on_ms - low->show_on_ms) * offset / span);
+    timing->show_off_ms = (uint16_t)(low->show_off_ms + ((int32_t)high->show_off_ms - low->show_off_ms) * offset / span);
+    timing->stable_us = (uint32_t)((int64_t)low->stable_us + ((int64_t)high->stable_us - low->stable_us) * offset / span);
+    timing->release_us = (uint32_t)((int64_t)low->release_us + ((int64_t)high->release_us - low->release_us) * offset / span);
+    timing->window_us = (uint32_t)((int64_t)low->window_us + ((int64_t)high->window_us - low->window_us) * offset / span);
+}
+
+void Simon_Levels_Start_Input(Simon_Levels *levels)
+{
+    levels->index = 0;
+    levels->waiting_us = 0;
+    levels->timed_out = 0;
+    Simon_Debouncer_Init(&levels->debouncer, levels->timing.stable_us, levels->timing.release_us);
+}
+
+int Simon_Levels_Update(Simon_Levels *levels, Color_t detected, uint32_t elapsed_us)
+{
+    Color_t event = Simon_Debouncer_Update(&levels->debouncer, detected, elapsed_us);
+
+    if (event == COLOR_UNKNOWN)
+    {
+        levels->waiting_us += elapsed_us;
+
+        if (levels->waiting_us > levels->timing.window_us)
+        {
+            levels->timed_out = 1;
+            return SIMON_GAME_WRONG;
+        }
+        return SIMON_GAME_IGNORED;
+    }
+
+    if (event != Simon_Levels_Get_Color(levels, levels->index))
+    {
+        return SIMON_GAME_WRONG;
+    }
+
+    levels->index++;
+    levels->waiting_us = 0;
+
+    return (levels->index == levels->length) ? SIMON_GAME_COMPLETE : SIMON_GAME_STEP;
+}
@@ -0,0 +1,274 @@
+/**
+ * @file Tickless_Timer.c
+ * @brief Source code for the Tickless_Timer module.
+ *
+ * This file contains the function definitions for the tickless timer service.
+ *
+ */
+
+#include <stdio.h>
+#include "../inc/Tickless_Timer.h"
+
+// Extends the counter into the 64-bit time base and publishes it. The difference is taken modulo 2^32,
+// which is correct as long as the counter is read at least once per wrap (the guard event ensures it)
+static uint64_t Tickless_Timer_Extend_Locked(Tickless_Timer *timer)
+{
+    uint32_t sequence = timer->base_sequence;
+    volatile Tickless_Timer_Base *base = &timer->base[sequence & 1];
+    volatile Tickless_Timer_Base *next = &timer->base[(sequence + 1) & 1];
+    uint32_t counter = timer->ops->now(timer->context);
+    uint64_t ticks = base->ticks + (uint32_t)(counter - base->counter);
+
+    // The copy in use is left intact for a reader that interrupts this update
+    next->ticks = ticks;
+    next->counter = counter;
+    timer->base_sequence = sequence + 1;
+
+    return ticks;
+}
+
+// Inserts an event after the pending events with the same or an earlier deadline
+static void Tickless_Timer_Insert_Locked(Tickless_Timer *timer, Tickless_Timer_Event *event)
+{
+    Tickless_Timer_Event **link = &timer->head;
+
+    while ((*link != 0) && ((*link)->deadline <= event->deadline))
+    {
+        link = &(*link)->next;
+    }
+
+    event->next = *link;
+    *link = event;
+    event->pending = 1;
+}
+
+static void Tickless_Timer_Remove_Locked(Tickless_Timer *timer, Tickless_Timer_Event *event)
+{
+    Tickless_Timer_Event **link = &timer->head;
+
+    while ((*link != 0) && (*link != event))
+    {
+        link = &(*link)->next;
+    }
+
+    if (*link == event)
+    {
+        *link = event->next;
+    }
+
+    event->next = 0;
+    event->pending = 0;
+}
+
+// Programs the alarm for the earliest deadline
+static void Tickless_Timer_Program_Alarm_Locked(Tickless_Timer *timer, uint64_t now)
+{
+    if (timer->head == 0)
+    {
+        timer->ops->cancel_alarm(timer->context);
+        return;
+    }
+
+    uint64_t deadline = timer->head->deadline;
+    uint64_t delay = (deadline > now) ? (deadline - now) : 0;
+
+    if (delay > TICKLESS_TIMER_MAX_ALARM_TICKS)
+    {
+        delay = TICKLESS_TIMER_MAX_ALARM_TICKS;
+    }
+
+    timer->ops->set_alarm(timer->context, (uint32_t)delay);
+}
+
+void Tickless_Timer_Init(Tickless_Timer *timer, const Tickless_Timer_Ops *ops, void *context, uint32_t ticks_per_ms)
+{
+    timer->ops = ops;
+    timer->context = context;
+    timer->ticks_per_ms = ticks_per_ms;
+    timer->base[0].ticks = 0;
+    timer->base[0].counter = ops->now(context);
+    timer->base_sequence = 0;
+    timer->head = 0;
+    timer->guard.pending = 0;
+    timer->guard.next = 0;
+    timer->alarms = 0;
+    timer->callbacks = 0;
+    timer->overruns = 0;
+    timer->idle_ticks = 0;
+
+    // Nothing else may be scheduled, so the guard event alone keeps the time base extended
+    Tickless_Timer_Start(timer, &timer->guard, TICKLESS_TIMER_GUARD_TICKS, TICKLESS_TIMER_GUARD_TICKS, 0, 0);
+}
+
+uint64_t Tickless_Timer_Now(Tickless_Timer *timer)
+{
+    uint32_t sequence;
+    uint64_t ticks;
+    uint32_t counter;
+
+    // A locked section that runs during the copy publishes a new base; the copy is then read again
+    do
+    {
+        sequence = timer->base_sequence;
+        ticks = timer->base[sequence & 1].ticks;
+        counter = timer->base[sequence & 1].counter;
+    } while (sequence != timer->base_sequence);
+
+    // The counter is read after the base, so the difference is never negative
+    return ticks + (uint32_t)(timer->ops->now(timer->context) - counter);
+}
+
+uint32_t Tickless_Timer_Now_ms(Tickless_Timer *timer)
+{
+    return (uint32_t)(Tickless_Timer_Now(timer) / timer->ticks_per_ms);
+}
+
+uint32_t Tickless_Timer_Ticks_From_ms(const Tickless_Timer *timer, uint32_t ms)
+{
+    uint64_t ticks = (uint64_t)ms * timer->ticks_per_ms;
+
+    return (ticks > UINT32_MAX) ? UINT32_MAX : (uint32_t)ticks;
+}
+
+void Tickless_Timer_Start(Tickless_Timer *timer, Tickless_Timer_Event *event, uint32_t delay_ticks, uint32_t period_ticks,
+                          Tickless_Timer_Callback callback, void *context)
+{
+    uint32_t state = timer->ops->lock(timer->context);
+    uint64_t now = Tickless_Timer_Extend_Locked(timer);
+
+    if (event->pending)
+    {
+        Tickless_Timer_Remove_Locked(timer, event);
+    }
+
+    event->deadline = now + delay_ticks;
+    event->period_ticks = period_ticks;
+    event->callback = callback;
+    event->context = context;
+    Tickless_Timer_Insert_Locked(timer, event);
+
+    if (timer->head == event)
+    {
+        Tickless_Timer_Program_Alarm_Locked(timer, now);
+    }
+
+    timer->ops->unlock(timer->context, state);
+}
+
+void Tickless_Timer_Stop(Tickless_Timer *timer, Tickless_Timer_Event *event)
+{
+    uint32_t state = timer->ops->lock(timer->context);
+
+    if (event->pending)
+    {
+        uint8_t was_first = (timer->head == event);
+
+        Tickless_Timer_Remove_Locked(timer, event);
+
+        // Move the alarm to the new earliest deadline rather than take a useless interrupt
+        if (was_first)
+        {
+            Tickless_Timer_Program_Alarm_Locked(timer, Tickless_Timer_Extend_Locked(timer));
+        }
+    }
+
+    timer->ops->unlock(timer->context, state);
+}
+
+void Tickless_Timer_Handle_Alarm(Tickless_Timer *timer)
+{
+    uint32_t state = timer->ops->lock(timer->context);
+    uint64_t now = Tickless_Timer_Extend_Locked(timer);
+
+    timer->alarms++;
+
+    while ((timer->head != 0) && (timer->head->deadline <= now))
+    {
+        Tickless_Timer_Event *event = timer->head;
+
+        timer->head = event->next;
+        event->next = 0;
+        event->pending = 0;
+
+        if (event->period_ticks > 0)
+        {
+            event->deadline += event->period_ticks;
+
+            // Skip the periods that a late callback has missed, keeping the phase
+            if (event->deadline <= now)
+            {
+                uint64_t missed = (now - event->deadline) / event->period_ticks + 1;
+
+                event->deadline += missed * event->period_ticks;
+                timer->overruns += (uint32_t)missed;
+            }
+
+            Tickless_Timer_Insert_Locked(timer, event);
+        }
+
+        // The callback may start or stop events, which takes the lock again
+        if (event->callback != 0)
+        {
+            timer->callbacks++;
+            timer->ops->unlock(timer->context, state);
+            event->callback(event);
+            state = timer->ops->lock(timer->context);
+        }
+
+        now = Tickless_Timer_Extend_Locked(timer);
+    }
+
+    Tickless_Timer_Program_Alarm_Locked(timer, now);
+    timer->ops->unlock(timer->context, state);
+}
+
+void Tickless_Timer_Sleep(Tickless_Timer *timer, uint32_t delay_ticks)
+{
+    Tickless_Timer_Event wake;
+    uint64_t start = Tickless_Timer_Now(timer);
+
+    wake.pending = 0;
+    Tickless_Timer_Start(timer, &wake, delay_ticks, 0, 0, 0);
+
+    // The flag is checked with the lock held, so the alarm cannot fire between the check and the wait
+    uint32_t state = timer->ops->lock(timer->context);
+
+    while (wake.pending)
+    {
+        timer->ops->idle(timer->context);
+        timer->ops->unlock(timer->context, state);
+        state = timer->ops->lock(timer->context);
+    }
+
+    timer->ops->unlock(timer->context, state);
+
+    timer->idle_ticks += Tickless_Timer_Now(timer) - start;
+}
+
+void Tickless_Timer_Sleep_ms(Tickless_Timer *timer, uint32_t ms)
+{
+    Tickless_Timer_Sleep(timer, Tickless_Timer_Ticks_From_ms(timer, ms));
+}
+
+void Tickless_Timer_Sleep_us(Tickless_Timer *timer, uint32_t us)
+{
+    uint64_t ticks = (uint64_t)us * timer->ticks_per_ms / 1000;
+
+    Tickless_Timer_Sleep(timer, (ticks > UINT32_MAX) ? UINT32_MAX : (uint32_t)ticks);
+}
+
+void Tickless_Timer_Print_Stats(Tickless_Timer *timer)
+{
+    uint64_t now = Tickless_Timer_Now(timer);
+    uint32_t elapsed_ms = (uint32_t)(now / timer->ticks_per_ms);
+    uint32_t idle_ms = (uint32_t)(timer->idle_ticks / timer->ticks_per_ms);
+
+    // Alarm interrupts per second with two decimals, and the idle share in percent
+    uint32_t rate_x100 = (elapsed_ms > 0) ? (uint32_t)((uint64_t)timer->alarms * 100000 / elapsed_ms) : 0;
+    uint32_t idle_percent = (now > 0) ? (uint32_t)(timer->idle_ticks * 100 / now) : 0;
+
+    printf("timer: %lu alarms in %lu ms (%lu.%02lu per s), %lu callbacks, %lu ms idle (%lu%%)\n",
+           (unsigned long)timer->alarms, (unsigned long)elapsed_ms, (unsigned long)(rate_x100 / 100),
+           (unsigned long)(rate_x100 % 100), (unsigned long)timer->callbacks, (unsigned long)idle_ms,
+           (unsigned long)idle_percent);
+}
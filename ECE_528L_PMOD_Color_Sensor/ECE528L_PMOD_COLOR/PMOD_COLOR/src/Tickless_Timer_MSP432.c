@@ -0,0 +1,118 @@
+/**
+ * @file Tickless_Timer_MSP432.c
+ * @brief Source code for the Tickless_Timer_MSP432 backend.
+ *
+ * This file contains the function definitions for the Timer32 backend of the tickless timer service.
+ *
+ */
+
+#include "../inc/Tickless_Timer_MSP432.h"
+#include "../inc/Critical_Section.h"
+
+// Timer32 CONTROL register bits
+#define TIMER32_ONESHOT                         0x01
+#define TIMER32_SIZE_32BIT                      0x02
+#define TIMER32_PRESCALE_16                     0x04
+#define TIMER32_IE                              0x20
+#define TIMER32_ENABLE                          0x80
+
+// Service served by T32_INT2_IRQHandler, and the priority of the interrupt, which the lock masks
+static Tickless_Timer *Tickless_Timer_MSP432_Timer = 0;
+static uint32_t Tickless_Timer_MSP432_Priority = TICKLESS_TIMER_MSP432_PRIORITY;
+
+static uint32_t Tickless_Timer_MSP432_Now(void *context)
+{
+    (void)context;
+
+    // Timer32 counts down from 0xFFFFFFFF; its complement counts up
+    return ~TIMER32_1->VALUE;
+}
+
+static void Tickless_Timer_MSP432_Set_Alarm(void *context, uint32_t delay_ticks)
+{
+    (void)context;
+
+    // A load value of 0 would not count; the shortest alarm is one tick
+    TIMER32_2->CONTROL = 0;
+    TIMER32_2->INTCLR = 0;
+    TIMER32_2->LOAD = (delay_ticks > 0) ? delay_ticks : 1;
+    TIMER32_2->CONTROL = TIMER32_ENABLE | TIMER32_IE | TIMER32_PRESCALE_16 | TIMER32_SIZE_32BIT | TIMER32_ONESHOT;
+}
+
+static void Tickless_Timer_MSP432_Cancel_Alarm(void *context)
+{
+    (void)context;
+
+    TIMER32_2->CONTROL = 0;
+    TIMER32_2->INTCLR = 0;
+}
+
+static uint32_t Tickless_Timer_MSP432_Lock(void *context)
+{
+    (void)context;
+
+    return Critical_Section_Enter(Tickless_Timer_MSP432_Priority);
+}
+
+static void Tickless_Timer_MSP432_Unlock(void *context, uint32_t state)
+{
+    (void)context;
+
+    Critical_Section_Exit(state);
+}
+
+static void Tickless_Timer_MSP432_Idle(void *context)
+{
+    (void)context;
+
+    Critical_Section_Wait_For_Interrupt();
+}
+
+static const Tickless_Timer_Ops Tickless_Timer_MSP432_Ops =
+{
+    Tickless_Timer_MSP432_Now,
+    Tickless_Timer_MSP432_Set_Alarm,
+    Tickless_Timer_MSP432_Cancel_Alarm,
+    Tickless_Timer_MSP432_Lock,
+    Tickless_Timer_MSP432_Unlock,
+    Tickless_Timer_MSP432_Idle,
+};
+
+void Tickless_Timer_MSP432_Init(Tickless_Timer *timer, uint32_t priority)
+{
+    // Free-running counter: 32-bit, MCLK / 16, no interrupt
+    TIMER32_1->CONTROL = 0;
+    TIMER32_1->LOAD = 0xFFFFFFFF;
+    TIMER32_1->CONTROL = TIMER32_ENABLE | TIMER32_PRESCALE_16 | TIMER32_SIZE_32BIT;
+
+    // The alarm counter stays disabled until the first event
+    TIMER32_2->CONTROL = 0;
+    TIMER32_2->INTCLR = 0;
+
+    Tickless_Timer_MSP432_Timer = timer;
+    Tickless_Timer_MSP432_Priority = priority;
+    Tickless_Timer_Init(timer, &Tickless_Timer_MSP432_Ops, 0, TICKLESS_TIMER_MSP432_TICKS_PER_MS);
+
+    NVIC_SetPriority(T32_INT2_IRQn, priority);
+    NVIC_EnableIRQ(T32_INT2_IRQn);
+}
+
+/**
+ * @brief Interrupt service routine for the alarm of the tickless timer service.
+ *
+ * Clears the one-shot interrupt of Timer32_2 and runs the events that are due, which programs
+ * the alarm for the next deadline.
+ *
+ * @param None
+ *
+ * @return None
+ */
+void T32_INT2_IRQHandler(void)
+{
+    TIMER32_2->INTCLR = 0;
+
+    if (Tickless_Timer_MSP432_Timer != 0)
+    {
+        Tickless_Timer_Handle_Alarm(Tickless_Timer_MSP432_Timer);
+    }
+}
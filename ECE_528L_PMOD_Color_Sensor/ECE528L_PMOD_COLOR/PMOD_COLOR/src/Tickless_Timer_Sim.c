@@ -0,0 +1,153 @@
+/**
+ * @file Tickless_Timer_Sim.c
+ * @brief Source code for the Tickless_Timer_Sim backend.
+ *
+ * This file contains the function definitions for the simulated backend of the tickless timer service.
+ *
+ */
+
+#include "../inc/Tickless_Timer_Sim.h"
+
+// Takes the pending alarm interrupt when nothing masks it. An alarm raised by the handler itself is
+// taken right after it returns, as a tail-chained interrupt would be
+static void Tickless_Timer_Sim_Take_Interrupt(Tickless_Timer_Sim_Context *context)
+{
+    while (context->interrupt_pending && !context->locked && !context->in_interrupt)
+    {
+        context->interrupt_pending = 0;
+        context->interrupts++;
+        context->in_interrupt = 1;
+        Tickless_Timer_Handle_Alarm(context->timer);
+        context->in_interrupt = 0;
+    }
+}
+
+static uint32_t Tickless_Timer_Sim_Now(void *context)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+    uint32_t counter = (uint32_t)(sim->counter_start + sim->time);
+
+    // The interrupt of the hook runs after the value was read, before the caller uses it
+    if ((sim->hook != 0) && !sim->in_hook)
+    {
+        sim->in_hook = 1;
+        sim->hook(sim);
+        sim->in_hook = 0;
+    }
+
+    return counter;
+}
+
+static void Tickless_Timer_Sim_Set_Alarm(void *context, uint32_t delay_ticks)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+
+    // Like the Timer32 one-shot mode, the shortest alarm is one tick, and programming it clears
+    // an interrupt that has not been taken
+    sim->alarm_armed = 1;
+    sim->alarm_time = sim->time + ((delay_ticks > 0) ? delay_ticks : 1);
+    sim->interrupt_pending = 0;
+}
+
+static void Tickless_Timer_Sim_Cancel_Alarm(void *context)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+
+    sim->alarm_armed = 0;
+    sim->interrupt_pending = 0;
+}
+
+static uint32_t Tickless_Timer_Sim_Lock(void *context)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+    uint32_t state = sim->locked;
+
+    sim->locked = 1;
+    return state;
+}
+
+static void Tickless_Timer_Sim_Unlock(void *context, uint32_t state)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+
+    sim->locked = (uint8_t)state;
+    Tickless_Timer_Sim_Take_Interrupt(sim);
+}
+
+// Called with the lock held: jumps to the alarm and raises its interrupt, which the unlock takes
+static void Tickless_Timer_Sim_Idle(void *context)
+{
+    Tickless_Timer_Sim_Context *sim = (Tickless_Timer_Sim_Context *)context;
+
+    sim->idle_calls++;
+
+    if (sim->interrupt_pending || !sim->alarm_armed)
+    {
+        return;
+    }
+
+    if (sim->alarm_time > sim->time)
+    {
+        sim->idle_ticks += sim->alarm_time - sim->time;
+        sim->time = sim->alarm_time;
+    }
+
+    sim->alarm_armed = 0;
+    sim->interrupt_pending = 1;
+}
+
+static const Tickless_Timer_Ops Tickless_Timer_Sim_Ops =
+{
+    Tickless_Timer_Sim_Now,
+    Tickless_Timer_Sim_Set_Alarm,
+    Tickless_Timer_Sim_Cancel_Alarm,
+    Tickless_Timer_Sim_Lock,
+    Tickless_Timer_Sim_Unlock,
+    Tickless_Timer_Sim_Idle,
+};
+
+void Tickless_Timer_Sim_Init(Tickless_Timer *timer, Tickless_Timer_Sim_Context *context, uint32_t counter_start, uint32_t ticks_per_ms)
+{
+    context->time = 0;
+    context->counter_start = counter_start;
+    context->alarm_armed = 0;
+    context->alarm_time = 0;
+    context->interrupt_pending = 0;
+    context->locked = 0;
+    context->in_interrupt = 0;
+    context->timer = timer;
+    context->hook = 0;
+    context->hook_context = 0;
+    context->in_hook = 0;
+    context->interrupts = 0;
+    context->idle_calls = 0;
+    context->idle_ticks = 0;
+
+    Tickless_Timer_Init(timer, &Tickless_Timer_Sim_Ops, context, ticks_per_ms);
+}
+
+void Tickless_Timer_Sim_Advance(Tickless_Timer_Sim_Context *context, uint64_t ticks)
+{
+    uint64_t end = context->time + ticks;
+
+    while (1)
+    {
+        if (context->alarm_armed && (context->alarm_time <= end))
+        {
+            if (context->alarm_time > context->time)
+            {
+                context->time = context->alarm_time;
+            }
+
+            context->alarm_armed = 0;
+            context->interrupt_pending = 1;
+            Tickless_Timer_Sim_Take_Interrupt(context);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    context->time = end;
+}
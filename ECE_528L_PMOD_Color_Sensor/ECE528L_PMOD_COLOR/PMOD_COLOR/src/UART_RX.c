@@ -0,0 +1,184 @@
+/**
+ * @file UART_RX.c
+ * @brief Source code for the UART_RX module.
+ *
+ * This file contains the function definitions for the DMA receive buffer and the idle-line frames.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "../inc/UART_RX.h"
+
+void UART_RX_Init(UART_RX *rx, const UART_RX_Ops *ops, void *context, uint32_t idle_checks)
+{
+    rx->ops = ops;
+    rx->context = context;
+    rx->completed = 0;
+    rx->tail = 0;
+    rx->last_head = 0;
+    rx->quiet_checks = 0;
+    rx->idle_checks = (idle_checks > 0) ? idle_checks : 1;
+    rx->frame_end = 0;
+    rx->frames_head = 0;
+    rx->frames_tail = 0;
+    rx->frames = 0;
+    rx->dropped_frames = 0;
+    rx->overruns = 0;
+    rx->max_pending = 0;
+    rx->dma_interrupts = 0;
+    rx->checks = 0;
+
+    ops->arm(context, 0, &rx->buffer[0], UART_RX_HALF_SIZE);
+    ops->arm(context, 1, &rx->buffer[UART_RX_HALF_SIZE], UART_RX_HALF_SIZE);
+}
+
+uint32_t UART_RX_Head(UART_RX *rx)
+{
+    uint32_t completed;
+    uint8_t active;
+    uint32_t remaining;
+
+    // A DMA interrupt between the reads changes the count; read again
+    do
+    {
+        completed = rx->completed;
+        active = rx->ops->active_half(rx->context);
+        remaining = rx->ops->remaining(rx->context, active);
+    } while (completed != rx->completed);
+
+    // The DMA moved on to the next half before its interrupt counted the completed one. If it
+    // completes the active half between the two reads, the remaining 0 gives the end of that half
+    if (active != (completed & 1))
+    {
+        completed++;
+    }
+
+    return completed * UART_RX_HALF_SIZE + (UART_RX_HALF_SIZE - remaining);
+}
+
+void UART_RX_Handle_DMA(UART_RX *rx)
+{
+    uint8_t half = (uint8_t)(rx->completed & 1);
+
+    rx->dma_interrupts++;
+
+    // The DMA is filling the other half; this one is filled again after it
+    rx->ops->arm(rx->context, half, &rx->buffer[half * UART_RX_HALF_SIZE], UART_RX_HALF_SIZE);
+    rx->completed++;
+}
+
+void UART_RX_Check_Idle(UART_RX *rx)
+{
+    uint32_t head = UART_RX_Head(rx);
+
+    rx->checks++;
+
+    if (head != rx->last_head)
+    {
+        rx->last_head = head;
+        rx->quiet_checks = 0;
+        return;
+    }
+
+    // Nothing was received since the last frame ended, or the line has not been idle long enough
+    if ((head == rx->frame_end) || (++rx->quiet_checks < rx->idle_checks))
+    {
+        return;
+    }
+
+    rx->frame_end = head;
+
+    // With the queue full, the frame is merged into the next one
+    if ((rx->frames_head - rx->frames_tail) >= UART_RX_MAX_FRAMES)
+    {
+        rx->dropped_frames++;
+        return;
+    }
+
+    rx->frame_ends[rx->frames_head % UART_RX_MAX_FRAMES] = head;
+    rx->frames_head++;
+    rx->frames++;
+}
+
+uint32_t UART_RX_Available(UART_RX *rx)
+{
+    uint32_t available = UART_RX_Head(rx) - rx->tail;
+
+    return (available > UART_RX_BUFFER_SIZE) ? UART_RX_BUFFER_SIZE : available;
+}
+
+uint32_t UART_RX_Read(UART_RX *rx, uint8_t *data, uint32_t max)
+{
+    uint32_t tail = rx->tail;
+    uint32_t available = UART_RX_Head(rx) - tail;
+
+    // The DMA has overwritten the bytes that are more than a buffer behind
+    if (available > UART_RX_BUFFER_SIZE)
+    {
+        rx->overruns += available - UART_RX_BUFFER_SIZE;
+        tail += available - UART_RX_BUFFER_SIZE;
+        available = UART_RX_BUFFER_SIZE;
+    }
+
+    if (available > rx->max_pending)
+    {
+        rx->max_pending = available;
+    }
+
+    uint32_t count = (available < max) ? available : max;
+    uint32_t index = tail & (UART_RX_BUFFER_SIZE - 1);
+    uint32_t first = UART_RX_BUFFER_SIZE - index;
+
+    if (first > count)
+    {
+        first = count;
+    }
+
+    memcpy(data, &rx->buffer[index], first);
+    memcpy(data + first, &rx->buffer[0], count - first);
+
+    // Bytes that the DMA overwrote during the copy are lost too; they are the first ones
+    uint32_t behind = UART_RX_Head(rx) - tail;
+
+    if (behind > UART_RX_BUFFER_SIZE)
+    {
+        uint32_t lost = behind - UART_RX_BUFFER_SIZE;
+
+        if (lost > count)
+        {
+            lost = count;
+        }
+
+        memmove(data, data + lost, count - lost);
+        rx->overruns += lost;
+        rx->tail = tail + count;
+        return count - lost;
+    }
+
+    rx->tail = tail + count;
+    return count;
+}
+
+uint8_t UART_RX_Frame_Length(UART_RX *rx, uint32_t *length)
+{
+    if (rx->frames_tail == rx->frames_head)
+    {
+        return 0;
+    }
+
+    uint32_t end = rx->frame_ends[rx->frames_tail % UART_RX_MAX_FRAMES];
+
+    rx->frames_tail++;
+
+    // The bytes of the frame may have been read already, or lost to an overrun
+    *length = ((int32_t)(end - rx->tail) > 0) ? (end - rx->tail) : 0;
+    return 1;
+}
+
+void UART_RX_Print_Stats(UART_RX *rx)
+{
+    printf("uart rx: %lu bytes, %lu frames, %lu bytes lost, max %lu of %u bytes waiting, %lu dma interrupts, %lu idle checks\n",
+           (unsigned long)UART_RX_Head(rx), (unsigned long)rx->frames, (unsigned long)rx->overruns, (unsigned long)rx->max_pending,
+           UART_RX_BUFFER_SIZE, (unsigned long)rx->dma_interrupts, (unsigned long)rx->checks);
+}
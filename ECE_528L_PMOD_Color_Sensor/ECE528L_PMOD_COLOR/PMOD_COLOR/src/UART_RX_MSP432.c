@@ -0,0 +1,188 @@
+/**
+ * @file UART_RX_MSP432.c
+ * @brief Source code for the UART_RX_MSP432 backend.
+ *
+ * This file contains the function definitions for the µDMA and Timer_A1 backend of the UART receiver.
+ *
+ */
+
+#include "../inc/UART_RX_MSP432.h"
+
+// Fields of the µDMA control word: byte destination increment, no source increment, byte transfers,
+// arbitration after each transfer, the transfers minus one (Bits 13:4) and the cycle type (Bits 2:0)
+#define UART_RX_MSP432_DST_INC_BYTE             0x00000000
+#define UART_RX_MSP432_SRC_INC_NONE             0x0C000000
+#define UART_RX_MSP432_N_MINUS_1_SHIFT          4
+#define UART_RX_MSP432_N_MINUS_1_MASK           0x00003FF0
+#define UART_RX_MSP432_CYCLE_MASK               0x00000007
+#define UART_RX_MSP432_CYCLE_PING_PONG          0x00000003
+
+// Master enable of the µDMA (CFG), and the enable of a channel completion interrupt (INT1_SRCCFG)
+#define UART_RX_MSP432_DMA_MASTEN               0x00000001
+#define UART_RX_MSP432_DMA_INT_EN               0x00000020
+
+// Timer_A CTL and CCTL register bits
+#define TIMER_A_SSEL_SMCLK                      0x0200
+#define TIMER_A_MC_UP                           0x0010
+#define TIMER_A_CLR                             0x0004
+#define TIMER_A_CCIE                            0x0010
+#define TIMER_A_CCIFG                           0x0001
+
+// Timer_A1 clock in counts per microsecond
+#define UART_RX_MSP432_COUNTS_PER_US            12
+
+// Channel control structure of the µDMA
+typedef struct
+{
+    volatile const void *source_end;
+    volatile void *destination_end;
+    volatile uint32_t control;
+    uint32_t spare;
+} UART_RX_MSP432_Control;
+
+// Primary structures of the 8 channels, followed by their alternate structures; the µDMA requires
+// the table to be aligned on its size
+static UART_RX_MSP432_Control UART_RX_MSP432_Table[16] __attribute__((aligned(256)));
+
+// Receiver served by the interrupt handlers
+static UART_RX *UART_RX_MSP432_Receiver = 0;
+
+static volatile UART_RX_MSP432_Control *UART_RX_MSP432_Structure(uint8_t half)
+{
+    // The alternate table starts at the address given by the µDMA (ATLBASE)
+    if (half != 0)
+    {
+        return &((volatile UART_RX_MSP432_Control *)(uintptr_t)DMA_Control->ATLBASE)[UART_RX_MSP432_CHANNEL];
+    }
+
+    return &UART_RX_MSP432_Table[UART_RX_MSP432_CHANNEL];
+}
+
+static uint8_t UART_RX_MSP432_Active_Half(void *context)
+{
+    (void)context;
+
+    return (uint8_t)((DMA_Control->ALTSET >> UART_RX_MSP432_CHANNEL) & 1);
+}
+
+static uint32_t UART_RX_MSP432_Remaining(void *context, uint8_t half)
+{
+    uint32_t control = UART_RX_MSP432_Structure(half)->control;
+
+    (void)context;
+
+    // The µDMA writes the count back after each transfer, and stops the structure after the last one
+    if ((control & UART_RX_MSP432_CYCLE_MASK) == 0)
+    {
+        return 0;
+    }
+
+    return ((control & UART_RX_MSP432_N_MINUS_1_MASK) >> UART_RX_MSP432_N_MINUS_1_SHIFT) + 1;
+}
+
+static void UART_RX_MSP432_Arm(void *context, uint8_t half, uint8_t *destination, uint32_t length)
+{
+    volatile UART_RX_MSP432_Control *structure = UART_RX_MSP432_Structure(half);
+
+    (void)context;
+
+    structure->source_end = &EUSCI_A0->RXBUF;
+    structure->destination_end = destination + length - 1;
+    structure->control = UART_RX_MSP432_DST_INC_BYTE | UART_RX_MSP432_SRC_INC_NONE |
+                         ((length - 1) << UART_RX_MSP432_N_MINUS_1_SHIFT) | UART_RX_MSP432_CYCLE_PING_PONG;
+
+    // The channel stops when it reaches a structure that was not armed again in time
+    DMA_Control->ENASET = 1 << UART_RX_MSP432_CHANNEL;
+}
+
+static const UART_RX_Ops UART_RX_MSP432_Ops =
+{
+    UART_RX_MSP432_Active_Half,
+    UART_RX_MSP432_Remaining,
+    UART_RX_MSP432_Arm
+};
+
+void UART_RX_MSP432_Init(UART_RX *rx, uint32_t check_us, uint32_t idle_checks, uint32_t priority)
+{
+    if (check_us < 100) check_us = 100;
+    if (check_us > 5000) check_us = 5000;
+
+    // Configure the channel before its structures are armed: start with the primary structure, on
+    // single requests, at the default priority
+    DMA_Control->CFG = UART_RX_MSP432_DMA_MASTEN;
+    DMA_Control->CTLBASE = (uint32_t)(uintptr_t)UART_RX_MSP432_Table;
+    DMA_Control->ENACLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Control->ALTCLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Control->USEBURSTCLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Control->PRIOCLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Control->REQMASKCLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Channel->CH_SRCCFG[UART_RX_MSP432_CHANNEL] = UART_RX_MSP432_SOURCE;
+
+    UART_RX_MSP432_Receiver = rx;
+    UART_RX_Init(rx, &UART_RX_MSP432_Ops, 0, idle_checks);
+
+    // Route the completions of the channel to DMA_INT1
+    DMA_Channel->INT0_CLRFLG = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Channel->INT1_SRCCFG = UART_RX_MSP432_DMA_INT_EN | UART_RX_MSP432_CHANNEL;
+
+    // Count SMCLK in up mode to CCR[0], which ends each check period with the TA1_0 interrupt
+    TIMER_A1->CTL = TIMER_A_CLR;
+    TIMER_A1->EX0 = 0;
+    TIMER_A1->CCR[0] = (uint16_t)(check_us * UART_RX_MSP432_COUNTS_PER_US - 1);
+    TIMER_A1->CCTL[0] = TIMER_A_CCIE;
+    TIMER_A1->CTL = TIMER_A_SSEL_SMCLK | TIMER_A_MC_UP | TIMER_A_CLR;
+
+    NVIC_SetPriority(DMA_INT1_IRQn, priority);
+    NVIC_SetPriority(TA1_0_IRQn, priority);
+    NVIC_EnableIRQ(DMA_INT1_IRQn);
+    NVIC_EnableIRQ(TA1_0_IRQn);
+}
+
+void UART_RX_MSP432_Stop(void)
+{
+    NVIC_DisableIRQ(DMA_INT1_IRQn);
+    NVIC_DisableIRQ(TA1_0_IRQn);
+
+    TIMER_A1->CTL = 0;
+    TIMER_A1->CCTL[0] = 0;
+
+    DMA_Control->ENACLR = 1 << UART_RX_MSP432_CHANNEL;
+    DMA_Channel->INT1_SRCCFG = 0;
+    DMA_Channel->CH_SRCCFG[UART_RX_MSP432_CHANNEL] = 0;
+
+    UART_RX_MSP432_Receiver = 0;
+}
+
+/**
+ * @brief Interrupt service routine of the µDMA completions routed to DMA_INT1.
+ *
+ * @param None
+ *
+ * @return None
+ */
+void DMA_INT1_IRQHandler(void)
+{
+    DMA_Channel->INT0_CLRFLG = 1 << UART_RX_MSP432_CHANNEL;
+
+    if (UART_RX_MSP432_Receiver != 0)
+    {
+        UART_RX_Handle_DMA(UART_RX_MSP432_Receiver);
+    }
+}
+
+/**
+ * @brief Interrupt service routine of Timer_A1 CCR[0], which runs the idle checks.
+ *
+ * @param None
+ *
+ * @return None
+ */
+void TA1_0_IRQHandler(void)
+{
+    TIMER_A1->CCTL[0] &= ~TIMER_A_CCIFG;
+
+    if (UART_RX_MSP432_Receiver != 0)
+    {
+        UART_RX_Check_Idle(UART_RX_MSP432_Receiver);
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file UART_RX_Sim.c
+ * @brief Source code for the UART_RX_Sim backend.
+ *
+ * This file contains the function definitions for the simulated DMA backend of the UART receiver.
+ *
+ */
+
+#include "../inc/UART_RX_Sim.h"
+
+static uint8_t UART_RX_Sim_Active_Half(void *context)
+{
+    UART_RX_Sim_Context *sim = (UART_RX_Sim_Context *)context;
+
+    return sim->active;
+}
+
+static uint32_t UART_RX_Sim_Remaining(void *context, uint8_t half)
+{
+    UART_RX_Sim_Context *sim = (UART_RX_Sim_Context *)context;
+
+    return sim->armed[half] ? sim->remaining[half] : 0;
+}
+
+static void UART_RX_Sim_Arm(void *context, uint8_t half, uint8_t *destination, uint32_t length)
+{
+    UART_RX_Sim_Context *sim = (UART_RX_Sim_Context *)context;
+
+    sim->destination[half] = destination;
+    sim->length[half] = length;
+    sim->remaining[half] = length;
+    sim->armed[half] = 1;
+}
+
+static const UART_RX_Ops UART_RX_Sim_Ops =
+{
+    UART_RX_Sim_Active_Half,
+    UART_RX_Sim_Remaining,
+    UART_RX_Sim_Arm
+};
+
+void UART_RX_Sim_Init(UART_RX *rx, UART_RX_Sim_Context *context, uint32_t idle_checks)
+{
+    context->rx = rx;
+    context->armed[0] = 0;
+    context->armed[1] = 0;
+    context->active = 0;
+    context->interrupt_pending = 0;
+    context->received = 0;
+    context->lost = 0;
+
+    UART_RX_Init(rx, &UART_RX_Sim_Ops, context, idle_checks);
+}
+
+void UART_RX_Sim_Receive(UART_RX_Sim_Context *context, uint8_t byte)
+{
+    uint8_t half = context->active;
+
+    if (!context->armed[half])
+    {
+        context->lost++;
+        return;
+    }
+
+    context->destination[half][context->length[half] - context->remaining[half]] = byte;
+    context->remaining[half]--;
+    context->received++;
+
+    // The completed half stays stopped until the interrupt arms it again
+    if (context->remaining[half] == 0)
+    {
+        context->armed[half] = 0;
+        context->active = (uint8_t)(half ^ 1);
+        context->interrupt_pending++;
+    }
+}
+
+void UART_RX_Sim_Take_Interrupt(UART_RX_Sim_Context *context)
+{
+    while (context->interrupt_pending > 0)
+    {
+        context->interrupt_pending--;
+        UART_RX_Handle_DMA(context->rx);
+    }
+}
@@ -0,0 +1,23 @@
+/**
+ * @file main.c
+ * @brief Main source code for the resident UART bootloader.
+ *
+ * This project builds the bootloader image of sectors 0 and 1 of the main flash (see
+ * msp432p401r_boot.cmd). It links these files of ../PMOD_COLOR:
+ *   - src/Bootloader.c and src/Bootloader_MSP432.c: the protocol core and the MSP432 backend
+ *   - src/GPIO.c: the RGB LED, which turns blue while the bootloader serves the protocol
+ *   - system_msp432p401r.c: SystemInit, called by the reset entry
+ *
+ * The bootloader is programmed once with the CCS debugger. After that, the application is updated
+ * with host_tools/boot_update, and every reset goes through Bootloader_MSP432_Start, which checks the
+ * application before starting it (see Bootloader_MSP432.h).
+ *
+ */
+
+#include "msp.h"
+#include "../PMOD_COLOR/inc/Bootloader_MSP432.h"
+
+int main(void)
+{
+    Bootloader_MSP432_Start();
+}
@@ -0,0 +1,60 @@
+/******************************************************************************
+*
+* Linker command file for the resident UART bootloader on the MSP432P401R
+*
+* The bootloader (see ../PMOD_COLOR/inc/Bootloader_MSP432.h) is linked into
+* sectors 0 and 1 of the main flash, with its vector table at 0x00000000, so
+* that it runs after every reset. The application is linked separately by
+* ../PMOD_COLOR/msp432p401r.cmd, after the application header sector:
+*
+*   0x00000000 - 0x00001FFF   BOOT        this image
+*   0x00002000 - 0x00002FFF   APP_HEADER  magic, length and CRC-32 of the application
+*   0x00003000 - 0x0003FFFF   application
+*
+* The protocol core and the flash functions run from SRAM (.TI.ramfunc).
+*
+*****************************************************************************/
+
+MEMORY
+{
+    BOOT       (RX) : origin = 0x00000000, length = 0x00002000
+#ifdef  __TI_COMPILER_VERSION__
+#if     __TI_COMPILER_VERSION__ >= 15009000
+    ALIAS
+    {
+    SRAM_CODE  (RWX): origin = 0x01000000
+    SRAM_DATA  (RW) : origin = 0x20000000
+    } length = 0x00010000
+#else
+    SRAM_CODE  (RWX): origin = 0x01000000, length = 0x00010000
+    SRAM_DATA  (RW) : origin = 0x20000000, length = 0x00010000
+#endif
+#endif
+}
+
+/* --stack_size=512 is enough: the bootloader state is in .bss and no interrupt is enabled */
+
+SECTIONS
+{
+    .intvecs:   > 0x00000000
+    .text   :   > BOOT
+    .const  :   > BOOT
+    .cinit  :   > BOOT
+    .pinit  :   > BOOT
+    .init_array   :     > BOOT
+    .binit        : {}  > BOOT
+
+    .data   :   > SRAM_DATA
+    .bss    :   > SRAM_DATA
+    .sysmem :   > SRAM_DATA
+    .stack  :   > SRAM_DATA (HIGH)
+
+#ifdef  __TI_COMPILER_VERSION__
+#if     __TI_COMPILER_VERSION__ >= 15009000
+    .TI.ramfunc : {} load=BOOT, run=SRAM_CODE, table(BINIT)
+#endif
+#endif
+}
+
+/* Symbolic definition of the WDTCTL register for RTS */
+WDTCTL_SYM = 0x4000480C;
@@ -0,0 +1,67 @@
+/**
+ * @file startup_msp432p401r_boot_ccs.c
+ * @brief Vector table and reset entry of the resident UART bootloader.
+ *
+ * The table is linked at address 0x00000000 by msp432p401r_boot.cmd, so the processor takes its stack
+ * pointer and reset handler from here after every reset. The bootloader enables no interrupt, so
+ * only the processor exceptions are listed; they stop in Default_Handler for the debugger.
+ *
+ * The application has its own table (../PMOD_COLOR/startup_msp432p401r_ccs.c) at
+ * BOOTLOADER_APP_ADDRESS, which the bootloader selects with VTOR before starting it.
+ *
+ */
+
+#include <stdint.h>
+
+// Linker variable that marks the top of the stack
+extern unsigned long __STACK_END;
+
+// CCS C initialization routine, which calls main()
+extern void _c_int00(void);
+
+// System initialization of ../PMOD_COLOR/system_msp432p401r.c: halts the watchdog and sets the clocks
+extern void SystemInit(void);
+
+void Reset_Handler(void);
+void Default_Handler(void);
+
+#pragma RETAIN(interruptVectors)
+#pragma DATA_SECTION(interruptVectors, ".intvecs")
+void (* const interruptVectors[])(void) =
+{
+    (void (*)(void))((uint32_t)&__STACK_END),
+                                           /* The initial stack pointer */
+    Reset_Handler,                         /* The reset handler         */
+    Default_Handler,                       /* The NMI handler           */
+    Default_Handler,                       /* The hard fault handler    */
+    Default_Handler,                       /* The MPU fault handler     */
+    Default_Handler,                       /* The bus fault handler     */
+    Default_Handler,                       /* The usage fault handler   */
+    0,                                     /* Reserved                  */
+    0,                                     /* Reserved                  */
+    0,                                     /* Reserved                  */
+    0,                                     /* Reserved                  */
+    Default_Handler,                       /* SVCall handler            */
+    Default_Handler,                       /* Debug monitor handler     */
+    0,                                     /* Reserved                  */
+    Default_Handler,                       /* The PendSV handler        */
+    Default_Handler                        /* The SysTick handler       */
+};
+
+// Reset entry of the board: initializes the C environment of the bootloader, then calls main()
+void Reset_Handler(void)
+{
+    SystemInit();
+
+    // Jump to the CCS C Initialization Routine
+    __asm("    .global _c_int00\n"
+          "    b.w     _c_int00");
+}
+
+// Unexpected exception: stay here, preserving the state for the debugger
+void Default_Handler(void)
+{
+    while (1)
+    {
+    }
+}
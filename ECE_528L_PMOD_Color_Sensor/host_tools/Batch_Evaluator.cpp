@@ -0,0 +1,374 @@
+/**
+ * @file Batch_Evaluator.cpp
+ * @brief Scalar, SSE2 and AVX2 kernels of the batch evaluator.
+ *
+ */
+
+#include "Batch_Evaluator.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BATCH_EVALUATOR_X86
+#endif
+
+namespace
+{
+
+// Confusion matrix cells, indexed by label * 4 + predicted
+constexpr int CELLS = COLOR_CLASSIFIER_NUM_COLORS * COLOR_CLASSIFIER_NUM_COLORS;
+
+// Number of vectors accumulated in 16-bit lane counters before they are added to the result
+constexpr size_t FLUSH_VECTORS = 32768;
+
+void Classify_Scalar(const Color_Classifier_Params &params, const uint16_t *red, const uint16_t *green,
+                     const uint16_t *blue, uint8_t *colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        colors[i] = (uint8_t)Color_Classifier_Classify(&params, red[i], green[i], blue[i]);
+    }
+}
+
+void Confusion_Scalar(const Color_Classifier_Params &params, const Capture &capture, size_t begin, Batch_Result &result)
+{
+    for (size_t i = begin; i < capture.Size(); i++)
+    {
+        result.confusion[capture.label[i]][Color_Classifier_Classify(&params, capture.red[i], capture.green[i], capture.blue[i])]++;
+    }
+}
+
+#if defined(BATCH_EVALUATOR_X86)
+
+// ---------------------------------------------------------------------------------------------
+// SSE2: 8 samples per vector
+// ---------------------------------------------------------------------------------------------
+
+struct SSE2_Params
+{
+    __m128i green_margin;
+    __m128i yellow_min_rg;
+    __m128i yellow_max_blue;
+    __m128i red_margin;
+};
+
+__attribute__((target("sse2")))
+SSE2_Params SSE2_Load_Params(const Color_Classifier_Params &params)
+{
+    return { _mm_set1_epi16((short)params.green_margin), _mm_set1_epi16((short)params.yellow_min_rg),
+             _mm_set1_epi16((short)params.yellow_max_blue), _mm_set1_epi16((short)params.red_margin) };
+}
+
+// Unsigned a > b on 16-bit lanes
+__attribute__((target("sse2")))
+inline __m128i SSE2_Greater(__m128i a, __m128i b)
+{
+    const __m128i sign = _mm_set1_epi16((short)0x8000);
+    return _mm_cmpgt_epi16(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+}
+
+// Same rules and priority as Color_Classifier_Classify; red + margin saturates at 0xFFFF,
+// where the comparison with a 16-bit channel is false, as it is for the 32-bit sum
+__attribute__((target("sse2")))
+inline __m128i SSE2_Classify(__m128i r, __m128i g, __m128i b, const SSE2_Params &p)
+{
+    __m128i is_green = _mm_and_si128(SSE2_Greater(g, _mm_adds_epu16(r, p.green_margin)),
+                                     SSE2_Greater(g, _mm_adds_epu16(b, p.green_margin)));
+    __m128i is_yellow = _mm_and_si128(_mm_and_si128(SSE2_Greater(r, p.yellow_min_rg), SSE2_Greater(g, p.yellow_min_rg)),
+                                      SSE2_Greater(p.yellow_max_blue, b));
+    __m128i is_red = _mm_and_si128(SSE2_Greater(r, _mm_adds_epu16(g, p.red_margin)),
+                                   SSE2_Greater(r, _mm_adds_epu16(b, p.red_margin)));
+    __m128i color = _mm_set1_epi16(COLOR_UNKNOWN);
+
+    color = _mm_or_si128(_mm_and_si128(is_red, _mm_set1_epi16(COLOR_RED)), _mm_andnot_si128(is_red, color));
+    color = _mm_or_si128(_mm_and_si128(is_yellow, _mm_set1_epi16(COLOR_YELLOW)), _mm_andnot_si128(is_yellow, color));
+    color = _mm_andnot_si128(is_green, color);     // COLOR_GREEN is 0
+
+    return color;
+}
+
+__attribute__((target("sse2")))
+void Classify_SSE2(const Color_Classifier_Params &params, const uint16_t *red, const uint16_t *green,
+                   const uint16_t *blue, uint8_t *colors, size_t count)
+{
+    SSE2_Params p = SSE2_Load_Params(params);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i color = SSE2_Classify(_mm_loadu_si128((const __m128i *)(red + i)),
+                                      _mm_loadu_si128((const __m128i *)(green + i)),
+                                      _mm_loadu_si128((const __m128i *)(blue + i)), p);
+        _mm_storel_epi64((__m128i *)(colors + i), _mm_packus_epi16(color, color));
+    }
+
+    Classify_Scalar(params, red + i, green + i, blue + i, colors + i, count - i);
+}
+
+__attribute__((target("sse2")))
+void Confusion_SSE2(const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result)
+{
+    SSE2_Params p = SSE2_Load_Params(params);
+    size_t vectors = capture.Size() / 8;
+    size_t i = 0;
+
+    while (vectors > 0)
+    {
+        size_t block = std::min(vectors, FLUSH_VECTORS);
+        __m128i counters[CELLS];
+
+        for (int k = 0; k < CELLS; k++) counters[k] = _mm_setzero_si128();
+
+        for (size_t v = 0; v < block; v++, i += 8)
+        {
+            __m128i color = SSE2_Classify(_mm_loadu_si128((const __m128i *)(capture.red.data() + i)),
+                                          _mm_loadu_si128((const __m128i *)(capture.green.data() + i)),
+                                          _mm_loadu_si128((const __m128i *)(capture.blue.data() + i)), p);
+            __m128i label = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(capture.label.data() + i)), _mm_setzero_si128());
+            __m128i cell = _mm_or_si128(_mm_slli_epi16(label, 2), color);
+
+            // A matching lane is -1, so subtracting the comparison counts the lane
+            for (int k = 0; k < CELLS; k++) counters[k] = _mm_sub_epi16(counters[k], _mm_cmpeq_epi16(cell, _mm_set1_epi16((short)k)));
+        }
+
+        for (int k = 0; k < CELLS; k++)
+        {
+            alignas(16) uint16_t lanes[8];
+            _mm_store_si128((__m128i *)lanes, counters[k]);
+            for (uint16_t lane : lanes) result.confusion[k >> 2][k & 3] += lane;
+        }
+
+        vectors -= block;
+    }
+
+    Confusion_Scalar(params, capture, i, result);
+}
+
+// ---------------------------------------------------------------------------------------------
+// AVX2: 16 samples per vector
+// ---------------------------------------------------------------------------------------------
+
+struct AVX2_Params
+{
+    __m256i green_margin;
+    __m256i yellow_min_rg;
+    __m256i yellow_max_blue;
+    __m256i red_margin;
+};
+
+__attribute__((target("avx2")))
+AVX2_Params AVX2_Load_Params(const Color_Classifier_Params &params)
+{
+    return { _mm256_set1_epi16((short)params.green_margin), _mm256_set1_epi16((short)params.yellow_min_rg),
+             _mm256_set1_epi16((short)params.yellow_max_blue), _mm256_set1_epi16((short)params.red_margin) };
+}
+
+__attribute__((target("avx2")))
+inline __m256i AVX2_Greater(__m256i a, __m256i b)
+{
+    const __m256i sign = _mm256_set1_epi16((short)0x8000);
+    return _mm256_cmpgt_epi16(_mm256_xor_si256(a, sign), _mm256_xor_si256(b, sign));
+}
+
+__attribute__((target("avx2")))
+inline __m256i AVX2_Classify(__m256i r, __m256i g, __m256i b, const AVX2_Params &p)
+{
+    __m256i is_green = _mm256_and_si256(AVX2_Greater(g, _mm256_adds_epu16(r, p.green_margin)),
+                                        AVX2_Greater(g, _mm256_adds_epu16(b, p.green_margin)));
+    __m256i is_yellow = _mm256_and_si256(_mm256_and_si256(AVX2_Greater(r, p.yellow_min_rg), AVX2_Greater(g, p.yellow_min_rg)),
+                                         AVX2_Greater(p.yellow_max_blue, b));
+    __m256i is_red = _mm256_and_si256(AVX2_Greater(r, _mm256_adds_epu16(g, p.red_margin)),
+                                      AVX2_Greater(r, _mm256_adds_epu16(b, p.red_margin)));
+    __m256i color = _mm256_set1_epi16(COLOR_UNKNOWN);
+
+    color = _mm256_blendv_epi8(color, _mm256_set1_epi16(COLOR_RED), is_red);
+    color = _mm256_blendv_epi8(color, _mm256_set1_epi16(COLOR_YELLOW), is_yellow);
+    color = _mm256_andnot_si256(is_green, color);  // COLOR_GREEN is 0
+
+    return color;
+}
+
+__attribute__((target("avx2")))
+void Classify_AVX2(const Color_Classifier_Params &params, const uint16_t *red, const uint16_t *green,
+                   const uint16_t *blue, uint8_t *colors, size_t count)
+{
+    AVX2_Params p = AVX2_Load_Params(params);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i color = AVX2_Classify(_mm256_loadu_si256((const __m256i *)(red + i)),
+                                      _mm256_loadu_si256((const __m256i *)(green + i)),
+                                      _mm256_loadu_si256((const __m256i *)(blue + i)), p);
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(color), _mm256_extracti128_si256(color, 1));
+        _mm_storeu_si128((__m128i *)(colors + i), packed);
+    }
+
+    Classify_Scalar(params, red + i, green + i, blue + i, colors + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void Confusion_AVX2(const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result)
+{
+    AVX2_Params p = AVX2_Load_Params(params);
+    size_t vectors = capture.Size() / 16;
+    size_t i = 0;
+
+    while (vectors > 0)
+    {
+        size_t block = std::min(vectors, FLUSH_VECTORS);
+        __m256i counters[CELLS];
+
+        for (int k = 0; k < CELLS; k++) counters[k] = _mm256_setzero_si256();
+
+        for (size_t v = 0; v < block; v++, i += 16)
+        {
+            __m256i color = AVX2_Classify(_mm256_loadu_si256((const __m256i *)(capture.red.data() + i)),
+                                          _mm256_loadu_si256((const __m256i *)(capture.green.data() + i)),
+                                          _mm256_loadu_si256((const __m256i *)(capture.blue.data() + i)), p);
+            __m256i label = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(capture.label.data() + i)));
+            __m256i cell = _mm256_or_si256(_mm256_slli_epi16(label, 2), color);
+
+            for (int k = 0; k < CELLS; k++) counters[k] = _mm256_sub_epi16(counters[k], _mm256_cmpeq_epi16(cell, _mm256_set1_epi16((short)k)));
+        }
+
+        for (int k = 0; k < CELLS; k++)
+        {
+            alignas(32) uint16_t lanes[16];
+            _mm256_store_si256((__m256i *)lanes, counters[k]);
+            for (uint16_t lane : lanes) result.confusion[k >> 2][k & 3] += lane;
+        }
+
+        vectors -= block;
+    }
+
+    Confusion_Scalar(params, capture, i, result);
+}
+
+#endif
+
+int32_t Min3(int32_t a, int32_t b, int32_t c)
+{
+    return std::min(a, std::min(b, c));
+}
+
+}
+
+uint64_t Batch_Result::Total() const
+{
+    uint64_t total = 0;
+    for (const auto &row : confusion) for (uint64_t value : row) total += value;
+    return total;
+}
+
+double Batch_Result::Accuracy() const
+{
+    uint64_t correct = 0;
+    for (int color = 0; color < COLOR_CLASSIFIER_NUM_COLORS; color++) correct += confusion[color][color];
+    return Total() ? (double)correct / Total() : 0.0;
+}
+
+double Batch_Result::Precision(int color) const
+{
+    uint64_t predicted = 0;
+    for (int label = 0; label < COLOR_CLASSIFIER_NUM_COLORS; label++) predicted += confusion[label][color];
+    return predicted ? (double)confusion[color][color] / predicted : 0.0;
+}
+
+double Batch_Result::Recall(int color) const
+{
+    uint64_t labeled = 0;
+    for (int predicted = 0; predicted < COLOR_CLASSIFIER_NUM_COLORS; predicted++) labeled += confusion[color][predicted];
+    return labeled ? (double)confusion[color][color] / labeled : 0.0;
+}
+
+int32_t Batch_Result::Margin_Percentile(int label, double fraction) const
+{
+    uint64_t total = 0;
+    for (int bin = 0; bin < BATCH_MARGIN_BINS; bin++) total += margin[label][bin];
+
+    uint64_t target = (uint64_t)(fraction * total);
+    uint64_t sum = 0;
+
+    for (int bin = 0; bin < BATCH_MARGIN_BINS; bin++)
+    {
+        sum += margin[label][bin];
+        if (sum > target) return (bin << BATCH_MARGIN_BIN_SHIFT) - 65536;
+    }
+
+    return 65536 - (1 << BATCH_MARGIN_BIN_SHIFT);
+}
+
+bool Batch_Kernel_Supported(Batch_Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Batch_Kernel::Scalar: return true;
+#if defined(BATCH_EVALUATOR_X86)
+        case Batch_Kernel::SSE2: return __builtin_cpu_supports("sse2");
+        case Batch_Kernel::AVX2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+Batch_Kernel Batch_Best_Kernel()
+{
+    if (Batch_Kernel_Supported(Batch_Kernel::AVX2)) return Batch_Kernel::AVX2;
+    if (Batch_Kernel_Supported(Batch_Kernel::SSE2)) return Batch_Kernel::SSE2;
+    return Batch_Kernel::Scalar;
+}
+
+const char *Batch_Kernel_Name(Batch_Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Batch_Kernel::SSE2: return "sse2";
+        case Batch_Kernel::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void Batch_Classify(Batch_Kernel kernel, const Color_Classifier_Params &params,
+                    const uint16_t *red, const uint16_t *green, const uint16_t *blue, uint8_t *colors, size_t count)
+{
+#if defined(BATCH_EVALUATOR_X86)
+    if ((kernel == Batch_Kernel::AVX2) && Batch_Kernel_Supported(kernel)) return Classify_AVX2(params, red, green, blue, colors, count);
+    if ((kernel == Batch_Kernel::SSE2) && Batch_Kernel_Supported(kernel)) return Classify_SSE2(params, red, green, blue, colors, count);
+#endif
+    (void)kernel;
+    Classify_Scalar(params, red, green, blue, colors, count);
+}
+
+void Batch_Confusion(Batch_Kernel kernel, const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result)
+{
+#if defined(BATCH_EVALUATOR_X86)
+    if ((kernel == Batch_Kernel::AVX2) && Batch_Kernel_Supported(kernel)) return Confusion_AVX2(params, capture, result);
+    if ((kernel == Batch_Kernel::SSE2) && Batch_Kernel_Supported(kernel)) return Confusion_SSE2(params, capture, result);
+#endif
+    (void)kernel;
+    Confusion_Scalar(params, capture, 0, result);
+}
+
+void Batch_Margins(const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result)
+{
+    for (size_t i = 0; i < capture.Size(); i++)
+    {
+        int32_t r = capture.red[i];
+        int32_t g = capture.green[i];
+        int32_t b = capture.blue[i];
+
+        // A margin of 1 or more satisfies the rule, matching the strict comparisons of the classifier
+        int32_t margins[3];
+        margins[COLOR_GREEN] = std::min(g - r, g - b) - params.green_margin;
+        margins[COLOR_RED] = std::min(r - g, r - b) - params.red_margin;
+        margins[COLOR_YELLOW] = Min3(r - params.yellow_min_rg, g - params.yellow_min_rg, params.yellow_max_blue - b);
+
+        uint8_t label = capture.label[i];
+        int32_t value = (label == COLOR_UNKNOWN) ? std::max(margins[0], std::max(margins[1], margins[2])) : margins[label];
+        int32_t bin = (value + 65536) >> BATCH_MARGIN_BIN_SHIFT;
+
+        result.margin[label][std::min(std::max(bin, 0), BATCH_MARGIN_BINS - 1)]++;
+    }
+}
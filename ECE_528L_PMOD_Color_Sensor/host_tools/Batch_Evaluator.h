@@ -0,0 +1,72 @@
+/**
+ * @file Batch_Evaluator.h
+ * @brief Vectorized batch evaluation of the Color_Classifier over captures.
+ *
+ * The kernels implement Color_Classifier_Classify on 16-bit lanes: the sums of the firmware are replaced
+ * by saturating additions, which give the same comparison results because every channel is at most 0xFFFF,
+ * and unsigned comparisons are done as signed comparisons after flipping the sign bit. The results are
+ * bit-exact with the firmware for all inputs and parameters. The AVX2 kernel processes 16 samples per
+ * instruction and the SSE2 kernel 8; the scalar kernel calls Color_Classifier_Classify itself. The kernel
+ * is selected at run time, so one build runs on any x86 host; other hosts use the scalar kernel.
+ *
+ */
+
+#ifndef HOST_TOOLS_BATCH_EVALUATOR_H_
+#define HOST_TOOLS_BATCH_EVALUATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "inc/Color_Classifier.h"
+#include "Capture.h"
+
+enum class Batch_Kernel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Margin histogram: signed distance to the rule of the label in bins of 512 counts from -65536 to 65535
+constexpr int BATCH_MARGIN_BIN_SHIFT = 9;
+constexpr int BATCH_MARGIN_BINS = (2 * 65536) >> BATCH_MARGIN_BIN_SHIFT;
+
+struct Batch_Result
+{
+    // confusion[label][predicted], where label COLOR_UNKNOWN stands for none
+    uint64_t confusion[COLOR_CLASSIFIER_NUM_COLORS][COLOR_CLASSIFIER_NUM_COLORS] = {};
+
+    // margin[label][bin]: positive margins satisfy the rule of the label. For samples labeled none,
+    // the margin of the closest rule is used, so positive margins are false detections
+    uint64_t margin[COLOR_CLASSIFIER_NUM_COLORS][BATCH_MARGIN_BINS] = {};
+
+    uint64_t Total() const;
+    double Accuracy() const;
+    double Precision(int color) const;
+    double Recall(int color) const;
+
+    // Margin at the given fraction of the samples of a label, at the lower edge of its bin
+    int32_t Margin_Percentile(int label, double fraction) const;
+};
+
+bool Batch_Kernel_Supported(Batch_Kernel kernel);
+Batch_Kernel Batch_Best_Kernel();
+const char *Batch_Kernel_Name(Batch_Kernel kernel);
+
+/**
+ * @brief Classifies count samples into colors (Color_t values stored as bytes).
+ */
+void Batch_Classify(Batch_Kernel kernel, const Color_Classifier_Params &params,
+                    const uint16_t *red, const uint16_t *green, const uint16_t *blue, uint8_t *colors, size_t count);
+
+/**
+ * @brief Adds the confusion matrix of a capture to the result.
+ */
+void Batch_Confusion(Batch_Kernel kernel, const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result);
+
+/**
+ * @brief Adds the margin histograms of a capture to the result.
+ */
+void Batch_Margins(const Color_Classifier_Params &params, const Capture &capture, Batch_Result &result);
+
+#endif /* HOST_TOOLS_BATCH_EVALUATOR_H_ */
@@ -0,0 +1,651 @@
+/**
+ * @file Board_Decoder.cpp
+ * @brief Incremental decoder of the text lines and binary frames sent by a board.
+ *
+ */
+
+#include "Board_Decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+uint16_t Get_U16(const uint8_t *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+uint32_t Get_U32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+bool Expect(const char *&cursor, const char *end, const char *text, size_t length)
+{
+    if (((size_t)(end - cursor) < length) || (std::memcmp(cursor, text, length) != 0)) return false;
+    cursor += length;
+    return true;
+}
+
+template <size_t N>
+bool Expect(const char *&cursor, const char *end, const char (&text)[N])
+{
+    return Expect(cursor, end, text, N - 1);
+}
+
+bool Equals(const char *line, size_t length, std::string_view text)
+{
+    return (length == text.size()) && (std::memcmp(line, text.data(), length) == 0);
+}
+
+// Parses 1 to 4 hexadecimal digits
+bool Parse_Hex(const char *&cursor, const char *end, uint16_t &value)
+{
+    uint32_t result = 0;
+    int digits = 0;
+
+    while ((cursor < end) && (digits < 5))
+    {
+        char c = *cursor;
+        uint32_t digit;
+
+        if ((c >= '0') && (c <= '9')) digit = c - '0';
+        else if ((c >= 'a') && (c <= 'f')) digit = c - 'a' + 10;
+        else if ((c >= 'A') && (c <= 'F')) digit = c - 'A' + 10;
+        else break;
+
+        result = (result << 4) | digit;
+        digits++;
+        cursor++;
+    }
+
+    value = (uint16_t)result;
+    return (digits >= 1) && (digits <= 4);
+}
+
+// Parses a decimal number of at most 10 digits that fits in 32 bits
+bool Parse_Decimal(const char *&cursor, const char *end, uint32_t &value)
+{
+    uint64_t result = 0;
+    int digits = 0;
+
+    while ((cursor < end) && (*cursor >= '0') && (*cursor <= '9') && (digits < 11))
+    {
+        result = result * 10 + (uint32_t)(*cursor - '0');
+        digits++;
+        cursor++;
+    }
+
+    value = (uint32_t)result;
+    return (digits >= 1) && (result <= UINT32_MAX);
+}
+
+// Parses a decimal number that fits in 16 bits
+bool Parse_Decimal(const char *&cursor, const char *end, uint16_t &value)
+{
+    uint32_t result;
+
+    if (!Parse_Decimal(cursor, end, result) || (result > UINT16_MAX)) return false;
+    value = (uint16_t)result;
+    return true;
+}
+
+// COBS decoding in place. Returns the decoded length, or -1 if the codes do not match the length.
+long COBS_Decode(uint8_t *data, size_t length)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < length)
+    {
+        uint8_t code = data[in++];
+
+        if ((code == 0) || (in + code - 1 > length)) return -1;
+
+        for (uint8_t i = 1; i < code; i++) data[out++] = data[in++];
+
+        if ((code < 0xFF) && (in < length)) data[out++] = 0;
+    }
+
+    return (long)out;
+}
+
+}
+
+void Board_Decoder::Feed(uint8_t *data, size_t size, uint64_t receive_time_us)
+{
+    cursor = data;
+    end = data + size;
+    time_us = receive_time_us;
+    counters.bytes += size;
+}
+
+void Board_Decoder::Reset()
+{
+    mode = Mode::Text;
+    carry_length = 0;
+    overflow = false;
+    has_sequence = false;
+    rate_lines = {};
+    reaction_lines = {};
+}
+
+bool Board_Decoder::Next(Board_Event &event)
+{
+    while (cursor < end)
+    {
+        // Text lines end at '\n'; a 0x00 starts a frame. Frames end at the next 0x00.
+        uint8_t *stop;
+
+        if (mode == Mode::Text)
+        {
+            uint8_t *newline = (uint8_t *)std::memchr(cursor, '\n', end - cursor);
+            uint8_t *search_end = newline ? newline : end;
+            uint8_t *delimiter = (uint8_t *)std::memchr(cursor, BOARD_PROTOCOL_DELIMITER, search_end - cursor);
+            stop = delimiter ? delimiter : search_end;
+        }
+        else
+        {
+            stop = (uint8_t *)std::memchr(cursor, BOARD_PROTOCOL_DELIMITER, end - cursor);
+            if (!stop) stop = end;
+        }
+
+        uint8_t *chunk = cursor;
+        size_t chunk_length = stop - cursor;
+        bool complete = (stop < end);
+        size_t capacity = (mode == Mode::Text) ? BOARD_DECODER_LINE_CAPACITY : BOARD_PROTOCOL_MAX_FRAME;
+
+        cursor = complete ? stop + 1 : end;
+
+        // A line or frame that started in an earlier buffer, or that does not end in this one, goes
+        // through the carry buffer; everything else is decoded where it is
+        uint8_t *item = chunk;
+        size_t length = chunk_length;
+
+        if (overflow || (carry_length + chunk_length > capacity))
+        {
+            overflow = true;
+        }
+        else if ((carry_length > 0) || !complete)
+        {
+            std::memcpy(carry + carry_length, chunk, chunk_length);
+            carry_length += chunk_length;
+            item = carry;
+            length = carry_length;
+        }
+
+        if (!complete)
+        {
+            if (overflow && (mode == Mode::Frame))
+            {
+                // Not a frame after all: resume with text at the next line
+                counters.overlong++;
+                mode = Mode::Text;
+                carry_length = 0;
+                overflow = false;
+            }
+            return false;
+        }
+
+        bool was_overflow = overflow;
+        carry_length = 0;
+        overflow = false;
+
+        if (mode == Mode::Text)
+        {
+            if (*stop == BOARD_PROTOCOL_DELIMITER)
+            {
+                // Text before a frame without a line ending is dropped
+                mode = Mode::Frame;
+                continue;
+            }
+
+            counters.lines++;
+
+            if (was_overflow)
+            {
+                counters.overlong++;
+                continue;
+            }
+
+            if ((length > 0) && (item[length - 1] == '\r')) length--;
+            if (Decode_Line((char *)item, length, event)) return true;
+        }
+        else
+        {
+            // An empty frame is the start delimiter following the end delimiter of the previous frame
+            if ((length == 0) && !was_overflow) continue;
+
+            if (was_overflow)
+            {
+                counters.overlong++;
+                continue;
+            }
+
+            // After a valid frame, text follows. After an invalid one, this delimiter may have been the
+            // start of the next frame, so the decoder stays in frame mode
+            if (Decode_Frame(item, length, event))
+            {
+                mode = Mode::Text;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool Board_Decoder::Decode_Frame(uint8_t *frame, size_t length, Board_Event &event)
+{
+    long decoded = COBS_Decode(frame, length);
+
+    if ((decoded < 4) || (Board_Protocol_CRC16(frame, (uint16_t)(decoded - 2)) != Get_U16(frame + decoded - 2)))
+    {
+        counters.crc_errors++;
+        return false;
+    }
+
+    const uint8_t *body = frame + 2;
+    size_t body_length = (size_t)decoded - 4;
+
+    counters.frames++;
+
+    if (has_sequence && (frame[1] != next_sequence)) counters.lost_frames += (uint8_t)(frame[1] - next_sequence);
+    has_sequence = true;
+    next_sequence = (uint8_t)(frame[1] + 1);
+
+    event.binary = true;
+    event.frame_type = frame[0];
+    event.sequence = frame[1];
+    event.time_us = time_us;
+    event.raw = std::string_view((const char *)body, body_length);
+
+    switch (frame[0])
+    {
+        case BOARD_PROTOCOL_SAMPLE:
+            if (body_length != BOARD_PROTOCOL_SAMPLE_SIZE) break;
+            event.type = Board_Event_Type::Sample;
+            event.sample.time_ms = Get_U32(body);
+            event.sample.red = Get_U16(body + 4);
+            event.sample.green = Get_U16(body + 6);
+            event.sample.blue = Get_U16(body + 8);
+            event.sample.clear = Get_U16(body + 10);
+            counters.samples++;
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_DETECTION:
+            if ((body_length != BOARD_PROTOCOL_DETECTION_SIZE) || (body[0] >= COLOR_CLASSIFIER_NUM_COLORS)) break;
+            event.type = Board_Event_Type::Detection;
+            event.color = (Color_t)body[0];
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_GAME:
+            if ((body_length != BOARD_PROTOCOL_GAME_SIZE) || (body[0] > SIMON_GAME_MISS)) break;
+            event.type = Board_Event_Type::Game;
+            event.game_result = body[0];
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_RATE_STATS:
+            if (body_length != BOARD_PROTOCOL_RATE_STATS_SIZE) break;
+            event.type = Board_Event_Type::Rate_Stats;
+            event.rate_stats.idle_samples = Get_U32(body);
+            event.rate_stats.idle_ms = Get_U32(body + 4);
+            event.rate_stats.burst_samples = Get_U32(body + 8);
+            event.rate_stats.burst_ms = Get_U32(body + 12);
+            event.rate_stats.bursts = Get_U32(body + 16);
+            event.rate_stats.adaptive_uJ = Get_U32(body + 20);
+            event.rate_stats.fixed_uJ = Get_U32(body + 24);
+            event.rate_stats.total_ms = Get_U32(body + 28);
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_REACTION:
+            if ((body_length != BOARD_PROTOCOL_REACTION_SIZE) || (body[0] == 0)) break;
+            event.type = Board_Event_Type::Reaction;
+            event.reaction.step = body[0];
+            event.reaction.since_start_ms = Get_U32(body + 1);
+            event.reaction.reaction_ms = Get_U32(body + 5);
+            event.reaction.pipeline_ms = Get_U32(body + 9);
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_REACTION_STATS:
+            if (body_length != BOARD_PROTOCOL_REACTION_STATS_SIZE) break;
+            event.type = Board_Event_Type::Reaction_Stats;
+            event.reaction_stats.steps = Get_U32(body);
+            event.reaction_stats.reaction_mean_ms = Get_U16(body + 4);
+            event.reaction_stats.reaction_p50_ms = Get_U16(body + 6);
+            event.reaction_stats.reaction_p90_ms = Get_U16(body + 8);
+            event.reaction_stats.pipeline_mean_ms = Get_U16(body + 10);
+            event.reaction_stats.pipeline_p90_ms = Get_U16(body + 12);
+            event.reaction_stats.rounds = Get_U16(body + 14);
+            event.reaction_stats.fails = Get_U16(body + 16);
+            event.reaction_stats.misses = Get_U16(body + 18);
+            event.reaction_stats.round_mean_ms = Get_U32(body + 20);
+            event.reaction_stats.best_round_ms = Get_U32(body + 24);
+            counters.events++;
+            return true;
+
+        case BOARD_PROTOCOL_PC_SAMPLES:
+        {
+            if (body_length < BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE) break;
+
+            bool has_lr = (body[0] & BOARD_PROTOCOL_PC_SAMPLES_LR) != 0;
+            size_t sample_size = has_lr ? 8 : 4;
+            size_t count = (body_length - BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE) / sample_size;
+
+            if ((count * sample_size != body_length - BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE) ||
+                (count > (has_lr ? BOARD_PROTOCOL_PC_SAMPLES_MAX_LR : BOARD_PROTOCOL_PC_SAMPLES_MAX))) break;
+
+            event.type = Board_Event_Type::PC_Samples;
+            event.pc_samples.count = (uint8_t)count;
+            event.pc_samples.has_lr = has_lr;
+            event.pc_samples.dropped = Get_U16(body + 1);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t *sample = body + BOARD_PROTOCOL_PC_SAMPLES_HEADER_SIZE + i * sample_size;
+
+                event.pc_samples.pc[i] = Get_U32(sample);
+                event.pc_samples.lr[i] = has_lr ? Get_U32(sample + 4) : 0;
+            }
+
+            counters.events++;
+            return true;
+        }
+
+        case BOARD_PROTOCOL_I2C_TRACE:
+        {
+            if (body_length < BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE) break;
+
+            size_t count = (body_length - BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE) / BOARD_PROTOCOL_I2C_TRANSFER_SIZE;
+
+            if ((count * BOARD_PROTOCOL_I2C_TRANSFER_SIZE != body_length - BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE) ||
+                (count > BOARD_PROTOCOL_I2C_TRACE_MAX)) break;
+
+            event.type = Board_Event_Type::I2C_Trace;
+            event.i2c_trace.count = (uint8_t)count;
+            event.i2c_trace.dropped = Get_U16(body);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const uint8_t *transfer = body + BOARD_PROTOCOL_I2C_TRACE_HEADER_SIZE + i * BOARD_PROTOCOL_I2C_TRANSFER_SIZE;
+
+                event.i2c_trace.transfers[i].start_us = Get_U32(transfer);
+                event.i2c_trace.transfers[i].duration_us = Get_U16(transfer + 4);
+                event.i2c_trace.transfers[i].address = transfer[6];
+                event.i2c_trace.transfers[i].write_length = transfer[7];
+                event.i2c_trace.transfers[i].read_length = transfer[8];
+                event.i2c_trace.transfers[i].status = (int8_t)transfer[9];
+            }
+
+            counters.events++;
+            return true;
+        }
+
+        case BOARD_PROTOCOL_SUMMARY:
+        {
+            if (body_length != BOARD_PROTOCOL_SUMMARY_SIZE) break;
+
+            event.type = Board_Event_Type::Summary;
+            event.summary.start_ms = Get_U32(body);
+            event.summary.window_ms = Get_U16(body + 4);
+            event.summary.samples = Get_U16(body + 6);
+            event.summary.raw_samples = Get_U16(body + 8);
+
+            for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CHANNELS; i++)
+            {
+                const uint8_t *channel = body + 10 + i * 10;
+
+                event.summary.min[i] = Get_U16(channel);
+                event.summary.max[i] = Get_U16(channel + 2);
+                event.summary.mean[i] = Get_U16(channel + 4);
+                event.summary.variance[i] = Get_U32(channel + 6);
+            }
+
+            for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+            {
+                event.summary.classes[i] = Get_U16(body + 50 + i * 2);
+            }
+
+            counters.events++;
+            return true;
+        }
+
+        default:
+            event.type = Board_Event_Type::Unknown_Frame;
+            counters.events++;
+            return true;
+    }
+
+    // Known type with an invalid body. The frame itself was valid, so text follows.
+    counters.malformed++;
+    mode = Mode::Text;
+    return false;
+}
+
+bool Board_Decoder::Decode_Line(char *line, size_t length, Board_Event &event)
+{
+    const char *end_of_line = line + length;
+    const char *position = line;
+
+    if (length == 0) return false;
+
+    event.binary = false;
+    event.frame_type = 0;
+    event.sequence = 0;
+    event.time_us = time_us;
+    event.raw = std::string_view(line, length);
+
+    if (Expect(position, end_of_line, "r="))
+    {
+        uint16_t red, green, blue;
+
+        if (Parse_Hex(position, end_of_line, red) && Expect(position, end_of_line, " g=") && Parse_Hex(position, end_of_line, green) &&
+            Expect(position, end_of_line, " b=") && Parse_Hex(position, end_of_line, blue) && (position == end_of_line))
+        {
+            event.type = Board_Event_Type::Sample;
+            event.sample = { red, green, blue, 0, 0 };
+            counters.samples++;
+            counters.events++;
+            return true;
+        }
+
+        counters.malformed++;
+        return false;
+    }
+
+    static const struct
+    {
+        std::string_view text;
+        Board_Event_Type type;
+        int value;
+    } KNOWN_LINES[] =
+    {
+        { "GREEN", Board_Event_Type::Detection, COLOR_GREEN },
+        { "RED", Board_Event_Type::Detection, COLOR_RED },
+        { "YELLOW", Board_Event_Type::Detection, COLOR_YELLOW },
+        { "Correct step!", Board_Event_Type::Game, SIMON_GAME_STEP },
+        { "ACCESS GRANTED!", Board_Event_Type::Game, SIMON_GAME_COMPLETE },
+        { "Wrong! Restarting...", Board_Event_Type::Game, SIMON_GAME_WRONG },
+        { "Miss! Keep going...", Board_Event_Type::Game, SIMON_GAME_MISS },
+    };
+
+    for (const auto &known : KNOWN_LINES)
+    {
+        if (Equals(line, length, known.text))
+        {
+            event.type = known.type;
+            if (known.type == Board_Event_Type::Detection) event.color = (Color_t)known.value;
+            else event.game_result = known.value;
+            counters.events++;
+            return true;
+        }
+    }
+
+    if ((length > 5) && (std::memcmp(line, "rate ", 5) == 0))
+    {
+        return Decode_Rate_Line(line, length, event);
+    }
+
+    if ((length > 9) && (std::memcmp(line, "reaction ", 9) == 0))
+    {
+        return Decode_Reaction_Line(line, length, event);
+    }
+
+    if ((length > 5) && (std::memcmp(line, "step ", 5) == 0))
+    {
+        return Decode_Step_Line(line, length, event);
+    }
+
+    event.type = Board_Event_Type::Text;
+    counters.events++;
+    return true;
+}
+
+// The three lines printed by Adaptive_Rate_Print_Stats:
+//   rate idle: N samples, T ms
+//   rate burst: N samples, T ms, B bursts
+//   rate energy: A uJ adaptive, F uJ fixed over T ms (P% saved)
+// The event is returned with the last line.
+bool Board_Decoder::Decode_Rate_Line(const char *line, size_t length, Board_Event &event)
+{
+    const char *end_of_line = line + length;
+    const char *position = line;
+    Board_Protocol_Rate_Stats &stats = rate_lines;
+    uint32_t percent;
+
+    if (Expect(position, end_of_line, "rate idle: "))
+    {
+        if (Parse_Decimal(position, end_of_line, stats.idle_samples) && Expect(position, end_of_line, " samples, ") &&
+            Parse_Decimal(position, end_of_line, stats.idle_ms) && Expect(position, end_of_line, " ms") && (position == end_of_line))
+        {
+            return false;
+        }
+    }
+    else if (Expect(position, end_of_line, "rate burst: "))
+    {
+        if (Parse_Decimal(position, end_of_line, stats.burst_samples) && Expect(position, end_of_line, " samples, ") &&
+            Parse_Decimal(position, end_of_line, stats.burst_ms) && Expect(position, end_of_line, " ms, ") &&
+            Parse_Decimal(position, end_of_line, stats.bursts) && Expect(position, end_of_line, " bursts") && (position == end_of_line))
+        {
+            return false;
+        }
+    }
+    else if (Expect(position, end_of_line, "rate energy: "))
+    {
+        if (Parse_Decimal(position, end_of_line, stats.adaptive_uJ) && Expect(position, end_of_line, " uJ adaptive, ") &&
+            Parse_Decimal(position, end_of_line, stats.fixed_uJ) && Expect(position, end_of_line, " uJ fixed over ") &&
+            Parse_Decimal(position, end_of_line, stats.total_ms) && Expect(position, end_of_line, " ms (") &&
+            Parse_Decimal(position, end_of_line, percent) && Expect(position, end_of_line, "% saved)") && (position == end_of_line))
+        {
+            event.type = Board_Event_Type::Rate_Stats;
+            event.rate_stats = stats;
+            stats = {};
+            counters.events++;
+            return true;
+        }
+    }
+    else
+    {
+        // Some other line that starts with "rate "
+        event.type = Board_Event_Type::Text;
+        counters.events++;
+        return true;
+    }
+
+    counters.malformed++;
+    return false;
+}
+
+// The line printed by main.c for every accepted color:
+//   step N: S ms after the pattern, R ms reaction, P ms pipeline
+bool Board_Decoder::Decode_Step_Line(const char *line, size_t length, Board_Event &event)
+{
+    const char *end_of_line = line + length;
+    const char *position = line;
+    Reaction_Step &step = event.reaction;
+    uint32_t number;
+
+    if (Expect(position, end_of_line, "step ") && Parse_Decimal(position, end_of_line, number) && (number >= 1) && (number <= UINT8_MAX) &&
+        Expect(position, end_of_line, ": ") && Parse_Decimal(position, end_of_line, step.since_start_ms) &&
+        Expect(position, end_of_line, " ms after the pattern, ") && Parse_Decimal(position, end_of_line, step.reaction_ms) &&
+        Expect(position, end_of_line, " ms reaction, ") && Parse_Decimal(position, end_of_line, step.pipeline_ms) &&
+        Expect(position, end_of_line, " ms pipeline") && (position == end_of_line))
+    {
+        event.type = Board_Event_Type::Reaction;
+        step.step = (uint8_t)number;
+        counters.events++;
+        return true;
+    }
+
+    counters.malformed++;
+    return false;
+}
+
+// The three lines printed by Reaction_Stats_Print:
+//   reaction steps: N, mean M ms, p50 X ms, p90 Y ms
+//   reaction pipeline: mean M ms, p90 Y ms
+//   reaction rounds: N complete, F failed, M misses, mean T ms, best B ms
+// The event is returned with the last line.
+bool Board_Decoder::Decode_Reaction_Line(const char *line, size_t length, Board_Event &event)
+{
+    const char *end_of_line = line + length;
+    const char *position = line;
+    Reaction_Summary &summary = reaction_lines;
+
+    if (Expect(position, end_of_line, "reaction steps: "))
+    {
+        if (Parse_Decimal(position, end_of_line, summary.steps) && Expect(position, end_of_line, ", mean ") &&
+            Parse_Decimal(position, end_of_line, summary.reaction_mean_ms) && Expect(position, end_of_line, " ms, p50 ") &&
+            Parse_Decimal(position, end_of_line, summary.reaction_p50_ms) && Expect(position, end_of_line, " ms, p90 ") &&
+            Parse_Decimal(position, end_of_line, summary.reaction_p90_ms) && Expect(position, end_of_line, " ms") && (position == end_of_line))
+        {
+            return false;
+        }
+    }
+    else if (Expect(position, end_of_line, "reaction pipeline: mean "))
+    {
+        if (Parse_Decimal(position, end_of_line, summary.pipeline_mean_ms) && Expect(position, end_of_line, " ms, p90 ") &&
+            Parse_Decimal(position, end_of_line, summary.pipeline_p90_ms) && Expect(position, end_of_line, " ms") && (position == end_of_line))
+        {
+            return false;
+        }
+    }
+    else if (Expect(position, end_of_line, "reaction rounds: "))
+    {
+        uint32_t rounds, fails, misses;
+
+        if (Parse_Decimal(position, end_of_line, rounds) && Expect(position, end_of_line, " complete, ") &&
+            Parse_Decimal(position, end_of_line, fails) && Expect(position, end_of_line, " failed, ") &&
+            Parse_Decimal(position, end_of_line, misses) && Expect(position, end_of_line, " misses, mean ") &&
+            Parse_Decimal(position, end_of_line, summary.round_mean_ms) && Expect(position, end_of_line, " ms, best ") &&
+            Parse_Decimal(position, end_of_line, summary.best_round_ms) && Expect(position, end_of_line, " ms") && (position == end_of_line))
+        {
+            // The counts are saturated as in the REACTION_STATS frame
+            summary.rounds = (uint16_t)std::min<uint32_t>(rounds, UINT16_MAX);
+            summary.fails = (uint16_t)std::min<uint32_t>(fails, UINT16_MAX);
+            summary.misses = (uint16_t)std::min<uint32_t>(misses, UINT16_MAX);
+            event.type = Board_Event_Type::Reaction_Stats;
+            event.reaction_stats = summary;
+            summary = {};
+            counters.events++;
+            return true;
+        }
+    }
+    else
+    {
+        // Some other line that starts with "reaction "
+        event.type = Board_Event_Type::Text;
+        counters.events++;
+        return true;
+    }
+
+    counters.malformed++;
+    return false;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file Board_Decoder.h
+ * @brief Host SDK for the serial output of a board: decodes text lines and binary frames into typed events.
+ *
+ * A board prints text lines with printf and may also send the binary frames of Board_Protocol.h on the
+ * same UART. Board_Decoder takes the received bytes in buffers of any size and turns both into
+ * Board_Event values:
+ *   r=XXXX g=XXXX b=XXXX, or a SAMPLE frame                   Sample
+ *   GREEN, RED, YELLOW, or a DETECTION frame                  Detection
+ *   Correct step!, ACCESS GRANTED!, Wrong! Restarting...,
+ *   Miss! Keep going..., or a GAME frame                      Game
+ *   the three "rate ..." lines of Adaptive_Rate_Print_Stats,
+ *   or a RATE_STATS frame                                     Rate_Stats
+ *   step N: ... ms pipeline, or a REACTION frame              Reaction
+ *   the three "reaction ..." lines of Reaction_Stats_Print,
+ *   or a REACTION_STATS frame                                 Reaction_Stats
+ *   a PC_SAMPLES frame (see PC_Sampler.h)                     PC_Samples
+ *   an I2C_TRACE frame (see I2C_Trace.h)                      I2C_Trace
+ *   a SUMMARY frame (see Sample_Summary.h)                    Summary
+ *   any other text line                                       Text
+ *   a valid frame of an unknown type                          Unknown_Frame
+ *
+ * Decoding is zero-copy: the raw view of an event points into the buffer passed to Feed, and binary
+ * frames are COBS decoded in place in that buffer. Only a line or frame that is split across two
+ * buffers is copied, into a small buffer of the decoder. Views are valid until the next call to Next,
+ * Feed or Decode.
+ *
+ * Two APIs are offered:
+ *   - Synchronous: Feed a buffer, then call Next until it returns false.
+ *   - Callbacks: Decode calls a handler for every event. When the handler returns false, decoding
+ *     stops after that event and Decode returns the number of bytes consumed, so that the caller can
+ *     stop reading from the board and pass the rest of the buffer again later (backpressure).
+ *
+ * Counters give the bytes, lines, frames and events decoded, and the errors: malformed lines and
+ * frames, overlong lines, CRC errors and frames lost according to their sequence numbers.
+ *
+ */
+
+#ifndef HOST_TOOLS_BOARD_DECODER_H_
+#define HOST_TOOLS_BOARD_DECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "inc/Board_Protocol.h"
+#include "inc/Color_Classifier.h"
+#include "inc/Simon_Game.h"
+
+// Longest text line kept by the decoder; longer lines are counted and dropped
+constexpr size_t BOARD_DECODER_LINE_CAPACITY = 128;
+
+enum class Board_Event_Type : uint8_t
+{
+    Sample,
+    Detection,
+    Game,
+    Rate_Stats,
+    Reaction,
+    Reaction_Stats,
+    PC_Samples,
+    I2C_Trace,
+    Summary,
+    Text,
+    Unknown_Frame
+};
+
+struct Board_Sample
+{
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+    uint16_t clear;         // 0 for text samples, which do not carry the clear channel
+    uint32_t time_ms;       // Board time of SAMPLE frames; 0 for text samples
+};
+
+struct Board_Event
+{
+    Board_Event_Type type;
+    bool binary;                        // Decoded from a frame rather than a text line
+    uint8_t frame_type;                 // Frame type (frames only)
+    uint8_t sequence;                   // Sequence number (frames only)
+    uint64_t time_us;                   // Receive time passed to Feed or Decode
+
+    union
+    {
+        Board_Sample sample;
+        Color_t color;
+        int game_result;                // SIMON_GAME_WRONG, _STEP, _COMPLETE or _MISS
+        Board_Protocol_Rate_Stats rate_stats;
+        Reaction_Step reaction;
+        Reaction_Summary reaction_stats;
+        Board_Protocol_PC_Samples pc_samples;
+        Board_Protocol_I2C_Trace i2c_trace;
+        Board_Protocol_Summary summary;
+    };
+
+    std::string_view raw;               // Text line without its line ending, or frame body
+};
+
+struct Board_Decoder_Counters
+{
+    uint64_t bytes = 0;
+    uint64_t lines = 0;
+    uint64_t frames = 0;
+    uint64_t events = 0;
+    uint64_t samples = 0;
+    uint64_t malformed = 0;             // Lines and frames with a known format that do not parse
+    uint64_t overlong = 0;              // Lines longer than BOARD_DECODER_LINE_CAPACITY, and oversized frames
+    uint64_t crc_errors = 0;
+    uint64_t lost_frames = 0;           // Gaps in the frame sequence numbers
+};
+
+class Board_Decoder
+{
+public:
+    /**
+     * @brief Sets the next buffer to decode. Frames are decoded in place, so the buffer is modified.
+     *
+     * Bytes of the previous buffer that Next has not reached yet are abandoned.
+     */
+    void Feed(uint8_t *data, size_t size, uint64_t time_us = 0);
+
+    /**
+     * @brief Decodes the next event of the current buffer.
+     *
+     * @return false when the buffer is exhausted. A partial line or frame at its end is kept and
+     *         completed by the next buffer.
+     */
+    bool Next(Board_Event &event);
+
+    // Number of bytes of the current buffer that Next has not reached yet
+    size_t Remaining() const { return (size_t)(end - cursor); }
+
+    /**
+     * @brief Decodes a buffer and calls handler(const Board_Event &) for every event.
+     *
+     * @return The number of bytes consumed. It is less than size when the handler returned false;
+     *         the caller then passes the remaining bytes again later.
+     */
+    template <typename Handler>
+    size_t Decode(uint8_t *data, size_t size, uint64_t time_us, Handler &&handler)
+    {
+        Board_Event event;
+
+        Feed(data, size, time_us);
+
+        while (Next(event))
+        {
+            if (!handler(static_cast<const Board_Event &>(event))) break;
+        }
+
+        return size - Remaining();
+    }
+
+    const Board_Decoder_Counters &Counters() const { return counters; }
+
+    // Forgets any partial line or frame and the sequence number, for example after a reconnection
+    void Reset();
+
+private:
+    enum class Mode : uint8_t
+    {
+        Text,
+        Frame
+    };
+
+    bool Decode_Line(char *line, size_t length, Board_Event &event);
+    bool Decode_Frame(uint8_t *frame, size_t length, Board_Event &event);
+    bool Decode_Rate_Line(const char *line, size_t length, Board_Event &event);
+    bool Decode_Step_Line(const char *line, size_t length, Board_Event &event);
+    bool Decode_Reaction_Line(const char *line, size_t length, Board_Event &event);
+
+    uint8_t *cursor = nullptr;
+    uint8_t *end = nullptr;
+    uint64_t time_us = 0;
+
+    Mode mode = Mode::Text;
+    uint8_t carry[BOARD_DECODER_LINE_CAPACITY];
+    size_t carry_length = 0;
+    bool overflow = false;
+
+    bool has_sequence = false;
+    uint8_t next_sequence = 0;
+
+    // Fields of the "rate idle" and "rate burst" lines, until the "rate energy" line completes them
+    Board_Protocol_Rate_Stats rate_lines = {};
+
+    // Fields of the "reaction steps" and "reaction pipeline" lines, until the "reaction rounds" line completes them
+    Reaction_Summary reaction_lines = {};
+
+    Board_Decoder_Counters counters;
+};
+
+#endif /* HOST_TOOLS_BOARD_DECODER_H_ */
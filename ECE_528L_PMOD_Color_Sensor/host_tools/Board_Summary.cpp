@@ -0,0 +1,135 @@
+/**
+ * @file Board_Summary.cpp
+ * @brief Merges the SUMMARY frames of a board into dashboard buckets.
+ *
+ */
+
+#include "Board_Summary.h"
+
+#include <algorithm>
+#include <cmath>
+
+void Board_Summary_Bucket::Add(const Board_Protocol_Summary &summary)
+{
+    if (summary.samples == 0) return;
+
+    double n = (double)summary.samples;
+    double total = (double)(samples + summary.samples);
+
+    for (int c = 0; c < BOARD_PROTOCOL_SUMMARY_CHANNELS; c++)
+    {
+        double delta = summary.mean[c] - mean[c];
+
+        if (samples == 0)
+        {
+            min[c] = summary.min[c];
+            max[c] = summary.max[c];
+        }
+        else
+        {
+            min[c] = std::min(min[c], summary.min[c]);
+            max[c] = std::max(max[c], summary.max[c]);
+        }
+
+        m2[c] += summary.variance[c] * n + delta * delta * samples * n / total;
+        mean[c] += delta * n / total;
+    }
+
+    for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+    {
+        classes[i] += summary.classes[i];
+    }
+
+    samples += summary.samples;
+    raw_samples += summary.raw_samples;
+    windows++;
+}
+
+void Board_Summary_Bucket::Add_Sample(const uint16_t *values, uint8_t color)
+{
+    samples++;
+
+    for (int c = 0; c < BOARD_PROTOCOL_SUMMARY_CHANNELS; c++)
+    {
+        double delta = values[c] - mean[c];
+
+        min[c] = (samples == 1) ? values[c] : std::min(min[c], values[c]);
+        max[c] = (samples == 1) ? values[c] : std::max(max[c], values[c]);
+        mean[c] += delta / samples;
+        m2[c] += delta * (values[c] - mean[c]);
+    }
+
+    if (color < BOARD_PROTOCOL_SUMMARY_CLASSES) classes[color]++;
+}
+
+double Board_Summary_Bucket::Std(int channel) const
+{
+    return std::sqrt(std::max(0.0, Variance(channel)));
+}
+
+Board_Summary_Bucket &Board_Summary_Timeline::Bucket(uint32_t start_ms)
+{
+    if (!has_first)
+    {
+        has_first = true;
+        first_ms = start_ms;
+        last_ms = start_ms;
+    }
+
+    // Time since the first window, extended past the wrap of the board time
+    last_offset_ms += (uint32_t)(start_ms - last_ms);
+    last_ms = start_ms;
+
+    size_t index = (size_t)(last_offset_ms / bucket_ms);
+
+    while (buckets.size() <= index)
+    {
+        buckets.emplace_back();
+        buckets.back().start_ms = (buckets.size() - 1) * bucket_ms;
+    }
+
+    return buckets[index];
+}
+
+void Board_Summary_Timeline::Add(const Board_Protocol_Summary &summary)
+{
+    Bucket(summary.start_ms).Add(summary);
+}
+
+void Board_Summary_Timeline::Add_Sample(uint32_t window_start_ms, const uint16_t *values, uint8_t color)
+{
+    Board_Summary_Bucket &bucket = Bucket(window_start_ms);
+
+    // The windows of the raw samples are counted when they start
+    if ((bucket.samples == 0) || (window_start_ms != last_sample_window_ms)) bucket.windows++;
+    last_sample_window_ms = window_start_ms;
+    bucket.Add_Sample(values, color);
+}
+
+void Board_Summary_Timeline::Write_CSV(FILE *file) const
+{
+    static const char *const channels[] = { "r", "g", "b", "c" };
+
+    std::fprintf(file, "time_ms,count");
+    for (const char *channel : channels) std::fprintf(file, ",%s_min,%s_max,%s_mean,%s_std", channel, channel, channel, channel);
+    std::fprintf(file, ",green,red,yellow,none,raw\n");
+
+    for (const Board_Summary_Bucket &bucket : buckets)
+    {
+        if (bucket.samples == 0) continue;
+
+        std::fprintf(file, "%llu,%llu", (unsigned long long)bucket.start_ms, (unsigned long long)bucket.samples);
+
+        for (int c = 0; c < BOARD_PROTOCOL_SUMMARY_CHANNELS; c++)
+        {
+            std::fprintf(file, ",%u,%u,%.1f,%.1f", bucket.min[c], bucket.max[c], bucket.mean[c], bucket.Std(c));
+        }
+
+        for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+        {
+            std::fprintf(file, ",%llu", (unsigned long long)bucket.classes[i]);
+        }
+
+        std::fprintf(file, ",%llu\n", (unsigned long long)bucket.raw_samples);
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file Board_Summary.h
+ * @brief Host SDK for the SUMMARY frames of a board: merges the windows into dashboard buckets.
+ *
+ * A board built with TELEMETRY_SUMMARY sends one SUMMARY frame per window of samples (see
+ * Sample_Summary.h) instead of a text line per sample. Board_Summary_Timeline puts the windows into
+ * buckets of a fixed length, aligned on the first window, and merges them into the statistics that
+ * the dashboards need: samples, min, max, mean and standard deviation of each channel, and the samples
+ * of each color. The windows are merged with the parallel form of the variance (Chan et al.), so a
+ * bucket has the statistics of all its samples:
+ *   - samples, min, max and the color counts are exact;
+ *   - the mean is within half a count, since the mean of each window is rounded on the board;
+ *   - the variance is the pooled variance of the windows, which have been rounded too: the standard
+ *     deviation is within about a count.
+ * The same buckets can be computed from raw samples with Add_Sample, to compare the two.
+ *
+ * The columns of Write_CSV extend those of capture_store overview, so the same plots read both.
+ *
+ */
+
+#ifndef HOST_TOOLS_BOARD_SUMMARY_H_
+#define HOST_TOOLS_BOARD_SUMMARY_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "inc/Board_Protocol.h"
+
+// Statistics of the samples in a time range
+struct Board_Summary_Bucket
+{
+    uint64_t start_ms = 0;                                  // Start of the bucket since the first window
+    uint64_t samples = 0;
+    uint64_t raw_samples = 0;                               // Samples that the board also sent raw
+    uint64_t windows = 0;
+    uint16_t min[BOARD_PROTOCOL_SUMMARY_CHANNELS] = {};
+    uint16_t max[BOARD_PROTOCOL_SUMMARY_CHANNELS] = {};
+    double mean[BOARD_PROTOCOL_SUMMARY_CHANNELS] = {};
+    double m2[BOARD_PROTOCOL_SUMMARY_CHANNELS] = {};        // Sum of the squared deviations from the mean
+    uint64_t classes[BOARD_PROTOCOL_SUMMARY_CLASSES] = {};
+
+    // Merges a window of the board
+    void Add(const Board_Protocol_Summary &summary);
+
+    // Adds one sample, in the order red, green, blue, clear
+    void Add_Sample(const uint16_t *values, uint8_t color);
+
+    double Variance(int channel) const { return samples ? m2[channel] / samples : 0.0; }
+    double Std(int channel) const;
+};
+
+class Board_Summary_Timeline
+{
+public:
+    explicit Board_Summary_Timeline(uint64_t bucket_ms) : bucket_ms(bucket_ms ? bucket_ms : 1) {}
+
+    // Adds a window; its start wraps at 2^32 ms and the windows come in order
+    void Add(const Board_Protocol_Summary &summary);
+
+    // Adds a raw sample that belongs to the window starting at window_start_ms (board time)
+    void Add_Sample(uint32_t window_start_ms, const uint16_t *values, uint8_t color);
+
+    const std::vector<Board_Summary_Bucket> &Buckets() const { return buckets; }
+    uint64_t Bucket_ms() const { return bucket_ms; }
+
+    // Board time of the first window, or 0 before the first one
+    uint32_t First_ms() const { return first_ms; }
+
+    // Writes one line per bucket; buckets without samples are skipped
+    void Write_CSV(FILE *file) const;
+
+private:
+    Board_Summary_Bucket &Bucket(uint32_t start_ms);
+
+    uint64_t bucket_ms;
+    std::vector<Board_Summary_Bucket> buckets;
+    bool has_first = false;
+    uint32_t first_ms = 0;
+    uint32_t last_ms = 0;
+    uint64_t last_offset_ms = 0;
+    uint32_t last_sample_window_ms = 0;
+};
+
+#endif /* HOST_TOOLS_BOARD_SUMMARY_H_ */
@@ -0,0 +1,411 @@
+/**
+ * @file Boot_Updater.cpp
+ * @brief Host side of the UART bootloader: delta generation and the update sequence.
+ *
+ */
+
+#include "Boot_Updater.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+
+void Put_U16(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+void Put_U32(std::vector<uint8_t> &out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+std::string Hex(uint32_t value)
+{
+    char text[16];
+    std::snprintf(text, sizeof(text), "0x%05X", value);
+    return text;
+}
+
+uint32_t Get_U32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// The image padded with 0xFF to a whole number of sectors
+std::vector<uint8_t> Pad_Image(const std::vector<uint8_t> &image, uint32_t sector_size)
+{
+    std::vector<uint8_t> padded(image);
+    padded.resize((image.size() + sector_size - 1) / sector_size * sector_size, 0xFF);
+    return padded;
+}
+
+// Calls chunk(offset, size) for each PROGRAM block of a sector. Only the image itself (rounded up to
+// a flash word) is programmed, and blocks that are all 0xFF are skipped unless full is set.
+template <typename Chunk>
+void For_Each_Chunk(const std::vector<uint8_t> &padded, size_t image_size, uint32_t sector, uint32_t sector_size,
+                    uint32_t max_data, bool full, Chunk &&chunk)
+{
+    size_t image_end = (image_size + BOOTLOADER_PROGRAM_ALIGN - 1) / BOOTLOADER_PROGRAM_ALIGN * BOOTLOADER_PROGRAM_ALIGN;
+    size_t begin = (size_t)sector * sector_size;
+    size_t end = std::min(begin + sector_size, image_end);
+
+    for (size_t offset = begin; offset < end; offset += max_data)
+    {
+        size_t size = std::min<size_t>(max_data, end - offset);
+        const uint8_t *data = &padded[offset];
+
+        if (!full && std::all_of(data, data + size, [](uint8_t byte) { return byte == 0xFF; })) continue;
+        chunk((uint32_t)offset, size);
+    }
+}
+
+}
+
+std::vector<uint8_t> Boot_Flash_Image(const std::vector<uint8_t> &application, uint32_t sector_size)
+{
+    std::vector<uint8_t> header;
+
+    Put_U32(header, BOOTLOADER_APP_MAGIC);
+    Put_U32(header, (uint32_t)application.size());
+    Put_U32(header, Bootloader_CRC32(0, application.data(), (uint32_t)application.size()));
+
+    std::vector<uint8_t> flash(sector_size, 0xFF);
+    std::copy(header.begin(), header.end(), flash.begin());
+    flash.insert(flash.end(), application.begin(), application.end());
+    return flash;
+}
+
+std::vector<uint32_t> Boot_Sector_CRCs(const std::vector<uint8_t> &image, uint32_t sector_size)
+{
+    std::vector<uint8_t> padded = Pad_Image(image, sector_size);
+    std::vector<uint32_t> crcs(padded.size() / sector_size);
+
+    for (size_t s = 0; s < crcs.size(); s++) crcs[s] = Bootloader_CRC32(0, &padded[s * sector_size], sector_size);
+
+    return crcs;
+}
+
+Boot_Delta Boot_Delta_Generate(const std::vector<uint8_t> &flash_image, const std::vector<uint32_t> &board_crcs,
+                               uint32_t sector_size, uint32_t max_data, bool full)
+{
+    std::vector<uint8_t> padded = Pad_Image(flash_image, sector_size);
+    std::vector<uint32_t> crcs = Boot_Sector_CRCs(flash_image, sector_size);
+    Boot_Delta delta;
+
+    delta.image_sectors = (uint32_t)crcs.size();
+
+    for (uint32_t s = 0; s < crcs.size(); s++)
+    {
+        if (!full && (s < board_crcs.size()) && (board_crcs[s] == crcs[s])) continue;
+        delta.sectors.push_back(s);
+    }
+
+    // The header must be erased before, and programmed after, any other sector
+    if (!delta.sectors.empty() && (delta.sectors[0] != 0)) delta.sectors.insert(delta.sectors.begin(), 0);
+
+    // Only the header itself is programmed in the header sector
+    for (uint32_t s : delta.sectors)
+    {
+        if (s == 0) delta.program_bytes += BOOTLOADER_APP_HEADER_SIZE;
+        else For_Each_Chunk(padded, flash_image.size(), s, sector_size, max_data, full, [&](uint32_t, size_t size) { delta.program_bytes += size; });
+    }
+
+    return delta;
+}
+
+Boot_Updater::Boot_Updater(Boot_Link &link, uint32_t baud, int timeout_ms, int retries)
+    : link(link), baud(baud), timeout_ms(timeout_ms), retries(retries)
+{
+}
+
+bool Boot_Updater::Fail(const std::string &message)
+{
+    error = message;
+    return false;
+}
+
+bool Boot_Updater::Receive_Frame(std::vector<uint8_t> &payload, int wait_ms)
+{
+    uint8_t buffer[512];
+
+    while (true)
+    {
+        // Look for a complete frame with a valid CRC, dropping bytes that cannot start one
+        while (!received.empty())
+        {
+            if (received[0] != BOOTLOADER_HEADER)
+            {
+                received.erase(received.begin());
+                continue;
+            }
+            if (received.size() < 3) break;
+
+            size_t length = received[1] | ((size_t)received[2] << 8);
+            if ((length < 2) || (length > BOOTLOADER_MAX_RESPONSE))
+            {
+                received.erase(received.begin());
+                continue;
+            }
+            if (received.size() < length + BOOTLOADER_FRAMING) break;
+
+            uint16_t crc = received[3 + length] | (uint16_t)(received[4 + length] << 8);
+            if (crc != Bootloader_CRC16(&received[3], (uint32_t)length))
+            {
+                received.erase(received.begin());
+                continue;
+            }
+
+            payload.assign(received.begin() + 3, received.begin() + 3 + length);
+            received.erase(received.begin(), received.begin() + length + BOOTLOADER_FRAMING);
+            return true;
+        }
+
+        size_t size = link.Receive(buffer, sizeof(buffer), wait_ms);
+        if (size == 0) return false;
+
+        stats.bytes_received += size;
+        received.insert(received.end(), buffer, buffer + size);
+    }
+}
+
+int Boot_Updater::Transact(const std::vector<uint8_t> &request, std::vector<uint8_t> &data, int attempts, int wait_ms, size_t enter_bytes)
+{
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> payload;
+    uint8_t buffer[512];
+
+    frame.push_back(BOOTLOADER_HEADER);
+    Put_U16(frame, (uint32_t)request.size());
+    frame.insert(frame.end(), request.begin(), request.end());
+    Put_U16(frame, Bootloader_CRC16(request.data(), (uint32_t)request.size()));
+    frame.insert(frame.end(), enter_bytes, BOOTLOADER_ENTER_BYTE);
+
+    for (int attempt = 0; attempt < attempts; attempt++)
+    {
+        if (attempt > 0)
+        {
+            // Drop late responses to the previous attempt before repeating the request
+            stats.retries++;
+            received.clear();
+            while (link.Receive(buffer, sizeof(buffer), 0) > 0);
+        }
+
+        stats.requests++;
+        stats.bytes_sent += frame.size();
+        if (!link.Send(frame.data(), frame.size())) break;
+
+        while (Receive_Frame(payload, wait_ms))
+        {
+            // A CRC error on the board is answered with command 0: repeat the request
+            if ((payload[0] == 0) && ((int8_t)payload[1] == BOOTLOADER_ERROR_CRC)) break;
+
+            // Responses to other commands are late answers to earlier requests
+            if (payload[0] != request[0]) continue;
+
+            data.assign(payload.begin() + 2, payload.end());
+            return (int8_t)payload[1];
+        }
+    }
+
+    error = "no valid response to command " + std::to_string(request[0]);
+    return BOOTLOADER_ERROR_CRC;
+}
+
+int Boot_Updater::Transact(const std::vector<uint8_t> &request, std::vector<uint8_t> &data)
+{
+    return Transact(request, data, retries, timeout_ms, 0);
+}
+
+bool Boot_Updater::Connect(Boot_Info &info, int seconds)
+{
+    std::vector<uint8_t> data;
+    const int WAIT_MS = 100;
+
+    // Each attempt sends INFO between two bursts of the entry request. The application counts the
+    // entry byte when it is the last byte received at a poll, so the INFO request must not end the
+    // attempt; the bootloader ignores the entry bytes around the request.
+    for (int attempt = 0; attempt < seconds * 1000 / WAIT_MS; attempt++)
+    {
+        std::vector<uint8_t> enter(64, BOOTLOADER_ENTER_BYTE);
+        link.Send(enter.data(), enter.size());
+
+        if ((Transact({ BOOTLOADER_CMD_INFO }, data, 1, WAIT_MS, 16) == BOOTLOADER_OK) && (data.size() >= BOOTLOADER_INFO_LENGTH))
+        {
+            error.clear();
+            return Info(info);
+        }
+    }
+
+    return Fail("the board did not enter the bootloader");
+}
+
+bool Boot_Updater::Info(Boot_Info &info)
+{
+    std::vector<uint8_t> data;
+
+    if ((Transact({ BOOTLOADER_CMD_INFO }, data) != BOOTLOADER_OK) || (data.size() < BOOTLOADER_INFO_LENGTH)) return Fail("INFO failed");
+
+    info.version = Get_U32(&data[0]);
+    info.flash_size = Get_U32(&data[4]);
+    info.sector_size = Get_U32(&data[8]);
+    info.max_data = Get_U32(&data[12]);
+    info.app_address = Get_U32(&data[16]);
+
+    if (info.version != BOOTLOADER_VERSION) return Fail("bootloader version " + std::to_string(info.version) + " is not supported");
+
+    // The header sector is the sector before the application
+    if ((info.sector_size == 0) || (info.max_data == 0) || (info.max_data % BOOTLOADER_PROGRAM_ALIGN != 0) ||
+        (info.app_address < info.sector_size) || (info.app_address % info.sector_size != 0) ||
+        (info.app_address >= info.flash_size))
+    {
+        return Fail("invalid INFO response");
+    }
+
+    return true;
+}
+
+bool Boot_Updater::Set_Baud(uint32_t new_baud)
+{
+    std::vector<uint8_t> request = { BOOTLOADER_CMD_SET_BAUD };
+    std::vector<uint8_t> data;
+    uint8_t buffer[256];
+    Boot_Info info;
+
+    if (new_baud == baud) return true;
+
+    Put_U32(request, new_baud);
+    if (Transact(request, data) != BOOTLOADER_OK) return Fail("SET_BAUD failed");
+
+    if (link.Set_Baud(new_baud))
+    {
+        received.clear();
+        if (Info(info))
+        {
+            baud = new_baud;
+            return true;
+        }
+        link.Set_Baud(baud);
+    }
+
+    // Wait until the board abandons the new rate, then check that it answers at the old one
+    received.clear();
+    link.Receive(buffer, sizeof(buffer), (BOOTLOADER_BAUD_PROBATION_IDLES + 5) * 100);
+    received.clear();
+
+    if (!Info(info)) return Fail("the board does not answer after a failed baud rate change");
+    error = "the link cannot run at " + std::to_string(new_baud) + " baud";
+    return true;
+}
+
+bool Boot_Updater::Sector_CRCs(uint32_t first, uint32_t count, std::vector<uint32_t> &crcs)
+{
+    std::vector<uint8_t> data;
+
+    crcs.clear();
+
+    while (count > 0)
+    {
+        uint32_t batch = std::min<uint32_t>(count, BOOTLOADER_MAX_SECTOR_CRCS);
+        std::vector<uint8_t> request = { BOOTLOADER_CMD_SECTOR_CRCS };
+
+        Put_U16(request, first);
+        Put_U16(request, batch);
+
+        if ((Transact(request, data) != BOOTLOADER_OK) || (data.size() != 2 + 4 * (size_t)batch)) return Fail("SECTOR_CRCS failed");
+
+        for (uint32_t i = 0; i < batch; i++) crcs.push_back(Get_U32(&data[2 + 4 * i]));
+
+        first += batch;
+        count -= batch;
+    }
+
+    return true;
+}
+
+bool Boot_Updater::Erase(uint32_t address)
+{
+    std::vector<uint8_t> request = { BOOTLOADER_CMD_ERASE };
+    std::vector<uint8_t> data;
+
+    Put_U32(request, address);
+    if (Transact(request, data) != BOOTLOADER_OK) return Fail("ERASE failed at " + Hex(address));
+    return true;
+}
+
+bool Boot_Updater::Program(uint32_t address, const uint8_t *bytes, size_t size)
+{
+    std::vector<uint8_t> request = { BOOTLOADER_CMD_PROGRAM };
+    std::vector<uint8_t> data;
+
+    Put_U32(request, address);
+    request.insert(request.end(), bytes, bytes + size);
+    if (Transact(request, data) != BOOTLOADER_OK) return Fail("PROGRAM failed at " + Hex(address));
+    return true;
+}
+
+bool Boot_Updater::Verify(uint32_t length, uint32_t crc)
+{
+    std::vector<uint8_t> request = { BOOTLOADER_CMD_VERIFY };
+    std::vector<uint8_t> data;
+
+    Put_U32(request, length);
+    Put_U32(request, crc);
+    if (Transact(request, data) != BOOTLOADER_OK) return Fail("VERIFY failed: the flash does not match the image");
+    return true;
+}
+
+bool Boot_Updater::Run()
+{
+    std::vector<uint8_t> data;
+
+    if (Transact({ BOOTLOADER_CMD_RUN }, data) != BOOTLOADER_OK) return Fail("RUN refused");
+    return true;
+}
+
+bool Boot_Updater::Update(const std::vector<uint8_t> &image, const Boot_Info &info, const Boot_Update_Options &options)
+{
+    if (image.empty() || (image.size() > info.flash_size - info.app_address)) return Fail("the image does not fit in the flash");
+
+    if ((options.baud != 0) && !Set_Baud(options.baud)) return false;
+    stats.baud = baud;
+
+    // Sector 0 of the flash image is the header sector
+    uint32_t base = info.app_address - info.sector_size;
+    std::vector<uint8_t> flash_image = Boot_Flash_Image(image, info.sector_size);
+    std::vector<uint8_t> padded = Pad_Image(flash_image, info.sector_size);
+    uint32_t image_sectors = (uint32_t)(padded.size() / info.sector_size);
+    std::vector<uint32_t> board_crcs;
+
+    if (!options.full && !Sector_CRCs(base / info.sector_size, image_sectors, board_crcs)) return false;
+
+    Boot_Delta delta = Boot_Delta_Generate(flash_image, board_crcs, info.sector_size, info.max_data, options.full);
+    stats.image_sectors = delta.image_sectors;
+
+    // The header sector comes first in the delta: it is only erased here, and its header is programmed
+    // after VERIFY, as the last flash word of the update
+    for (uint32_t sector : delta.sectors)
+    {
+        bool ok = Erase(base + sector * info.sector_size);
+
+        if (sector != 0)
+        {
+            For_Each_Chunk(padded, flash_image.size(), sector, info.sector_size, info.max_data, options.full, [&](uint32_t offset, size_t size)
+            {
+                ok = ok && Program(base + offset, &padded[offset], size);
+            });
+        }
+
+        if (!ok) return false;
+        stats.sectors_written++;
+    }
+
+    if (!Verify((uint32_t)image.size(), Bootloader_CRC32(0, image.data(), (uint32_t)image.size()))) return false;
+
+    if (!delta.sectors.empty() && !Program(base, flash_image.data(), BOOTLOADER_APP_HEADER_SIZE)) return false;
+
+    return !options.run || Run();
+}
@@ -0,0 +1,163 @@
+/**
+ * @file Boot_Updater.h
+ * @brief Host side of the UART bootloader: delta generation and the update sequence.
+ *
+ * The bootloader protocol is described in Bootloader.h. Boot_Updater talks to a board through a
+ * Boot_Link, which is a serial port in boot_update.cpp and an emulated board in boot_update_bench.cpp.
+ *
+ * The image is the application, which the board stores at the application address given by INFO.
+ * The sector before it holds the application header (magic, length, CRC-32), which the resident
+ * bootloader checks after every reset. The updater writes the header sector and the image together
+ * as one flash image (Boot_Flash_Image).
+ *
+ * An update:
+ *   1. Requests the bootloader and reads INFO.
+ *   2. Switches both ends to the update baud rate, or stays at the current rate when the link
+ *      cannot follow (the board reverts on its own when nothing arrives at the new rate).
+ *   3. Reads the CRC-32 of every sector covered by the flash image and generates the delta: the
+ *      sectors whose CRC differs from the same sector of the flash image (padded with 0xFF). A full
+ *      update rewrites every sector instead.
+ *   4. Erases the header sector, so that the board stays in the bootloader if the update is
+ *      interrupted, then erases and programs each other sector of the delta. Blocks that are all 0xFF
+ *      are skipped, since the erase already left them so.
+ *   5. Verifies the CRC-32 of the whole image, programs the header and sends RUN.
+ *
+ * Requests are repeated after a timeout, a corrupted response or a CRC error on the board. Commands
+ * are idempotent, and the header is only programmed after a VERIFY of the whole image, so a repeated
+ * request or an interrupted update cannot leave a wrong image that the board would start. Running
+ * the update again completes an interrupted one.
+ *
+ */
+
+#ifndef HOST_TOOLS_BOOT_UPDATER_H_
+#define HOST_TOOLS_BOOT_UPDATER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "inc/Bootloader.h"
+
+class Boot_Link
+{
+public:
+    virtual ~Boot_Link() = default;
+
+    virtual bool Send(const uint8_t *data, size_t size) = 0;
+
+    // Returns up to size received bytes, waiting at most timeout_ms for the first one
+    virtual size_t Receive(uint8_t *data, size_t size, int timeout_ms) = 0;
+
+    // Changes the baud rate of the host end; false if the link cannot use it
+    virtual bool Set_Baud(uint32_t baud) = 0;
+};
+
+struct Boot_Info
+{
+    uint32_t version = 0;
+    uint32_t flash_size = 0;
+    uint32_t sector_size = 0;
+    uint32_t max_data = 0;
+    uint32_t app_address = 0;
+};
+
+// Sectors to rewrite, and the PROGRAM data they need
+struct Boot_Delta
+{
+    std::vector<uint32_t> sectors;
+    uint32_t image_sectors = 0;
+    uint64_t program_bytes = 0;
+};
+
+struct Boot_Update_Options
+{
+    bool full = false;                  // Rewrite every sector of the image
+    bool run = true;                    // Start the new image when it is verified
+    uint32_t baud = 921600;             // Baud rate of the update (0 keeps the current rate)
+};
+
+struct Boot_Update_Stats
+{
+    uint32_t sectors_written = 0;
+    uint32_t image_sectors = 0;
+    uint32_t requests = 0;
+    uint32_t retries = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint32_t baud = 0;                  // Rate the update ran at
+};
+
+// The flash from the header sector to the end of an application: the header sector, which holds the
+// header of the application followed by 0xFF, then the application
+std::vector<uint8_t> Boot_Flash_Image(const std::vector<uint8_t> &application, uint32_t sector_size);
+
+// CRC-32 of each sector of an image padded with 0xFF to a whole number of sectors
+std::vector<uint32_t> Boot_Sector_CRCs(const std::vector<uint8_t> &image, uint32_t sector_size);
+
+// Delta of a flash image against the sector CRCs read from a board (full = every sector of the image).
+// The header sector, the first one, is rewritten whenever another sector is.
+Boot_Delta Boot_Delta_Generate(const std::vector<uint8_t> &flash_image, const std::vector<uint32_t> &board_crcs,
+                               uint32_t sector_size, uint32_t max_data, bool full);
+
+class Boot_Updater
+{
+public:
+    explicit Boot_Updater(Boot_Link &link, uint32_t baud = 115200, int timeout_ms = 300, int retries = 8);
+
+    /**
+     * @brief Requests the bootloader and waits until it answers INFO.
+     *
+     * BOOTLOADER_ENTER_BYTE is sent continuously: the application only polls for it and then resets,
+     * and the bootloader looks for it after the reset. A board that does not answer can be reset by
+     * hand while this runs.
+     */
+    bool Connect(Boot_Info &info, int seconds = 10);
+
+    bool Info(Boot_Info &info);
+
+    /**
+     * @brief Switches the board and the link to a new baud rate.
+     *
+     * When the link cannot use the rate, the board is left to revert and the session continues at
+     * the current rate (Baud() is unchanged and Error() says why).
+     *
+     * @return false only when the board no longer answers.
+     */
+    bool Set_Baud(uint32_t baud);
+
+    bool Sector_CRCs(uint32_t first, uint32_t count, std::vector<uint32_t> &crcs);
+    bool Erase(uint32_t address);
+    bool Program(uint32_t address, const uint8_t *data, size_t size);
+    bool Verify(uint32_t length, uint32_t crc);
+    bool Run();
+
+    // Runs the whole update sequence of an application image on a connected board
+    bool Update(const std::vector<uint8_t> &image, const Boot_Info &info, const Boot_Update_Options &options);
+
+    const std::string &Error() const { return error; }
+    const Boot_Update_Stats &Stats() const { return stats; }
+    uint32_t Baud() const { return baud; }
+
+private:
+    // Sends a request and waits for its response, repeating it when needed. Returns the status of the
+    // response, or BOOTLOADER_ERROR_CRC when no valid response arrived; data receives the response data.
+    // enter_bytes entry requests are sent after the request.
+    int Transact(const std::vector<uint8_t> &request, std::vector<uint8_t> &data, int attempts, int timeout_ms, size_t enter_bytes);
+    int Transact(const std::vector<uint8_t> &request, std::vector<uint8_t> &data);
+
+    // Receives one response frame; false on timeout
+    bool Receive_Frame(std::vector<uint8_t> &payload, int timeout_ms);
+
+    bool Fail(const std::string &message);
+
+    Boot_Link &link;
+    uint32_t baud;
+    int timeout_ms;
+    int retries;
+    std::vector<uint8_t> received;
+    std::string error;
+    Boot_Update_Stats stats;
+};
+
+#endif /* HOST_TOOLS_BOOT_UPDATER_H_ */
@@ -0,0 +1,93 @@
+/**
+ * @file Capture.cpp
+ * @brief Loader for labeled color captures.
+ *
+ */
+
+#include "Capture.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <strings.h>
+
+namespace
+{
+
+bool Parse_Label(const char *text, uint8_t &label)
+{
+    // Same order as Color_t, with none in the place of COLOR_UNKNOWN
+    static const char *const names[] = { "green", "red", "yellow", "none" };
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (strcasecmp(text, names[i]) == 0)
+        {
+            label = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Parse_Number(const char *text, uint64_t &value)
+{
+    char *end;
+    bool hex = (text[0] == '0') && ((text[1] == 'x') || (text[1] == 'X'));
+
+    value = std::strtoull(text, &end, hex ? 16 : 10);
+    return (end != text) && ((*end == '\0') || (*end == '\r') || (*end == '\n'));
+}
+
+}
+
+bool Capture_Load(const char *path, Capture &capture)
+{
+    std::ifstream file(path);
+    std::string line;
+    uint32_t line_number = 0;
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+
+        if (line.empty() || (line[0] == '#')) continue;
+        if (line.compare(0, 4, "time") == 0) continue;
+
+        char *fields[6];
+        int count = 0;
+        char *cursor = &line[0];
+
+        while ((count < 6) && cursor)
+        {
+            fields[count++] = cursor;
+            cursor = std::strchr(cursor, ',');
+            if (cursor) *cursor++ = '\0';
+        }
+
+        uint64_t time_us, red, green, blue, clear = 0;
+        uint8_t label;
+
+        if ((count < 5) || cursor || !Parse_Number(fields[0], time_us) || !Parse_Label(fields[1], label) ||
+            !Parse_Number(fields[2], red) || !Parse_Number(fields[3], green) || !Parse_Number(fields[4], blue) ||
+            ((count == 6) && !Parse_Number(fields[5], clear)) ||
+            (red > 0xFFFF) || (green > 0xFFFF) || (blue > 0xFFFF) || (clear > 0xFFFF))
+        {
+            std::fprintf(stderr, "%s:%u: malformed sample\n", path, line_number);
+            return false;
+        }
+
+        capture.Append(time_us, label, (uint16_t)red, (uint16_t)green, (uint16_t)blue, (uint16_t)clear);
+    }
+
+    return true;
+}
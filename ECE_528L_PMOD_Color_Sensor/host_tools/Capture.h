@@ -0,0 +1,50 @@
+/**
+ * @file Capture.h
+ * @brief Labeled color captures for the host tools.
+ *
+ * A capture is a CSV file with one sample per line ('#' starts a comment, an optional header line is skipped):
+ *   time_us,label,r,g,b[,c]
+ * where label is green, red, yellow or none, and r, g, b are the calibrated channels printed by the
+ * firmware (decimal, or hexadecimal with a 0x prefix). The clear channel c is optional and is 0 when absent.
+ * The samples are stored as a structure of arrays, so that each channel is contiguous in memory for tiled
+ * and vectorized evaluation.
+ *
+ */
+
+#ifndef HOST_TOOLS_CAPTURE_H_
+#define HOST_TOOLS_CAPTURE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Capture
+{
+    std::vector<uint64_t> time_us;
+    std::vector<uint8_t> label;
+    std::vector<uint16_t> red;
+    std::vector<uint16_t> green;
+    std::vector<uint16_t> blue;
+    std::vector<uint16_t> clear;
+
+    size_t Size() const { return time_us.size(); }
+
+    void Append(uint64_t sample_time_us, uint8_t sample_label, uint16_t r, uint16_t g, uint16_t b, uint16_t c = 0)
+    {
+        time_us.push_back(sample_time_us);
+        label.push_back(sample_label);
+        red.push_back(r);
+        green.push_back(g);
+        blue.push_back(b);
+        clear.push_back(c);
+    }
+};
+
+/**
+ * @brief Appends the samples of a capture file. Labels are stored as Color_t values (none is COLOR_UNKNOWN).
+ *
+ * @return true on success. On a malformed line, an error is printed and false is returned.
+ */
+bool Capture_Load(const char *path, Capture &capture);
+
+#endif /* HOST_TOOLS_CAPTURE_H_ */
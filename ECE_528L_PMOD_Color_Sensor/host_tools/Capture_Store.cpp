@@ -0,0 +1,657 @@
+/**
+ * @file Capture_Store.cpp
+ * @brief Writer and memory-mapped reader of the columnar capture store.
+ *
+ */
+
+#include "Capture_Store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const char MAGIC[8] = { 'C', 'C', 'S', 'T', 'O', 'R', 'E', '1' };
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t MAX_BLOCK_SAMPLES = 1 << 20;
+
+uint64_t Zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t Unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+uint8_t Bit_Width(uint64_t value)
+{
+    return value ? (uint8_t)(64 - __builtin_clzll(value)) : 0;
+}
+
+size_t Packed_Words(size_t count, uint8_t bits)
+{
+    return (count * bits + 63) / 64;
+}
+
+void Pack(const uint64_t *values, size_t count, uint8_t bits, uint64_t *out)
+{
+    if (bits == 0) return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t position = i * bits;
+        size_t word = position >> 6;
+        uint32_t shift = position & 63;
+
+        out[word] |= values[i] << shift;
+        if (shift + bits > 64) out[word + 1] |= values[i] >> (64 - shift);
+    }
+}
+
+void Unpack(const uint64_t *words, size_t count, uint8_t bits, uint64_t *values)
+{
+    if (bits == 0)
+    {
+        std::fill(values, values + count, 0);
+        return;
+    }
+
+    uint64_t mask = (bits == 64) ? ~(uint64_t)0 : (((uint64_t)1 << bits) - 1);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t position = i * bits;
+        size_t word = position >> 6;
+        uint32_t shift = position & 63;
+        uint64_t value = words[word] >> shift;
+
+        if (shift + bits > 64) value |= words[word + 1] << (64 - shift);
+        values[i] = value & mask;
+    }
+}
+
+size_t Miniblocks(size_t count)
+{
+    return (count + CAPTURE_STORE_MINIBLOCK - 1) / CAPTURE_STORE_MINIBLOCK;
+}
+
+// Packed size in bits, with one bit width per miniblock
+uint64_t Packed_Bits(const std::vector<uint64_t> &residuals)
+{
+    uint64_t total = 0;
+
+    for (size_t first = 0; first < residuals.size(); first += CAPTURE_STORE_MINIBLOCK)
+    {
+        size_t n = std::min<size_t>(CAPTURE_STORE_MINIBLOCK, residuals.size() - first);
+        uint64_t any = 0;
+
+        for (size_t i = first; i < first + n; i++) any |= residuals[i];
+        total += Bit_Width(any) * n;
+    }
+
+    return total;
+}
+
+// Appends the bit widths of the miniblocks (one byte each, padded to a word), then each miniblock.
+// A full miniblock of 128 values always fills whole words, so every miniblock starts on a word.
+uint8_t Pack_Miniblocks(const std::vector<uint64_t> &residuals, std::vector<uint64_t> &words)
+{
+    size_t header = words.size();
+    size_t miniblocks = Miniblocks(residuals.size());
+    uint8_t max_bits = 0;
+
+    words.resize(header + (miniblocks + 7) / 8, 0);
+
+    for (size_t m = 0; m < miniblocks; m++)
+    {
+        size_t first = m * CAPTURE_STORE_MINIBLOCK;
+        size_t n = std::min<size_t>(CAPTURE_STORE_MINIBLOCK, residuals.size() - first);
+        uint64_t any = 0;
+
+        for (size_t i = first; i < first + n; i++) any |= residuals[i];
+
+        uint8_t bits = Bit_Width(any);
+        size_t packed = words.size();
+
+        ((uint8_t *)(words.data() + header))[m] = bits;
+        max_bits = std::max(max_bits, bits);
+        words.resize(packed + Packed_Words(n, bits), 0);
+        Pack(residuals.data() + first, n, bits, words.data() + packed);
+    }
+
+    return max_bits;
+}
+
+// Number of words of a column, as given by its miniblock widths (0 if a width is invalid)
+size_t Miniblock_Words(const uint64_t *words, size_t total)
+{
+    size_t miniblocks = Miniblocks(total);
+    const uint8_t *widths = (const uint8_t *)words;
+    size_t word = (miniblocks + 7) / 8;
+
+    for (size_t m = 0; m < miniblocks; m++)
+    {
+        if (widths[m] > 64) return 0;
+        word += Packed_Words(std::min<size_t>(CAPTURE_STORE_MINIBLOCK, total - m * CAPTURE_STORE_MINIBLOCK), widths[m]);
+    }
+
+    return word;
+}
+
+// Unpacks the first count of the total values of a column
+void Unpack_Miniblocks(const uint64_t *words, size_t total, size_t count, uint64_t *values)
+{
+    const uint8_t *widths = (const uint8_t *)words;
+    size_t word = (Miniblocks(total) + 7) / 8;
+
+    for (size_t m = 0; m * CAPTURE_STORE_MINIBLOCK < count; m++)
+    {
+        size_t first = m * CAPTURE_STORE_MINIBLOCK;
+        size_t n = std::min<size_t>(CAPTURE_STORE_MINIBLOCK, total - first);
+
+        Unpack(words + word, std::min(n, count - first), widths[m], values + first);
+        word += Packed_Words(n, widths[m]);
+    }
+}
+
+// Chooses the transform that packs into the fewest bits, and appends the packed words
+Capture_Store_Column Encode_Column(const uint64_t *values, uint32_t count, std::vector<uint64_t> &words, std::vector<uint64_t> residuals[3])
+{
+    Capture_Store_Column column = {};
+    uint64_t minimum = *std::min_element(values, values + count);
+
+    for (int e = 0; e < 3; e++) residuals[e].clear();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        residuals[CAPTURE_STORE_OFFSET].push_back(values[i] - minimum);
+        if (i >= 1) residuals[CAPTURE_STORE_DELTA].push_back(Zigzag((int64_t)(values[i] - values[i - 1])));
+        if (i >= 2) residuals[CAPTURE_STORE_DELTA2].push_back(Zigzag((int64_t)((values[i] - values[i - 1]) - (values[i - 1] - values[i - 2]))));
+    }
+
+    uint64_t best_size = UINT64_MAX;
+
+    for (uint8_t e = 0; e < ((count >= 2) ? 3 : 1); e++)
+    {
+        uint64_t packed_size = Packed_Bits(residuals[e]);
+
+        if (packed_size < best_size)
+        {
+            best_size = packed_size;
+            column.encoding = e;
+        }
+    }
+
+    column.offset = words.size() * sizeof(uint64_t);
+    column.base = (column.encoding == CAPTURE_STORE_OFFSET) ? minimum : values[0];
+    column.step = (column.encoding == CAPTURE_STORE_DELTA2) ? (int64_t)(values[1] - values[0]) : 0;
+    column.bits = Pack_Miniblocks(residuals[column.encoding], words);
+    column.words = (uint32_t)(words.size() - column.offset / sizeof(uint64_t));
+
+    return column;
+}
+
+// Number of packed values of a column in a block of count samples
+size_t Packed_Count(const Capture_Store_Column &column, uint32_t count)
+{
+    if (column.encoding == CAPTURE_STORE_DELTA) return count - 1;
+    if (column.encoding == CAPTURE_STORE_DELTA2) return count - 2;
+    return count;
+}
+
+void Bucket_Clear(Capture_Store_Bucket &bucket)
+{
+    bucket = {};
+    for (int c = 0; c < 4; c++) bucket.min[c] = 0xFFFF;
+}
+
+void Bucket_Merge(Capture_Store_Bucket &into, const Capture_Store_Bucket &from)
+{
+    if (from.count == 0) return;
+
+    if (into.count == 0)
+    {
+        into.first_time_us = from.first_time_us;
+        into.first_index = from.first_index;
+    }
+
+    into.last_time_us = from.last_time_us;
+    into.count += from.count;
+
+    for (int c = 0; c < 4; c++)
+    {
+        into.min[c] = std::min(into.min[c], from.min[c]);
+        into.max[c] = std::max(into.max[c], from.max[c]);
+        into.sum[c] += from.sum[c];
+    }
+}
+
+void Bucket_Add(Capture_Store_Bucket &bucket, const Capture &capture, size_t i)
+{
+    const uint16_t channels[4] = { capture.red[i], capture.green[i], capture.blue[i], capture.clear[i] };
+
+    if (bucket.count == 0)
+    {
+        bucket.first_time_us = capture.time_us[i];
+        bucket.first_index = i;
+    }
+
+    bucket.last_time_us = capture.time_us[i];
+    bucket.count++;
+
+    for (int c = 0; c < 4; c++)
+    {
+        bucket.min[c] = std::min(bucket.min[c], channels[c]);
+        bucket.max[c] = std::max(bucket.max[c], channels[c]);
+        bucket.sum[c] += channels[c];
+    }
+}
+
+}
+
+bool Capture_Store_Write(const char *path, const Capture &capture, uint32_t block_samples)
+{
+    size_t count = capture.Size();
+
+    if ((block_samples < 2) || (block_samples > MAX_BLOCK_SAMPLES))
+    {
+        std::fprintf(stderr, "block size must be between 2 and %u samples\n", MAX_BLOCK_SAMPLES);
+        return false;
+    }
+
+    for (size_t i = 1; i < count; i++)
+    {
+        if (capture.time_us[i] < capture.time_us[i - 1])
+        {
+            std::fprintf(stderr, "sample %zu: timestamps must be non-decreasing\n", i);
+            return false;
+        }
+    }
+
+    // Columns, block by block
+    std::vector<Capture_Store_Block> blocks;
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> values(block_samples);
+    std::vector<uint64_t> residuals[3];
+
+    for (size_t first = 0; first < count; first += block_samples)
+    {
+        Capture_Store_Block block = {};
+        uint32_t n = (uint32_t)std::min<size_t>(block_samples, count - first);
+
+        block.first_index = first;
+        block.first_time_us = capture.time_us[first];
+        block.last_time_us = capture.time_us[first + n - 1];
+        block.count = n;
+
+        for (int c = 0; c < CAPTURE_STORE_COLUMNS; c++)
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                size_t j = first + i;
+
+                switch (c)
+                {
+                    case CAPTURE_STORE_TIME:  values[i] = capture.time_us[j]; break;
+                    case CAPTURE_STORE_LABEL: values[i] = capture.label[j];   break;
+                    case CAPTURE_STORE_RED:   values[i] = capture.red[j];     break;
+                    case CAPTURE_STORE_GREEN: values[i] = capture.green[j];   break;
+                    case CAPTURE_STORE_BLUE:  values[i] = capture.blue[j];    break;
+                    default:                  values[i] = capture.clear[j];   break;
+                }
+            }
+
+            block.column[c] = Encode_Column(values.data(), n, words, residuals);
+        }
+
+        blocks.push_back(block);
+    }
+
+    // Pyramid levels, each built from the previous one
+    std::vector<std::vector<Capture_Store_Bucket>> levels;
+
+    if (count > 0)
+    {
+        std::vector<Capture_Store_Bucket> level((count + CAPTURE_STORE_BASE_BUCKET - 1) / CAPTURE_STORE_BASE_BUCKET);
+
+        for (size_t b = 0; b < level.size(); b++)
+        {
+            Bucket_Clear(level[b]);
+            for (size_t i = b * CAPTURE_STORE_BASE_BUCKET; i < std::min<size_t>(count, (b + 1) * CAPTURE_STORE_BASE_BUCKET); i++)
+            {
+                Bucket_Add(level[b], capture, i);
+            }
+        }
+
+        levels.push_back(level);
+
+        while ((levels.back().size() > 1) && (levels.size() < CAPTURE_STORE_MAX_LEVELS))
+        {
+            const std::vector<Capture_Store_Bucket> &finer = levels.back();
+            std::vector<Capture_Store_Bucket> coarser((finer.size() + CAPTURE_STORE_LEVEL_RATIO - 1) / CAPTURE_STORE_LEVEL_RATIO);
+
+            for (size_t b = 0; b < coarser.size(); b++)
+            {
+                Bucket_Clear(coarser[b]);
+                for (size_t i = b * CAPTURE_STORE_LEVEL_RATIO; i < std::min(finer.size(), (b + 1) * CAPTURE_STORE_LEVEL_RATIO); i++)
+                {
+                    Bucket_Merge(coarser[b], finer[i]);
+                }
+            }
+
+            levels.push_back(coarser);
+        }
+    }
+
+    // Layout
+    Capture_Store_Header header = {};
+    uint64_t offset = sizeof(Capture_Store_Header);
+    uint64_t bucket_samples = CAPTURE_STORE_BASE_BUCKET;
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.block_samples = block_samples;
+    header.sample_count = count;
+    header.block_count = blocks.size();
+    header.block_offset = offset;
+    header.level_count = (uint32_t)levels.size();
+    offset += blocks.size() * sizeof(Capture_Store_Block);
+
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        header.level[l].offset = offset;
+        header.level[l].count = levels[l].size();
+        header.level[l].bucket_samples = bucket_samples;
+        offset += levels[l].size() * sizeof(Capture_Store_Bucket);
+        bucket_samples *= CAPTURE_STORE_LEVEL_RATIO;
+    }
+
+    for (Capture_Store_Block &block : blocks)
+    {
+        for (Capture_Store_Column &column : block.column) column.offset += offset;
+    }
+
+    header.file_size = offset + words.size() * sizeof(uint64_t);
+
+    FILE *file = std::fopen(path, "wb");
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    bool ok = (std::fwrite(&header, sizeof(header), 1, file) == 1);
+    ok = ok && (std::fwrite(blocks.data(), sizeof(Capture_Store_Block), blocks.size(), file) == blocks.size());
+    for (const std::vector<Capture_Store_Bucket> &level : levels)
+    {
+        ok = ok && (std::fwrite(level.data(), sizeof(Capture_Store_Bucket), level.size(), file) == level.size());
+    }
+    ok = ok && (std::fwrite(words.data(), sizeof(uint64_t), words.size(), file) == words.size());
+    ok = (std::fclose(file) == 0) && ok;
+
+    if (!ok) std::fprintf(stderr, "error writing %s\n", path);
+    return ok;
+}
+
+Capture_Store::~Capture_Store()
+{
+    Close();
+}
+
+bool Capture_Store::Open(const char *path)
+{
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    struct stat status;
+
+    if ((fd < 0) || (fstat(fd, &status) != 0))
+    {
+        std::fprintf(stderr, "cannot open %s\n", path);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    size = (size_t)status.st_size;
+    void *mapping = (size >= sizeof(Capture_Store_Header)) ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        std::fprintf(stderr, "%s: not a capture store\n", path);
+        size = 0;
+        return false;
+    }
+
+    data = (const uint8_t *)mapping;
+    header = (const Capture_Store_Header *)data;
+    blocks = (const Capture_Store_Block *)(data + header->block_offset);
+
+    // Validate every offset, so that the queries can trust the tables
+    bool valid = (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0) && (header->version == VERSION) &&
+                 (header->file_size == size) && (header->block_samples >= 2) && (header->block_samples <= MAX_BLOCK_SAMPLES) &&
+                 (header->level_count <= CAPTURE_STORE_MAX_LEVELS) && (header->block_offset % 8 == 0) &&
+                 (header->block_count == (header->sample_count + header->block_samples - 1) / header->block_samples) &&
+                 (header->block_count <= size / sizeof(Capture_Store_Block)) &&
+                 (header->block_offset + header->block_count * sizeof(Capture_Store_Block) <= size);
+
+    for (uint64_t b = 0; valid && (b < header->block_count); b++)
+    {
+        const Capture_Store_Block &block = blocks[b];
+        uint64_t expected = std::min<uint64_t>(header->block_samples, header->sample_count - b * header->block_samples);
+
+        valid = (block.first_index == b * header->block_samples) && (block.count == expected) &&
+                (block.first_time_us <= block.last_time_us) && ((b == 0) || (blocks[b - 1].last_time_us <= block.first_time_us));
+
+        for (int c = 0; valid && (c < CAPTURE_STORE_COLUMNS); c++)
+        {
+            const Capture_Store_Column &column = block.column[c];
+
+            valid = (column.encoding <= CAPTURE_STORE_DELTA2) && (column.offset % 8 == 0) &&
+                    ((column.encoding != CAPTURE_STORE_DELTA2) || (block.count >= 2)) &&
+                    (column.words >= (Miniblocks(Packed_Count(column, block.count)) + 7) / 8) &&
+                    (column.offset + (uint64_t)column.words * sizeof(uint64_t) <= size) &&
+                    (Miniblock_Words((const uint64_t *)(data + column.offset), Packed_Count(column, block.count)) == column.words);
+        }
+    }
+
+    for (uint32_t l = 0; valid && (l < header->level_count); l++)
+    {
+        valid = (header->level[l].offset % 8 == 0) && (header->level[l].count <= size / sizeof(Capture_Store_Bucket)) &&
+                (header->level[l].offset + header->level[l].count * sizeof(Capture_Store_Bucket) <= size);
+    }
+
+    if (!valid)
+    {
+        std::fprintf(stderr, "%s: corrupt or unsupported capture store\n", path);
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void Capture_Store::Close()
+{
+    if (data) munmap((void *)data, size);
+
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    blocks = nullptr;
+}
+
+uint64_t Capture_Store::Start_Time_us() const
+{
+    return (Size() > 0) ? blocks[0].first_time_us : 0;
+}
+
+uint64_t Capture_Store::End_Time_us() const
+{
+    return (Size() > 0) ? blocks[header->block_count - 1].last_time_us : 0;
+}
+
+void Capture_Store::Decode_Column(const Capture_Store_Column &column, uint32_t total, uint32_t count, uint64_t *values) const
+{
+    const uint64_t *words = (const uint64_t *)(data + column.offset);
+    size_t packed = Packed_Count(column, total);
+
+    if (column.encoding == CAPTURE_STORE_OFFSET)
+    {
+        Unpack_Miniblocks(words, packed, count, values);
+        for (uint32_t i = 0; i < count; i++) values[i] += column.base;
+    }
+    else if (count == 0)
+    {
+        return;
+    }
+    else if (column.encoding == CAPTURE_STORE_DELTA)
+    {
+        values[0] = column.base;
+        Unpack_Miniblocks(words, packed, count - 1, values + 1);
+        for (uint32_t i = 1; i < count; i++) values[i] = values[i - 1] + (uint64_t)Unzigzag(values[i]);
+    }
+    else
+    {
+        uint64_t step = (uint64_t)column.step;
+
+        values[0] = column.base;
+        if (count < 2) return;
+
+        values[1] = column.base + step;
+        Unpack_Miniblocks(words, packed, count - 2, values + 2);
+        for (uint32_t i = 2; i < count; i++)
+        {
+            step += (uint64_t)Unzigzag(values[i]);
+            values[i] = values[i - 1] + step;
+        }
+    }
+}
+
+uint64_t Capture_Store::Find(uint64_t time_us) const
+{
+    if (Size() == 0) return 0;
+
+    // First block that ends at or after the time, then the first sample in it
+    const Capture_Store_Block *end = blocks + header->block_count;
+    const Capture_Store_Block *block = std::partition_point(blocks, end, [time_us](const Capture_Store_Block &b) { return b.last_time_us < time_us; });
+
+    if (block == end) return Size();
+    if (block->first_time_us >= time_us) return block->first_index;
+
+    std::vector<uint64_t> times(block->count);
+    Decode_Column(block->column[CAPTURE_STORE_TIME], block->count, block->count, times.data());
+
+    return block->first_index + (std::lower_bound(times.begin(), times.end(), time_us) - times.begin());
+}
+
+void Capture_Store::Read(uint64_t begin, uint64_t end, Capture &capture) const
+{
+    end = std::min(end, Size());
+    if (begin >= end) return;
+
+    size_t out = capture.Size();
+    size_t total = out + (end - begin);
+    std::vector<uint64_t> values(header->block_samples);
+
+    capture.time_us.resize(total);
+    capture.label.resize(total);
+    capture.red.resize(total);
+    capture.green.resize(total);
+    capture.blue.resize(total);
+    capture.clear.resize(total);
+
+    for (uint64_t b = begin / header->block_samples; (b < header->block_count) && (blocks[b].first_index < end); b++)
+    {
+        const Capture_Store_Block &block = blocks[b];
+        uint32_t first = (uint32_t)((begin > block.first_index) ? begin - block.first_index : 0);
+        uint32_t last = (uint32_t)std::min<uint64_t>(block.count, end - block.first_index);
+
+        // The samples after the range are not needed by any transform
+        Decode_Column(block.column[CAPTURE_STORE_TIME], block.count, last, values.data());
+        std::copy(values.begin() + first, values.begin() + last, capture.time_us.begin() + out);
+
+        Decode_Column(block.column[CAPTURE_STORE_LABEL], block.count, last, values.data());
+        std::copy(values.begin() + first, values.begin() + last, capture.label.begin() + out);
+
+        std::vector<uint16_t> *channels[4] = { &capture.red, &capture.green, &capture.blue, &capture.clear };
+        for (int c = 0; c < 4; c++)
+        {
+            Decode_Column(block.column[CAPTURE_STORE_RED + c], block.count, last, values.data());
+            std::copy(values.begin() + first, values.begin() + last, channels[c]->begin() + out);
+        }
+
+        out += last - first;
+    }
+}
+
+void Capture_Store::Query(uint64_t start_us, uint64_t end_us, Capture &capture) const
+{
+    if (start_us < end_us) Read(Find(start_us), Find(end_us), capture);
+}
+
+uint64_t Capture_Store::Find_In_Level(uint32_t level, uint64_t time_us) const
+{
+    const Capture_Store_Bucket *first = (const Capture_Store_Bucket *)(data + header->level[level].offset);
+    const Capture_Store_Bucket *last = first + header->level[level].count;
+
+    return std::partition_point(first, last, [time_us](const Capture_Store_Bucket &b) { return b.first_time_us < time_us; }) - first;
+}
+
+int Capture_Store::Overview(uint64_t start_us, uint64_t end_us, uint32_t width, std::vector<Capture_Store_Bucket> &buckets) const
+{
+    buckets.resize(width);
+    if ((width == 0) || (end_us <= start_us)) return -1;
+
+    uint64_t span = end_us - start_us;
+
+    for (uint32_t p = 0; p < width; p++)
+    {
+        Bucket_Clear(buckets[p]);
+        buckets[p].first_time_us = start_us + span * p / width;
+        buckets[p].last_time_us = buckets[p].first_time_us;
+    }
+
+    // Coarsest level with at least one bucket per pixel. Each bucket goes to the pixel of its first sample.
+    for (int level = (int)header->level_count - 1; level >= 0; level--)
+    {
+        uint64_t first = Find_In_Level(level, start_us);
+        uint64_t last = Find_In_Level(level, end_us);
+
+        if (last - first < width) continue;
+
+        const Capture_Store_Bucket *level_buckets = (const Capture_Store_Bucket *)(data + header->level[level].offset);
+
+        for (uint64_t b = first; b < last; b++)
+        {
+            Bucket_Merge(buckets[(level_buckets[b].first_time_us - start_us) * width / span], level_buckets[b]);
+        }
+
+        return level;
+    }
+
+    // Fewer buckets than pixels at the finest level: summarize the samples themselves
+    Capture samples;
+    uint64_t first_index = Find(start_us);
+    Read(first_index, Find(end_us), samples);
+
+    for (size_t i = 0; i < samples.Size(); i++)
+    {
+        Capture_Store_Bucket &bucket = buckets[(samples.time_us[i] - start_us) * width / span];
+
+        Bucket_Add(bucket, samples, i);
+        if (bucket.count == 1) bucket.first_index += first_index;
+    }
+
+    return -1;
+}
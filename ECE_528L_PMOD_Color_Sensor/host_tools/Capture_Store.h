@@ -0,0 +1,180 @@
+/**
+ * @file Capture_Store.h
+ * @brief Columnar file format for long color captures, with a time index and min/max/mean pyramids.
+ *
+ * A store file holds the columns of a Capture (time, label and the four channels) in blocks of
+ * CAPTURE_STORE_BLOCK_SAMPLES samples. Each column of a block is bit-packed after one of three
+ * transforms, whichever needs the fewest bits: offset from the block minimum, first difference, or
+ * second difference (which packs a regular sampling clock into a few bits of jitter). The packed
+ * values are split into miniblocks of 128 with their own bit width, so that a step in the data, such
+ * as an object placed in front of the sensor or a change of sampling rate, only widens one miniblock.
+ * The column data is the bit width of each miniblock, one byte each and padded to a 64-bit word,
+ * followed by the packed miniblocks. The block table is the
+ * time index: it holds the first and last time of each block, so a time is located with a binary
+ * search over the blocks and one block decode.
+ *
+ * The pyramids hold the min, max and sum of each channel over buckets of 64 samples, then 512, 4096
+ * and so on up to a single bucket for the whole capture. An overview of any time range at a given
+ * width reads the coarsest level that still has about one bucket per pixel, so its cost depends on
+ * the width and not on the length of the capture.
+ *
+ * Every table is at an 8-byte aligned offset, so a store is read in place through mmap.
+ *
+ * File layout:
+ *   Capture_Store_Header
+ *   Capture_Store_Block[block_count]
+ *   Capture_Store_Bucket[] for each level, finest first
+ *   packed column data (64-bit words)
+ *
+ */
+
+#ifndef HOST_TOOLS_CAPTURE_STORE_H_
+#define HOST_TOOLS_CAPTURE_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Capture.h"
+
+// Number of samples per compressed block
+constexpr uint32_t CAPTURE_STORE_BLOCK_SAMPLES = 4096;
+
+// Number of packed values sharing one bit width inside a column of a block
+constexpr uint32_t CAPTURE_STORE_MINIBLOCK = 128;
+
+// Samples per bucket at the finest pyramid level, and ratio between consecutive levels
+constexpr uint32_t CAPTURE_STORE_BASE_BUCKET = 64;
+constexpr uint32_t CAPTURE_STORE_LEVEL_RATIO = 8;
+constexpr uint32_t CAPTURE_STORE_MAX_LEVELS = 16;
+
+// Columns of a block, in this order
+constexpr int CAPTURE_STORE_COLUMNS = 6;
+enum Capture_Store_Column_ID
+{
+    CAPTURE_STORE_TIME = 0,
+    CAPTURE_STORE_LABEL,
+    CAPTURE_STORE_RED,
+    CAPTURE_STORE_GREEN,
+    CAPTURE_STORE_BLUE,
+    CAPTURE_STORE_CLEAR
+};
+
+// Column transforms
+enum Capture_Store_Encoding : uint8_t
+{
+    CAPTURE_STORE_OFFSET = 0,
+    CAPTURE_STORE_DELTA = 1,
+    CAPTURE_STORE_DELTA2 = 2
+};
+
+struct Capture_Store_Column
+{
+    uint64_t offset;        // Byte offset of the column data in the file
+    uint64_t base;          // Block minimum (OFFSET) or first value (DELTA, DELTA2)
+    int64_t step;           // First difference (DELTA2)
+    uint32_t words;         // Size of the column data in 64-bit words
+    uint8_t encoding;
+    uint8_t bits;           // Largest bit width of the miniblocks
+    uint8_t reserved[2];
+};
+
+struct Capture_Store_Block
+{
+    uint64_t first_index;
+    uint64_t first_time_us;
+    uint64_t last_time_us;
+    uint32_t count;
+    uint32_t reserved;
+    Capture_Store_Column column[CAPTURE_STORE_COLUMNS];
+};
+
+// Summary of the red, green, blue and clear channels over consecutive samples
+struct Capture_Store_Bucket
+{
+    uint64_t first_time_us;
+    uint64_t last_time_us;
+    uint64_t first_index;
+    uint32_t count;
+    uint16_t min[4];
+    uint16_t max[4];
+    uint32_t reserved;
+    uint64_t sum[4];
+
+    double Mean(int channel) const { return count ? (double)sum[channel] / count : 0.0; }
+};
+
+struct Capture_Store_Level
+{
+    uint64_t offset;        // Byte offset of the buckets in the file
+    uint64_t count;
+    uint64_t bucket_samples;
+};
+
+struct Capture_Store_Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t block_samples;
+    uint64_t sample_count;
+    uint64_t block_count;
+    uint64_t block_offset;
+    uint64_t file_size;
+    uint32_t level_count;
+    uint32_t reserved;
+    Capture_Store_Level level[CAPTURE_STORE_MAX_LEVELS];
+};
+
+/**
+ * @brief Writes a capture as a store file. The timestamps must be non-decreasing.
+ *
+ * @return true on success. On failure, an error is printed and false is returned.
+ */
+bool Capture_Store_Write(const char *path, const Capture &capture, uint32_t block_samples = CAPTURE_STORE_BLOCK_SAMPLES);
+
+/**
+ * @brief Read-only view of a memory-mapped store file.
+ */
+class Capture_Store
+{
+public:
+    Capture_Store() = default;
+    ~Capture_Store();
+
+    Capture_Store(const Capture_Store &) = delete;
+    Capture_Store &operator=(const Capture_Store &) = delete;
+
+    // Maps and validates a store file. Returns false and prints an error on failure.
+    bool Open(const char *path);
+    void Close();
+
+    uint64_t Size() const { return header ? header->sample_count : 0; }
+    uint64_t Start_Time_us() const;
+    uint64_t End_Time_us() const;
+    const Capture_Store_Header *Header() const { return header; }
+    const Capture_Store_Block *Blocks() const { return blocks; }
+
+    // Index of the first sample with a time at or after time_us (Size() if there is none)
+    uint64_t Find(uint64_t time_us) const;
+
+    // Appends the samples [begin, end) to a capture
+    void Read(uint64_t begin, uint64_t end, Capture &capture) const;
+
+    // Appends the samples with a time in [start_us, end_us) to a capture
+    void Query(uint64_t start_us, uint64_t end_us, Capture &capture) const;
+
+    // Summarizes [start_us, end_us) into width buckets of equal duration. Buckets without samples have
+    // a count of 0. Returns the pyramid level used, or -1 when the samples were read directly.
+    int Overview(uint64_t start_us, uint64_t end_us, uint32_t width, std::vector<Capture_Store_Bucket> &buckets) const;
+
+private:
+    void Decode_Column(const Capture_Store_Column &column, uint32_t total, uint32_t count, uint64_t *values) const;
+    uint64_t Find_In_Level(uint32_t level, uint64_t time_us) const;
+
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    const Capture_Store_Header *header = nullptr;
+    const Capture_Store_Block *blocks = nullptr;
+};
+
+#endif /* HOST_TOOLS_CAPTURE_STORE_H_ */
@@ -0,0 +1,194 @@
+/**
+ * @file Work_Stealing_Pool.h
+ * @brief Work-stealing thread pool shared by the host tools.
+ *
+ */
+
+#ifndef HOST_TOOLS_WORK_STEALING_POOL_H_
+#define HOST_TOOLS_WORK_STEALING_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Each worker owns a deque of index ranges. A worker takes ranges from the back of its own deque
+// and splits them until they are no larger than the grain, pushing the upper halves back. An idle
+// worker steals from the front of another deque, where the largest ranges are.
+class Work_Stealing_Pool
+{
+public:
+    explicit Work_Stealing_Pool(unsigned thread_count)
+    {
+        thread_count = std::max(1u, thread_count);
+
+        for (unsigned i = 0; i < thread_count; i++) queues_.emplace_back(new Queue);
+        for (unsigned i = 0; i < thread_count; i++) threads_.emplace_back(&Work_Stealing_Pool::Worker_Loop, this, i);
+    }
+
+    ~Work_Stealing_Pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+
+        for (std::thread &thread : threads_) thread.join();
+    }
+
+    unsigned Thread_Count() const { return (unsigned)threads_.size(); }
+    uint64_t Steal_Count() const { return steals_.load(); }
+
+    // Calls body(begin, end) on disjoint ranges covering [0, count) and returns when all are done
+    void Parallel_For(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body)
+    {
+        if (count == 0) return;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        grain = std::max<size_t>(1, grain);
+        remaining_.store(count);
+
+        // Deal out one contiguous block per worker
+        size_t workers = queues_.size();
+        for (size_t i = 0; i < workers; i++)
+        {
+            size_t begin = (count * i) / workers;
+            size_t end = (count * (i + 1)) / workers;
+
+            if (begin < end)
+            {
+                std::lock_guard<std::mutex> queue_lock(queues_[i]->mutex);
+                queues_[i]->ranges.push_back({ begin, end, grain, &body });
+            }
+        }
+
+        generation_++;
+        wake_.notify_all();
+        done_.wait(lock, [this] { return remaining_.load() == 0; });
+    }
+
+private:
+    // Each range carries the body of its Parallel_For call, so a worker that is still finishing
+    // one call never runs a range of the next call with the previous body
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+        size_t grain;
+        const std::function<void(size_t, size_t)> *body;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    bool Pop(unsigned index, Range &range)
+    {
+        Queue &queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.ranges.empty()) return false;
+
+        range = queue.ranges.back();
+        queue.ranges.pop_back();
+        return true;
+    }
+
+    bool Steal(unsigned index, std::minstd_rand &rng, Range &range)
+    {
+        size_t workers = queues_.size();
+        size_t start = rng() % workers;
+
+        for (size_t i = 0; i < workers; i++)
+        {
+            size_t victim = (start + i) % workers;
+            if (victim == index) continue;
+
+            Queue &queue = *queues_[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (!queue.ranges.empty())
+            {
+                range = queue.ranges.front();
+                queue.ranges.pop_front();
+                steals_++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Push(unsigned index, Range range)
+    {
+        Queue &queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.ranges.push_back(range);
+    }
+
+    void Worker_Loop(unsigned index)
+    {
+        std::minstd_rand rng(index + 1);
+        uint64_t seen_generation = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || (generation_ != seen_generation); });
+                if (stop_) return;
+                seen_generation = generation_;
+            }
+
+            Range range;
+
+            while (remaining_.load() > 0)
+            {
+                if (!Pop(index, range) && !Steal(index, rng, range))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                while (range.end - range.begin > range.grain)
+                {
+                    size_t middle = range.begin + (range.end - range.begin) / 2;
+                    Push(index, { middle, range.end, range.grain, range.body });
+                    range.end = middle;
+                }
+
+                (*range.body)(range.begin, range.end);
+
+                size_t done = range.end - range.begin;
+                if (remaining_.fetch_sub(done) == done)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    done_.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::atomic<size_t> remaining_{ 0 };
+    std::atomic<uint64_t> steals_{ 0 };
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+#endif /* HOST_TOOLS_WORK_STEALING_POOL_H_ */
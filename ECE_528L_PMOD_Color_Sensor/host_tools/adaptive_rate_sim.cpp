@@ -0,0 +1,199 @@
+/**
+ * @file adaptive_rate_sim.cpp
+ * @brief Host simulation of the Adaptive_Rate controller against the Color_Sensor_Mock backend.
+ *
+ * A scripted player alternates between long idle gaps and short sessions in which objects are
+ * swapped in front of the sensor. The same script is run twice: once with the original fixed
+ * loop (2.4 ms integration followed by a 50 ms delay) and once with the Adaptive_Rate controller.
+ * For every scene change, the detection latency is the time from the change until the end of the
+ * first integration window that started after the change, i.e. the first sample that fully sees
+ * the new scene. The rate distribution and the sensor energy estimate are printed for both runs.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Adaptive_Rate.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Sensor_Mock.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR adaptive_rate_sim.cpp Adaptive_Rate.o Color_Sensor_Mock.o -o adaptive_rate_sim
+ *
+ * Usage: ./adaptive_rate_sim [duration_s] [seed]
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "inc/Adaptive_Rate.h"
+#include "inc/Color_Sensor_Mock.h"
+
+namespace
+{
+
+// Original main loop: default 2.4 ms integration, then Clock_Delay1ms(50)
+constexpr uint32_t FIXED_INTEGRATION_US = 2400;
+constexpr uint32_t FIXED_LOOP_DELAY_US = 50000;
+
+// Scene counts per 2.4 ms cycle at 1x gain: red, green, blue, clear
+struct Scene
+{
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+    uint16_t clear;
+};
+
+const Scene SCENES[] =
+{
+    {  40,  42,  36, 120 },     // Empty background
+    {  70, 210,  80, 350 },     // Green object
+    { 230,  60,  55, 330 },     // Red object
+    { 240, 220,  70, 520 },     // Yellow object
+};
+
+struct Event
+{
+    uint64_t time_us;
+    int scene;
+};
+
+// Builds the player script: idle gaps of 2 to 15 s, then a session of 2 to 6 object swaps
+// held for 0.3 to 1.5 s each, ending with the sensor uncovered again
+std::vector<Event> Build_Script(uint64_t duration_us, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> gap_us(2000000, 15000000);
+    std::uniform_int_distribution<uint32_t> hold_us(300000, 1500000);
+    std::uniform_int_distribution<int> swaps(2, 6);
+    std::uniform_int_distribution<int> object(1, 3);
+    std::vector<Event> script;
+    uint64_t t = 0;
+
+    script.push_back({ 0, 0 });
+
+    while (true)
+    {
+        t += gap_us(rng);
+        int count = swaps(rng);
+        int previous = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            int next = object(rng);
+            if (next == previous) next = (next % 3) + 1;
+            if (t >= duration_us) return script;
+            script.push_back({ t, next });
+            previous = next;
+            t += hold_us(rng);
+        }
+
+        if (t >= duration_us) return script;
+        script.push_back({ t, 0 });
+    }
+}
+
+struct Run_Result
+{
+    std::vector<uint64_t> latencies_us;
+    uint32_t samples = 0;
+};
+
+int Scene_At(const std::vector<Event> &script, uint64_t t)
+{
+    auto it = std::upper_bound(script.begin(), script.end(), t,
+                               [](uint64_t value, const Event &event) { return value < event.time_us; });
+    return std::prev(it)->scene;
+}
+
+// Runs the script with either the fixed loop (controller == nullptr) or the adaptive controller
+Run_Result Run(const std::vector<Event> &script, uint64_t duration_us, Adaptive_Rate_Controller *controller)
+{
+    Run_Result result;
+    size_t pending = 1;
+
+    Color_Sensor_Mock_Init();
+    Color_Sensor_Mock_Set_Noise(4, 1);
+
+    if (controller)
+    {
+        Color_Sensor_Mock_Set_Timing(Adaptive_Rate_Get_Integration_us(controller), Adaptive_Rate_Get_Wait_us(controller));
+    }
+    else
+    {
+        Color_Sensor_Mock_Set_Timing(FIXED_INTEGRATION_US, FIXED_LOOP_DELAY_US);
+    }
+
+    while (Color_Sensor_Mock_Get_Time_us() < duration_us)
+    {
+        uint64_t start_us = Color_Sensor_Mock_Get_Time_us();
+        uint32_t integration_us = controller ? Adaptive_Rate_Get_Integration_us(controller) : FIXED_INTEGRATION_US;
+        const Scene &scene = SCENES[Scene_At(script, start_us)];
+
+        // The scene is sampled at the start of the integration window; a window that
+        // straddles a change is not counted as a detection
+        Color_Sensor_Mock_Set_Color(scene.red, scene.green, scene.blue, scene.clear);
+        PMOD_Color_Data sample = Color_Sensor_Mock_Read();
+        result.samples++;
+
+        while ((pending < script.size()) && (script[pending].time_us <= start_us))
+        {
+            result.latencies_us.push_back(start_us + integration_us - script[pending].time_us);
+            pending++;
+        }
+
+        if (controller && Adaptive_Rate_Update(controller, sample))
+        {
+            Color_Sensor_Mock_Set_Timing(Adaptive_Rate_Get_Integration_us(controller), Adaptive_Rate_Get_Wait_us(controller));
+        }
+    }
+
+    return result;
+}
+
+void Print_Latency(const char *name, std::vector<uint64_t> latencies_us)
+{
+    if (latencies_us.empty())
+    {
+        std::printf("%-9s no scene changes\n", name);
+        return;
+    }
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+
+    uint64_t sum = 0;
+    for (uint64_t latency : latencies_us) sum += latency;
+
+    std::printf("%-9s latency over %zu changes: mean %.1f ms, p50 %.1f ms, p95 %.1f ms, max %.1f ms\n",
+                name, latencies_us.size(),
+                sum / 1000.0 / latencies_us.size(),
+                latencies_us[latencies_us.size() / 2] / 1000.0,
+                latencies_us[(latencies_us.size() * 95) / 100] / 1000.0,
+                latencies_us.back() / 1000.0);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t duration_us = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) * 1000000ULL : 600000000ULL;
+    uint32_t seed = (argc > 2) ? (uint32_t)std::strtoul(argv[2], nullptr, 10) : 528;
+    std::vector<Event> script = Build_Script(duration_us, seed);
+
+    Run_Result fixed = Run(script, duration_us, nullptr);
+
+    Adaptive_Rate_Controller controller;
+    Adaptive_Rate_Init(&controller, &Adaptive_Rate_Default_Config);
+    Run_Result adaptive = Run(script, duration_us, &controller);
+
+    std::printf("simulated %.0f s, %zu scene changes\n", duration_us / 1e6, script.size() - 1);
+    std::printf("fixed     %u samples, %.1f Hz\n", fixed.samples, fixed.samples / (duration_us / 1e6));
+    std::printf("adaptive  %u samples, %.1f Hz\n", adaptive.samples, adaptive.samples / (duration_us / 1e6));
+    Print_Latency("fixed", fixed.latencies_us);
+    Print_Latency("adaptive", adaptive.latencies_us);
+
+    // The fixed loop keeps the sensor integrating continuously, which is the reference of Adaptive_Rate_Get_Energy
+    Adaptive_Rate_Print_Stats(&controller);
+
+    return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * @file batch_eval.cpp
+ * @brief Batch evaluation and benchmark of the Color_Classifier with the SIMD kernels of Batch_Evaluator.
+ *
+ * For each capture set, the program prints the confusion matrix, per-class precision and recall and
+ * a summary of the margin histograms. It then checks that every supported kernel is bit-exact with
+ * Color_Classifier_Classify, on random samples with random parameters and on samples placed around the
+ * thresholds and the 16-bit limits, and reports the throughput of each kernel in samples per second.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR batch_eval.cpp Batch_Evaluator.cpp Capture.cpp Color_Classifier.o -o batch_eval
+ *
+ * Usage: batch_eval [options] [capture.csv ...]
+ *   --kernel NAME        Kernel for the evaluation: scalar, sse2, avx2 or auto (default: auto)
+ *   --params G Y B R     Classifier parameters (default: Color_Classifier_Config.h)
+ *   --bench-samples N    Number of random samples for the benchmark (default: 16777216)
+ *   --repeat N           Passes over the benchmark samples per kernel (default: 8)
+ *   --margins-csv FILE   Write the margin histograms as CSV
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inc/Color_Classifier.h"
+#include "Batch_Evaluator.h"
+#include "Capture.h"
+
+namespace
+{
+
+const Batch_Kernel KERNELS[] = { Batch_Kernel::Scalar, Batch_Kernel::SSE2, Batch_Kernel::AVX2 };
+
+void Print_Result(const Batch_Result &result)
+{
+    static const char *const labels[] = { "green", "red", "yellow", "none" };
+
+    std::printf("%8s %10s %10s %10s %10s %10s\n", "label", "GREEN", "RED", "YELLOW", "UNKNOWN", "recall");
+
+    for (int label = 0; label < COLOR_CLASSIFIER_NUM_COLORS; label++)
+    {
+        std::printf("%8s", labels[label]);
+        for (int color = 0; color < COLOR_CLASSIFIER_NUM_COLORS; color++)
+        {
+            std::printf(" %10llu", (unsigned long long)result.confusion[label][color]);
+        }
+        std::printf(" %9.2f%%\n", 100.0 * result.Recall(label));
+    }
+
+    std::printf("%8s", "precis.");
+    for (int color = 0; color < COLOR_CLASSIFIER_NUM_COLORS; color++)
+    {
+        std::printf(" %9.2f%%", 100.0 * result.Precision(color));
+    }
+    std::printf("\naccuracy %.3f%% over %llu samples\n\n", 100.0 * result.Accuracy(), (unsigned long long)result.Total());
+
+    std::printf("margins (counts to the rule of the label, positive = rule satisfied; for none, the closest rule)\n");
+    std::printf("%8s %10s %10s %10s %10s\n", "label", "p1", "p5", "p50", "p95");
+
+    for (int label = 0; label < COLOR_CLASSIFIER_NUM_COLORS; label++)
+    {
+        std::printf("%8s %10d %10d %10d %10d\n", labels[label],
+                    result.Margin_Percentile(label, 0.01), result.Margin_Percentile(label, 0.05),
+                    result.Margin_Percentile(label, 0.50), result.Margin_Percentile(label, 0.95));
+    }
+}
+
+bool Write_Margins(const char *path, const Batch_Result &result)
+{
+    FILE *file = std::fopen(path, "w");
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    std::fprintf(file, "margin,green,red,yellow,none\n");
+
+    for (int bin = 0; bin < BATCH_MARGIN_BINS; bin++)
+    {
+        std::fprintf(file, "%d", (bin << BATCH_MARGIN_BIN_SHIFT) - 65536);
+        for (int label = 0; label < COLOR_CLASSIFIER_NUM_COLORS; label++)
+        {
+            std::fprintf(file, ",%llu", (unsigned long long)result.margin[label][bin]);
+        }
+        std::fprintf(file, "\n");
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+// Values around a threshold and the 16-bit limits, where saturation and strict comparisons matter
+void Add_Edge_Values(std::vector<uint16_t> &values, uint32_t threshold)
+{
+    for (int32_t offset = -2; offset <= 2; offset++)
+    {
+        int32_t value = (int32_t)threshold + offset;
+        if ((value >= 0) && (value <= 0xFFFF)) values.push_back((uint16_t)value);
+    }
+}
+
+// Compares a kernel with Color_Classifier_Classify and returns the number of mismatches
+uint64_t Verify_Kernel(Batch_Kernel kernel)
+{
+    std::mt19937 rng(528);
+    uint64_t mismatches = 0;
+
+    for (int round = 0; round < 64; round++)
+    {
+        Color_Classifier_Params params = Color_Classifier_Default_Params;
+
+        if (round > 0)
+        {
+            // Random parameters, including the extremes
+            const uint16_t extremes[] = { 0, 1, 0x7FFF, 0x8000, 0xFFFE, 0xFFFF };
+            uint16_t *fields[] = { &params.green_margin, &params.yellow_min_rg, &params.yellow_max_blue, &params.red_margin };
+
+            for (uint16_t *field : fields)
+            {
+                *field = (rng() % 4 == 0) ? extremes[rng() % 6] : (uint16_t)rng();
+            }
+        }
+
+        // Edge values around every threshold and around threshold-shifted channel values
+        std::vector<uint16_t> edges = { 0, 1, 2, 0x7FFF, 0x8000, 0x8001, 0xFFFD, 0xFFFE, 0xFFFF };
+        Add_Edge_Values(edges, params.yellow_min_rg);
+        Add_Edge_Values(edges, params.yellow_max_blue);
+        Add_Edge_Values(edges, params.green_margin);
+        Add_Edge_Values(edges, params.red_margin);
+        Add_Edge_Values(edges, 0x8000u + params.green_margin);
+        Add_Edge_Values(edges, 0x8000u + params.red_margin);
+        Add_Edge_Values(edges, 0xFFFFu - params.green_margin);
+        Add_Edge_Values(edges, 0xFFFFu - params.red_margin);
+
+        std::vector<uint16_t> red, green, blue;
+
+        for (uint16_t r : edges)
+        {
+            for (uint16_t g : edges)
+            {
+                for (uint16_t b : edges)
+                {
+                    red.push_back(r);
+                    green.push_back(g);
+                    blue.push_back(b);
+                }
+            }
+        }
+
+        // Random samples, and samples at a random offset from each other across the margins
+        for (int i = 0; i < 65536; i++)
+        {
+            uint16_t base = (uint16_t)rng();
+            int32_t offset = (int32_t)(rng() % 5) - 2;
+            int32_t margin = (i & 1) ? params.green_margin : params.red_margin;
+
+            red.push_back(base);
+            green.push_back((uint16_t)std::min<int32_t>(0xFFFF, std::max<int32_t>(0, base + margin + offset)));
+            blue.push_back((uint16_t)rng());
+        }
+
+        std::vector<uint8_t> colors(red.size());
+        Batch_Classify(kernel, params, red.data(), green.data(), blue.data(), colors.data(), red.size());
+
+        for (size_t i = 0; i < red.size(); i++)
+        {
+            if (colors[i] != (uint8_t)Color_Classifier_Classify(&params, red[i], green[i], blue[i])) mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    Batch_Kernel kernel = Batch_Best_Kernel();
+    Color_Classifier_Params params = Color_Classifier_Default_Params;
+    size_t bench_samples = 16777216;
+    int repeat = 8;
+    const char *margins_csv = nullptr;
+    Capture capture;
+    bool loaded = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--kernel") && (i + 1 < argc))
+        {
+            std::string name = argv[++i];
+            if (name == "scalar") kernel = Batch_Kernel::Scalar;
+            else if (name == "sse2") kernel = Batch_Kernel::SSE2;
+            else if (name == "avx2") kernel = Batch_Kernel::AVX2;
+            else if (name != "auto")
+            {
+                std::fprintf(stderr, "unknown kernel %s\n", name.c_str());
+                return 1;
+            }
+        }
+        else if ((option == "--params") && (i + 4 < argc))
+        {
+            params.green_margin = (uint16_t)std::strtoul(argv[++i], nullptr, 0);
+            params.yellow_min_rg = (uint16_t)std::strtoul(argv[++i], nullptr, 0);
+            params.yellow_max_blue = (uint16_t)std::strtoul(argv[++i], nullptr, 0);
+            params.red_margin = (uint16_t)std::strtoul(argv[++i], nullptr, 0);
+        }
+        else if ((option == "--bench-samples") && (i + 1 < argc)) bench_samples = std::strtoull(argv[++i], nullptr, 10);
+        else if ((option == "--repeat") && (i + 1 < argc)) repeat = std::max(1, std::atoi(argv[++i]));
+        else if ((option == "--margins-csv") && (i + 1 < argc)) margins_csv = argv[++i];
+        else if (option.compare(0, 2, "--") == 0)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else
+        {
+            if (!Capture_Load(argv[i], capture)) return 1;
+            loaded = true;
+        }
+    }
+
+    if (!Batch_Kernel_Supported(kernel))
+    {
+        std::fprintf(stderr, "kernel %s is not supported on this host\n", Batch_Kernel_Name(kernel));
+        return 1;
+    }
+
+    std::printf("params: green_margin=%u yellow_min_rg=0x%04X yellow_max_blue=0x%04X red_margin=%u\n\n",
+                params.green_margin, params.yellow_min_rg, params.yellow_max_blue, params.red_margin);
+
+    if (loaded)
+    {
+        Batch_Result result;
+        Batch_Confusion(kernel, params, capture, result);
+        Batch_Margins(params, capture, result);
+        Print_Result(result);
+        std::printf("\n");
+
+        if (margins_csv && !Write_Margins(margins_csv, result)) return 1;
+    }
+
+    // Benchmark samples: the loaded captures tiled to the requested size, or random samples
+    Capture bench;
+    std::mt19937 rng(1);
+
+    for (size_t i = 0; i < bench_samples; i++)
+    {
+        if (loaded && capture.Size())
+        {
+            size_t j = i % capture.Size();
+            bench.Append(0, capture.label[j], capture.red[j], capture.green[j], capture.blue[j]);
+        }
+        else
+        {
+            bench.Append(0, (uint8_t)(rng() & 3), (uint16_t)rng(), (uint16_t)rng(), (uint16_t)rng());
+        }
+    }
+
+    std::vector<uint8_t> colors(bench.Size());
+    double scalar_rate = 0.0;
+    int failures = 0;
+
+    std::printf("%8s %10s %16s %16s %10s\n", "kernel", "bit-exact", "classify (MS/s)", "confusion (MS/s)", "speedup");
+
+    for (Batch_Kernel candidate : KERNELS)
+    {
+        if (!Batch_Kernel_Supported(candidate))
+        {
+            std::printf("%8s   not supported on this host\n", Batch_Kernel_Name(candidate));
+            continue;
+        }
+
+        uint64_t mismatches = Verify_Kernel(candidate);
+        if (mismatches) failures++;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < repeat; pass++)
+        {
+            Batch_Classify(candidate, params, bench.red.data(), bench.green.data(), bench.blue.data(), colors.data(), bench.Size());
+        }
+        double classify_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        Batch_Result result;
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < repeat; pass++)
+        {
+            Batch_Confusion(candidate, params, bench, result);
+        }
+        double confusion_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double classify_rate = bench.Size() * (double)repeat / classify_s;
+        double confusion_rate = bench.Size() * (double)repeat / confusion_s;
+        if (candidate == Batch_Kernel::Scalar) scalar_rate = confusion_rate;
+
+        std::printf("%8s %10s %16.1f %16.1f %9.1fx\n", Batch_Kernel_Name(candidate),
+                    mismatches ? "NO" : "yes", classify_rate * 1e-6, confusion_rate * 1e-6,
+                    scalar_rate ? confusion_rate / scalar_rate : 1.0);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,359 @@
+/**
+ * @file board_decoder_bench.cpp
+ * @brief Checks and benchmarks Board_Decoder on text, binary and mixed streams.
+ *
+ * The program generates the output of a board in three formats: text lines as printed by main.c,
+ * binary frames encoded with Board_Protocol, and binary samples mixed with text events. Each stream is
+ * decoded with the synchronous and the callback APIs, in receive buffers of several sizes, and the
+ * decoded events are compared with the generated ones. The callback API is also run with a handler
+ * that refuses every 1000th event (backpressure), and a corrupted copy of each stream checks that the
+ * decoder resynchronizes. Throughput includes copying each buffer as a read() would.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR board_decoder_bench.cpp Board_Decoder.cpp Board_Protocol.o -o board_decoder_bench
+ *
+ * Usage: board_decoder_bench [--megabytes N] [--repeat N]
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inc/Board_Protocol.h"
+#include "Board_Decoder.h"
+
+namespace
+{
+
+// Bytes per second of a 115200 baud UART with 8N1 framing
+constexpr double UART_BYTES_PER_SECOND = 11520.0;
+
+enum class Format
+{
+    Text,
+    Binary,
+    Mixed
+};
+
+const char *Format_Name(Format format)
+{
+    switch (format)
+    {
+        case Format::Text:   return "text";
+        case Format::Binary: return "binary";
+        default:             return "mixed";
+    }
+}
+
+// Totals of a stream, compared between the generator and the decoder
+struct Totals
+{
+    uint64_t samples = 0;
+    uint64_t detections = 0;
+    uint64_t games = 0;
+    uint64_t rate_stats = 0;
+    uint64_t reactions = 0;
+    uint64_t reaction_stats = 0;
+    uint64_t text = 0;
+    uint64_t checksum = 0;
+
+    bool operator==(const Totals &other) const
+    {
+        return (samples == other.samples) && (detections == other.detections) && (games == other.games) &&
+               (rate_stats == other.rate_stats) && (reactions == other.reactions) && (reaction_stats == other.reaction_stats) &&
+               (text == other.text) && (checksum == other.checksum);
+    }
+
+    void Add(const Board_Event &event)
+    {
+        switch (event.type)
+        {
+            case Board_Event_Type::Sample:
+                samples++;
+                checksum += event.sample.red * 3u + event.sample.green * 5u + event.sample.blue * 7u + event.sample.clear * 11u;
+                break;
+            case Board_Event_Type::Detection:  detections++; checksum += event.color; break;
+            case Board_Event_Type::Game:       games++; checksum += 100 + event.game_result; break;
+            case Board_Event_Type::Rate_Stats: rate_stats++; checksum += event.rate_stats.bursts + event.rate_stats.total_ms; break;
+            case Board_Event_Type::Reaction:
+                reactions++;
+                checksum += event.reaction.step + event.reaction.reaction_ms + event.reaction.pipeline_ms * 3u;
+                break;
+            case Board_Event_Type::Reaction_Stats:
+                reaction_stats++;
+                checksum += event.reaction_stats.steps + event.reaction_stats.reaction_p90_ms + event.reaction_stats.best_round_ms;
+                break;
+            default:                           text++; break;
+        }
+    }
+};
+
+void Append_Frame(std::vector<uint8_t> &stream, const uint8_t *frame, int length)
+{
+    stream.insert(stream.end(), frame, frame + length);
+}
+
+void Append_Text(std::vector<uint8_t> &stream, const char *text)
+{
+    stream.insert(stream.end(), text, text + std::strlen(text));
+}
+
+// Generates about size bytes of board output
+std::vector<uint8_t> Generate(Format format, size_t size, Totals &totals)
+{
+    static const char *const DETECTIONS[3] = { "GREEN\n", "RED\n", "YELLOW\n" };
+    static const char *const GAMES[3] = { "Wrong! Restarting...\n", "Correct step!\n", "ACCESS GRANTED!\n" };
+    std::vector<uint8_t> stream;
+    std::mt19937 rng(86);
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+    char line[128];
+    uint8_t sequence = 0;
+    uint32_t time_ms = 0;
+
+    Append_Text(stream, "PMOD COLOR has been initialized and powered on.\n");
+    totals.text++;
+
+    for (uint32_t n = 0; stream.size() < size; n++)
+    {
+        PMOD_Color_Data data = { (uint16_t)rng(), (uint16_t)rng(), (uint16_t)rng(), (uint16_t)((format == Format::Text) ? 0 : rng()) };
+
+        time_ms += 3;
+
+        if (format == Format::Text)
+        {
+            std::snprintf(line, sizeof(line), "r=%04x g=%04x b=%04x\r\n", data.red, data.green, data.blue);
+            Append_Text(stream, line);
+        }
+        else
+        {
+            Append_Frame(stream, frame, Board_Protocol_Encode_Sample(sequence++, time_ms, &data, frame, sizeof(frame)));
+        }
+
+        totals.samples++;
+        totals.checksum += data.red * 3u + data.green * 5u + data.blue * 7u + data.clear * 11u;
+
+        if (n % 200 == 100)
+        {
+            uint8_t color = (uint8_t)(rng() % 3);
+
+            if (format == Format::Binary) Append_Frame(stream, frame, Board_Protocol_Encode_Detection(sequence++, color, frame, sizeof(frame)));
+            else Append_Text(stream, DETECTIONS[color]);
+
+            totals.detections++;
+            totals.checksum += color;
+        }
+
+        if (n % 800 == 101)
+        {
+            uint8_t result = (uint8_t)(rng() % 3);
+
+            if (format == Format::Binary) Append_Frame(stream, frame, Board_Protocol_Encode_Game(sequence++, result, frame, sizeof(frame)));
+            else Append_Text(stream, GAMES[result]);
+
+            totals.games++;
+            totals.checksum += 100 + result;
+        }
+
+        if (n % 5000 == 102)
+        {
+            Board_Protocol_Rate_Stats stats = { n / 2, n, n / 2, n * 2, n / 100, n * 3, n * 5, n * 3 };
+
+            if (format == Format::Binary)
+            {
+                Append_Frame(stream, frame, Board_Protocol_Encode_Rate_Stats(sequence++, &stats, frame, sizeof(frame)));
+            }
+            else
+            {
+                std::snprintf(line, sizeof(line), "rate idle: %u samples, %u ms\n", stats.idle_samples, stats.idle_ms);
+                Append_Text(stream, line);
+                std::snprintf(line, sizeof(line), "rate burst: %u samples, %u ms, %u bursts\n", stats.burst_samples, stats.burst_ms, stats.bursts);
+                Append_Text(stream, line);
+                std::snprintf(line, sizeof(line), "rate energy: %u uJ adaptive, %u uJ fixed over %u ms (40%% saved)\n",
+                              stats.adaptive_uJ, stats.fixed_uJ, stats.total_ms);
+                Append_Text(stream, line);
+            }
+
+            totals.rate_stats++;
+            totals.checksum += stats.bursts + stats.total_ms;
+        }
+
+        if (n % 800 == 103)
+        {
+            Reaction_Step step = { (uint8_t)(1 + rng() % 4), 0, 300 + (uint32_t)(rng() % 3000), 150 + (uint32_t)(rng() % 1000) };
+
+            step.since_start_ms = step.reaction_ms + step.pipeline_ms;
+
+            if (format == Format::Binary)
+            {
+                Append_Frame(stream, frame, Board_Protocol_Encode_Reaction(sequence++, &step, frame, sizeof(frame)));
+            }
+            else
+            {
+                std::snprintf(line, sizeof(line), "step %u: %u ms after the pattern, %u ms reaction, %u ms pipeline\n",
+                              step.step, step.since_start_ms, step.reaction_ms, step.pipeline_ms);
+                Append_Text(stream, line);
+            }
+
+            totals.reactions++;
+            totals.checksum += step.step + step.reaction_ms + step.pipeline_ms * 3u;
+        }
+
+        if (n % 5000 == 104)
+        {
+            Reaction_Summary summary = { n / 800, 900, 800, 1700, 160, 200, (uint16_t)(n / 3200), (uint16_t)(n / 9600),
+                                         (uint16_t)(n / 4800), 6000 + n % 1000, 4000 + n % 500 };
+
+            if (format == Format::Binary)
+            {
+                Append_Frame(stream, frame, Board_Protocol_Encode_Reaction_Stats(sequence++, &summary, frame, sizeof(frame)));
+            }
+            else
+            {
+                std::snprintf(line, sizeof(line), "reaction steps: %u, mean %u ms, p50 %u ms, p90 %u ms\n", summary.steps,
+                              summary.reaction_mean_ms, summary.reaction_p50_ms, summary.reaction_p90_ms);
+                Append_Text(stream, line);
+                std::snprintf(line, sizeof(line), "reaction pipeline: mean %u ms, p90 %u ms\n", summary.pipeline_mean_ms, summary.pipeline_p90_ms);
+                Append_Text(stream, line);
+                std::snprintf(line, sizeof(line), "reaction rounds: %u complete, %u failed, %u misses, mean %u ms, best %u ms\n",
+                              summary.rounds, summary.fails, summary.misses, summary.round_mean_ms, summary.best_round_ms);
+                Append_Text(stream, line);
+            }
+
+            totals.reaction_stats++;
+            totals.checksum += summary.steps + summary.reaction_p90_ms + summary.best_round_ms;
+        }
+    }
+
+    return stream;
+}
+
+// Decodes a stream in buffers of chunk bytes. With refuse_every > 0, the callback refuses that often,
+// and the rest of the buffer is passed again, as a reader that stopped reading would do.
+Totals Decode_Stream(const std::vector<uint8_t> &stream, size_t chunk, bool callbacks, uint64_t refuse_every, Board_Decoder &decoder)
+{
+    std::vector<uint8_t> buffer(chunk);
+    Totals totals;
+    uint64_t calls = 0;
+
+    for (size_t offset = 0; offset < stream.size(); offset += chunk)
+    {
+        size_t size = std::min(chunk, stream.size() - offset);
+        std::memcpy(buffer.data(), stream.data() + offset, size);
+
+        if (callbacks)
+        {
+            size_t consumed = 0;
+
+            while (consumed < size)
+            {
+                consumed += decoder.Decode(buffer.data() + consumed, size - consumed, 0, [&](const Board_Event &event)
+                {
+                    totals.Add(event);
+                    return (refuse_every == 0) || (++calls % refuse_every != 0);
+                });
+            }
+        }
+        else
+        {
+            Board_Event event;
+
+            decoder.Feed(buffer.data(), size);
+            while (decoder.Next(event)) totals.Add(event);
+        }
+    }
+
+    return totals;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    size_t megabytes = 32;
+    int repeat = 3;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--megabytes") && (i + 1 < argc)) megabytes = std::strtoul(argv[++i], nullptr, 10);
+        else if ((option == "--repeat") && (i + 1 < argc)) repeat = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    const Format formats[] = { Format::Text, Format::Binary, Format::Mixed };
+    const size_t chunks[] = { 64, 4096, 65536 };
+    int failures = 0;
+
+    std::printf("%8s %8s %9s %8s %10s %12s %12s\n", "format", "api", "buffer", "correct", "MB/s", "Mevents/s", "x 115200 bd");
+
+    for (Format format : formats)
+    {
+        Totals expected;
+        std::vector<uint8_t> stream = Generate(format, megabytes << 20, expected);
+
+        for (int api = 0; api < 2; api++)
+        {
+            for (size_t chunk : chunks)
+            {
+                double best_s = 1e30;
+                bool correct = true;
+
+                for (int pass = 0; pass < repeat; pass++)
+                {
+                    Board_Decoder decoder;
+                    auto start = std::chrono::steady_clock::now();
+                    Totals decoded = Decode_Stream(stream, chunk, api == 1, 0, decoder);
+                    best_s = std::min(best_s, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+                    const Board_Decoder_Counters &counters = decoder.Counters();
+                    correct = correct && (decoded == expected) && (counters.malformed == 0) && (counters.crc_errors == 0) &&
+                              (counters.overlong == 0) && (counters.lost_frames == 0);
+                }
+
+                uint64_t events = expected.samples + expected.detections + expected.games + expected.rate_stats +
+                                  expected.reactions + expected.reaction_stats + expected.text;
+                failures += !correct;
+
+                std::printf("%8s %8s %9zu %8s %10.1f %12.2f %12.0f\n", Format_Name(format), api ? "callback" : "sync", chunk,
+                            correct ? "yes" : "NO", stream.size() / best_s * 1e-6, events / best_s * 1e-6,
+                            stream.size() / best_s / UART_BYTES_PER_SECOND);
+            }
+        }
+
+        // Backpressure: the handler refuses every 1000th event and the caller passes the rest again
+        Board_Decoder decoder;
+        bool backpressure_ok = (Decode_Stream(stream, 4096, true, 1000, decoder) == expected);
+        failures += !backpressure_ok;
+
+        // Corruption: one random byte in 10000 is changed; the decoder must resynchronize
+        std::vector<uint8_t> corrupted = stream;
+        std::mt19937 rng(1);
+        size_t flips = corrupted.size() / 10000;
+        for (size_t f = 0; f < flips; f++) corrupted[rng() % corrupted.size()] ^= (uint8_t)(1 + rng() % 255);
+
+        Board_Decoder corrupted_decoder;
+        Totals recovered = Decode_Stream(corrupted, 4096, false, 0, corrupted_decoder);
+        const Board_Decoder_Counters &counters = corrupted_decoder.Counters();
+
+        std::printf("%8s backpressure %s; %zu corrupted bytes: %.3f%% of samples recovered, %" PRIu64 " malformed, %" PRIu64
+                    " CRC errors, %" PRIu64 " lost frames, %" PRIu64 " overlong\n\n",
+                    Format_Name(format), backpressure_ok ? "ok" : "FAILED", flips, 100.0 * recovered.samples / expected.samples,
+                    counters.malformed, counters.crc_errors, counters.lost_frames, counters.overlong);
+    }
+
+    return failures ? 1 : 0;
+}
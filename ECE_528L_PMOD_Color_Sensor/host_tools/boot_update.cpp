@@ -0,0 +1,243 @@
+/**
+ * @file boot_update.cpp
+ * @brief Updates the firmware of a board through the UART bootloader.
+ *
+ * The board must hold the resident bootloader (PMOD_COLOR_BOOT, see Bootloader_MSP432.h). The
+ * program requests the bootloader, which a running application passes on by resetting the board
+ * (main.c does, in Check_Host_Input). A board that stays in the bootloader after an interrupted
+ * update answers directly, and one whose application does not answer can be reset by hand while the
+ * program waits. It then switches to the update baud rate, rewrites only the sectors whose CRC-32
+ * differs from the new image, verifies the whole image, writes the application header and starts it
+ * (see Boot_Updater.h). If the update is interrupted, run the program again.
+ *
+ * The image is a raw binary of the application that starts at the application address (0x3000), as
+ * written by the CCS post-build step "tiobj2bin" or by "armhex -b" for an application linked with
+ * msp432p401r.cmd. The delta mode only compares two images and prints the sectors an update would
+ * rewrite, without a board.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Bootloader.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR boot_update.cpp Boot_Updater.cpp Bootloader.o -o boot_update
+ *
+ * Usage: boot_update [options] PORT IMAGE.bin
+ *   --full                   Rewrite every sector of the image
+ *   --baud RATE              Baud rate of the update (default: 921600, 0 stays at 115200)
+ *   --no-run                 Leave the board in the bootloader after the update
+ *
+ *        boot_update --delta OLD.bin NEW.bin
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "inc/Bootloader.h"
+#include "Boot_Updater.h"
+
+namespace
+{
+
+// Sector size of the MSP432P401R, for the delta mode
+constexpr uint32_t SECTOR_SIZE = 0x1000;
+
+speed_t Baud_Constant(uint32_t baud)
+{
+    switch (baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+#ifdef B1500000
+        case 1500000: return B1500000;
+#endif
+        default:      return B0;
+    }
+}
+
+class Serial_Link : public Boot_Link
+{
+public:
+    ~Serial_Link() override
+    {
+        if (fd >= 0) close(fd);
+    }
+
+    bool Open(const char *port)
+    {
+        fd = open(port, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct termios settings;
+
+        if (tcgetattr(fd, &settings) != 0) return false;
+        cfmakeraw(&settings);
+        settings.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(fd, TCSANOW, &settings);
+
+        return Set_Baud(115200);
+    }
+
+    bool Send(const uint8_t *data, size_t size) override
+    {
+        while (size > 0)
+        {
+            ssize_t written = write(fd, data, size);
+            if (written <= 0) return false;
+            data += written;
+            size -= (size_t)written;
+        }
+
+        // Return when the bytes have left the host, like the send of the bootloader
+        tcdrain(fd);
+        return true;
+    }
+
+    size_t Receive(uint8_t *data, size_t size, int timeout_ms) override
+    {
+        fd_set read_set;
+        struct timeval timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000 };
+
+        FD_ZERO(&read_set);
+        FD_SET(fd, &read_set);
+        if (select(fd + 1, &read_set, nullptr, nullptr, &timeout) <= 0) return 0;
+
+        ssize_t count = read(fd, data, size);
+        return (count > 0) ? (size_t)count : 0;
+    }
+
+    bool Set_Baud(uint32_t baud) override
+    {
+        speed_t constant = Baud_Constant(baud);
+        struct termios settings;
+
+        if ((constant == B0) || (tcgetattr(fd, &settings) != 0)) return false;
+        cfsetispeed(&settings, constant);
+        cfsetospeed(&settings, constant);
+        return tcsetattr(fd, TCSADRAIN, &settings) == 0;
+    }
+
+private:
+    int fd = -1;
+};
+
+bool Read_File(const char *path, std::vector<uint8_t> &data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int Print_Delta(const char *old_path, const char *new_path)
+{
+    std::vector<uint8_t> old_image;
+    std::vector<uint8_t> new_image;
+
+    if (!Read_File(old_path, old_image) || !Read_File(new_path, new_image))
+    {
+        fprintf(stderr, "Cannot read the images\n");
+        return 1;
+    }
+
+    // The board CRCs of a flash that holds the old image, from the header sector on
+    std::vector<uint8_t> new_flash = Boot_Flash_Image(new_image, SECTOR_SIZE);
+    std::vector<uint32_t> board_crcs = Boot_Sector_CRCs(Boot_Flash_Image(old_image, SECTOR_SIZE), SECTOR_SIZE);
+    Boot_Delta delta = Boot_Delta_Generate(new_flash, board_crcs, SECTOR_SIZE, BOOTLOADER_MAX_DATA, false);
+    Boot_Delta full = Boot_Delta_Generate(new_flash, board_crcs, SECTOR_SIZE, BOOTLOADER_MAX_DATA, true);
+    uint32_t first = BOOTLOADER_APP_HEADER_ADDRESS / SECTOR_SIZE;
+
+    printf("Sectors to rewrite: %zu of %u (sector %u is the application header)\n", delta.sectors.size(), delta.image_sectors, first);
+    for (uint32_t sector : delta.sectors) printf("  sector %2u  0x%05X\n", first + sector, (first + sector) * SECTOR_SIZE);
+    printf("PROGRAM data: %llu bytes (full update: %llu bytes)\n",
+           (unsigned long long)delta.program_bytes, (unsigned long long)full.program_bytes);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Boot_Update_Options options;
+    std::vector<const char *> paths;
+    bool usage_error = false;
+
+    if ((argc == 4) && !strcmp(argv[1], "--delta")) return Print_Delta(argv[2], argv[3]);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--full")) options.full = true;
+        else if (!strcmp(argv[i], "--no-run")) options.run = false;
+        else if (!strcmp(argv[i], "--baud") && (i + 1 < argc)) options.baud = (uint32_t)atol(argv[++i]);
+        else if (argv[i][0] != '-') paths.push_back(argv[i]);
+        else usage_error = true;
+    }
+
+    if (usage_error || (paths.size() != 2) || ((options.baud != 0) && (Baud_Constant(options.baud) == B0)))
+    {
+        fprintf(stderr, "Usage: %s [--full] [--baud RATE] [--no-run] PORT IMAGE.bin\n", argv[0]);
+        fprintf(stderr, "       %s --delta OLD.bin NEW.bin\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<uint8_t> image;
+    if (!Read_File(paths[1], image) || image.empty())
+    {
+        fprintf(stderr, "Cannot read %s\n", paths[1]);
+        return 1;
+    }
+
+    Serial_Link link;
+    if (!link.Open(paths[0]))
+    {
+        fprintf(stderr, "Cannot open %s\n", paths[0]);
+        return 1;
+    }
+
+    Boot_Updater updater(link);
+    Boot_Info info;
+
+    printf("Requesting the bootloader on %s...\n", paths[0]);
+    if (!updater.Connect(info))
+    {
+        fprintf(stderr, "%s\n", updater.Error().c_str());
+        return 1;
+    }
+    printf("Bootloader version %u, flash %u KB, sector %u bytes, application at 0x%05X\n", info.version,
+           info.flash_size / 1024, info.sector_size, info.app_address);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = updater.Update(image, info, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const Boot_Update_Stats &stats = updater.Stats();
+
+    if (!ok)
+    {
+        fprintf(stderr, "Update failed: %s\n", updater.Error().c_str());
+        return 1;
+    }
+    if (!updater.Error().empty()) printf("Note: %s\n", updater.Error().c_str());
+
+    printf("Rewrote %u of %u sectors at %u baud in %.2f s (%llu bytes sent, %u retries)\n",
+           stats.sectors_written, stats.image_sectors, updater.Baud(), seconds,
+           (unsigned long long)stats.bytes_sent, stats.retries);
+    printf(options.run ? "The new image is running\n" : "The board is waiting in the bootloader\n");
+    return 0;
+}
@@ -0,0 +1,492 @@
+/**
+ * @file boot_update_bench.cpp
+ * @brief Checks Boot_Updater against the emulated bootloader and compares delta and full update times.
+ *
+ * The program runs the firmware's Bootloader core on the Bootloader_Sim flash emulator and drives it
+ * with Boot_Updater through a simulated serial link. Each scenario starts from a board that runs an
+ * old application, updates it to a new one with a delta update and with a full update, at 115200 baud
+ * and at the update rate, and checks that the flash holds the new application and a valid header,
+ * that the sectors of the resident bootloader are unchanged and that the reset after RUN started the
+ * new application.
+ *
+ * Update times come from a model of the link and the flash, since nothing runs in real time:
+ *   - 10 bit times per byte in each direction, at the rate of the sender,
+ *   - a fixed turnaround per request (USB serial adapters poll every millisecond),
+ *   - a sector erase time and a time per programmed 128-bit flash word,
+ *   - the time the MSP432 takes to compute the CRC-32 of a flash byte with the bitwise CRC.
+ * The flash times are estimates; measure them on a board with --erase-ms and --program-us if needed.
+ *
+ * Two fault scenarios repeat the one-function update with corrupted bytes on the link, and with a
+ * link that cannot run at the update rate, which must fall back to 115200 baud.
+ *
+ * The interrupted updates cut the power during one erase or programmed flash word of the one-function
+ * update: at every one of them for the delta update, and at every 41st for the full update. The header
+ * is the last flash word programmed, so after the power comes back the board must stay in the
+ * bootloader; starting anything but the complete new application is a failure. Running the updater
+ * again must then complete the update. Last, one byte of an installed application is corrupted: the
+ * check at reset must keep the board in the bootloader, and a delta update must repair it.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Bootloader.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Bootloader_Sim.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR boot_update_bench.cpp Boot_Updater.cpp Bootloader.o Bootloader_Sim.o -o boot_update_bench
+ *
+ * Usage: boot_update_bench [--baud N] [--image-kb N] [--erase-ms X] [--program-us X] [--latency-ms X]
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inc/Bootloader.h"
+#include "inc/Bootloader_Sim.h"
+#include "Boot_Updater.h"
+
+namespace
+{
+
+struct Timing
+{
+    double erase_ms = 12.0;             // Sector erase
+    double program_us = 40.0;           // 128-bit flash word
+    double latency_ms = 1.0;            // Turnaround per request
+    double crc_us_per_byte = 1.7;       // Bitwise CRC-32 at 48 MHz, from SRAM
+};
+
+// Serial link to an emulated board, with simulated time
+class Sim_Link : public Boot_Link
+{
+public:
+    Sim_Link(const Timing &timing, uint32_t baud, uint32_t max_baud, double error_rate, uint32_t seed)
+        : timing(timing), sim(new Bootloader_Sim_Context), host_baud(baud), max_baud(max_baud),
+          error_rate(error_rate), random(seed)
+    {
+        Bootloader_Sim_Init(&bootloader, sim.get(), baud);
+        resident.assign(sim->flash, sim->flash + BOOTLOADER_RESIDENT_SIZE);
+    }
+
+    bool Send(const uint8_t *data, size_t size) override
+    {
+        seconds += timing.latency_ms / 1000.0 + size * 10.0 / host_baud;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            uint32_t board_baud = sim->baud;
+            uint32_t erases = sim->erase_count;
+            uint32_t words = sim->program_word_count;
+            uint32_t checked = bootloader.checked_byte_count;
+
+            idle_ms = 0;
+            Bootloader_Sim_Receive_Byte(&bootloader, sim.get(), Corrupt(data[i], board_baud));
+
+            seconds += (sim->erase_count - erases) * timing.erase_ms / 1000.0 +
+                       (sim->program_word_count - words) * timing.program_us / 1e6 +
+                       (bootloader.checked_byte_count - checked) * timing.crc_us_per_byte / 1e6;
+
+            // A response is sent before a SET_BAUD takes effect, so at the rate the request arrived at
+            Collect(board_baud);
+        }
+
+        return true;
+    }
+
+    size_t Receive(uint8_t *data, size_t size, int timeout_ms) override
+    {
+        if (pending.empty() && (timeout_ms > 0))
+        {
+            // Nothing arrives: the time passes, and the board sees idle periods
+            seconds += timeout_ms / 1000.0;
+            idle_ms += timeout_ms;
+            while (idle_ms >= 100)
+            {
+                idle_ms -= 100;
+                if (sim->state == BOOTLOADER_SIM_STATE_BOOTLOADER) Bootloader_Idle(&bootloader);
+                Collect(sim->baud);
+            }
+        }
+
+        size_t count = std::min(size, pending.size());
+        std::copy(pending.begin(), pending.begin() + count, data);
+        pending.erase(pending.begin(), pending.begin() + count);
+        return count;
+    }
+
+    bool Set_Baud(uint32_t baud) override
+    {
+        if (baud > max_baud) return false;
+        host_baud = baud;
+        return true;
+    }
+
+    // Installs an application and resets the board, which starts it
+    void Load(const std::vector<uint8_t> &image)
+    {
+        Bootloader_Sim_Load(sim.get(), image.data(), (uint32_t)image.size());
+        Bootloader_Sim_Reset(&bootloader, sim.get(), 0);
+    }
+
+    double seconds = 0.0;
+    Bootloader bootloader;
+    Timing timing;
+    std::unique_ptr<Bootloader_Sim_Context> sim;
+    std::vector<uint8_t> resident;      // Sectors of the bootloader after Bootloader_Sim_Init
+
+private:
+    // A byte sent at one rate and received at another is garbage; others are corrupted at random
+    uint8_t Corrupt(uint8_t byte, uint32_t receiver_baud)
+    {
+        if (receiver_baud != host_baud) byte ^= 0xA5;
+        if ((error_rate > 0.0) && (std::uniform_real_distribution<double>(0.0, 1.0)(random) < error_rate))
+        {
+            byte ^= (uint8_t)(1u << (random() % 8));
+        }
+        return byte;
+    }
+
+    void Collect(uint32_t board_baud)
+    {
+        uint8_t buffer[BOOTLOADER_SIM_OUTPUT_CAPACITY];
+        uint32_t length = Bootloader_Sim_Read_Output(sim.get(), buffer, sizeof(buffer));
+
+        seconds += length * 10.0 / board_baud;
+        for (uint32_t i = 0; i < length; i++) pending.push_back(Corrupt(buffer[i], board_baud));
+    }
+
+    uint32_t host_baud;
+    uint32_t max_baud;
+    double error_rate;
+    std::mt19937 random;
+    std::deque<uint8_t> pending;
+    int idle_ms = 0;
+};
+
+struct Scenario
+{
+    std::string name;
+    std::vector<uint8_t> old_image;     // Empty for an erased board
+    std::vector<uint8_t> new_image;
+};
+
+// Bytes that look like Thumb code: mostly 16-bit instructions with some repetition
+std::vector<uint8_t> Make_Code(size_t size, std::mt19937 &random)
+{
+    std::vector<uint8_t> code(size);
+    for (size_t i = 0; i < size; i += 2)
+    {
+        uint16_t instruction = (random() % 4 == 0) ? 0x4770 : (uint16_t)random();
+        code[i] = (uint8_t)instruction;
+        if (i + 1 < size) code[i + 1] = (uint8_t)(instruction >> 8);
+    }
+    return code;
+}
+
+std::vector<Scenario> Make_Scenarios(size_t image_size)
+{
+    std::mt19937 random(528);
+    size_t table_size = std::min<size_t>(2048, image_size / 4);
+    std::vector<uint8_t> base = Make_Code(image_size - table_size, random);
+
+    // Constant table at the end of the image, like the .const section
+    for (size_t i = 0; i < table_size; i++) base.push_back((uint8_t)(i * 7));
+
+    std::vector<Scenario> scenarios;
+    scenarios.push_back({ "first install", {}, base });
+
+    std::vector<uint8_t> function = base;
+    for (size_t i = 0; i < 96; i++) function[image_size / 3 + i] ^= 0x5A;
+    scenarios.push_back({ "one function changed", base, function });
+
+    std::vector<uint8_t> table = base;
+    for (size_t i = 0; i < 64; i++) table[image_size - table_size / 2 + i] += 1;
+    scenarios.push_back({ "constant table changed", base, table });
+
+    std::vector<uint8_t> shifted = base;
+    std::vector<uint8_t> inserted = Make_Code(64, random);
+    shifted.insert(shifted.begin() + 3000, inserted.begin(), inserted.end());
+    scenarios.push_back({ "code inserted at 3000", base, shifted });
+
+    scenarios.push_back({ "identical image", base, base });
+
+    return scenarios;
+}
+
+// Checks that the board runs an application after a reset, and that the flash holds the new application
+// with a valid header followed by erased bytes and an unchanged bootloader. Returns an error, or "".
+std::string Check_Board(const Sim_Link &link, const std::vector<uint8_t> &image)
+{
+    const uint8_t *flash = link.sim->flash;
+    const uint8_t *application = flash + BOOTLOADER_APP_ADDRESS;
+    std::vector<uint8_t> header = Boot_Flash_Image(image, BOOTLOADER_SIM_SECTOR_SIZE);
+    bool match = std::equal(image.begin(), image.end(), application);
+    bool erased_tail = std::all_of(application + image.size(), application + ((image.size() + 0xFFF) & ~(size_t)0xFFF),
+                                   [](uint8_t byte) { return byte == 0xFF; });
+
+    if (!std::equal(link.resident.begin(), link.resident.end(), flash) || (link.sim->protected_write_count != 0))
+    {
+        return "the sectors of the bootloader were written";
+    }
+    if (!match || !erased_tail) return "the flash does not hold the new image";
+    if (!std::equal(header.begin(), header.begin() + BOOTLOADER_APP_HEADER_SIZE, flash + BOOTLOADER_APP_HEADER_ADDRESS) ||
+        !Bootloader_Application_Valid(flash, BOOTLOADER_SIM_FLASH_SIZE))
+    {
+        return "the flash does not hold the header of the new image";
+    }
+    if (link.sim->state != BOOTLOADER_SIM_STATE_APPLICATION) return "the board was not started";
+    return "";
+}
+
+struct Result
+{
+    bool ok = false;
+    double seconds = 0.0;
+    Boot_Update_Stats stats;
+    std::string error;
+};
+
+Result Run_Update(const Scenario &scenario, const Timing &timing, bool full, uint32_t baud,
+                  uint32_t max_baud = BOOTLOADER_MAX_BAUD, double error_rate = 0.0)
+{
+    Sim_Link link(timing, 115200, max_baud, error_rate, 86);
+    Boot_Updater updater(link);
+    Boot_Update_Options options;
+    Boot_Info info;
+    Result result;
+
+    if (!scenario.old_image.empty()) link.Load(scenario.old_image);
+
+    if (!updater.Connect(info))
+    {
+        result.error = updater.Error();
+        return result;
+    }
+
+    options.full = full;
+    options.baud = (baud == 115200) ? 0 : baud;
+
+    double start = link.seconds;
+    bool ok = updater.Update(scenario.new_image, info, options);
+
+    result.seconds = link.seconds - start;
+    result.stats = updater.Stats();
+    result.stats.baud = updater.Baud();
+    result.error = updater.Error();
+
+    if (!ok) return result;
+
+    result.error = Check_Board(link, scenario.new_image);
+    result.ok = result.error.empty();
+    return result;
+}
+
+struct Interrupted_Result
+{
+    uint32_t points = 0;
+    uint32_t stayed = 0;                // Stayed in the bootloader after the reset
+    uint32_t started = 0;               // Started the complete new application after the reset
+    std::string error;
+};
+
+// Corrupts one byte of an installed application: the board must stay in the bootloader after a reset,
+// and a delta update must repair it. Returns an error, or "".
+std::string Run_Corrupted(const std::vector<uint8_t> &image, const Timing &timing, Boot_Update_Stats &stats)
+{
+    Sim_Link link(timing, 115200, BOOTLOADER_MAX_BAUD, 0.0, 86);
+    Boot_Updater updater(link);
+    Boot_Update_Options options;
+    Boot_Info info;
+
+    link.Load(image);
+    link.sim->flash[BOOTLOADER_APP_ADDRESS + image.size() / 2] ^= 0x10;
+    Bootloader_Sim_Reset(&link.bootloader, link.sim.get(), 0);
+
+    if (link.sim->state != BOOTLOADER_SIM_STATE_BOOTLOADER) return "the board started a corrupted application";
+    if (!updater.Connect(info) || !updater.Update(image, info, options)) return updater.Error();
+
+    stats = updater.Stats();
+    return Check_Board(link, image);
+}
+
+// Cuts the power at every stride-th flash operation of an update, resets the board and updates it again
+Interrupted_Result Run_Interrupted(const Scenario &scenario, const Timing &timing, bool full, uint32_t baud, uint32_t stride)
+{
+    Interrupted_Result result;
+
+    for (uint32_t operation = 1; result.error.empty(); operation += stride)
+    {
+        Sim_Link link(timing, 115200, BOOTLOADER_MAX_BAUD, 0.0, 86);
+        Boot_Update_Options options;
+        Boot_Info info;
+
+        if (!scenario.old_image.empty()) link.Load(scenario.old_image);
+
+        Boot_Updater updater(link);
+        if (!updater.Connect(info))
+        {
+            result.error = updater.Error();
+            break;
+        }
+
+        options.full = full;
+        options.baud = baud;
+        Bootloader_Sim_Power_Fail(link.sim.get(), operation);
+
+        // The update completed before the operation: every point has been tried
+        if (updater.Update(scenario.new_image, info, options)) break;
+
+        result.points++;
+        Bootloader_Sim_Reset(&link.bootloader, link.sim.get(), 0);
+
+        if (link.sim->state == BOOTLOADER_SIM_STATE_BOOTLOADER)
+        {
+            result.stayed++;
+        }
+        else if (!Check_Board(link, scenario.new_image).empty())
+        {
+            result.error = "operation " + std::to_string(operation) + ": the board started an incomplete application";
+            break;
+        }
+        else
+        {
+            result.started++;
+        }
+
+        // The host reopens the port at 115200 baud and runs the update again
+        Boot_Updater recovery(link);
+        link.Set_Baud(115200);
+
+        if (!recovery.Connect(info) || !recovery.Update(scenario.new_image, info, options))
+        {
+            result.error = "operation " + std::to_string(operation) + ": " + recovery.Error();
+            break;
+        }
+
+        std::string error = Check_Board(link, scenario.new_image);
+        if (!error.empty()) result.error = "operation " + std::to_string(operation) + " then update: " + error;
+    }
+
+    return result;
+}
+
+void Print_Result(const char *name, const char *mode, uint32_t baud, const Result &result)
+{
+    if (!result.ok)
+    {
+        printf("  %-24s %-6s %8u  FAILED: %s\n", name, mode, baud, result.error.c_str());
+        return;
+    }
+
+    printf("  %-24s %-6s %8u  %2u/%-2u %9llu %9llu %6u %8.2f\n", name, mode, result.stats.baud,
+           result.stats.sectors_written, result.stats.image_sectors,
+           (unsigned long long)result.stats.bytes_sent, (unsigned long long)result.stats.bytes_received,
+           result.stats.retries, result.seconds);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Timing timing;
+    uint32_t update_baud = 921600;
+    size_t image_kb = 64;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--baud") && (i + 1 < argc)) update_baud = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--image-kb") && (i + 1 < argc)) image_kb = (size_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--erase-ms") && (i + 1 < argc)) timing.erase_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--program-us") && (i + 1 < argc)) timing.program_us = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--latency-ms") && (i + 1 < argc)) timing.latency_ms = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--baud N] [--image-kb N] [--erase-ms X] [--program-us X] [--latency-ms X]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if ((image_kb < 8) || (image_kb * 1024 > BOOTLOADER_SIM_FLASH_SIZE - BOOTLOADER_APP_ADDRESS) ||
+        (update_baud < BOOTLOADER_MIN_BAUD) || (update_baud > BOOTLOADER_MAX_BAUD))
+    {
+        fprintf(stderr, "Invalid image size or baud rate\n");
+        return 2;
+    }
+
+    std::vector<Scenario> scenarios = Make_Scenarios(image_kb * 1024);
+    int failures = 0;
+
+    printf("Image: %zu KB, erase %.1f ms/sector, program %.1f us/word, turnaround %.1f ms\n\n",
+           image_kb, timing.erase_ms, timing.program_us, timing.latency_ms);
+    printf("  %-24s %-6s %8s  %5s %9s %9s %6s %8s\n", "Scenario", "Mode", "Baud", "Sect", "Sent", "Received", "Retry", "Seconds");
+
+    for (const Scenario &scenario : scenarios)
+    {
+        for (uint32_t baud : { (uint32_t)115200, update_baud })
+        {
+            double full_seconds = 0.0;
+
+            for (bool full : { true, false })
+            {
+                Result result = Run_Update(scenario, timing, full, baud);
+                Print_Result(scenario.name.c_str(), full ? "full" : "delta", baud, result);
+
+                if (!result.ok) failures++;
+                else if (full) full_seconds = result.seconds;
+                else if (full_seconds > 0.0) printf("  %-24s %-6s %8s  speedup %.1fx\n", "", "", "", full_seconds / std::max(result.seconds, 1e-6));
+            }
+        }
+        printf("\n");
+    }
+
+    printf("Faults (one function changed, delta):\n");
+
+    Result noisy = Run_Update(scenarios[1], timing, false, update_baud, BOOTLOADER_MAX_BAUD, 1e-4);
+    Print_Result("1e-4 byte errors", "delta", update_baud, noisy);
+    if (!noisy.ok) failures++;
+
+    Result limited = Run_Update(scenarios[1], timing, false, update_baud, 115200);
+    Print_Result("link limited to 115200", "delta", update_baud, limited);
+    if (!limited.ok || (limited.stats.baud != 115200))
+    {
+        if (limited.ok) printf("  the update did not fall back to 115200 baud\n");
+        failures++;
+    }
+
+    printf("\nInterrupted updates (one function changed, power failure at a flash operation, then a reset):\n");
+
+    for (bool full : { false, true })
+    {
+        Interrupted_Result interrupted = Run_Interrupted(scenarios[1], timing, full, update_baud, full ? 41 : 1);
+
+        if (!interrupted.error.empty())
+        {
+            printf("  %-6s FAILED: %s\n", full ? "full" : "delta", interrupted.error.c_str());
+            failures++;
+            continue;
+        }
+
+        printf("  %-6s %4u points: %4u stayed in the bootloader, %3u started the new application, all updated again\n",
+               full ? "full" : "delta", interrupted.points, interrupted.stayed, interrupted.started);
+    }
+
+    Boot_Update_Stats repair;
+    std::string corrupted = Run_Corrupted(scenarios[1].new_image, timing, repair);
+
+    if (!corrupted.empty())
+    {
+        printf("  corrupted application: FAILED: %s\n", corrupted.c_str());
+        failures++;
+    }
+    else
+    {
+        printf("  corrupted application: stayed in the bootloader, repaired by a delta update of %u sectors\n", repair.sectors_written);
+    }
+
+    printf("\n%s\n", failures ? "FAILED" : "All updates verified");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,378 @@
+/**
+ * @file bumper_check.cpp
+ * @brief Checks the interrupt-driven bumper switches on simulated pin edges.
+ *
+ * The program runs the firmware's Bumper_Switches on the Bumper_Switches_Sim backend:
+ *   - Model: random closings, openings and contact bounces of the six switches, with motor starts
+ *     through Bumper_Switches_Drive and a game that takes and acknowledges the collisions. After every
+ *     step, the state seen by the module, the collision flag, the posted event, and the collision and
+ *     bounce counts are compared with a model of the debounce rule. Every edge must stop the motors.
+ *   - Races: the same with switches changed in the middle of the interrupt handler (before a read,
+ *     between the edge selection and the clearing of the flags, after it) and while the program masks
+ *     the interrupt. The module must end every handler with the state of the pins and the matching
+ *     edges selected, and the motors must be off whenever a switch is closed.
+ *   - Reaction: collisions at random times during the motor animations of main.c. The time the motors
+ *     keep running is compared between the interrupt (which stops them at the edge in simulated time;
+ *     the cycles on the board come from Bumper_Switches_MSP432_Measure_Latency) and a poll of the
+ *     switches once per iteration of the main loop, which does not run during an animation.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Bumper_Switches.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Bumper_Switches_Sim.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR bumper_check.cpp Bumper_Switches.o Bumper_Switches_Sim.o -o bumper_check
+ *
+ * Usage: bumper_check [--steps N] [--seed N]
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "inc/Bumper_Switches.h"
+#include "inc/Bumper_Switches_Sim.h"
+
+namespace
+{
+
+uint64_t mismatches = 0;
+
+void Report(const char *what, uint64_t step, uint64_t got, uint64_t expected)
+{
+    if (mismatches < 10)
+    {
+        std::fprintf(stderr, "%s at step %llu: %llu, expected %llu\n", what, (unsigned long long)step,
+                     (unsigned long long)got, (unsigned long long)expected);
+    }
+    mismatches++;
+}
+
+// Port whose motors the Motor function below starts; Bumper_Switches_Drive takes no context
+Bumper_Switches_Sim_Context *driven_port = nullptr;
+
+void Sim_Motor_Forward(uint16_t left_duty_cycle, uint16_t right_duty_cycle)
+{
+    (void)left_duty_cycle;
+    (void)right_duty_cycle;
+    driven_port->motors_enabled = 1;
+}
+
+// Debounce rule of Bumper_Switches, applied to every change of the pins
+struct Model
+{
+    uint32_t debounce_ms;
+    uint8_t closed = 0;
+    bool opened_valid = false;
+    uint32_t opened_ms = 0;
+    bool collision = false;
+    bool event_pending = false;
+    uint8_t event_switches = 0;
+    uint32_t collisions = 0;
+    uint32_t bounces = 0;
+
+    explicit Model(uint32_t debounce) : debounce_ms(debounce) {}
+
+    void Change(uint8_t now_closed, uint32_t now_ms)
+    {
+        if ((now_closed != 0) && (closed == 0))
+        {
+            if (opened_valid && (now_ms - opened_ms < debounce_ms))
+            {
+                bounces++;
+            }
+            else
+            {
+                collisions++;
+                collision = true;
+                event_pending = true;
+                event_switches = now_closed;
+            }
+        }
+        else if (event_pending)
+        {
+            event_switches |= now_closed;
+        }
+
+        if ((now_closed == 0) && (closed != 0))
+        {
+            opened_valid = true;
+            opened_ms = now_ms;
+        }
+
+        closed = now_closed;
+    }
+};
+
+uint8_t Random_Change(std::mt19937 &random, uint8_t closed)
+{
+    // Mostly one switch; sometimes the whole front or several at once
+    switch (random() % 8)
+    {
+        case 0:  return closed ? 0 : 0x0C;
+        case 1:  return closed ^ (uint8_t)(random() & BUMPER_SWITCHES_ALL);
+        default: return closed ^ (uint8_t)(1u << (random() % BUMPER_SWITCHES_COUNT));
+    }
+}
+
+void Check_Model(uint64_t steps, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    Bumper_Switches bumpers;
+    Bumper_Switches_Sim_Context sim;
+    Model model(BUMPER_SWITCHES_DEBOUNCE_MS);
+    uint64_t drives = 0;
+
+    Bumper_Switches_Sim_Init(&bumpers, &sim, BUMPER_SWITCHES_DEBOUNCE_MS, nullptr, nullptr);
+    driven_port = &sim;
+
+    for (uint64_t step = 0; step < steps; step++)
+    {
+        uint32_t action = random() % 16;
+
+        if (action < 6)
+        {
+            uint8_t closed = Random_Change(random, sim.closed);
+
+            if (closed != sim.closed)
+            {
+                bool running = sim.motors_enabled;
+
+                model.Change(closed, (uint32_t)(sim.time_us / 1000));
+                Bumper_Switches_Sim_Set(&sim, closed);
+
+                if (running && sim.motors_enabled) Report("motors still running after an edge", step, 1, 0);
+            }
+        }
+        else if (action < 9)
+        {
+            // Contact bounce: the same switch toggled within a few milliseconds
+            uint8_t bit = (uint8_t)(1u << (random() % BUMPER_SWITCHES_COUNT));
+
+            for (uint32_t i = 0, n = 2 + random() % 6; i < n; i++)
+            {
+                Bumper_Switches_Sim_Advance(&sim, 100 + random() % 3000);
+                model.Change(sim.closed ^ bit, (uint32_t)(sim.time_us / 1000));
+                Bumper_Switches_Sim_Set(&sim, sim.closed ^ bit);
+            }
+        }
+        else if (action < 12)
+        {
+            Bumper_Switches_Sim_Advance(&sim, (random() % 2) ? random() % 5000 : random() % 200000);
+        }
+        else if (action < 13)
+        {
+            uint8_t started = Bumper_Switches_Drive(&bumpers, Sim_Motor_Forward, 3000, 3000);
+            uint8_t expected = !model.collision && (model.closed == 0);
+
+            drives += started;
+            if (started != expected) Report("drive", step, started, expected);
+        }
+        else if (action < 15)
+        {
+            Bumper_Switches_Event event;
+            uint8_t taken = Bumper_Switches_Take_Event(&bumpers, &event);
+
+            if (taken != model.event_pending) Report("event taken", step, taken, model.event_pending);
+            else if (taken && (event.switches != model.event_switches)) Report("event switches", step, event.switches, model.event_switches);
+            model.event_pending = false;
+        }
+        else
+        {
+            uint8_t clear = Bumper_Switches_Acknowledge(&bumpers);
+
+            if (model.closed == 0) model.collision = false;
+            if (clear != !model.collision) Report("acknowledge", step, clear, !model.collision);
+        }
+
+        if (bumpers.closed != sim.closed) Report("closed switches", step, bumpers.closed, sim.closed);
+        if (bumpers.collision != model.collision) Report("collision flag", step, bumpers.collision, model.collision);
+        if (bumpers.collisions != model.collisions) Report("collisions", step, bumpers.collisions, model.collisions);
+        if (bumpers.bounces != model.bounces) Report("bounces", step, bumpers.bounces, model.bounces);
+    }
+
+    std::printf("Model: %llu steps, %llu interrupts, %lu collisions, %lu bounces, %llu motor starts, %llu cutoffs\n",
+                (unsigned long long)steps, (unsigned long long)sim.interrupts, (unsigned long)bumpers.collisions,
+                (unsigned long)bumpers.bounces, (unsigned long long)drives, (unsigned long long)sim.cutoffs);
+}
+
+// Changes one switch at a chosen operation of the interrupt handler
+struct Race
+{
+    std::mt19937 *random;
+    uint32_t countdown;
+    uint64_t changes;
+};
+
+void Race_Hook(Bumper_Switches_Sim_Context *context)
+{
+    Race *race = (Race *)context->hook_context;
+
+    if (race->countdown > 0)
+    {
+        if (--race->countdown == 0)
+        {
+            race->changes++;
+            Bumper_Switches_Sim_Set(context, Random_Change(*race->random, context->closed));
+        }
+    }
+}
+
+void Check_Races(uint64_t steps, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    Bumper_Switches bumpers;
+    Bumper_Switches_Sim_Context sim;
+    Race race = { &random, 0, 0 };
+    uint64_t masked = 0;
+
+    Bumper_Switches_Sim_Init(&bumpers, &sim, BUMPER_SWITCHES_DEBOUNCE_MS, nullptr, nullptr);
+    sim.hook = Race_Hook;
+    sim.hook_context = &race;
+    driven_port = &sim;
+
+    for (uint64_t step = 0; step < steps; step++)
+    {
+        uint32_t action = random() % 8;
+
+        // The handler makes at most 4 hook calls per pass before a change is seen
+        race.countdown = (random() % 2) ? 1 + random() % 6 : 0;
+
+        if (action < 4)
+        {
+            Bumper_Switches_Sim_Set(&sim, Random_Change(random, sim.closed));
+        }
+        else if (action < 5)
+        {
+            // Changes while the program masks the interrupt are handled when it is unmasked
+            Bumper_Switches_Sim_Mask(&sim, 1);
+            for (uint32_t i = 0, n = random() % 4; i < n; i++)
+            {
+                Bumper_Switches_Sim_Set(&sim, Random_Change(random, sim.closed));
+            }
+            if (random() % 2) Bumper_Switches_Drive(&bumpers, Sim_Motor_Forward, 3000, 3000);
+            masked++;
+            Bumper_Switches_Sim_Mask(&sim, 0);
+        }
+        else if (action < 6)
+        {
+            Bumper_Switches_Drive(&bumpers, Sim_Motor_Forward, 3000, 3000);
+        }
+        else if (action < 7)
+        {
+            Bumper_Switches_Event event;
+            Bumper_Switches_Take_Event(&bumpers, &event);
+            Bumper_Switches_Acknowledge(&bumpers);
+        }
+        else
+        {
+            Bumper_Switches_Sim_Advance(&sim, random() % 40000);
+        }
+
+        race.countdown = 0;
+
+        if (bumpers.closed != sim.closed) Report("closed switches after a race", step, bumpers.closed, sim.closed);
+        if (sim.flags != 0) Report("flags left", step, sim.flags, 0);
+        if (sim.watch_closing != (uint8_t)(~sim.closed & BUMPER_SWITCHES_ALL)) Report("edge selection", step, sim.watch_closing, ~sim.closed & BUMPER_SWITCHES_ALL);
+        if ((sim.closed != 0) && sim.motors_enabled) Report("motors running with a closed switch", step, sim.closed, 0);
+    }
+
+    std::printf("Races: %llu steps, %llu changes inside the handler, %llu masked sections, %llu interrupts\n",
+                (unsigned long long)steps, (unsigned long long)race.changes, (unsigned long long)masked,
+                (unsigned long long)sim.interrupts);
+}
+
+double Percentile(std::vector<double> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    return values[(size_t)(p * (values.size() - 1))];
+}
+
+// Motor animations of main.c: ACCESS GRANTED drives forward and backward for 2 s each, a wrong color
+// turns left and right for 2 s each. The main loop, where a poll would be, runs after the animation
+void Measure_Reaction(uint32_t seed)
+{
+    std::mt19937 random(seed);
+    Bumper_Switches bumpers;
+    Bumper_Switches_Sim_Context sim;
+    std::vector<double> interrupt_ms;
+    std::vector<double> poll_ms;
+    const uint64_t step_us = 2000000;
+
+    Bumper_Switches_Sim_Init(&bumpers, &sim, BUMPER_SWITCHES_DEBOUNCE_MS, nullptr, nullptr);
+    driven_port = &sim;
+
+    for (int trial = 0; trial < 100000; trial++)
+    {
+        uint64_t start = sim.time_us;
+        uint64_t hit = start + random() % (2 * step_us);
+
+        // First step of the animation, with the hit somewhere in the two steps
+        Bumper_Switches_Drive(&bumpers, Sim_Motor_Forward, 3000, 3000);
+        uint64_t stopped = 0;
+
+        for (int motor_step = 0; motor_step < 2; motor_step++)
+        {
+            uint64_t end = start + (motor_step + 1) * step_us;
+
+            if ((hit >= sim.time_us) && (hit < end))
+            {
+                Bumper_Switches_Sim_Advance(&sim, hit - sim.time_us);
+                Bumper_Switches_Sim_Set(&sim, 0x0C);
+                if (!sim.motors_enabled && (stopped == 0)) stopped = sim.time_us;
+            }
+
+            Bumper_Switches_Sim_Advance(&sim, end - sim.time_us);
+            if ((motor_step == 0) && (sim.closed == 0)) Bumper_Switches_Drive(&bumpers, Sim_Motor_Forward, 3000, 3000);
+        }
+
+        interrupt_ms.push_back((stopped - hit) / 1000.0);
+        poll_ms.push_back((start + 2 * step_us - hit) / 1000.0);
+
+        // The robot backs off, and the game acknowledges the collision
+        Bumper_Switches_Sim_Advance(&sim, 500000);
+        Bumper_Switches_Sim_Set(&sim, 0);
+        Bumper_Switches_Sim_Advance(&sim, 100000);
+        Bumper_Switches_Event event;
+        Bumper_Switches_Take_Event(&bumpers, &event);
+        Bumper_Switches_Acknowledge(&bumpers);
+    }
+
+    std::printf("\nMotor run time after a collision during an animation (100000 collisions)\n");
+    std::printf("Handling          Mean ms    p99 ms    Max ms\n");
+    double interrupt_sum = 0;
+    double poll_sum = 0;
+    for (double v : interrupt_ms) interrupt_sum += v;
+    for (double v : poll_ms) poll_sum += v;
+
+    std::printf("Interrupt    %12.3f %9.3f %9.3f\n", interrupt_sum / interrupt_ms.size(), Percentile(interrupt_ms, 0.99), Percentile(interrupt_ms, 1.0));
+    std::printf("Loop poll    %12.1f %9.1f %9.1f\n", poll_sum / poll_ms.size(), Percentile(poll_ms, 0.99), Percentile(poll_ms, 1.0));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t steps = 2000000;
+    uint32_t seed = 528;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--steps") && (i + 1 < argc)) steps = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && (i + 1 < argc)) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--steps N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Check_Model(steps, seed);
+    Check_Races(steps, seed + 1);
+    Measure_Reaction(seed + 2);
+
+    std::printf("%s\n", mismatches ? "MISMATCHES FOUND" : "The module matches the model");
+    return mismatches ? 1 : 0;
+}
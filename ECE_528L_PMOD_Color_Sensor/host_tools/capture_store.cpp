@@ -0,0 +1,336 @@
+/**
+ * @file capture_store.cpp
+ * @brief Converts captures to the columnar Capture_Store format, queries stores, and benchmarks them.
+ *
+ * Build from this directory:
+ *   g++ -std=c++17 -O2 capture_store.cpp Capture_Store.cpp Capture.cpp -o capture_store
+ *
+ * Usage:
+ *   capture_store ingest STORE CAPTURE.csv ...        Converts captures (in time order) to a store
+ *   capture_store info STORE                          Prints the size of each column and the pyramid levels
+ *   capture_store query STORE START_US END_US         Prints the samples in [START_US, END_US) as CSV
+ *   capture_store overview STORE START_US END_US W    Prints W min/max/mean buckets of [START_US, END_US) as CSV
+ *   capture_store bench [--hours H] [--burst F] [--file PATH]
+ *       Synthesizes an H-hour capture (default 8) with the timing of the Adaptive_Rate controller, spending
+ *       the fraction F of the time in burst mode (default 0.5), then measures ingest, range queries and overviews.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Capture.h"
+#include "Capture_Store.h"
+
+namespace
+{
+
+const char *const LABEL_NAMES[] = { "green", "red", "yellow", "none" };
+
+using Clock = std::chrono::steady_clock;
+
+double Elapsed_us(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int Ingest(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        std::fprintf(stderr, "usage: capture_store ingest STORE CAPTURE.csv ...\n");
+        return 1;
+    }
+
+    Capture capture;
+    auto start = Clock::now();
+
+    for (int i = 3; i < argc; i++)
+    {
+        if (!Capture_Load(argv[i], capture)) return 1;
+    }
+
+    double load_us = Elapsed_us(start);
+    start = Clock::now();
+
+    if (!Capture_Store_Write(argv[2], capture)) return 1;
+
+    std::printf("%zu samples: parsed in %.0f ms, stored in %.0f ms\n", capture.Size(), load_us * 1e-3, Elapsed_us(start) * 1e-3);
+    return 0;
+}
+
+int Info(const Capture_Store &store)
+{
+    static const char *const column_names[] = { "time", "label", "red", "green", "blue", "clear" };
+    static const char *const encoding_names[] = { "offset", "delta", "delta2" };
+    const Capture_Store_Header *header = store.Header();
+    uint64_t bits[CAPTURE_STORE_COLUMNS] = {};
+    uint64_t encodings[CAPTURE_STORE_COLUMNS][3] = {};
+
+    for (uint64_t b = 0; b < header->block_count; b++)
+    {
+        for (int c = 0; c < CAPTURE_STORE_COLUMNS; c++)
+        {
+            bits[c] += (uint64_t)store.Blocks()[b].column[c].words * 64;
+            encodings[c][store.Blocks()[b].column[c].encoding]++;
+        }
+    }
+
+    std::printf("%" PRIu64 " samples from %" PRIu64 " us to %" PRIu64 " us, %" PRIu64 " bytes (%.2f bytes per sample)\n\n",
+                store.Size(), store.Start_Time_us(), store.End_Time_us(), header->file_size,
+                store.Size() ? (double)header->file_size / store.Size() : 0.0);
+
+    std::printf("%8s %14s %8s %8s %8s   (blocks per transform)\n", "column", "bits/sample", encoding_names[0], encoding_names[1], encoding_names[2]);
+    for (int c = 0; c < CAPTURE_STORE_COLUMNS; c++)
+    {
+        std::printf("%8s %14.2f", column_names[c], store.Size() ? (double)bits[c] / store.Size() : 0.0);
+        for (int e = 0; e < 3; e++) std::printf(" %8" PRIu64, encodings[c][e]);
+        std::printf("\n");
+    }
+
+    std::printf("\n%8s %14s %12s\n", "level", "samples/bucket", "buckets");
+    for (uint32_t l = 0; l < header->level_count; l++)
+    {
+        std::printf("%8u %14" PRIu64 " %12" PRIu64 "\n", l, header->level[l].bucket_samples, header->level[l].count);
+    }
+
+    return 0;
+}
+
+void Print_Samples(const Capture &capture)
+{
+    std::printf("time_us,label,r,g,b,c\n");
+
+    for (size_t i = 0; i < capture.Size(); i++)
+    {
+        std::printf("%" PRIu64 ",%s,%u,%u,%u,%u\n", capture.time_us[i], LABEL_NAMES[capture.label[i] & 3],
+                    capture.red[i], capture.green[i], capture.blue[i], capture.clear[i]);
+    }
+}
+
+void Print_Overview(const std::vector<Capture_Store_Bucket> &buckets)
+{
+    std::printf("time_us,count,r_min,r_max,r_mean,g_min,g_max,g_mean,b_min,b_max,b_mean,c_min,c_max,c_mean\n");
+
+    for (const Capture_Store_Bucket &bucket : buckets)
+    {
+        std::printf("%" PRIu64 ",%u", bucket.first_time_us, bucket.count);
+        for (int c = 0; c < 4; c++)
+        {
+            if (bucket.count) std::printf(",%u,%u,%.1f", bucket.min[c], bucket.max[c], bucket.Mean(c));
+            else std::printf(",,,");
+        }
+        std::printf("\n");
+    }
+}
+
+// Capture with the timing of the Adaptive_Rate controller: 2.4 ms conversions with a 48 ms wait in idle
+// mode and none in burst mode, with a few microseconds of loop jitter, and objects held in front of the
+// sensor for a few seconds at a time
+void Synthesize(double hours, double burst_fraction, Capture &capture)
+{
+    static const uint16_t colors[4][4] =
+    {
+        {  900, 2600,  800, 4000 },
+        { 3800, 1100,  900, 5600 },
+        { 3900, 3500,  900, 8000 },
+        {  300,  320,  280,  900 },
+    };
+    std::mt19937 rng(84);
+    std::normal_distribution<double> noise(0.0, 12.0);
+    uint64_t end_us = (uint64_t)(hours * 3600e6);
+    uint64_t time_us = 0;
+
+    while (time_us < end_us)
+    {
+        bool burst = std::uniform_real_distribution<double>(0.0, 1.0)(rng) < burst_fraction;
+        uint8_t label = burst ? (uint8_t)(rng() % 3) : 3;
+        uint64_t segment_end = time_us + 1000000 + rng() % 4000000;
+        uint32_t period_us = burst ? 2400 : 50400;
+
+        while ((time_us < segment_end) && (time_us < end_us))
+        {
+            uint16_t channels[4];
+
+            for (int c = 0; c < 4; c++)
+            {
+                channels[c] = (uint16_t)std::min(65535.0, std::max(0.0, colors[label][c] + noise(rng)));
+            }
+
+            capture.Append(time_us, label, channels[0], channels[1], channels[2], channels[3]);
+            time_us += period_us + rng() % 8;
+        }
+    }
+}
+
+struct Latency
+{
+    double median_us;
+    double p99_us;
+};
+
+Latency Summarize(std::vector<double> &times)
+{
+    std::sort(times.begin(), times.end());
+    return { times[times.size() / 2], times[std::min(times.size() - 1, times.size() * 99 / 100)] };
+}
+
+int Bench(int argc, char **argv)
+{
+    double hours = 8.0;
+    double burst_fraction = 0.5;
+    std::string path = "capture_store_bench.ccs";
+
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--hours") && (i + 1 < argc)) hours = std::atof(argv[++i]);
+        else if ((option == "--burst") && (i + 1 < argc)) burst_fraction = std::atof(argv[++i]);
+        else if ((option == "--file") && (i + 1 < argc)) path = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Capture capture;
+    Synthesize(hours, burst_fraction, capture);
+
+    // CSV size of the same capture, for comparison
+    uint64_t csv_bytes = 0;
+    char line[96];
+    for (size_t i = 0; i < capture.Size(); i++)
+    {
+        csv_bytes += std::snprintf(line, sizeof(line), "%" PRIu64 ",%s,%u,%u,%u,%u\n", capture.time_us[i],
+                                   LABEL_NAMES[capture.label[i]], capture.red[i], capture.green[i], capture.blue[i], capture.clear[i]);
+    }
+
+    auto start = Clock::now();
+    if (!Capture_Store_Write(path.c_str(), capture)) return 1;
+    double ingest_us = Elapsed_us(start);
+
+    Capture_Store store;
+    start = Clock::now();
+    if (!store.Open(path.c_str())) return 1;
+    double open_us = Elapsed_us(start);
+
+    uint64_t file_bytes = store.Header()->file_size;
+    uint64_t raw_bytes = capture.Size() * (sizeof(uint64_t) + 1 + 4 * sizeof(uint16_t));
+
+    std::printf("capture: %.1f h, %zu samples, %.0f%% in burst mode\n", hours, capture.Size(), 100.0 * burst_fraction);
+    std::printf("ingest:  %.1f Msamples/s (%.0f ms)\n", capture.Size() / ingest_us, ingest_us * 1e-3);
+    std::printf("size:    %.2f MB, %.2f bytes/sample (%.1fx smaller than raw columns, %.1fx smaller than CSV)\n",
+                file_bytes * 1e-6, (double)file_bytes / capture.Size(), (double)raw_bytes / file_bytes, (double)csv_bytes / file_bytes);
+    std::printf("open:    %.0f us (mmap and validation)\n", open_us);
+
+    // Round trip
+    Capture decoded;
+    start = Clock::now();
+    store.Read(0, store.Size(), decoded);
+    double decode_us = Elapsed_us(start);
+
+    bool exact = (decoded.time_us == capture.time_us) && (decoded.label == capture.label) && (decoded.red == capture.red) &&
+                 (decoded.green == capture.green) && (decoded.blue == capture.blue) && (decoded.clear == capture.clear);
+    std::printf("decode:  %.1f Msamples/s, round trip %s\n\n", capture.Size() / decode_us, exact ? "exact" : "MISMATCH");
+
+    const struct
+    {
+        const char *name;
+        uint64_t span_us;
+    } spans[] =
+    {
+        { "10 ms", 10000 },
+        { "1 s", 1000000 },
+        { "1 min", 60000000 },
+        { "1 h", 3600000000ULL },
+        { "all", 0 },
+    };
+    const uint32_t width = 1920;
+    const int queries = 200;
+    std::mt19937_64 rng(1);
+    uint64_t duration_us = store.End_Time_us() - store.Start_Time_us() + 1;
+
+    std::printf("%8s %12s %12s %12s   %12s %12s %8s\n", "span", "query p50", "query p99", "samples", "overview p50", "overview p99", "level");
+
+    for (const auto &span : spans)
+    {
+        uint64_t span_us = span.span_us ? std::min(span.span_us, duration_us) : duration_us;
+        std::vector<double> query_us, overview_us;
+        uint64_t samples = 0;
+        int level = 0;
+        std::vector<Capture_Store_Bucket> buckets;
+
+        for (int q = 0; q < queries; q++)
+        {
+            uint64_t t0 = store.Start_Time_us() + ((duration_us > span_us) ? rng() % (duration_us - span_us) : 0);
+            Capture result;
+
+            start = Clock::now();
+            store.Query(t0, t0 + span_us, result);
+            query_us.push_back(Elapsed_us(start));
+            samples += result.Size();
+
+            start = Clock::now();
+            level = store.Overview(t0, t0 + span_us, width, buckets);
+            overview_us.push_back(Elapsed_us(start));
+        }
+
+        Latency query = Summarize(query_us);
+        Latency overview = Summarize(overview_us);
+
+        std::printf("%8s %10.0f us %10.0f us %12" PRIu64 "   %10.0f us %10.0f us %8s\n", span.name, query.median_us, query.p99_us,
+                    samples / queries, overview.median_us, overview.p99_us, (level < 0) ? "samples" : std::to_string(level).c_str());
+    }
+
+    std::printf("\noverviews are %u buckets wide; level is the pyramid level read by the last overview\n", width);
+    return exact ? 0 : 1;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::string command = (argc > 1) ? argv[1] : "";
+
+    if (command == "ingest") return Ingest(argc, argv);
+    if (command == "bench") return Bench(argc, argv);
+
+    if (((command == "info") && (argc == 3)) || ((command == "query") && (argc == 5)) || ((command == "overview") && (argc == 6)))
+    {
+        Capture_Store store;
+        if (!store.Open(argv[2])) return 1;
+
+        if (command == "info") return Info(store);
+
+        uint64_t start_us = std::strtoull(argv[3], nullptr, 0);
+        uint64_t end_us = std::strtoull(argv[4], nullptr, 0);
+
+        if (command == "query")
+        {
+            Capture capture;
+            store.Query(start_us, end_us, capture);
+            Print_Samples(capture);
+        }
+        else
+        {
+            std::vector<Capture_Store_Bucket> buckets;
+            store.Overview(start_us, end_us, (uint32_t)std::strtoul(argv[5], nullptr, 0), buckets);
+            Print_Overview(buckets);
+        }
+
+        return 0;
+    }
+
+    std::fprintf(stderr, "usage: capture_store ingest|info|query|overview|bench ... (see the header of capture_store.cpp)\n");
+    return 1;
+}
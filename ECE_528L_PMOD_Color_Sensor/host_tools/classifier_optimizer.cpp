@@ -0,0 +1,584 @@
+/**
+ * @file classifier_optimizer.cpp
+ * @brief Offline optimizer for the Color_Classifier thresholds.
+ *
+ * The optimizer loads labeled captures and evaluates candidate Color_Classifier_Params with the same
+ * Color_Classifier_Classify function that runs on the robot. It searches a coarse grid, refines the
+ * best candidate with a shrinking pattern search, and writes a Color_Classifier_Config.h that can
+ * replace the one in the firmware project.
+ *
+ * The capture format is described in Capture.h. Consecutive samples with the same label form a
+ * segment. For a colored segment, the decision is the first sample that is not classified as unknown,
+ * which is the sample Hold_Color would lock in; a segment labeled none must not produce any decision.
+ * The first guard_ms of a segment labeled none are skipped, since the object is still being removed.
+ *
+ * The cost of a parameter set is
+ *   decision_weight * (wrong + missed + false decisions) / segments
+ *   + sample_weight * (samples classified as a wrong color) / samples
+ *   + latency_weight * (mean decision latency in seconds)
+ *
+ * Candidates are evaluated in batches on a work-stealing thread pool. Each batch walks the dataset once
+ * in tiles that stay in cache while all candidates of the batch are applied, so the evaluation is limited
+ * by the arithmetic of the classifier rather than by memory bandwidth and scales with the number of cores.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c
+ *   g++ -std=c++17 -O2 -pthread -I../ECE528L_PMOD_COLOR/PMOD_COLOR classifier_optimizer.cpp Capture.cpp Color_Classifier.o -o classifier_optimizer
+ *
+ * Usage:
+ *   classifier_optimizer [options] capture.csv [capture.csv ...]
+ *     --threads N            Number of worker threads (default: number of cores)
+ *     --grid N               Grid levels per parameter for the coarse search (default: 12)
+ *     --decision-weight W    Weight of the decision error rate (default: 1.0)
+ *     --sample-weight W      Weight of the sample error rate (default: 1.0)
+ *     --latency-weight W     Weight of the mean latency in seconds (default: 0.5)
+ *     --guard-ms T           Settling time skipped at the start of a segment labeled none (default: 100)
+ *     --output FILE          Write the best parameters as a Color_Classifier_Config.h
+ *     --scaling              Time the coarse grid with 1, 2, 4, ... threads and report the speedup
+ *   classifier_optimizer --synthesize FILE MINUTES [RATE_HZ] [SEED]
+ *     Writes a synthetic labeled capture for trying out the optimizer
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inc/Color_Classifier.h"
+#include "Capture.h"
+#include "Work_Stealing_Pool.h"
+
+namespace
+{
+
+// ---------------------------------------------------------------------------------------------
+// Dataset
+// ---------------------------------------------------------------------------------------------
+
+// Samples of a segment labeled none before decision_begin are still settling from the previous
+// object, and are excluded from the evaluation
+struct Segment
+{
+    uint32_t begin;
+    uint32_t decision_begin;
+    uint32_t end;
+    uint8_t label;
+};
+
+struct Dataset : Capture
+{
+    std::vector<Segment> segments;
+    uint32_t colored_segments = 0;
+};
+
+bool Load_Capture(const char *path, uint64_t guard_us, Dataset &dataset)
+{
+    uint32_t first = (uint32_t)dataset.Size();
+
+    if (!Capture_Load(path, dataset)) return false;
+
+    // Split the samples of this file into segments of constant label
+    uint32_t last = (uint32_t)dataset.Size();
+
+    for (uint32_t i = first; i < last;)
+    {
+        uint32_t j = i + 1;
+        while ((j < last) && (dataset.label[j] == dataset.label[i])) j++;
+
+        uint32_t decision_begin = i;
+
+        if ((dataset.label[i] == COLOR_UNKNOWN) && (i > first))
+        {
+            while ((decision_begin < j) && (dataset.time_us[decision_begin] - dataset.time_us[i] < guard_us)) decision_begin++;
+        }
+
+        dataset.segments.push_back({ i, decision_begin, j, dataset.label[i] });
+        if (dataset.label[i] != COLOR_UNKNOWN) dataset.colored_segments++;
+        i = j;
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Evaluation
+// ---------------------------------------------------------------------------------------------
+
+struct Weights
+{
+    double decision = 1.0;
+    double sample = 1.0;
+    double latency = 0.5;
+};
+
+struct Metrics
+{
+    uint64_t confusion[COLOR_CLASSIFIER_NUM_COLORS][COLOR_CLASSIFIER_NUM_COLORS] = {};
+    uint32_t correct_decisions = 0;
+    uint32_t wrong_decisions = 0;
+    uint32_t missed_decisions = 0;
+    uint32_t false_decisions = 0;
+    uint64_t latency_sum_us = 0;
+    uint64_t latency_max_us = 0;
+    double cost = 0.0;
+
+    uint64_t Samples() const
+    {
+        uint64_t total = 0;
+        for (const auto &row : confusion) for (uint64_t value : row) total += value;
+        return total;
+    }
+
+    // A sample counts as an error if it is classified as a color other than its label
+    uint64_t Sample_Errors() const
+    {
+        uint64_t errors = 0;
+        for (int label = 0; label < COLOR_CLASSIFIER_NUM_COLORS; label++)
+        {
+            for (int color = 0; color < COLOR_UNKNOWN; color++)
+            {
+                if (color != label) errors += confusion[label][color];
+            }
+        }
+        return errors;
+    }
+
+    double Mean_Latency_s() const
+    {
+        return correct_decisions ? (latency_sum_us * 1e-6 / correct_decisions) : 0.0;
+    }
+};
+
+constexpr size_t TILE_SAMPLES = 4096;
+constexpr size_t BATCH_SIZE = 16;
+
+void Finish_Metrics(const Dataset &dataset, const Weights &weights, Metrics &metrics)
+{
+    uint32_t decision_errors = metrics.wrong_decisions + metrics.missed_decisions + metrics.false_decisions;
+    double segments = std::max<size_t>(1, dataset.segments.size());
+    double samples = std::max<uint64_t>(1, metrics.Samples());
+
+    metrics.cost = weights.decision * decision_errors / segments +
+                   weights.sample * metrics.Sample_Errors() / samples +
+                   weights.latency * metrics.Mean_Latency_s();
+}
+
+// Evaluates a batch of parameter sets in one pass over the dataset
+void Evaluate_Batch(const Dataset &dataset, const Weights &weights,
+                    const Color_Classifier_Params *params, Metrics *metrics, size_t count)
+{
+    uint8_t decided[BATCH_SIZE];
+    uint8_t decision[BATCH_SIZE];
+    uint64_t decision_time_us[BATCH_SIZE];
+
+    for (const Segment &segment : dataset.segments)
+    {
+        for (size_t p = 0; p < count; p++) decided[p] = 0;
+
+        for (size_t tile = segment.decision_begin; tile < segment.end; tile += TILE_SAMPLES)
+        {
+            size_t tile_end = std::min<size_t>(segment.end, tile + TILE_SAMPLES);
+
+            for (size_t p = 0; p < count; p++)
+            {
+                uint64_t *row = metrics[p].confusion[segment.label];
+
+                for (size_t i = tile; i < tile_end; i++)
+                {
+                    Color_t color = Color_Classifier_Classify(&params[p], dataset.red[i], dataset.green[i], dataset.blue[i]);
+                    row[color]++;
+
+                    if (!decided[p] && (color != COLOR_UNKNOWN))
+                    {
+                        decided[p] = 1;
+                        decision[p] = (uint8_t)color;
+                        decision_time_us[p] = dataset.time_us[i];
+                    }
+                }
+            }
+        }
+
+        for (size_t p = 0; p < count; p++)
+        {
+            if (segment.label == COLOR_UNKNOWN)
+            {
+                if (decided[p]) metrics[p].false_decisions++;
+            }
+            else if (!decided[p])
+            {
+                metrics[p].missed_decisions++;
+            }
+            else if (decision[p] != segment.label)
+            {
+                metrics[p].wrong_decisions++;
+            }
+            else
+            {
+                uint64_t latency_us = decision_time_us[p] - dataset.time_us[segment.begin];
+                metrics[p].correct_decisions++;
+                metrics[p].latency_sum_us += latency_us;
+                metrics[p].latency_max_us = std::max(metrics[p].latency_max_us, latency_us);
+            }
+        }
+    }
+
+    for (size_t p = 0; p < count; p++) Finish_Metrics(dataset, weights, metrics[p]);
+}
+
+std::vector<Metrics> Evaluate_All(Work_Stealing_Pool &pool, const Dataset &dataset, const Weights &weights,
+                                  const std::vector<Color_Classifier_Params> &candidates)
+{
+    std::vector<Metrics> results(candidates.size());
+    size_t batches = (candidates.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+
+    pool.Parallel_For(batches, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t batch = begin; batch < end; batch++)
+        {
+            size_t first = batch * BATCH_SIZE;
+            size_t count = std::min(BATCH_SIZE, candidates.size() - first);
+            Evaluate_Batch(dataset, weights, &candidates[first], &results[first], count);
+        }
+    });
+
+    return results;
+}
+
+// Returns the index of the lowest cost; ties keep the lowest index, so the result does not depend on the thread count
+size_t Best_Index(const std::vector<Metrics> &results)
+{
+    size_t best = 0;
+
+    for (size_t i = 1; i < results.size(); i++)
+    {
+        if (results[i].cost < results[best].cost) best = i;
+    }
+
+    return best;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Search
+// ---------------------------------------------------------------------------------------------
+
+constexpr int NUM_PARAMS = 4;
+
+// Search range of each parameter: green_margin, yellow_min_rg, yellow_max_blue, red_margin
+const uint32_t PARAM_MAX[NUM_PARAMS] = { 0x8000, 0xFFFF, 0xFFFF, 0x8000 };
+
+uint16_t &Param(Color_Classifier_Params &params, int index)
+{
+    switch (index)
+    {
+        case 0: return params.green_margin;
+        case 1: return params.yellow_min_rg;
+        case 2: return params.yellow_max_blue;
+        default: return params.red_margin;
+    }
+}
+
+std::vector<Color_Classifier_Params> Build_Grid(int levels)
+{
+    std::vector<Color_Classifier_Params> grid;
+    int total = 1;
+
+    for (int i = 0; i < NUM_PARAMS; i++) total *= levels;
+    grid.reserve(total);
+
+    for (int index = 0; index < total; index++)
+    {
+        Color_Classifier_Params params;
+        int rest = index;
+
+        for (int i = 0; i < NUM_PARAMS; i++)
+        {
+            Param(params, i) = (uint16_t)((PARAM_MAX[i] * (uint32_t)(rest % levels)) / (levels - 1));
+            rest /= levels;
+        }
+
+        grid.push_back(params);
+    }
+
+    // The current configuration is always a candidate
+    grid.push_back(Color_Classifier_Default_Params);
+
+    return grid;
+}
+
+// Pattern search: evaluates the 3^4 neighbors of the best point, moves to the best neighbor,
+// and halves the step when the center is still the best
+Color_Classifier_Params Refine(Work_Stealing_Pool &pool, const Dataset &dataset, const Weights &weights,
+                               Color_Classifier_Params best, Metrics &best_metrics, int levels)
+{
+    int32_t step = (int32_t)(0x8000 / (levels - 1)) / 2;
+
+    while (step >= 8)
+    {
+        std::vector<Color_Classifier_Params> candidates;
+
+        for (int index = 0; index < 81; index++)
+        {
+            Color_Classifier_Params params = best;
+            int rest = index;
+
+            for (int i = 0; i < NUM_PARAMS; i++)
+            {
+                int32_t value = (int32_t)Param(params, i) + ((rest % 3) - 1) * step;
+                Param(params, i) = (uint16_t)std::min<int32_t>(std::max<int32_t>(value, 0), PARAM_MAX[i]);
+                rest /= 3;
+            }
+
+            candidates.push_back(params);
+        }
+
+        std::vector<Metrics> results = Evaluate_All(pool, dataset, weights, candidates);
+        size_t index = Best_Index(results);
+
+        if (results[index].cost < best_metrics.cost)
+        {
+            best = candidates[index];
+            best_metrics = results[index];
+        }
+        else
+        {
+            step /= 2;
+        }
+    }
+
+    return best;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Output
+// ---------------------------------------------------------------------------------------------
+
+void Print_Metrics(const char *name, const Color_Classifier_Params &params, const Metrics &metrics)
+{
+    std::printf("%s: green_margin=%u yellow_min_rg=0x%04X yellow_max_blue=0x%04X red_margin=%u\n", name,
+                params.green_margin, params.yellow_min_rg, params.yellow_max_blue, params.red_margin);
+    std::printf("  cost %.5f, decisions: %u correct, %u wrong, %u missed, %u false\n", metrics.cost,
+                metrics.correct_decisions, metrics.wrong_decisions, metrics.missed_decisions, metrics.false_decisions);
+    std::printf("  sample errors %.3f%%, latency mean %.1f ms, max %.1f ms\n",
+                100.0 * metrics.Sample_Errors() / std::max<uint64_t>(1, metrics.Samples()),
+                metrics.Mean_Latency_s() * 1e3, metrics.latency_max_us * 1e-3);
+}
+
+bool Write_Config(const char *path, const Color_Classifier_Params &params, const Metrics &metrics, const Dataset &dataset)
+{
+    FILE *file = std::fopen(path, "w");
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    std::fprintf(file,
+        "/**\n"
+        " * @file Color_Classifier_Config.h\n"
+        " * @brief Threshold configuration for the Color_Classifier.\n"
+        " *\n"
+        " * Generated by host_tools/classifier_optimizer from %zu samples in %zu segments.\n"
+        " * Decisions: %u correct, %u wrong, %u missed, %u false. Mean latency %.1f ms.\n"
+        " *\n"
+        " */\n"
+        "\n"
+        "#ifndef INC_COLOR_CLASSIFIER_CONFIG_H_\n"
+        "#define INC_COLOR_CLASSIFIER_CONFIG_H_\n"
+        "\n"
+        "#define COLOR_CLASSIFIER_GREEN_MARGIN           %u\n"
+        "#define COLOR_CLASSIFIER_YELLOW_MIN_RG          0x%04X\n"
+        "#define COLOR_CLASSIFIER_YELLOW_MAX_BLUE        0x%04X\n"
+        "#define COLOR_CLASSIFIER_RED_MARGIN             %u\n"
+        "\n"
+        "#endif /* INC_COLOR_CLASSIFIER_CONFIG_H_ */\n",
+        dataset.time_us.size(), dataset.segments.size(),
+        metrics.correct_decisions, metrics.wrong_decisions, metrics.missed_decisions, metrics.false_decisions,
+        metrics.Mean_Latency_s() * 1e3,
+        params.green_margin, params.yellow_min_rg, params.yellow_max_blue, params.red_margin);
+
+    std::fclose(file);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Synthetic captures
+// ---------------------------------------------------------------------------------------------
+
+// Writes a capture in which objects are held in front of the sensor for 0.5 to 3 s, separated by
+// 1 to 8 s of background. The calibrated values ramp to the object over 20 to 60 ms, and each
+// presentation has its own brightness and tint, so the hand-picked thresholds are not perfect
+int Synthesize(const char *path, double minutes, double rate_hz, uint32_t seed)
+{
+    static const char *const names[] = { "green", "red", "yellow", "none" };
+    static const double colors[4][3] =
+    {
+        { 0x1800, 0x4C00, 0x2400 },     // Green
+        { 0x6400, 0x1C00, 0x1A00 },     // Red
+        { 0x6000, 0x5600, 0x2000 },     // Yellow
+        { 0x0C00, 0x0D00, 0x0B00 },     // Background
+    };
+
+    FILE *file = std::fopen(path, "w");
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> noise(0.0, 600.0);
+    double period_us = 1e6 / rate_hz;
+    double end_us = minutes * 60e6;
+    double t = 0.0;
+    double current[3] = { colors[3][0], colors[3][1], colors[3][2] };
+    uint64_t samples = 0;
+
+    std::fprintf(file, "time_us,label,r,g,b\n");
+
+    while (t < end_us)
+    {
+        bool object = (samples == 0) ? false : (uniform(rng) < 0.5);
+        int label = object ? (int)(uniform(rng) * 3) : 3;
+        double duration_us = object ? (0.5e6 + uniform(rng) * 2.5e6) : (1e6 + uniform(rng) * 7e6);
+        double ramp_us = 20e3 + uniform(rng) * 40e3;
+        double brightness = 0.8 + uniform(rng) * 0.4;
+        double target[3];
+        double start[3] = { current[0], current[1], current[2] };
+
+        for (int c = 0; c < 3; c++) target[c] = colors[label][c] * brightness * (0.9 + uniform(rng) * 0.2);
+
+        for (double segment_t = 0.0; (segment_t < duration_us) && (t < end_us); segment_t += period_us, t += period_us)
+        {
+            double blend = std::min(1.0, segment_t / ramp_us);
+            uint32_t value[3];
+
+            for (int c = 0; c < 3; c++)
+            {
+                current[c] = start[c] + (target[c] - start[c]) * blend;
+                value[c] = (uint32_t)std::min(65535.0, std::max(0.0, current[c] + noise(rng)));
+            }
+
+            std::fprintf(file, "%llu,%s,0x%04X,0x%04X,0x%04X\n", (unsigned long long)t, names[label], value[0], value[1], value[2]);
+            samples++;
+        }
+    }
+
+    std::fclose(file);
+    std::printf("wrote %llu samples to %s\n", (unsigned long long)samples, path);
+    return 0;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int levels = 12;
+    uint64_t guard_us = 100000;
+    const char *output = nullptr;
+    bool scaling = false;
+    Weights weights;
+    Dataset dataset;
+    std::vector<const char *> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--synthesize") && (i + 2 < argc))
+        {
+            double rate_hz = (i + 3 < argc) ? std::atof(argv[i + 3]) : 100.0;
+            uint32_t seed = (i + 4 < argc) ? (uint32_t)std::strtoul(argv[i + 4], nullptr, 10) : 528;
+            return Synthesize(argv[i + 1], std::atof(argv[i + 2]), rate_hz, seed);
+        }
+        else if ((option == "--threads") && (i + 1 < argc)) threads = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else if ((option == "--grid") && (i + 1 < argc)) levels = std::max(2, std::atoi(argv[++i]));
+        else if ((option == "--decision-weight") && (i + 1 < argc)) weights.decision = std::atof(argv[++i]);
+        else if ((option == "--sample-weight") && (i + 1 < argc)) weights.sample = std::atof(argv[++i]);
+        else if ((option == "--latency-weight") && (i + 1 < argc)) weights.latency = std::atof(argv[++i]);
+        else if ((option == "--guard-ms") && (i + 1 < argc)) guard_us = std::strtoull(argv[++i], nullptr, 10) * 1000;
+        else if ((option == "--output") && (i + 1 < argc)) output = argv[++i];
+        else if (option == "--scaling") scaling = true;
+        else if (option.compare(0, 2, "--") == 0)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        std::fprintf(stderr, "usage: %s [options] capture.csv [capture.csv ...]\n", argv[0]);
+        return 1;
+    }
+
+    for (const char *input : inputs)
+    {
+        if (!Load_Capture(input, guard_us, dataset)) return 1;
+    }
+
+    if (dataset.time_us.empty())
+    {
+        std::fprintf(stderr, "no samples loaded\n");
+        return 1;
+    }
+
+    std::printf("loaded %zu samples, %zu segments (%u colored)\n",
+                dataset.time_us.size(), dataset.segments.size(), dataset.colored_segments);
+
+    std::vector<Color_Classifier_Params> grid = Build_Grid(levels);
+
+    if (scaling)
+    {
+        double single_s = 0.0;
+
+        std::printf("%8s %10s %12s %10s %10s\n", "threads", "time (s)", "evals/s", "speedup", "steals");
+
+        for (unsigned power = 1; ; power *= 2)
+        {
+            unsigned count = std::min(power, threads);
+            Work_Stealing_Pool pool(count);
+            auto start = std::chrono::steady_clock::now();
+            Evaluate_All(pool, dataset, weights, grid);
+            double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (count == 1) single_s = elapsed_s;
+
+            std::printf("%8u %10.3f %12.0f %9.2fx %10llu\n", count, elapsed_s, grid.size() / elapsed_s,
+                        single_s / elapsed_s, (unsigned long long)pool.Steal_Count());
+
+            if (count == threads) break;
+        }
+
+        return 0;
+    }
+
+    Work_Stealing_Pool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Metrics> results = Evaluate_All(pool, dataset, weights, grid);
+    size_t best_index = Best_Index(results);
+    Color_Classifier_Params best = grid[best_index];
+    Metrics best_metrics = results[best_index];
+
+    best = Refine(pool, dataset, weights, best, best_metrics, levels);
+
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("searched %zu grid points on %u threads in %.2f s\n", grid.size(), pool.Thread_Count(), elapsed_s);
+    Print_Metrics("current", Color_Classifier_Default_Params, results.back());
+    Print_Metrics("best", best, best_metrics);
+
+    if (output && !Write_Config(output, best, best_metrics, dataset)) return 1;
+
+    return 0;
+}
@@ -0,0 +1,606 @@
+/**
+ * @file color_names.cpp
+ * @brief Generates the named color database of Color_Names from a CSV file, and benchmarks its search.
+ *
+ * The CSV file has a header line and one color per line, as name,#RRGGBB or name,r,g,b:
+ *   - #RRGGBB is an sRGB color, for example from a paint chip catalog. It is converted to linear light
+ *     and scaled to the calibrated range, which is what PMOD_Color_Normalize_Calibration gives for a
+ *     surface of that color between the black and white references of the calibration.
+ *   - r,g,b are calibrated values from 0 to 65535, for example the mean of a capture of the chip
+ *     (see Capture.h), which also takes the light and the sensor into account.
+ * The tool computes the keys with the firmware's Color_Names_Key_From_RGB, sorts the entries into the
+ * cells of the grid, prints the size of the database and writes it as a Color_Names_Table.c that can
+ * replace the one in the firmware project. --grid-bits sets the grid; by default it has about one cell
+ * per entry. --query finds the nearest color of a calibrated sample.
+ *
+ * --check compares Color_Names_Find with Color_Names_Find_Linear on random databases of 1 to 4096
+ * colors, with every grid size, duplicates, and keys on the edges of the grid, and checks the database
+ * in the firmware project. --bench times both searches on databases of 16 to 4096 colors.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Names.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Names_Table.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR color_names.cpp Color_Names.o Color_Names_Table.o -o color_names
+ *
+ * Usage:
+ *   color_names [options] colors.csv
+ *     --grid-bits B          Grid of 2^B x 2^B cells, from 0 to 6 (default: about one cell per entry)
+ *     --output FILE          Write the database as a Color_Names_Table.c
+ *     --query R,G,B          Find the nearest color of a calibrated sample
+ *   color_names --check
+ *   color_names --bench
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "inc/Color_Names.h"
+
+namespace
+{
+
+struct Color
+{
+    std::string name;
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+};
+
+// A database built on the host; database points into the vectors
+struct Built_Database
+{
+    std::vector<std::string> names;
+    std::vector<Color_Names_Entry> entries;
+    std::vector<uint16_t> cells;
+    Color_Names_Database database = {};
+
+    Built_Database() = default;
+    Built_Database(const Built_Database &) = delete;
+    Built_Database &operator=(const Built_Database &) = delete;
+};
+
+// sRGB component to calibrated linear light
+uint16_t Linear_From_sRGB(unsigned value)
+{
+    double v = value / 255.0;
+    double linear = (v <= 0.04045) ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+    return (uint16_t)std::lround(linear * 65535.0);
+}
+
+bool Load_Colors(const char *path, std::vector<Color> &colors)
+{
+    std::ifstream file(path);
+    std::string line;
+    size_t line_number = 0;
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot read %s\n", path);
+        return false;
+    }
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+
+        if (!line.empty() && (line.back() == '\r')) line.pop_back();
+        if (line.empty() || (line_number == 1)) continue;
+
+        size_t comma = line.find(',');
+        Color color;
+        unsigned r = 0, g = 0, b = 0;
+        bool valid = false;
+
+        if (comma != std::string::npos)
+        {
+            const char *value = line.c_str() + comma + 1;
+            color.name = line.substr(0, comma);
+
+            if ((value[0] == '#') && (std::strlen(value) == 7) && (std::sscanf(value + 1, "%2x%2x%2x", &r, &g, &b) == 3))
+            {
+                color.red = Linear_From_sRGB(r);
+                color.green = Linear_From_sRGB(g);
+                color.blue = Linear_From_sRGB(b);
+                valid = true;
+            }
+            else if ((std::sscanf(value, "%u,%u,%u", &r, &g, &b) == 3) && (r <= 65535) && (g <= 65535) && (b <= 65535))
+            {
+                color.red = (uint16_t)r;
+                color.green = (uint16_t)g;
+                color.blue = (uint16_t)b;
+                valid = true;
+            }
+        }
+
+        // The name becomes a C string literal
+        if (!valid || color.name.empty() || (color.name.find_first_of("\"\\") != std::string::npos))
+        {
+            std::fprintf(stderr, "%s:%zu: expected name,#RRGGBB or name,r,g,b\n", path, line_number);
+            return false;
+        }
+
+        colors.push_back(color);
+    }
+
+    if (colors.size() >= COLOR_NAMES_NONE)
+    {
+        std::fprintf(stderr, "%s: at most %u colors\n", path, COLOR_NAMES_NONE - 1);
+        return false;
+    }
+
+    return true;
+}
+
+// About one cell per entry: half of the grid is empty, since x + y <= 1
+int Default_Grid_Bits(size_t count)
+{
+    int bits = 0;
+
+    while ((bits < COLOR_NAMES_MAX_GRID_BITS) && ((size_t)1 << (2 * bits)) < count) bits++;
+
+    return bits;
+}
+
+uint32_t Cell_Of(const Color_Names_Key &key, int grid_bits)
+{
+    uint32_t size = 1u << grid_bits;
+    uint32_t cx = std::min<uint32_t>(key.x >> (15 - grid_bits), size - 1);
+    uint32_t cy = std::min<uint32_t>(key.y >> (15 - grid_bits), size - 1);
+
+    return (cy << grid_bits) + cx;
+}
+
+// Sorts the colors into the cells of the grid; the colors of a cell stay in the order of the file
+void Build(const std::vector<Color> &colors, int grid_bits, Built_Database &built)
+{
+    std::vector<Color_Names_Key> keys;
+    std::vector<uint32_t> order(colors.size());
+    uint32_t cell_count = 1u << (2 * grid_bits);
+
+    for (const Color &color : colors)
+    {
+        keys.push_back(Color_Names_Key_From_RGB(color.red, color.green, color.blue));
+    }
+
+    for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        return Cell_Of(keys[a], grid_bits) < Cell_Of(keys[b], grid_bits);
+    });
+
+    built.names.clear();
+    built.entries.clear();
+    built.cells.assign(cell_count + 1, 0);
+
+    for (uint32_t i : order) built.names.push_back(colors[i].name);
+
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        built.entries.push_back({ keys[order[i]], built.names[i].c_str() });
+        built.cells[Cell_Of(keys[order[i]], grid_bits) + 1]++;
+    }
+
+    for (uint32_t c = 0; c < cell_count; c++) built.cells[c + 1] += built.cells[c];
+
+    built.database.entries = built.entries.data();
+    built.database.cells = built.cells.data();
+    built.database.count = (uint16_t)built.entries.size();
+    built.database.grid_bits = (uint8_t)grid_bits;
+}
+
+// Flash size of a database on the M4: 12-byte entries, the cell offsets and the names
+size_t Flash_Bytes(const Color_Names_Database &database)
+{
+    size_t bytes = (size_t)database.count * 12 + ((size_t)1 << (2 * database.grid_bits)) * 2 + 2;
+
+    for (uint16_t i = 0; i < database.count; i++) bytes += std::strlen(database.entries[i].name) + 1;
+
+    return bytes;
+}
+
+void Print_Database(const Color_Names_Database &database)
+{
+    uint32_t cell_count = 1u << (2 * database.grid_bits);
+    uint32_t used = 0;
+    uint32_t largest = 0;
+
+    for (uint32_t c = 0; c < cell_count; c++)
+    {
+        uint32_t entries = database.cells[c + 1] - database.cells[c];
+
+        if (entries > 0) used++;
+        largest = std::max(largest, entries);
+    }
+
+    std::printf("%u colors on a grid of %u x %u cells: %u cells used, up to %u colors per cell, %zu bytes of flash\n",
+                database.count, 1u << database.grid_bits, 1u << database.grid_bits, used, largest,
+                Flash_Bytes(database));
+}
+
+bool Write_Table(const char *path, const Color_Names_Database &database, const char *source)
+{
+    FILE *file = std::fopen(path, "w");
+    uint32_t cell_count = 1u << (2 * database.grid_bits);
+    const char *base = std::strrchr(source, '/');
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    std::fprintf(file,
+        "/**\n"
+        " * @file Color_Names_Table.c\n"
+        " * @brief Named color database of the Color_Names module.\n"
+        " *\n"
+        " * Generated by host_tools/color_names from %s: %u colors on a grid of %u x %u cells.\n"
+        " *\n"
+        " */\n"
+        "\n"
+        "#include \"../inc/Color_Names.h\"\n"
+        "\n"
+        "static const Color_Names_Entry Color_Names_Entries[%u] =\n"
+        "{\n",
+        base ? base + 1 : source, database.count, 1u << database.grid_bits, 1u << database.grid_bits,
+        std::max<unsigned>(1, database.count));
+
+    for (uint16_t i = 0; i < database.count; i++)
+    {
+        const Color_Names_Entry &entry = database.entries[i];
+        std::fprintf(file, "    { { %5u, %5u, %5u }, \"%s\" }%s\n", entry.key.x, entry.key.y, entry.key.lightness,
+                     entry.name, (i + 1 < database.count) ? "," : "");
+    }
+
+    if (database.count == 0) std::fprintf(file, "    { { 0, 0, 0 }, \"none\" }\n");
+
+    std::fprintf(file, "};\n\nstatic const uint16_t Color_Names_Cells[%u] =\n{", cell_count + 1);
+
+    for (uint32_t c = 0; c <= cell_count; c++)
+    {
+        std::fprintf(file, "%s%u%s", (c % 16 == 0) ? "\n    " : " ", database.cells[c], (c < cell_count) ? "," : "");
+    }
+
+    std::fprintf(file,
+        "\n};\n"
+        "\n"
+        "const Color_Names_Database Color_Names_Default_Database =\n"
+        "{\n"
+        "    Color_Names_Entries,\n"
+        "    Color_Names_Cells,\n"
+        "    %u,\n"
+        "    %u\n"
+        "};\n",
+        database.count, database.grid_bits);
+
+    return std::fclose(file) == 0;
+}
+
+// Random catalog: sRGB colors drawn uniformly, as paint chips cover the whole gamut
+std::vector<Color> Random_Colors(size_t count, std::mt19937 &random)
+{
+    std::vector<Color> colors;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        colors.push_back({ "color" + std::to_string(i), Linear_From_sRGB(random() % 256), Linear_From_sRGB(random() % 256),
+                           Linear_From_sRGB(random() % 256) });
+    }
+
+    return colors;
+}
+
+// Queries: the samples of catalog colors, with the noise and brightness changes of the sensor
+std::vector<Color_Names_Key> Random_Queries(const std::vector<Color> &colors, size_t count, std::mt19937 &random)
+{
+    std::vector<Color_Names_Key> keys;
+    std::normal_distribution<double> noise(0.0, 300.0);
+    std::uniform_real_distribution<double> gain(0.8, 1.2);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const Color &color = colors[random() % colors.size()];
+        double g = gain(random);
+        auto channel = [&](uint16_t value) { return (uint16_t)std::clamp(value * g + noise(random), 0.0, 65535.0); };
+
+        keys.push_back(Color_Names_Key_From_RGB(channel(color.red), channel(color.green), channel(color.blue)));
+    }
+
+    return keys;
+}
+
+// Keys anywhere, on the edges of the grid and on the keys of the entries
+std::vector<Color_Names_Key> Edge_Queries(const Color_Names_Database &database, size_t count, std::mt19937 &random)
+{
+    std::vector<Color_Names_Key> keys;
+    static const uint16_t edges[] = { 0, 1, 16383, 16384, 21845, 32767, 32768 };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        Color_Names_Key key;
+
+        switch (random() % 4)
+        {
+            case 0:
+                key = Color_Names_Key_From_RGB(random() % 65536, random() % 65536, random() % 65536);
+                break;
+            case 1:
+                key.x = edges[random() % 7];
+                key.y = edges[random() % 7];
+                key.lightness = (random() % 2) ? 0 : 32767;
+                break;
+            case 2:
+                key.x = random() % 32769;
+                key.y = random() % 32769;
+                key.lightness = random() % 32768;
+                break;
+            default:
+                key = database.count ? database.entries[random() % database.count].key
+                                     : Color_Names_Key_From_RGB(0, 0, 0);
+                break;
+        }
+
+        keys.push_back(key);
+    }
+
+    return keys;
+}
+
+// Compares the grid with the linear scan. Returns the number of mismatches
+uint64_t Compare(const Color_Names_Database &database, const std::vector<Color_Names_Key> &keys, uint64_t &compared)
+{
+    uint64_t mismatches = 0;
+
+    for (const Color_Names_Key &key : keys)
+    {
+        Color_Names_Match grid, linear;
+
+        Color_Names_Find(&database, &key, &grid);
+        Color_Names_Find_Linear(&database, &key, &linear);
+
+        compared += grid.compared;
+
+        if ((grid.index != linear.index) || (grid.distance != linear.distance))
+        {
+            if (mismatches++ < 5)
+            {
+                std::fprintf(stderr, "key (%u, %u, %u) in %u colors, %u grid bits: grid %u at %u, linear %u at %u\n", key.x,
+                             key.y, key.lightness, database.count, database.grid_bits, grid.index, grid.distance,
+                             linear.index, linear.distance);
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+// The firmware database: sorted into its cells, with every color findable, and the same results as a scan
+uint64_t Check_Default_Database(std::mt19937 &random)
+{
+    const Color_Names_Database &database = Color_Names_Default_Database;
+    uint32_t cell_count = 1u << (2 * database.grid_bits);
+    uint64_t mismatches = 0;
+    uint64_t compared = 0;
+
+    if ((database.grid_bits > COLOR_NAMES_MAX_GRID_BITS) || (database.cells[0] != 0) ||
+        (database.cells[cell_count] != database.count))
+    {
+        return 1;
+    }
+
+    for (uint32_t c = 0; c < cell_count; c++)
+    {
+        for (uint32_t i = database.cells[c]; i < database.cells[c + 1]; i++)
+        {
+            if (Cell_Of(database.entries[i].key, database.grid_bits) != c) mismatches++;
+        }
+    }
+
+    mismatches += Compare(database, Edge_Queries(database, 100000, random), compared);
+    Print_Database(database);
+
+    return mismatches;
+}
+
+int Check_Names()
+{
+    std::mt19937 random(99);
+    uint64_t mismatches = 0;
+    uint64_t queries = 0;
+
+    // Keys against a double reference, within the rounding
+    for (int i = 0; i < 1000000; i++)
+    {
+        uint16_t r = (i < 8) ? ((i & 1) ? 65535 : 0) : random() % 65536;
+        uint16_t g = (i < 8) ? ((i & 2) ? 65535 : 0) : random() % 65536;
+        uint16_t b = (i < 8) ? ((i & 4) ? 65535 : 0) : random() % 65536;
+        Color_Names_Key key = Color_Names_Key_From_RGB(r, g, b);
+        double sum = (double)r + g + b;
+
+        if (sum == 0.0) continue;
+
+        if ((std::fabs(key.x - r * 32768.0 / sum) > 0.5) || (std::fabs(key.y - g * 32768.0 / sum) > 0.5) ||
+            (key.lightness != (uint32_t)(sum / 6)))
+        {
+            mismatches++;
+        }
+    }
+
+    std::printf("Keys: %s\n", mismatches ? "FAILED" : "passed");
+
+    for (size_t count : { 0, 1, 2, 7, 139, 500, 4096 })
+    {
+        std::vector<Color> colors = Random_Colors(count, random);
+
+        // Duplicates, and colors that all fall in the same cell
+        if (count >= 7)
+        {
+            for (size_t i = 0; i < count / 7; i++) colors[random() % count] = colors[random() % count];
+            for (size_t i = 0; i < count / 7; i++) colors[random() % count] = { "gray", 20000, 20000, 20000 };
+        }
+
+        for (int bits = 0; bits <= COLOR_NAMES_MAX_GRID_BITS; bits++)
+        {
+            Built_Database built;
+            uint64_t compared = 0;
+
+            Build(colors, bits, built);
+            std::vector<Color_Names_Key> keys = Edge_Queries(built.database, 20000, random);
+
+            if (count > 0)
+            {
+                std::vector<Color_Names_Key> samples = Random_Queries(colors, 20000, random);
+                keys.insert(keys.end(), samples.begin(), samples.end());
+            }
+
+            mismatches += Compare(built.database, keys, compared);
+            queries += keys.size();
+        }
+    }
+
+    std::printf("Grid: %llu queries on 7 database sizes with grid bits 0 to %d: %s\n", (unsigned long long)queries,
+                COLOR_NAMES_MAX_GRID_BITS, mismatches ? "FAILED" : "passed");
+
+    uint64_t default_mismatches = Check_Default_Database(random);
+    std::printf("Firmware database: %s\n", default_mismatches ? "FAILED" : "passed");
+
+    return (mismatches || default_mismatches) ? 1 : 0;
+}
+
+template <typename Find>
+double Time_ns(const Color_Names_Database &database, const std::vector<Color_Names_Key> &keys, Find find, double &compared,
+               uint64_t &checksum)
+{
+    Color_Names_Match match;
+    uint64_t total = 0;
+    double best_ns = 1e30;
+
+    // Best of 5 runs
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        total = 0;
+
+        for (const Color_Names_Key &key : keys)
+        {
+            find(&database, &key, &match);
+            checksum += match.index;
+            total += match.compared;
+        }
+
+        double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best_ns = std::min(best_ns, elapsed_ns / keys.size());
+    }
+
+    compared = (double)total / keys.size();
+    return best_ns;
+}
+
+int Bench_Names()
+{
+    std::mt19937 random(4);
+    uint64_t checksum = 0;
+
+    std::printf("Colors  Grid  Flash (B)   Linear (ns, compared)     Grid (ns, compared)   Speedup\n");
+
+    for (size_t count : { 16, 64, 256, 1024, 4096 })
+    {
+        std::vector<Color> colors = Random_Colors(count, random);
+        std::vector<Color_Names_Key> keys = Random_Queries(colors, 200000, random);
+        int default_bits = Default_Grid_Bits(count);
+
+        for (int bits = std::max(0, default_bits - 2); bits <= std::min(COLOR_NAMES_MAX_GRID_BITS, default_bits + 1); bits++)
+        {
+            Built_Database built;
+            double linear_compared = 0.0;
+            double grid_compared = 0.0;
+
+            Build(colors, bits, built);
+
+            double linear_ns = Time_ns(built.database, keys, Color_Names_Find_Linear, linear_compared, checksum);
+            double grid_ns = Time_ns(built.database, keys, Color_Names_Find, grid_compared, checksum);
+
+            std::printf("%6zu %3ux%-2u%s %9zu %11.1f %11.1f %11.1f %11.1f %8.1fx\n", count, 1u << bits, 1u << bits,
+                        (bits == default_bits) ? "*" : " ", Flash_Bytes(built.database), linear_ns, linear_compared,
+                        grid_ns, grid_compared, linear_ns / grid_ns);
+        }
+    }
+
+    std::printf("* default grid (checksum %llu)\n", (unsigned long long)checksum);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int grid_bits = -1;
+    const char *output = nullptr;
+    const char *query = nullptr;
+    const char *input = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--check") return Check_Names();
+        else if (option == "--bench") return Bench_Names();
+        else if ((option == "--grid-bits") && (i + 1 < argc)) grid_bits = std::atoi(argv[++i]);
+        else if ((option == "--output") && (i + 1 < argc)) output = argv[++i];
+        else if ((option == "--query") && (i + 1 < argc)) query = argv[++i];
+        else if (option.compare(0, 2, "--") == 0)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else input = argv[i];
+    }
+
+    if ((input == nullptr) || (grid_bits > COLOR_NAMES_MAX_GRID_BITS))
+    {
+        std::fprintf(stderr, "usage: %s [--grid-bits B] [--output FILE] [--query R,G,B] colors.csv\n"
+                             "       %s --check\n"
+                             "       %s --bench\n", argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    std::vector<Color> colors;
+    Built_Database built;
+
+    if (!Load_Colors(input, colors)) return 1;
+
+    Build(colors, (grid_bits >= 0) ? grid_bits : Default_Grid_Bits(colors.size()), built);
+    Print_Database(built.database);
+
+    if (query)
+    {
+        unsigned r, g, b;
+        Color_Names_Match match;
+
+        if ((std::sscanf(query, "%u,%u,%u", &r, &g, &b) != 3) || (r > 65535) || (g > 65535) || (b > 65535))
+        {
+            std::fprintf(stderr, "--query expects calibrated R,G,B values\n");
+            return 1;
+        }
+
+        Color_Names_Key key = Color_Names_Key_From_RGB((uint16_t)r, (uint16_t)g, (uint16_t)b);
+        Color_Names_Find(&built.database, &key, &match);
+        std::printf("%s: distance %u, %u colors compared\n", Color_Names_Name(&built.database, match.index),
+                    match.distance, match.compared);
+    }
+
+    if (output && !Write_Table(output, built.database, input)) return 1;
+
+    return 0;
+}
@@ -0,0 +1,661 @@
+/**
+ * @file fixed_point_check.cpp
+ * @brief Checks the saturating fixed-point library of the firmware and the stages built on it.
+ *
+ * --check compares every function of Fixed_Point.h with a 64-bit integer or double reference:
+ *   - Exhaustively over 16-bit domains: the unsigned additions, subtractions, differences and UQ16
+ *     products, the Q15 additions, subtractions and products, and Fixed_Point_Scale_UQ16 for every pair
+ *     of 16-bit values, and Fixed_Point_Divide for every 16-bit dividend and divisor.
+ *   - Divisions: every divisor up to 2^18 (the sums of three channels) with the dividends next to its
+ *     multiples, 0 and 2^32 - 1, and random ones; every 32-bit dividend for a few divisors.
+ *   - Square root: every value up to 2^24, both sides of every square up to 2^32, and random values.
+ *   - Saturations and the 32-bit and Q16.16 arithmetic at the edges of their types and at random.
+ * It then checks the stages of the pipeline against their previous integer code:
+ * PMOD_Color_Normalize_Calibration for every sample value over random calibrations, including the ones
+ * without a range (the same values within the calibration, saturated outside of it),
+ * Color_Classifier_Classify, Adaptive_Rate_Normalize, and Color_Names_Key_From_RGB.
+ *
+ * --bench times the calibration, classification and chromaticity of a sample with the firmware's
+ * fixed-point code and with the same steps in float, and the single operations against their float and
+ * division equivalents. The host has a fast FPU and divider, so the times only compare the code paths;
+ * on the MSP432, an integer division or a single-precision VDIV or VSQRT takes up to 12 or 14 cycles.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Fixed_Point.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/PMOD_Color.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Adaptive_Rate.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Names.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus_Sim.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR fixed_point_check.cpp Fixed_Point.o PMOD_Color.o Color_Classifier.o Adaptive_Rate.o Color_Names.o I2C_Bus.o I2C_Bus_Sim.o -o fixed_point_check
+ *
+ * Usage: fixed_point_check --check
+ *        fixed_point_check --bench
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "inc/Fixed_Point.h"
+#include "inc/PMOD_Color.h"
+#include "inc/Color_Classifier.h"
+#include "inc/Adaptive_Rate.h"
+#include "inc/Color_Names.h"
+
+namespace
+{
+
+uint64_t failures = 0;
+
+// Counts a failure and prints the first few of each check
+void Fail(uint64_t &mismatches, const char *what, int64_t a, int64_t b, int64_t got, int64_t expected)
+{
+    if (mismatches++ < 5)
+    {
+        std::fprintf(stderr, "%s(%lld, %lld) = %lld, expected %lld\n", what, (long long)a, (long long)b, (long long)got,
+                     (long long)expected);
+    }
+}
+
+void Report(const char *name, uint64_t cases, uint64_t mismatches)
+{
+    std::printf("%-44s %14llu cases: %s\n", name, (unsigned long long)cases, mismatches ? "FAILED" : "passed");
+    failures += mismatches;
+}
+
+int64_t Clamp(int64_t value, int64_t low, int64_t high)
+{
+    return std::min(std::max(value, low), high);
+}
+
+// Rounded to the nearest, ties away from zero, as the products of Fixed_Point.h
+int64_t Round_Shift(int64_t product, int shift)
+{
+    int64_t half = int64_t(1) << (shift - 1);
+    return (product >= 0) ? (product + half) >> shift : -((-product + half) >> shift);
+}
+
+// ---- Fixed_Point.h ----
+
+void Check_Saturations(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    std::vector<int32_t> values = { INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 1 };
+
+    for (int32_t v = -0x30000; v <= 0x30000; v++) values.push_back(v);
+    for (int i = 0; i < 1000000; i++) values.push_back((int32_t)random());
+
+    for (int32_t v : values)
+    {
+        uint16_t u = Fixed_Point_Sat_U16(v);
+        int16_t s = Fixed_Point_Sat_S16(v);
+        uint16_t w = Fixed_Point_Sat_U16_From_U32((uint32_t)v);
+
+        if (u != Clamp(v, 0, 0xFFFF)) Fail(mismatches, "Sat_U16", v, 0, u, Clamp(v, 0, 0xFFFF));
+        if (s != Clamp(v, -0x8000, 0x7FFF)) Fail(mismatches, "Sat_S16", v, 0, s, Clamp(v, -0x8000, 0x7FFF));
+        if (w != std::min<uint32_t>((uint32_t)v, 0xFFFF)) Fail(mismatches, "Sat_U16_From_U32", (uint32_t)v, 0, w, 0);
+    }
+
+    Report("Saturations", values.size(), mismatches);
+}
+
+// Every pair of unsigned 16-bit values
+void Check_Unsigned_16()
+{
+    uint64_t mismatches = 0;
+
+    for (uint32_t a = 0; a <= 0xFFFF; a++)
+    {
+        for (uint32_t b = 0; b <= 0xFFFF; b++)
+        {
+            uint16_t sum = Fixed_Point_Add_U16((uint16_t)a, (uint16_t)b);
+            uint16_t difference = Fixed_Point_Sub_U16((uint16_t)a, (uint16_t)b);
+            uint16_t distance = Fixed_Point_Abs_Diff_U16((uint16_t)a, (uint16_t)b);
+            uint16_t product = Fixed_Point_Mul_UQ16((uint16_t)a, (uint16_t)b);
+            uint32_t expected_product = (uint32_t)(((uint64_t)a * b + 0x8000) >> 16);
+
+            if (sum != std::min<uint32_t>(a + b, 0xFFFF)) Fail(mismatches, "Add_U16", a, b, sum, std::min<uint32_t>(a + b, 0xFFFF));
+            if (difference != ((a > b) ? a - b : 0)) Fail(mismatches, "Sub_U16", a, b, difference, (a > b) ? a - b : 0);
+            if (distance != ((a > b) ? a - b : b - a)) Fail(mismatches, "Abs_Diff_U16", a, b, distance, 0);
+            if ((product != expected_product) || (product > std::min(a, b))) Fail(mismatches, "Mul_UQ16", a, b, product, expected_product);
+        }
+    }
+
+    Report("Add, Sub, Abs_Diff and Mul of UQ16", 1ull << 32, mismatches);
+}
+
+// Every pair of Q15 values
+void Check_Q15()
+{
+    uint64_t mismatches = 0;
+
+    for (int32_t a = -0x8000; a <= 0x7FFF; a++)
+    {
+        for (int32_t b = -0x8000; b <= 0x7FFF; b++)
+        {
+            int16_t sum = Fixed_Point_Add_Q15((int16_t)a, (int16_t)b);
+            int16_t difference = Fixed_Point_Sub_Q15((int16_t)a, (int16_t)b);
+            int16_t product = Fixed_Point_Mul_Q15((int16_t)a, (int16_t)b);
+            int64_t expected_product = Clamp(Round_Shift((int64_t)a * b, 15), -0x8000, 0x7FFF);
+
+            if (sum != Clamp(a + b, -0x8000, 0x7FFF)) Fail(mismatches, "Add_Q15", a, b, sum, Clamp(a + b, -0x8000, 0x7FFF));
+            if (difference != Clamp(a - b, -0x8000, 0x7FFF)) Fail(mismatches, "Sub_Q15", a, b, difference, Clamp(a - b, -0x8000, 0x7FFF));
+            if (product != expected_product) Fail(mismatches, "Mul_Q15", a, b, product, expected_product);
+        }
+    }
+
+    Report("Add, Sub and Mul of Q15", 1ull << 32, mismatches);
+}
+
+void Check_32_Bit(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    std::vector<int32_t> edges = { 0, 1, -1, 2, -2, 0x7FFF, 0x8000, -0x8000, 0xFFFF, 0x10000, -0x10000, 0x10001,
+                                   0x7FFFFFFF, 0x7FFFFFFE, INT32_MIN, INT32_MIN + 1, 46341, -46341 };
+    std::vector<std::pair<int32_t, int32_t>> pairs;
+
+    for (int32_t a : edges) for (int32_t b : edges) pairs.push_back({ a, b });
+    for (int i = 0; i < 20000000; i++) pairs.push_back({ (int32_t)random(), (int32_t)random() });
+
+    // Products around 1.0 and of small values, where the rounding shows
+    for (int i = 0; i < 10000000; i++)
+    {
+        pairs.push_back({ (int32_t)(random() % 0x40000) - 0x20000, (int32_t)(random() % 0x40000) - 0x20000 });
+    }
+
+    for (const auto &pair : pairs)
+    {
+        int64_t a = pair.first;
+        int64_t b = pair.second;
+        int32_t sum = Fixed_Point_Add_S32(pair.first, pair.second);
+        int32_t difference = Fixed_Point_Sub_S32(pair.first, pair.second);
+        int32_t product = Fixed_Point_Mul_Q16_16(pair.first, pair.second);
+        int64_t expected_product = Clamp(Round_Shift(a * b, 16), INT32_MIN, INT32_MAX);
+
+        if (sum != Clamp(a + b, INT32_MIN, INT32_MAX)) Fail(mismatches, "Add_S32", a, b, sum, Clamp(a + b, INT32_MIN, INT32_MAX));
+        if (difference != Clamp(a - b, INT32_MIN, INT32_MAX)) Fail(mismatches, "Sub_S32", a, b, difference, Clamp(a - b, INT32_MIN, INT32_MAX));
+        if (product != expected_product) Fail(mismatches, "Mul_Q16_16", a, b, product, expected_product);
+    }
+
+    Report("Add_S32, Sub_S32 and Mul_Q16_16", pairs.size(), mismatches);
+}
+
+void Check_Divide(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+
+    // Every 16-bit dividend and divisor
+    for (uint32_t d = 1; d <= 0xFFFF; d++)
+    {
+        Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(d);
+
+        for (uint32_t n = 0; n <= 0xFFFF; n++)
+        {
+            uint32_t q = Fixed_Point_Divide(n, d, reciprocal);
+            if (q != n / d) Fail(mismatches, "Divide", n, d, q, n / d);
+        }
+    }
+
+    cases += 0xFFFFull * 0x10000;
+
+    // Every divisor up to 2^18, with the dividends on both sides of its multiples and at random
+    for (uint32_t d = 1; d <= (1u << 18); d++)
+    {
+        Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(d);
+        uint32_t top = 0xFFFFFFFFu - 0xFFFFFFFFu % d;
+        uint32_t dividends[] = { 0, 1, d - 1, d, d + 1, 2 * d - 1, 2 * d, top - 1, top, top - d, 0xFFFFFFFFu,
+                                 (uint32_t)random(), (uint32_t)random(), (uint32_t)random(), (uint32_t)random(),
+                                 (uint32_t)random() / d * d, (uint32_t)random() / d * d - 1 };
+
+        for (uint32_t n : dividends)
+        {
+            uint32_t q = Fixed_Point_Divide(n, d, reciprocal);
+            if (q != n / d) Fail(mismatches, "Divide", n, d, q, n / d);
+        }
+
+        cases += sizeof(dividends) / sizeof(dividends[0]);
+    }
+
+    // Every 32-bit dividend for a few divisors, up to the largest
+    for (uint32_t d : { 3u, 196605u, 0xFFFFFFFFu })
+    {
+        Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(d);
+        uint32_t n = 0;
+
+        do
+        {
+            uint32_t q = Fixed_Point_Divide(n, d, reciprocal);
+            if (q != n / d) Fail(mismatches, "Divide", n, d, q, n / d);
+        }
+        while (++n != 0);
+
+        cases += 1ull << 32;
+    }
+
+    Report("Reciprocal and Divide", cases, mismatches);
+}
+
+// Every pair of a 16-bit value and range
+void Check_Scale()
+{
+    uint64_t mismatches = 0;
+
+    for (uint32_t range = 0; range <= 0xFFFF; range++)
+    {
+        for (uint32_t value = 0; value <= 0xFFFF; value++)
+        {
+            uint16_t scaled = Fixed_Point_Scale_UQ16((uint16_t)value, (uint16_t)range);
+            uint32_t expected = (range == 0) ? 0 : (uint32_t)std::min<uint64_t>((uint64_t)value * 0xFFFF / range, 0xFFFF);
+
+            if (scaled != expected) Fail(mismatches, "Scale_UQ16", value, range, scaled, expected);
+        }
+    }
+
+    Report("Scale_UQ16", 1ull << 32, mismatches);
+}
+
+void Check_Sqrt(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+
+    auto check = [&](uint32_t value)
+    {
+        uint64_t root = Fixed_Point_Sqrt(value);
+
+        if ((root * root > value) || ((root + 1) * (root + 1) <= value))
+        {
+            Fail(mismatches, "Sqrt", value, 0, (int64_t)root, (int64_t)std::sqrt((double)value));
+        }
+
+        cases++;
+    };
+
+    for (uint32_t value = 0; value <= (1u << 24); value++) check(value);
+
+    for (uint64_t k = 1; k <= 0xFFFF; k++)
+    {
+        check((uint32_t)(k * k - 1));
+        check((uint32_t)(k * k));
+        check((uint32_t)(k * k + 2 * k));
+    }
+
+    for (int i = 0; i < 10000000; i++) check((uint32_t)random());
+
+    check(0xFFFFFFFFu);
+    Report("Sqrt", cases, mismatches);
+}
+
+// ---- Stages of the pipeline ----
+
+// The calibration of every sample value for random calibrations: the same values as the previous code
+// within the calibration, where it did not wrap around, and saturated outside of it
+void Check_Normalize(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+    uint64_t saturated = 0;
+
+    for (int c = 0; c < 2000; c++)
+    {
+        uint16_t min = (c < 4) ? (uint16_t)((c & 1) ? 0xFFFF : 0) : (uint16_t)(random() % 65536);
+        uint16_t max = (c < 4) ? (uint16_t)((c & 2) ? 0xFFFF : 0) : (uint16_t)(random() % 65536);
+
+        // Half of the calibrations with a small range, as in a dim room
+        if ((c >= 4) && (c % 2 == 0)) max = (uint16_t)std::min(0xFFFF, min + (int)(random() % 2000));
+
+        PMOD_Calibration_Data calibration = { { min, min, min, min }, { max, max, max, max } };
+
+        for (uint32_t v = 0; v <= 0xFFFF; v++)
+        {
+            PMOD_Color_Data sample = { (uint16_t)v, (uint16_t)v, (uint16_t)v, (uint16_t)v };
+            PMOD_Color_Data normalized = PMOD_Color_Normalize_Calibration(sample, calibration);
+            int64_t expected = 0;
+
+            if ((max > min) && (v >= min))
+            {
+                int64_t scaled = (int64_t)(v - min) * (0xFFFF / (max - min));
+
+                // The previous code truncated the product to 16 bits
+                if (v <= max) expected = (uint16_t)((v - min) * (0xFFFF / (max - min)));
+                else expected = std::min<int64_t>(scaled, 0xFFFF);
+
+                if (scaled > 0xFFFF) saturated++;
+            }
+
+            if ((normalized.red != expected) || (normalized.green != normalized.red) ||
+                (normalized.blue != normalized.red) || (normalized.clear != normalized.red))
+            {
+                Fail(mismatches, "Normalize_Calibration", v, (int64_t)min << 16 | max, normalized.red, expected);
+            }
+
+            cases++;
+        }
+    }
+
+    Report("PMOD_Color_Normalize_Calibration", cases, mismatches);
+    std::printf("    %llu values above the calibration saturated instead of wrapping around\n", (unsigned long long)saturated);
+}
+
+// The rules of the classifier against the int comparisons of the original Detect_Color
+Color_t Classify_Reference(const Color_Classifier_Params &params, int R, int G, int B)
+{
+    if ((G > R + params.green_margin) && (G > B + params.green_margin)) return COLOR_GREEN;
+    if ((R > params.yellow_min_rg) && (G > params.yellow_min_rg) && (B < params.yellow_max_blue)) return COLOR_YELLOW;
+    if ((R > G + params.red_margin) && (R > B + params.red_margin)) return COLOR_RED;
+
+    return COLOR_UNKNOWN;
+}
+
+void Check_Classify(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+    const uint16_t edges[] = { 0, 1, 6000, 0x7FFF, 0x8000, 0xFFFE, 0xFFFF };
+
+    for (int p = 0; p < 2000; p++)
+    {
+        Color_Classifier_Params params = (p == 0) ? Color_Classifier_Default_Params
+                                                  : Color_Classifier_Params{ (uint16_t)random(), (uint16_t)random(),
+                                                                             (uint16_t)random(), (uint16_t)random() };
+
+        if (p % 3 == 1)
+        {
+            params.green_margin = edges[random() % 7];
+            params.red_margin = edges[random() % 7];
+        }
+
+        for (int i = 0; i < 20000; i++)
+        {
+            uint16_t R = (i % 4 == 0) ? edges[random() % 7] : (uint16_t)random();
+            uint16_t G = (i % 4 == 1) ? edges[random() % 7] : (uint16_t)random();
+            uint16_t B = (i % 4 == 2) ? edges[random() % 7] : (uint16_t)random();
+
+            // Around the margins, where the sums saturate
+            if (i % 8 == 3) G = (uint16_t)std::min(0xFFFF, R + params.green_margin + (int)(random() % 3) - 1);
+            if (i % 8 == 7) R = (uint16_t)std::min(0xFFFF, G + params.red_margin + (int)(random() % 3) - 1);
+
+            Color_t color = Color_Classifier_Classify(&params, R, G, B);
+            Color_t expected = Classify_Reference(params, R, G, B);
+
+            if (color != expected) Fail(mismatches, "Classify", R, G, color, expected);
+            cases++;
+        }
+    }
+
+    Report("Color_Classifier_Classify", cases, mismatches);
+}
+
+// The scaling to the burst integration time against the previous division per channel
+void Check_Adaptive_Rate(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+
+    for (int c = 0; c < 500; c++)
+    {
+        Adaptive_Rate_Config config = Adaptive_Rate_Default_Config;
+        Adaptive_Rate_Controller controller;
+
+        // ATIME gives 2.4 ms to 614 ms, and times below 100 us leave the samples as they are
+        if (c > 0)
+        {
+            config.integration_us[ADAPTIVE_RATE_IDLE] = (c % 10 == 1) ? random() % 100 : 2400 * (1 + random() % 256);
+            config.integration_us[ADAPTIVE_RATE_BURST] = 2400 * (1 + random() % 256);
+        }
+
+        Adaptive_Rate_Init(&controller, &config);
+
+        uint32_t from = config.integration_us[ADAPTIVE_RATE_IDLE] / 100;
+        uint32_t to = config.integration_us[ADAPTIVE_RATE_BURST] / 100;
+
+        for (uint32_t v = 0; v <= 0xFFFF; v++)
+        {
+            PMOD_Color_Data sample = { (uint16_t)v, (uint16_t)(0xFFFF - v), (uint16_t)(v * 7), (uint16_t)v };
+            PMOD_Color_Data scaled = Adaptive_Rate_Normalize(&controller, sample);
+            const uint16_t *in = &sample.red;
+            const uint16_t *out = &scaled.red;
+
+            for (int i = 0; i < 4; i++)
+            {
+                uint32_t expected = ((from == 0) || (from == to)) ? in[i]
+                                                                  : std::min<uint32_t>(((uint32_t)in[i] * to + from / 2) / from, 0xFFFF);
+
+                if (out[i] != expected) Fail(mismatches, "Adaptive_Rate_Normalize", in[i], from << 16 | to, out[i], expected);
+            }
+
+            cases++;
+        }
+    }
+
+    Report("Adaptive_Rate_Normalize", cases, mismatches);
+}
+
+// The chromaticity keys against the division of each channel
+void Check_Keys(std::mt19937 &random)
+{
+    uint64_t mismatches = 0;
+    uint64_t cases = 0;
+
+    for (int i = 0; i < 20000000; i++)
+    {
+        uint16_t R = (i < 8) ? ((i & 1) ? 0xFFFF : 0) : (uint16_t)random();
+        uint16_t G = (i < 8) ? ((i & 2) ? 0xFFFF : 0) : (uint16_t)random();
+        uint16_t B = (i < 8) ? ((i & 4) ? 0xFFFF : 0) : (uint16_t)random();
+
+        // Dark samples, where the sums are small
+        if (i % 2 == 1)
+        {
+            R %= 64;
+            G %= 64;
+            B %= 64;
+        }
+
+        uint32_t sum = (uint32_t)R + G + B;
+        Color_Names_Key key = Color_Names_Key_From_RGB(R, G, B);
+
+        if (sum == 0) continue;
+
+        uint32_t x = ((uint32_t)R * COLOR_NAMES_ONE + sum / 2) / sum;
+        uint32_t y = ((uint32_t)G * COLOR_NAMES_ONE + sum / 2) / sum;
+
+        if ((key.x != x) || (key.y != y) || (key.lightness != sum / 6)) Fail(mismatches, "Key_From_RGB", R, G, key.x, x);
+        cases++;
+    }
+
+    Report("Color_Names_Key_From_RGB", cases, mismatches);
+}
+
+int Check_Fixed_Point()
+{
+    std::mt19937 random(100);
+
+    std::printf("Intrinsics: %s\n", FIXED_POINT_INTRINSICS ? "yes" : "no, portable C");
+
+    Check_Saturations(random);
+    Check_Unsigned_16();
+    Check_Q15();
+    Check_32_Bit(random);
+    Check_Divide(random);
+    Check_Scale();
+    Check_Sqrt(random);
+
+    Check_Normalize(random);
+    Check_Classify(random);
+    Check_Adaptive_Rate(random);
+    Check_Keys(random);
+
+    std::printf("Fixed point: %s\n", failures ? "FAILED" : "passed");
+
+    return failures ? 1 : 0;
+}
+
+// ---- Benchmark ----
+
+// The calibration, classification and chromaticity of a sample in float, as they would be written
+// without the fixed-point library
+struct Float_Key
+{
+    float x, y, lightness;
+};
+
+Color_t Float_Pipeline(const PMOD_Color_Data &sample, const PMOD_Calibration_Data &calibration, Float_Key &key)
+{
+    const uint16_t *in = &sample.red;
+    const uint16_t *min = &calibration.min.red;
+    const uint16_t *max = &calibration.max.red;
+    float calibrated[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        float range = (float)max[i] - (float)min[i];
+        float value = (range > 0.0f) ? ((float)in[i] - (float)min[i]) * std::floor(65535.0f / range) : 0.0f;
+
+        calibrated[i] = std::min(std::max(value, 0.0f), 65535.0f);
+    }
+
+    float R = calibrated[0];
+    float G = calibrated[1];
+    float B = calibrated[2];
+    float sum = R + G + B;
+    const Color_Classifier_Params &params = Color_Classifier_Default_Params;
+
+    key.x = (sum > 0.0f) ? R / sum : 1.0f / 3.0f;
+    key.y = (sum > 0.0f) ? G / sum : 1.0f / 3.0f;
+    key.lightness = sum / 6.0f;
+
+    if ((G > R + params.green_margin) && (G > B + params.green_margin)) return COLOR_GREEN;
+    if ((R > params.yellow_min_rg) && (G > params.yellow_min_rg) && (B < params.yellow_max_blue)) return COLOR_YELLOW;
+    if ((R > G + params.red_margin) && (R > B + params.red_margin)) return COLOR_RED;
+
+    return COLOR_UNKNOWN;
+}
+
+Color_t Fixed_Pipeline(const PMOD_Color_Data &sample, const PMOD_Calibration_Data &calibration, Color_Names_Key &key)
+{
+    PMOD_Color_Data calibrated = PMOD_Color_Normalize_Calibration(sample, calibration);
+
+    key = Color_Names_Key_From_RGB(calibrated.red, calibrated.green, calibrated.blue);
+
+    return Color_Classifier_Classify(&Color_Classifier_Default_Params, calibrated.red, calibrated.green, calibrated.blue);
+}
+
+// Best of 5 runs of a function over all the inputs, in ns per input
+template <typename Input, typename Function>
+double Time_ns(const std::vector<Input> &inputs, Function function, double &checksum)
+{
+    double best_ns = 1e30;
+
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (const Input &input : inputs) checksum += function(input);
+
+        double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best_ns = std::min(best_ns, elapsed_ns / inputs.size());
+    }
+
+    return best_ns;
+}
+
+void Print_Bench(const char *name, const char *fixed_name, double fixed_ns, const char *other_name, double other_ns)
+{
+    std::printf("%-28s %-26s %7.2f ns   %-22s %7.2f ns   %5.2fx\n", name, fixed_name, fixed_ns, other_name, other_ns,
+                other_ns / fixed_ns);
+}
+
+int Bench_Fixed_Point()
+{
+    std::mt19937 random(5);
+    PMOD_Calibration_Data calibration = { { 310, 420, 380, 1200 }, { 21000, 26000, 19000, 61000 } };
+    std::vector<PMOD_Color_Data> samples(1000000);
+    std::vector<uint32_t> values(1000000);
+    std::vector<std::pair<int16_t, int16_t>> pairs(1000000);
+    double checksum = 0.0;
+
+    for (PMOD_Color_Data &sample : samples)
+    {
+        sample = { (uint16_t)(random() % 22000), (uint16_t)(random() % 27000), (uint16_t)(random() % 20000),
+                   (uint16_t)(random() % 62000) };
+    }
+
+    for (uint32_t &value : values) value = (uint32_t)random() >> (random() % 16);
+    for (auto &pair : pairs) pair = { (int16_t)random(), (int16_t)random() };
+
+    std::printf("%-28s %-26s %10s   %-22s %10s   %6s\n", "Per sample", "Fixed point", "", "Reference", "", "Ratio");
+
+    double fixed_ns = Time_ns(samples, [&](const PMOD_Color_Data &sample)
+    {
+        Color_Names_Key key;
+        return (double)Fixed_Pipeline(sample, calibration, key) + key.x + key.y;
+    }, checksum);
+
+    double float_ns = Time_ns(samples, [&](const PMOD_Color_Data &sample)
+    {
+        Float_Key key;
+        return (double)Float_Pipeline(sample, calibration, key) + key.x + key.y;
+    }, checksum);
+
+    Print_Bench("Calibrate, classify, key", "firmware", fixed_ns, "float", float_ns);
+
+    // Four channels divided by the same integration time
+    fixed_ns = Time_ns(samples, [](const PMOD_Color_Data &sample)
+    {
+        uint32_t from = 24 + sample.clear % 1000;
+        Fixed_Point_UQ32 reciprocal = Fixed_Point_Reciprocal(from);
+        return (double)(Fixed_Point_Divide(sample.red * 96u, from, reciprocal) + Fixed_Point_Divide(sample.green * 96u, from, reciprocal) +
+                        Fixed_Point_Divide(sample.blue * 96u, from, reciprocal) + Fixed_Point_Divide(sample.clear * 96u, from, reciprocal));
+    }, checksum);
+
+    float_ns = Time_ns(samples, [](const PMOD_Color_Data &sample)
+    {
+        uint32_t from = 24 + sample.clear % 1000;
+        return (double)(sample.red * 96u / from + sample.green * 96u / from + sample.blue * 96u / from + sample.clear * 96u / from);
+    }, checksum);
+
+    Print_Bench("4 divisions by one value", "Reciprocal + 4 Divide", fixed_ns, "4 divisions", float_ns);
+
+    float_ns = Time_ns(samples, [](const PMOD_Color_Data &sample)
+    {
+        float from = (float)(24 + sample.clear % 1000);
+        return (double)(sample.red * 96.0f / from + sample.green * 96.0f / from + sample.blue * 96.0f / from + sample.clear * 96.0f / from);
+    }, checksum);
+
+    Print_Bench("", "", fixed_ns, "4 float divisions", float_ns);
+
+    fixed_ns = Time_ns(values, [](uint32_t value) { return (double)Fixed_Point_Sqrt(value); }, checksum);
+    float_ns = Time_ns(values, [](uint32_t value) { return (double)std::sqrt((float)value); }, checksum);
+    Print_Bench("Square root", "Sqrt", fixed_ns, "sqrtf", float_ns);
+
+    fixed_ns = Time_ns(pairs, [](const std::pair<int16_t, int16_t> &pair)
+    {
+        return (double)Fixed_Point_Mul_Q15(pair.first, pair.second);
+    }, checksum);
+
+    float_ns = Time_ns(pairs, [](const std::pair<int16_t, int16_t> &pair)
+    {
+        return (double)std::min(std::max((pair.first / 32768.0f) * (pair.second / 32768.0f), -1.0f), 32767.0f / 32768.0f);
+    }, checksum);
+
+    Print_Bench("Product", "Mul_Q15", fixed_ns, "float", float_ns);
+
+    std::printf("(checksum %.0f)\n", checksum);
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if ((argc == 2) && !std::strcmp(argv[1], "--check")) return Check_Fixed_Point();
+    if ((argc == 2) && !std::strcmp(argv[1], "--bench")) return Bench_Fixed_Point();
+
+    std::fprintf(stderr, "Usage: %s --check\n"
+                         "       %s --bench\n", argv[0], argv[0]);
+    return 2;
+}
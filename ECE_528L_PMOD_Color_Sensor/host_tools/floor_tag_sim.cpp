@@ -0,0 +1,408 @@
+/**
+ * @file floor_tag_sim.cpp
+ * @brief Validates the Floor_Tag decoder on synthetic and recorded drive-and-scan streams.
+ *
+ * Synthetic streams: random tags of 3 to 8 patches (30 mm each, 10 mm gaps between patches of the same
+ * color, and touching or separated patches of different colors) are laid on a dark floor. The robot
+ * drives over each tag at a set speed and samples at the maximum rate of the firmware, one 2.4 ms
+ * integration after the other. Each sample averages the floor under the sensor spot (6 mm) over the
+ * distance driven during its integration, with the brightness and tint of each patch and the sensor
+ * noise, and is classified with the firmware's Color_Classifier and Floor_Tag_Classifier_Params (or the
+ * Simon thresholds with --simon-thresholds). The decoder receives the distance that the firmware
+ * computes from the nominal speed, while the robot actually drives up to 15% faster or slower. For each
+ * speed, the program counts the tags read correctly, the tags reported as errors, the wrong tags (read
+ * as complete with other symbols) and the tags missed.
+ *
+ * Recorded streams: a capture file (see Capture.h) of a drive at a known speed is replayed through
+ * Color_Classifier and the decoder, and the tags are printed. When the capture is labeled with the
+ * floor color under the sensor, the tags decoded from the labels are printed as the reference.
+ * --write saves synthetic drives in this format.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Floor_Tag.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR floor_tag_sim.cpp Capture.cpp Floor_Tag.o Color_Classifier.o -o floor_tag_sim
+ *
+ * Usage:
+ *   floor_tag_sim [--tags N] [--seed N] [--noise SIGMA] [--spot MM] [--speed-error FRACTION] [--simon-thresholds]
+ *   floor_tag_sim --write FILE [--speed MM_PER_S] [--tags N]
+ *   floor_tag_sim --capture FILE --speed MM_PER_S [--simon-thresholds]
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Capture.h"
+#include "inc/Adaptive_Rate.h"
+#include "inc/Color_Classifier.h"
+#include "inc/Floor_Tag.h"
+
+namespace
+{
+
+// Calibrated colors of the patches and of the floor
+const double COLOR_VALUES[4][3] =
+{
+    { 0x1800, 0x4C00, 0x2400 },     // Green
+    { 0x6400, 0x1C00, 0x1A00 },     // Red
+    { 0x6000, 0x5600, 0x2000 },     // Yellow
+    { 0x0C00, 0x0D00, 0x0B00 },     // Floor
+};
+
+// Floor layout in millimeters
+constexpr double PATCH_MM = 30.0;
+constexpr double GAP_MM = 10.0;
+constexpr double LEAD_IN_MM = 60.0;
+constexpr double LEAD_OUT_MM = 100.0;
+
+// Maximum sampling rate of the firmware: burst integrations back to back
+constexpr double PERIOD_US = ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US;
+
+struct Config
+{
+    uint32_t tags = 2000;
+    uint32_t seed = 528;
+    double noise = 600.0;
+    double spot_mm = 6.0;
+    double speed_error = 0.15;
+    const Color_Classifier_Params *classifier = &Floor_Tag_Classifier_Params;
+};
+
+struct Segment
+{
+    double start_mm;
+    double end_mm;
+    int color;
+    double value[3];
+};
+
+struct Floor
+{
+    std::vector<Segment> segments;
+    std::vector<Color_t> tag;
+    double length_mm = 0.0;
+
+    void Add(double length, int color, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        Segment segment = { length_mm, length_mm + length, color, {} };
+
+        // Brightness of the patch and tint of each channel. The sensor is at a fixed height over the
+        // floor and lit by its own LED, so they vary less than for the objects of simon_farm
+        double brightness = 0.9 + 0.2 * unit(random);
+        for (int c = 0; c < 3; c++) segment.value[c] = COLOR_VALUES[color][c] * brightness * (0.95 + 0.1 * unit(random));
+
+        segments.push_back(segment);
+        length_mm += length;
+    }
+
+    const Segment &At(double x) const
+    {
+        for (const Segment &segment : segments)
+        {
+            if (x < segment.end_mm) return segment;
+        }
+        return segments.back();
+    }
+};
+
+Floor Make_Floor(std::mt19937 &random)
+{
+    Floor floor;
+    int symbols = 3 + (int)(random() % (FLOOR_TAG_MAX_SYMBOLS - 2));
+
+    floor.Add(LEAD_IN_MM, COLOR_UNKNOWN, random);
+
+    for (int i = 0; i < symbols; i++)
+    {
+        Color_t color = (Color_t)(random() % 3);
+
+        // Patches of the same color need a gap; the others touch half of the time
+        if ((i > 0) && ((color == floor.tag.back()) || (random() % 2)))
+        {
+            floor.Add(GAP_MM, COLOR_UNKNOWN, random);
+        }
+
+        floor.Add(PATCH_MM, color, random);
+        floor.tag.push_back(color);
+    }
+
+    floor.Add(LEAD_OUT_MM, COLOR_UNKNOWN, random);
+    return floor;
+}
+
+struct Sample
+{
+    double time_us;
+    double position_mm;
+    int label;
+    uint16_t rgb[3];
+};
+
+// Samples a drive over the floor. The sensor integrates the floor under its spot while the robot moves
+std::vector<Sample> Drive(const Floor &floor, double speed_mm_s, double actual_speed_mm_s, const Config &config, std::mt19937 &random)
+{
+    std::normal_distribution<double> noise(0.0, config.noise);
+    std::vector<Sample> samples;
+    const int time_steps = 8;
+    const int spot_points = 5;
+
+    for (double t = PERIOD_US; ; t += PERIOD_US)
+    {
+        double end_mm = actual_speed_mm_s * t * 1e-6;
+        double start_mm = end_mm - actual_speed_mm_s * PERIOD_US * 1e-6;
+
+        if (end_mm + config.spot_mm > floor.length_mm) break;
+
+        double sum[3] = {};
+        for (int i = 0; i < time_steps; i++)
+        {
+            double center = start_mm + (end_mm - start_mm) * (i + 0.5) / time_steps;
+            for (int j = 0; j < spot_points; j++)
+            {
+                const Segment &segment = floor.At(center + config.spot_mm * ((j + 0.5) / spot_points - 0.5));
+                for (int c = 0; c < 3; c++) sum[c] += segment.value[c];
+            }
+        }
+
+        Sample sample;
+        double middle_mm = (start_mm + end_mm) / 2;
+
+        // The firmware tags a sample with the middle of its integration, from the nominal speed
+        sample.time_us = t - PERIOD_US / 2;
+        sample.position_mm = speed_mm_s * sample.time_us * 1e-6;
+        sample.label = floor.At(middle_mm).color;
+
+        for (int c = 0; c < 3; c++)
+        {
+            double value = sum[c] / (time_steps * spot_points) + noise(random);
+            sample.rgb[c] = (uint16_t)std::min(65535.0, std::max(0.0, value));
+        }
+
+        samples.push_back(sample);
+    }
+
+    return samples;
+}
+
+Color_t Classify(const Config &config, const uint16_t rgb[3])
+{
+    return Color_Classifier_Classify(config.classifier, rgb[0], rgb[1], rgb[2]);
+}
+
+uint32_t To_um(double mm)
+{
+    return (uint32_t)(int64_t)std::llround(mm * 1000.0);
+}
+
+struct Speed_Result
+{
+    uint32_t correct = 0;
+    uint32_t errors = 0;
+    uint32_t wrong = 0;
+    uint32_t missed = 0;
+    uint64_t samples = 0;
+    uint64_t glitches = 0;
+};
+
+Speed_Result Run_Speed(double speed_mm_s, const Config &config)
+{
+    std::mt19937 random(config.seed + (uint32_t)speed_mm_s);
+    std::uniform_real_distribution<double> error(-config.speed_error, config.speed_error);
+    Speed_Result result;
+    Floor_Tag_Decoder decoder;
+
+    Floor_Tag_Init(&decoder, &Floor_Tag_Default_Params);
+
+    for (uint32_t n = 0; n < config.tags; n++)
+    {
+        Floor floor = Make_Floor(random);
+        std::vector<Sample> samples = Drive(floor, speed_mm_s, speed_mm_s * (1.0 + error(random)), config, random);
+        int outcome = FLOOR_TAG_NONE;
+        std::vector<Color_t> read;
+
+        Floor_Tag_Reset(&decoder, 0);
+
+        for (const Sample &sample : samples)
+        {
+            int pushed = Floor_Tag_Push(&decoder, Classify(config, sample.rgb), To_um(sample.position_mm));
+
+            if ((pushed == FLOOR_TAG_COMPLETE) || (pushed == FLOOR_TAG_ERROR))
+            {
+                outcome = pushed;
+                read.assign(decoder.tag, decoder.tag + decoder.tag_length);
+                break;
+            }
+        }
+
+        if (outcome == FLOOR_TAG_COMPLETE) (read == floor.tag) ? result.correct++ : result.wrong++;
+        else if (outcome == FLOOR_TAG_ERROR) result.errors++;
+        else result.missed++;
+    }
+
+    result.samples = decoder.samples;
+    result.glitches = decoder.glitches;
+    return result;
+}
+
+const char *LABEL_NAMES[4] = { "green", "red", "yellow", "none" };
+
+bool Write_Capture(const char *path, double speed_mm_s, const Config &config)
+{
+    FILE *file = std::fopen(path, "w");
+    std::mt19937 random(config.seed);
+
+    if (!file)
+    {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    std::fprintf(file, "# Synthetic drive-and-scan at %.0f mm/s\n", speed_mm_s);
+    std::fprintf(file, "time_us,label,r,g,b\n");
+
+    double offset_us = 0;
+    for (uint32_t n = 0; n < config.tags; n++)
+    {
+        Floor floor = Make_Floor(random);
+        std::vector<Sample> samples = Drive(floor, speed_mm_s, speed_mm_s, config, random);
+
+        std::fprintf(file, "# tag");
+        for (Color_t color : floor.tag) std::fprintf(file, " %s", LABEL_NAMES[color]);
+        std::fprintf(file, "\n");
+
+        for (const Sample &sample : samples)
+        {
+            std::fprintf(file, "%llu,%s,0x%04X,0x%04X,0x%04X\n", (unsigned long long)(offset_us + sample.time_us),
+                         LABEL_NAMES[sample.label], sample.rgb[0], sample.rgb[1], sample.rgb[2]);
+        }
+
+        offset_us += samples.back().time_us + PERIOD_US;
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+void Print_Tag(const char *prefix, const Floor_Tag_Decoder &decoder, int result, uint64_t time_us)
+{
+    std::printf("%s %8.3f s: ", prefix, time_us * 1e-6);
+
+    if (result == FLOOR_TAG_ERROR)
+    {
+        std::printf("error\n");
+        return;
+    }
+
+    for (uint8_t i = 0; i < decoder.tag_length; i++)
+    {
+        std::printf("%s%s", i ? " " : "", Color_Classifier_Name(decoder.tag[i]));
+    }
+    std::printf("\n");
+}
+
+int Replay_Capture(const char *path, double speed_mm_s, const Config &config)
+{
+    Capture capture;
+    if (!Capture_Load(path, capture) || (capture.Size() == 0)) return 1;
+
+    Floor_Tag_Decoder decoder;
+    Floor_Tag_Decoder reference;
+    bool labeled = false;
+
+    Floor_Tag_Init(&decoder, &Floor_Tag_Default_Params);
+    Floor_Tag_Init(&reference, &Floor_Tag_Default_Params);
+
+    for (size_t i = 0; i < capture.Size(); i++)
+    {
+        uint64_t time_us = capture.time_us[i] - capture.time_us[0];
+        uint32_t position_um = To_um(speed_mm_s * time_us * 1e-6);
+        uint16_t rgb[3] = { capture.red[i], capture.green[i], capture.blue[i] };
+
+        int result = Floor_Tag_Push(&decoder, Classify(config, rgb), position_um);
+        if ((result == FLOOR_TAG_COMPLETE) || (result == FLOOR_TAG_ERROR)) Print_Tag("sensor   ", decoder, result, time_us);
+
+        labeled = labeled || (capture.label[i] != COLOR_UNKNOWN);
+        result = Floor_Tag_Push(&reference, (Color_t)capture.label[i], position_um);
+        if (labeled && ((result == FLOOR_TAG_COMPLETE) || (result == FLOOR_TAG_ERROR))) Print_Tag("labels   ", reference, result, time_us);
+    }
+
+    std::printf("%zu samples at %.0f mm/s (%.2f mm per sample)\n", capture.Size(), speed_mm_s,
+                speed_mm_s * (capture.time_us.back() - capture.time_us.front()) * 1e-6 / std::max<size_t>(1, capture.Size() - 1));
+    Floor_Tag_Print_Stats(&decoder);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Config config;
+    const char *capture_path = nullptr;
+    const char *write_path = nullptr;
+    double speed_mm_s = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--tags") && (i + 1 < argc)) config.tags = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if ((option == "--seed") && (i + 1 < argc)) config.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if ((option == "--noise") && (i + 1 < argc)) config.noise = std::atof(argv[++i]);
+        else if ((option == "--spot") && (i + 1 < argc)) config.spot_mm = std::atof(argv[++i]);
+        else if ((option == "--speed-error") && (i + 1 < argc)) config.speed_error = std::atof(argv[++i]);
+        else if ((option == "--speed") && (i + 1 < argc)) speed_mm_s = std::atof(argv[++i]);
+        else if ((option == "--capture") && (i + 1 < argc)) capture_path = argv[++i];
+        else if ((option == "--write") && (i + 1 < argc)) write_path = argv[++i];
+        else if (option == "--simon-thresholds") config.classifier = &Color_Classifier_Default_Params;
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--tags N] [--seed N] [--noise SIGMA] [--spot MM] [--speed-error FRACTION] [--simon-thresholds]\n"
+                                 "       %s --write FILE [--speed MM_PER_S] [--tags N]\n"
+                                 "       %s --capture FILE --speed MM_PER_S [--simon-thresholds]\n", argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (capture_path)
+    {
+        if (speed_mm_s <= 0.0)
+        {
+            std::fprintf(stderr, "--capture needs the speed of the drive (--speed)\n");
+            return 2;
+        }
+        return Replay_Capture(capture_path, speed_mm_s, config);
+    }
+
+    if (write_path)
+    {
+        return Write_Capture(write_path, (speed_mm_s > 0.0) ? speed_mm_s : 150.0, config) ? 0 : 1;
+    }
+
+    std::printf("%u tags per speed, seed %u, noise %.0f, %.0f mm spot, speed error up to %.0f%%, %.1f ms per sample, %s thresholds\n",
+                config.tags, config.seed, config.noise, config.spot_mm, 100.0 * config.speed_error, PERIOD_US * 1e-3,
+                (config.classifier == &Floor_Tag_Classifier_Params) ? "floor tag" : "Simon");
+    std::printf("Speed mm/s  mm/sample  Samples/patch   Correct    Errors     Wrong    Missed  Glitches/tag\n");
+
+    const double SPEEDS[] = { 50, 100, 150, 200, 300, 400, 600, 800, 1000 };
+
+    for (double speed : SPEEDS)
+    {
+        Speed_Result result = Run_Speed(speed, config);
+        double total = config.tags;
+        double step_mm = speed * PERIOD_US * 1e-6;
+
+        std::printf("%10.0f %10.2f %14.1f %8.2f%% %8.2f%% %8.2f%% %8.2f%% %13.2f\n", speed, step_mm, PATCH_MM / step_mm,
+                    100.0 * result.correct / total, 100.0 * result.errors / total, 100.0 * result.wrong / total,
+                    100.0 * result.missed / total, result.glitches / total);
+    }
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+/**
+ * @file i2c_bus_linux_check.cpp
+ * @brief Checks the I2C_Bus_Linux backend with an injected ioctl function.
+ *
+ * The backend is attached with an ioctl function that records each request and answers I2C_RDWR from
+ * an I2C_Bus_Sim bus with a TCA9548A and two TCS34725s, or fails a chosen request with a chosen errno:
+ *   - Setup: the I2C_TIMEOUT argument in units of 10 ms and I2C_RETRIES 0. A failure of either ioctl
+ *     returns I2C_BUS_ERROR_IO and leaves the bus uninitialized. I2C_Bus_Linux_Open of /dev/null, whose
+ *     ioctls fail with ENOTTY, and of a missing path, returns I2C_BUS_ERROR_IO with the adapter closed.
+ *   - Transfers: the PMOD_Color driver runs on the backend. Each transfer is one I2C_RDWR with the same
+ *     messages, and each sensor returns its own data.
+ *   - Message limit: 42 messages are one ioctl, 43 and more are rejected with I2C_BUS_ERROR_INVALID
+ *     without an ioctl.
+ *   - Errors: the errno of a failed I2C_RDWR maps to I2C_BUS_ERROR_NACK, _TIMEOUT or _IO.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus_Linux.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus_Sim.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/PMOD_Color.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR i2c_bus_linux_check.cpp I2C_Bus.o I2C_Bus_Linux.o I2C_Bus_Sim.o PMOD_Color.o -o i2c_bus_linux_check
+ *
+ * Usage: i2c_bus_linux_check
+ *
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "inc/I2C_Bus.h"
+#include "inc/I2C_Bus_Linux.h"
+#include "inc/I2C_Bus_Sim.h"
+#include "inc/PMOD_Color.h"
+
+namespace
+{
+
+constexpr int CHECK_FD = 1000;
+
+// An ioctl as the backend issued it
+struct Request
+{
+    unsigned long request;
+    unsigned long value;
+    uint32_t message_count;
+};
+
+struct Check_State
+{
+    I2C_Bus sim_bus;
+    I2C_Bus_Sim_Context sim;
+
+    // Request that fails, with its errno, or 0
+    unsigned long fail_request = 0;
+    int fail_errno = 0;
+
+    std::vector<Request> requests;
+};
+
+Check_State check;
+uint64_t failures = 0;
+
+int Check_Ioctl(int fd, unsigned long request, void *argument)
+{
+    Request record = { request, 0, 0 };
+
+    if (request == I2C_RDWR)
+    {
+        record.message_count = ((i2c_rdwr_ioctl_data *)argument)->nmsgs;
+    }
+    else
+    {
+        record.value = (unsigned long)argument;
+    }
+
+    check.requests.push_back(record);
+
+    if (fd != CHECK_FD)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (request == check.fail_request)
+    {
+        errno = check.fail_errno;
+        return -1;
+    }
+
+    if (request != I2C_RDWR) return 0;
+
+    // Answer the transaction from the simulated bus
+    i2c_rdwr_ioctl_data *transfer = (i2c_rdwr_ioctl_data *)argument;
+    std::vector<I2C_Bus_Message> messages(transfer->nmsgs);
+
+    for (uint32_t i = 0; i < transfer->nmsgs; i++)
+    {
+        messages[i].address = (uint8_t)transfer->msgs[i].addr;
+        messages[i].flags = (transfer->msgs[i].flags & I2C_M_RD) ? I2C_BUS_MSG_READ : I2C_BUS_MSG_WRITE;
+        messages[i].length = transfer->msgs[i].len;
+        messages[i].buffer = transfer->msgs[i].buf;
+    }
+
+    switch (check.sim_bus.ops->transfer(&check.sim_bus, messages.data(), transfer->nmsgs))
+    {
+        case I2C_BUS_OK: return (int)transfer->nmsgs;
+        case I2C_BUS_ERROR_NACK: errno = ENXIO; return -1;
+        case I2C_BUS_ERROR_TIMEOUT: errno = ETIMEDOUT; return -1;
+        default: errno = EIO; return -1;
+    }
+}
+
+void Reset(unsigned long fail_request, int fail_errno)
+{
+    I2C_Bus_Sim_Init(&check.sim_bus, &check.sim);
+    I2C_Bus_Sim_Add_TCA9548A(&check.sim, TCA9548A_ADDRESS);
+
+    for (uint8_t channel = 0; channel < 2; channel++)
+    {
+        I2C_Bus_Sim_Device *device = I2C_Bus_Sim_Add_TCS34725(&check.sim, PMOD_COLOR_ADDRESS, channel, 1);
+        I2C_Bus_Sim_Set_RGBC(device, 100 + channel, 200 + channel, 300 + channel, 400 + channel);
+    }
+
+    check.fail_request = fail_request;
+    check.fail_errno = fail_errno;
+    check.requests.clear();
+}
+
+void Expect(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        if (failures < 10) std::fprintf(stderr, "failed: %s\n", what);
+        failures++;
+    }
+}
+
+void Check_Setup()
+{
+    uint64_t before = failures;
+    I2C_Bus bus;
+    I2C_Bus_Linux_Context context;
+
+    const uint32_t timeouts[][2] = { { 0, 0 }, { 1, 1 }, { 10000, 1 }, { 10001, 2 }, { 25000, 3 } };
+
+    for (const auto &timeout : timeouts)
+    {
+        Reset(0, 0);
+
+        Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, timeout[0], Check_Ioctl) == I2C_BUS_OK, "attach");
+        Expect(check.requests.size() == 2, "attach issues two ioctls");
+
+        if (check.requests.size() == 2)
+        {
+            Expect((check.requests[0].request == I2C_TIMEOUT) && (check.requests[0].value == timeout[1]),
+                   "I2C_TIMEOUT in units of 10 ms, rounded up");
+            Expect((check.requests[1].request == I2C_RETRIES) && (check.requests[1].value == 0), "I2C_RETRIES 0");
+        }
+    }
+
+    // A failure of either ioctl is returned, and the bus is left alone
+    const unsigned long setup_requests[] = { I2C_TIMEOUT, I2C_RETRIES };
+
+    for (unsigned long request : setup_requests)
+    {
+        Reset(request, EINVAL);
+        bus.ops = 0;
+
+        Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, 10000, Check_Ioctl) == I2C_BUS_ERROR_IO,
+               "a failed setup ioctl is returned");
+        Expect(bus.ops == 0, "a failed attach leaves the bus uninitialized");
+        Expect(check.requests.back().request == request, "attach stops at the failed ioctl");
+    }
+
+    // The system ioctl on a file that is not an adapter
+    Expect(I2C_Bus_Linux_Open(&bus, &context, "/dev/null", 10000) == I2C_BUS_ERROR_IO, "open of /dev/null fails");
+    Expect(context.fd == -1, "a failed open closes the file");
+    Expect(I2C_Bus_Linux_Open(&bus, &context, "/dev/i2c-missing", 10000) == I2C_BUS_ERROR_IO, "open of a missing adapter fails");
+    Expect(context.fd == -1, "a missing adapter is not open");
+
+    std::printf("Setup: timeout rounding, failed I2C_TIMEOUT and I2C_RETRIES, /dev/null: %s\n",
+                (failures == before) ? "passed" : "FAILED");
+}
+
+void Check_Transfers()
+{
+    uint64_t before = failures;
+    I2C_Bus bus;
+    I2C_Bus_Linux_Context context;
+    uint32_t ioctl_count = 0;
+
+    Reset(0, 0);
+    Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, 10000, Check_Ioctl) == I2C_BUS_OK, "attach");
+
+    PMOD_Color_Sensor sensors[2] =
+    {
+        { &bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 0 },
+        { &bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 1 },
+    };
+
+    for (int round = 0; round < 100; round++)
+    {
+        for (uint8_t s = 0; s < 2; s++)
+        {
+            PMOD_Color_Data data = {};
+            size_t first = check.requests.size();
+            uint32_t sim_transfers = check.sim.transfer_count;
+            uint32_t sim_messages = check.sim.message_count;
+
+            if (round == 0) Expect(PMOD_Color_Sensor_Init(&sensors[s]) == I2C_BUS_OK, "init through the backend");
+
+            Expect(PMOD_Color_Sensor_Get_RGBC(&sensors[s], &data) == I2C_BUS_OK, "read through the backend");
+            Expect((data.clear == 100 + s) && (data.red == 200 + s) && (data.green == 300 + s) && (data.blue == 400 + s),
+                   "each sensor returns its own data");
+
+            // One I2C_RDWR per transfer, with all of its messages
+            uint32_t messages = 0;
+
+            for (size_t r = first; r < check.requests.size(); r++)
+            {
+                Expect(check.requests[r].request == I2C_RDWR, "transfers use I2C_RDWR");
+                messages += check.requests[r].message_count;
+            }
+
+            Expect(check.requests.size() - first == check.sim.transfer_count - sim_transfers, "one ioctl per transfer");
+            Expect(messages == check.sim.message_count - sim_messages, "the messages of each transfer");
+
+            ioctl_count += (uint32_t)(check.requests.size() - first);
+        }
+    }
+
+    Expect(check.sim.collision_count == 0, "no collision");
+
+    std::printf("Transfers: PMOD_Color on 2 sensors, %u ioctls: %s\n", ioctl_count, (failures == before) ? "passed" : "FAILED");
+}
+
+void Check_Message_Limit()
+{
+    uint64_t before = failures;
+    I2C_Bus bus;
+    I2C_Bus_Linux_Context context;
+
+    // Writes of the control byte of the multiplexer
+    uint8_t control[100] = {};
+    I2C_Bus_Message messages[100];
+
+    for (int i = 0; i < 100; i++)
+    {
+        messages[i] = { TCA9548A_ADDRESS, I2C_BUS_MSG_WRITE, 1, &control[i] };
+    }
+
+    Reset(0, 0);
+    Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, 10000, Check_Ioctl) == I2C_BUS_OK, "attach");
+
+    const uint32_t counts[] = { 1, 41, 42, 43, 84, 100 };
+
+    for (uint32_t count : counts)
+    {
+        check.requests.clear();
+
+        int status = I2C_Bus_Transfer(&bus, messages, count);
+
+        if (count <= 42)
+        {
+            Expect(status == I2C_BUS_OK, "a transfer within the limit");
+            Expect((check.requests.size() == 1) && (check.requests[0].message_count == count), "is one ioctl");
+        }
+        else
+        {
+            Expect(status == I2C_BUS_ERROR_INVALID, "a transfer over the limit is rejected");
+            Expect(check.requests.empty(), "without an ioctl");
+        }
+    }
+
+    std::printf("Message limit: 1 to 42 messages in one ioctl, 43 to 100 rejected: %s\n",
+                (failures == before) ? "passed" : "FAILED");
+}
+
+void Check_Errors()
+{
+    uint64_t before = failures;
+    I2C_Bus bus;
+    I2C_Bus_Linux_Context context;
+    const uint8_t id_register = PMOD_COLOR_AUTO_INC | PMOD_COLOR_DEVICE_ID_REG;
+    uint8_t id = 0;
+
+    const int errors[][2] =
+    {
+        { ENXIO, I2C_BUS_ERROR_NACK }, { EREMOTEIO, I2C_BUS_ERROR_NACK }, { ETIMEDOUT, I2C_BUS_ERROR_TIMEOUT },
+        { EIO, I2C_BUS_ERROR_IO }, { EBUSY, I2C_BUS_ERROR_IO }, { EAGAIN, I2C_BUS_ERROR_IO },
+    };
+
+    for (const auto &error : errors)
+    {
+        Reset(0, 0);
+        Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, 10000, Check_Ioctl) == I2C_BUS_OK, "attach");
+
+        check.fail_request = I2C_RDWR;
+        check.fail_errno = error[0];
+
+        Expect(I2C_Bus_Write_Read(&bus, PMOD_COLOR_ADDRESS, &id_register, 1, &id, 1) == error[1], "errno maps to the status");
+    }
+
+    // A sensor that does not answer on the simulated bus
+    Reset(0, 0);
+    Expect(I2C_Bus_Linux_Attach(&bus, &context, CHECK_FD, 10000, Check_Ioctl) == I2C_BUS_OK, "attach");
+
+    PMOD_Color_Sensor missing = { &bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 5 };
+    Expect(PMOD_Color_Sensor_Init(&missing) == I2C_BUS_ERROR_NACK, "a missing sensor is a NACK");
+
+    std::printf("Errors: ENXIO, EREMOTEIO, ETIMEDOUT, EIO, EBUSY, EAGAIN and a missing sensor: %s\n",
+                (failures == before) ? "passed" : "FAILED");
+}
+
+} // namespace
+
+int main()
+{
+    Check_Setup();
+    Check_Transfers();
+    Check_Message_Limit();
+    Check_Errors();
+
+    std::printf("I2C_Bus_Linux: %s\n", failures ? "FAILED" : "passed");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,891 @@
+/**
+ * @file i2c_trace.cpp
+ * @brief Reports the I2C transfers that a board traced (see I2C_Trace.h), with timelines.
+ *
+ * The serial output of a board built with I2C_BUS_TRACE set to 1 is read from a port, or from a file
+ * that holds a recording of it, and decoded with Board_Decoder; the text lines are ignored. The
+ * program prints:
+ *   - Totals: the transfers, bytes and errors by status, and the transfers that the board dropped
+ *     because its buffer was full or that were lost on the link.
+ *   - Utilization: the share of the time that the bus was busy, over the whole trace and in windows
+ *     of --window ms (mean, 90th percentile and busiest window).
+ *   - Durations: a histogram of the transfer durations with the percentiles.
+ *   - Operations: for each device address and kind of transfer (write, read, or write then read),
+ *     the transfers, bytes, mean and longest duration, share of the bus time and errors.
+ *   - Timeline: one row per operation over --span ms from --from, one column per time bin: '.' idle,
+ *     '-', '=' and '#' for a bin busy up to a quarter, a half or more, 'X' for a bin with an error.
+ * --svg draws the same timeline with one bar per transfer, and --csv writes every transfer.
+ *
+ * --check runs the firmware's I2C_Trace with the PMOD_Color driver on a simulated bus with two sensors
+ * behind a TCA9548A, probes of an absent device and a clock that wraps. Every transfer that the
+ * decoder returns must match the transfer on the bus, every drop must be reported, and the statistics
+ * of the board must match the transfers. It also measures the time that tracing adds to a transfer.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -DI2C_BUS_TRACE=1 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Trace.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus_Sim.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/PMOD_Color.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c
+ *   g++ -std=c++17 -O2 -DI2C_BUS_TRACE=1 -I../ECE528L_PMOD_COLOR/PMOD_COLOR i2c_trace.cpp Board_Decoder.cpp I2C_Trace.o I2C_Bus.o I2C_Bus_Sim.o PMOD_Color.o Board_Protocol.o -o i2c_trace
+ *
+ * Usage: i2c_trace [options] INPUT
+ *   INPUT                    Serial port of the board, or a file with its recorded output
+ *   --baud RATE              Baud rate of a serial port (default: 115200)
+ *   --seconds S              Stop reading a serial port after S seconds (default: until SIGINT)
+ *   --save FILE              Also write the bytes read from the port to FILE, for later runs
+ *   --window MS              Utilization window (default: 100)
+ *   --from MS                Start of the timeline after the first transfer (default: 0)
+ *   --span MS                Length of the timeline (default: 100)
+ *   --columns N              Columns of the text timeline (default: 100)
+ *   --svg FILE               Write the timeline as SVG
+ *   --csv FILE               Write every transfer
+ *
+ *        i2c_trace --check
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Board_Decoder.h"
+#include "inc/I2C_Bus.h"
+#include "inc/I2C_Bus_Sim.h"
+#include "inc/I2C_Trace.h"
+#include "inc/PMOD_Color.h"
+
+#if !I2C_BUS_TRACE
+#error "Build i2c_trace and the firmware modules with -DI2C_BUS_TRACE=1"
+#endif
+
+namespace
+{
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void Handle_Signal(int)
+{
+    stop_requested = 1;
+}
+
+// A decoded transfer, with its start extended to 64 bits
+struct Transfer
+{
+    uint64_t start_us;
+    uint32_t duration_us;
+    uint8_t address;
+    uint8_t write_length;
+    uint8_t read_length;
+    int8_t status;
+};
+
+uint8_t Kind(const Transfer &transfer)
+{
+    uint8_t kind = (transfer.read_length > 0) ? I2C_TRACE_KIND_READ : 0;
+
+    if ((transfer.write_length > 0) || (kind == 0)) kind |= I2C_TRACE_KIND_WRITE;
+    return kind;
+}
+
+const char *Kind_Name(uint8_t kind)
+{
+    switch (kind)
+    {
+        case I2C_TRACE_KIND_WRITE:      return "write";
+        case I2C_TRACE_KIND_READ:       return "read";
+        case I2C_TRACE_KIND_WRITE_READ: return "write-read";
+        default:                        return "?";
+    }
+}
+
+const char *Status_Name(int status)
+{
+    switch (status)
+    {
+        case I2C_BUS_OK:            return "ok";
+        case I2C_BUS_ERROR_NACK:    return "nack";
+        case I2C_BUS_ERROR_TIMEOUT: return "timeout";
+        case I2C_BUS_ERROR_IO:      return "io";
+        case I2C_BUS_ERROR_INVALID: return "invalid";
+        default:                    return "other";
+    }
+}
+
+std::string Operation_Name(uint16_t key)
+{
+    char name[32];
+
+    std::snprintf(name, sizeof(name), "0x%02X %s", key >> 8, Kind_Name((uint8_t)key));
+    return name;
+}
+
+uint16_t Operation_Key(const Transfer &transfer)
+{
+    return (uint16_t)((transfer.address << 8) | Kind(transfer));
+}
+
+// Transfers of a trace, in the order of the frames
+struct Trace
+{
+    std::vector<Transfer> transfers;
+    uint64_t dropped = 0;
+    uint64_t frames = 0;
+    uint64_t high = 0;
+    uint32_t last_start = 0;
+
+    void Add(const Board_Protocol_I2C_Trace &frame)
+    {
+        frames++;
+        dropped += frame.dropped;
+
+        for (uint8_t i = 0; i < frame.count; i++)
+        {
+            const Board_Protocol_I2C_Transfer &in = frame.transfers[i];
+
+            // The start wraps after 2^32 us; the transfers come in order
+            if (!transfers.empty() && (in.start_us < last_start)) high += 1ull << 32;
+            last_start = in.start_us;
+
+            transfers.push_back({ high + in.start_us, in.duration_us, in.address, in.write_length, in.read_length, in.status });
+        }
+    }
+};
+
+double Percentile(std::vector<uint32_t> values, double share)
+{
+    if (values.empty()) return 0.0;
+
+    size_t index = std::min(values.size() - 1, (size_t)(share * (values.size() - 1) + 0.5));
+
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// Time of each window covered by transfers, which may straddle two windows
+std::vector<uint64_t> Window_Busy(const Trace &trace, uint64_t first_us, uint64_t window_us)
+{
+    std::vector<uint64_t> busy;
+
+    for (const Transfer &transfer : trace.transfers)
+    {
+        uint64_t start = transfer.start_us - first_us;
+        uint64_t end = start + transfer.duration_us;
+
+        while (start < end)
+        {
+            size_t window = (size_t)(start / window_us);
+            uint64_t window_end = (window + 1) * window_us;
+            uint64_t part = std::min(end, window_end) - start;
+
+            if (busy.size() <= window) busy.resize(window + 1, 0);
+            busy[window] += part;
+            start += part;
+        }
+    }
+
+    return busy;
+}
+
+void Print_Report(const Trace &trace, const Board_Decoder_Counters &counters, uint64_t window_us)
+{
+    if (trace.transfers.empty())
+    {
+        std::printf("No I2C_TRACE frames: build the firmware with I2C_BUS_TRACE set to 1\n");
+        return;
+    }
+
+    uint64_t bytes = 0;
+    uint64_t busy_us = 0;
+    std::map<int, uint64_t> statuses;
+    std::vector<uint32_t> durations;
+
+    for (const Transfer &transfer : trace.transfers)
+    {
+        bytes += (uint64_t)transfer.write_length + transfer.read_length;
+        busy_us += transfer.duration_us;
+        statuses[transfer.status]++;
+        durations.push_back(transfer.duration_us);
+    }
+
+    const Transfer &first = trace.transfers.front();
+    const Transfer &last = trace.transfers.back();
+    uint64_t span_us = std::max<uint64_t>(1, last.start_us + last.duration_us - first.start_us);
+    uint64_t errors = trace.transfers.size() - statuses[I2C_BUS_OK];
+
+    std::printf("Transfers: %zu in %llu frames over %.3f s, %llu bytes, %llu dropped by the board, %llu frames lost\n",
+                trace.transfers.size(), (unsigned long long)trace.frames, span_us / 1e6, (unsigned long long)bytes,
+                (unsigned long long)trace.dropped, (unsigned long long)counters.lost_frames);
+    std::printf("Errors: %llu (%.3f%%)", (unsigned long long)errors, 100.0 * errors / trace.transfers.size());
+
+    for (const auto &status : statuses)
+    {
+        if (status.first != I2C_BUS_OK) std::printf(", %llu %s", (unsigned long long)status.second, Status_Name(status.first));
+    }
+
+    std::printf("\n");
+
+    // Utilization over the windows that the trace covers
+    std::vector<uint64_t> busy = Window_Busy(trace, first.start_us, window_us);
+    std::vector<uint32_t> shares;
+    size_t busiest = 0;
+
+    for (size_t i = 0; i < busy.size(); i++)
+    {
+        shares.push_back((uint32_t)(busy[i] * 10000 / window_us));
+        if (busy[i] > busy[busiest]) busiest = i;
+    }
+
+    std::printf("Utilization: %.2f%% overall; %llu ms windows: mean %.2f%%, p90 %.2f%%, max %.2f%% at %.3f s\n",
+                100.0 * busy_us / span_us, (unsigned long long)(window_us / 1000),
+                100.0 * busy_us / ((double)busy.size() * window_us), Percentile(shares, 0.9) / 100.0,
+                busy[busiest] * 100.0 / window_us, busiest * window_us / 1e6);
+
+    // Durations in the buckets of the board
+    uint64_t buckets[I2C_TRACE_BUCKETS] = {};
+
+    for (uint32_t duration : durations)
+    {
+        int bucket = 0;
+
+        while ((bucket < (I2C_TRACE_BUCKETS - 1)) && (duration >= ((uint32_t)I2C_TRACE_BUCKET_MIN_US << bucket))) bucket++;
+        buckets[bucket]++;
+    }
+
+    std::printf("Durations: p50 %.0f us, p90 %.0f us, p99 %.0f us, max %.0f us\n", Percentile(durations, 0.5),
+                Percentile(durations, 0.9), Percentile(durations, 0.99), Percentile(durations, 1.0));
+
+    for (int i = 0; i < I2C_TRACE_BUCKETS; i++)
+    {
+        if (buckets[i] == 0) continue;
+
+        int bar = (int)(50.0 * buckets[i] / trace.transfers.size() + 0.5);
+        char label[32];
+
+        if (i < (I2C_TRACE_BUCKETS - 1)) std::snprintf(label, sizeof(label), "< %u us", (unsigned)I2C_TRACE_BUCKET_MIN_US << i);
+        else std::snprintf(label, sizeof(label), ">= %u us", (unsigned)I2C_TRACE_BUCKET_MIN_US << (i - 1));
+
+        std::printf("  %-11s %8llu  %s\n", label, (unsigned long long)buckets[i], std::string((size_t)bar, '#').c_str());
+    }
+
+    // Operations, the busiest first
+    struct Operation
+    {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+        uint64_t busy_us = 0;
+        uint32_t max_us = 0;
+        uint64_t errors = 0;
+    };
+
+    std::map<uint16_t, Operation> operations;
+
+    for (const Transfer &transfer : trace.transfers)
+    {
+        Operation &operation = operations[Operation_Key(transfer)];
+
+        operation.count++;
+        operation.bytes += (uint64_t)transfer.write_length + transfer.read_length;
+        operation.busy_us += transfer.duration_us;
+        operation.max_us = std::max(operation.max_us, transfer.duration_us);
+        if (transfer.status != I2C_BUS_OK) operation.errors++;
+    }
+
+    std::vector<std::pair<uint16_t, Operation>> sorted(operations.begin(), operations.end());
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.second.busy_us > b.second.busy_us; });
+
+    std::printf("\nOperation          Transfers       Bytes   Mean us    Max us  Bus time  Utilization    Errors\n");
+
+    for (const auto &entry : sorted)
+    {
+        const Operation &operation = entry.second;
+
+        std::printf("%-16s %11llu %11llu %9.1f %9u %8.1f%% %11.2f%% %9llu\n", Operation_Name(entry.first).c_str(),
+                    (unsigned long long)operation.count, (unsigned long long)operation.bytes,
+                    (double)operation.busy_us / operation.count, operation.max_us,
+                    100.0 * operation.busy_us / std::max<uint64_t>(1, busy_us), 100.0 * operation.busy_us / span_us,
+                    (unsigned long long)operation.errors);
+    }
+}
+
+// Operations that have a transfer in the span, in the order of their first transfer
+std::vector<uint16_t> Lanes(const Trace &trace, uint64_t from_us, uint64_t to_us)
+{
+    std::vector<uint16_t> lanes;
+
+    for (const Transfer &transfer : trace.transfers)
+    {
+        if ((transfer.start_us + transfer.duration_us < from_us) || (transfer.start_us >= to_us)) continue;
+
+        uint16_t key = Operation_Key(transfer);
+        if (std::find(lanes.begin(), lanes.end(), key) == lanes.end()) lanes.push_back(key);
+    }
+
+    return lanes;
+}
+
+void Print_Timeline(const Trace &trace, uint64_t from_ms, uint64_t span_ms, int columns)
+{
+    if (trace.transfers.empty()) return;
+
+    uint64_t from_us = trace.transfers.front().start_us + from_ms * 1000;
+    uint64_t span_us = std::max<uint64_t>(1, span_ms * 1000);
+    uint64_t to_us = from_us + span_us;
+    double bin_us = (double)span_us / columns;
+    std::vector<uint16_t> lanes = Lanes(trace, from_us, to_us);
+
+    std::printf("\nTimeline from %.3f ms for %.3f ms, %.3f ms per column ('.' idle, '-' '=' '#' busy up to 25%%, 50%% or more, 'X' error)\n",
+                from_ms * 1.0, span_ms * 1.0, bin_us / 1000.0);
+
+    for (int lane = -1; lane < (int)lanes.size(); lane++)
+    {
+        std::vector<double> busy((size_t)columns, 0.0);
+        std::vector<bool> error((size_t)columns, false);
+
+        for (const Transfer &transfer : trace.transfers)
+        {
+            if ((lane >= 0) && (Operation_Key(transfer) != lanes[(size_t)lane])) continue;
+
+            double start = std::max<double>(0.0, (double)transfer.start_us - (double)from_us);
+            double end = std::min<double>((double)span_us, (double)transfer.start_us + transfer.duration_us - (double)from_us);
+
+            if ((transfer.start_us >= to_us) || (end < 0.0)) continue;
+
+            // A transfer shorter than a microsecond still marks its bin
+            end = std::max(end, start + 0.001);
+
+            for (int column = (int)(start / bin_us); (column < columns) && (column * bin_us < end); column++)
+            {
+                double bin_start = column * bin_us;
+
+                busy[(size_t)column] += std::min(end, bin_start + bin_us) - std::max(start, bin_start);
+                if (transfer.status != I2C_BUS_OK) error[(size_t)column] = true;
+            }
+        }
+
+        std::string row;
+
+        for (int column = 0; column < columns; column++)
+        {
+            double share = busy[(size_t)column] / bin_us;
+
+            if (error[(size_t)column]) row += 'X';
+            else if (share <= 0.0) row += '.';
+            else if (share < 0.25) row += '-';
+            else if (share < 0.5) row += '=';
+            else row += '#';
+        }
+
+        std::printf("%-16s |%s|\n", (lane < 0) ? "all" : Operation_Name(lanes[(size_t)lane]).c_str(), row.c_str());
+    }
+}
+
+bool Write_SVG(const char *path, const Trace &trace, uint64_t from_ms, uint64_t span_ms)
+{
+    constexpr int WIDTH = 1200;
+    constexpr int LABEL = 140;
+    constexpr int LANE = 26;
+    constexpr int TOP = 40;
+
+    FILE *file = std::fopen(path, "w");
+
+    if (file == nullptr)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    uint64_t from_us = trace.transfers.empty() ? 0 : trace.transfers.front().start_us + from_ms * 1000;
+    uint64_t span_us = std::max<uint64_t>(1, span_ms * 1000);
+    std::vector<uint16_t> lanes = Lanes(trace, from_us, from_us + span_us);
+    double scale = (double)(WIDTH - LABEL - 20) / span_us;
+    int height = TOP + (int)lanes.size() * LANE + 30;
+
+    std::fprintf(file, "<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    std::fprintf(file, "<svg version=\"1.1\" width=\"%d\" height=\"%d\" xmlns=\"http://www.w3.org/2000/svg\" font-family=\"Verdana\" font-size=\"12\">\n",
+                 WIDTH, height);
+    std::fprintf(file, "<rect x=\"0\" y=\"0\" width=\"%d\" height=\"%d\" fill=\"#ffffff\"/>\n", WIDTH, height);
+    std::fprintf(file, "<text x=\"%d\" y=\"20\" font-size=\"16\">I2C transfers from %.3f ms for %.3f ms</text>\n",
+                 LABEL, from_ms * 1.0, span_ms * 1.0);
+
+    // Time axis with 10 divisions
+    for (int i = 0; i <= 10; i++)
+    {
+        double x = LABEL + i * (WIDTH - LABEL - 20) / 10.0;
+
+        std::fprintf(file, "<line x1=\"%.1f\" y1=\"%d\" x2=\"%.1f\" y2=\"%d\" stroke=\"#dddddd\"/>\n", x, TOP - 5, x, height - 25);
+        std::fprintf(file, "<text x=\"%.1f\" y=\"%d\" text-anchor=\"middle\">%.3f</text>\n", x, height - 10,
+                     (from_ms * 1000.0 + span_us * i / 10.0) / 1000.0);
+    }
+
+    for (size_t lane = 0; lane < lanes.size(); lane++)
+    {
+        int y = TOP + (int)lane * LANE;
+
+        std::fprintf(file, "<text x=\"5\" y=\"%d\">%s</text>\n", y + 16, Operation_Name(lanes[lane]).c_str());
+
+        for (const Transfer &transfer : trace.transfers)
+        {
+            if ((Operation_Key(transfer) != lanes[lane]) || (transfer.start_us + transfer.duration_us < from_us) ||
+                (transfer.start_us >= from_us + span_us)) continue;
+
+            double start = std::max<double>(0.0, (double)transfer.start_us - (double)from_us);
+            double end = std::min<double>((double)span_us, (double)(transfer.start_us + transfer.duration_us - from_us));
+            double width = std::max(1.0, (end - start) * scale);
+
+            std::fprintf(file, "<rect x=\"%.2f\" y=\"%d\" width=\"%.2f\" height=\"%d\" fill=\"%s\"><title>%.3f ms: %u us, %u written, %u read, %s</title></rect>\n",
+                         LABEL + start * scale, y + 3, width, LANE - 6, (transfer.status == I2C_BUS_OK) ? "#4682b4" : "#d62728",
+                         (transfer.start_us - trace.transfers.front().start_us) / 1000.0, transfer.duration_us,
+                         transfer.write_length, transfer.read_length, Status_Name(transfer.status));
+        }
+    }
+
+    std::fprintf(file, "</svg>\n");
+    return std::fclose(file) == 0;
+}
+
+bool Write_CSV(const char *path, const Trace &trace)
+{
+    FILE *file = std::fopen(path, "w");
+
+    if (file == nullptr)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    std::fprintf(file, "start_us,duration_us,address,write_length,read_length,status\n");
+
+    for (const Transfer &transfer : trace.transfers)
+    {
+        std::fprintf(file, "%llu,%u,0x%02X,%u,%u,%s\n", (unsigned long long)transfer.start_us, transfer.duration_us,
+                     transfer.address, transfer.write_length, transfer.read_length, Status_Name(transfer.status));
+    }
+
+    return std::fclose(file) == 0;
+}
+
+speed_t Baud_Constant(long baud)
+{
+    switch (baud)
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return B0;
+    }
+}
+
+// Reads a recording, or a serial port until the time is up or SIGINT, and decodes the transfers
+bool Read_Input(const char *path, long baud, double seconds, const char *save_path, Board_Decoder &decoder, Trace &trace)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    bool port = isatty(fd);
+
+    if (port)
+    {
+        struct termios settings;
+
+        if (tcgetattr(fd, &settings) == 0)
+        {
+            cfmakeraw(&settings);
+            cfsetispeed(&settings, Baud_Constant(baud));
+            cfsetospeed(&settings, Baud_Constant(baud));
+            settings.c_cflag |= CLOCAL | CREAD;
+            tcsetattr(fd, TCSANOW, &settings);
+        }
+
+        std::signal(SIGINT, Handle_Signal);
+        std::fprintf(stderr, "Reading %s, Ctrl-C to stop\n", path);
+    }
+
+    FILE *save = save_path ? std::fopen(save_path, "wb") : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    uint8_t buffer[4096];
+
+    while (!stop_requested)
+    {
+        if (port)
+        {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if ((seconds > 0.0) && (elapsed >= seconds)) break;
+
+            fd_set read_set;
+            struct timeval timeout = { 0, 100000 };
+
+            FD_ZERO(&read_set);
+            FD_SET(fd, &read_set);
+
+            if (select(fd + 1, &read_set, nullptr, nullptr, &timeout) <= 0) continue;
+        }
+
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        if (save) std::fwrite(buffer, 1, (size_t)length, save);
+
+        decoder.Decode(buffer, (size_t)length, 0, [&](const Board_Event &event)
+        {
+            if (event.type == Board_Event_Type::I2C_Trace) trace.Add(event.i2c_trace);
+            return true;
+        });
+    }
+
+    if (save) std::fclose(save);
+    close(fd);
+    return true;
+}
+
+// Check: a 48 MHz clock that advances with the program and with the bytes on a 400 kHz bus
+constexpr uint32_t CHECK_TICKS_PER_US = 48;
+constexpr uint64_t CHECK_TICKS_PER_BIT = 120;
+
+struct Check_Bus
+{
+    I2C_Bus bus;
+    I2C_Bus_Sim_Context sim;
+    const I2C_Bus_Ops *sim_ops;
+    I2C_Bus_Ops ops;
+
+    // Time of the program in ticks since the trace started, and the clock at that time
+    uint64_t program_ticks = 0;
+    uint32_t clock_start = 0;
+
+    // Transfers seen on the bus, as the trace must record them
+    std::vector<Transfer> expected;
+    std::vector<uint64_t> expected_ticks;
+};
+
+Check_Bus *check_bus = nullptr;
+
+uint64_t Bus_Ticks(const I2C_Bus_Sim_Context &sim)
+{
+    // Each message sends an address byte, and each byte takes 9 bits with its acknowledge
+    return ((uint64_t)sim.message_count + sim.byte_count) * 9 * CHECK_TICKS_PER_BIT;
+}
+
+uint32_t Check_Clock(void *context)
+{
+    Check_Bus *check = (Check_Bus *)context;
+
+    return (uint32_t)(check->clock_start + check->program_ticks + Bus_Ticks(check->sim));
+}
+
+int Check_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    Check_Bus *check = check_bus;
+    uint64_t start = check->program_ticks + Bus_Ticks(check->sim);
+    int status = check->sim_ops->transfer(bus, messages, message_count);
+    uint64_t ticks = check->program_ticks + Bus_Ticks(check->sim) - start;
+    uint32_t write_length = 0;
+    uint32_t read_length = 0;
+
+    for (uint32_t i = 0; i < message_count; i++)
+    {
+        if (messages[i].flags & I2C_BUS_MSG_READ) read_length += messages[i].length;
+        else write_length += messages[i].length;
+    }
+
+    check->expected.push_back({ start / CHECK_TICKS_PER_US, (uint32_t)(ticks / CHECK_TICKS_PER_US), messages[0].address,
+                                (uint8_t)std::min<uint32_t>(write_length, 255), (uint8_t)std::min<uint32_t>(read_length, 255),
+                                (int8_t)status });
+    check->expected_ticks.push_back(ticks);
+    return status;
+}
+
+void Check_Write(void *context, const uint8_t *frame, uint16_t length)
+{
+    std::vector<uint8_t> &stream = *(std::vector<uint8_t> *)context;
+    stream.insert(stream.end(), frame, frame + length);
+}
+
+int Check_Trace()
+{
+    static Check_Bus check;
+    static I2C_Trace trace;
+    std::vector<uint8_t> stream;
+    std::mt19937 random(528);
+    char line[64];
+
+    check_bus = &check;
+    I2C_Bus_Sim_Init(&check.bus, &check.sim);
+    I2C_Bus_Sim_Add_TCA9548A(&check.sim, TCA9548A_ADDRESS);
+
+    // Route the transfers through the check, which records them as they reach the simulated bus
+    check.sim_ops = check.bus.ops;
+    check.ops.transfer = Check_Transfer;
+    check.bus.ops = &check.ops;
+
+    PMOD_Color_Sensor sensors[2] =
+    {
+        { &check.bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 0 },
+        { &check.bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 1 },
+    };
+
+    I2C_Bus_Sim_Set_RGBC(I2C_Bus_Sim_Add_TCS34725(&check.sim, PMOD_COLOR_ADDRESS, 0, 1), 100, 40, 30, 20);
+    I2C_Bus_Sim_Set_RGBC(I2C_Bus_Sim_Add_TCS34725(&check.sim, PMOD_COLOR_ADDRESS, 1, 1), 200, 80, 60, 40);
+
+    // The clock wraps after 2 seconds of the trace, and then every 89 s
+    check.clock_start = 0xFFFFFFFFu - 2 * 48000000u;
+    I2C_Trace_Init(&trace, Check_Clock, &check, CHECK_TICKS_PER_US, Check_Write, &stream);
+    I2C_Trace_Attach(&trace, &check.bus);
+
+    for (int round = 0; round < 20000; round++)
+    {
+        for (PMOD_Color_Sensor &sensor : sensors)
+        {
+            PMOD_Color_Data data;
+
+            if ((round == 0) && (PMOD_Color_Sensor_Init(&sensor) != I2C_BUS_OK)) return 1;
+            PMOD_Color_Sensor_Get_RGBC(&sensor, &data);
+        }
+
+        // A probe of an absent device now and then
+        if (random() % 10 == 0)
+        {
+            uint8_t data = 0;
+            I2C_Bus_Write(&check.bus, 0x50, &data, 1);
+        }
+
+        std::snprintf(line, sizeof(line), "r=%04x g=%04x b=%04x\r\n", round & 0xFFFF, (round * 7) & 0xFFFF, 0x1234);
+        stream.insert(stream.end(), line, line + std::strlen(line));
+
+        // The main loop sleeps between the samples. For 100 rounds it sleeps 50 s, so that the start
+        // in microseconds wraps at 2^32; it samples more often than the clock wraps
+        check.program_ticks += 48 * (2400 + random() % 50000);
+        if ((round >= 10000) && (round < 10100)) check.program_ticks += 48ull * 50000000;
+
+        // It stops flushing for a while, so that the buffer fills up
+        if ((round % 1000) >= 900) continue;
+
+        I2C_Trace_Flush(&trace, 1 + random() % 6);
+    }
+
+    while (I2C_Trace_Flush(&trace, 16) > 0)
+    {
+    }
+
+    uint64_t dropped = trace.dropped;
+
+    // The decoder must return exactly the transfers that fit in the buffer, and report the others
+    Board_Decoder decoder;
+    Trace decoded;
+    size_t offset = 0;
+
+    while (offset < stream.size())
+    {
+        size_t size = std::min(stream.size() - offset, (size_t)(1 + random() % 300));
+
+        decoder.Decode(&stream[offset], size, 0, [&](const Board_Event &event)
+        {
+            if (event.type == Board_Event_Type::I2C_Trace) decoded.Add(event.i2c_trace);
+            return true;
+        });
+
+        offset += size;
+    }
+
+    uint64_t mismatches = 0;
+    size_t next = 0;
+
+    for (const Transfer &transfer : decoded.transfers)
+    {
+        // Skip the transfers that the board dropped
+        while ((next < check.expected.size()) && (check.expected[next].start_us != transfer.start_us)) next++;
+
+        if ((next == check.expected.size()) || (std::memcmp(&check.expected[next], &transfer, sizeof(Transfer)) != 0))
+        {
+            if (mismatches++ < 5)
+            {
+                std::fprintf(stderr, "transfer at %llu us: 0x%02X %u us %u/%u %d\n", (unsigned long long)transfer.start_us,
+                             transfer.address, transfer.duration_us, transfer.write_length, transfer.read_length, transfer.status);
+            }
+            continue;
+        }
+
+        next++;
+    }
+
+    // The statistics of the board count every transfer, the dropped ones included
+    uint64_t busy_ticks = 0;
+    uint32_t bytes = 0;
+    uint32_t errors[I2C_TRACE_ERROR_KINDS] = {};
+    uint32_t buckets[I2C_TRACE_BUCKETS] = {};
+
+    for (size_t i = 0; i < check.expected.size(); i++)
+    {
+        const Transfer &transfer = check.expected[i];
+        int bucket = 0;
+
+        busy_ticks += check.expected_ticks[i];
+        bytes += transfer.write_length + transfer.read_length;
+        if (transfer.status < 0) errors[-transfer.status - 1]++;
+
+        while ((bucket < (I2C_TRACE_BUCKETS - 1)) &&
+               (check.expected_ticks[i] >= (uint64_t)CHECK_TICKS_PER_US * ((uint32_t)I2C_TRACE_BUCKET_MIN_US << bucket))) bucket++;
+        buckets[bucket]++;
+    }
+
+    uint64_t elapsed = check.program_ticks + Bus_Ticks(check.sim);
+    uint32_t utilization = (uint32_t)(busy_ticks * 10000 / elapsed);
+
+    bool passed = (mismatches == 0) && (decoded.transfers.size() + dropped == check.expected.size()) && (dropped > 0) &&
+                  (decoded.dropped == dropped) && (decoded.high > 0) && (decoder.Counters().lost_frames == 0) &&
+                  (decoder.Counters().crc_errors == 0) && (decoder.Counters().malformed == 0) &&
+                  (trace.transfers == check.expected.size()) && (trace.busy_ticks == busy_ticks) && (trace.bytes == bytes) &&
+                  (std::memcmp(trace.errors, errors, sizeof(errors)) == 0) && (std::memcmp(trace.buckets, buckets, sizeof(buckets)) == 0) &&
+                  (I2C_Trace_Utilization(&trace) == utilization);
+
+    std::printf("Trace: %zu transfers on the bus, %zu decoded in %llu frames, %llu dropped, %.2f%% utilization, %llu errors: %s\n",
+                check.expected.size(), decoded.transfers.size(), (unsigned long long)decoded.frames, (unsigned long long)dropped,
+                utilization / 100.0, (unsigned long long)(errors[0] + errors[1] + errors[2] + errors[3]), passed ? "passed" : "FAILED");
+
+    I2C_Trace_Print_Stats(&trace);
+
+    return passed ? 0 : 1;
+}
+
+// Measures the time that tracing adds to a transfer, on a bus whose transfers do nothing
+int Null_Transfer(I2C_Bus *, I2C_Bus_Message *, uint32_t)
+{
+    return I2C_BUS_OK;
+}
+
+uint32_t Null_Clock(void *context)
+{
+    return ++*(uint32_t *)context;
+}
+
+void Null_Write(void *, const uint8_t *, uint16_t)
+{
+}
+
+void Measure_Overhead()
+{
+    static I2C_Trace trace;
+    static const I2C_Bus_Ops ops = { Null_Transfer };
+    I2C_Bus bus = { &ops, nullptr, I2C_BUS_DEFAULT_TIMEOUT_US, 0, I2C_BUS_NO_MUX_CHANNEL, nullptr };
+    uint32_t clock = 0;
+    uint8_t command = 0x94;
+    uint8_t data[8];
+    constexpr int COUNT = 2000000;
+    double ns[2];
+    double flush_ns = 0.0;
+
+    I2C_Trace_Init(&trace, Null_Clock, &clock, CHECK_TICKS_PER_US, Null_Write, nullptr);
+
+    for (int traced = 0; traced < 2; traced++)
+    {
+        std::chrono::steady_clock::duration flush_time {};
+
+        I2C_Trace_Attach(traced ? &trace : nullptr, &bus);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < COUNT; i++)
+        {
+            I2C_Bus_Write_Read(&bus, PMOD_COLOR_ADDRESS, &command, 1, data, sizeof(data));
+
+            // The flush is timed apart, as the main loop sends the records after the transfers
+            if (traced && ((i & 31) == 31))
+            {
+                auto flush_start = std::chrono::steady_clock::now();
+
+                I2C_Trace_Flush(&trace, 16);
+                flush_time += std::chrono::steady_clock::now() - flush_start;
+            }
+        }
+
+        auto total = std::chrono::steady_clock::now() - start - flush_time;
+
+        ns[traced] = std::chrono::duration<double, std::nano>(total).count() / COUNT;
+        if (traced) flush_ns = std::chrono::duration<double, std::nano>(flush_time).count() / COUNT;
+    }
+
+    std::printf("Overhead: %.1f ns per write-read transfer with the trace, %.1f ns without, and %.1f ns per record to send it, on this host\n",
+                ns[1], ns[0], flush_ns);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    long baud = 115200;
+    double seconds = 0.0;
+    const char *save_path = nullptr;
+    const char *svg_path = nullptr;
+    const char *csv_path = nullptr;
+    const char *input = nullptr;
+    uint64_t window_ms = 100;
+    uint64_t from_ms = 0;
+    uint64_t span_ms = 100;
+    int columns = 100;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--check"))
+        {
+            int result = Check_Trace();
+            Measure_Overhead();
+            return result;
+        }
+        else if (!strcmp(argv[i], "--baud") && (i + 1 < argc)) baud = strtol(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seconds") && (i + 1 < argc)) seconds = strtod(argv[++i], nullptr);
+        else if (!strcmp(argv[i], "--save") && (i + 1 < argc)) save_path = argv[++i];
+        else if (!strcmp(argv[i], "--window") && (i + 1 < argc)) window_ms = std::max(1ull, strtoull(argv[++i], nullptr, 10));
+        else if (!strcmp(argv[i], "--from") && (i + 1 < argc)) from_ms = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--span") && (i + 1 < argc)) span_ms = std::max(1ull, strtoull(argv[++i], nullptr, 10));
+        else if (!strcmp(argv[i], "--columns") && (i + 1 < argc)) columns = std::max(10, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--svg") && (i + 1 < argc)) svg_path = argv[++i];
+        else if (!strcmp(argv[i], "--csv") && (i + 1 < argc)) csv_path = argv[++i];
+        else if ((argv[i][0] != '-') && (input == nullptr)) input = argv[i];
+        else
+        {
+            input = nullptr;
+            break;
+        }
+    }
+
+    if (input == nullptr)
+    {
+        std::fprintf(stderr, "Usage: %s [--baud RATE] [--seconds S] [--save FILE] [--window MS] [--from MS] [--span MS]\n"
+                             "       [--columns N] [--svg FILE] [--csv FILE] INPUT\n"
+                             "       %s --check\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    Board_Decoder decoder;
+    Trace trace;
+
+    if (!Read_Input(input, baud, seconds, save_path, decoder, trace)) return 1;
+
+    Print_Report(trace, decoder.Counters(), window_ms * 1000);
+    Print_Timeline(trace, from_ms, span_ms, columns);
+
+    if (svg_path && !Write_SVG(svg_path, trace, from_ms, span_ms)) return 1;
+    if (csv_path && !Write_CSV(csv_path, trace)) return 1;
+
+    return 0;
+}
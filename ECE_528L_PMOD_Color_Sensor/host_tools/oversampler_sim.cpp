@@ -0,0 +1,231 @@
+/**
+ * @file oversampler_sim.cpp
+ * @brief Host simulation of the Oversampler filter against the Color_Sensor_Mock backend.
+ *
+ * The mock sensor runs back to back 2.4 ms conversions. The program prints three tables:
+ *  - Noise: the standard deviation of the output for a dim, noisy scene at several decimations,
+ *    compared with the sqrt(K) reduction expected for uncorrelated noise.
+ *  - Timing: the number of input samples per output sample and the output period.
+ *  - Flicker: the peak-to-peak ripple of the output under 100 Hz and 120 Hz flicker, with an
+ *    arbitrary decimation and with the decimation chosen by Oversampler_Flicker_Decimation.
+ *  - DC mean: the mean error of the output for a noisy constant scene, for powers of two of K, which
+ *    are scaled with a shift, and the odd neighbouring K, which are scaled with a division. Both round
+ *    to nearest. With an odd K, no sum falls halfway, so the division has no bias. A shift by s rounds
+ *    the halfway sums up, which adds 2^-(s+1) output LSB when the remainders are uniform. The difference
+ *    of the means must be that tie bias within 0.05 LSB, and the program fails otherwise. Truncation
+ *    gave -(1 - 2^-s) / 2 LSB instead.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Oversampler.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Sensor_Mock.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR oversampler_sim.cpp Oversampler.o Color_Sensor_Mock.o -o oversampler_sim
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "inc/Color_Sensor_Mock.h"
+#include "inc/Oversampler.h"
+
+namespace
+{
+
+constexpr uint32_t SAMPLE_PERIOD_US = COLOR_SENSOR_MOCK_CYCLE_US;
+constexpr double PI = 3.14159265358979323846;
+
+// Collects the green channel of the output samples, in units of input counts
+std::vector<double> Collect(Oversampler &oversampler, uint32_t input_count, double flicker_hz, double depth, uint16_t level)
+{
+    std::vector<double> outputs;
+    Oversampler_Data output;
+    double scale = 1.0 / (1u << oversampler.extra_bits);
+
+    for (uint32_t i = 0; i < input_count; i++)
+    {
+        double gain = 1.0;
+
+        // Average of 1 + depth * cos(2 pi f t) over the integration window of this sample
+        if (flicker_hz > 0)
+        {
+            double t0 = Color_Sensor_Mock_Get_Time_us() * 1e-6;
+            double t1 = t0 + SAMPLE_PERIOD_US * 1e-6;
+            double w = 2.0 * PI * flicker_hz;
+            gain += depth * (std::sin(w * t1) - std::sin(w * t0)) / (w * (t1 - t0));
+        }
+
+        uint16_t value = (uint16_t)std::lround(level * gain);
+        Color_Sensor_Mock_Set_Color(value, value, value, value);
+
+        if (Oversampler_Add(&oversampler, Color_Sensor_Mock_Read(), &output))
+        {
+            outputs.push_back(output.green * scale);
+        }
+    }
+
+    return outputs;
+}
+
+double Standard_Deviation(const std::vector<double> &values)
+{
+    double mean = 0.0;
+    double variance = 0.0;
+
+    for (double value : values) mean += value;
+    mean /= values.size();
+
+    for (double value : values) variance += (value - mean) * (value - mean);
+
+    return std::sqrt(variance / (values.size() - 1));
+}
+
+double Peak_To_Peak(const std::vector<double> &values)
+{
+    auto range = std::minmax_element(values.begin(), values.end());
+    return *range.second - *range.first;
+}
+
+void Reset_Mock(uint16_t noise)
+{
+    Color_Sensor_Mock_Init();
+    Color_Sensor_Mock_Set_Timing(SAMPLE_PERIOD_US, 0);
+    Color_Sensor_Mock_Set_Noise(noise, 528);
+}
+
+// Mean of the green channel of the outputs minus the mean of the inputs, in output LSBs
+double DC_Error(uint16_t k, uint8_t extra_bits, uint32_t output_count)
+{
+    Oversampler oversampler;
+    Oversampler_Data output;
+    double input_sum = 0.0;
+    double output_sum = 0.0;
+    uint32_t input_count = 0;
+    double scale = (double)(1u << extra_bits);
+
+    Reset_Mock(8);
+    Color_Sensor_Mock_Set_Color(20, 20, 20, 20);
+    Oversampler_Init(&oversampler, k, extra_bits);
+
+    while (oversampler.output_count < output_count)
+    {
+        PMOD_Color_Data sample = Color_Sensor_Mock_Read();
+
+        input_sum += sample.green;
+        input_count++;
+
+        if (Oversampler_Add(&oversampler, sample, &output))
+        {
+            output_sum += output.green;
+        }
+    }
+
+    return output_sum / output_count - (input_sum / input_count) * scale;
+}
+
+}
+
+int main()
+{
+    Oversampler oversampler;
+    const uint16_t decimations[] = { 1, 4, 16, 64, 25, 125 };
+
+    std::printf("noise: dim scene of 20 counts with +/-8 counts of uniform noise\n");
+    std::printf("%6s %6s %10s %10s %10s\n", "K", "bits", "std dev", "expected", "reduction");
+
+    double reference = 0.0;
+
+    for (uint16_t k : decimations)
+    {
+        uint8_t extra_bits = (uint8_t)std::min<int>(OVERSAMPLER_MAX_EXTRA_BITS, (int)std::ceil(std::log2(k)));
+
+        Reset_Mock(8);
+        Oversampler_Init(&oversampler, k, extra_bits);
+        std::vector<double> outputs = Collect(oversampler, 4000u * k, 0.0, 0.0, 20);
+        double deviation = Standard_Deviation(outputs);
+
+        if (k == 1) reference = deviation;
+
+        std::printf("%6u %6u %10.4f %10.4f %9.1fx\n", k, Oversampler_Get_Output_Bits(&oversampler),
+                    deviation, reference / std::sqrt((double)k), reference / deviation);
+    }
+
+    std::printf("\ntiming: %u us input period\n", SAMPLE_PERIOD_US);
+    std::printf("%6s %10s %10s %12s\n", "K", "inputs", "outputs", "period (us)");
+
+    for (uint16_t k : decimations)
+    {
+        Reset_Mock(0);
+        Oversampler_Init(&oversampler, k, 0);
+
+        uint64_t last_output_us = 0;
+        uint64_t first_period_us = 0;
+        uint8_t uniform = 1;
+        Oversampler_Data output;
+
+        for (uint32_t i = 0; i < 10u * k + (k / 2); i++)
+        {
+            PMOD_Color_Data sample = Color_Sensor_Mock_Read();
+
+            if (Oversampler_Add(&oversampler, sample, &output))
+            {
+                uint64_t now_us = Color_Sensor_Mock_Get_Time_us();
+                uint64_t period_us = now_us - last_output_us;
+
+                if (first_period_us == 0) first_period_us = period_us;
+                if (period_us != first_period_us) uniform = 0;
+                last_output_us = now_us;
+            }
+        }
+
+        std::printf("%6u %10u %10u %12llu%s\n", k, oversampler.input_count, oversampler.output_count,
+                    (unsigned long long)first_period_us,
+                    (uniform && (first_period_us == Oversampler_Get_Output_Period_us(&oversampler, SAMPLE_PERIOD_US))) ? "" : "  MISMATCH");
+    }
+
+    std::printf("\nflicker: 400 counts with 30%% modulation, output ripple in counts\n");
+    std::printf("%8s %14s %10s %16s %10s\n", "flicker", "arbitrary K", "ripple", "chosen K", "ripple");
+
+    const double flicker_frequencies[] = { 100.0, 120.0 };
+
+    for (double flicker_hz : flicker_frequencies)
+    {
+        uint16_t chosen = Oversampler_Flicker_Decimation(SAMPLE_PERIOD_US, OVERSAMPLER_FLICKER_100_120_HZ, 1, 1000, 0);
+
+        Reset_Mock(0);
+        Oversampler_Init(&oversampler, 32, 4);
+        double arbitrary_ripple = Peak_To_Peak(Collect(oversampler, 32u * 200, flicker_hz, 0.3, 400));
+
+        Reset_Mock(0);
+        Oversampler_Init(&oversampler, chosen, 4);
+        double chosen_ripple = Peak_To_Peak(Collect(oversampler, (uint32_t)chosen * 200, flicker_hz, 0.3, 400));
+
+        std::printf("%6.0fHz %14u %10.3f %16u %10.3f\n", flicker_hz, 32, arbitrary_ripple, chosen, chosen_ripple);
+    }
+
+    std::printf("\ndc mean: 20 counts with +/-8 counts of uniform noise, mean error of 20000 outputs in output LSBs\n");
+    std::printf("%6s %6s %12s %6s %12s %12s %12s\n", "bits", "K", "error", "K", "error", "difference", "tie bias");
+
+    // A power of two of K and each of its neighbours
+    const uint16_t pairs[][2] = { { 4, 3 }, { 4, 5 }, { 16, 15 }, { 16, 17 }, { 64, 63 } };
+    uint8_t failed = 0;
+
+    for (uint8_t extra_bits = 0; extra_bits <= 1; extra_bits++)
+    {
+        for (const auto &pair : pairs)
+        {
+            double shift_error = DC_Error(pair[0], extra_bits, 20000);
+            double division_error = DC_Error(pair[1], extra_bits, 20000);
+            double difference = shift_error - division_error;
+            double tie_bias = std::ldexp(1.0, extra_bits - (int)std::log2(pair[0]) - 1);
+            uint8_t mismatch = std::fabs(difference - tie_bias) > 0.05;
+
+            std::printf("%6u %6u %12.4f %6u %12.4f %12.4f %12.4f%s\n", extra_bits, pair[0], shift_error, pair[1], division_error,
+                        difference, tie_bias, mismatch ? "  MISMATCH" : "");
+            failed |= mismatch;
+        }
+    }
+
+    return failed ? 1 : 0;
+}
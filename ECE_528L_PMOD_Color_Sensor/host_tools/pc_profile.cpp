@@ -0,0 +1,841 @@
+/**
+ * @file pc_profile.cpp
+ * @brief Builds a flat profile and a flame graph from the PC samples of a board (see PC_Sampler.h).
+ *
+ * The serial output of a board built with PC_SAMPLING set to 1 is read from a port, or from a file
+ * that holds a recording of it, and decoded with Board_Decoder; the text lines are ignored. Every PC
+ * is symbolized with the function symbols of the ELF file of the firmware (the .out file of CCS), and
+ * the program prints the samples and their share for each function, which is the share of the
+ * processor time it used. The samples that the board dropped because its buffer was full, and the
+ * frames lost on the link, are printed as well, since that part of the time was not seen.
+ *
+ * With PC_SAMPLER_LR, the stacked LR is symbolized too. When it is in another function than the PC,
+ * it is the caller of a leaf function, and the flat profile lists the callers of each function. An
+ * LR that holds an EXC_RETURN value means that the PC was in an interrupt handler that had not called
+ * any function yet; its caller is [exception].
+ *
+ * --folded writes the stacks in the folded format of flamegraph.pl ("caller;function count"), and
+ * --svg writes a flame graph directly. --addresses prints the hottest addresses with their offset in
+ * the function, which finds the loops inside a function (with the disassembly of armdis or objdump).
+ *
+ * --check runs the firmware's PC_Sampler against Board_Decoder on a simulated stream (text lines,
+ * bursts of samples that overflow the buffer and flushes of a few frames) and checks that every sample
+ * and every drop arrives, and checks the symbolizer on a generated ELF file.
+ *
+ * Build from this directory (add -DPC_SAMPLER_LR=1 to both commands to check the LR frames):
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/PC_Sampler.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR pc_profile.cpp Board_Decoder.cpp PC_Sampler.o Board_Protocol.o -o pc_profile
+ *
+ * Usage: pc_profile [options] FIRMWARE.out INPUT
+ *   INPUT                    Serial port of the board, or a file with its recorded output
+ *   --baud RATE              Baud rate of a serial port (default: 115200)
+ *   --seconds S              Stop reading a serial port after S seconds (default: until SIGINT)
+ *   --save FILE              Also write the bytes read from the port to FILE, for later runs
+ *   --top N                  Functions in the flat profile (default: 30)
+ *   --addresses N            Also print the N hottest addresses
+ *   --folded FILE            Write the folded stacks
+ *   --svg FILE               Write a flame graph
+ *
+ *        pc_profile --check
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Board_Decoder.h"
+#include "inc/PC_Sampler.h"
+
+namespace
+{
+
+// ELF32 constants
+constexpr uint8_t ELF_CLASS_32 = 1;
+constexpr uint8_t ELF_DATA_LSB = 1;
+constexpr uint32_t ELF_SHT_SYMTAB = 2;
+constexpr uint8_t ELF_STT_FUNC = 2;
+constexpr size_t ELF_HEADER_SIZE = 52;
+constexpr size_t ELF_SECTION_SIZE = 40;
+constexpr size_t ELF_SYMBOL_SIZE = 16;
+
+// Names of the samples that are not in a function
+const std::string UNKNOWN_NAME = "[unknown]";
+const std::string EXCEPTION_NAME = "[exception]";
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void Handle_Signal(int)
+{
+    stop_requested = 1;
+}
+
+uint16_t Get_U16(const uint8_t *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+uint32_t Get_U32(const uint8_t *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+struct Function
+{
+    uint32_t start;
+    uint32_t size;
+    std::string name;
+};
+
+// Function symbols of an ELF32 little-endian file, sorted by address
+class Symbolizer
+{
+public:
+    bool Load(const std::vector<uint8_t> &elf, std::string &error)
+    {
+        functions.clear();
+
+        if ((elf.size() < ELF_HEADER_SIZE) || (std::memcmp(elf.data(), "\x7F" "ELF", 4) != 0))
+        {
+            error = "not an ELF file";
+            return false;
+        }
+
+        if ((elf[4] != ELF_CLASS_32) || (elf[5] != ELF_DATA_LSB))
+        {
+            error = "not a 32-bit little-endian ELF file";
+            return false;
+        }
+
+        uint32_t section_offset = Get_U32(&elf[32]);
+        uint16_t section_size = Get_U16(&elf[46]);
+        uint16_t section_count = Get_U16(&elf[48]);
+
+        if ((section_size < ELF_SECTION_SIZE) || ((uint64_t)section_offset + (uint64_t)section_size * section_count > elf.size()))
+        {
+            error = "invalid section headers";
+            return false;
+        }
+
+        for (uint16_t i = 0; i < section_count; i++)
+        {
+            const uint8_t *section = &elf[section_offset + (size_t)i * section_size];
+
+            if (Get_U32(section + 4) != ELF_SHT_SYMTAB) continue;
+
+            uint32_t symbols_offset = Get_U32(section + 16);
+            uint32_t symbols_size = Get_U32(section + 20);
+            uint32_t strings_index = Get_U32(section + 24);
+
+            if ((strings_index >= section_count) || ((uint64_t)symbols_offset + symbols_size > elf.size()))
+            {
+                error = "invalid symbol table";
+                return false;
+            }
+
+            const uint8_t *strings_section = &elf[section_offset + (size_t)strings_index * section_size];
+            uint32_t strings_offset = Get_U32(strings_section + 16);
+            uint32_t strings_size = Get_U32(strings_section + 20);
+
+            if ((uint64_t)strings_offset + strings_size > elf.size())
+            {
+                error = "invalid string table";
+                return false;
+            }
+
+            for (uint32_t offset = 0; offset + ELF_SYMBOL_SIZE <= symbols_size; offset += ELF_SYMBOL_SIZE)
+            {
+                const uint8_t *symbol = &elf[symbols_offset + offset];
+                uint32_t name = Get_U32(symbol);
+
+                if (((symbol[12] & 0x0F) != ELF_STT_FUNC) || (name >= strings_size)) continue;
+
+                const char *text = (const char *)&elf[strings_offset + name];
+                size_t length = strnlen(text, strings_size - name);
+
+                // Bit 0 of a Thumb function address is set
+                functions.push_back({ Get_U32(symbol + 4) & ~1u, Get_U32(symbol + 8), std::string(text, length) });
+            }
+        }
+
+        if (functions.empty())
+        {
+            error = "no function symbols (stripped file?)";
+            return false;
+        }
+
+        std::sort(functions.begin(), functions.end(), [](const Function &a, const Function &b)
+        {
+            return (a.start != b.start) ? (a.start < b.start) : (a.size > b.size);
+        });
+
+        // Aliases of the same address keep the first (largest) symbol
+        functions.erase(std::unique(functions.begin(), functions.end(), [](const Function &a, const Function &b)
+        {
+            return a.start == b.start;
+        }), functions.end());
+
+        return true;
+    }
+
+    // Returns the function that contains an address, or nullptr. A symbol without a size extends to the next one
+    const Function *Find(uint32_t address) const
+    {
+        auto next = std::upper_bound(functions.begin(), functions.end(), address, [](uint32_t value, const Function &function)
+        {
+            return value < function.start;
+        });
+
+        if (next == functions.begin()) return nullptr;
+
+        const Function &function = *(next - 1);
+
+        if ((function.size > 0) && (address - function.start >= function.size)) return nullptr;
+
+        return &function;
+    }
+
+    size_t Size() const { return functions.size(); }
+
+private:
+    std::vector<Function> functions;
+};
+
+struct Profile
+{
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+    uint64_t frames = 0;
+    bool has_lr = false;
+
+    std::unordered_map<uint32_t, uint64_t> pcs;
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> pc_lrs;
+
+    void Add(const Board_Protocol_PC_Samples &samples)
+    {
+        frames++;
+        dropped += samples.dropped;
+        has_lr = has_lr || samples.has_lr;
+
+        for (uint8_t i = 0; i < samples.count; i++)
+        {
+            Add_Sample(samples.pc[i], samples.has_lr ? samples.lr[i] : 0);
+        }
+    }
+
+    void Add_Sample(uint32_t pc, uint32_t lr)
+    {
+        samples++;
+        pcs[pc]++;
+        pc_lrs[{ pc, lr }]++;
+    }
+};
+
+std::string Function_Name(const Symbolizer &symbolizer, uint32_t address)
+{
+    const Function *function = symbolizer.Find(address);
+    return function ? function->name : UNKNOWN_NAME;
+}
+
+// Caller of a sample from its stacked LR, or an empty string when the LR does not give one
+std::string Caller_Name(const Symbolizer &symbolizer, uint32_t pc, uint32_t lr)
+{
+    if (lr >= 0xFFFFFFE0u) return EXCEPTION_NAME;
+    if (lr < 2) return std::string();
+
+    // The return address follows the call; the call itself is in the caller
+    const Function *caller = symbolizer.Find((lr & ~1u) - 2);
+    const Function *function = symbolizer.Find(pc);
+
+    if ((caller == nullptr) || (caller == function)) return std::string();
+
+    return caller->name;
+}
+
+// Folded stacks: "caller;function" or "function", with their samples
+std::map<std::string, uint64_t> Fold(const Profile &profile, const Symbolizer &symbolizer)
+{
+    std::map<std::string, uint64_t> stacks;
+
+    for (const auto &entry : profile.pc_lrs)
+    {
+        std::string function = Function_Name(symbolizer, entry.first.first);
+        std::string caller = profile.has_lr ? Caller_Name(symbolizer, entry.first.first, entry.first.second) : std::string();
+
+        stacks[caller.empty() ? function : caller + ";" + function] += entry.second;
+    }
+
+    if (profile.dropped > 0)
+    {
+        stacks["[dropped]"] += profile.dropped;
+    }
+
+    return stacks;
+}
+
+void Print_Profile(const Profile &profile, const Symbolizer &symbolizer, const Board_Decoder_Counters &counters, size_t top, size_t addresses)
+{
+    std::map<std::string, uint64_t> functions;
+    std::map<std::string, std::map<std::string, uint64_t>> callers;
+
+    for (const auto &entry : profile.pc_lrs)
+    {
+        std::string function = Function_Name(symbolizer, entry.first.first);
+
+        functions[function] += entry.second;
+
+        if (profile.has_lr)
+        {
+            std::string caller = Caller_Name(symbolizer, entry.first.first, entry.first.second);
+            if (!caller.empty()) callers[function][caller] += entry.second;
+        }
+    }
+
+    uint64_t total = profile.samples + profile.dropped;
+
+    std::printf("%llu samples in %llu frames, %llu dropped by the board, %llu frames lost, %llu CRC errors\n",
+                (unsigned long long)profile.samples, (unsigned long long)profile.frames, (unsigned long long)profile.dropped,
+                (unsigned long long)counters.lost_frames, (unsigned long long)counters.crc_errors);
+
+    if (total == 0) return;
+
+    std::vector<std::pair<std::string, uint64_t>> sorted(functions.begin(), functions.end());
+
+    if (profile.dropped > 0)
+    {
+        sorted.emplace_back("[dropped]", profile.dropped);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+    {
+        return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+    });
+
+    std::printf("\n  samples      %%   cumul%%  function\n");
+
+    uint64_t cumulative = 0;
+
+    for (size_t i = 0; (i < sorted.size()) && (i < top); i++)
+    {
+        cumulative += sorted[i].second;
+        std::printf("%9llu %6.2f %7.2f  %s\n", (unsigned long long)sorted[i].second, 100.0 * sorted[i].second / total,
+                    100.0 * cumulative / total, sorted[i].first.c_str());
+
+        auto found = callers.find(sorted[i].first);
+        if (found == callers.end()) continue;
+
+        std::vector<std::pair<std::string, uint64_t>> from(found->second.begin(), found->second.end());
+        std::sort(from.begin(), from.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+        for (size_t j = 0; (j < from.size()) && (j < 3); j++)
+        {
+            std::printf("%9llu %6.2f          called from %s\n", (unsigned long long)from[j].second,
+                        100.0 * from[j].second / total, from[j].first.c_str());
+        }
+    }
+
+    if (addresses == 0) return;
+
+    std::vector<std::pair<uint32_t, uint64_t>> hot(profile.pcs.begin(), profile.pcs.end());
+    std::sort(hot.begin(), hot.end(), [](const auto &a, const auto &b)
+    {
+        return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+    });
+
+    std::printf("\n  samples      %%  address     function\n");
+
+    for (size_t i = 0; (i < hot.size()) && (i < addresses); i++)
+    {
+        const Function *function = symbolizer.Find(hot[i].first);
+
+        std::printf("%9llu %6.2f  0x%08X  %s+0x%X\n", (unsigned long long)hot[i].second, 100.0 * hot[i].second / total,
+                    hot[i].first, function ? function->name.c_str() : UNKNOWN_NAME.c_str(),
+                    function ? hot[i].first - function->start : 0);
+    }
+}
+
+bool Write_Folded(const char *path, const std::map<std::string, uint64_t> &stacks)
+{
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr) return false;
+
+    for (const auto &stack : stacks)
+    {
+        std::fprintf(file, "%s %llu\n", stack.first.c_str(), (unsigned long long)stack.second);
+    }
+
+    return std::fclose(file) == 0;
+}
+
+struct Flame_Node
+{
+    uint64_t samples = 0;
+    std::map<std::string, Flame_Node> children;
+};
+
+std::string Escape_XML(const std::string &text)
+{
+    std::string escaped;
+
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '<':  escaped += "&lt;"; break;
+            case '>':  escaped += "&gt;"; break;
+            case '&':  escaped += "&amp;"; break;
+            case '"':  escaped += "&quot;"; break;
+            default:   escaped += c; break;
+        }
+    }
+
+    return escaped;
+}
+
+// Draws a node and its children above it; the root is at the bottom of the graph
+void Draw_Node(FILE *file, const std::string &name, const Flame_Node &node, double x, int depth, double scale, int height, uint64_t total)
+{
+    constexpr int ROW = 17;
+    double width = node.samples * scale;
+
+    if (width < 0.5) return;
+
+    int y = height - (depth + 1) * ROW;
+    uint32_t hash = 2166136261u;
+
+    for (char c : name) hash = (hash ^ (uint8_t)c) * 16777619u;
+
+    std::fprintf(file, "<g><title>%s (%llu samples, %.2f%%)</title>"
+                       "<rect x=\"%.1f\" y=\"%d\" width=\"%.1f\" height=\"%d\" fill=\"rgb(%u,%u,%u)\" rx=\"2\"/>",
+                 Escape_XML(name).c_str(), (unsigned long long)node.samples, 100.0 * node.samples / total,
+                 x, y, width, ROW - 1, 205 + (hash % 50), 80 + ((hash >> 8) % 120), 40 + ((hash >> 16) % 50));
+
+    // About 7 pixels per character of the 12 px font
+    size_t fit = (size_t)(width / 7.0);
+
+    if (fit >= 3)
+    {
+        std::string label = (name.size() <= fit) ? name : name.substr(0, fit - 2) + "..";
+        std::fprintf(file, "<text x=\"%.1f\" y=\"%d\">%s</text>", x + 3, y + ROW - 5, Escape_XML(label).c_str());
+    }
+
+    std::fprintf(file, "</g>\n");
+
+    for (const auto &child : node.children)
+    {
+        Draw_Node(file, child.first, child.second, x, depth + 1, scale, height, total);
+        x += child.second.samples * scale;
+    }
+}
+
+bool Write_SVG(const char *path, const std::map<std::string, uint64_t> &stacks)
+{
+    Flame_Node root;
+    int depth = 1;
+
+    for (const auto &stack : stacks)
+    {
+        Flame_Node *node = &root;
+        size_t start = 0;
+        int frames = 1;
+
+        root.samples += stack.second;
+
+        while (true)
+        {
+            size_t end = stack.first.find(';', start);
+
+            node = &node->children[stack.first.substr(start, end - start)];
+            node->samples += stack.second;
+            frames++;
+
+            if (end == std::string::npos) break;
+            start = end + 1;
+        }
+
+        depth = std::max(depth, frames);
+    }
+
+    if (root.samples == 0) return false;
+
+    constexpr int WIDTH = 1200;
+    constexpr int MARGIN = 10;
+    int height = depth * 17 + 40;
+
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file, "<?xml version=\"1.0\" standalone=\"no\"?>\n"
+                       "<svg version=\"1.1\" width=\"%d\" height=\"%d\" xmlns=\"http://www.w3.org/2000/svg\" "
+                       "font-family=\"Verdana\" font-size=\"12\">\n"
+                       "<rect width=\"100%%\" height=\"100%%\" fill=\"#f8f8f0\"/>\n"
+                       "<text x=\"%d\" y=\"24\" font-size=\"16\">PC samples: %llu</text>\n",
+                 WIDTH + 2 * MARGIN, height, MARGIN, (unsigned long long)root.samples);
+
+    Draw_Node(file, "all", root, MARGIN, 0, (double)WIDTH / root.samples, height, root.samples);
+
+    std::fprintf(file, "</svg>\n");
+    return std::fclose(file) == 0;
+}
+
+speed_t Baud_Constant(long baud)
+{
+    switch (baud)
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return B0;
+    }
+}
+
+// Reads a recording, or a serial port until the time is up or SIGINT, and decodes the samples
+bool Read_Input(const char *path, long baud, double seconds, const char *save_path, Board_Decoder &decoder, Profile &profile)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    bool port = isatty(fd);
+
+    if (port)
+    {
+        struct termios settings;
+
+        if (tcgetattr(fd, &settings) == 0)
+        {
+            cfmakeraw(&settings);
+            cfsetispeed(&settings, Baud_Constant(baud));
+            cfsetospeed(&settings, Baud_Constant(baud));
+            settings.c_cflag |= CLOCAL | CREAD;
+            tcsetattr(fd, TCSANOW, &settings);
+        }
+
+        std::signal(SIGINT, Handle_Signal);
+        std::fprintf(stderr, "Reading %s, Ctrl-C to stop\n", path);
+    }
+
+    FILE *save = save_path ? std::fopen(save_path, "wb") : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    uint8_t buffer[4096];
+
+    while (!stop_requested)
+    {
+        if (port)
+        {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if ((seconds > 0.0) && (elapsed >= seconds)) break;
+
+            fd_set read_set;
+            struct timeval timeout = { 0, 100000 };
+
+            FD_ZERO(&read_set);
+            FD_SET(fd, &read_set);
+
+            if (select(fd + 1, &read_set, nullptr, nullptr, &timeout) <= 0) continue;
+        }
+
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        if (save) std::fwrite(buffer, 1, (size_t)length, save);
+
+        decoder.Decode(buffer, (size_t)length, 0, [&](const Board_Event &event)
+        {
+            if (event.type == Board_Event_Type::PC_Samples) profile.Add(event.pc_samples);
+            return true;
+        });
+    }
+
+    if (save) std::fclose(save);
+    close(fd);
+    return true;
+}
+
+// Adds a symbol to a generated ELF file
+void Put_Symbol(std::vector<uint8_t> &symbols, std::string &strings, const char *name, uint32_t value, uint32_t size, uint8_t type)
+{
+    uint8_t symbol[ELF_SYMBOL_SIZE] = {};
+    uint32_t name_offset = (uint32_t)strings.size();
+
+    strings += name;
+    strings += '\0';
+
+    std::memcpy(&symbol[0], &name_offset, 4);
+    std::memcpy(&symbol[4], &value, 4);
+    std::memcpy(&symbol[8], &size, 4);
+    symbol[12] = (uint8_t)(0x10 | type);
+    symbol[14] = 1;
+
+    symbols.insert(symbols.end(), symbol, symbol + ELF_SYMBOL_SIZE);
+}
+
+// Generates an ELF file with a symbol table and a string table, and nothing else
+std::vector<uint8_t> Generate_ELF(const std::vector<uint8_t> &symbols, const std::string &strings)
+{
+    std::vector<uint8_t> elf(ELF_HEADER_SIZE, 0);
+    uint32_t symbols_offset = (uint32_t)elf.size();
+
+    elf.insert(elf.end(), symbols.begin(), symbols.end());
+
+    uint32_t strings_offset = (uint32_t)elf.size();
+
+    elf.insert(elf.end(), strings.begin(), strings.end());
+
+    while (elf.size() % 4) elf.push_back(0);
+
+    uint32_t section_offset = (uint32_t)elf.size();
+    uint8_t sections[3][ELF_SECTION_SIZE] = {};
+    uint32_t symbols_size = (uint32_t)symbols.size();
+    uint32_t strings_size = (uint32_t)strings.size();
+    uint32_t symtab = ELF_SHT_SYMTAB;
+    uint32_t strtab = 3;
+    uint32_t link = 2;
+
+    std::memcpy(&sections[1][4], &symtab, 4);
+    std::memcpy(&sections[1][16], &symbols_offset, 4);
+    std::memcpy(&sections[1][20], &symbols_size, 4);
+    std::memcpy(&sections[1][24], &link, 4);
+    std::memcpy(&sections[2][4], &strtab, 4);
+    std::memcpy(&sections[2][16], &strings_offset, 4);
+    std::memcpy(&sections[2][20], &strings_size, 4);
+
+    for (auto &section : sections) elf.insert(elf.end(), section, section + ELF_SECTION_SIZE);
+
+    uint16_t section_size = ELF_SECTION_SIZE;
+    uint16_t section_count = 3;
+
+    std::memcpy(&elf[0], "\x7F" "ELF", 4);
+    elf[4] = ELF_CLASS_32;
+    elf[5] = ELF_DATA_LSB;
+    elf[6] = 1;
+    std::memcpy(&elf[32], &section_offset, 4);
+    std::memcpy(&elf[46], &section_size, 2);
+    std::memcpy(&elf[48], &section_count, 2);
+
+    return elf;
+}
+
+// Writes the frames of the sampler to the simulated link
+void Check_Write(void *context, const uint8_t *frame, uint16_t length)
+{
+    std::vector<uint8_t> &stream = *(std::vector<uint8_t> *)context;
+    stream.insert(stream.end(), frame, frame + length);
+}
+
+int Check_Stream()
+{
+    static PC_Sampler sampler;
+    std::vector<uint8_t> stream;
+    std::vector<std::pair<uint32_t, uint32_t>> pushed;
+    std::mt19937 random(12345);
+    uint64_t dropped = 0;
+    char line[64];
+
+    PC_Sampler_Init(&sampler, Check_Write, &stream);
+
+    for (int round = 0; round < 20000; round++)
+    {
+        // Samples taken while the main program ran, sometimes more than the buffer holds
+        uint32_t count = (random() % 50 == 0) ? PC_SAMPLER_BUFFER_SIZE + random() % 300 : random() % 40;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t pc = 0x1000 + (random() % 0x8000) * 2;
+            uint32_t lr = (random() % 16 == 0) ? 0xFFFFFFF9u : (0x1000 + (random() % 0x8000) * 2) | 1;
+
+            if (PC_Sampler_Pending(&sampler) < PC_SAMPLER_BUFFER_SIZE)
+            {
+                pushed.emplace_back(pc, PC_SAMPLER_LR ? lr : 0);
+            }
+            else
+            {
+                dropped++;
+            }
+
+            PC_Sampler_Push(&sampler, pc, lr);
+        }
+
+        std::snprintf(line, sizeof(line), "r=%04x g=%04x b=%04x\r\n", round & 0xFFFF, (round * 7) & 0xFFFF, 0x1234);
+        stream.insert(stream.end(), line, line + std::strlen(line));
+
+        PC_Sampler_Flush(&sampler, 1 + random() % 6);
+    }
+
+    while (PC_Sampler_Flush(&sampler, 16) > 0)
+    {
+    }
+
+    Board_Decoder decoder;
+    Profile profile;
+    std::vector<std::pair<uint32_t, uint32_t>> received;
+    size_t offset = 0;
+
+    // The stream arrives in reads of random sizes
+    while (offset < stream.size())
+    {
+        size_t size = std::min(stream.size() - offset, (size_t)(1 + random() % 300));
+
+        decoder.Decode(&stream[offset], size, 0, [&](const Board_Event &event)
+        {
+            if (event.type != Board_Event_Type::PC_Samples) return true;
+
+            profile.Add(event.pc_samples);
+
+            for (uint8_t i = 0; i < event.pc_samples.count; i++)
+            {
+                received.emplace_back(event.pc_samples.pc[i], event.pc_samples.lr[i]);
+            }
+            return true;
+        });
+
+        offset += size;
+    }
+
+    bool passed = (received == pushed) && (profile.dropped == dropped) && (sampler.dropped == dropped) &&
+                  (decoder.Counters().lost_frames == 0) && (decoder.Counters().crc_errors == 0) &&
+                  (decoder.Counters().malformed == 0) && (decoder.Counters().lines == 20000);
+
+    std::printf("Stream: %zu samples in %llu frames, %llu dropped, %llu text lines, %zu bytes: %s\n", received.size(),
+                (unsigned long long)profile.frames, (unsigned long long)profile.dropped,
+                (unsigned long long)decoder.Counters().lines, stream.size(), passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
+
+int Check_Symbolizer()
+{
+    std::vector<uint8_t> symbols(ELF_SYMBOL_SIZE, 0);
+    std::string strings(1, '\0');
+
+    Put_Symbol(symbols, strings, "main", 0x1001, 0x100, ELF_STT_FUNC);
+    Put_Symbol(symbols, strings, "Delay", 0x1101, 0x20, ELF_STT_FUNC);
+    Put_Symbol(symbols, strings, "table", 0x1200, 0x40, 1);
+    Put_Symbol(symbols, strings, "Handler", 0x1301, 0, ELF_STT_FUNC);
+    Put_Symbol(symbols, strings, "_c_int00", 0x1401, 0x10, ELF_STT_FUNC);
+
+    Symbolizer symbolizer;
+    std::string error;
+    bool passed = symbolizer.Load(Generate_ELF(symbols, strings), error);
+
+    struct
+    {
+        uint32_t address;
+        const char *name;
+    } cases[] =
+    {
+        { 0x0FFE, "[unknown]" }, { 0x1000, "main" }, { 0x10FE, "main" }, { 0x1100, "Delay" }, { 0x111E, "Delay" },
+        { 0x1120, "[unknown]" }, { 0x1210, "[unknown]" }, { 0x1300, "Handler" }, { 0x13FE, "Handler" },
+        { 0x1400, "_c_int00" }, { 0x1410, "[unknown]" },
+    };
+
+    for (const auto &test : cases)
+    {
+        passed = passed && (Function_Name(symbolizer, test.address) == test.name);
+    }
+
+    // A return address into main is a call from main; an LR inside the function itself is not a caller
+    passed = passed && (Caller_Name(symbolizer, 0x1104, 0x1051) == "main") && (Caller_Name(symbolizer, 0x1104, 0x1111).empty()) &&
+             (Caller_Name(symbolizer, 0x1104, 0xFFFFFFF9u) == EXCEPTION_NAME);
+
+    std::printf("Symbolizer: %zu functions: %s\n", symbolizer.Size(), passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    long baud = 115200;
+    double seconds = 0.0;
+    const char *save_path = nullptr;
+    const char *folded_path = nullptr;
+    const char *svg_path = nullptr;
+    size_t top = 30;
+    size_t addresses = 0;
+    bool usage = false;
+    std::vector<const char *> paths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--check") return Check_Stream() | Check_Symbolizer();
+        else if ((option == "--baud") && (i + 1 < argc)) baud = std::strtol(argv[++i], nullptr, 10);
+        else if ((option == "--seconds") && (i + 1 < argc)) seconds = std::atof(argv[++i]);
+        else if ((option == "--save") && (i + 1 < argc)) save_path = argv[++i];
+        else if ((option == "--top") && (i + 1 < argc)) top = std::strtoul(argv[++i], nullptr, 10);
+        else if ((option == "--addresses") && (i + 1 < argc)) addresses = std::strtoul(argv[++i], nullptr, 10);
+        else if ((option == "--folded") && (i + 1 < argc)) folded_path = argv[++i];
+        else if ((option == "--svg") && (i + 1 < argc)) svg_path = argv[++i];
+        else if (option.compare(0, 2, "--") != 0) paths.push_back(argv[i]);
+        else usage = true;
+    }
+
+    if (usage || (paths.size() != 2) || (Baud_Constant(baud) == B0))
+    {
+        std::fprintf(stderr, "Usage: %s [--baud RATE] [--seconds S] [--save FILE] [--top N] [--addresses N] [--folded FILE] [--svg FILE] FIRMWARE.out INPUT\n"
+                             "       %s --check\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    std::ifstream elf_file(paths[0], std::ios::binary);
+    std::vector<uint8_t> elf((std::istreambuf_iterator<char>(elf_file)), std::istreambuf_iterator<char>());
+    Symbolizer symbolizer;
+    std::string error;
+
+    if (!elf_file || !symbolizer.Load(elf, error))
+    {
+        std::fprintf(stderr, "%s: %s\n", paths[0], elf_file ? error.c_str() : "cannot read");
+        return 1;
+    }
+
+    Board_Decoder decoder;
+    Profile profile;
+
+    if (!Read_Input(paths[1], baud, seconds, save_path, decoder, profile)) return 1;
+
+    Print_Profile(profile, symbolizer, decoder.Counters(), top, addresses);
+
+    std::map<std::string, uint64_t> stacks = Fold(profile, symbolizer);
+
+    if (folded_path && !Write_Folded(folded_path, stacks))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", folded_path);
+        return 1;
+    }
+
+    if (svg_path && !Write_SVG(svg_path, stacks))
+    {
+        std::fprintf(stderr, "Cannot write %s\n", svg_path);
+        return 1;
+    }
+
+    return 0;
+}
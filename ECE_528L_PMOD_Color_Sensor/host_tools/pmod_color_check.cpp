@@ -0,0 +1,353 @@
+/**
+ * @file pmod_color_check.cpp
+ * @brief Checks the multi-sensor PMOD_Color driver on simulated buses with TCS34725s behind TCA9548As.
+ *
+ * The firmware's PMOD_Color runs on two I2C_Bus_Sim buses, each with a TCA9548A and TCS34725s at the
+ * same address on different channels. Every transfer is recorded on its way to the simulated bus, with
+ * the channel that the multiplexer had selected, and transfers can be made to fail:
+ *   - Init: PMOD_Color_Sensor_Init succeeds on a present sensor, and returns the error when any one of
+ *     its transfers fails, or when the sensor is missing behind the multiplexer.
+ *   - Channel cache: reads of the sensors in random order reach the selected sensor and no other (no
+ *     collision, each sensor returns its own data), the multiplexer is only written when the channel
+ *     changes, a sensor without a multiplexer leaves the cached channel alone, and a failed channel
+ *     write makes the next access select the channel again.
+ *   - Sampling: PMOD_Color_Sample_Sensors visits the sensors of the two buses in turn, returns the data
+ *     of each sensor, and returns the ready sensors when one is slow or missing. The slow one is read
+ *     by a later call.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/I2C_Bus_Sim.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/PMOD_Color.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR pmod_color_check.cpp I2C_Bus.o I2C_Bus_Sim.o PMOD_Color.o -o pmod_color_check
+ *
+ * Usage: pmod_color_check
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "inc/I2C_Bus.h"
+#include "inc/I2C_Bus_Sim.h"
+#include "inc/PMOD_Color.h"
+
+namespace
+{
+
+// Address of a second sensor model that is connected directly to bus A
+constexpr uint8_t DIRECT_ADDRESS = 0x39;
+
+// A transfer as it reached the simulated bus
+struct Access
+{
+    int bus;
+    uint8_t address;
+
+    // For a write to the multiplexer: its new control byte. Otherwise the control byte it had
+    bool mux_write;
+    uint8_t control;
+    int status;
+};
+
+struct Check_Bus
+{
+    I2C_Bus bus;
+    I2C_Bus_Sim_Context sim;
+    const I2C_Bus_Ops *sim_ops;
+    I2C_Bus_Ops ops;
+    int id;
+
+    // Transfer number that fails with a NACK, or -1
+    int64_t fail_at = -1;
+    int64_t transfers = 0;
+};
+
+Check_Bus check_buses[2];
+std::vector<Access> accesses;
+uint64_t failures = 0;
+
+int Check_Transfer(I2C_Bus *bus, I2C_Bus_Message *messages, uint32_t message_count)
+{
+    Check_Bus &check = (bus == &check_buses[0].bus) ? check_buses[0] : check_buses[1];
+    Access access = { check.id, messages[0].address, false, check.sim.mux_control, I2C_BUS_OK };
+
+    if ((messages[0].address == check.sim.mux_address) && !(messages[0].flags & I2C_BUS_MSG_READ))
+    {
+        access.mux_write = true;
+        access.control = messages[0].buffer[messages[0].length - 1];
+    }
+
+    access.status = (check.transfers++ == check.fail_at) ? I2C_BUS_ERROR_NACK : check.sim_ops->transfer(bus, messages, message_count);
+    accesses.push_back(access);
+
+    return access.status;
+}
+
+// Sets up a bus with a multiplexer, and routes its transfers through the check
+void Reset_Bus(int id)
+{
+    Check_Bus &check = check_buses[id];
+
+    I2C_Bus_Sim_Init(&check.bus, &check.sim);
+    I2C_Bus_Sim_Add_TCA9548A(&check.sim, TCA9548A_ADDRESS);
+
+    check.id = id;
+    check.fail_at = -1;
+    check.transfers = 0;
+    check.sim_ops = check.bus.ops;
+    check.ops.transfer = Check_Transfer;
+    check.bus.ops = &check.ops;
+}
+
+void Expect(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        if (failures < 10) std::fprintf(stderr, "failed: %s\n", what);
+        failures++;
+    }
+}
+
+// Channel values that tell the sensors apart
+PMOD_Color_Data Sensor_Values(int bus, int channel)
+{
+    uint16_t base = (uint16_t)(1000 * (bus + 1) + 100 * channel);
+    return { (uint16_t)(base + 1), (uint16_t)(base + 2), (uint16_t)(base + 3), base };
+}
+
+I2C_Bus_Sim_Device *Add_Sensor(int bus, uint8_t channel, uint32_t transfers_per_conversion)
+{
+    I2C_Bus_Sim_Device *device = I2C_Bus_Sim_Add_TCS34725(&check_buses[bus].sim, PMOD_COLOR_ADDRESS, channel,
+                                                           transfers_per_conversion);
+    PMOD_Color_Data values = Sensor_Values(bus, channel);
+
+    I2C_Bus_Sim_Set_RGBC(device, values.clear, values.red, values.green, values.blue);
+    return device;
+}
+
+bool Same_Data(const PMOD_Color_Data &a, const PMOD_Color_Data &b)
+{
+    return (a.red == b.red) && (a.green == b.green) && (a.blue == b.blue) && (a.clear == b.clear);
+}
+
+void Check_Init()
+{
+    uint64_t before = failures;
+
+    Reset_Bus(0);
+    Add_Sensor(0, 2, 1);
+
+    PMOD_Color_Sensor sensor = { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 2 };
+
+    accesses.clear();
+    Expect(PMOD_Color_Sensor_Init(&sensor) == I2C_BUS_OK, "init of a present sensor");
+    size_t transfer_count = accesses.size();
+
+    // Each transfer of the initialization fails in turn, the channel select included
+    for (size_t k = 0; k < transfer_count; k++)
+    {
+        Reset_Bus(0);
+        Add_Sensor(0, 2, 1);
+        check_buses[0].fail_at = (int64_t)k;
+
+        Expect(PMOD_Color_Sensor_Init(&sensor) == I2C_BUS_ERROR_NACK, "init returns the error of each failed transfer");
+    }
+
+    // A channel of the multiplexer without a sensor
+    Reset_Bus(0);
+    Add_Sensor(0, 2, 1);
+
+    PMOD_Color_Sensor missing = { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 5 };
+    Expect(PMOD_Color_Sensor_Init(&missing) == I2C_BUS_ERROR_NACK, "init of a missing sensor behind the multiplexer");
+
+    std::printf("Init: %zu transfers, each one failed in turn, and a missing sensor: %s\n", transfer_count,
+                (failures == before) ? "passed" : "FAILED");
+}
+
+void Check_Channel_Cache()
+{
+    uint64_t before = failures;
+    std::mt19937 random(76);
+    PMOD_Color_Sensor sensors[5];
+    uint64_t reads = 0;
+    uint64_t mux_writes = 0;
+    uint64_t switches = 0;
+
+    Reset_Bus(0);
+
+    for (uint8_t channel = 0; channel < 4; channel++)
+    {
+        Add_Sensor(0, channel, 1);
+        sensors[channel] = { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, channel };
+    }
+
+    // A sensor at another address on the bus itself
+    I2C_Bus_Sim_Device *direct = I2C_Bus_Sim_Add_TCS34725(&check_buses[0].sim, DIRECT_ADDRESS, PMOD_COLOR_NO_MUX, 1);
+    I2C_Bus_Sim_Set_RGBC(direct, 9000, 9001, 9002, 9003);
+    sensors[4] = { &check_buses[0].bus, DIRECT_ADDRESS, 0, PMOD_COLOR_NO_MUX };
+
+    for (PMOD_Color_Sensor &sensor : sensors)
+    {
+        Expect(PMOD_Color_Sensor_Init(&sensor) == I2C_BUS_OK, "init of each sensor");
+    }
+
+    uint8_t selected = check_buses[0].sim.mux_control;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        int s = random() % 5;
+        PMOD_Color_Sensor &sensor = sensors[s];
+        bool switch_channel = (sensor.mux_channel != PMOD_COLOR_NO_MUX) && (selected != (1 << sensor.mux_channel));
+
+        // Now and then, the channel select fails
+        if (switch_channel && (random() % 10 == 0))
+        {
+            check_buses[0].fail_at = check_buses[0].transfers;
+            uint8_t id = 0;
+
+            Expect(PMOD_Color_Sensor_Read_Register(&sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_DEVICE_ID_REG, &id) == I2C_BUS_ERROR_NACK,
+                   "a failed channel select is returned");
+            Expect(check_buses[0].bus.mux_channel == PMOD_COLOR_NO_MUX, "a failed channel select clears the cache");
+
+            // The multiplexer may have taken the byte or not; a select must follow either way
+            selected = 0xFF;
+            continue;
+        }
+
+        size_t first = accesses.size();
+        PMOD_Color_Data data;
+
+        if (random() % 2)
+        {
+            uint8_t id = 0;
+
+            Expect(PMOD_Color_Sensor_Read_Register(&sensor, PMOD_COLOR_AUTO_INC | PMOD_COLOR_DEVICE_ID_REG, &id) == I2C_BUS_OK,
+                   "read of the ID register");
+            Expect(id == I2C_BUS_SIM_TCS34725_ID, "ID of the sensor");
+        }
+        else
+        {
+            Expect(PMOD_Color_Sensor_Get_RGBC(&sensor, &data) == I2C_BUS_OK, "read of the data registers");
+
+            PMOD_Color_Data expected = (s == 4) ? PMOD_Color_Data{ 9001, 9002, 9003, 9000 } : Sensor_Values(0, s);
+            Expect(Same_Data(data, expected), "the data of the selected sensor");
+        }
+
+        // The multiplexer is written exactly when the channel changes, and the sensor is then reached
+        // on its channel
+        uint64_t writes = 0;
+
+        for (size_t a = first; a < accesses.size(); a++)
+        {
+            const Access &access = accesses[a];
+
+            if (access.mux_write)
+            {
+                writes++;
+                selected = access.control;
+            }
+            else if (sensor.mux_channel != PMOD_COLOR_NO_MUX)
+            {
+                Expect(access.control == (1 << sensor.mux_channel), "the sensor is read on its channel");
+            }
+        }
+
+        Expect(writes == (switch_channel ? 1u : 0u), "one channel select per channel change, none otherwise");
+
+        mux_writes += writes;
+        switches += switch_channel;
+        reads++;
+    }
+
+    Expect(check_buses[0].sim.collision_count == 0, "no two sensors answer at the same time");
+
+    std::printf("Channel cache: %llu reads of 5 sensors, %llu channel changes, %llu channel selects: %s\n",
+                (unsigned long long)reads, (unsigned long long)switches, (unsigned long long)mux_writes,
+                (failures == before) ? "passed" : "FAILED");
+}
+
+void Check_Sample_Sensors()
+{
+    uint64_t before = failures;
+
+    Reset_Bus(0);
+    Reset_Bus(1);
+
+    // Bus A: 4 sensors, of which the one on channel 2 converts slowly. Bus B: 2 sensors, and a
+    // channel without a sensor
+    for (uint8_t channel = 0; channel < 4; channel++) Add_Sensor(0, channel, (channel == 2) ? 400 : 1);
+    for (uint8_t channel = 0; channel < 2; channel++) Add_Sensor(1, channel, 1);
+
+    PMOD_Color_Sensor sensors[7] =
+    {
+        { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 0 },
+        { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 1 },
+        { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 2 },
+        { &check_buses[0].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 3 },
+        { &check_buses[1].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 0 },
+        { &check_buses[1].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 1 },
+        { &check_buses[1].bus, PMOD_COLOR_ADDRESS, TCA9548A_ADDRESS, 2 },
+    };
+    PMOD_Color_Data data[7] = {};
+
+    for (int i = 0; i < 6; i++) Expect(PMOD_Color_Sensor_Init(&sensors[i]) == I2C_BUS_OK, "init of each sensor");
+    Expect(PMOD_Color_Sensor_Init(&sensors[6]) == I2C_BUS_ERROR_NACK, "init of the missing sensor");
+
+    accesses.clear();
+    uint32_t ready = PMOD_Color_Sample_Sensors(sensors, data, 7, 3);
+
+    // The first round visits the n-th sensor of each bus in turn. A visit is a run of transfers to
+    // the sensors of one bus and channel
+    std::vector<std::pair<int, uint8_t>> visits;
+
+    for (const Access &access : accesses)
+    {
+        if (access.mux_write) continue;
+
+        std::pair<int, uint8_t> visit = { access.bus, access.control };
+        if (visits.empty() || (visits.back() != visit)) visits.push_back(visit);
+    }
+
+    const std::pair<int, uint8_t> expected_order[7] =
+    {
+        { 0, 0x01 }, { 1, 0x01 }, { 0, 0x02 }, { 1, 0x02 }, { 0, 0x04 }, { 1, 0x04 }, { 0, 0x08 }
+    };
+
+    Expect(visits.size() >= 7, "every sensor is visited");
+
+    for (size_t k = 0; (k < 7) && (k < visits.size()); k++)
+    {
+        Expect(visits[k] == expected_order[k], "the sensors of the two buses are visited in turn");
+    }
+
+    Expect(ready == 0x3B, "the ready sensors are returned without the slow and the missing one");
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (ready & (1u << i)) Expect(Same_Data(data[i], Sensor_Values(i / 4, i % 4)), "the data of each sensor");
+    }
+
+    // A later call with more rounds reads the slow sensor too
+    ready = PMOD_Color_Sample_Sensors(sensors, data, 7, 1000);
+
+    Expect(ready == 0x3F, "the slow sensor is read by a later call");
+    Expect(Same_Data(data[2], Sensor_Values(0, 2)), "the data of the slow sensor");
+    Expect((check_buses[0].sim.collision_count == 0) && (check_buses[1].sim.collision_count == 0), "no collision");
+
+    std::printf("Sample_Sensors: 7 sensors on 2 buses, visits in turn, slow and missing sensors: %s\n",
+                (failures == before) ? "passed" : "FAILED");
+}
+
+} // namespace
+
+int main()
+{
+    Check_Init();
+    Check_Channel_Cache();
+    Check_Sample_Sensors();
+
+    std::printf("PMOD_Color: %s\n", failures ? "FAILED" : "passed");
+
+    return failures ? 1 : 0;
+}
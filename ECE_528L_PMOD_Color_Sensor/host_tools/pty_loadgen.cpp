@@ -0,0 +1,322 @@
+/**
+ * @file pty_loadgen.cpp
+ * @brief Simulates many boards on pseudo-terminals, for load tests of telemetry_collector.
+ *
+ * Every simulated board is a pty that carries the serial output of main.c at the full rate of the
+ * UART: sample lines (r=XXXX g=XXXX b=XXXX), with a detection line, and now and then a game event,
+ * each time a simulated object is presented. With --format binary, samples and events are sent as
+ * Board_Protocol frames instead, and with --format mixed, samples are frames and events are text
+ * lines, as a board that moves to the binary protocol one message at a time. The output is paced from one thread on a fixed tick so
+ * that each board sends baud / 10 bytes per second, and lines that the pty cannot take yet are kept
+ * and sent later rather than dropped. At the end, the number of samples and events sent is printed,
+ * to be compared with the totals of the collector.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR pty_loadgen.cpp Board_Protocol.o -o pty_loadgen
+ *
+ * Usage: pty_loadgen BOARDS [options]
+ *   --ports FILE         Write the pty paths to FILE, one per line (default: ports.txt)
+ *   --baud RATE          Simulated baud rate (default: 115200)
+ *   --seconds S          Duration of the load (default: 30)
+ *   --start-delay S      Wait before sending, so that the collector can open the ptys (default: 2)
+ *   --format F           text, binary or mixed (default: text)
+ *
+ * Example:
+ *   ./pty_loadgen 300 --seconds 30 &
+ *   sleep 1; ./telemetry_collector --ports-file ports.txt --seconds 34 --out /tmp/collected
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "inc/Board_Protocol.h"
+#include "inc/Simon_Game.h"
+
+namespace
+{
+
+// Interval between two writes to each pty
+constexpr uint64_t TICK_US = 10000;
+
+// Samples per simulated object, and the colors of the objects
+constexpr uint32_t OBJECT_SAMPLES = 400;
+const char *const DETECTIONS[3] = { "GREEN\n", "RED\n", "YELLOW\n" };
+const char *const EVENTS[3] = { "Correct step!\n", "ACCESS GRANTED!\n", "Wrong! Restarting...\n" };
+const uint8_t EVENT_RESULTS[3] = { SIMON_GAME_STEP, SIMON_GAME_COMPLETE, SIMON_GAME_WRONG };
+
+enum class Format
+{
+    Text,
+    Binary,
+    Mixed
+};
+
+struct Simulated_Board
+{
+    int master = -1;
+    std::string path;
+    uint32_t random_state;
+    uint32_t sample = 0;
+    uint8_t sequence = 0;
+    uint64_t credit = 0;                    // Bytes that may be sent at this point of the run
+    std::string pending;                    // Bytes generated but not yet accepted by the pty
+    uint64_t bytes = 0;
+    uint64_t samples = 0;
+    uint64_t events = 0;
+    uint64_t blocked = 0;
+};
+
+uint64_t Monotonic_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// xorshift32 pseudo-random number generator, as in the firmware
+uint32_t Random(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void Append_Frame(Simulated_Board &board, const uint8_t *frame, int length)
+{
+    board.pending.append((const char *)frame, (size_t)length);
+}
+
+// Appends the next line or frame of a board: a sample, or a detection or game event once per object
+void Generate_Line(Simulated_Board &board, Format format)
+{
+    char line[32];
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+    uint32_t object = board.sample / OBJECT_SAMPLES;
+    uint32_t phase = board.sample % OBJECT_SAMPLES;
+
+    if (phase == OBJECT_SAMPLES / 2)
+    {
+        if (format == Format::Binary) Append_Frame(board, frame, Board_Protocol_Encode_Detection(board.sequence++, (uint8_t)(object % 3), frame, sizeof(frame)));
+        else board.pending += DETECTIONS[object % 3];
+        board.events++;
+    }
+    else if ((phase == OBJECT_SAMPLES / 2 + 1) && (object % 4 == 3))
+    {
+        if (format == Format::Binary) Append_Frame(board, frame, Board_Protocol_Encode_Game(board.sequence++, EVENT_RESULTS[(object / 4) % 3], frame, sizeof(frame)));
+        else board.pending += EVENTS[(object / 4) % 3];
+        board.events++;
+    }
+
+    uint32_t noise = Random(board.random_state);
+    uint16_t base = (phase < OBJECT_SAMPLES / 4) ? 0x0800 : (uint16_t)(0x2000 + (object % 3) * 0x1800);
+    PMOD_Color_Data data;
+
+    data.red = (uint16_t)(base + (noise & 0xFF));
+    data.green = (uint16_t)(base / 2 + ((noise >> 8) & 0xFF));
+    data.blue = (uint16_t)(0x0400 + ((noise >> 16) & 0xFF));
+    data.clear = (uint16_t)(data.red + data.green + data.blue);
+
+    if (format == Format::Text)
+    {
+        int length = std::snprintf(line, sizeof(line), "r=%04x g=%04x b=%04x\r\n", data.red, data.green, data.blue);
+        board.pending.append(line, length);
+    }
+    else
+    {
+        // The simulated board takes a sample every 3 ms
+        Append_Frame(board, frame, Board_Protocol_Encode_Sample(board.sequence++, board.sample * 3, &data, frame, sizeof(frame)));
+    }
+
+    board.samples++;
+    board.sample++;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: pty_loadgen BOARDS [options] (see the header of pty_loadgen.cpp)\n");
+        return 1;
+    }
+
+    size_t count = std::strtoul(argv[1], nullptr, 10);
+    std::string ports_path = "ports.txt";
+    long baud = 115200;
+    double seconds = 30.0;
+    double start_delay = 2.0;
+    Format format = Format::Text;
+
+    for (int i = 2; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--ports") && (i + 1 < argc)) ports_path = argv[++i];
+        else if ((option == "--baud") && (i + 1 < argc)) baud = std::atol(argv[++i]);
+        else if ((option == "--seconds") && (i + 1 < argc)) seconds = std::atof(argv[++i]);
+        else if ((option == "--start-delay") && (i + 1 < argc)) start_delay = std::atof(argv[++i]);
+        else if ((option == "--format") && (i + 1 < argc))
+        {
+            std::string name = argv[++i];
+
+            if (name == "text") format = Format::Text;
+            else if (name == "binary") format = Format::Binary;
+            else if (name == "mixed") format = Format::Mixed;
+            else
+            {
+                std::fprintf(stderr, "unknown format %s\n", name.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    struct rlimit limit;
+    if ((getrlimit(RLIMIT_NOFILE, &limit) == 0) && (limit.rlim_cur < count + 64))
+    {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, count + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::vector<Simulated_Board> boards(count);
+    FILE *ports = std::fopen(ports_path.c_str(), "w");
+
+    if (!ports)
+    {
+        std::fprintf(stderr, "cannot write %s\n", ports_path.c_str());
+        return 1;
+    }
+
+    for (size_t b = 0; b < count; b++)
+    {
+        Simulated_Board &board = boards[b];
+
+        board.master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if ((board.master < 0) || (grantpt(board.master) != 0) || (unlockpt(board.master) != 0))
+        {
+            std::fprintf(stderr, "cannot create pty %zu: %s\n", b, std::strerror(errno));
+            return 1;
+        }
+
+        // Raw mode, so that the line discipline neither translates nor echoes the data
+        struct termios settings;
+        tcgetattr(board.master, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(board.master, TCSANOW, &settings);
+
+        board.path = ptsname(board.master);
+        board.random_state = 0x9E3779B9u ^ (uint32_t)(b * 2654435761u);
+        if (board.random_state == 0) board.random_state = 1;
+        board.sample = (uint32_t)(b * 37) % OBJECT_SAMPLES;
+        std::fprintf(ports, "%s\n", board.path.c_str());
+    }
+
+    std::fclose(ports);
+    std::printf("%zu boards at %ld baud, pty paths in %s\n", count, baud, ports_path.c_str());
+    std::fflush(stdout);
+
+    usleep((useconds_t)(start_delay * 1e6));
+
+    uint64_t bytes_per_second = (uint64_t)baud / 10;
+    uint64_t start_us = Monotonic_us();
+    uint64_t end_us = start_us + (uint64_t)(seconds * 1e6);
+    uint64_t next_us = start_us;
+    uint64_t late_ticks = 0;
+
+    while (true)
+    {
+        uint64_t now_us = Monotonic_us();
+        if (now_us >= end_us) break;
+
+        if (now_us > next_us + TICK_US) late_ticks++;
+
+        uint64_t credit = (now_us - start_us) * bytes_per_second / 1000000;
+
+        for (Simulated_Board &board : boards)
+        {
+            // Generate whole lines and frames up to the byte budget of the board
+            while (board.bytes + board.pending.size() < credit) Generate_Line(board, format);
+
+            if (board.pending.empty()) continue;
+
+            ssize_t written = write(board.master, board.pending.data(), board.pending.size());
+
+            if (written > 0)
+            {
+                board.bytes += (uint64_t)written;
+                board.pending.erase(0, (size_t)written);
+            }
+
+            if (!board.pending.empty()) board.blocked++;
+        }
+
+        next_us += TICK_US;
+        now_us = Monotonic_us();
+        if (next_us > now_us) usleep((useconds_t)(next_us - now_us));
+    }
+
+    // Let the last lines drain before the ptys are closed
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        bool pending = false;
+
+        for (Simulated_Board &board : boards)
+        {
+            if (board.pending.empty()) continue;
+
+            ssize_t written = write(board.master, board.pending.data(), board.pending.size());
+            if (written > 0)
+            {
+                board.bytes += (uint64_t)written;
+                board.pending.erase(0, (size_t)written);
+            }
+            pending |= !board.pending.empty();
+        }
+
+        if (!pending) break;
+        usleep(10000);
+    }
+
+    usleep(500000);
+
+    double elapsed = (Monotonic_us() - start_us) * 1e-6;
+    uint64_t bytes = 0, samples = 0, events = 0, blocked = 0, unsent = 0;
+
+    for (Simulated_Board &board : boards)
+    {
+        bytes += board.bytes;
+        samples += board.samples;
+        events += board.events;
+        blocked += board.blocked;
+        unsent += board.pending.size();
+        close(board.master);
+    }
+
+    std::printf("sent %" PRIu64 " samples and %" PRIu64 " events, %.2f MB in %.1f s (%.0f bytes/s per board, target %" PRIu64 ")\n",
+                samples, events, bytes * 1e-6, elapsed, bytes / (seconds * count), bytes_per_second);
+    std::printf("%" PRIu64 " writes blocked by a full pty, %" PRIu64 " late ticks, %" PRIu64 " bytes unsent\n", blocked, late_ticks, unsent);
+
+    return (unsent > 0) ? 1 : 0;
+}
@@ -0,0 +1,875 @@
+/**
+ * @file simon_farm.cpp
+ * @brief Monte Carlo simulation farm for the Simon Says game.
+ *
+ * The farm plays millions of rounds of the game with the firmware's own Simon_Game and Color_Classifier
+ * modules. Each round generates a pattern, then runs the main loop of main.c in simulated time:
+ * sample the sensor, classify, hold a detected color for 1 s (Hold_Color), check it against the pattern
+ * and wait for the feedback delays. The sensor is a noise model in the calibrated color space, and the
+ * player is scripted: after a random gap they present the next color of the pattern (or a wrong color
+ * with a configurable probability), and remove it a reaction time after the white feedback LED, or
+ * after their patience runs out when no feedback comes.
+ *
+ * In the restart mode of Simon_Game, a round ends when the pattern is completed or the game restarts.
+ * A failed round in which the player never presented a wrong color is a false fail. The wrong checks
+ * behind it are split into misreads (the classified color differs from the presented object, or no
+ * object was presented) and re-reads (the object of an already accepted step was still in front of
+ * the sensor after the feedback delay). The expected time to ACCESS GRANTED counts each failed attempt
+ * with the restart delays of main.c (pink LED, motor shake and Show_Pattern).
+ *
+ * In the continuous mode, a round ends only when the pattern has been found in the stream of color
+ * events. As in main.c, every sample goes through Simon_Game_Debounce, an event is checked at once
+ * without Hold_Color, and the sensor is still sampled during the feedback delays (Watch_Delay_ms), so
+ * that an object removed meanwhile is released. A miss costs its short feedback delay. After a miss, or when their last color did not
+ * grant access, the player presents the pattern again from its start.
+ *
+ * In both modes, the accepted colors go through Reaction_Stats as in main.c, and the farm prints the
+ * same "reaction ..." lines as the board: the reaction time of the player, the pipeline time of the
+ * firmware (Hold_Color or the debounce time) and the time of the completed rounds.
+ *
+ * In the levels mode, each round plays one level of Simon_Levels, the progressive game of main.c
+ * (PLAY_LEVELS): a fresh game is advanced to a level of 4 to 256 colors, chosen in turn from
+ * LEVEL_LENGTHS, and the player presents the whole pattern at the pace of the level, since the time
+ * allowed for each color shrinks with the length. Every sample goes straight to Simon_Levels_Update,
+ * without feedback delays, as in the low-latency path of main.c. A level fails on a wrong color or
+ * when a color comes too late, which shows when the sampling period cannot keep up with the level.
+ * The packed pattern is also compared with a plain copy as it grows.
+ *
+ * Every round is seeded from the global seed and its round number, and the simulation of a round
+ * uses only stack memory, so the results are identical for any number of threads.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Simon_Game.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Simon_Levels.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Reaction_Stats.c
+ *   g++ -std=c++17 -O2 -pthread -I../ECE528L_PMOD_COLOR/PMOD_COLOR simon_farm.cpp Color_Classifier.o Simon_Game.o Simon_Levels.o Reaction_Stats.o -o simon_farm
+ *
+ * Usage: simon_farm [options]
+ *   --rounds N           Number of rounds (default: 1000000)
+ *   --threads N          Number of worker threads (default: number of cores)
+ *   --seed N             Global seed (default: 528)
+ *   --noise SIGMA        Standard deviation of the sensor noise in calibrated counts (default: 600)
+ *   --mistake P          Probability that the player presents a wrong color (default: 0)
+ *   --period-ms T        Sampling period of the main loop (default: 50, or 2.4 in the levels mode)
+ *   --reaction-ms A B    Range of the time to remove an object after the feedback (default: 200 600)
+ *   --mode MODE          restart, continuous or levels (default: restart)
+ *   --oversample K       Samples averaged per classification in the levels mode (default: SIMON_LEVELS_OVERSAMPLING)
+ *   --spread S           Scale of the brightness (+-20%) and tint (+-10%) variation of the objects (default: 1)
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "inc/Color_Classifier.h"
+#include "inc/Simon_Game.h"
+#include "inc/Simon_Levels.h"
+#include "inc/Reaction_Stats.h"
+#include "inc/Adaptive_Rate.h"
+#include "Work_Stealing_Pool.h"
+
+namespace
+{
+
+// Delays of the main loop in main.c, in microseconds
+constexpr uint64_t HOLD_US = 1000000;
+constexpr uint64_t STEP_FEEDBACK_US = 500000;
+constexpr uint64_t MISS_FEEDBACK_US = 300000;
+
+// Delays of main.c between a wrong check and the next attempt: pink LED, motor shake and Show_Pattern
+constexpr uint64_t RESTART_US = 2500000 + 500000 + 4000000 + 4000000;
+
+// Rounds that have not ended after this much simulated time are counted as stalled
+constexpr uint64_t ROUND_LIMIT_US = 120000000;
+
+// Round duration histogram: 250 ms bins, the last bin collects everything longer
+constexpr uint64_t DURATION_BIN_US = 250000;
+constexpr int DURATION_BINS = 241;
+
+// Causes of a wrong check
+constexpr uint8_t CAUSE_MISREAD = 0x01;
+constexpr uint8_t CAUSE_REREAD = 0x02;
+constexpr uint8_t CAUSE_PLAYER = 0x04;
+
+// Farm mode of the levels game, next to the modes of Simon_Game
+constexpr uint8_t MODE_LEVELS = 0xFF;
+
+// Pattern lengths played in the levels mode, in turn
+constexpr uint16_t LEVEL_LENGTHS[] = { 4, 8, 16, 32, 64, 128, 256 };
+constexpr int LEVEL_COUNT = sizeof(LEVEL_LENGTHS) / sizeof(LEVEL_LENGTHS[0]);
+
+// Detection latency histogram of the levels mode: 1 ms bins
+constexpr int LATENCY_BINS = 1000;
+
+// Causes of a failed level
+constexpr int LEVEL_PASS = 0;
+constexpr int LEVEL_TIMEOUT = 1;
+constexpr int LEVEL_MISREAD = 2;
+constexpr int LEVEL_PLAYER = 3;
+
+constexpr uint64_t CHUNK_ROUNDS = 4096;
+constexpr double PI = 3.14159265358979323846;
+
+// Calibrated colors of the objects and of the empty background
+const double COLOR_VALUES[4][3] =
+{
+    { 0x1800, 0x4C00, 0x2400 },     // Green
+    { 0x6400, 0x1C00, 0x1A00 },     // Red
+    { 0x6000, 0x5600, 0x2000 },     // Yellow
+    { 0x0C00, 0x0D00, 0x0B00 },     // Background
+};
+
+struct Farm_Config
+{
+    uint64_t rounds = 1000000;
+    uint64_t seed = 528;
+    double noise = 600.0;
+    double mistake = 0.0;
+    uint64_t period_us = 0;
+    uint64_t reaction_min_us = 200000;
+    uint64_t reaction_max_us = 600000;
+    uint64_t gap_min_us = 300000;
+    uint64_t gap_max_us = 1200000;
+    uint64_t patience_us = 4000000;
+    uint64_t ramp_min_us = 20000;
+    uint64_t ramp_max_us = 60000;
+    uint8_t mode = SIMON_GAME_MODE_RESTART;
+    int oversample = SIMON_LEVELS_OVERSAMPLING;
+    double spread = 1.0;
+};
+
+struct Farm_Stats
+{
+    uint64_t rounds = 0;
+    uint64_t successes = 0;
+    uint64_t fails = 0;
+    uint64_t stalls = 0;
+    uint64_t player_fails = 0;
+    uint64_t false_fails = 0;
+    uint64_t false_fails_misread = 0;
+    uint64_t false_fails_reread = 0;
+    uint64_t checks = 0;
+    uint64_t checks_misread = 0;
+    uint64_t checks_reread = 0;
+    uint64_t checks_player = 0;
+    uint64_t double_credits = 0;
+    uint64_t misses = 0;
+    uint64_t simulated_us = 0;
+    uint64_t duration_sum_us[2] = {};
+    uint64_t duration[2][DURATION_BINS] = {};
+
+    // Levels mode: outcomes of each level, and latency from the presentation of an object to its event
+    uint64_t level_outcomes[LEVEL_COUNT][4] = {};
+    uint64_t level_latency[LEVEL_COUNT][LATENCY_BINS] = {};
+    uint64_t packing_errors = 0;
+
+    // Restart and continuous modes: the statistics of main.c
+    Reaction_Stats reaction;
+
+    Farm_Stats() { Reaction_Stats_Init(&reaction); }
+
+    static void Merge_Histogram(Reaction_Histogram &into, const Reaction_Histogram &other)
+    {
+        if (other.count == 0) return;
+        into.min_ms = (into.count == 0) ? other.min_ms : std::min(into.min_ms, other.min_ms);
+        into.max_ms = std::max(into.max_ms, other.max_ms);
+        into.count += other.count;
+        into.sum_ms += other.sum_ms;
+        for (int bin = 0; bin < REACTION_STATS_BINS; bin++) into.bins[bin] = (uint32_t)std::min<uint64_t>((uint64_t)into.bins[bin] + other.bins[bin], UINT32_MAX);
+    }
+
+    void Merge(const Farm_Stats &other)
+    {
+        rounds += other.rounds;
+        successes += other.successes;
+        fails += other.fails;
+        stalls += other.stalls;
+        player_fails += other.player_fails;
+        false_fails += other.false_fails;
+        false_fails_misread += other.false_fails_misread;
+        false_fails_reread += other.false_fails_reread;
+        checks += other.checks;
+        checks_misread += other.checks_misread;
+        checks_reread += other.checks_reread;
+        checks_player += other.checks_player;
+        double_credits += other.double_credits;
+        misses += other.misses;
+        simulated_us += other.simulated_us;
+
+        for (int outcome = 0; outcome < 2; outcome++)
+        {
+            duration_sum_us[outcome] += other.duration_sum_us[outcome];
+            for (int bin = 0; bin < DURATION_BINS; bin++) duration[outcome][bin] += other.duration[outcome][bin];
+        }
+
+        for (int level = 0; level < LEVEL_COUNT; level++)
+        {
+            for (int outcome = 0; outcome < 4; outcome++) level_outcomes[level][outcome] += other.level_outcomes[level][outcome];
+            for (int bin = 0; bin < LATENCY_BINS; bin++) level_latency[level][bin] += other.level_latency[level][bin];
+        }
+        packing_errors += other.packing_errors;
+
+        Merge_Histogram(reaction.reaction, other.reaction.reaction);
+        Merge_Histogram(reaction.pipeline, other.reaction.pipeline);
+        Merge_Histogram(reaction.round, other.reaction.round);
+        if ((other.reaction.best_round_ms > 0) && ((reaction.best_round_ms == 0) || (other.reaction.best_round_ms < reaction.best_round_ms)))
+        {
+            reaction.best_round_ms = other.reaction.best_round_ms;
+        }
+        reaction.fails += other.reaction.fails;
+        reaction.misses += other.reaction.misses;
+    }
+};
+
+// splitmix64, used to derive the seed of each round
+uint64_t Split_Mix(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// xorshift64* generator with a Box-Muller normal distribution, so the sequence does not depend on the standard library
+class Round_Random
+{
+public:
+    explicit Round_Random(uint64_t seed) : state_(seed ? seed : 1) {}
+
+    uint64_t Next()
+    {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1DULL;
+    }
+
+    double Uniform() { return (Next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    uint64_t Range(uint64_t low, uint64_t high) { return low + (uint64_t)(Uniform() * (double)(high - low)); }
+
+    double Normal()
+    {
+        if (has_spare_)
+        {
+            has_spare_ = false;
+            return spare_;
+        }
+
+        double u1 = std::max(Uniform(), 1e-300);
+        double u2 = Uniform();
+        double radius = std::sqrt(-2.0 * std::log(u1));
+
+        spare_ = radius * std::sin(2.0 * PI * u2);
+        has_spare_ = true;
+        return radius * std::cos(2.0 * PI * u2);
+    }
+
+private:
+    uint64_t state_;
+    double spare_ = 0.0;
+    bool has_spare_ = false;
+};
+
+// Light in front of the sensor: a ramp from the previous scene to the current one
+struct Scene
+{
+    double from[3] = {};
+    double to[3] = {};
+    uint64_t change_us = 0;
+    uint64_t ramp_us = 1;
+
+    void Value(uint64_t t, double value[3]) const
+    {
+        double blend = (t <= change_us) ? 0.0 : std::min(1.0, (double)(t - change_us) / ramp_us);
+        for (int c = 0; c < 3; c++) value[c] = from[c] + (to[c] - from[c]) * blend;
+    }
+
+    void Change(uint64_t t, const double target[3], uint64_t ramp)
+    {
+        double current[3];
+        Value(t, current);
+
+        for (int c = 0; c < 3; c++)
+        {
+            from[c] = current[c];
+            to[c] = target[c];
+        }
+
+        change_us = t;
+        ramp_us = ramp;
+    }
+};
+
+// Classifies the average of count noisy samples of the scene taken every period_us from time t. Like the
+// sensor, each sample is an integer count, and like the Oversampler, the average is rounded to nearest
+Color_t Classify_Scene(const Scene &scene, double noise, Round_Random &random, uint64_t t, int count, uint64_t period_us)
+{
+    uint32_t sum[3] = {};
+    uint16_t channel[3];
+
+    for (int i = 0; i < count; i++)
+    {
+        double value[3];
+        scene.Value(t + i * period_us, value);
+
+        for (int c = 0; c < 3; c++)
+        {
+            double noisy = value[c] + noise * random.Normal();
+            sum[c] += (uint32_t)std::min(65535.0, std::max(0.0, noisy));
+        }
+    }
+
+    for (int c = 0; c < 3; c++) channel[c] = (uint16_t)((sum[c] + count / 2) / count);
+
+    return Color_Classifier_Classify(&Color_Classifier_Default_Params, channel[0], channel[1], channel[2]);
+}
+
+// Presents an object of a color to the sensor, with the brightness and tint of a real object
+void Present_Object(Scene &scene, const Farm_Config &config, Round_Random &random, uint64_t t, Color_t color)
+{
+    double target[3];
+    double brightness = 1.0 + config.spread * (0.4 * random.Uniform() - 0.2);
+    for (int c = 0; c < 3; c++) target[c] = COLOR_VALUES[color][c] * brightness * (1.0 + config.spread * (0.2 * random.Uniform() - 0.1));
+
+    scene.Change(t, target, random.Range(config.ramp_min_us, config.ramp_max_us));
+}
+
+// Scripted player
+struct Player
+{
+    uint8_t step = 0;
+    bool presenting = false;
+    bool credited = false;
+    bool made_mistake = false;
+    Color_t color = COLOR_UNKNOWN;
+    uint64_t present_us = 0;
+    uint64_t remove_us = 0;
+};
+
+class Round
+{
+public:
+    Round(const Farm_Config &config, uint64_t seed) : config_(config), random_(seed)
+    {
+        Simon_Game_Init(&game_, (uint32_t)(seed >> 32) ^ (uint32_t)seed);
+        Simon_Game_Set_Mode(&game_, config_.mode);
+        Simon_Game_Generate_Pattern(&game_);
+
+        scene_.Change(0, COLOR_VALUES[COLOR_UNKNOWN], 1);
+        player_.present_us = random_.Range(config_.gap_min_us, config_.gap_max_us);
+    }
+
+    // Plays the round and adds its outcome to the statistics
+    void Play(Farm_Stats &stats)
+    {
+        uint64_t t = 0;
+        int result = SIMON_GAME_IGNORED;
+
+        // Causes of the consecutive wrong checks since the last correct one
+        uint8_t wrong_causes = 0;
+
+        // The round starts at the end of the pattern display
+        Reaction_Stats_Start_Round(&stats.reaction, 0);
+
+        while (t < ROUND_LIMIT_US)
+        {
+            Advance_Player(t);
+            Color_t detected = Classify(t);
+            t += config_.period_us;
+
+            // Time the color was first seen, as main.c computes it
+            uint64_t detected_us = t;
+
+            if (config_.mode == SIMON_GAME_MODE_CONTINUOUS)
+            {
+                detected = Simon_Game_Debounce(&game_, detected, (uint32_t)config_.period_us);
+                detected_us = t - game_.debouncer.stable_us;
+            }
+
+            if (detected == COLOR_UNKNOWN)
+            {
+                continue;
+            }
+
+            // The cause of a wrong check depends on what was in front of the sensor when it was sampled
+            bool object_matches = player_.presenting && (player_.color == detected);
+            bool object_credited = player_.presenting && player_.credited;
+
+            Color_t expected = game_.pattern[game_.index];
+
+            if (config_.mode == SIMON_GAME_MODE_CONTINUOUS)
+            {
+                result = Simon_Game_Check(&game_, detected);
+            }
+            else
+            {
+                // Hold_Color, then CheckPattern
+                t += HOLD_US;
+                Advance_Player(t);
+                result = Simon_Game_Check(&game_, detected);
+            }
+            stats.checks++;
+
+            if (detected != expected)
+            {
+                if (!object_matches)
+                {
+                    stats.checks_misread++;
+                    wrong_causes |= CAUSE_MISREAD;
+                }
+                else if (object_credited)
+                {
+                    stats.checks_reread++;
+                    wrong_causes |= CAUSE_REREAD;
+                }
+                else
+                {
+                    stats.checks_player++;
+                    wrong_causes |= CAUSE_PLAYER;
+                }
+            }
+            else
+            {
+                // The same object was accepted for two consecutive steps of the pattern
+                if (object_matches && object_credited) stats.double_credits++;
+
+                wrong_causes = 0;
+            }
+
+            if (result != SIMON_GAME_IGNORED)
+            {
+                On_Feedback(t, result);
+            }
+
+            if ((result == SIMON_GAME_STEP) || (result == SIMON_GAME_COMPLETE))
+            {
+                Reaction_Stats_Accept(&stats.reaction, (uint32_t)(detected_us / 1000), (uint32_t)(t / 1000));
+            }
+
+            if (result == SIMON_GAME_STEP)
+            {
+                t = Watch_Delay(t, STEP_FEEDBACK_US);
+            }
+            else if (result == SIMON_GAME_MISS)
+            {
+                stats.misses++;
+                Reaction_Stats_Miss(&stats.reaction);
+                t = Watch_Delay(t, MISS_FEEDBACK_US);
+            }
+            else if ((result == SIMON_GAME_COMPLETE) || (result == SIMON_GAME_WRONG))
+            {
+                break;
+            }
+        }
+
+        stats.rounds++;
+        stats.simulated_us += t;
+
+        if (t >= ROUND_LIMIT_US)
+        {
+            stats.stalls++;
+            return;
+        }
+
+        int outcome = (result == SIMON_GAME_COMPLETE) ? 0 : 1;
+        stats.duration[outcome][std::min<uint64_t>(t / DURATION_BIN_US, DURATION_BINS - 1)]++;
+        stats.duration_sum_us[outcome] += t;
+
+        if (outcome == 0)
+        {
+            stats.successes++;
+            Reaction_Stats_Complete(&stats.reaction, (uint32_t)(t / 1000));
+        }
+        else
+        {
+            stats.fails++;
+            Reaction_Stats_Fail(&stats.reaction);
+
+            if (player_.made_mistake)
+            {
+                stats.player_fails++;
+            }
+            else
+            {
+                stats.false_fails++;
+                if (wrong_causes & CAUSE_REREAD) stats.false_fails_reread++;
+                else if (wrong_causes & CAUSE_MISREAD) stats.false_fails_misread++;
+            }
+        }
+    }
+
+private:
+    Color_t Classify(uint64_t t)
+    {
+        return Classify_Scene(scene_, config_.noise, random_, t, 1, config_.period_us);
+    }
+
+    // Feedback delay of main.c (Watch_Delay_ms). In the continuous mode, the sensor is still sampled
+    // during the delay, so that the debouncer releases an object that the player removes meanwhile
+    uint64_t Watch_Delay(uint64_t t, uint64_t delay_us)
+    {
+        if (config_.mode != SIMON_GAME_MODE_CONTINUOUS) return t + delay_us;
+
+        for (uint64_t end = t + delay_us; t < end; t += config_.period_us)
+        {
+            Advance_Player(t);
+            if (Classify(t) == COLOR_UNKNOWN) Simon_Game_Debounce(&game_, COLOR_UNKNOWN, (uint32_t)config_.period_us);
+        }
+
+        return t;
+    }
+
+    // Applies the presentations and removals of the player up to time t
+    void Advance_Player(uint64_t t)
+    {
+        while (true)
+        {
+            if (!player_.presenting && (player_.present_us <= t))
+            {
+                Color_t expected = game_.pattern[player_.step];
+                Color_t color = expected;
+
+                if (random_.Uniform() < config_.mistake)
+                {
+                    color = (Color_t)((expected + 1 + random_.Range(0, 2)) % 3);
+                    player_.made_mistake = true;
+                }
+
+                Present_Object(scene_, config_, random_, player_.present_us, color);
+                player_.presenting = true;
+                player_.credited = false;
+                player_.color = color;
+                player_.remove_us = player_.present_us + config_.patience_us;
+            }
+            else if (player_.presenting && (player_.remove_us <= t))
+            {
+                scene_.Change(player_.remove_us, COLOR_VALUES[COLOR_UNKNOWN], random_.Range(config_.ramp_min_us, config_.ramp_max_us));
+                player_.presenting = false;
+                player_.present_us = player_.remove_us + random_.Range(config_.gap_min_us, config_.gap_max_us);
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    // The player sees the feedback LED and removes the object after their reaction time
+    void On_Feedback(uint64_t t, int result)
+    {
+        bool last_color = (player_.step == SIMON_GAME_PATTERN_LENGTH - 1);
+
+        if ((result == SIMON_GAME_MISS) || ((result == SIMON_GAME_STEP) && last_color && (config_.mode == SIMON_GAME_MODE_CONTINUOUS)))
+        {
+            // The player does not know how much of the pattern the board kept, so after a miss, or
+            // when the last color did not grant access, they present the pattern again from its start
+            player_.step = 0;
+        }
+        else if (result == SIMON_GAME_STEP)
+        {
+            player_.step = std::min<uint8_t>(player_.step + 1, SIMON_GAME_PATTERN_LENGTH - 1);
+        }
+
+        if (player_.presenting)
+        {
+            player_.credited = true;
+            player_.remove_us = std::min(player_.remove_us, t + random_.Range(config_.reaction_min_us, config_.reaction_max_us));
+        }
+    }
+
+    const Farm_Config &config_;
+    Round_Random random_;
+    Simon_Game game_;
+    Scene scene_;
+    Player player_;
+};
+
+// One level of the levels game, played by a player at the pace of the level
+class Levels_Round
+{
+public:
+    Levels_Round(const Farm_Config &config, uint64_t seed, int level) : config_(config), random_(seed), level_(level)
+    {
+        Simon_Levels_Init(&levels_, (uint32_t)(seed >> 32) ^ (uint32_t)seed);
+
+        // Grow the pattern to the length of the level, and check that the packing keeps every color
+        Color_t plain[SIMON_LEVELS_MAX_LENGTH];
+        for (uint16_t i = 0; i < levels_.length; i++) plain[i] = Simon_Levels_Get_Color(&levels_, i);
+
+        while (levels_.length < LEVEL_LENGTHS[level])
+        {
+            Simon_Levels_Next_Level(&levels_);
+            plain[levels_.length - 1] = Simon_Levels_Get_Color(&levels_, levels_.length - 1);
+        }
+
+        for (uint16_t i = 0; i < levels_.length; i++)
+        {
+            if ((plain[i] != Simon_Levels_Get_Color(&levels_, i)) || (plain[i] > COLOR_YELLOW)) packing_errors_++;
+        }
+
+        scene_.Change(0, COLOR_VALUES[COLOR_UNKNOWN], 1);
+        Simon_Levels_Start_Input(&levels_);
+    }
+
+    void Play(Farm_Stats &stats)
+    {
+        const uint64_t window_us = levels_.timing.window_us;
+        uint64_t t = 0;
+        uint64_t next_us = Player_Gap(window_us);
+        uint64_t remove_us = 0;
+        bool presenting = false;
+        bool made_mistake = false;
+        uint16_t step = 0;
+        uint64_t present_times[SIMON_LEVELS_MAX_LENGTH];
+        Color_t color = COLOR_UNKNOWN;
+        int result = SIMON_GAME_IGNORED;
+
+        stats.packing_errors += packing_errors_;
+
+        while ((result != SIMON_GAME_COMPLETE) && (result != SIMON_GAME_WRONG))
+        {
+            // The player keeps presenting the pattern at the pace of the level, without waiting for feedback
+            if (!presenting && (t >= next_us) && (step < levels_.length))
+            {
+                color = Simon_Levels_Get_Color(&levels_, step);
+                if (random_.Uniform() < config_.mistake)
+                {
+                    color = (Color_t)((color + 1 + random_.Range(0, 2)) % 3);
+                    made_mistake = true;
+                }
+
+                Present_Object(scene_, config_, random_, next_us, color);
+                present_times[step] = next_us;
+                remove_us = next_us + Player_Hold(window_us);
+                presenting = true;
+                step++;
+            }
+            else if (presenting && (t >= remove_us))
+            {
+                scene_.Change(remove_us, COLOR_VALUES[COLOR_UNKNOWN], random_.Range(config_.ramp_min_us, config_.ramp_max_us));
+                next_us = remove_us + Player_Gap(window_us);
+                presenting = false;
+            }
+
+            // One output of the oversampler of main.c per iteration
+            uint64_t output_period_us = config_.period_us * config_.oversample;
+            Color_t detected = Classify_Scene(scene_, config_.noise, random_, t, config_.oversample, config_.period_us);
+            t += output_period_us;
+
+            uint16_t index = levels_.index;
+            result = Simon_Levels_Update(&levels_, detected, (uint32_t)output_period_us);
+
+            // Latency from the presentation of the object to its event
+            if (((result == SIMON_GAME_STEP) || (result == SIMON_GAME_COMPLETE)) && (index < step))
+            {
+                stats.level_latency[level_][std::min<uint64_t>((t - present_times[index]) / 1000, LATENCY_BINS - 1)]++;
+            }
+        }
+
+        int outcome = LEVEL_PASS;
+        if (result == SIMON_GAME_WRONG)
+        {
+            if (made_mistake) outcome = LEVEL_PLAYER;
+            else outcome = levels_.timed_out ? LEVEL_TIMEOUT : LEVEL_MISREAD;
+        }
+
+        stats.level_outcomes[level_][outcome]++;
+        stats.rounds++;
+        stats.simulated_us += t;
+    }
+
+private:
+    // Gap before the next object and time an object is held, as fractions of the window of the level
+    uint64_t Player_Gap(uint64_t window_us) { return random_.Range(window_us / 10, window_us * 3 / 10); }
+    uint64_t Player_Hold(uint64_t window_us) { return random_.Range(window_us / 4, window_us * 9 / 20); }
+
+    const Farm_Config &config_;
+    Round_Random random_;
+    int level_;
+    Simon_Levels levels_;
+    Scene scene_;
+    uint64_t packing_errors_ = 0;
+};
+
+uint64_t Percentile_us(const uint64_t *histogram, uint64_t count, double fraction)
+{
+    uint64_t target = (uint64_t)std::ceil(count * fraction);
+    uint64_t total = 0;
+
+    for (int bin = 0; bin < DURATION_BINS; bin++)
+    {
+        total += histogram[bin];
+        if ((total >= target) && (total > 0)) return (bin + 1) * DURATION_BIN_US;
+    }
+
+    return DURATION_BINS * DURATION_BIN_US;
+}
+
+void Print_Durations(const char *name, const uint64_t *histogram, uint64_t count)
+{
+    if (count == 0) return;
+
+    std::printf("%-8s duration: p10 <= %.2f s, p50 <= %.2f s, p90 <= %.2f s, p99 <= %.2f s\n", name,
+                Percentile_us(histogram, count, 0.10) * 1e-6, Percentile_us(histogram, count, 0.50) * 1e-6,
+                Percentile_us(histogram, count, 0.90) * 1e-6, Percentile_us(histogram, count, 0.99) * 1e-6);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    Farm_Config config;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--rounds") && (i + 1 < argc)) config.rounds = std::strtoull(argv[++i], nullptr, 10);
+        else if ((option == "--threads") && (i + 1 < argc)) threads = (unsigned)std::max(1, std::atoi(argv[++i]));
+        else if ((option == "--seed") && (i + 1 < argc)) config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if ((option == "--noise") && (i + 1 < argc)) config.noise = std::atof(argv[++i]);
+        else if ((option == "--mistake") && (i + 1 < argc)) config.mistake = std::atof(argv[++i]);
+        else if ((option == "--period-ms") && (i + 1 < argc)) config.period_us = std::max(1.0, std::atof(argv[++i]) * 1000.0);
+        else if ((option == "--spread") && (i + 1 < argc)) config.spread = std::atof(argv[++i]);
+        else if ((option == "--oversample") && (i + 1 < argc)) config.oversample = std::max(1, std::atoi(argv[++i]));
+        else if ((option == "--mode") && (i + 1 < argc))
+        {
+            std::string mode = argv[++i];
+            if (mode == "restart") config.mode = SIMON_GAME_MODE_RESTART;
+            else if (mode == "continuous") config.mode = SIMON_GAME_MODE_CONTINUOUS;
+            else if (mode == "levels") config.mode = MODE_LEVELS;
+            else
+            {
+                std::fprintf(stderr, "unknown mode %s\n", mode.c_str());
+                return 1;
+            }
+        }
+        else if ((option == "--reaction-ms") && (i + 2 < argc))
+        {
+            config.reaction_min_us = (uint64_t)(std::atof(argv[++i]) * 1000.0);
+            config.reaction_max_us = std::max<uint64_t>(config.reaction_min_us + 1, (uint64_t)(std::atof(argv[++i]) * 1000.0));
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // The levels game samples at the burst rate of Adaptive_Rate (main.c, Play_Levels)
+    if (config.period_us == 0)
+    {
+        config.period_us = (config.mode == MODE_LEVELS) ? (ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US) : 50000;
+    }
+
+    uint64_t chunks = (config.rounds + CHUNK_ROUNDS - 1) / CHUNK_ROUNDS;
+    std::vector<Farm_Stats> chunk_stats(chunks);
+    Work_Stealing_Pool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    pool.Parallel_For(chunks, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            uint64_t first = chunk * CHUNK_ROUNDS;
+            uint64_t last = std::min(config.rounds, first + CHUNK_ROUNDS);
+
+            for (uint64_t round = first; round < last; round++)
+            {
+                uint64_t seed = Split_Mix(config.seed ^ Split_Mix(round));
+
+                if (config.mode == MODE_LEVELS)
+                {
+                    Levels_Round level_round(config, seed, (int)(round % LEVEL_COUNT));
+                    level_round.Play(chunk_stats[chunk]);
+                }
+                else
+                {
+                    Round game_round(config, seed);
+                    game_round.Play(chunk_stats[chunk]);
+                }
+            }
+        }
+    });
+
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Merge in chunk order, so the totals do not depend on the scheduling
+    Farm_Stats stats;
+    for (const Farm_Stats &chunk : chunk_stats) stats.Merge(chunk);
+
+    double rounds = (double)std::max<uint64_t>(1, stats.rounds);
+    double fails = (double)std::max<uint64_t>(1, stats.fails);
+
+    if (config.mode == MODE_LEVELS)
+    {
+        std::printf("%llu levels, seed %llu, noise %.0f, mistake probability %.3f, period %.1f ms\n",
+                    (unsigned long long)stats.rounds, (unsigned long long)config.seed, config.noise, config.mistake,
+                    config.period_us * 1e-3);
+        std::printf("Colors  Show s  Window ms  Stable ms    Pass %%  Timeout %%  Misread %%  Player %%  Latency p50/p99 ms\n");
+
+        for (int level = 0; level < LEVEL_COUNT; level++)
+        {
+            Simon_Level_Timing timing;
+            const uint64_t *outcomes = stats.level_outcomes[level];
+            const uint64_t *latency = stats.level_latency[level];
+            double played = (double)std::max<uint64_t>(1, outcomes[0] + outcomes[1] + outcomes[2] + outcomes[3]);
+            uint64_t events = 0;
+            int p50 = 0;
+            int p99 = 0;
+
+            Simon_Levels_Get_Timing(LEVEL_LENGTHS[level], &timing);
+            for (int bin = 0; bin < LATENCY_BINS; bin++) events += latency[bin];
+            for (uint64_t total = 0; (p99 < LATENCY_BINS) && (total < (uint64_t)std::ceil(events * 0.99)); p99++) total += latency[p99];
+            for (uint64_t total = 0; (p50 < LATENCY_BINS) && (total < (uint64_t)std::ceil(events * 0.50)); p50++) total += latency[p50];
+
+            std::printf("%6u  %6.1f  %9u  %9.1f  %8.3f  %9.3f  %9.3f  %8.3f  %7d / %d\n", LEVEL_LENGTHS[level],
+                        LEVEL_LENGTHS[level] * (timing.show_on_ms + timing.show_off_ms) * 1e-3, timing.window_us / 1000,
+                        timing.stable_us * 1e-3, 100.0 * outcomes[LEVEL_PASS] / played, 100.0 * outcomes[LEVEL_TIMEOUT] / played,
+                        100.0 * outcomes[LEVEL_MISREAD] / played, 100.0 * outcomes[LEVEL_PLAYER] / played, p50, p99);
+        }
+
+        std::printf("packed pattern errors: %llu\n", (unsigned long long)stats.packing_errors);
+        std::printf("%.2f s on %u threads: %.0f levels/s, %.0fx real time\n", elapsed_s, pool.Thread_Count(),
+                    stats.rounds / elapsed_s, stats.simulated_us * 1e-6 / elapsed_s);
+        return stats.packing_errors ? 1 : 0;
+    }
+
+    std::printf("%llu rounds, %s mode, seed %llu, noise %.0f, mistake probability %.3f, period %.1f ms\n",
+                (unsigned long long)stats.rounds, (config.mode == SIMON_GAME_MODE_CONTINUOUS) ? "continuous" : "restart",
+                (unsigned long long)config.seed, config.noise, config.mistake, config.period_us * 1e-3);
+    std::printf("success %.3f%%, fail %.3f%%, stalled %.3f%%\n",
+                100.0 * stats.successes / rounds, 100.0 * stats.fails / rounds, 100.0 * stats.stalls / rounds);
+    std::printf("false-fail rate %.3f%% of rounds (%.1f%% of fails): %llu from misreads only, %llu involving a re-read\n",
+                100.0 * stats.false_fails / rounds, 100.0 * stats.false_fails / fails,
+                (unsigned long long)stats.false_fails_misread, (unsigned long long)stats.false_fails_reread);
+    std::printf("checks %llu: %llu misread, %llu re-read, %llu player errors, %llu double credits\n",
+                (unsigned long long)stats.checks, (unsigned long long)stats.checks_misread,
+                (unsigned long long)stats.checks_reread, (unsigned long long)stats.checks_player,
+                (unsigned long long)stats.double_credits);
+    Print_Durations("success", stats.duration[0], stats.successes);
+    Print_Durations("fail", stats.duration[1], stats.fails);
+    Reaction_Stats_Print(&stats.reaction);
+
+    // Attempts are independent, so the expected number of failed attempts before a success is fails / successes
+    if (stats.successes > 0)
+    {
+        double success_s = stats.duration_sum_us[0] * 1e-6 / stats.successes;
+        double fail_s = (stats.fails > 0) ? stats.duration_sum_us[1] * 1e-6 / stats.fails : 0.0;
+        double retries = (double)stats.fails / stats.successes;
+
+        std::printf("misses %.3f per round; expected time to ACCESS GRANTED %.2f s (%.3f restarts)\n",
+                    (double)stats.misses / rounds, success_s + retries * (fail_s + RESTART_US * 1e-6), retries);
+    }
+    std::printf("%.2f s on %u threads: %.0f rounds/s, %.0f rounds/s per thread, %.0fx real time\n",
+                elapsed_s, pool.Thread_Count(), stats.rounds / elapsed_s, stats.rounds / elapsed_s / pool.Thread_Count(),
+                stats.simulated_us * 1e-6 / elapsed_s);
+
+    return 0;
+}
@@ -0,0 +1,308 @@
+/**
+ * @file simon_matcher_check.cpp
+ * @brief Checks the continuous mode of Simon_Game against brute-force models on random streams.
+ *
+ * The matcher: for every pattern of green, red and yellow (generated with Simon_Game_Generate_Pattern
+ * until all 3^SIMON_GAME_PATTERN_LENGTH have appeared), the program feeds random streams of color
+ * events, including COLOR_UNKNOWN, to Simon_Game_Check in SIMON_GAME_MODE_CONTINUOUS. After every
+ * event, the result and the partial match of the game are compared with a brute-force matcher that
+ * keeps the whole stream of events:
+ *   - SIMON_GAME_IGNORED for COLOR_UNKNOWN,
+ *   - SIMON_GAME_COMPLETE exactly when the last SIMON_GAME_PATTERN_LENGTH events are the pattern,
+ *   - index equal to the longest end of the stream that is a proper start of the pattern,
+ *   - SIMON_GAME_STEP when that match is not empty, SIMON_GAME_MISS when it is.
+ * A clean presentation of the pattern after any stream must also complete it.
+ * Streams are drawn with three biases: uniform colors, colors that mostly follow the pattern with
+ * random errors (like a player with misreads), and long runs of one color.
+ *
+ * The debouncer: random runs of one detected color (10 ms to 600 ms, COLOR_UNKNOWN included) are
+ * sampled with a jittered period and fed to Simon_Game_Debounce. A sample must give an event exactly
+ * when its color has just been stable for SIMON_GAME_STABLE_US and differs from the last event, unless
+ * the background has been seen for SIMON_GAME_RELEASE_US since then.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Simon_Game.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR simon_matcher_check.cpp Simon_Game.o -o simon_matcher_check
+ *
+ * Usage: simon_matcher_check [--colors N] [--seed N]
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "inc/Simon_Game.h"
+
+namespace
+{
+
+constexpr int LENGTH = SIMON_GAME_PATTERN_LENGTH;
+
+// Longest end of the stream that is a start of the pattern, shorter than the pattern
+int Brute_Force_Match(const std::vector<Color_t> &stream, const Color_t *pattern)
+{
+    for (int length = std::min<int>(LENGTH - 1, (int)stream.size()); length > 0; length--)
+    {
+        bool match = true;
+        for (int i = 0; i < length && match; i++) match = (stream[stream.size() - length + i] == pattern[i]);
+        if (match) return length;
+    }
+    return 0;
+}
+
+bool Ends_With_Pattern(const std::vector<Color_t> &stream, const Color_t *pattern)
+{
+    if (stream.size() < (size_t)LENGTH) return false;
+    for (int i = 0; i < LENGTH; i++)
+    {
+        if (stream[stream.size() - LENGTH + i] != pattern[i]) return false;
+    }
+    return true;
+}
+
+Color_t Next_Color(int bias, const Simon_Game &game, int &cursor, Color_t previous, std::mt19937 &random)
+{
+    uint32_t draw = random() % 100;
+
+    if (draw < 5) return COLOR_UNKNOWN;
+
+    switch (bias)
+    {
+        case 0:
+            return (Color_t)(random() % 3);
+        case 1:
+        {
+            // A player presenting the pattern in a loop, with 15% wrong colors
+            Color_t color = game.pattern[cursor];
+            cursor = (cursor + 1) % LENGTH;
+            return (draw < 20) ? (Color_t)(random() % 3) : color;
+        }
+        default:
+            return ((draw < 70) && (previous != COLOR_UNKNOWN)) ? previous : (Color_t)(random() % 3);
+    }
+}
+
+// Reference of Simon_Game_Debounce over the whole sample history
+struct Sample
+{
+    Color_t color;
+    uint32_t elapsed_us;
+    bool event;
+};
+
+Color_t Brute_Force_Debounce(const std::vector<Sample> &samples)
+{
+    const Sample &sample = samples.back();
+
+    if (sample.color == COLOR_UNKNOWN) return COLOR_UNKNOWN;
+
+    // Time the color has been stable, up to and without the last sample
+    uint64_t stable_us = 0;
+    size_t i = samples.size();
+    while ((i > 0) && (samples[i - 1].color == sample.color)) stable_us += samples[--i].elapsed_us;
+    if ((stable_us < SIMON_GAME_STABLE_US) || (stable_us - sample.elapsed_us >= SIMON_GAME_STABLE_US)) return COLOR_UNKNOWN;
+
+    // The last event, unless a long enough run of background came after it
+    uint64_t unknown_us = 0;
+    while (i > 0)
+    {
+        const Sample &earlier = samples[--i];
+        if (earlier.color == COLOR_UNKNOWN)
+        {
+            unknown_us += earlier.elapsed_us;
+            if (unknown_us >= SIMON_GAME_RELEASE_US) return sample.color;
+            continue;
+        }
+        unknown_us = 0;
+        if (earlier.event) return (earlier.color == sample.color) ? COLOR_UNKNOWN : sample.color;
+    }
+    return sample.color;
+}
+
+uint64_t Check_Debouncer(uint64_t runs, std::mt19937 &random, uint64_t &events)
+{
+    static const uint32_t periods_us[] = { 10000, 20000, 50000 };
+    uint64_t mismatches = 0;
+
+    for (uint32_t period_us : periods_us)
+    {
+        Simon_Game game;
+        std::vector<Sample> samples;
+
+        Simon_Game_Init(&game, 1);
+        Simon_Game_Set_Mode(&game, SIMON_GAME_MODE_CONTINUOUS);
+
+        for (uint64_t run = 0; run < runs; run++)
+        {
+            Color_t color = (Color_t)(random() % COLOR_CLASSIFIER_NUM_COLORS);
+            int64_t duration_us = 10000 + (int64_t)(random() % 590000);
+
+            while (duration_us > 0)
+            {
+                uint32_t elapsed_us = period_us / 2 + (uint32_t)(random() % period_us);
+                samples.push_back({ color, elapsed_us, false });
+                duration_us -= elapsed_us;
+
+                Color_t event = Simon_Game_Debounce(&game, color, elapsed_us);
+                Color_t expected = Brute_Force_Debounce(samples);
+
+                samples.back().event = (event != COLOR_UNKNOWN);
+                if (event != COLOR_UNKNOWN) events++;
+                if (event != expected)
+                {
+                    if (mismatches < 10)
+                    {
+                        fprintf(stderr, "debouncer, period %u us, sample %zu: event %d (expected %d)\n",
+                                period_us, samples.size(), event, expected);
+                    }
+                    mismatches++;
+                }
+            }
+
+            // The reference only needs the end of the history, which a run longer than both times covers
+            if (samples.size() > 8192) samples.erase(samples.begin(), samples.end() - 4096);
+        }
+    }
+
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t colors_per_stream = 20000;
+    uint32_t seed = 528;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--colors") && (i + 1 < argc)) colors_per_stream = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && (i + 1 < argc)) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--colors N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::mt19937 random(seed);
+    std::set<std::vector<int>> patterns_seen;
+    uint64_t checked = 0;
+    uint64_t completes = 0;
+    uint64_t steps = 0;
+    uint64_t misses = 0;
+    uint64_t mismatches = 0;
+    int total_patterns = 1;
+
+    for (int i = 0; i < LENGTH; i++) total_patterns *= 3;
+
+    for (uint32_t game_seed = 1; (int)patterns_seen.size() < total_patterns; game_seed++)
+    {
+        Simon_Game game;
+        Simon_Game_Init(&game, game_seed);
+        Simon_Game_Generate_Pattern(&game);
+
+        std::vector<int> key(game.pattern, game.pattern + LENGTH);
+        if (!patterns_seen.insert(key).second) continue;
+
+        for (int bias = 0; bias < 3; bias++)
+        {
+            std::vector<Color_t> stream;
+            int cursor = 0;
+            Color_t previous = COLOR_UNKNOWN;
+
+            Simon_Game_Set_Mode(&game, SIMON_GAME_MODE_CONTINUOUS);
+
+            for (uint64_t n = 0; n < colors_per_stream; n++)
+            {
+                Color_t color = Next_Color(bias, game, cursor, previous, random);
+                int result = Simon_Game_Check(&game, color);
+                int expected_result;
+
+                if (color == COLOR_UNKNOWN)
+                {
+                    expected_result = SIMON_GAME_IGNORED;
+                }
+                else
+                {
+                    stream.push_back(color);
+                    previous = color;
+
+                    if (Ends_With_Pattern(stream, game.pattern)) expected_result = SIMON_GAME_COMPLETE;
+                    else if (Brute_Force_Match(stream, game.pattern) > 0) expected_result = SIMON_GAME_STEP;
+                    else expected_result = SIMON_GAME_MISS;
+                }
+
+                int expected_index = stream.empty() ? 0 : Brute_Force_Match(stream, game.pattern);
+
+                checked++;
+                if (result == SIMON_GAME_COMPLETE) completes++;
+                else if (result == SIMON_GAME_STEP) steps++;
+                else if (result == SIMON_GAME_MISS) misses++;
+
+                if ((result != expected_result) || (game.index != expected_index))
+                {
+                    if (mismatches < 10)
+                    {
+                        fprintf(stderr, "pattern %d%d%d%d, color %u: result %d (expected %d), index %d (expected %d)\n",
+                                game.pattern[0], game.pattern[1], game.pattern[2], game.pattern[3], (unsigned)n,
+                                result, expected_result, game.index, expected_index);
+                    }
+                    mismatches++;
+                }
+
+                // The brute-force matcher only needs the end of the stream
+                if (stream.size() > 4096) stream.erase(stream.begin(), stream.end() - LENGTH);
+            }
+
+            // Whatever the stream left behind, presenting the pattern completes it by its last color
+            bool completed = false;
+            for (int i = 0; (i < LENGTH) && !completed; i++)
+            {
+                completed = (Simon_Game_Check(&game, game.pattern[i]) == SIMON_GAME_COMPLETE);
+            }
+            if (!completed)
+            {
+                fprintf(stderr, "pattern %d%d%d%d: a clean presentation did not complete\n",
+                        game.pattern[0], game.pattern[1], game.pattern[2], game.pattern[3]);
+                mismatches++;
+            }
+        }
+    }
+
+    printf("%zu patterns, %llu events checked: %llu complete, %llu steps, %llu misses\n", patterns_seen.size(),
+           (unsigned long long)checked, (unsigned long long)completes, (unsigned long long)steps, (unsigned long long)misses);
+
+    uint64_t debounced_events = 0;
+    mismatches += Check_Debouncer(colors_per_stream, random, debounced_events);
+    printf("Debouncer: %llu runs of samples at 3 periods, %llu events\n",
+           (unsigned long long)colors_per_stream, (unsigned long long)debounced_events);
+
+    // Throughput of the automaton alone, on a stream with misreads
+    Simon_Game game;
+    std::vector<Color_t> stream(1 << 20);
+    uint64_t sink = 0;
+    int cursor = 0;
+
+    Simon_Game_Init(&game, seed);
+    Simon_Game_Generate_Pattern(&game);
+    for (Color_t &color : stream) color = Next_Color(1, game, cursor, COLOR_UNKNOWN, random);
+    Simon_Game_Set_Mode(&game, SIMON_GAME_MODE_CONTINUOUS);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 16; repeat++)
+    {
+        for (Color_t color : stream) sink += (uint64_t)Simon_Game_Check(&game, color);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%.1f million events/s (checksum %llu)\n", 16.0 * stream.size() / seconds * 1e-6, (unsigned long long)sink);
+    printf("%s\n", mismatches ? "MISMATCHES FOUND" : "The automaton and the debouncer match the brute-force models");
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,593 @@
+/**
+ * @file summary_dashboard.cpp
+ * @brief Rebuilds the sample dashboards of a board from its SUMMARY frames (see Sample_Summary.h).
+ *
+ * The serial output of a board built with TELEMETRY_SUMMARY set to 1 is read from a port, or from a file
+ * that holds a recording of it, and decoded with Board_Decoder. The windows are merged into buckets of
+ * --bucket ms with Board_Summary_Timeline, and the program prints:
+ *   - Totals: the windows, samples and raw samples, the frames lost, and the bytes received against
+ *     the bytes of a text line per sample.
+ *   - Dashboard: one line per bucket with the samples, the mean and standard deviation of the red,
+ *     green and blue channels, the share of each color and the raw samples.
+ * --csv writes the buckets with the min, max, mean and standard deviation of all four channels, in the
+ * columns of capture_store overview, and --raw writes the raw bursts as a capture (see Capture.h).
+ * --request sends SAMPLE_SUMMARY_BURST_REQUEST to the board when the port is opened.
+ *
+ * --check runs the firmware's Sample_Summary on two hours of synthetic samples with the timing of
+ * Adaptive_Rate: objects of each color held in front of the sensor, pauses without samples, a board
+ * clock that wraps, and bursts requested at random. The buckets rebuilt from the decoded frames must
+ * match the buckets of all the samples, every raw sample must be a sample of the board, every request
+ * must be followed by its burst, and the changes after a quiet window must start an anomaly burst, with
+ * about one anomaly burst per change. It then compares the bytes sent for several window lengths.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Sample_Summary.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Color_Classifier.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Fixed_Point.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR summary_dashboard.cpp Board_Summary.cpp Board_Decoder.cpp Sample_Summary.o Board_Protocol.o Color_Classifier.o Fixed_Point.o -o summary_dashboard
+ *
+ * Usage: summary_dashboard [options] INPUT
+ *   INPUT                    Serial port of the board, or a file with its recorded output
+ *   --baud RATE              Baud rate of a serial port (default: 115200)
+ *   --seconds S              Stop reading a serial port after S seconds (default: until SIGINT)
+ *   --save FILE              Also write the bytes read from the port to FILE, for later runs
+ *   --request                Request a raw burst when the port is opened
+ *   --bucket MS              Length of the dashboard buckets (default: 10000)
+ *   --csv FILE               Write the buckets
+ *   --raw FILE               Write the raw samples as a capture
+ *
+ *        summary_dashboard --check
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Board_Decoder.h"
+#include "Board_Summary.h"
+#include "inc/Color_Classifier.h"
+#include "inc/Sample_Summary.h"
+
+namespace
+{
+
+// Length of the text line that main.c prints for each sample without the summary
+constexpr size_t TEXT_LINE_SIZE = 22;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void Handle_Signal(int)
+{
+    stop_requested = 1;
+}
+
+// What was decoded from a board
+struct Received
+{
+    Board_Summary_Timeline timeline;
+    std::vector<Board_Sample> raw;
+    uint64_t windows = 0;
+    uint64_t bytes = 0;
+
+    explicit Received(uint64_t bucket_ms) : timeline(bucket_ms) {}
+
+    bool Handle(const Board_Event &event)
+    {
+        if (event.type == Board_Event_Type::Summary)
+        {
+            timeline.Add(event.summary);
+            windows++;
+        }
+        else if ((event.type == Board_Event_Type::Sample) && event.binary)
+        {
+            raw.push_back(event.sample);
+        }
+
+        return true;
+    }
+};
+
+void Print_Report(const Received &received, const Board_Decoder_Counters &counters)
+{
+    uint64_t samples = 0;
+    uint64_t raw = 0;
+
+    for (const Board_Summary_Bucket &bucket : received.timeline.Buckets())
+    {
+        samples += bucket.samples;
+        raw += bucket.raw_samples;
+    }
+
+    if (received.windows == 0)
+    {
+        std::printf("No SUMMARY frames: build the firmware with TELEMETRY_SUMMARY set to 1\n");
+        return;
+    }
+
+    std::printf("Windows: %llu with %llu samples, %llu sent raw, %llu frames lost\n", (unsigned long long)received.windows,
+                (unsigned long long)samples, (unsigned long long)raw, (unsigned long long)counters.lost_frames);
+    std::printf("Bytes: %llu received, %llu for a text line per sample (%.1fx less)\n", (unsigned long long)counters.bytes,
+                (unsigned long long)(samples * TEXT_LINE_SIZE), (double)(samples * TEXT_LINE_SIZE) / std::max<uint64_t>(1, counters.bytes));
+
+    std::printf("\n    Time  Samples        Red (mean, std)      Green (mean, std)       Blue (mean, std)   Green   Red  Yellow  None    Raw\n");
+
+    for (const Board_Summary_Bucket &bucket : received.timeline.Buckets())
+    {
+        if (bucket.samples == 0) continue;
+
+        std::printf("%7.1fs %8llu", bucket.start_ms / 1000.0, (unsigned long long)bucket.samples);
+
+        for (int c = 0; c < 3; c++)
+        {
+            std::printf("   %9.1f %9.1f", bucket.mean[c], bucket.Std(c));
+        }
+
+        for (int i = 0; i < BOARD_PROTOCOL_SUMMARY_CLASSES; i++)
+        {
+            std::printf(" %5.0f%%", 100.0 * bucket.classes[i] / bucket.samples);
+        }
+
+        std::printf(" %6llu\n", (unsigned long long)bucket.raw_samples);
+    }
+}
+
+bool Write_Raw(const char *path, const std::vector<Board_Sample> &raw)
+{
+    FILE *file = std::fopen(path, "w");
+
+    if (file == nullptr)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    std::fprintf(file, "time_us,label,r,g,b,c\n");
+
+    for (const Board_Sample &sample : raw)
+    {
+        std::fprintf(file, "%llu,none,%u,%u,%u,%u\n", (unsigned long long)sample.time_ms * 1000, sample.red, sample.green,
+                     sample.blue, sample.clear);
+    }
+
+    return std::fclose(file) == 0;
+}
+
+speed_t Baud_Constant(long baud)
+{
+    switch (baud)
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return B0;
+    }
+}
+
+// Reads a recording, or a serial port until the time is up or SIGINT, and decodes the summaries
+bool Read_Input(const char *path, long baud, double seconds, const char *save_path, bool request, Board_Decoder &decoder,
+                Received &received)
+{
+    int fd = open(path, (request ? O_RDWR : O_RDONLY) | O_NOCTTY);
+
+    if (fd < 0)
+    {
+        std::perror(path);
+        return false;
+    }
+
+    bool port = isatty(fd);
+
+    if (port)
+    {
+        struct termios settings;
+
+        if (tcgetattr(fd, &settings) == 0)
+        {
+            cfmakeraw(&settings);
+            cfsetispeed(&settings, Baud_Constant(baud));
+            cfsetospeed(&settings, Baud_Constant(baud));
+            settings.c_cflag |= CLOCAL | CREAD;
+            tcsetattr(fd, TCSANOW, &settings);
+        }
+
+        if (request)
+        {
+            uint8_t byte = SAMPLE_SUMMARY_BURST_REQUEST;
+            if (write(fd, &byte, 1) != 1) std::perror(path);
+        }
+
+        std::signal(SIGINT, Handle_Signal);
+        std::fprintf(stderr, "Reading %s, Ctrl-C to stop\n", path);
+    }
+
+    FILE *save = save_path ? std::fopen(save_path, "wb") : nullptr;
+    auto start = std::chrono::steady_clock::now();
+    uint8_t buffer[4096];
+
+    while (!stop_requested)
+    {
+        if (port)
+        {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if ((seconds > 0.0) && (elapsed >= seconds)) break;
+
+            fd_set read_set;
+            struct timeval timeout = { 0, 100000 };
+
+            FD_ZERO(&read_set);
+            FD_SET(fd, &read_set);
+
+            if (select(fd + 1, &read_set, nullptr, nullptr, &timeout) <= 0) continue;
+        }
+
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        if (save) std::fwrite(buffer, 1, (size_t)length, save);
+
+        decoder.Decode(buffer, (size_t)length, 0, [&](const Board_Event &event) { return received.Handle(event); });
+    }
+
+    if (save) std::fclose(save);
+    close(fd);
+    return true;
+}
+
+// Check: a sample of the synthetic board
+struct Check_Sample
+{
+    uint64_t time_ms;
+    uint16_t values[BOARD_PROTOCOL_SUMMARY_CHANNELS];
+    uint8_t color;
+    bool change;        // First sample of an object placed or removed
+};
+
+// Two hours with the timing of Adaptive_Rate: 50.4 ms idle periods, and 2.4 ms bursts for 1.5 s after a
+// change. Objects are held for 1 to 5 s, with 2 to 20 s of background between them, and the board
+// sometimes stops sampling for 3 s, as after ACCESS GRANTED
+std::vector<Check_Sample> Synthesize(uint32_t seed)
+{
+    static const uint16_t scenes[4][4] =
+    {
+        {  9000, 30000,  8000, 40000 },     // green
+        { 38000,  9000,  8000, 45000 },     // red
+        { 40000, 36000,  6000, 60000 },     // yellow
+        {  3000,  3200,  2800,  6000 },     // background
+    };
+    std::mt19937 random(seed);
+    std::normal_distribution<double> noise(0.0, 300.0);
+    std::vector<Check_Sample> samples;
+    uint64_t time_us = 0;
+    uint64_t end_us = 2ull * 3600 * 1000000;
+    bool object = false;
+
+    while (time_us < end_us)
+    {
+        int scene = object ? (int)(random() % 3) : 3;
+        uint64_t scene_end = time_us + (object ? 1000000 + random() % 4000000 : 2000000 + random() % 18000000);
+        uint64_t burst_end = time_us + 1500000;
+        bool first = true;
+
+        while (time_us < scene_end)
+        {
+            Check_Sample sample;
+
+            sample.time_ms = time_us / 1000;
+            sample.change = first;
+
+            for (int c = 0; c < 4; c++)
+            {
+                double value = std::round(scenes[scene][c] + noise(random));
+                sample.values[c] = (uint16_t)std::min(65535.0, std::max(0.0, value));
+            }
+
+            sample.color = (uint8_t)Color_Classifier_Classify(&Color_Classifier_Default_Params, sample.values[0],
+                                                              sample.values[1], sample.values[2]);
+            samples.push_back(sample);
+            first = false;
+
+            time_us += (time_us < burst_end) ? 2400 : 50400;
+        }
+
+        if (random() % 20 == 0) time_us += 3000000;
+        object = !object;
+    }
+
+    return samples;
+}
+
+void Check_Write(void *context, const uint8_t *frame, uint16_t length)
+{
+    std::vector<uint8_t> &stream = *(std::vector<uint8_t> *)context;
+    stream.insert(stream.end(), frame, frame + length);
+}
+
+// Runs the firmware over the samples, and returns the stream with the detection lines of main.c
+std::vector<uint8_t> Run_Board(const std::vector<Check_Sample> &samples, uint32_t window_ms, uint32_t clock_start_ms,
+                               std::vector<size_t> *requests, Sample_Summary &summary)
+{
+    static const char *const names[] = { "GREEN\n", "RED\n", "YELLOW\n" };
+    std::vector<uint8_t> stream;
+    Sample_Summary_Config config = Sample_Summary_Default_Config;
+    std::mt19937 random(96);
+
+    config.window_ms = window_ms;
+    Sample_Summary_Init(&summary, &config, Check_Write, &stream);
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        const Check_Sample &sample = samples[i];
+        PMOD_Color_Data data;
+
+        data.red = sample.values[0];
+        data.green = sample.values[1];
+        data.blue = sample.values[2];
+        data.clear = sample.values[3];
+
+        // The host asks for a burst now and then, which starts with the next sample
+        if (requests && (random() % 5000 == 0))
+        {
+            Sample_Summary_Request_Burst(&summary);
+            requests->push_back(i);
+        }
+
+        Sample_Summary_Add(&summary, (uint32_t)(clock_start_ms + sample.time_ms), &data, (Color_t)sample.color);
+
+        if (sample.color < COLOR_UNKNOWN)
+        {
+            stream.insert(stream.end(), names[sample.color], names[sample.color] + std::strlen(names[sample.color]));
+        }
+    }
+
+    Sample_Summary_Flush(&summary);
+    return stream;
+}
+
+int Check_Summary()
+{
+    constexpr uint32_t WINDOW_MS = 1000;
+    constexpr uint64_t BUCKET_MS = 10000;
+
+    // The board clock wraps 10 minutes into the run
+    constexpr uint32_t CLOCK_START_MS = 0xFFFFFFFFu - 600000;
+
+    std::vector<Check_Sample> samples = Synthesize(98);
+    std::vector<size_t> requests;
+    static Sample_Summary summary;
+    std::vector<uint8_t> stream = Run_Board(samples, WINDOW_MS, CLOCK_START_MS, &requests, summary);
+
+    // Decode in chunks of random sizes
+    Board_Decoder decoder;
+    Received received(BUCKET_MS);
+    std::mt19937 random(528);
+    size_t offset = 0;
+
+    while (offset < stream.size())
+    {
+        size_t size = std::min(stream.size() - offset, (size_t)(1 + random() % 300));
+
+        decoder.Decode(&stream[offset], size, 0, [&](const Board_Event &event) { return received.Handle(event); });
+        offset += size;
+    }
+
+    // The buckets of all the samples, in the windows of the board: aligned on the first sample
+    Board_Summary_Timeline truth(BUCKET_MS);
+
+    for (const Check_Sample &sample : samples)
+    {
+        uint64_t window_start = samples[0].time_ms + (sample.time_ms - samples[0].time_ms) / WINDOW_MS * WINDOW_MS;
+        truth.Add_Sample((uint32_t)(CLOCK_START_MS + window_start), sample.values, sample.color);
+    }
+
+    uint64_t mismatches = 0;
+    double max_mean_error = 0.0;
+    double max_std_error = 0.0;
+    const std::vector<Board_Summary_Bucket> &rebuilt = received.timeline.Buckets();
+    const std::vector<Board_Summary_Bucket> &expected = truth.Buckets();
+
+    if (rebuilt.size() != expected.size()) mismatches++;
+
+    for (size_t i = 0; i < std::min(rebuilt.size(), expected.size()); i++)
+    {
+        const Board_Summary_Bucket &a = rebuilt[i];
+        const Board_Summary_Bucket &b = expected[i];
+        bool equal = (a.samples == b.samples) && (a.windows == b.windows) &&
+                     (std::memcmp(a.classes, b.classes, sizeof(a.classes)) == 0) &&
+                     (std::memcmp(a.min, b.min, sizeof(a.min)) == 0) && (std::memcmp(a.max, b.max, sizeof(a.max)) == 0);
+
+        for (int c = 0; c < BOARD_PROTOCOL_SUMMARY_CHANNELS; c++)
+        {
+            max_mean_error = std::max(max_mean_error, std::fabs(a.mean[c] - b.mean[c]));
+            max_std_error = std::max(max_std_error, std::fabs(a.Std(c) - b.Std(c)));
+        }
+
+        if (!equal && (mismatches++ < 5))
+        {
+            std::fprintf(stderr, "bucket at %llu ms: %llu samples in %llu windows, expected %llu in %llu\n",
+                         (unsigned long long)a.start_ms, (unsigned long long)a.samples, (unsigned long long)a.windows,
+                         (unsigned long long)b.samples, (unsigned long long)b.windows);
+        }
+    }
+
+    // Every raw sample is a sample of the board, in order
+    std::vector<bool> sent_raw(samples.size(), false);
+    size_t next = 0;
+    uint64_t raw_mismatches = 0;
+
+    for (const Board_Sample &raw : received.raw)
+    {
+        while ((next < samples.size()) && ((uint32_t)(CLOCK_START_MS + samples[next].time_ms) != raw.time_ms)) next++;
+
+        if ((next == samples.size()) || (raw.red != samples[next].values[0]) || (raw.green != samples[next].values[1]) ||
+            (raw.blue != samples[next].values[2]) || (raw.clear != samples[next].values[3]))
+        {
+            raw_mismatches++;
+            continue;
+        }
+
+        sent_raw[next++] = true;
+    }
+
+    uint64_t raw_in_buckets = 0;
+    for (const Board_Summary_Bucket &bucket : rebuilt) raw_in_buckets += bucket.raw_samples;
+
+    // Each request is followed by a burst of SAMPLE_SUMMARY_BURST_SAMPLES samples
+    uint64_t requests_served = 0;
+
+    for (size_t request : requests)
+    {
+        size_t end = std::min(samples.size(), request + SAMPLE_SUMMARY_BURST_SAMPLES);
+        bool served = true;
+
+        for (size_t i = request; i < end; i++) served = served && sent_raw[i];
+        if (served) requests_served++;
+    }
+
+    // The changes after a full window without one must start a burst within 3 samples
+    uint64_t changes = 0;
+    uint64_t quiet_changes = 0;
+    uint64_t detected = 0;
+    uint64_t last_change_ms = 0;
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (!samples[i].change || (i == 0)) continue;
+
+        changes++;
+
+        uint64_t window_start = samples[0].time_ms + (samples[i].time_ms - samples[0].time_ms) / WINDOW_MS * WINDOW_MS;
+
+        if (last_change_ms + 2 * WINDOW_MS <= window_start)
+        {
+            bool burst = false;
+
+            quiet_changes++;
+            for (size_t j = i; (j < i + 3) && (j < samples.size()); j++) burst = burst || sent_raw[j];
+            if (burst) detected++;
+        }
+
+        last_change_ms = samples[i].time_ms;
+    }
+
+    bool passed = (mismatches == 0) && (raw_mismatches == 0) && (received.raw.size() == summary.raw_sent) &&
+                  (raw_in_buckets == summary.raw_sent) && (received.windows == summary.windows) &&
+                  (requests_served == requests.size()) && (detected == quiet_changes) &&
+                  (summary.anomalies <= changes + changes / 10) && (max_mean_error <= 0.5) &&
+                  (max_std_error <= 1.0) && (decoder.Counters().lost_frames == 0) && (decoder.Counters().crc_errors == 0);
+
+    std::printf("Summary: %zu samples in %llu windows and %zu buckets, mean within %.3f, std within %.3f: %s\n",
+                samples.size(), (unsigned long long)summary.windows, rebuilt.size(), max_mean_error, max_std_error,
+                passed ? "passed" : "FAILED");
+    std::printf("Raw: %zu samples, %llu anomaly bursts for %llu changes; %llu of %llu changes after a quiet window started a burst, "
+                "%llu of %zu requests served\n", received.raw.size(), (unsigned long long)summary.anomalies,
+                (unsigned long long)changes, (unsigned long long)detected, (unsigned long long)quiet_changes,
+                (unsigned long long)requests_served, requests.size());
+
+    // Bytes sent for other windows, against a text line or a SAMPLE frame per sample
+    uint64_t text_bytes = samples.size() * TEXT_LINE_SIZE;
+    uint64_t frame_bytes = 0;
+    uint8_t frame[BOARD_PROTOCOL_MAX_FRAME];
+
+    for (const Check_Sample &sample : samples)
+    {
+        PMOD_Color_Data data = { sample.values[0], sample.values[1], sample.values[2], sample.values[3] };
+        frame_bytes += Board_Protocol_Encode_Sample(0x55, (uint32_t)sample.time_ms, &data, frame, sizeof(frame));
+    }
+
+    std::printf("\nWindow     Bytes  Text lines  SAMPLE frames   Raw share\n");
+    std::printf("  none %9llu %10.1fx %13.1fx\n", (unsigned long long)text_bytes, 1.0, (double)text_bytes / frame_bytes);
+
+    for (uint32_t window : { 250u, 1000u, 10000u })
+    {
+        static Sample_Summary other;
+        std::vector<uint8_t> other_stream = Run_Board(samples, window, CLOCK_START_MS, nullptr, other);
+
+        std::printf("%5.2gs %9u %10.1fx %13.1fx %10.1f%%\n", window / 1000.0, other.bytes, (double)text_bytes / other.bytes,
+                    (double)frame_bytes / other.bytes, 100.0 * other.raw_sent / samples.size());
+    }
+
+    Sample_Summary_Print_Stats(&summary);
+
+    return passed ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    long baud = 115200;
+    double seconds = 0.0;
+    const char *save_path = nullptr;
+    const char *csv_path = nullptr;
+    const char *raw_path = nullptr;
+    const char *input = nullptr;
+    bool request = false;
+    uint64_t bucket_ms = 10000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--check")) return Check_Summary();
+        else if (!strcmp(argv[i], "--baud") && (i + 1 < argc)) baud = strtol(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seconds") && (i + 1 < argc)) seconds = strtod(argv[++i], nullptr);
+        else if (!strcmp(argv[i], "--save") && (i + 1 < argc)) save_path = argv[++i];
+        else if (!strcmp(argv[i], "--request")) request = true;
+        else if (!strcmp(argv[i], "--bucket") && (i + 1 < argc)) bucket_ms = std::max(1ull, strtoull(argv[++i], nullptr, 10));
+        else if (!strcmp(argv[i], "--csv") && (i + 1 < argc)) csv_path = argv[++i];
+        else if (!strcmp(argv[i], "--raw") && (i + 1 < argc)) raw_path = argv[++i];
+        else if ((argv[i][0] != '-') && (input == nullptr)) input = argv[i];
+        else
+        {
+            input = nullptr;
+            break;
+        }
+    }
+
+    if (input == nullptr)
+    {
+        std::fprintf(stderr, "Usage: %s [--baud RATE] [--seconds S] [--save FILE] [--request] [--bucket MS] [--csv FILE]\n"
+                             "       [--raw FILE] INPUT\n"
+                             "       %s --check\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    Board_Decoder decoder;
+    Received received(bucket_ms);
+
+    if (!Read_Input(input, baud, seconds, save_path, request, decoder, received)) return 1;
+
+    Print_Report(received, decoder.Counters());
+
+    if (csv_path)
+    {
+        FILE *file = std::fopen(csv_path, "w");
+
+        if (file == nullptr)
+        {
+            std::perror(csv_path);
+            return 1;
+        }
+
+        received.timeline.Write_CSV(file);
+        if (std::fclose(file) != 0) return 1;
+    }
+
+    if (raw_path && !Write_Raw(raw_path, received.raw)) return 1;
+
+    return 0;
+}
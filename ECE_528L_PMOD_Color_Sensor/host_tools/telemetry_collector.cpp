@@ -0,0 +1,566 @@
+/**
+ * @file telemetry_collector.cpp
+ * @brief Collects the serial output of many boards on one epoll loop into a capture store directory.
+ *
+ * Each port is opened non-blocking in raw mode and registered with a single epoll instance, together
+ * with a signalfd for SIGINT and SIGTERM and a timerfd for the periodic statistics. Every board has a
+ * Board_Decoder (see Board_Decoder.h), which decodes the text lines printed by main.c and the binary
+ * frames of Board_Protocol.h in place in the read buffer, so no memory is allocated per line or frame.
+ * Samples are stored with the host receive time; detections, game results and rate statistics are
+ * counted, and other lines are counted and ignored.
+ *
+ * The samples of each board are buffered into segments of --segment-samples samples, and a writer
+ * thread stores every full segment as OUT/<board>/segment_NNNNNN.ccs (see Capture_Store.h), so that
+ * the epoll loop never waits for the disk. The decoder handler stops decoding when a segment is full,
+ * and the rest of the read is decoded into the next segment. The remaining samples are stored on exit, and the
+ * statistics of each board are written to OUT/stats.csv. Boards that disconnect are reopened once
+ * per statistics interval.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Board_Protocol.c
+ *   g++ -std=c++17 -O2 -pthread -I../ECE528L_PMOD_COLOR/PMOD_COLOR telemetry_collector.cpp Board_Decoder.cpp Capture_Store.cpp Capture.cpp Board_Protocol.o -o telemetry_collector
+ *
+ * Usage: telemetry_collector [options] PORT ...
+ *   --ports-file FILE        Read more port paths from FILE, one per line
+ *   --out DIR                Output directory (default: capture_store)
+ *   --baud RATE              Baud rate of real serial ports (default: 115200)
+ *   --segment-samples N      Samples per stored segment (default: 262144)
+ *   --stats-interval S       Seconds between statistics lines (default: 5)
+ *   --seconds S              Stop after S seconds (default: run until SIGINT or SIGTERM)
+ *
+ * The pty_loadgen tool simulates boards on pseudo-terminals for load testing.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Board_Decoder.h"
+#include "Capture.h"
+#include "Capture_Store.h"
+
+namespace
+{
+
+// Size of one read from a port
+constexpr size_t READ_SIZE = 16384;
+
+// Label stored with every sample: the collector does not know what was in front of the sensor
+constexpr uint8_t LABEL_NONE = 3;
+
+// Events counted per board; detections and game results follow Color_t and the SIMON_GAME_ results
+enum Event
+{
+    EVENT_GREEN = 0,
+    EVENT_RED,
+    EVENT_YELLOW,
+    EVENT_WRONG,
+    EVENT_STEP,
+    EVENT_GRANTED,
+    EVENT_MISS,
+    EVENT_RATE_STATS,
+    EVENT_REACTION,
+    EVENT_REACTION_STATS,
+    EVENT_COUNT
+};
+
+const char *const EVENT_NAMES[EVENT_COUNT] = { "green", "red", "yellow", "wrong", "step", "granted", "miss", "rate_stats", "reaction",
+                                               "reaction_stats" };
+
+// Counts kept next to the decoder counters
+struct Board_Stats
+{
+    uint64_t other = 0;
+    uint64_t disconnects = 0;
+    uint64_t events[EVENT_COUNT] = {};
+};
+
+struct Board
+{
+    std::string port;
+    std::string name;
+    int fd = -1;
+    Board_Decoder decoder;
+    uint32_t segment = 0;
+    Capture buffer;
+    Board_Stats stats;
+};
+
+struct Segment_Job
+{
+    std::string path;
+    Capture capture;
+};
+
+// Stores full segments on a separate thread, so that the epoll loop never blocks on the disk
+class Segment_Writer
+{
+public:
+    Segment_Writer() : thread([this] { Run(); }) {}
+
+    ~Segment_Writer()
+    {
+        Finish();
+    }
+
+    // Stores the queued segments and stops the thread
+    void Finish()
+    {
+        if (!thread.joinable()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_one();
+        thread.join();
+    }
+
+    void Submit(std::string path, Capture &&capture)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({ std::move(path), std::move(capture) });
+        }
+        ready.notify_one();
+    }
+
+    uint64_t Failures() const { return failures; }
+
+private:
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true)
+        {
+            ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;
+
+            Segment_Job job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+
+            if (!Capture_Store_Write(job.path.c_str(), job.capture)) failures++;
+
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Segment_Job> jobs;
+    bool stopping = false;
+    std::atomic<uint64_t> failures{ 0 };
+    std::thread thread;
+};
+
+uint64_t Monotonic_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+speed_t Baud_Constant(long baud)
+{
+    switch (baud)
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default:     return B0;
+    }
+}
+
+bool Open_Port(Board &board, speed_t baud)
+{
+    board.fd = open(board.port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (board.fd < 0) return false;
+
+    struct termios settings;
+
+    if (tcgetattr(board.fd, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        cfsetispeed(&settings, baud);
+        cfsetospeed(&settings, baud);
+        settings.c_cflag |= CLOCAL | CREAD;
+        tcsetattr(board.fd, TCSANOW, &settings);
+    }
+
+    // A partial line or frame from before a reconnection is not decoded
+    board.decoder.Reset();
+    return true;
+}
+
+// Stores or counts one decoded event. Returns false when the segment is full, so that decoding stops
+// until the segment has been handed to the writer.
+bool Handle_Event(Board &board, const Board_Event &event, uint32_t segment_samples)
+{
+    switch (event.type)
+    {
+        case Board_Event_Type::Sample:
+            board.buffer.Append(event.time_us, LABEL_NONE, event.sample.red, event.sample.green, event.sample.blue, event.sample.clear);
+            break;
+        case Board_Event_Type::Detection:
+            if (event.color <= COLOR_YELLOW) board.stats.events[EVENT_GREEN + event.color]++;
+            else board.stats.other++;
+            break;
+        case Board_Event_Type::Game:
+            board.stats.events[EVENT_WRONG + event.game_result]++;
+            break;
+        case Board_Event_Type::Rate_Stats:
+            board.stats.events[EVENT_RATE_STATS]++;
+            break;
+        case Board_Event_Type::Reaction:
+            board.stats.events[EVENT_REACTION]++;
+            break;
+        case Board_Event_Type::Reaction_Stats:
+            board.stats.events[EVENT_REACTION_STATS]++;
+            break;
+        default:
+            board.stats.other++;
+            break;
+    }
+
+    return board.buffer.Size() < segment_samples;
+}
+
+std::string Board_Name(const std::string &port)
+{
+    std::string name = (port.compare(0, 5, "/dev/") == 0) ? port.substr(5) : port;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return name;
+}
+
+// Reserves a whole segment, so that appending samples never reallocates
+void Reset_Buffer(Board &board, uint32_t segment_samples)
+{
+    board.buffer = Capture();
+    board.buffer.time_us.reserve(segment_samples);
+    board.buffer.label.reserve(segment_samples);
+    board.buffer.red.reserve(segment_samples);
+    board.buffer.green.reserve(segment_samples);
+    board.buffer.blue.reserve(segment_samples);
+    board.buffer.clear.reserve(segment_samples);
+}
+
+void Store_Segment(Board &board, const std::string &out, uint32_t segment_samples, Segment_Writer &writer)
+{
+    if (board.buffer.Size() == 0) return;
+
+    char file[32];
+    std::snprintf(file, sizeof(file), "segment_%06u.ccs", board.segment++);
+
+    writer.Submit(out + "/" + board.name + "/" + file, std::move(board.buffer));
+    Reset_Buffer(board, segment_samples);
+}
+
+void Write_Stats(const std::string &path, const std::vector<Board> &boards, double seconds)
+{
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file) return;
+
+    std::fprintf(file, "board,port,bytes,lines,frames,samples,samples_per_s,malformed,overlong,crc_errors,lost_frames,other,disconnects");
+    for (int e = 0; e < EVENT_COUNT; e++) std::fprintf(file, ",%s", EVENT_NAMES[e]);
+    std::fprintf(file, "\n");
+
+    for (const Board &board : boards)
+    {
+        const Board_Stats &s = board.stats;
+        const Board_Decoder_Counters &c = board.decoder.Counters();
+
+        std::fprintf(file, "%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.1f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+                     board.name.c_str(), board.port.c_str(), c.bytes, c.lines, c.frames, c.samples, c.samples / seconds,
+                     c.malformed, c.overlong, c.crc_errors, c.lost_frames, s.other, s.disconnects);
+        for (int e = 0; e < EVENT_COUNT; e++) std::fprintf(file, ",%" PRIu64, s.events[e]);
+        std::fprintf(file, "\n");
+    }
+
+    std::fclose(file);
+}
+
+double CPU_Seconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Board> boards;
+    std::string out = "capture_store";
+    long baud = 115200;
+    uint32_t segment_samples = 262144;
+    int stats_interval = 5;
+    double run_seconds = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if ((option == "--ports-file") && (i + 1 < argc))
+        {
+            std::ifstream file(argv[++i]);
+            std::string line;
+
+            if (!file)
+            {
+                std::fprintf(stderr, "cannot open %s\n", argv[i]);
+                return 1;
+            }
+            while (std::getline(file, line))
+            {
+                if (!line.empty()) boards.emplace_back().port = line;
+            }
+        }
+        else if ((option == "--out") && (i + 1 < argc)) out = argv[++i];
+        else if ((option == "--baud") && (i + 1 < argc)) baud = std::atol(argv[++i]);
+        else if ((option == "--segment-samples") && (i + 1 < argc)) segment_samples = (uint32_t)std::max(1L, std::atol(argv[++i]));
+        else if ((option == "--stats-interval") && (i + 1 < argc)) stats_interval = std::max(1, std::atoi(argv[++i]));
+        else if ((option == "--seconds") && (i + 1 < argc)) run_seconds = std::atof(argv[++i]);
+        else if (option.compare(0, 2, "--") == 0)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        else boards.emplace_back().port = option;
+    }
+
+    speed_t baud_constant = Baud_Constant(baud);
+
+    if (boards.empty() || (baud_constant == B0))
+    {
+        std::fprintf(stderr, "usage: telemetry_collector [options] PORT ... (see the header of telemetry_collector.cpp)\n");
+        return 1;
+    }
+
+    // Every board needs a descriptor, on top of the epoll, signal and timer descriptors
+    struct rlimit limit;
+    if ((getrlimit(RLIMIT_NOFILE, &limit) == 0) && (limit.rlim_cur < boards.size() + 64))
+    {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, boards.size() + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    mkdir(out.c_str(), 0755);
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {};
+
+    for (size_t b = 0; b < boards.size(); b++)
+    {
+        Board &board = boards[b];
+
+        board.name = Board_Name(board.port);
+        mkdir((out + "/" + board.name).c_str(), 0755);
+        Reset_Buffer(board, segment_samples);
+
+        if (!Open_Port(board, baud_constant))
+        {
+            std::fprintf(stderr, "cannot open %s: %s\n", board.port.c_str(), std::strerror(errno));
+            return 1;
+        }
+
+        event.events = EPOLLIN;
+        event.data.u64 = b;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, board.fd, &event);
+    }
+
+    // Signals and the statistics timer are delivered through the same loop
+    const uint64_t SIGNAL_ID = UINT64_MAX;
+    const uint64_t TIMER_ID = UINT64_MAX - 1;
+    sigset_t signals;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, nullptr);
+
+    int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+    event.events = EPOLLIN;
+    event.data.u64 = SIGNAL_ID;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &event);
+
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    struct itimerspec interval = { { stats_interval, 0 }, { stats_interval, 0 } };
+    timerfd_settime(timer_fd, 0, &interval, nullptr);
+    event.data.u64 = TIMER_ID;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event);
+
+    std::printf("collecting %zu boards into %s/\n", boards.size(), out.c_str());
+    std::fflush(stdout);
+
+    Segment_Writer writer;
+    std::vector<struct epoll_event> events(std::min<size_t>(boards.size() + 2, 1024));
+    static uint8_t data[READ_SIZE];
+    uint64_t start_us = Monotonic_us();
+    uint64_t end_us = (run_seconds > 0.0) ? start_us + (uint64_t)(run_seconds * 1e6) : UINT64_MAX;
+    double start_cpu = CPU_Seconds();
+    uint64_t last_bytes = 0;
+    uint64_t last_samples = 0;
+    bool running = true;
+
+    while (running)
+    {
+        uint64_t now_us = Monotonic_us();
+        if (now_us >= end_us) break;
+
+        int timeout_ms = (end_us == UINT64_MAX) ? -1 : (int)std::min<uint64_t>((end_us - now_us + 999) / 1000, 1000);
+        int count = epoll_wait(epoll_fd, events.data(), (int)events.size(), timeout_ms);
+        now_us = Monotonic_us();
+
+        for (int e = 0; e < count; e++)
+        {
+            uint64_t id = events[e].data.u64;
+
+            if (id == SIGNAL_ID)
+            {
+                running = false;
+            }
+            else if (id == TIMER_ID)
+            {
+                uint64_t expirations;
+                uint64_t bytes = 0, samples = 0, errors = 0;
+                size_t connected = 0;
+
+                if (read(timer_fd, &expirations, sizeof(expirations)) < 0) continue;
+
+                for (size_t b = 0; b < boards.size(); b++)
+                {
+                    Board &board = boards[b];
+
+                    // Reopen boards that were disconnected
+                    if ((board.fd < 0) && Open_Port(board, baud_constant))
+                    {
+                        event.events = EPOLLIN;
+                        event.data.u64 = b;
+                        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, board.fd, &event);
+                    }
+
+                    const Board_Decoder_Counters &counters = board.decoder.Counters();
+
+                    connected += (board.fd >= 0);
+                    bytes += counters.bytes;
+                    samples += counters.samples;
+                    errors += counters.malformed + counters.overlong + counters.crc_errors;
+                }
+
+                double elapsed = (now_us - start_us) * 1e-6;
+                std::printf("%7.1f s: %zu/%zu boards, %.0f samples/s, %.1f kB/s, %" PRIu64 " decode errors, CPU %.1f%%\n",
+                            elapsed, connected, boards.size(), (samples - last_samples) / (double)stats_interval,
+                            (bytes - last_bytes) / (stats_interval * 1e3), errors,
+                            100.0 * (CPU_Seconds() - start_cpu) / elapsed);
+                std::fflush(stdout);
+                last_bytes = bytes;
+                last_samples = samples;
+            }
+            else
+            {
+                Board &board = boards[id];
+                ssize_t size = read(board.fd, data, sizeof(data));
+
+                if (size > 0)
+                {
+                    size_t consumed = 0;
+
+                    while (consumed < (size_t)size)
+                    {
+                        consumed += board.decoder.Decode(data + consumed, (size_t)size - consumed, now_us, [&](const Board_Event &decoded)
+                        {
+                            return Handle_Event(board, decoded, segment_samples);
+                        });
+                        if (board.buffer.Size() >= segment_samples) Store_Segment(board, out, segment_samples, writer);
+                    }
+                }
+                else if ((size == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+                {
+                    // Unplugged board or closed pty: drop it until it can be reopened
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, board.fd, nullptr);
+                    close(board.fd);
+                    board.fd = -1;
+                    board.stats.disconnects++;
+                }
+            }
+        }
+    }
+
+    double elapsed = (Monotonic_us() - start_us) * 1e-6;
+    double cpu = CPU_Seconds() - start_cpu;
+    Board_Decoder_Counters total;
+    uint64_t disconnects = 0;
+
+    for (Board &board : boards)
+    {
+        const Board_Decoder_Counters &counters = board.decoder.Counters();
+
+        Store_Segment(board, out, segment_samples, writer);
+        if (board.fd >= 0) close(board.fd);
+
+        total.bytes += counters.bytes;
+        total.lines += counters.lines;
+        total.frames += counters.frames;
+        total.samples += counters.samples;
+        total.malformed += counters.malformed;
+        total.overlong += counters.overlong;
+        total.crc_errors += counters.crc_errors;
+        total.lost_frames += counters.lost_frames;
+        disconnects += board.stats.disconnects;
+    }
+
+    writer.Finish();
+    Write_Stats(out + "/stats.csv", boards, elapsed);
+
+    std::printf("\n%zu boards, %.1f s: %" PRIu64 " lines, %" PRIu64 " frames, %" PRIu64 " samples (%.0f/s), %.2f MB (%.1f kB/s)\n",
+                boards.size(), elapsed, total.lines, total.frames, total.samples, total.samples / elapsed,
+                total.bytes * 1e-6, total.bytes / (elapsed * 1e3));
+    std::printf("%" PRIu64 " malformed, %" PRIu64 " overlong, %" PRIu64 " CRC errors, %" PRIu64 " lost frames, %" PRIu64 " disconnects\n",
+                total.malformed, total.overlong, total.crc_errors, total.lost_frames, disconnects);
+    std::printf("CPU %.2f s (%.1f%% of one core, %.0f ns per sample)\n", cpu, 100.0 * cpu / elapsed, cpu * 1e9 / std::max<uint64_t>(1, total.samples));
+    std::printf("per-board statistics in %s/stats.csv\n", out.c_str());
+
+    close(timer_fd);
+    close(signal_fd);
+    close(epoll_fd);
+
+    if (writer.Failures() > 0)
+    {
+        std::fprintf(stderr, "%" PRIu64 " segments could not be stored\n", writer.Failures());
+        return 1;
+    }
+
+    return 0;
+}
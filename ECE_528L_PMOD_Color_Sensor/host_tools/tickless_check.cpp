@@ -0,0 +1,427 @@
+/**
+ * @file tickless_check.cpp
+ * @brief Checks the tickless timer service in simulated time and measures its interrupt rate.
+ *
+ * The program runs the firmware's Tickless_Timer on the Tickless_Timer_Sim backend:
+ *   - Ordering: random one-shot and periodic events are started and stopped from the main program
+ *     and from the callbacks, with busy time and sleeps in between. Every callback is compared with a
+ *     model that keeps each deadline in 64 bits: it must be the pending event with the earliest
+ *     deadline (the earliest started on a tie), and run exactly at its deadline. No event may stay
+ *     pending past its deadline. The counter starts just below its wraparound.
+ *   - Wraparound: the service runs with only a 500 ms periodic event until the millisecond time has
+ *     wrapped (49.7 days), in busy steps longer than a counter wrap. The 64-bit and millisecond times
+ *     must match the simulated time, and the periodic event must keep its count.
+ *   - Overruns: a periodic callback that runs for 2.5 periods must skip the missed periods and keep
+ *     the phase of the following ones.
+ *   - Preemption: after random reads of the counter, including the ones inside the locked sections,
+ *     the simulated interrupt of a higher priority than the alarm (such as PORT4 with its BASEPRI
+ *     lock) takes one tick and reads the time. Each of these reads and every read of the main program
+ *     must return the exact simulated time.
+ *   - Interrupt rate: the main loop of main.c is modeled in the idle and burst modes of Adaptive_Rate
+ *     (sample, print the line over the UART, sleep for the sampling period) with the chassis LED
+ *     toggled every 500 ms. The alarm interrupts, wakeups and idle time are compared with the 1 kHz
+ *     SysTick interrupt and the busy-wait delays it replaces.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Tickless_Timer.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/Tickless_Timer_Sim.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR tickless_check.cpp Tickless_Timer.o Tickless_Timer_Sim.o -o tickless_check
+ *
+ * Usage: tickless_check [--operations N] [--seed N]
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "inc/Tickless_Timer.h"
+#include "inc/Tickless_Timer_Sim.h"
+#include "inc/Adaptive_Rate.h"
+
+namespace
+{
+
+// 48 MHz / 16, as on the MSP432
+constexpr uint32_t TICKS_PER_MS = 3000;
+
+// Events of the ordering check
+constexpr int EVENT_COUNT = 12;
+
+// Cost of one SysTick interrupt in cycles: exception entry and exit, and the handler of main.c
+constexpr double SYSTICK_CYCLES = 12 + 12 + 20;
+constexpr double CPU_HZ = 48e6;
+
+uint64_t mismatches = 0;
+
+void Report(const char *format, uint64_t a, uint64_t b, uint64_t c)
+{
+    if (mismatches < 10)
+    {
+        std::fprintf(stderr, format, (unsigned long long)a, (unsigned long long)b, (unsigned long long)c);
+        std::fputc('\n', stderr);
+    }
+    mismatches++;
+}
+
+// Model of one event, with its deadline in 64 bits and its start order for ties
+struct Model_Event
+{
+    bool pending = false;
+    uint64_t deadline = 0;
+    uint64_t order = 0;
+    uint32_t period = 0;
+};
+
+struct Ordering_Check
+{
+    Tickless_Timer timer;
+    Tickless_Timer_Sim_Context sim;
+    Tickless_Timer_Event events[EVENT_COUNT];
+    Model_Event model[EVENT_COUNT];
+    uint64_t next_order = 0;
+    uint64_t fired = 0;
+    std::mt19937 random;
+
+    explicit Ordering_Check(uint32_t seed) : random(seed) {}
+
+    uint32_t Delay(uint32_t minimum)
+    {
+        // Mostly short delays, some equal to force ties, a few up to the counter wrap
+        switch (random() % 8)
+        {
+            case 0:  return minimum + 1000;
+            case 1:  return (uint32_t)(random() % 0x40000000u) + minimum;
+            default: return (uint32_t)(random() % 3000000) + minimum;
+        }
+    }
+
+    void Start(int id, uint32_t minimum_delay)
+    {
+        uint32_t delay = Delay(minimum_delay);
+        uint32_t period = (random() % 2) ? (uint32_t)(random() % 2000000) + 1 : 0;
+
+        Tickless_Timer_Start(&timer, &events[id], delay, period, Callback, this);
+        model[id] = { true, sim.time + delay, next_order++, period };
+    }
+
+    void Stop(int id)
+    {
+        Tickless_Timer_Stop(&timer, &events[id]);
+        model[id].pending = false;
+    }
+
+    static void Callback(Tickless_Timer_Event *event)
+    {
+        Ordering_Check *check = (Ordering_Check *)event->context;
+        check->Fire((int)(event - check->events));
+    }
+
+    void Fire(int id)
+    {
+        int expected = -1;
+
+        for (int i = 0; i < EVENT_COUNT; i++)
+        {
+            if (!model[i].pending) continue;
+            if ((expected < 0) || (model[i].deadline < model[expected].deadline) ||
+                ((model[i].deadline == model[expected].deadline) && (model[i].order < model[expected].order)))
+            {
+                expected = i;
+            }
+        }
+
+        fired++;
+
+        if ((expected != id) || (model[id].deadline != sim.time) || (Tickless_Timer_Now(&timer) != sim.time))
+        {
+            Report("ordering: event %llu fired at %llu, expected event %llu", (uint64_t)id, sim.time, (uint64_t)expected);
+            return;
+        }
+
+        // A periodic event is started again before its callback runs
+        if (model[id].period > 0)
+        {
+            model[id].deadline += model[id].period;
+            model[id].order = next_order++;
+        }
+        else
+        {
+            model[id].pending = false;
+        }
+
+        // Callbacks start and stop events themselves, including their own
+        uint32_t action = random() % 10;
+        int other = (int)(random() % EVENT_COUNT);
+
+        if (action < 2) Start(other, 0);
+        else if (action < 3) Stop(other);
+        else if (action < 4) Stop(id);
+    }
+
+    void Check_Nothing_Late()
+    {
+        for (int i = 0; i < EVENT_COUNT; i++)
+        {
+            if (model[i].pending && (model[i].deadline <= sim.time))
+            {
+                Report("ordering: event %llu with deadline %llu still pending at %llu", (uint64_t)i, model[i].deadline, sim.time);
+                model[i].pending = false;
+            }
+        }
+        if (Tickless_Timer_Now(&timer) != sim.time)
+        {
+            Report("ordering: time %llu, expected %llu%llu", Tickless_Timer_Now(&timer), sim.time, 0);
+        }
+    }
+
+    void Run(uint64_t operations)
+    {
+        std::memset(events, 0, sizeof(events));
+
+        // The counter wraps after 1 million ticks, and then every 23.9 minutes of simulated time
+        Tickless_Timer_Sim_Init(&timer, &sim, 0xFFF00000u, TICKS_PER_MS);
+
+        for (uint64_t n = 0; n < operations; n++)
+        {
+            uint32_t action = random() % 10;
+            int id = (int)(random() % EVENT_COUNT);
+
+            if (action < 4)
+            {
+                Start(id, 1);
+            }
+            else if (action < 5)
+            {
+                Stop(id);
+            }
+            else if (action < 6)
+            {
+                uint64_t start = sim.time;
+                uint32_t delay = (uint32_t)(random() % 3000000);
+
+                Tickless_Timer_Sleep(&timer, delay);
+                if (sim.time != start + delay) Report("sleep: woke at %llu, expected %llu%llu", sim.time, start + delay, 0);
+            }
+            else
+            {
+                Tickless_Timer_Sim_Advance(&sim, random() % 4000000);
+            }
+
+            Check_Nothing_Late();
+        }
+    }
+};
+
+// Runs with a 500 ms event until the millisecond time wraps, in steps longer than a counter wrap
+void Check_Wraparound(uint64_t &led_toggles, uint64_t &alarms)
+{
+    Tickless_Timer timer;
+    Tickless_Timer_Sim_Context sim;
+    Tickless_Timer_Event led = {};
+    uint64_t toggles = 0;
+    const uint32_t period = 500 * TICKS_PER_MS;
+
+    Tickless_Timer_Sim_Init(&timer, &sim, 0xFFFFFF00u, TICKS_PER_MS);
+    Tickless_Timer_Start(&timer, &led, period, period, [](Tickless_Timer_Event *event) { (*(uint64_t *)event->context)++; }, &toggles);
+
+    const uint64_t end = (1ULL << 32) * TICKS_PER_MS + 1000ULL * TICKS_PER_MS * 3600;
+    uint32_t previous_ms = 0;
+    bool wrapped = false;
+
+    while (sim.time < end)
+    {
+        Tickless_Timer_Sim_Advance(&sim, 10000000000ULL + sim.time % 7777);
+
+        uint64_t now = Tickless_Timer_Now(&timer);
+        uint32_t now_ms = Tickless_Timer_Now_ms(&timer);
+
+        if (now != sim.time) Report("wraparound: time %llu, expected %llu%llu", now, sim.time, 0);
+        if (now_ms != (uint32_t)(sim.time / TICKS_PER_MS)) Report("wraparound: %llu ms at %llu ticks%llu", now_ms, sim.time, 0);
+        if (toggles != sim.time / period) Report("wraparound: %llu toggles at %llu ticks, expected %llu", toggles, sim.time, sim.time / period);
+
+        wrapped = wrapped || (now_ms < previous_ms);
+        previous_ms = now_ms;
+    }
+
+    if (!wrapped) Report("wraparound: the millisecond time did not wrap%llu%llu%llu", 0, 0, 0);
+
+    led_toggles = toggles;
+    alarms = sim.interrupts;
+}
+
+// A callback that runs for 2.5 periods once
+void Check_Overruns(uint32_t &overruns)
+{
+    struct Overrun_State
+    {
+        Tickless_Timer_Sim_Context *sim;
+        uint64_t calls;
+        uint64_t off_phase;
+    };
+
+    Tickless_Timer timer;
+    Tickless_Timer_Sim_Context sim;
+    Tickless_Timer_Event event = {};
+    Overrun_State state = { &sim, 0, 0 };
+
+    Tickless_Timer_Sim_Init(&timer, &sim, 0, TICKS_PER_MS);
+    Tickless_Timer_Start(&timer, &event, 3000, 3000, [](Tickless_Timer_Event *e)
+    {
+        Overrun_State *s = (Overrun_State *)e->context;
+
+        // The call after the long one comes late; all others must be on the 3000-tick grid
+        if ((s->calls != 5) && (s->sim->time % 3000 != 0)) s->off_phase++;
+        if (++s->calls == 5) Tickless_Timer_Sim_Advance(s->sim, 7500);
+    }, &state);
+
+    Tickless_Timer_Sim_Advance(&sim, 3000 * 20);
+
+    // 20 periods: the call due at 18000 runs late at 22500, the one at 21000 is skipped
+    if ((state.calls != 19) || (state.off_phase != 0) || (timer.overruns != 1))
+    {
+        Report("overruns: %llu calls, %llu off phase, %llu overruns", state.calls, state.off_phase, timer.overruns);
+    }
+
+    overruns = timer.overruns;
+}
+
+// Reads the time from a simulated interrupt that the lock does not mask, at random reads of the counter
+void Check_Preemption(uint64_t operations, uint32_t seed, uint64_t &reads)
+{
+    struct Preemption_State
+    {
+        Tickless_Timer *timer;
+        std::mt19937 random;
+        uint64_t reads;
+    };
+
+    Tickless_Timer timer;
+    Tickless_Timer_Sim_Context sim;
+    Tickless_Timer_Event events[4] = {};
+    Preemption_State state = { &timer, std::mt19937(seed), 0 };
+
+    Tickless_Timer_Sim_Init(&timer, &sim, 0xFFF00000u, TICKS_PER_MS);
+    sim.hook_context = &state;
+    sim.hook = [](Tickless_Timer_Sim_Context *context)
+    {
+        Preemption_State *s = (Preemption_State *)context->hook_context;
+
+        if (s->random() % 2) return;
+
+        // The interrupt runs for one tick, then reads the time
+        context->time++;
+        s->reads++;
+
+        uint64_t now = Tickless_Timer_Now(s->timer);
+        if (now != context->time) Report("preemption: read %llu at %llu%llu", now, context->time, 0);
+    };
+
+    for (uint64_t n = 0; n < operations; n++)
+    {
+        Tickless_Timer_Event *event = &events[state.random() % 4];
+        uint32_t delay = (uint32_t)(state.random() % 300000);
+
+        switch (state.random() % 4)
+        {
+            case 0:  Tickless_Timer_Start(&timer, event, delay, (state.random() % 2) ? delay + 1 : 0, 0, 0); break;
+            case 1:  Tickless_Timer_Stop(&timer, event); break;
+            case 2:  Tickless_Timer_Sleep(&timer, delay); break;
+            default: Tickless_Timer_Sim_Advance(&sim, delay * 16ULL); break;
+        }
+
+        // Without the interrupt, which would make this read one tick old
+        Tickless_Timer_Sim_Hook hook = sim.hook;
+        sim.hook = 0;
+
+        uint64_t now = Tickless_Timer_Now(&timer);
+        if (now != sim.time) Report("preemption: time %llu, expected %llu%llu", now, sim.time, 0);
+
+        sim.hook = hook;
+    }
+
+    reads = state.reads;
+}
+
+// Models the main loop of main.c for one minute and prints its interrupt rate and idle time
+void Measure(const char *mode, uint32_t period_us)
+{
+    Tickless_Timer timer;
+    Tickless_Timer_Sim_Context sim;
+    Tickless_Timer_Event led = {};
+    const uint32_t led_period = 500 * TICKS_PER_MS;
+
+    Tickless_Timer_Sim_Init(&timer, &sim, 0, TICKS_PER_MS);
+    Tickless_Timer_Start(&timer, &led, led_period, led_period, [](Tickless_Timer_Event *) {}, nullptr);
+
+    // Busy time per sample: the I2C read of the sensor (about 0.3 ms at 400 kHz) and the
+    // "r=XXXX g=XXXX b=XXXX" line, 22 bytes at 115200 baud
+    const uint64_t busy_ticks = 300 * TICKS_PER_MS / 1000 + 22 * 10 * TICKS_PER_MS * 1000 / 115200;
+    uint64_t samples = 0;
+
+    while (sim.time < 60000ULL * TICKS_PER_MS)
+    {
+        Tickless_Timer_Sim_Advance(&sim, busy_ticks);
+        Tickless_Timer_Sleep_us(&timer, period_us);
+        samples++;
+    }
+
+    double seconds = sim.time / (TICKS_PER_MS * 1000.0);
+    double idle = (double)timer.idle_ticks / sim.time;
+
+    // The SysTick firmware busy-waited in Clock_Delay, and was interrupted every millisecond
+    double systick_cpu = 1000.0 * SYSTICK_CYCLES / CPU_HZ;
+
+    std::printf("%-6s %9.1f %10.1f %13.2f %9.1f%% %13.0f %9.1f%%\n", mode, period_us / 1000.0, samples / seconds,
+                sim.interrupts / seconds, 100.0 * idle, 1000.0, 100.0 * systick_cpu);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t operations = 1000000;
+    uint32_t seed = 528;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--operations") && (i + 1 < argc)) operations = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && (i + 1 < argc)) seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--operations N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Ordering_Check *ordering = new Ordering_Check(seed);
+    ordering->Run(operations);
+    std::printf("Ordering: %llu operations, %llu callbacks, %llu counter wraps, %llu alarm interrupts\n",
+                (unsigned long long)operations, (unsigned long long)ordering->fired,
+                (unsigned long long)((ordering->sim.time + 0x100000) >> 32), (unsigned long long)ordering->sim.interrupts);
+    delete ordering;
+
+    uint64_t toggles = 0;
+    uint64_t alarms = 0;
+    Check_Wraparound(toggles, alarms);
+    std::printf("Wraparound: 49.8 days simulated, %llu LED toggles, %llu alarm interrupts\n",
+                (unsigned long long)toggles, (unsigned long long)alarms);
+
+    uint32_t overruns = 0;
+    Check_Overruns(overruns);
+    std::printf("Overruns: %u periods skipped after a callback of 2.5 periods\n", overruns);
+
+    uint64_t reads = 0;
+    Check_Preemption(operations / 4, seed, reads);
+    std::printf("Preemption: %llu operations, %llu reads of the time from a higher-priority interrupt\n",
+                (unsigned long long)(operations / 4), (unsigned long long)reads);
+
+    std::printf("\n                                  Tickless timer           SysTick\n");
+    std::printf("Mode   Period ms  Samples/s  Interrupts/s      Idle  Interrupts/s  In handler\n");
+    Measure("idle", ADAPTIVE_RATE_IDLE_INTEGRATION_US + ADAPTIVE_RATE_IDLE_WAIT_US);
+    Measure("burst", ADAPTIVE_RATE_BURST_INTEGRATION_US + ADAPTIVE_RATE_BURST_WAIT_US);
+
+    std::printf("%s\n", mismatches ? "MISMATCHES FOUND" : "The service matches the model");
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file uart_rx_check.cpp
+ * @brief Checks the DMA receiver of the UART against bursty input in simulated time.
+ *
+ * The program runs the firmware's UART_RX on the UART_RX_Sim backend, in nanoseconds of simulated time:
+ *   - Input: frames of bursts sent at the full line rate. The bursts of a frame are separated by gaps
+ *     of up to 1.85 ms (such as the USB packets of a serial adapter), and the frames by gaps of 3 to
+ *     50 ms. Each byte is a hash of its position in the stream.
+ *   - Interrupts: the DMA interrupt is taken 0 to 200 us after each completed half, and 5 ms late one
+ *     time in a hundred. The idle check runs every UART_RX_MSP432_CHECK_US with
+ *     UART_RX_MSP432_IDLE_CHECKS, as on the board.
+ *   - Reader: the main program wakes at random intervals of up to 80% of the time to fill the buffer
+ *     (and at most 40 ms), reads every complete frame, and then the bytes of the frame in progress.
+ * Every byte read must be the byte of its position, every frame must have the length that was sent,
+ * and no byte may be lost, at 115200 to 1500000 baud. A last run with a reader slower than the
+ * buffer must count the overwritten bytes as overruns and still return only correct bytes.
+ *
+ * Build from this directory:
+ *   gcc -std=gnu99 -O2 -c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/UART_RX.c ../ECE528L_PMOD_COLOR/PMOD_COLOR/src/UART_RX_Sim.c
+ *   g++ -std=c++17 -O2 -I../ECE528L_PMOD_COLOR/PMOD_COLOR uart_rx_check.cpp UART_RX.o UART_RX_Sim.o -o uart_rx_check
+ *
+ * Usage: uart_rx_check [--bytes N] [--seed N]
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+
+#include "inc/UART_RX.h"
+#include "inc/UART_RX_Sim.h"
+
+namespace
+{
+
+// Idle checks of UART_RX_MSP432.h
+constexpr uint64_t CHECK_NS = 1000000;
+constexpr uint32_t IDLE_CHECKS = 2;
+
+constexpr uint64_t NEVER = UINT64_MAX;
+
+uint64_t mismatches = 0;
+
+void Report(const char *format, uint64_t a, uint64_t b, uint64_t c)
+{
+    if (mismatches < 10)
+    {
+        std::fprintf(stderr, format, (unsigned long long)a, (unsigned long long)b, (unsigned long long)c);
+        std::fputc('\n', stderr);
+    }
+    mismatches++;
+}
+
+uint8_t Stream_Byte(uint64_t position)
+{
+    uint64_t x = position + 0x9E3779B97F4A7C15ull;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return (uint8_t)(x ^ (x >> 31));
+}
+
+struct Scenario
+{
+    const char *name;
+    uint32_t baud;
+    bool continuous;
+    bool slow_reader;
+};
+
+struct Result
+{
+    uint64_t bytes = 0;
+    uint64_t frames = 0;
+    uint64_t frames_read = 0;
+    uint64_t bytes_read = 0;
+};
+
+struct Check
+{
+    UART_RX rx;
+    UART_RX_Sim_Context sim;
+    std::mt19937_64 random;
+    Scenario scenario;
+    uint64_t byte_ns;
+
+    // Input: time of the next byte, bytes left in the burst and in the frame, and the frames sent
+    uint64_t next_byte = 0;
+    uint64_t sent = 0;
+    uint64_t burst_left = 0;
+    uint64_t frame_left = 0;
+    std::deque<uint64_t> frame_lengths;
+
+    // Reader: bytes of the current frame read before its end was known
+    uint64_t partial = 0;
+    Result result;
+
+    Check(const Scenario &s, uint64_t seed) : random(seed), scenario(s), byte_ns(10000000000ull / s.baud) {}
+
+    uint64_t Uniform(uint64_t low, uint64_t high)
+    {
+        return low + random() % (high - low + 1);
+    }
+
+    void Next_Burst(uint64_t now)
+    {
+        if (frame_left == 0)
+        {
+            // A new frame, after an idle gap that ends the last one
+            frame_left = scenario.continuous ? Uniform(4096, 65536) :
+                         ((random() % 4) ? Uniform(1, 600) : Uniform(600, 8000));
+            frame_lengths.push_back(frame_left);
+            next_byte = now + ((sent == 0) ? 0 : Uniform(3000000, (random() % 4) ? 6000000 : 50000000));
+        }
+        else
+        {
+            // The next burst of the frame, after a gap that must not end it
+            next_byte = now + ((random() % 3) ? 0 : Uniform(0, 1850000));
+        }
+
+        burst_left = std::min<uint64_t>(frame_left, scenario.continuous ? frame_left : Uniform(1, 256));
+    }
+
+    void Verify(const uint8_t *data, uint32_t count)
+    {
+        uint64_t first = rx.tail - count;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (data[i] != Stream_Byte(first + i))
+            {
+                Report("byte %llu read as 0x%02llx, sent as 0x%02llx", first + i, data[i], Stream_Byte(first + i));
+                return;
+            }
+        }
+    }
+
+    uint32_t Read(uint8_t *data, uint32_t max)
+    {
+        uint32_t count = UART_RX_Read(&rx, data, max);
+
+        Verify(data, count);
+        result.bytes_read += count;
+        return count;
+    }
+
+    void Wake_Reader()
+    {
+        uint8_t data[512];
+        uint32_t length;
+
+        while (UART_RX_Frame_Length(&rx, &length))
+        {
+            uint64_t total = partial + length;
+            uint32_t end = rx.tail + length;
+
+            // After an overrun, the reader skips the overwritten bytes, part of the frame included
+            while ((int32_t)(end - rx.tail) > 0)
+            {
+                uint32_t tail = rx.tail;
+
+                Read(data, std::min<uint32_t>(end - rx.tail, sizeof(data)));
+
+                if (rx.tail == tail)
+                {
+                    Report("frame %llu: ends at %llu, past the %llu bytes received", result.frames_read, end, UART_RX_Head(&rx));
+                    break;
+                }
+            }
+
+            partial = 0;
+            result.frames_read++;
+
+            if (scenario.slow_reader)
+            {
+                continue;
+            }
+
+            if (frame_lengths.empty() || (frame_lengths.front() != total))
+            {
+                Report("frame %llu: %llu bytes read, %llu sent", result.frames_read, total,
+                       frame_lengths.empty() ? 0 : frame_lengths.front());
+            }
+
+            if (!frame_lengths.empty())
+            {
+                frame_lengths.pop_front();
+            }
+        }
+
+        // The bytes of a frame that has not ended yet are read too, since it may be longer than the buffer
+        uint32_t count;
+
+        while (UART_RX_Available(&rx) > 0)
+        {
+            uint32_t tail = rx.tail;
+
+            count = Read(data, (uint32_t)Uniform(1, sizeof(data)));
+            partial += count;
+
+            if (rx.tail == tail)
+            {
+                Report("read: no byte of the %llu available at %llu%llu", UART_RX_Available(&rx), tail, 0);
+                break;
+            }
+        }
+    }
+
+    void Run(uint64_t bytes)
+    {
+        UART_RX_Sim_Init(&rx, &sim, IDLE_CHECKS);
+
+        // Time to fill the whole buffer at the line rate
+        uint64_t fill_ns = byte_ns * UART_RX_BUFFER_SIZE;
+        uint64_t reader_max = scenario.slow_reader ? fill_ns * 3 / 2 : std::min<uint64_t>(fill_ns * 4 / 5, 40000000);
+        uint64_t reader_min = scenario.slow_reader ? fill_ns * 3 / 2 : 0;
+
+        uint64_t now = 0;
+        uint64_t next_check = CHECK_NS;
+        uint64_t next_interrupt = NEVER;
+        uint64_t next_reader = Uniform(reader_min, reader_max);
+        uint64_t end = NEVER;
+
+        Next_Burst(0);
+
+        while (now < end)
+        {
+            uint64_t next = std::min({ next_byte, next_check, next_interrupt, next_reader, end });
+
+            now = next;
+
+            if (now == next_byte)
+            {
+                UART_RX_Sim_Receive(&sim, Stream_Byte(sent));
+                sent++;
+                burst_left--;
+                frame_left--;
+                next_byte = now + byte_ns;
+
+                if ((sim.interrupt_pending > 0) && (next_interrupt == NEVER))
+                {
+                    next_interrupt = now + (((random() % 100) == 0) ? 5000000 : Uniform(0, 200000));
+                }
+
+                if (sent == bytes)
+                {
+                    // The last frame is cut where the stream ends; let it end and the reader take it
+                    frame_lengths.back() -= frame_left;
+                    next_byte = NEVER;
+                    end = now + 100000000;
+                }
+                else if (burst_left == 0)
+                {
+                    Next_Burst(now);
+                }
+            }
+            else if (now == next_interrupt)
+            {
+                UART_RX_Sim_Take_Interrupt(&sim);
+                next_interrupt = NEVER;
+            }
+            else if (now == next_check)
+            {
+                UART_RX_Check_Idle(&rx);
+                next_check += CHECK_NS;
+            }
+            else if (now == next_reader)
+            {
+                Wake_Reader();
+                next_reader = now + Uniform(reader_min, reader_max);
+            }
+        }
+
+        Wake_Reader();
+
+        result.bytes = sent;
+        result.frames = rx.frames;
+    }
+};
+
+bool Run_Scenario(const Scenario &scenario, uint64_t bytes, uint64_t seed)
+{
+    Check *check = new Check(scenario, seed);
+    uint64_t before = mismatches;
+
+    check->Run(bytes);
+
+    const Result &r = check->result;
+    const UART_RX &rx = check->rx;
+    double kb = r.bytes / 1024.0;
+
+    if (check->sim.lost > 0)
+    {
+        Report("%llu bytes lost by the DMA, %llu received of %llu", check->sim.lost, check->sim.received, r.bytes);
+    }
+
+    if (scenario.slow_reader)
+    {
+        // Every byte is either read or counted as overwritten
+        if ((rx.overruns == 0) || (r.bytes_read + rx.overruns != r.bytes))
+        {
+            Report("slow reader: %llu bytes read and %llu overruns of %llu", r.bytes_read, rx.overruns, r.bytes);
+        }
+    }
+    else
+    {
+        if ((rx.overruns > 0) || (r.bytes_read != r.bytes) || !check->frame_lengths.empty() || (rx.dropped_frames > 0))
+        {
+            Report("%llu bytes read, %llu overruns, %llu frames not read", r.bytes_read, rx.overruns, check->frame_lengths.size());
+        }
+    }
+
+    std::printf("%-10s %8u %10llu %7llu %9llu %9.2f %11llu %10llu  %s\n",
+                scenario.name, scenario.baud, (unsigned long long)r.bytes, (unsigned long long)r.frames,
+                (unsigned long long)rx.dma_interrupts, rx.dma_interrupts / kb, (unsigned long long)rx.max_pending,
+                (unsigned long long)rx.overruns, (mismatches == before) ? "ok" : "FAILED");
+
+    delete check;
+    return mismatches == before;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t bytes = 2000000;
+    uint64_t seed = 528;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--bytes") && (i + 1 < argc)) bytes = strtoull(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--seed") && (i + 1 < argc)) seed = strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--bytes N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    const Scenario scenarios[] =
+    {
+        { "bursts", 115200, false, false },
+        { "bursts", 460800, false, false },
+        { "bursts", 921600, false, false },
+        { "bursts", 1500000, false, false },
+        { "line rate", 1500000, true, false },
+        { "slow", 115200, false, true },
+    };
+
+    std::printf("Buffer of %u bytes in two halves, idle check every %llu us, frame end after %u quiet checks\n",
+                UART_RX_BUFFER_SIZE, (unsigned long long)(CHECK_NS / 1000), IDLE_CHECKS);
+    std::printf("An interrupt per byte would take 1024 interrupts per KB\n\n");
+    std::printf("Input          Baud      Bytes  Frames  DMA ints    per KB  Max unread   Overruns\n");
+
+    for (const Scenario &scenario : scenarios)
+    {
+        Run_Scenario(scenario, scenario.slow_reader ? bytes / 10 : bytes, seed++);
+    }
+
+    std::printf("%s\n", mismatches ? "MISMATCHES FOUND" : "No byte lost or corrupted, and every frame ends where it was sent");
+    return mismatches ? 1 : 0;
+}